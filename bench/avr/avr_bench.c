@@ -0,0 +1,94 @@
+#include "avr_bench.h"
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include <stdlib.h>
+
+// from simavr's include directory (simavr/avr/avr_mcu_section.h); it only adds a section to the .elf that simavr reads, no code
+#include "avr_mcu_section.h"
+
+// tells simavr which chip and clock to emulate, so that 'run_avr <image>.elf' needs no arguments
+AVR_MCU(F_CPU, AVRBENCH_MCU);
+
+// every byte written to GPIOR0 is printed by simavr (a line at a time)
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+
+// cycles that avrbench_start/avrbench_stop themselves add to every measurement
+static uint16_t g_u16Overhead = 0;
+
+void avrbench_start()
+{
+	TCCR1B = 0;	// stop timer1
+	TCNT1 = 0;
+	TIFR1 = (1 << TOV1);	// writing a 1 clears the overflow flag
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);	// normal mode, no prescaler, so it counts cpu cycles
+}
+
+uint32_t avrbench_stop()
+{
+	uint16_t u16Count = TCNT1;
+	TCCR1B = 0;
+
+	// interrupts are disabled the whole time so nothing else can sneak in, but we can only tell that the timer wrapped, not how many times
+	if (TIFR1 & (1 << TOV1))
+	{
+		return 0xFFFFFFFF;
+	}
+
+	return u16Count - g_u16Overhead;
+}
+
+void avrbench_print(const char *psz)
+{
+	while (*psz != 0)
+	{
+		GPIOR0 = *psz;
+		psz++;
+	}
+	GPIOR0 = '\n';
+}
+
+void avrbench_report(const char *pszName, uint32_t u32Cycles)
+{
+	char s[11];
+
+	while (*pszName != 0)
+	{
+		GPIOR0 = *pszName;
+		pszName++;
+	}
+	GPIOR0 = ' ';
+
+	if (u32Cycles == 0xFFFFFFFF)
+	{
+		avrbench_print(">65535");
+	}
+	else
+	{
+		avrbench_print(ultoa(u32Cycles, s, 10));
+	}
+}
+
+int main()
+{
+	cli();
+
+	// calibrate by measuring nothing
+	avrbench_start();
+	g_u16Overhead = (uint16_t) avrbench_stop();
+
+	avrbench_print("# " AVRBENCH_NAME " (cycles)");
+	avrbench_run();
+	avrbench_print("# end");
+
+	// simavr exits when the cpu goes to sleep with interrupts disabled
+	sleep_enable();
+	sleep_cpu();
+
+	for (;;)
+	{
+	}
+
+	return 0;
+}
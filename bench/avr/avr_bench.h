@@ -0,0 +1,30 @@
+#ifndef LDP_IN_AVR_BENCH_H
+#define LDP_IN_AVR_BENCH_H
+
+#include <stdint.h>
+
+// Cycle counting harness for the interpreters, cross-compiled for the AVR and run under simavr (see README.md).
+// Cycles are counted with Timer1 running at the CPU clock, with interrupts disabled, so the counts are exact
+//  (the same firmware also works on a real atmega644p if the console is redirected to a UART).
+// Results are printed through simavr's console register, one line per measurement.
+
+// Each firmware image (one per interpreter) defines this; it runs the scripted command sequences using AVRBENCH_MEASURE.
+void avrbench_run();
+
+// Starts the counter.  Use AVRBENCH_MEASURE instead of calling this directly.
+void avrbench_start();
+
+// Returns the cycles since avrbench_start (minus the harness's own overhead), or 0xFFFFFFFF if the counter overflowed.
+uint32_t avrbench_stop();
+
+// prints "<name> <cycles>"
+void avrbench_report(const char *pszName, uint32_t u32Cycles);
+
+// prints any line (for section headers, etc)
+void avrbench_print(const char *psz);
+
+// Measures a single statement (normally one call to a public entry point) and reports it under pszName.
+#define AVRBENCH_MEASURE(pszName, stmt) \
+	do { uint32_t u32AvrBenchCycles; avrbench_start(); stmt; u32AvrBenchCycles = avrbench_stop(); avrbench_report(pszName, u32AvrBenchCycles); } while (0)
+
+#endif // LDP_IN_AVR_BENCH_H
@@ -0,0 +1,9 @@
+#include "avr_bench.h"
+
+// The harness by itself, without an interpreter.
+// Its size is subtracted from the other images so that the report shows what linking in each interpreter costs.
+
+void avrbench_run()
+{
+	AVRBENCH_MEASURE("empty", (void) 0);
+}
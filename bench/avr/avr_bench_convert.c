@@ -0,0 +1,26 @@
+#include "avr_bench.h"
+#include <ldp-in/convert.h>
+
+// The frame number conversions that the interpreters share, by themselves.
+// The volatile inputs keep the compiler from folding the calls into constants.
+
+void avrbench_run()
+{
+	volatile uint32_t u32Frame = 12345;
+	volatile uint32_t u32Sink;
+	uint8_t buf[5];
+
+	AVRBENCH_MEASURE("ldpin_u32_to_ascii5 (12345)", ldpin_u32_to_ascii5(u32Frame, buf));
+	u32Frame = 99999;
+	AVRBENCH_MEASURE("ldpin_u32_to_ascii5 (99999)", ldpin_u32_to_ascii5(u32Frame, buf));
+	u32Frame = 123456;
+	AVRBENCH_MEASURE("ldpin_u32_to_ascii5 (123456)", ldpin_u32_to_ascii5(u32Frame, buf));
+	u32Frame = 54321;
+	AVRBENCH_MEASURE("ldpin_u32_to_bcd5 (54321)", ldpin_u32_to_bcd5(u32Frame, buf));
+
+	AVRBENCH_MEASURE("ldpin_ascii5_to_u32 (5 digits)", u32Sink = ldpin_ascii5_to_u32("12345"));
+	AVRBENCH_MEASURE("ldpin_ascii5_to_u32 (empty)", u32Sink = ldpin_ascii5_to_u32(""));
+	AVRBENCH_MEASURE("ldpin_bcd5_to_u32", u32Sink = ldpin_bcd5_to_u32(buf[0], buf[1], buf[2]));
+	AVRBENCH_MEASURE("ldpin_bcd3_to_u16", u32Sink = ldpin_bcd3_to_u16(buf[1], buf[2]));
+	AVRBENCH_MEASURE("ldpin_append_digit", u32Sink = ldpin_append_digit(u32Frame, 7));
+}
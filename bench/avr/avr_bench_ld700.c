@@ -0,0 +1,72 @@
+#include "avr_bench.h"
+#include <ldp-in/ld700-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+void ld700i_host_play(void *pUser) { }
+void ld700i_host_pause(void *pUser) { }
+void ld700i_host_stop(void *pUser) { }
+void ld700i_host_eject(void *pUser) { }
+void ld700i_host_step(void *pUser, LD700_BOOL bBackward) { }
+void ld700i_host_begin_search(void *pUser, uint32_t uFrameNumber) { }
+void ld700i_host_change_audio(void *pUser, LD700_BOOL bEnableLeft, LD700_BOOL bEnableRight) { }
+void ld700i_host_change_audio_squelch(void *pUser, LD700_BOOL bSquelched) { }
+uint32_t ld700i_host_get_current_picnum(void *pUser) { return 12345; }
+void ld700i_host_on_ext_ack_changed(void *pUser, LD700_BOOL bActive) { }
+void ld700i_host_error(void *pUser, LD700ErrCode_t code, uint8_t u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const LD700Callbacks_t g_cb =
+{
+	ld700i_host_play, ld700i_host_pause, ld700i_host_stop, ld700i_host_eject, ld700i_host_step, ld700i_host_begin_search,
+	ld700i_host_change_audio, ld700i_host_change_audio_squelch, ld700i_host_get_current_picnum,
+	ld700i_host_on_ext_ack_changed, ld700i_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static LD700Ctx_t g_ctx;
+
+// sends one complete command (header, command, inverted command) the way the LD-700 receives it
+static void send_cmd(uint8_t u8Cmd)
+{
+	ld700i_ctx_on_new_cmd(&g_ctx);
+	ld700i_ctx_write(&g_ctx, 0xA8, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, 0x57, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, u8Cmd, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, u8Cmd ^ 0xFF, LD700_PAUSED);
+}
+
+void avrbench_run()
+{
+	ld700i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("ld700i_ctx_reset", ld700i_ctx_reset(&g_ctx));
+
+	// prepare for frame number, then 12345 and begin search
+	AVRBENCH_MEASURE("ld700i_ctx_on_new_cmd", ld700i_ctx_on_new_cmd(&g_ctx));
+	AVRBENCH_MEASURE("ld700i_ctx_write (header)", ld700i_ctx_write(&g_ctx, 0xA8, LD700_PAUSED));
+	ld700i_ctx_write(&g_ctx, 0x57, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, 0x41, LD700_PAUSED);
+	AVRBENCH_MEASURE("ld700i_ctx_write (cmd 41 complete)", ld700i_ctx_write(&g_ctx, 0x41 ^ 0xFF, LD700_PAUSED));
+	AVRBENCH_MEASURE("ld700i_ctx_on_vblank (after cmd)", ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED));
+
+	send_cmd(1);
+	ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED);
+	send_cmd(2);
+	ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED);
+	send_cmd(3);
+	ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED);
+	send_cmd(4);
+	ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED);
+	send_cmd(5);
+	ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED);
+
+	ld700i_ctx_on_new_cmd(&g_ctx);
+	ld700i_ctx_write(&g_ctx, 0xA8, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, 0x57, LD700_PAUSED);
+	ld700i_ctx_write(&g_ctx, 0x42, LD700_PAUSED);
+	AVRBENCH_MEASURE("ld700i_ctx_write (cmd 42 search 12345)", ld700i_ctx_write(&g_ctx, 0x42 ^ 0xFF, LD700_PAUSED));
+	AVRBENCH_MEASURE("ld700i_ctx_on_vblank (idle)", ld700i_ctx_on_vblank(&g_ctx, LD700_PAUSED));
+}
@@ -0,0 +1,95 @@
+#include "avr_bench.h"
+#include <ldp-in/ldp1000-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+static LDP1000Status_t g_status = LDP1000_PLAYING;
+static uint32_t g_u32Frame = 12345;
+
+void ldp1000i_host_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched) { }
+void ldp1000i_host_pause(void *pUser) { }
+void ldp1000i_host_begin_search(void *pUser, uint32_t u32FrameNum) { }
+void ldp1000i_host_step_forward(void *pUser) { }
+void ldp1000i_host_step_reverse(void *pUser) { }
+void ldp1000i_host_skip(void *pUser, int16_t i16TracksToSkip) { }
+void ldp1000i_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { }
+void ldp1000i_host_change_video(void *pUser, LDP1000_BOOL bEnable) { }
+LDP1000Status_t ldp1000i_host_get_status(void *pUser) { return g_status; }
+uint32_t ldp1000i_host_get_cur_frame_num(void *pUser) { return g_u32Frame; }
+void ldp1000i_host_text_enable_changed(void *pUser, LDP1000_BOOL bEnabled) { }
+void ldp1000i_host_text_buffer_contents_changed(void *pUser, const uint8_t *p8Buf32Bytes) { }
+void ldp1000i_host_text_buffer_start_index_changed(void *pUser, uint8_t u8StartIdx) { }
+void ldp1000i_host_text_modes_changed(void *pUser, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y) { }
+void ldp1000i_host_error(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const LDP1000Callbacks_t g_cb =
+{
+	ldp1000i_host_play, ldp1000i_host_pause, ldp1000i_host_begin_search, ldp1000i_host_step_forward,
+	ldp1000i_host_step_reverse, ldp1000i_host_skip, ldp1000i_host_change_audio, ldp1000i_host_change_video,
+	ldp1000i_host_get_status, ldp1000i_host_get_cur_frame_num, ldp1000i_host_text_enable_changed,
+	ldp1000i_host_text_buffer_contents_changed, ldp1000i_host_text_buffer_start_index_changed,
+	ldp1000i_host_text_modes_changed, ldp1000i_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static LDP1000Ctx_t g_ctx;
+
+static void drain()
+{
+	uint16_t buf[8];
+	while (ldp1000i_ctx_read_n(&g_ctx, buf, 8) != 0)
+	{
+	}
+}
+
+static const uint8_t g_search[] = { 0x43, '1', '2', '3', '4', '5' };
+
+void avrbench_run()
+{
+	uint16_t buf[8];
+	volatile uint16_t u16Sink;
+
+	ldp1000i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("ldp1000i_ctx_reset (1450)", ldp1000i_ctx_reset(&g_ctx, LDP1000_EMU_LDP1450));
+
+	AVRBENCH_MEASURE("ldp1000i_ctx_can_read (empty)", u16Sink = ldp1000i_ctx_can_read(&g_ctx));
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 3A (play)", ldp1000i_ctx_write(&g_ctx, 0x3A));
+	AVRBENCH_MEASURE("ldp1000i_ctx_read (ack)", u16Sink = ldp1000i_ctx_read(&g_ctx));
+	drain();
+
+	// ADDR INQ
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 60 (frame 12345)", ldp1000i_ctx_write(&g_ctx, 0x60));
+	AVRBENCH_MEASURE("ldp1000i_ctx_read_n (5 digits)", ldp1000i_ctx_read_n(&g_ctx, buf, 5));
+	drain();
+	g_u32Frame = 99999;
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 60 (frame 99999)", ldp1000i_ctx_write(&g_ctx, 0x60));
+	drain();
+	ldp1000i_ctx_set_cur_frame_num(&g_ctx, 12345);
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 60 (cached)", ldp1000i_ctx_write(&g_ctx, 0x60));
+	drain();
+
+	// status inquiry
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 67 (status inq)", ldp1000i_ctx_write(&g_ctx, 0x67));
+	drain();
+
+	// search
+	AVRBENCH_MEASURE("ldp1000i_ctx_write_n 43 + 5 digits", ldp1000i_ctx_write_n(&g_ctx, g_search, sizeof(g_search)));
+	drain();
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 40 (enter)", ldp1000i_ctx_write(&g_ctx, 0x40));
+	drain();
+	g_status = LDP1000_PAUSED;
+	AVRBENCH_MEASURE("ldp1000i_ctx_think_during_vblank (search done)", ldp1000i_ctx_think_during_vblank(&g_ctx));
+	drain();
+	AVRBENCH_MEASURE("ldp1000i_ctx_think_during_vblank (idle)", ldp1000i_ctx_think_during_vblank(&g_ctx));
+
+	// the 1000A uses the same code but tags every byte with its latency
+	ldp1000i_ctx_reset(&g_ctx, LDP1000_EMU_LDP1000A);
+	AVRBENCH_MEASURE("ldp1000i_ctx_write 60 (1000A)", ldp1000i_ctx_write(&g_ctx, 0x60));
+	drain();
+
+	(void) u16Sink;
+}
@@ -0,0 +1,101 @@
+#include "avr_bench.h"
+#include <ldp-in/ldv1000-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+static LDV1000Status_t g_status = LDV1000_PLAYING;
+static uint32_t g_u32Frame = 12345;
+
+LDV1000Status_t ldv1000i_host_get_status(void *pUser) { return g_status; }
+uint32_t ldv1000i_host_get_cur_frame_num(void *pUser) { return g_u32Frame; }
+void ldv1000i_host_play(void *pUser) { }
+void ldv1000i_host_pause(void *pUser) { }
+void ldv1000i_host_begin_search(void *pUser, uint32_t uFrameNumber) { }
+void ldv1000i_host_step_reverse(void *pUser) { }
+void ldv1000i_host_change_speed(void *pUser, uint8_t uNumerator, uint8_t uDenominator) { }
+void ldv1000i_host_skip_forward(void *pUser, uint8_t uTracks) { }
+void ldv1000i_host_skip_backward(void *pUser, uint8_t uTracks) { }
+void ldv1000i_host_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable) { }
+void ldv1000i_host_on_error(void *pUser, const char *pszErrMsg) { }
+const uint8_t *ldv1000i_host_query_available_discs(void *pUser) { static const uint8_t discs[] = { 1, 2, 0 }; return discs; }
+uint8_t ldv1000i_host_query_active_disc(void *pUser) { return 1; }
+void ldv1000i_host_begin_changing_to_disc(void *pUser, uint8_t idDisc) { }
+void ldv1000i_host_change_seek_delay(void *pUser, LDV1000_BOOL bEnabled) { }
+void ldv1000i_host_change_spinup_delay(void *pUser, LDV1000_BOOL bEnabled) { }
+void ldv1000i_host_change_super_mode(void *pUser, LDV1000_BOOL bEnabled) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const LDV1000Callbacks_t g_cb =
+{
+	ldv1000i_host_get_status, ldv1000i_host_get_cur_frame_num, ldv1000i_host_play, ldv1000i_host_pause,
+	ldv1000i_host_begin_search, ldv1000i_host_step_reverse, ldv1000i_host_change_speed, ldv1000i_host_skip_forward,
+	ldv1000i_host_skip_backward, ldv1000i_host_change_audio, ldv1000i_host_on_error, ldv1000i_host_query_available_discs,
+	ldv1000i_host_query_active_disc, ldv1000i_host_begin_changing_to_disc, ldv1000i_host_change_seek_delay,
+	ldv1000i_host_change_spinup_delay, ldv1000i_host_change_super_mode
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static LDV1000Ctx_t g_ctx;
+
+// digits of frame 12345, each preceded by NO ENTRY like the games do
+static const unsigned char g_search[] = { 0xFF, 0x0F, 0xFF, 0x8F, 0xFF, 0x4F, 0xFF, 0x2F, 0xFF, 0xAF, 0xFF };
+
+void avrbench_run()
+{
+	unsigned char buf[5];
+	volatile unsigned char u8Sink;
+
+	ldv1000i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("ldv1000i_ctx_reset", ldv1000i_ctx_reset(&g_ctx, LDV1000_EMU_STANDARD));
+
+	AVRBENCH_MEASURE("ldv1000i_ctx_write FF (no entry)", ldv1000i_ctx_write(&g_ctx, 0xFF));
+	AVRBENCH_MEASURE("ldv1000i_ctx_write FD (play)", ldv1000i_ctx_write(&g_ctx, 0xFD));
+	ldv1000i_ctx_write(&g_ctx, 0xFF);
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (status)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+	ldv1000i_ctx_set_status(&g_ctx, LDV1000_PLAYING);
+	ldv1000i_ctx_read(&g_ctx);
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (status, notified)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+	ldv1000i_ctx_reset(&g_ctx, LDV1000_EMU_STANDARD);
+	ldv1000i_ctx_write(&g_ctx, 0xFD);
+	ldv1000i_ctx_write(&g_ctx, 0xFF);
+
+	// get current frame
+	AVRBENCH_MEASURE("ldv1000i_ctx_write C2 (frame 12345)", ldv1000i_ctx_write(&g_ctx, 0xC2));
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (queued digit)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+	ldv1000i_ctx_read_n(&g_ctx, buf, 4);
+	g_u32Frame = 99999;
+	ldv1000i_ctx_write(&g_ctx, 0xFF);
+	AVRBENCH_MEASURE("ldv1000i_ctx_write C2 (frame 99999)", ldv1000i_ctx_write(&g_ctx, 0xC2));
+	AVRBENCH_MEASURE("ldv1000i_ctx_read_n (5 digits)", ldv1000i_ctx_read_n(&g_ctx, buf, 5));
+
+	// the same query with the host supplying the frame number at vblank
+	ldv1000i_ctx_set_cur_frame_num(&g_ctx, 12398);
+	AVRBENCH_MEASURE("ldv1000i_ctx_set_cur_frame_num (+1)", ldv1000i_ctx_set_cur_frame_num(&g_ctx, 12399));
+	AVRBENCH_MEASURE("ldv1000i_ctx_set_cur_frame_num (jump)", ldv1000i_ctx_set_cur_frame_num(&g_ctx, 12345));
+	ldv1000i_ctx_write(&g_ctx, 0xFF);
+	AVRBENCH_MEASURE("ldv1000i_ctx_write C2 (cached)", ldv1000i_ctx_write(&g_ctx, 0xC2));
+	ldv1000i_ctx_read_n(&g_ctx, buf, 5);
+
+	// search
+	AVRBENCH_MEASURE("ldv1000i_ctx_write_n (5 digits)", ldv1000i_ctx_write_n(&g_ctx, g_search, sizeof(g_search)));
+	g_status = LDV1000_SEARCHING;
+	AVRBENCH_MEASURE("ldv1000i_ctx_write F7 (search)", ldv1000i_ctx_write(&g_ctx, 0xF7));
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (searching)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+	ldv1000i_ctx_read(&g_ctx);
+	ldv1000i_ctx_read(&g_ctx);
+	ldv1000i_ctx_read(&g_ctx);
+	g_status = LDV1000_PAUSED;
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (search done)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+
+	// a search that ends in a state the interpreter doesn't expect takes the sprintf error path
+	ldv1000i_ctx_write_n(&g_ctx, g_search, sizeof(g_search));
+	ldv1000i_ctx_write(&g_ctx, 0xF7);
+	ldv1000i_ctx_read_n(&g_ctx, buf, 4);
+	g_status = LDV1000_PLAYING;
+	AVRBENCH_MEASURE("ldv1000i_ctx_read (search error)", u8Sink = ldv1000i_ctx_read(&g_ctx));
+
+	(void) u8Sink;
+}
@@ -0,0 +1,48 @@
+#include "avr_bench.h"
+#include <ldp-in/pr7820-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+static PR7820Status_t g_status = PR7820_PAUSED;
+
+PR7820Status_t pr7820i_host_get_status(void *pUser) { return g_status; }
+void pr7820i_host_play(void *pUser) { }
+void pr7820i_host_pause(void *pUser) { }
+void pr7820i_host_begin_search(void *pUser, unsigned int uFrameNumber) { }
+void pr7820i_host_change_audio(void *pUser, unsigned char uChannel, unsigned char uEnable) { }
+void pr7820i_host_enable_super_mode(void *pUser) { }
+void pr7820i_host_on_error(void *pUser, PR7820ErrCode_t code, unsigned char u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const PR7820Callbacks_t g_cb =
+{
+	pr7820i_host_get_status, pr7820i_host_play, pr7820i_host_pause, pr7820i_host_begin_search,
+	pr7820i_host_change_audio, pr7820i_host_enable_super_mode, pr7820i_host_on_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static PR7820Ctx_t g_ctx;
+
+void avrbench_run()
+{
+	volatile uint8_t u8Sink;
+
+	pr7820i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("pr7820i_ctx_reset", pr7820i_ctx_reset(&g_ctx));
+
+	AVRBENCH_MEASURE("pr7820i_ctx_is_busy", u8Sink = pr7820i_ctx_is_busy(&g_ctx));
+	AVRBENCH_MEASURE("pr7820i_ctx_write FD (play)", pr7820i_ctx_write(&g_ctx, 0xFD));
+
+	// 12345 then search
+	AVRBENCH_MEASURE("pr7820i_ctx_write 0F (digit)", pr7820i_ctx_write(&g_ctx, 0x0F));
+	pr7820i_ctx_write(&g_ctx, 0x8F);
+	pr7820i_ctx_write(&g_ctx, 0x4F);
+	pr7820i_ctx_write(&g_ctx, 0x2F);
+	pr7820i_ctx_write(&g_ctx, 0xAF);
+	AVRBENCH_MEASURE("pr7820i_ctx_write F7 (search 12345)", pr7820i_ctx_write(&g_ctx, 0xF7));
+
+	(void) u8Sink;
+}
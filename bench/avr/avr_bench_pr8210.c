@@ -0,0 +1,55 @@
+#include "avr_bench.h"
+#include <ldp-in/pr8210-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+void pr8210i_host_play(void *pUser) { }
+void pr8210i_host_pause(void *pUser) { }
+void pr8210i_host_step(void *pUser, int8_t i8TracksToStep) { }
+void pr8210i_host_begin_search(void *pUser, uint32_t uFrameNumber) { }
+void pr8210i_host_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable) { }
+void pr8210i_host_skip(void *pUser, int8_t i8TracksToSkip) { }
+void pr8210i_host_change_auto_track_jump(void *pUser, PR8210_BOOL bAutoTrackJumpEnabled) { }
+PR8210_BOOL pr8210i_host_is_player_busy(void *pUser) { return PR8210_FALSE; }
+void pr8210i_host_change_standby(void *pUser, PR8210_BOOL bRaised) { }
+void pr8210i_host_error(void *pUser, PR8210ErrCode_t code, uint16_t u16Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const PR8210Callbacks_t g_cb =
+{
+	pr8210i_host_play, pr8210i_host_pause, pr8210i_host_step, pr8210i_host_begin_search, pr8210i_host_change_audio,
+	pr8210i_host_skip, pr8210i_host_change_auto_track_jump, pr8210i_host_is_player_busy, pr8210i_host_change_standby,
+	pr8210i_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static PR8210Ctx_t g_ctx;
+
+#define PR8210_MSG(cmd) ((uint16_t) (4 | ((cmd) << 3)))
+
+void avrbench_run()
+{
+	pr8210i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("pr8210i_ctx_reset", pr8210i_ctx_reset(&g_ctx));
+
+	// every message is sent twice; the second copy is the one that gets acted on
+	AVRBENCH_MEASURE("pr8210i_ctx_write (first copy)", pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x11)));
+	AVRBENCH_MEASURE("pr8210i_ctx_write (digit)", pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x11)));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x12));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x12));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x13));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x13));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x14));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x14));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x15));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0x15));
+	pr8210i_ctx_write(&g_ctx, PR8210_MSG(0xB));
+	AVRBENCH_MEASURE("pr8210i_ctx_write (search 12345)", pr8210i_ctx_write(&g_ctx, PR8210_MSG(0xB)));
+	AVRBENCH_MEASURE("pr8210i_ctx_write (filler)", pr8210i_ctx_write(&g_ctx, PR8210_MSG(0)));
+
+	AVRBENCH_MEASURE("pr8210i_ctx_on_vblank", pr8210i_ctx_on_vblank(&g_ctx));
+	AVRBENCH_MEASURE("pr8210i_ctx_on_jmp_trigger_changed", pr8210i_ctx_on_jmp_trigger_changed(&g_ctx, PR8210_TRUE, PR8210_FALSE));
+}
@@ -0,0 +1,76 @@
+#include "avr_bench.h"
+#include <ldp-in/vip9500sg-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+static VIP9500SGStatus_t g_status = VIP9500SG_PAUSED;
+static uint32_t g_u32Frame = 12345;
+
+void vip9500sgi_host_play(void *pUser) { }
+void vip9500sgi_host_pause(void *pUser) { }
+void vip9500sgi_host_stop(void *pUser) { }
+void vip9500sgi_host_step_reverse(void *pUser) { }
+void vip9500sgi_host_begin_search(void *pUser, uint32_t u32FrameNum) { }
+void vip9500sgi_host_skip(void *pUser, int32_t i32TracksToSkip) { }
+void vip9500sgi_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { }
+VIP9500SGStatus_t vip9500sgi_host_get_status(void *pUser) { return g_status; }
+uint32_t vip9500sgi_host_get_cur_frame_num(void *pUser) { return g_u32Frame; }
+uint32_t vip9500sgi_host_get_cur_vbi_line18(void *pUser) { return 0xF80000 | 0x12345; }
+void vip9500sgi_host_error(void *pUser, VIP9500SGErrCode_t code, uint8_t u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const VIP9500SGCallbacks_t g_cb =
+{
+	vip9500sgi_host_play, vip9500sgi_host_pause, vip9500sgi_host_stop, vip9500sgi_host_step_reverse,
+	vip9500sgi_host_begin_search, vip9500sgi_host_skip, vip9500sgi_host_change_audio, vip9500sgi_host_get_status,
+	vip9500sgi_host_get_cur_frame_num, vip9500sgi_host_get_cur_vbi_line18, vip9500sgi_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static VIP9500SGCtx_t g_ctx;
+
+static void drain()
+{
+	uint8_t buf[8];
+	while (vip9500sgi_ctx_read_n(&g_ctx, buf, 8) != 0)
+	{
+	}
+}
+
+static const uint8_t g_search[] = { 0x2b, '1', '2', '3', '4', '5' };
+
+void avrbench_run()
+{
+	uint8_t buf[8];
+	volatile uint8_t u8Sink;
+
+	vip9500sgi_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("vip9500sgi_ctx_reset", vip9500sgi_ctx_reset(&g_ctx));
+
+	AVRBENCH_MEASURE("vip9500sgi_ctx_can_read (empty)", u8Sink = vip9500sgi_ctx_can_read(&g_ctx));
+	AVRBENCH_MEASURE("vip9500sgi_ctx_write 2f (stop)", vip9500sgi_ctx_write(&g_ctx, 0x2f));
+	AVRBENCH_MEASURE("vip9500sgi_ctx_read (ack)", u8Sink = vip9500sgi_ctx_read(&g_ctx));
+	drain();
+
+	// get current frame; answered from the VBI after the next vblank
+	AVRBENCH_MEASURE("vip9500sgi_ctx_write 6b (frame)", vip9500sgi_ctx_write(&g_ctx, 0x6b));
+	AVRBENCH_MEASURE("vip9500sgi_ctx_think_after_vblank (frame)", vip9500sgi_ctx_think_after_vblank(&g_ctx));
+	AVRBENCH_MEASURE("vip9500sgi_ctx_read_n (frame)", u8Sink = (uint8_t) vip9500sgi_ctx_read_n(&g_ctx, buf, sizeof(buf)));
+	drain();
+
+	// search
+	AVRBENCH_MEASURE("vip9500sgi_ctx_write_n 2b + 5 digits", vip9500sgi_ctx_write_n(&g_ctx, g_search, sizeof(g_search)));
+	g_status = VIP9500SG_SEARCHING;
+	AVRBENCH_MEASURE("vip9500sgi_ctx_write 41 (enter)", vip9500sgi_ctx_write(&g_ctx, 0x41));
+	drain();
+	AVRBENCH_MEASURE("vip9500sgi_ctx_think_after_vblank (searching)", vip9500sgi_ctx_think_after_vblank(&g_ctx));
+	g_status = VIP9500SG_PAUSED;
+	AVRBENCH_MEASURE("vip9500sgi_ctx_think_after_vblank (search done)", vip9500sgi_ctx_think_after_vblank(&g_ctx));
+	drain();
+	AVRBENCH_MEASURE("vip9500sgi_ctx_think_after_vblank (idle)", vip9500sgi_ctx_think_after_vblank(&g_ctx));
+
+	(void) u8Sink;
+}
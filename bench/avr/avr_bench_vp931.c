@@ -0,0 +1,39 @@
+#include "avr_bench.h"
+#include <ldp-in/vp931-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+void vp931i_host_play(void *pUser) { }
+void vp931i_host_pause(void *pUser) { }
+void vp931i_host_begin_search(void *pUser, uint32_t uFrameNumber, VP931_BOOL bAudioSquelchedOnComplete) { }
+void vp931i_host_skip_tracks(void *pUser, int16_t i16TracksToSkip) { }
+void vp931i_host_skip_to_framenum(void *pUser, uint32_t uFrameNumber) { }
+void vp931i_host_error(void *pUser, VP931ErrCode_t code, uint8_t u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const VP931Callbacks_t g_cb =
+{
+	vp931i_host_play, vp931i_host_pause, vp931i_host_begin_search, vp931i_host_skip_tracks, vp931i_host_skip_to_framenum,
+	vp931i_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static VP931Ctx_t g_ctx;
+
+static const uint8_t g_search[] = { 0xD1, 0x23, 0x45 };	// goto frame 12345 and halt
+static const uint8_t g_skip[] = { 0xE1, 0x23, 0xF0 };	// jump 123 tracks forward
+static const uint8_t g_batch[] = { 0xD1, 0x23, 0x45, 0x00, 0xE1, 0x23, 0xF0, 0x05, 0x00, 0x00, 0x00, 0x00 };
+
+void avrbench_run()
+{
+	vp931i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("vp931i_ctx_reset", vp931i_ctx_reset(&g_ctx));
+
+	AVRBENCH_MEASURE("vp931i_ctx_on_vsync (no cmd)", vp931i_ctx_on_vsync(&g_ctx, g_search, 0, VP931_PAUSED));
+	AVRBENCH_MEASURE("vp931i_ctx_on_vsync (search)", vp931i_ctx_on_vsync(&g_ctx, g_search, sizeof(g_search), VP931_PAUSED));
+	AVRBENCH_MEASURE("vp931i_ctx_on_vsync (skip)", vp931i_ctx_on_vsync(&g_ctx, g_skip, sizeof(g_skip), VP931_PLAYING));
+	AVRBENCH_MEASURE("vp931i_ctx_on_vsync (4 cmds)", vp931i_ctx_on_vsync(&g_ctx, g_batch, sizeof(g_batch), VP931_PAUSED));
+}
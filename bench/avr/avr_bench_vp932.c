@@ -0,0 +1,64 @@
+#include "avr_bench.h"
+#include <ldp-in/vp932-interpreter.h>
+
+// The stub callbacks are named like the LDP_IN_STATIC_CALLBACKS hooks so that this file works in either callback mode.
+
+static uint32_t g_u32Frame = 12345;
+
+void vp932i_host_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, VP932_BOOL bBackward, VP932_BOOL bAudioSquelched) { }
+void vp932i_host_step(void *pUser, VP932_BOOL bBackward) { }
+void vp932i_host_pause(void *pUser) { }
+void vp932i_host_begin_search(void *pUser, uint32_t u32FrameNum) { }
+void vp932i_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { }
+uint32_t vp932i_host_get_cur_frame_num(void *pUser) { return g_u32Frame; }
+void vp932i_host_error(void *pUser, VP932ErrCode_t code, uint8_t u8Val) { }
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+static const VP932Callbacks_t g_cb =
+{
+	vp932i_host_play, vp932i_host_step, vp932i_host_pause, vp932i_host_begin_search, vp932i_host_change_audio,
+	vp932i_host_get_cur_frame_num, vp932i_host_error
+};
+#define CALLBACKS &g_cb
+#else
+#define CALLBACKS 0
+#endif
+
+static VP932Ctx_t g_ctx;
+
+static void drain()
+{
+	uint8_t buf[8];
+	while (vp932i_ctx_read_n(&g_ctx, buf, 8) != 0)
+	{
+	}
+}
+
+// search and halt
+static const char g_search[] = "F12345R\r";
+
+void avrbench_run()
+{
+	uint8_t buf[8];
+	volatile uint8_t u8Sink;
+
+	vp932i_ctx_init(&g_ctx, CALLBACKS, 0);
+	AVRBENCH_MEASURE("vp932i_ctx_reset", vp932i_ctx_reset(&g_ctx));
+
+	AVRBENCH_MEASURE("vp932i_ctx_can_read (empty)", u8Sink = vp932i_ctx_can_read(&g_ctx));
+	AVRBENCH_MEASURE("vp932i_ctx_write (one byte)", vp932i_ctx_write(&g_ctx, 'F'));
+	vp932i_ctx_write_n(&g_ctx, (const uint8_t *) "12345R", 6);
+	AVRBENCH_MEASURE("vp932i_ctx_write (CR, search)", vp932i_ctx_write(&g_ctx, '\r'));
+	AVRBENCH_MEASURE("vp932i_ctx_think_during_vblank (searching)", vp932i_ctx_think_during_vblank(&g_ctx, VP932_SEARCHING));
+	AVRBENCH_MEASURE("vp932i_ctx_think_during_vblank (search done)", vp932i_ctx_think_during_vblank(&g_ctx, VP932_PAUSED));
+	AVRBENCH_MEASURE("vp932i_ctx_read (response)", u8Sink = vp932i_ctx_read(&g_ctx));
+	drain();
+	AVRBENCH_MEASURE("vp932i_ctx_think_during_vblank (idle)", vp932i_ctx_think_during_vblank(&g_ctx, VP932_PAUSED));
+
+	// the same search a second time is answered without searching
+	AVRBENCH_MEASURE("vp932i_ctx_write_n (whole search line)", vp932i_ctx_write_n(&g_ctx, (const uint8_t *) g_search, sizeof(g_search) - 1));
+	AVRBENCH_MEASURE("vp932i_ctx_read_n (response)", u8Sink = (uint8_t) vp932i_ctx_read_n(&g_ctx, buf, sizeof(buf)));
+	drain();
+
+	(void) u8Sink;
+}
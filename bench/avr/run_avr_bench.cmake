@@ -0,0 +1,58 @@
+# Runs every AVR benchmark image under simavr and prints the cycle counts along with each interpreter's flash/SRAM cost.
+# Invoked by the avr_bench target: cmake -DRUN_AVR=... -DAVR_SIZE=... -DIMAGE_DIR=... -DIMAGES=baseline|ldv1000|... -P run_avr_bench.cmake
+
+string(REPLACE "|" ";" IMAGES "${IMAGES}")
+
+# returns flash (text + data) and SRAM (data + bss) of an .elf, as reported by avr-size in berkeley format
+function(get_avr_size elf out_flash out_sram)
+    execute_process(COMMAND ${AVR_SIZE} --format=berkeley ${elf} OUTPUT_VARIABLE out RESULT_VARIABLE res)
+    if (NOT res EQUAL 0)
+        message(FATAL_ERROR "avr-size failed on ${elf}")
+    endif()
+    string(REGEX MATCH "\n[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)" unused "${out}")
+    math(EXPR flash "${CMAKE_MATCH_1} + ${CMAKE_MATCH_2}")
+    math(EXPR sram "${CMAKE_MATCH_2} + ${CMAKE_MATCH_3}")
+    set(${out_flash} ${flash} PARENT_SCOPE)
+    set(${out_sram} ${sram} PARENT_SCOPE)
+endfunction()
+
+get_avr_size(${IMAGE_DIR}/avr_bench_baseline.elf base_flash base_sram)
+
+set(size_report "interpreter   flash  sram  (bytes added over the bare harness, including libc/libgcc helpers it pulls in)\n")
+
+foreach(image ${IMAGES})
+    set(elf ${IMAGE_DIR}/avr_bench_${image}.elf)
+
+    execute_process(COMMAND ${RUN_AVR} ${elf} OUTPUT_VARIABLE out ERROR_VARIABLE err RESULT_VARIABLE res)
+
+    # simavr prints the console output on stderr with a prefix; only keep our lines
+    string(REPLACE "\n" ";" lines "${out}${err}")
+    set(found_end FALSE)
+    foreach(line ${lines})
+        if (line MATCHES "(# .*|[a-z0-9_]+ .* ([0-9]+|>65535))$")
+            message("${CMAKE_MATCH_1}")
+            if (CMAKE_MATCH_1 STREQUAL "# end")
+                set(found_end TRUE)
+            endif()
+        endif()
+    endforeach()
+
+    if (NOT found_end)
+        message(FATAL_ERROR "avr_bench_${image}.elf did not run to completion:\n${out}${err}")
+    endif()
+
+    if (NOT image STREQUAL "baseline")
+        get_avr_size(${elf} flash sram)
+        math(EXPR flash "${flash} - ${base_flash}")
+        math(EXPR sram "${sram} - ${base_sram}")
+        string(APPEND size_report "${image}")
+        string(LENGTH "${image}" len)
+        foreach(i RANGE ${len} 13)
+            string(APPEND size_report " ")
+        endforeach()
+        string(APPEND size_report "${flash}  ${sram}\n")
+    endif()
+endforeach()
+
+message("")
+message("${size_report}")
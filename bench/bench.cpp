@@ -0,0 +1,77 @@
+#include "bench.h"
+#include "instr_counter.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+static volatile uint32_t g_u32Sink = 0;
+
+void bench_sink(uint32_t u32Val)
+{
+	g_u32Sink += u32Val;
+}
+
+static void run_case(const BenchCase_t *pCase, uint32_t u32MinMs, InstrCounter &instr)
+{
+	typedef std::chrono::steady_clock clock_t;
+	uint64_t u64Batches = 1;
+	double dElapsedNs = 0;
+
+	if (pCase->pSetup) pCase->pSetup(pCase->pArg);
+
+	// warm up and find a batch count that runs for at least u32MinMs
+	for (;;)
+	{
+		clock_t::time_point start = clock_t::now();
+		for (uint64_t u = 0; u < u64Batches; u++)
+		{
+			pCase->pFunc(pCase->pArg);
+		}
+		dElapsedNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+
+		if (dElapsedNs >= u32MinMs * 1000000.0) break;
+		u64Batches *= 2;
+	}
+
+	// count instructions in a separate pass so that the counter's overhead doesn't land in the timings
+	double dInstrPerCmd = -1;
+	if (instr.IsAvailable() && (pCase->u32CmdsPerBatch != 0))
+	{
+		instr.Start();
+		for (uint64_t u = 0; u < u64Batches; u++)
+		{
+			pCase->pFunc(pCase->pArg);
+		}
+		dInstrPerCmd = (double) instr.Stop() / ((double) u64Batches * pCase->u32CmdsPerBatch);
+	}
+
+	double dNsPerByte = dElapsedNs / ((double) u64Batches * pCase->u32BytesPerBatch);
+	double dCallsPerSec = ((double) u64Batches * pCase->u32CallsPerBatch) / (dElapsedNs / 1e9);
+
+	if (dInstrPerCmd >= 0)
+	{
+		printf("%-32s %10.2f %14.0f %12.1f\n", pCase->pszName, dNsPerByte, dCallsPerSec, dInstrPerCmd);
+	}
+	else
+	{
+		printf("%-32s %10.2f %14.0f %12s\n", pCase->pszName, dNsPerByte, dCallsPerSec, "n/a");
+	}
+}
+
+void bench_run_all(const BenchCase_t *pCases, uint32_t u32Count, const char *pszFilter, uint32_t u32MinMs)
+{
+	InstrCounter instr;
+
+	printf("%-32s %10s %14s %12s\n", "case", "ns/byte", "calls/sec", "instr/cmd");
+
+	for (uint32_t u = 0; u < u32Count; u++)
+	{
+		if (pszFilter && !strstr(pCases[u].pszName, pszFilter)) continue;
+		run_case(&pCases[u], u32MinMs, instr);
+	}
+
+	if (!instr.IsAvailable())
+	{
+		printf("(instruction counts need perf_event_open; try lowering /proc/sys/kernel/perf_event_paranoid)\n");
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef LDP_IN_BENCH_H
+#define LDP_IN_BENCH_H
+
+#include <stdint.h>
+
+// Minimal host benchmark harness.
+// It has no dependencies beyond the C++ standard library so that it builds anywhere the unit tests build.
+
+// Runs one batch of work (for example, one complete command and the reads of its response).
+typedef void (*BenchFunc_t)(void *pArg);
+
+typedef struct
+{
+	const char *pszName;
+	BenchFunc_t pFunc;
+	void *pArg;
+	void (*pSetup)(void *pArg);	// optional, called once before timing starts (reset the interpreter here)
+	uint32_t u32BytesPerBatch;	// bytes/messages moved across the interpreter's interface per batch (for ns/byte)
+	uint32_t u32CallsPerBatch;	// calls into the interpreter's public entry points per batch (for calls/sec)
+	uint32_t u32CmdsPerBatch;	// complete commands per batch (for instructions/command)
+} BenchCase_t;
+
+// Runs every case and prints one line of results per case.
+// If pszFilter is not null, only cases whose name contains it are run.
+// u32MinMs is roughly how long each case is timed for.
+void bench_run_all(const BenchCase_t *pCases, uint32_t u32Count, const char *pszFilter, uint32_t u32MinMs);
+
+// Keeps the compiler from optimizing away a result that is otherwise unused.
+void bench_sink(uint32_t u32Val);
+
+#endif // LDP_IN_BENCH_H
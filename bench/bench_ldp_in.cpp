@@ -0,0 +1,406 @@
+// Host micro-benchmarks for the interpreters' hot paths.
+// Every callback is a no-op stub (get_status and friends just return what the stub player was told to return),
+//  so the numbers are the cost of the interpreter itself.
+
+#include "bench.h"
+#include "stubs.h"
+#include <ldp-in/convert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_COUNT(a) ((uint32_t) (sizeof(a) / sizeof((a)[0])))
+
+/////////////////////////////////////////////////////////////////
+// LD-V1000
+
+struct LDV1000Bench
+{
+	LDV1000Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void ldv1000_setup_playing(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	p->player.iStatus = LDV1000_PLAYING;
+	p->player.u32Frame = 1000;
+	ldv1000i_ctx_init(&p->ctx, &ldv1000_stubs::cb, &p->player);
+	ldv1000i_ctx_reset(&p->ctx, LDV1000_EMU_STANDARD);
+	ldv1000i_ctx_write(&p->ctx, 0xFD);	// play
+	ldv1000i_ctx_write(&p->ctx, 0xFF);
+}
+
+// same, with the host notifying the interpreter of status and frame changes
+static void ldv1000_setup_notified(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	ldv1000_setup_playing(pArg);
+	ldv1000i_ctx_set_status(&p->ctx, LDV1000_PLAYING);
+	ldv1000i_ctx_set_cur_frame_num(&p->ctx, p->player.u32Frame);
+}
+
+#define LDV1000_POLLS 64
+
+// the status strobe loop that every LD-V1000 game spends most of its time in
+static void ldv1000_status_poll(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	uint32_t u32Sum = 0;
+
+	for (int i = 0; i < LDV1000_POLLS; i++)
+	{
+		u32Sum += ldv1000i_ctx_read(&p->ctx);
+	}
+	bench_sink(u32Sum);
+}
+
+// NO ENTRY, get current frame (0xC2), then strobe out the 5 digits
+static void ldv1000_send_frame_query(LDV1000Bench *p)
+{
+	uint32_t u32Sum = 0;
+
+	ldv1000i_ctx_write(&p->ctx, 0xFF);
+	ldv1000i_ctx_write(&p->ctx, 0xC2);
+	for (int i = 0; i < 5; i++)
+	{
+		u32Sum += ldv1000i_ctx_read(&p->ctx);
+	}
+	bench_sink(u32Sum);
+}
+
+static void ldv1000_frame_query(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	p->player.u32Frame = (p->player.u32Frame + 1) % 54000;
+	ldv1000_send_frame_query(p);
+}
+
+// same, with the host supplying the frame number at each vblank
+static void ldv1000_frame_query_cached(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	p->player.u32Frame = (p->player.u32Frame + 1) % 54000;
+	ldv1000i_ctx_set_cur_frame_num(&p->ctx, p->player.u32Frame);
+	ldv1000_send_frame_query(p);
+}
+
+// enter 5 digits and SEARCH (each byte preceded by NO ENTRY, like the games do), then poll until the search completes
+static const uint8_t g_ldv1000_search[] = { 0xFF, 0x0F, 0xFF, 0x8F, 0xFF, 0x4F, 0xFF, 0x2F, 0xFF, 0xAF, 0xFF, 0xF7 };
+#define LDV1000_SEARCH_POLLS 6
+
+static void ldv1000_search(void *pArg)
+{
+	LDV1000Bench *p = (LDV1000Bench *) pArg;
+	uint32_t u32Sum = 0;
+
+	p->player.iStatus = LDV1000_PAUSED;	// search completes as soon as the delay iterations run out
+	ldv1000i_ctx_write_n(&p->ctx, g_ldv1000_search, sizeof(g_ldv1000_search));
+	for (int i = 0; i < LDV1000_SEARCH_POLLS; i++)
+	{
+		u32Sum += ldv1000i_ctx_read(&p->ctx);
+	}
+	bench_sink(u32Sum);
+}
+
+/////////////////////////////////////////////////////////////////
+// LDP-1000/1450
+
+struct LDP1000Bench
+{
+	LDP1000Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void ldp1450_setup(void *pArg)
+{
+	LDP1000Bench *p = (LDP1000Bench *) pArg;
+	p->player.iStatus = LDP1000_PLAYING;
+	p->player.u32Frame = 1000;
+	ldp1000i_ctx_init(&p->ctx, &ldp1000_stubs::cb, &p->player);
+	ldp1000i_ctx_reset(&p->ctx, LDP1000_EMU_LDP1450);
+}
+
+// sends one command byte and drains the response the way a UART host would
+static uint32_t ldp1000_cmd(LDP1000Ctx_t *pCtx, uint8_t u8Cmd)
+{
+	uint32_t u32Sum = 0;
+	ldp1000i_ctx_write(pCtx, u8Cmd);
+	while (ldp1000i_ctx_can_read(pCtx))
+	{
+		u32Sum += ldp1000i_ctx_read(pCtx);
+	}
+	return u32Sum;
+}
+
+// ADDR INQ (0x60), 5 digit response
+static void ldp1450_addr_inq(void *pArg)
+{
+	LDP1000Bench *p = (LDP1000Bench *) pArg;
+	p->player.u32Frame = (p->player.u32Frame + 1) % 54000;
+	bench_sink(ldp1000_cmd(&p->ctx, 0x60));
+}
+
+// same, with the host supplying the frame number at each vblank
+static void ldp1450_addr_inq_cached(void *pArg)
+{
+	LDP1000Bench *p = (LDP1000Bench *) pArg;
+	p->player.u32Frame = (p->player.u32Frame + 1) % 54000;
+	ldp1000i_ctx_set_cur_frame_num(&p->ctx, p->player.u32Frame);
+	bench_sink(ldp1000_cmd(&p->ctx, 0x60));
+}
+
+// status inquiry (0x67), 5 byte response
+static void ldp1450_status_inq(void *pArg)
+{
+	LDP1000Bench *p = (LDP1000Bench *) pArg;
+	bench_sink(ldp1000_cmd(&p->ctx, 0x67));
+}
+
+// SEARCH 12345 ENTER, then the vblank that sees the search complete
+static const uint8_t g_ldp1000_search[] = { 0x43, '1', '2', '3', '4', '5', 0x40 };
+
+static void ldp1450_search(void *pArg)
+{
+	LDP1000Bench *p = (LDP1000Bench *) pArg;
+	uint32_t u32Sum = 0;
+
+	for (uint32_t u = 0; u < sizeof(g_ldp1000_search); u++)
+	{
+		u32Sum += ldp1000_cmd(&p->ctx, g_ldp1000_search[u]);
+	}
+	p->player.iStatus = LDP1000_PAUSED;
+	ldp1000i_ctx_think_during_vblank(&p->ctx);
+	u32Sum += ldp1000i_ctx_read(&p->ctx);	// search complete
+	bench_sink(u32Sum);
+}
+
+/////////////////////////////////////////////////////////////////
+// PR-8210
+
+struct PR8210Bench
+{
+	PR8210Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void pr8210_setup(void *pArg)
+{
+	PR8210Bench *p = (PR8210Bench *) pArg;
+	p->player.iStatus = 0;	// not busy
+	pr8210i_ctx_init(&p->ctx, &pr8210_stubs::cb, &p->player);
+}
+
+#define PR8210_MSG(cmd) ((uint16_t) (4 | ((cmd) << 3)))
+
+// each message is sent twice, like the games do; 5 digits, SEARCH, then filler
+static const uint16_t g_pr8210_search[] =
+{
+	PR8210_MSG(0x11), PR8210_MSG(0x11), PR8210_MSG(0x12), PR8210_MSG(0x12), PR8210_MSG(0x13), PR8210_MSG(0x13),
+	PR8210_MSG(0x14), PR8210_MSG(0x14), PR8210_MSG(0x15), PR8210_MSG(0x15), PR8210_MSG(0xB), PR8210_MSG(0xB),
+	PR8210_MSG(0), PR8210_MSG(0)
+};
+
+static void pr8210_search(void *pArg)
+{
+	PR8210Bench *p = (PR8210Bench *) pArg;
+
+	for (uint32_t u = 0; u < ARRAY_COUNT(g_pr8210_search); u++)
+	{
+		pr8210i_ctx_write(&p->ctx, g_pr8210_search[u]);
+	}
+	pr8210i_ctx_on_vblank(&p->ctx);	// player is not busy so stand by drops
+}
+
+/////////////////////////////////////////////////////////////////
+// LD-700
+
+struct LD700Bench
+{
+	LD700Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void ld700_setup(void *pArg)
+{
+	LD700Bench *p = (LD700Bench *) pArg;
+	ld700i_ctx_init(&p->ctx, &ld700_stubs::cb, &p->player);
+	ld700i_ctx_reset(&p->ctx);
+}
+
+// prepare for frame number, 5 digits, begin search
+static const uint8_t g_ld700_search[] = { 0x41, 1, 2, 3, 4, 5, 0x42 };
+
+static void ld700_search(void *pArg)
+{
+	LD700Bench *p = (LD700Bench *) pArg;
+
+	for (uint32_t u = 0; u < sizeof(g_ld700_search); u++)
+	{
+		uint8_t u8Cmd = g_ld700_search[u];
+		ld700i_ctx_on_new_cmd(&p->ctx);
+		ld700i_ctx_write(&p->ctx, 0xA8, LD700_PAUSED);
+		ld700i_ctx_write(&p->ctx, 0x57, LD700_PAUSED);
+		ld700i_ctx_write(&p->ctx, u8Cmd, LD700_PAUSED);
+		ld700i_ctx_write(&p->ctx, u8Cmd ^ 0xFF, LD700_PAUSED);
+		ld700i_ctx_on_vblank(&p->ctx, LD700_PAUSED);
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+// VP931
+
+struct VP931Bench
+{
+	VP931Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void vp931_setup(void *pArg)
+{
+	VP931Bench *p = (VP931Bench *) pArg;
+	vp931i_ctx_init(&p->ctx, &vp931_stubs::cb, &p->player);
+	vp931i_ctx_reset(&p->ctx);
+}
+
+// goto+halt 12345, jump 123 tracks forward, goto+play 500, play (what Firefox sends in a busy field)
+static const uint8_t g_vp931_cmds[] = { 0xD1, 0x23, 0x45, 0x00, 0xE1, 0x23, 0xF0, 0x05, 0x00, 0x00, 0x00, 0x00 };
+
+static void vp931_vsync_batch(void *pArg)
+{
+	VP931Bench *p = (VP931Bench *) pArg;
+	vp931i_ctx_on_vsync(&p->ctx, g_vp931_cmds, sizeof(g_vp931_cmds), VP931_PAUSED);
+}
+
+/////////////////////////////////////////////////////////////////
+// VP932
+
+struct VP932Bench
+{
+	VP932Ctx_t ctx;
+	StubPlayer player;
+};
+
+static void vp932_setup(void *pArg)
+{
+	VP932Bench *p = (VP932Bench *) pArg;
+	vp932i_ctx_init(&p->ctx, &vp932_stubs::cb, &p->player);
+	vp932i_ctx_reset(&p->ctx);
+}
+
+// two different frames so that the "already searched here" shortcut is never taken
+static const char g_vp932_lines[] = "F12345R\rF00100N\r";
+
+static void vp932_search_lines(void *pArg)
+{
+	VP932Bench *p = (VP932Bench *) pArg;
+	const uint8_t *p8Line = (const uint8_t *) g_vp932_lines;
+	uint8_t buf[8];
+	uint32_t u32Sum = 0;
+
+	for (int i = 0; i < 2; i++)
+	{
+		vp932i_ctx_write_n(&p->ctx, p8Line, 8);
+		p8Line += 8;
+		vp932i_ctx_think_during_vblank(&p->ctx, VP932_PAUSED);
+		u32Sum += vp932i_ctx_read_n(&p->ctx, buf, sizeof(buf));	// A0 or A1 and CR
+	}
+	bench_sink(u32Sum);
+}
+
+/////////////////////////////////////////////////////////////////
+// Frame number conversions (shared by all interpreters)
+
+#define CONVERT_FRAMES 64
+
+// spread over the whole range so that every digit position changes
+static void convert_to_ascii5(void *)
+{
+	uint8_t s[5];
+	uint32_t u32Sum = 0;
+	for (uint32_t u = 0; u < CONVERT_FRAMES; u++)
+	{
+		ldpin_u32_to_ascii5(u * 1562 + 7, s);
+		u32Sum += s[0] + s[4];
+	}
+	bench_sink(u32Sum);
+}
+
+static void convert_from_ascii5(void *)
+{
+	static const char *arr[] = { "12345", "00001", "99999", "54321" };
+	uint32_t u32Sum = 0;
+	for (uint32_t u = 0; u < CONVERT_FRAMES; u++)
+	{
+		u32Sum += ldpin_ascii5_to_u32(arr[u & 3]);
+	}
+	bench_sink(u32Sum);
+}
+
+static void convert_from_bcd5(void *)
+{
+	uint32_t u32Sum = 0;
+	for (uint32_t u = 0; u < CONVERT_FRAMES; u++)
+	{
+		u32Sum += ldpin_bcd5_to_u32((uint8_t) (u & 7), 0x23, (uint8_t) (0x40 | (u & 7)));
+	}
+	bench_sink(u32Sum);
+}
+
+/////////////////////////////////////////////////////////////////
+
+static LDV1000Bench g_ldv1000;
+static LDP1000Bench g_ldp1000;
+static PR8210Bench g_pr8210;
+static LD700Bench g_ld700;
+static VP931Bench g_vp931;
+static VP932Bench g_vp932;
+
+// bytes, calls and commands are per batch
+static const BenchCase_t g_cases[] =
+{
+	{ "ldv1000_status_poll", ldv1000_status_poll, &g_ldv1000, ldv1000_setup_playing, LDV1000_POLLS, LDV1000_POLLS, LDV1000_POLLS },
+	{ "ldv1000_status_poll_notified", ldv1000_status_poll, &g_ldv1000, ldv1000_setup_notified, LDV1000_POLLS, LDV1000_POLLS, LDV1000_POLLS },
+	{ "ldv1000_frame_query_c2", ldv1000_frame_query, &g_ldv1000, ldv1000_setup_playing, 7, 7, 1 },
+	{ "ldv1000_frame_query_c2_cached", ldv1000_frame_query_cached, &g_ldv1000, ldv1000_setup_playing, 7, 8, 1 },
+	{ "ldv1000_search_f7", ldv1000_search, &g_ldv1000, ldv1000_setup_playing,
+		sizeof(g_ldv1000_search) + LDV1000_SEARCH_POLLS, 1 + LDV1000_SEARCH_POLLS, 1 },
+	{ "ldp1450_addr_inq_60", ldp1450_addr_inq, &g_ldp1000, ldp1450_setup, 6, 1 + 6 + 5, 1 },
+	{ "ldp1450_addr_inq_60_cached", ldp1450_addr_inq_cached, &g_ldp1000, ldp1450_setup, 6, 2 + 6 + 5, 1 },
+	{ "ldp1450_status_inq_67", ldp1450_status_inq, &g_ldp1000, ldp1450_setup, 6, 1 + 6 + 5, 1 },
+	{ "ldp1450_search_43", ldp1450_search, &g_ldp1000, ldp1450_setup,
+		sizeof(g_ldp1000_search) * 2 + 1, sizeof(g_ldp1000_search) * 3 + 2, 1 },
+	{ "pr8210_search_msgs", pr8210_search, &g_pr8210, pr8210_setup, ARRAY_COUNT(g_pr8210_search), ARRAY_COUNT(g_pr8210_search) + 1, 1 },
+	{ "ld700_search_frames", ld700_search, &g_ld700, ld700_setup, sizeof(g_ld700_search) * 4, sizeof(g_ld700_search) * 6, sizeof(g_ld700_search) },
+	{ "vp931_vsync_batch", vp931_vsync_batch, &g_vp931, vp931_setup, sizeof(g_vp931_cmds), 1, sizeof(g_vp931_cmds) / 3 },
+	{ "vp932_search_lines", vp932_search_lines, &g_vp932, vp932_setup, 16 + 6, 6, 2 },
+	{ "convert_u32_to_ascii5", convert_to_ascii5, 0, 0, CONVERT_FRAMES * 5, CONVERT_FRAMES, CONVERT_FRAMES },
+	{ "convert_ascii5_to_u32", convert_from_ascii5, 0, 0, CONVERT_FRAMES * 5, CONVERT_FRAMES, CONVERT_FRAMES },
+	{ "convert_bcd5_to_u32", convert_from_bcd5, 0, 0, CONVERT_FRAMES * 3, CONVERT_FRAMES, CONVERT_FRAMES },
+};
+
+int main(int argc, char **argv)
+{
+	const char *pszFilter = 0;
+	uint32_t u32MinMs = 200;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--ms") == 0) && (i + 1 < argc))
+		{
+			u32MinMs = (uint32_t) atoi(argv[++i]);
+		}
+		else if (argv[i][0] != '-')
+		{
+			pszFilter = argv[i];
+		}
+		else
+		{
+			printf("usage: %s [--ms <min ms per case>] [case name filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bench_run_all(g_cases, ARRAY_COUNT(g_cases), pszFilter, u32MinMs);
+	return 0;
+}
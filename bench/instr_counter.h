@@ -0,0 +1,67 @@
+#ifndef LDP_IN_BENCH_INSTR_COUNTER_H
+#define LDP_IN_BENCH_INSTR_COUNTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Counts user-space instructions retired using the kernel's perf counters.
+// Not every machine (or container) allows this, so check IsAvailable before relying on the counts.
+class InstrCounter
+{
+public:
+	InstrCounter()
+	{
+#ifdef __linux__
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		m_fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+	}
+
+	~InstrCounter()
+	{
+#ifdef __linux__
+		if (m_fd >= 0) close(m_fd);
+#endif
+	}
+
+	bool IsAvailable() const { return m_fd >= 0; }
+
+	void Start()
+	{
+#ifdef __linux__
+		if (m_fd < 0) return;
+		ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+		ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+
+	uint64_t Stop()
+	{
+		uint64_t u64Count = 0;
+#ifdef __linux__
+		if (m_fd < 0) return 0;
+		ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+		if (read(m_fd, &u64Count, sizeof(u64Count)) != sizeof(u64Count)) u64Count = 0;
+#endif
+		return u64Count;
+	}
+
+private:
+	int m_fd = -1;
+};
+
+#endif // LDP_IN_BENCH_INSTR_COUNTER_H
@@ -0,0 +1,337 @@
+// How much memory the rewind buffer (see rewind.h) needs per minute of play, and what it costs per vblank.
+// Each case plays a scripted session against the stub player: the polling a game does every vblank, with the frame number advancing,
+//  and a search every 10 seconds.  After every vblank the interpreter is saved and the snapshot pushed into a rewind buffer that is
+//  big enough to keep everything, so the bytes used at the end are what that much play costs.
+
+#include "stubs.h"
+#include <ldp-in/rewind.h>
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VBLANKS_PER_MINUTE 3596	// 59.94 Hz
+#define SEARCH_INTERVAL 599	// vblanks between searches (about 10 seconds)
+#define REWIND_MEM_SIZE (64 * 1024 * 1024)
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+struct RewindCase
+{
+	const char *pszName;
+	uint16_t u16SnapSize;
+	void (*pSetup)();
+	void (*pVBlank)(uint32_t u32VBlank);	// plays one vblank's worth of traffic
+	void (*pSave)(void *pSnap);
+};
+
+static StubPlayer g_player;
+
+/////////////////////////////////////////////////////////////////
+// LD-V1000: status strobe every vblank, frame inquiry (C2) every other one
+
+static LDV1000Ctx_t g_ldv1000;
+static const uint8_t g_ldv1000_search[] = { 0xFF, 0x0F, 0xFF, 0x8F, 0xFF, 0x4F, 0xFF, 0x2F, 0xFF, 0xAF, 0xFF, 0xF7 };
+
+static void ldv1000_setup()
+{
+	g_player.iStatus = LDV1000_PLAYING;
+	g_player.u32Frame = 1000;
+	ldv1000i_ctx_init(&g_ldv1000, &ldv1000_stubs::cb, &g_player);
+	ldv1000i_ctx_reset(&g_ldv1000, LDV1000_EMU_STANDARD);
+}
+
+static void ldv1000_vblank(uint32_t u32VBlank)
+{
+	g_player.u32Frame++;
+	ldv1000i_ctx_set_cur_frame_num(&g_ldv1000, g_player.u32Frame);
+
+	if ((u32VBlank % SEARCH_INTERVAL) == 0)
+	{
+		ldv1000i_ctx_write_n(&g_ldv1000, g_ldv1000_search, sizeof(g_ldv1000_search));
+	}
+	else if (u32VBlank & 1)
+	{
+		ldv1000i_ctx_write(&g_ldv1000, 0xFF);
+		ldv1000i_ctx_write(&g_ldv1000, 0xC2);
+		for (int i = 0; i < 5; i++)
+		{
+			ldv1000i_ctx_read(&g_ldv1000);
+		}
+	}
+	ldv1000i_ctx_read(&g_ldv1000);
+}
+
+static void ldv1000_save(void *pSnap) { ldv1000i_ctx_save(&g_ldv1000, (LDV1000Snapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+// LDP-1450: current address inquiry (60) every vblank
+
+static LDP1000Ctx_t g_ldp1000;
+static const uint8_t g_ldp1000_search[] = { 0x43, '1', '2', '3', '4', '5', 0x40 };
+
+static void ldp1000_cmd(uint8_t u8Cmd)
+{
+	ldp1000i_ctx_write(&g_ldp1000, u8Cmd);
+	while (ldp1000i_ctx_can_read(&g_ldp1000))
+	{
+		ldp1000i_ctx_read(&g_ldp1000);
+	}
+}
+
+static void ldp1450_setup()
+{
+	g_player.iStatus = LDP1000_PLAYING;
+	g_player.u32Frame = 1000;
+	ldp1000i_ctx_init(&g_ldp1000, &ldp1000_stubs::cb, &g_player);
+	ldp1000i_ctx_reset(&g_ldp1000, LDP1000_EMU_LDP1450);
+}
+
+static void ldp1450_vblank(uint32_t u32VBlank)
+{
+	g_player.u32Frame++;
+	ldp1000i_ctx_set_cur_frame_num(&g_ldp1000, g_player.u32Frame);
+
+	if ((u32VBlank % SEARCH_INTERVAL) == 0)
+	{
+		for (uint32_t u = 0; u < sizeof(g_ldp1000_search); u++)
+		{
+			ldp1000_cmd(g_ldp1000_search[u]);
+		}
+	}
+	ldp1000_cmd(0x60);
+	ldp1000i_ctx_think_during_vblank(&g_ldp1000);
+}
+
+static void ldp1450_save(void *pSnap) { ldp1000i_ctx_save(&g_ldp1000, (LDP1000Snapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+// PR-8210: nothing but the vblank between searches
+
+static PR8210Ctx_t g_pr8210;
+
+#define PR8210_MSG(cmd) ((uint16_t) (4 | ((cmd) << 3)))
+static const uint16_t g_pr8210_search[] =
+{
+	PR8210_MSG(0x11), PR8210_MSG(0x11), PR8210_MSG(0x12), PR8210_MSG(0x12), PR8210_MSG(0x13), PR8210_MSG(0x13),
+	PR8210_MSG(0x14), PR8210_MSG(0x14), PR8210_MSG(0x15), PR8210_MSG(0x15), PR8210_MSG(0xB), PR8210_MSG(0xB),
+	PR8210_MSG(0), PR8210_MSG(0)
+};
+
+static void pr8210_setup()
+{
+	g_player.iStatus = 0;
+	pr8210i_ctx_init(&g_pr8210, &pr8210_stubs::cb, &g_player);
+}
+
+static void pr8210_vblank(uint32_t u32VBlank)
+{
+	if ((u32VBlank % SEARCH_INTERVAL) == 0)
+	{
+		for (uint32_t u = 0; u < sizeof(g_pr8210_search) / sizeof(g_pr8210_search[0]); u++)
+		{
+			pr8210i_ctx_write(&g_pr8210, g_pr8210_search[u]);
+		}
+	}
+	pr8210i_ctx_on_vblank(&g_pr8210);
+}
+
+static void pr8210_save(void *pSnap) { pr8210i_ctx_save(&g_pr8210, (PR8210Snapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+// LD-700: one command per vblank while searching, EXT_ACK' timing otherwise
+
+static LD700Ctx_t g_ld700;
+static const uint8_t g_ld700_search[] = { 0x41, 1, 2, 3, 4, 5, 0x42 };
+
+static void ld700_setup()
+{
+	ld700i_ctx_init(&g_ld700, &ld700_stubs::cb, &g_player);
+	ld700i_ctx_reset(&g_ld700);
+}
+
+static void ld700_vblank(uint32_t u32VBlank)
+{
+	uint32_t u32Step = u32VBlank % SEARCH_INTERVAL;
+
+	if (u32Step < sizeof(g_ld700_search))
+	{
+		uint8_t u8Cmd = g_ld700_search[u32Step];
+		ld700i_ctx_on_new_cmd(&g_ld700);
+		ld700i_ctx_write(&g_ld700, 0xA8, LD700_PLAYING);
+		ld700i_ctx_write(&g_ld700, 0x57, LD700_PLAYING);
+		ld700i_ctx_write(&g_ld700, u8Cmd, LD700_PLAYING);
+		ld700i_ctx_write(&g_ld700, u8Cmd ^ 0xFF, LD700_PLAYING);
+	}
+	ld700i_ctx_on_vblank(&g_ld700, LD700_PLAYING);
+}
+
+static void ld700_save(void *pSnap) { ld700i_ctx_save(&g_ld700, (LD700Snapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+// VP932: searches only
+
+static VP932Ctx_t g_vp932;
+static const char g_vp932_search[] = "F12345R\r";
+
+static void vp932_setup()
+{
+	vp932i_ctx_init(&g_vp932, &vp932_stubs::cb, &g_player);
+	vp932i_ctx_reset(&g_vp932);
+}
+
+static void vp932_vblank(uint32_t u32VBlank)
+{
+	uint8_t buf[8];
+
+	if ((u32VBlank % SEARCH_INTERVAL) == 0)
+	{
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) g_vp932_search, 8);
+	}
+	vp932i_ctx_think_during_vblank(&g_vp932, VP932_PLAYING);
+	vp932i_ctx_read_n(&g_vp932, buf, sizeof(buf));
+}
+
+static void vp932_save(void *pSnap) { vp932i_ctx_save(&g_vp932, (VP932Snapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+// VIP9500SG: get current frame (6B) every vblank
+
+static VIP9500SGCtx_t g_vip9500sg;
+static const uint8_t g_vip9500sg_search[] = { 0x2b, '1', '2', '3', '4', '5', 0x41 };
+
+static void vip9500sg_setup()
+{
+	g_player.iStatus = VIP9500SG_PLAYING;
+	g_player.u32Frame = 1000;
+	vip9500sgi_ctx_init(&g_vip9500sg, &vip9500sg_stubs::cb, &g_player);
+	vip9500sgi_ctx_reset(&g_vip9500sg);
+}
+
+static void vip9500sg_vblank(uint32_t u32VBlank)
+{
+	uint8_t buf[8];
+
+	g_player.u32Frame++;
+	vip9500sgi_ctx_set_cur_frame_num(&g_vip9500sg, g_player.u32Frame);
+
+	if ((u32VBlank % SEARCH_INTERVAL) == 0)
+	{
+		vip9500sgi_ctx_write_n(&g_vip9500sg, g_vip9500sg_search, sizeof(g_vip9500sg_search));
+	}
+	vip9500sgi_ctx_write(&g_vip9500sg, 0x6b);
+	vip9500sgi_ctx_think_after_vblank(&g_vip9500sg);
+	vip9500sgi_ctx_read_n(&g_vip9500sg, buf, sizeof(buf));
+}
+
+static void vip9500sg_save(void *pSnap) { vip9500sgi_ctx_save(&g_vip9500sg, (VIP9500SGSnapshot_t *) pSnap); }
+
+/////////////////////////////////////////////////////////////////
+
+static const RewindCase g_cases[] =
+{
+	{ "ldv1000", sizeof(LDV1000Snapshot_t), ldv1000_setup, ldv1000_vblank, ldv1000_save },
+	{ "ldp1450", sizeof(LDP1000Snapshot_t), ldp1450_setup, ldp1450_vblank, ldp1450_save },
+	{ "pr8210", sizeof(PR8210Snapshot_t), pr8210_setup, pr8210_vblank, pr8210_save },
+	{ "ld700", sizeof(LD700Snapshot_t), ld700_setup, ld700_vblank, ld700_save },
+	{ "vp932", sizeof(VP932Snapshot_t), vp932_setup, vp932_vblank, vp932_save },
+	{ "vip9500sg", sizeof(VIP9500SGSnapshot_t), vip9500sg_setup, vip9500sg_vblank, vip9500sg_save },
+};
+
+static void run_case(const RewindCase &c, uint32_t u32Minutes, uint16_t u16KeyInterval, std::vector<uint32_t> &mem)
+{
+	LDPInRewind_t rw;
+	uint8_t snap[1024];
+	uint32_t u32VBlanks = u32Minutes * VBLANKS_PER_MINUTE;
+	double dPushNs = 0;
+
+	if (!ldpin_rewind_init(&rw, mem.data(), (uint32_t) (mem.size() * sizeof(uint32_t)), c.u16SnapSize, u16KeyInterval, 0))
+	{
+		printf("%-12s can't set up the rewind buffer\n", c.pszName);
+		return;
+	}
+
+	c.pSetup();
+
+	for (uint32_t u = 0; u < u32VBlanks; u++)
+	{
+		c.pVBlank(u);
+
+		bench_clock_t::time_point start = bench_clock_t::now();
+		c.pSave(snap);
+		ldpin_rewind_push(&rw, snap);
+		dPushNs += (double) std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock_t::now() - start).count();
+	}
+
+	// everything must still be there, or the memory figure would be too low
+	if (ldpin_rewind_oldest(&rw) != 0)
+	{
+		printf("%-12s the rewind buffer filled up; use fewer minutes\n", c.pszName);
+		return;
+	}
+
+	// rewinding to a random vblank (the worst case is the last one before a keyframe)
+	uint32_t u32Gets = 10000;
+	uint32_t u32Seed = 12345;
+	bench_clock_t::time_point start = bench_clock_t::now();
+	for (uint32_t u = 0; u < u32Gets; u++)
+	{
+		u32Seed = u32Seed * 1103515245 + 12345;
+		ldpin_rewind_get(&rw, (u32Seed >> 8) % u32VBlanks, snap);
+	}
+	double dGetNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock_t::now() - start).count() / u32Gets;
+
+	double dBytes = ldpin_rewind_bytes_used(&rw);
+	double dKeyBytes = (double) ((u32VBlanks + u16KeyInterval - 1) / u16KeyInterval) * (1 + c.u16SnapSize);
+
+	printf("%-12s %8u %12.0f %10.2f %10.2f %8.0f %8.0f\n", c.pszName, c.u16SnapSize, dBytes / u32Minutes, dBytes / u32VBlanks,
+		(dBytes - dKeyBytes) / (u32VBlanks - (u32VBlanks + u16KeyInterval - 1) / u16KeyInterval), dPushNs / u32VBlanks, dGetNs);
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszFilter = 0;
+	uint32_t u32Minutes = 1;
+	uint16_t u16KeyInterval = 60;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--minutes") == 0) && (i + 1 < argc))
+		{
+			u32Minutes = (uint32_t) atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--key") == 0) && (i + 1 < argc))
+		{
+			u16KeyInterval = (uint16_t) atoi(argv[++i]);
+		}
+		else if (argv[i][0] != '-')
+		{
+			pszFilter = argv[i];
+		}
+		else
+		{
+			printf("usage: %s [--minutes <n>] [--key <vblanks between keyframes>] [case name filter]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if ((u32Minutes == 0) || (u16KeyInterval == 0))
+	{
+		printf("--minutes and --key must be at least 1\n");
+		return 1;
+	}
+
+	std::vector<uint32_t> mem(REWIND_MEM_SIZE / sizeof(uint32_t));
+
+	printf("%u minute(s), a keyframe every %u vblanks\n", u32Minutes, u16KeyInterval);
+	printf("%-12s %8s %12s %10s %10s %8s %8s\n", "case", "snapshot", "bytes/min", "bytes/vbl", "diff bytes", "push ns", "get ns");
+
+	for (const RewindCase &c : g_cases)
+	{
+		if (pszFilter && !strstr(c.pszName, pszFilter)) continue;
+		run_case(c, u32Minutes, u16KeyInterval, mem);
+	}
+
+	return 0;
+}
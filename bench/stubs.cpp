@@ -0,0 +1,153 @@
+#include "stubs.h"
+
+namespace ldv1000_stubs
+{
+	LDV1000Status_t get_status(void *pUser) { return (LDV1000Status_t) ((StubPlayer *) pUser)->iStatus; }
+	uint32_t get_cur_frame_num(void *pUser) { return ((StubPlayer *) pUser)->u32Frame; }
+	void play(void *) { }
+	void pause(void *) { }
+	void begin_search(void *, uint32_t) { }
+	void step_reverse(void *) { }
+	void change_speed(void *, uint8_t, uint8_t) { }
+	void skip_forward(void *, uint8_t) { }
+	void skip_backward(void *, uint8_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	void on_error(void *, const char *) { }
+	const uint8_t *query_available_discs(void *) { static const uint8_t discs[] = { 1, 2, 0 }; return discs; }
+	uint8_t query_active_disc(void *pUser) { return ((StubPlayer *) pUser)->u8ActiveDisc; }
+	void begin_changing_to_disc(void *, uint8_t) { }
+	void change_seek_delay(void *, LDV1000_BOOL) { }
+	void change_spinup_delay(void *, LDV1000_BOOL) { }
+	void change_super_mode(void *, LDV1000_BOOL) { }
+
+	const LDV1000Callbacks_t cb =
+	{
+		get_status, get_cur_frame_num, play, pause, begin_search, step_reverse, change_speed, skip_forward, skip_backward,
+		change_audio, on_error, query_available_discs, query_active_disc, begin_changing_to_disc, change_seek_delay,
+		change_spinup_delay, change_super_mode
+	};
+}
+
+namespace ldp1000_stubs
+{
+	void play(void *, uint8_t, uint8_t, LDP1000_BOOL, LDP1000_BOOL) { }
+	void pause(void *) { }
+	void begin_search(void *, uint32_t) { }
+	void step_forward(void *) { }
+	void step_reverse(void *) { }
+	void skip(void *, int16_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	void change_video(void *, LDP1000_BOOL) { }
+	LDP1000Status_t get_status(void *pUser) { return (LDP1000Status_t) ((StubPlayer *) pUser)->iStatus; }
+	uint32_t get_cur_frame_num(void *pUser) { return ((StubPlayer *) pUser)->u32Frame; }
+	void text_enable_changed(void *, LDP1000_BOOL) { }
+	void text_buffer_contents_changed(void *, const uint8_t *) { }
+	void text_buffer_start_index_changed(void *, uint8_t) { }
+	void text_modes_changed(void *, uint8_t, uint8_t, uint8_t) { }
+	void error(void *, LDP1000ErrCode_t, uint8_t) { }
+
+	const LDP1000Callbacks_t cb =
+	{
+		play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed,
+		text_modes_changed, error
+	};
+}
+
+namespace pr7820_stubs
+{
+	PR7820Status_t get_status(void *pUser) { return (PR7820Status_t) ((StubPlayer *) pUser)->iStatus; }
+	void play(void *) { }
+	void pause(void *) { }
+	void begin_search(void *, unsigned int) { }
+	void change_audio(void *, unsigned char, unsigned char) { }
+	void enable_super_mode(void *) { }
+	void on_error(void *, PR7820ErrCode_t, unsigned char) { }
+
+	const PR7820Callbacks_t cb = { get_status, play, pause, begin_search, change_audio, enable_super_mode, on_error };
+}
+
+namespace pr8210_stubs
+{
+	void play(void *) { }
+	void pause(void *) { }
+	void step(void *, int8_t) { }
+	void begin_search(void *, uint32_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	void skip(void *, int8_t) { }
+	void change_auto_track_jump(void *, PR8210_BOOL) { }
+	PR8210_BOOL is_player_busy(void *pUser) { return (((StubPlayer *) pUser)->iStatus != 0) ? PR8210_TRUE : PR8210_FALSE; }
+	void change_standby(void *, PR8210_BOOL) { }
+	void error(void *, PR8210ErrCode_t, uint16_t) { }
+
+	const PR8210Callbacks_t cb =
+	{
+		play, pause, step, begin_search, change_audio, skip, change_auto_track_jump, is_player_busy, change_standby, error
+	};
+}
+
+namespace vip9500sg_stubs
+{
+	void play(void *) { }
+	void pause(void *) { }
+	void stop(void *) { }
+	void step_reverse(void *) { }
+	void begin_search(void *, uint32_t) { }
+	void skip(void *, int32_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	VIP9500SGStatus_t get_status(void *pUser) { return (VIP9500SGStatus_t) ((StubPlayer *) pUser)->iStatus; }
+	uint32_t get_cur_frame_num(void *pUser) { return ((StubPlayer *) pUser)->u32Frame; }
+	uint32_t get_cur_vbi_line18(void *pUser) { return 0xF80000 | ((StubPlayer *) pUser)->u32Frame; }
+	void error(void *, VIP9500SGErrCode_t, uint8_t) { }
+
+	const VIP9500SGCallbacks_t cb =
+	{
+		play, pause, stop, step_reverse, begin_search, skip, change_audio, get_status, get_cur_frame_num, get_cur_vbi_line18, error
+	};
+}
+
+namespace ld700_stubs
+{
+	void play(void *) { }
+	void pause(void *) { }
+	void stop(void *) { }
+	void eject(void *) { }
+	void step(void *, LD700_BOOL) { }
+	void begin_search(void *, uint32_t) { }
+	void change_audio(void *, LD700_BOOL, LD700_BOOL) { }
+	void change_audio_squelch(void *, LD700_BOOL) { }
+	uint32_t get_current_picnum(void *pUser) { return ((StubPlayer *) pUser)->u32Frame; }
+	void on_ext_ack_changed(void *, LD700_BOOL) { }
+	void error(void *, LD700ErrCode_t, uint8_t) { }
+
+	const LD700Callbacks_t cb =
+	{
+		play, pause, stop, eject, step, begin_search, change_audio, change_audio_squelch, get_current_picnum,
+		on_ext_ack_changed, error
+	};
+}
+
+namespace vp931_stubs
+{
+	void play(void *) { }
+	void pause(void *) { }
+	void begin_search(void *, uint32_t, VP931_BOOL) { }
+	void skip_tracks(void *, int16_t) { }
+	void skip_to_framenum(void *, uint32_t) { }
+	void error(void *, VP931ErrCode_t, uint8_t) { }
+
+	const VP931Callbacks_t cb = { play, pause, begin_search, skip_tracks, skip_to_framenum, error };
+}
+
+namespace vp932_stubs
+{
+	void play(void *, uint8_t, uint8_t, VP932_BOOL, VP932_BOOL) { }
+	void step(void *, VP932_BOOL) { }
+	void pause(void *) { }
+	void begin_search(void *, uint32_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	uint32_t get_cur_frame_num(void *pUser) { return ((StubPlayer *) pUser)->u32Frame; }
+	void error(void *, VP932ErrCode_t, uint8_t) { }
+
+	const VP932Callbacks_t cb = { play, step, pause, begin_search, change_audio, get_cur_frame_num, error };
+}
@@ -0,0 +1,33 @@
+#ifndef LDP_IN_BENCH_STUBS_H
+#define LDP_IN_BENCH_STUBS_H
+
+// No-op callbacks for every interpreter, shared by the host benchmark tools.
+// Pass a StubPlayer as the context's user pointer; the callbacks that return something return what it was told to.
+
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+
+// what the stub callbacks report back to the interpreters
+struct StubPlayer
+{
+	int iStatus;	// the interpreter's status enum (for the PR-8210, non-zero means busy)
+	uint32_t u32Frame;
+	uint8_t u8ActiveDisc;
+};
+
+namespace ldv1000_stubs { extern const LDV1000Callbacks_t cb; }
+namespace ldp1000_stubs { extern const LDP1000Callbacks_t cb; }
+namespace pr7820_stubs { extern const PR7820Callbacks_t cb; }
+namespace pr8210_stubs { extern const PR8210Callbacks_t cb; }
+namespace vip9500sg_stubs { extern const VIP9500SGCallbacks_t cb; }
+namespace ld700_stubs { extern const LD700Callbacks_t cb; }
+namespace vp931_stubs { extern const VP931Callbacks_t cb; }
+namespace vp932_stubs { extern const VP932Callbacks_t cb; }
+
+#endif // LDP_IN_BENCH_STUBS_H
@@ -0,0 +1,131 @@
+#include "wcet.h"
+#include "instr_counter.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+// Measures in instructions retired when the perf counters are available, otherwise in nanoseconds.
+class WcetCounter
+{
+public:
+	bool IsCountingInstructions() const { return m_instr.IsAvailable(); }
+
+	const char *GetUnit() const { return m_instr.IsAvailable() ? "instr" : "ns"; }
+
+	// smallest count of u32Repeats calls to pCall, minus the cost of measuring nothing
+	uint64_t Measure(const WcetProbe_t *pProbe, uint32_t u32Scenario, uint32_t u32Status, uint32_t u32Input, uint32_t u32Repeats)
+	{
+		uint64_t u64Min = UINT64_MAX;
+
+		for (uint32_t u = 0; u < u32Repeats; u++)
+		{
+			pProbe->pPrepare(u32Scenario, u32Status, u32Input);
+			uint64_t u64Count = MeasureCall(pProbe->pCall, u32Status, u32Input);
+			if (u64Count < u64Min) u64Min = u64Count;
+		}
+
+		return (u64Min > m_u64Overhead) ? (u64Min - m_u64Overhead) : 0;
+	}
+
+	void Calibrate()
+	{
+		m_u64Overhead = UINT64_MAX;
+		for (int i = 0; i < 1000; i++)
+		{
+			uint64_t u64Count = MeasureCall(empty_call, 0, 0);
+			if (u64Count < m_u64Overhead) m_u64Overhead = u64Count;
+		}
+	}
+
+private:
+	static void empty_call(uint32_t, uint32_t) { }
+
+	uint64_t MeasureCall(void (*pCall)(uint32_t, uint32_t), uint32_t u32Status, uint32_t u32Input)
+	{
+		if (m_instr.IsAvailable())
+		{
+			m_instr.Start();
+			pCall(u32Status, u32Input);
+			return m_instr.Stop();
+		}
+
+		typedef std::chrono::steady_clock clock_t;
+		clock_t::time_point start = clock_t::now();
+		pCall(u32Status, u32Input);
+		return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - start).count();
+	}
+
+	InstrCounter m_instr;
+	uint64_t m_u64Overhead = 0;
+};
+
+static uint64_t get_budget(const char *pszEntry, const WcetBudget_t *pBudgets, uint32_t u32Budgets, uint64_t u64DefaultBudget)
+{
+	for (uint32_t u = 0; u < u32Budgets; u++)
+	{
+		if (strcmp(pBudgets[u].pszEntry, pszEntry) == 0) return pBudgets[u].u64Budget;
+	}
+	return u64DefaultBudget;
+}
+
+uint32_t wcet_run_all(const WcetProbe_t *pProbes, uint32_t u32Count, const char *pszFilter, uint32_t u32Repeats,
+	const WcetBudget_t *pBudgets, uint32_t u32Budgets, uint64_t u64DefaultBudget)
+{
+	WcetCounter counter;
+	uint32_t u32Failed = 0;
+
+	counter.Calibrate();
+
+	if (!counter.IsCountingInstructions())
+	{
+		printf("(perf_event_open isn't permitted, so this is wall clock time and only roughly repeatable;"
+			" try lowering /proc/sys/kernel/perf_event_paranoid)\n");
+	}
+
+	printf("%-44s %10s %6s  %s\n", "entry point", "worst", "unit", "caused by");
+
+	for (uint32_t uProbe = 0; uProbe < u32Count; uProbe++)
+	{
+		const WcetProbe_t *pProbe = &pProbes[uProbe];
+		uint64_t u64Worst = 0;
+		uint32_t u32WorstScenario = 0, u32WorstStatus = 0, u32WorstInput = 0;
+
+		if (pszFilter && !strstr(pProbe->pszEntry, pszFilter)) continue;
+
+		for (uint32_t uScenario = 0; uScenario < pProbe->u32Scenarios; uScenario++)
+		{
+			for (uint32_t uStatus = 0; uStatus < pProbe->u32Statuses; uStatus++)
+			{
+				for (uint32_t uInput = 0; uInput < pProbe->u32Inputs; uInput++)
+				{
+					uint64_t u64Count = counter.Measure(pProbe, uScenario, uStatus, uInput, u32Repeats);
+					if (u64Count > u64Worst)
+					{
+						u64Worst = u64Count;
+						u32WorstScenario = uScenario;
+						u32WorstStatus = uStatus;
+						u32WorstInput = uInput;
+					}
+				}
+			}
+		}
+
+		uint64_t u64Budget = get_budget(pProbe->pszEntry, pBudgets, u32Budgets, u64DefaultBudget);
+		bool bFailed = (u64Budget != 0) && (u64Worst > u64Budget);
+
+		printf("%-44s %10llu %6s  scenario '%s', status %s", pProbe->pszEntry, (unsigned long long) u64Worst, counter.GetUnit(),
+			pProbe->ppszScenarios[u32WorstScenario], pProbe->ppszStatuses[u32WorstStatus]);
+		if (pProbe->u32Inputs > 1)
+		{
+			printf(", input 0x%02X", u32WorstInput);
+		}
+		if (bFailed)
+		{
+			printf("  OVER BUDGET (%llu)", (unsigned long long) u64Budget);
+			u32Failed++;
+		}
+		printf("\n");
+	}
+
+	return u32Failed;
+}
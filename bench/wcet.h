@@ -0,0 +1,35 @@
+#ifndef LDP_IN_WCET_H
+#define LDP_IN_WCET_H
+
+#include <stdint.h>
+
+// Worst case execution time search.
+// Every probe calls one public entry point for every combination of scenario (the state the interpreter is put into first),
+//  status (what the stub player reports) and input (command byte, message, etc) and keeps the slowest.
+
+typedef struct
+{
+	const char *pszEntry;	// the entry point being measured (for example "ldv1000i_ctx_write"); budgets are matched against this
+	const char * const *ppszScenarios;
+	uint32_t u32Scenarios;
+	const char * const *ppszStatuses;	// names of the status values, in enum order
+	uint32_t u32Statuses;
+	uint32_t u32Inputs;	// 256 for a command byte, 1 for entry points that take no input
+	void (*pPrepare)(uint32_t u32Scenario, uint32_t u32Status, uint32_t u32Input);	// resets the interpreter and puts it into the scenario
+	void (*pCall)(uint32_t u32Status, uint32_t u32Input);	// the call being measured; must not do anything else
+} WcetProbe_t;
+
+typedef struct
+{
+	const char *pszEntry;
+	uint64_t u64Budget;
+} WcetBudget_t;
+
+// Runs every probe (or only those whose entry point contains pszFilter, if it's not null) and prints the worst case of each.
+// Each combination is measured u32Repeats times and the smallest count is kept, which filters out interrupts and cache misses.
+// A probe fails if its worst case is more than its budget: the WcetBudget_t with a matching name, else u64DefaultBudget (0 means no budget).
+// Returns how many probes failed.
+uint32_t wcet_run_all(const WcetProbe_t *pProbes, uint32_t u32Count, const char *pszFilter, uint32_t u32Repeats,
+	const WcetBudget_t *pBudgets, uint32_t u32Budgets, uint64_t u64DefaultBudget);
+
+#endif // LDP_IN_WCET_H
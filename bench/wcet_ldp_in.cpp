@@ -0,0 +1,509 @@
+// Worst case execution time of every public entry point that the firmware calls from interrupt context.
+// Each probe sweeps every command byte (or message) x every status value x a handful of interpreter states.
+
+#include "wcet.h"
+#include "stubs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_COUNT(a) ((uint32_t) (sizeof(a) / sizeof((a)[0])))
+
+static StubPlayer g_player;
+
+/////////////////////////////////////////////////////////////////
+// LD-V1000
+
+static LDV1000Ctx_t g_ldv1000;
+
+static const char * const g_ldv1000_statuses[] = { "ERROR", "SEARCHING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP", "DISC_SWITCHING" };
+
+static const char * const g_ldv1000_scenarios[] =
+{
+	"reset", "ready", "5 digits entered", "search pending", "search delay expired", "frame queued", "waiting for disc id",
+	"disc switch pending", "badlands", "super mode"
+};
+
+// NO ENTRY before every byte like the games do
+static void ldv1000_send(const uint8_t *p8Bytes, uint32_t u32Count)
+{
+	for (uint32_t u = 0; u < u32Count; u++)
+	{
+		ldv1000i_ctx_write(&g_ldv1000, 0xFF);
+		ldv1000i_ctx_write(&g_ldv1000, p8Bytes[u]);
+	}
+	ldv1000i_ctx_write(&g_ldv1000, 0xFF);
+}
+
+static void ldv1000_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t)
+{
+	static const uint8_t digits[] = { 0x0F, 0x8F, 0x4F, 0x2F, 0xAF };	// 12345
+	static const uint8_t search[] = { 0x0F, 0x8F, 0x4F, 0x2F, 0xAF, 0xF7 };
+	static const uint8_t switch_disc[] = { 0x93, 2 };
+	LDV1000_EmulationType_t type = (u32Scenario == 8) ? LDV1000_EMU_BADLANDS : ((u32Scenario == 9) ? LDV1000_EMU_SUPER : LDV1000_EMU_STANDARD);
+
+	g_player.iStatus = LDV1000_PLAYING;
+	g_player.u32Frame = 12345;
+	g_player.u8ActiveDisc = 1;
+	ldv1000i_ctx_reset(&g_ldv1000, type);
+
+	switch (u32Scenario)
+	{
+	case 1:
+	case 8:
+	case 9:
+		ldv1000i_ctx_write(&g_ldv1000, 0xFF);
+		break;
+	case 2:
+		ldv1000_send(digits, sizeof(digits));
+		break;
+	case 3:
+	case 4:
+		g_player.iStatus = LDV1000_SEARCHING;
+		ldv1000_send(search, sizeof(search));
+		if (u32Scenario == 4)
+		{
+			for (int i = 0; i < 4; i++) ldv1000i_ctx_read(&g_ldv1000);
+		}
+		break;
+	case 5:
+		ldv1000_send((const uint8_t *) "\xC2", 1);
+		break;
+	case 6:
+		ldv1000_send(switch_disc, 1);
+		break;
+	case 7:
+		g_player.iStatus = LDV1000_DISC_SWITCHING;
+		ldv1000_send(switch_disc, sizeof(switch_disc));
+		break;
+	default:
+		break;
+	}
+
+	g_player.iStatus = (int) u32Status;
+}
+
+static void ldv1000_call_write(uint32_t, uint32_t u32Input) { ldv1000i_ctx_write(&g_ldv1000, (unsigned char) u32Input); }
+static void ldv1000_call_read(uint32_t, uint32_t) { ldv1000i_ctx_read(&g_ldv1000); }
+
+/////////////////////////////////////////////////////////////////
+// LDP-1000A/1450
+
+static LDP1000Ctx_t g_ldp1000;
+
+static const char * const g_ldp1000_statuses[] = { "ERROR", "SEARCHING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP" };
+
+// the first half are on a 1450, the second half on a 1000A
+static const char * const g_ldp1000_scenarios[] =
+{
+	"1450 reset", "1450 search, 5 digits entered", "1450 search active", "1450 repeat, 5 digits entered", "1450 repeat active",
+	"1450 user index control", "1450 skip forward, 2 digits entered", "1450 3 bytes queued",
+	"1000A reset", "1000A search, 5 digits entered", "1000A search active", "1000A repeat, 5 digits entered", "1000A repeat active",
+	"1000A user index control", "1000A skip forward, 2 digits entered", "1000A 3 bytes queued"
+};
+
+static void ldp1000_send(const char *pszBytes)
+{
+	uint16_t buf[8];
+	ldp1000i_ctx_write_n(&g_ldp1000, (const uint8_t *) pszBytes, (uint16_t) strlen(pszBytes));
+	while (ldp1000i_ctx_read_n(&g_ldp1000, buf, ARRAY_COUNT(buf)) != 0)
+	{
+	}
+}
+
+static void ldp1000_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t)
+{
+	g_player.iStatus = LDP1000_PLAYING;
+	g_player.u32Frame = 1000;
+	ldp1000i_ctx_reset(&g_ldp1000, (u32Scenario < 8) ? LDP1000_EMU_LDP1450 : LDP1000_EMU_LDP1000A);
+
+	switch (u32Scenario & 7)
+	{
+	case 1:
+		ldp1000_send("\x43" "12345");
+		break;
+	case 2:
+		g_player.iStatus = LDP1000_SEARCHING;
+		ldp1000_send("\x43" "12345\x40");
+		break;
+	case 3:
+		ldp1000_send("\x44" "12345");
+		break;
+	case 4:
+		ldp1000_send("\x44" "12345\x40" "3\x40");
+		break;
+	case 5:
+		ldp1000_send("\x80");
+		break;
+	case 6:
+		ldp1000_send("\x2D" "10");
+		break;
+	case 7:
+		ldp1000i_ctx_write_n(&g_ldp1000, (const uint8_t *) "\x3A\x3A\x3A", 3);	// queue up three ACKs
+		break;
+	default:
+		break;
+	}
+
+	g_player.iStatus = (int) u32Status;
+}
+
+static void ldp1000_call_write(uint32_t, uint32_t u32Input) { ldp1000i_ctx_write(&g_ldp1000, (uint8_t) u32Input); }
+static void ldp1000_call_read(uint32_t, uint32_t) { if (ldp1000i_ctx_can_read(&g_ldp1000)) ldp1000i_ctx_read(&g_ldp1000); }
+static void ldp1000_call_think(uint32_t, uint32_t) { ldp1000i_ctx_think_during_vblank(&g_ldp1000); }
+
+/////////////////////////////////////////////////////////////////
+// PR-7820
+
+static PR7820Ctx_t g_pr7820;
+
+static const char * const g_pr7820_statuses[] = { "ERROR", "SEARCHING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP" };
+static const char * const g_pr7820_scenarios[] = { "reset", "5 digits entered" };
+
+static void pr7820_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t)
+{
+	static const uint8_t digits[] = { 0x0F, 0x8F, 0x4F, 0x2F, 0xAF };	// 12345
+
+	g_player.iStatus = PR7820_PLAYING;
+	pr7820i_ctx_reset(&g_pr7820);
+	if (u32Scenario == 1)
+	{
+		for (uint32_t u = 0; u < sizeof(digits); u++) pr7820i_ctx_write(&g_pr7820, digits[u]);
+	}
+	g_player.iStatus = (int) u32Status;
+}
+
+static void pr7820_call_write(uint32_t, uint32_t u32Input) { pr7820i_ctx_write(&g_pr7820, (unsigned char) u32Input); }
+static void pr7820_call_is_busy(uint32_t, uint32_t) { pr7820i_ctx_is_busy(&g_pr7820); }
+
+/////////////////////////////////////////////////////////////////
+// PR-8210
+
+static PR8210Ctx_t g_pr8210;
+
+static const char * const g_pr8210_statuses[] = { "not busy", "busy" };
+static const char * const g_pr8210_scenarios[] = { "first copy", "second copy", "5 digits entered, second copy", "jump trigger raised" };
+
+// every message is sent twice; the input is the 10-bit message itself
+static void pr8210_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t u32Input)
+{
+	g_player.iStatus = 0;
+	pr8210i_ctx_reset(&g_pr8210);
+
+	if (u32Scenario == 2)
+	{
+		for (uint16_t u16Cmd = 0x11; u16Cmd <= 0x15; u16Cmd++)
+		{
+			pr8210i_ctx_write(&g_pr8210, (uint16_t) (4 | (u16Cmd << 3)));
+			pr8210i_ctx_write(&g_pr8210, (uint16_t) (4 | (u16Cmd << 3)));
+		}
+	}
+	else if (u32Scenario == 3)
+	{
+		pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(&g_pr8210, PR8210_FALSE);
+		pr8210i_ctx_on_jmp_trigger_changed(&g_pr8210, PR8210_TRUE, PR8210_FALSE);
+	}
+
+	if (u32Scenario != 0)
+	{
+		pr8210i_ctx_write(&g_pr8210, (uint16_t) u32Input);
+	}
+
+	g_player.iStatus = (int) u32Status;
+}
+
+static void pr8210_call_write(uint32_t, uint32_t u32Input) { pr8210i_ctx_write(&g_pr8210, (uint16_t) u32Input); }
+static void pr8210_call_on_vblank(uint32_t, uint32_t) { pr8210i_ctx_on_vblank(&g_pr8210); }
+static void pr8210_call_jmp_trigger(uint32_t, uint32_t u32Input)
+{
+	pr8210i_ctx_on_jmp_trigger_changed(&g_pr8210, (PR8210_BOOL) (u32Input & 1), (PR8210_BOOL) ((u32Input >> 1) & 1));
+}
+
+/////////////////////////////////////////////////////////////////
+// VIP9500SG
+
+static VIP9500SGCtx_t g_vip9500sg;
+
+static const char * const g_vip9500sg_statuses[] = { "ERROR", "SEARCHING", "STEPPING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP" };
+
+static const char * const g_vip9500sg_scenarios[] =
+{
+	"reset", "search, 5 digits entered", "searching", "skip, 2 digits entered", "waiting for playing", "waiting for picture number",
+	"3 bytes queued"
+};
+
+static void vip9500sg_send(const char *pszBytes)
+{
+	uint8_t buf[8];
+	vip9500sgi_ctx_write_n(&g_vip9500sg, (const uint8_t *) pszBytes, (uint16_t) strlen(pszBytes));
+	while (vip9500sgi_ctx_read_n(&g_vip9500sg, buf, sizeof(buf)) != 0)
+	{
+	}
+}
+
+static void vip9500sg_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t)
+{
+	g_player.iStatus = VIP9500SG_PAUSED;
+	g_player.u32Frame = 12345;
+	vip9500sgi_ctx_reset(&g_vip9500sg);
+
+	switch (u32Scenario)
+	{
+	case 1:
+		vip9500sg_send("\x2b" "12345");
+		break;
+	case 2:
+		vip9500sg_send("\x2b" "12345\x41");
+		break;
+	case 3:
+		vip9500sg_send("\x46" "10");
+		break;
+	case 4:
+		vip9500sg_send("\x25");
+		break;
+	case 5:
+		vip9500sg_send("\x6b");
+		break;
+	case 6:
+		vip9500sgi_ctx_write_n(&g_vip9500sg, (const uint8_t *) "\x2f\x2f\x2f", 3);	// three stops, three ACKs
+		break;
+	default:
+		break;
+	}
+
+	g_player.iStatus = (int) u32Status;
+}
+
+static void vip9500sg_call_write(uint32_t, uint32_t u32Input) { vip9500sgi_ctx_write(&g_vip9500sg, (uint8_t) u32Input); }
+static void vip9500sg_call_read(uint32_t, uint32_t) { if (vip9500sgi_ctx_can_read(&g_vip9500sg)) vip9500sgi_ctx_read(&g_vip9500sg); }
+static void vip9500sg_call_think(uint32_t, uint32_t) { vip9500sgi_ctx_think_after_vblank(&g_vip9500sg); }
+
+/////////////////////////////////////////////////////////////////
+// LD-700
+
+static LD700Ctx_t g_ld700;
+
+static const char * const g_ld700_statuses[] = { "ERROR", "SEARCHING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP", "TRAY_EJECTED" };
+static const char * const g_ld700_scenarios[] = { "reset", "frame number prepared", "escaped", "same command last field" };
+
+// header, command, inverted command
+static void ld700_send(uint8_t u8Cmd, LD700Status_t status)
+{
+	ld700i_ctx_on_new_cmd(&g_ld700);
+	ld700i_ctx_write(&g_ld700, 0xA8, status);
+	ld700i_ctx_write(&g_ld700, 0x57, status);
+	ld700i_ctx_write(&g_ld700, u8Cmd, status);
+	ld700i_ctx_write(&g_ld700, u8Cmd ^ 0xFF, status);
+	ld700i_ctx_on_vblank(&g_ld700, status);
+}
+
+// the input is the command byte; everything up to its inverted copy (which is what makes the interpreter act) is sent here
+static void ld700_prepare(uint32_t u32Scenario, uint32_t u32Status, uint32_t u32Input)
+{
+	LD700Status_t status = (LD700Status_t) u32Status;
+	ld700i_ctx_reset(&g_ld700);
+
+	switch (u32Scenario)
+	{
+	case 1:
+		ld700_send(0x41, status);
+		break;
+	case 2:
+		ld700_send(0x5F, status);
+		break;
+	case 3:
+		ld700i_ctx_on_new_cmd(&g_ld700);
+		ld700i_ctx_write(&g_ld700, 0xA8, status);
+		ld700i_ctx_write(&g_ld700, 0x57, status);
+		ld700i_ctx_write(&g_ld700, (uint8_t) u32Input, status);
+		ld700i_ctx_write(&g_ld700, (uint8_t) u32Input ^ 0xFF, status);
+		break;
+	default:
+		break;
+	}
+
+	ld700i_ctx_on_new_cmd(&g_ld700);
+	ld700i_ctx_write(&g_ld700, 0xA8, status);
+	ld700i_ctx_write(&g_ld700, 0x57, status);
+	ld700i_ctx_write(&g_ld700, (uint8_t) u32Input, status);
+}
+
+static void ld700_call_write(uint32_t u32Status, uint32_t u32Input)
+{
+	ld700i_ctx_write(&g_ld700, (uint8_t) u32Input ^ 0xFF, (LD700Status_t) u32Status);
+}
+
+static void ld700_call_on_vblank(uint32_t u32Status, uint32_t)
+{
+	ld700i_ctx_on_vblank(&g_ld700, (LD700Status_t) u32Status);
+}
+
+static void ld700_call_on_new_cmd(uint32_t, uint32_t) { ld700i_ctx_on_new_cmd(&g_ld700); }
+
+/////////////////////////////////////////////////////////////////
+// VP931
+
+static VP931Ctx_t g_vp931;
+
+static const char * const g_vp931_statuses[] = { "ERROR", "SEARCHING", "PLAYING", "PAUSED", "SPINNING_UP" };
+static const char * const g_vp931_scenarios[] = { "1 command", "4 commands" };
+
+static uint8_t g_vp931_buf[12];
+static uint8_t g_vp931_len;
+
+// the input is the first two bytes of each 3 byte command
+static void vp931_prepare(uint32_t u32Scenario, uint32_t, uint32_t u32Input)
+{
+	vp931i_ctx_reset(&g_vp931);
+
+	g_vp931_len = (u32Scenario == 0) ? 3 : 12;
+	for (uint8_t u = 0; u < g_vp931_len; u += 3)
+	{
+		g_vp931_buf[u] = (uint8_t) (u32Input >> 8);
+		g_vp931_buf[u + 1] = (uint8_t) u32Input;
+		g_vp931_buf[u + 2] = 0x99;
+	}
+}
+
+static void vp931_call_on_vsync(uint32_t u32Status, uint32_t)
+{
+	vp931i_ctx_on_vsync(&g_vp931, g_vp931_buf, g_vp931_len, (VP931Status_t) u32Status);
+}
+
+/////////////////////////////////////////////////////////////////
+// VP932
+
+static VP932Ctx_t g_vp932;
+
+static const char * const g_vp932_statuses[] = { "ERROR", "SEARCHING", "STOPPED", "PLAYING", "PAUSED", "SPINNING_UP" };
+
+static const char * const g_vp932_scenarios[] =
+{
+	"reset", "F12345 received", "F12345R received", "searching", "same search done", "rx buffer full", "3 bytes queued"
+};
+
+static void vp932_prepare(uint32_t u32Scenario, uint32_t, uint32_t)
+{
+	uint8_t buf[8];
+
+	g_player.u32Frame = 12345;
+	vp932i_ctx_reset(&g_vp932);
+
+	switch (u32Scenario)
+	{
+	case 1:
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345", 6);
+		break;
+	case 2:
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345R", 7);
+		break;
+	case 3:
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345R\r", 8);
+		break;
+	case 4:
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345R\r", 8);
+		vp932i_ctx_think_during_vblank(&g_vp932, VP932_PAUSED);
+		vp932i_ctx_read_n(&g_vp932, buf, sizeof(buf));
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345R", 7);
+		break;
+	case 5:
+		for (uint32_t u = 0; u < VP932_RX_BUFSIZE; u++) vp932i_ctx_write(&g_vp932, '1');
+		break;
+	case 6:
+		vp932i_ctx_write_n(&g_vp932, (const uint8_t *) "F12345R\r", 8);
+		vp932i_ctx_think_during_vblank(&g_vp932, VP932_PAUSED);
+		break;
+	default:
+		break;
+	}
+}
+
+static void vp932_call_write(uint32_t, uint32_t u32Input) { vp932i_ctx_write(&g_vp932, (uint8_t) u32Input); }
+static void vp932_call_read(uint32_t, uint32_t) { if (vp932i_ctx_can_read(&g_vp932)) vp932i_ctx_read(&g_vp932); }
+static void vp932_call_think(uint32_t u32Status, uint32_t) { vp932i_ctx_think_during_vblank(&g_vp932, (VP932Status_t) u32Status); }
+
+/////////////////////////////////////////////////////////////////
+
+#define WCET_SCENARIOS(name) g_##name##_scenarios, ARRAY_COUNT(g_##name##_scenarios)
+#define WCET_STATUSES(name) g_##name##_statuses, ARRAY_COUNT(g_##name##_statuses)
+
+static const WcetProbe_t g_probes[] =
+{
+	{ "ldv1000i_ctx_write", WCET_SCENARIOS(ldv1000), WCET_STATUSES(ldv1000), 256, ldv1000_prepare, ldv1000_call_write },
+	{ "ldv1000i_ctx_read", WCET_SCENARIOS(ldv1000), WCET_STATUSES(ldv1000), 1, ldv1000_prepare, ldv1000_call_read },
+	{ "ldp1000i_ctx_write", WCET_SCENARIOS(ldp1000), WCET_STATUSES(ldp1000), 256, ldp1000_prepare, ldp1000_call_write },
+	{ "ldp1000i_ctx_read", WCET_SCENARIOS(ldp1000), WCET_STATUSES(ldp1000), 1, ldp1000_prepare, ldp1000_call_read },
+	{ "ldp1000i_ctx_think_during_vblank", WCET_SCENARIOS(ldp1000), WCET_STATUSES(ldp1000), 1, ldp1000_prepare, ldp1000_call_think },
+	{ "pr7820i_ctx_write", WCET_SCENARIOS(pr7820), WCET_STATUSES(pr7820), 256, pr7820_prepare, pr7820_call_write },
+	{ "pr7820i_ctx_is_busy", WCET_SCENARIOS(pr7820), WCET_STATUSES(pr7820), 1, pr7820_prepare, pr7820_call_is_busy },
+	{ "pr8210i_ctx_write", WCET_SCENARIOS(pr8210), WCET_STATUSES(pr8210), 1024, pr8210_prepare, pr8210_call_write },
+	{ "pr8210i_ctx_on_vblank", WCET_SCENARIOS(pr8210), WCET_STATUSES(pr8210), 1, pr8210_prepare, pr8210_call_on_vblank },
+	{ "pr8210i_ctx_on_jmp_trigger_changed", WCET_SCENARIOS(pr8210), WCET_STATUSES(pr8210), 4, pr8210_prepare, pr8210_call_jmp_trigger },
+	{ "vip9500sgi_ctx_write", WCET_SCENARIOS(vip9500sg), WCET_STATUSES(vip9500sg), 256, vip9500sg_prepare, vip9500sg_call_write },
+	{ "vip9500sgi_ctx_read", WCET_SCENARIOS(vip9500sg), WCET_STATUSES(vip9500sg), 1, vip9500sg_prepare, vip9500sg_call_read },
+	{ "vip9500sgi_ctx_think_after_vblank", WCET_SCENARIOS(vip9500sg), WCET_STATUSES(vip9500sg), 1, vip9500sg_prepare, vip9500sg_call_think },
+	{ "ld700i_ctx_write", WCET_SCENARIOS(ld700), WCET_STATUSES(ld700), 256, ld700_prepare, ld700_call_write },
+	{ "ld700i_ctx_on_vblank", WCET_SCENARIOS(ld700), WCET_STATUSES(ld700), 1, ld700_prepare, ld700_call_on_vblank },
+	{ "ld700i_ctx_on_new_cmd", WCET_SCENARIOS(ld700), WCET_STATUSES(ld700), 1, ld700_prepare, ld700_call_on_new_cmd },
+	{ "vp931i_ctx_on_vsync", WCET_SCENARIOS(vp931), WCET_STATUSES(vp931), 65536, vp931_prepare, vp931_call_on_vsync },
+	{ "vp932i_ctx_write", WCET_SCENARIOS(vp932), WCET_STATUSES(vp932), 256, vp932_prepare, vp932_call_write },
+	{ "vp932i_ctx_read", WCET_SCENARIOS(vp932), WCET_STATUSES(vp932), 1, vp932_prepare, vp932_call_read },
+	{ "vp932i_ctx_think_during_vblank", WCET_SCENARIOS(vp932), WCET_STATUSES(vp932), 1, vp932_prepare, vp932_call_think },
+};
+
+#define MAX_BUDGETS 64
+
+int main(int argc, char **argv)
+{
+	const char *pszFilter = 0;
+	uint32_t u32Repeats = 3;
+	uint64_t u64DefaultBudget = 0;
+	WcetBudget_t budgets[MAX_BUDGETS];
+	uint32_t u32Budgets = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--repeat") == 0) && (i + 1 < argc))
+		{
+			u32Repeats = (uint32_t) atoi(argv[++i]);
+		}
+		// --budget <n> applies to every entry point, --budget <entry>=<n> to just one
+		else if ((strcmp(argv[i], "--budget") == 0) && (i + 1 < argc))
+		{
+			char *pszArg = argv[++i];
+			char *pszEquals = strchr(pszArg, '=');
+			if (!pszEquals)
+			{
+				u64DefaultBudget = strtoull(pszArg, NULL, 10);
+			}
+			else if (u32Budgets < MAX_BUDGETS)
+			{
+				*pszEquals = 0;
+				budgets[u32Budgets].pszEntry = pszArg;
+				budgets[u32Budgets].u64Budget = strtoull(pszEquals + 1, NULL, 10);
+				u32Budgets++;
+			}
+		}
+		else if (argv[i][0] != '-')
+		{
+			pszFilter = argv[i];
+		}
+		else
+		{
+			printf("usage: %s [--repeat <n>] [--budget [<entry point>=]<max>]... [entry point filter]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	ldv1000i_ctx_init(&g_ldv1000, &ldv1000_stubs::cb, &g_player);
+	ldp1000i_ctx_init(&g_ldp1000, &ldp1000_stubs::cb, &g_player);
+	pr7820i_ctx_init(&g_pr7820, &pr7820_stubs::cb, &g_player);
+	pr8210i_ctx_init(&g_pr8210, &pr8210_stubs::cb, &g_player);
+	vip9500sgi_ctx_init(&g_vip9500sg, &vip9500sg_stubs::cb, &g_player);
+	ld700i_ctx_init(&g_ld700, &ld700_stubs::cb, &g_player);
+	vp931i_ctx_init(&g_vp931, &vp931_stubs::cb, &g_player);
+	vp932i_ctx_init(&g_vp932, &vp932_stubs::cb, &g_player);
+
+	uint32_t u32Failed = wcet_run_all(g_probes, ARRAY_COUNT(g_probes), pszFilter, u32Repeats, budgets, u32Budgets, u64DefaultBudget);
+	return (u32Failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#ifndef LDP_IN_HOST_FIELD_CLOCK_H
+#define LDP_IN_HOST_FIELD_CLOCK_H
+
+// Field pacing for the host components that run interpreters' vblanks themselves (ldp_in_ptyd and the real-time runtime).
+// Each field's time is worked out from the start time and the field number, with exact integer arithmetic, rather than by adding
+//  up a rounded period, so the rate never drifts: field n of NTSC is due at n * 1001/60000 s, field n of PAL at n / 50 s.
+// After a stall, up to LDPIN_FIELD_MAX_CATCH_UP of the fields that are due are run at once and any more are skipped (and counted),
+//  so that a stall doesn't turn into a burst of vblanks.
+// Times are in ns on any clock; ldpin_field_now_ns and ldpin_field_arm_timer are for CLOCK_MONOTONIC and a timerfd on Linux.
+
+#include <stdint.h>
+
+#define LDPIN_FIELD_MAX_CATCH_UP 6
+
+// field rates as a whole number of fields every whole number of ns
+#define LDPIN_FIELD_NTSC_FIELDS 60000ull
+#define LDPIN_FIELD_NTSC_NS 1001000000000ull	// 60000 fields every 1001 s
+#define LDPIN_FIELD_PAL_FIELDS 50ull
+#define LDPIN_FIELD_PAL_NS 1000000000ull
+
+class LDPInFieldClock
+{
+public:
+	LDPInFieldClock() : m_u64StartNs(0), m_u64Field(0), m_u64Skipped(0), m_bPal(false) { }
+
+	// when field u64Field is due, in ns after field 0 (rounded up, so that it is the first ns at which FieldsAt counts it)
+	static uint64_t FieldNs(uint64_t u64Field, bool bPal)
+	{
+		uint64_t u64Fields = bPal ? LDPIN_FIELD_PAL_FIELDS : LDPIN_FIELD_NTSC_FIELDS;
+		uint64_t u64Ns = bPal ? LDPIN_FIELD_PAL_NS : LDPIN_FIELD_NTSC_NS;
+		return (u64Field / u64Fields) * u64Ns + ((u64Field % u64Fields) * u64Ns + u64Fields - 1) / u64Fields;
+	}
+
+	// the last field due u64Ns after field 0
+	static uint64_t FieldsAt(uint64_t u64Ns, bool bPal)
+	{
+		uint64_t u64Fields = bPal ? LDPIN_FIELD_PAL_FIELDS : LDPIN_FIELD_NTSC_FIELDS;
+		uint64_t u64Period = bPal ? LDPIN_FIELD_PAL_NS : LDPIN_FIELD_NTSC_NS;
+		return (u64Ns / u64Period) * u64Fields + ((u64Ns % u64Period) * u64Fields) / u64Period;
+	}
+
+	// field 0 is at u64StartNs; the first field to run is field 1
+	void Start(uint64_t u64StartNs, bool bPal)
+	{
+		m_u64StartNs = u64StartNs;
+		m_u64Field = 0;
+		m_u64Skipped = 0;
+		m_bPal = bPal;
+	}
+
+	// when the next field to run is due (what to arm the timer for)
+	uint64_t NextAtNs() const { return m_u64StartNs + FieldNs(m_u64Field + 1, m_bPal); }
+
+	// how late, at u64NowNs, the next field to run is (0 if it isn't due yet)
+	uint64_t LateNs(uint64_t u64NowNs) const
+	{
+		uint64_t u64DueNs = NextAtNs();
+		return (u64NowNs > u64DueNs) ? (u64NowNs - u64DueNs) : 0;
+	}
+
+	// Returns how many fields to run now, at u64NowNs (0 if the timer fired early), and counts them as run.
+	// If more than LDPIN_FIELD_MAX_CATCH_UP are due, the oldest are skipped instead and added to Skipped.
+	uint32_t Advance(uint64_t u64NowNs)
+	{
+		uint64_t u64Due = (u64NowNs > m_u64StartNs) ? FieldsAt(u64NowNs - m_u64StartNs, m_bPal) : 0;
+
+		if (u64Due <= m_u64Field)
+		{
+			return 0;
+		}
+		if (u64Due > m_u64Field + LDPIN_FIELD_MAX_CATCH_UP)
+		{
+			m_u64Skipped += u64Due - m_u64Field - LDPIN_FIELD_MAX_CATCH_UP;
+			m_u64Field = u64Due - LDPIN_FIELD_MAX_CATCH_UP;
+		}
+
+		uint32_t u32Run = (uint32_t) (u64Due - m_u64Field);
+		m_u64Field = u64Due;
+		return u32Run;
+	}
+
+	uint64_t Field() const { return m_u64Field; }	// the last field run (or skipped)
+	uint64_t Skipped() const { return m_u64Skipped; }
+
+private:
+	uint64_t m_u64StartNs;
+	uint64_t m_u64Field;
+	uint64_t m_u64Skipped;
+	bool m_bPal;
+};
+
+#ifdef __linux__
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+
+static inline uint64_t ldpin_field_now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+// arms a CLOCK_MONOTONIC timerfd to fire once at u64AtNs
+static inline bool ldpin_field_arm_timer(int fdTimer, uint64_t u64AtNs)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	its.it_value.tv_sec = (time_t) (u64AtNs / 1000000000ull);
+	its.it_value.tv_nsec = (long) (u64AtNs % 1000000000ull);
+	return timerfd_settime(fdTimer, TFD_TIMER_ABSTIME, &its, 0) == 0;
+}
+#endif // __linux__
+
+#endif // LDP_IN_HOST_FIELD_CLOCK_H
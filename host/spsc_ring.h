@@ -0,0 +1,73 @@
+#ifndef LDP_IN_HOST_SPSC_RING_H
+#define LDP_IN_HOST_SPSC_RING_H
+
+// Single-producer/single-consumer ring of any copyable type, for the host components (the shared-memory transport and the
+//  real-time runtime) that hand whole entries between threads or processes.
+// The rules are those of the library's byte channel (channel.h): the producer only writes the head and the consumer only the
+//  tail, both free-running, with head - tail entries queued.  The differences are what the host components need: the entries can
+//  be anything, the size can be any power of two, and the indices are 32-bit std::atomics, so a ring can live in shared memory.
+// An all-zero ring is empty, so one in a freshly created shared memory object is ready to use without being constructed.
+
+#include <atomic>
+#include <stdint.h>
+
+template <typename T, uint32_t SIZE>
+struct LDPInSpscRing
+{
+	static_assert((SIZE & (SIZE - 1)) == 0, "ring size must be a power of two");
+
+	// each index on its own cache line, so the two sides don't keep stealing the line from each other
+	alignas(64) std::atomic<uint32_t> u32Head{0};	// next slot to write (producer only)
+	alignas(64) std::atomic<uint32_t> u32Tail{0};	// next slot to read (consumer only)
+	alignas(64) T buf[SIZE];
+
+	// producer; false if full
+	bool Push(const T &val)
+	{
+		uint32_t uHead = u32Head.load(std::memory_order_relaxed);
+		if (uHead - u32Tail.load(std::memory_order_acquire) == SIZE)
+		{
+			return false;
+		}
+		buf[uHead & (SIZE - 1)] = val;
+		u32Head.store(uHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer: how many entries can be read
+	uint32_t Count() const
+	{
+		return u32Head.load(std::memory_order_acquire) - u32Tail.load(std::memory_order_relaxed);
+	}
+
+	// consumer: the oldest entry, or 0 if empty; Drop it once done with it
+	const T *Peek() const
+	{
+		uint32_t uTail = u32Tail.load(std::memory_order_relaxed);
+		if (uTail == u32Head.load(std::memory_order_acquire))
+		{
+			return 0;
+		}
+		return &buf[uTail & (SIZE - 1)];
+	}
+
+	void Drop()
+	{
+		u32Tail.store(u32Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// consumer; false if empty
+	bool Pop(T *pVal)
+	{
+		const T *p = Peek();
+		if (!p)
+		{
+			return false;
+		}
+		*pVal = *p;
+		Drop();
+		return true;
+	}
+};
+
+#endif // LDP_IN_HOST_SPSC_RING_H
@@ -0,0 +1,70 @@
+#ifndef LDP_IN_CHANNEL_H
+#define LDP_IN_CHANNEL_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+
+// Single-producer/single-consumer byte channel.
+// For handing bytes between an interrupt handler and the main loop without disabling interrupts: for example the UART receive
+//  interrupt puts each byte into a channel and the main loop feeds them to <prefix>_ctx_write, or the main loop puts the bytes it
+//  reads from an interpreter into one that the UART-empty interrupt drains.
+// The producer only writes the head and the consumer only writes the tail, and each is a single byte, so there is no counter
+//  that both sides read-modify-write.  Head and tail are free-running; head - tail is how many bytes are queued.
+// On the AVR single-byte loads and stores are atomic, and a compiler barrier keeps the buffer access on the right side of the
+//  index update.  Elsewhere the indices are C11 atomics with acquire/release ordering, so the two sides may be threads on different cores.
+// There must be exactly one producer and one consumer; two interrupt handlers putting into one channel need a lock.
+// The interpreters' transmit rings (ring.h) follow the same rules.
+
+// what the library (compiled as C11) sees as an atomic byte is a plain byte to C++ and older compilers; both are one byte
+#if defined(__cplusplus) || defined(__AVR__) || !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) || defined(__STDC_NO_ATOMICS__)
+typedef volatile uint8_t LDPInChanIdx_t;
+#else
+#include <stdatomic.h>
+#define LDP_IN_CHAN_C11_ATOMICS
+typedef _Atomic uint8_t LDPInChanIdx_t;
+#endif
+
+typedef struct
+{
+	uint8_t *p8Buf;	// storage passed to ldpin_chan_init
+	uint8_t u8Mask;	// capacity - 1
+	LDPInChanIdx_t u8Head;	// next slot to write (producer only)
+	LDPInChanIdx_t u8Tail;	// next slot to read (consumer only)
+	uint8_t u8Overflows;	// bytes dropped because the channel was full (producer only, stops at 255)
+} LDPInChan_t;
+
+// Prepares an empty channel that uses u8Size bytes at p8Buf, which must be a power of two between 2 and 128.
+// Returns 0 if it isn't.  Neither side may be using the channel while this runs.
+uint8_t ldpin_chan_init(LDPInChan_t *pChan, uint8_t *p8Buf, uint8_t u8Size);
+
+// How many bytes are queued.  Either side may call it: it can only be low for the consumer and only high for the producer.
+uint8_t ldpin_chan_count(const LDPInChan_t *pChan);
+
+// producer: adds a byte; returns 0 (and counts an overflow) if the channel was full, otherwise non-zero
+uint8_t ldpin_chan_put(LDPInChan_t *pChan, uint8_t u8Val);
+
+// producer: adds up to u8Len bytes, publishing them all at once; returns how many were added (the rest are counted as overflows)
+uint8_t ldpin_chan_put_n(LDPInChan_t *pChan, const uint8_t *p8Src, uint8_t u8Len);
+
+// consumer: removes the oldest byte into *pu8Val; returns 0 if the channel was empty, otherwise non-zero
+uint8_t ldpin_chan_get(LDPInChan_t *pChan, uint8_t *pu8Val);
+
+// consumer: removes up to u8Cap of the oldest bytes into pDst; returns how many
+uint8_t ldpin_chan_get_n(LDPInChan_t *pChan, uint8_t *pDst, uint8_t u8Cap);
+
+// Consumer: returns a pointer to the oldest byte and stores in *pu8Count how many can be read contiguously from it
+//  (for example to pass straight to <prefix>_ctx_write_n).  Call ldpin_chan_commit once they have been consumed.
+const uint8_t *ldpin_chan_peek(const LDPInChan_t *pChan, uint8_t *pu8Count);
+
+// consumer: removes u8Count bytes (must not exceed what ldpin_chan_peek returned)
+void ldpin_chan_commit(LDPInChan_t *pChan, uint8_t u8Count);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_CHANNEL_H
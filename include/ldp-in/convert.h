@@ -0,0 +1,56 @@
+#ifndef LDP_IN_CONVERT_H
+#define LDP_IN_CONVERT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+
+// Frame number conversions shared by the interpreters.
+// None of these divide or do a 32x32 multiply, both of which are library calls costing hundreds of cycles on the AVR.
+// The constants below are exact for every value the functions accept (checked exhaustively by the unit tests).
+
+// Stores the lower 5 decimal digits of u32Val in p8Dst as ASCII ('0' to '9'), most significant first.
+// Values over 99999 need one real division to drop the extra digits, but frame numbers never get that big.
+void ldpin_u32_to_ascii5(uint32_t u32Val, uint8_t *p8Dst);
+
+// Stores the lower 5 decimal digits of u32Val in 3 bytes of packed BCD: 0x0A, 0xBC, 0xDE for ABCDE.
+void ldpin_u32_to_bcd5(uint32_t u32Val, uint8_t *p8Dst);
+
+// Converts up to 5 ASCII digits to binary, stopping at the first character that isn't a digit (or at a null terminator).
+// Same result as strtoul(psz, NULL, 10) for the digit buffers that the interpreters keep.
+uint32_t ldpin_ascii5_to_u32(const char *psz);
+
+// Converts a 5 digit packed BCD number to binary.
+// u8Hi holds the most significant digit in its lower nibble (the upper nibble is ignored); u8Mid and u8Lo hold two digits each.
+uint32_t ldpin_bcd5_to_u32(uint8_t u8Hi, uint8_t u8Mid, uint8_t u8Lo);
+
+// Converts a 3 digit packed BCD number to binary (same layout as above without the last byte).
+uint16_t ldpin_bcd3_to_u16(uint8_t u8Hi, uint8_t u8Lo);
+
+// Returns u32Val * 10 + u8Digit (for building up a number as its digits arrive), using shifts instead of a multiply.
+uint32_t ldpin_append_digit(uint32_t u32Val, uint8_t u8Digit);
+
+// Frame number cache for hosts that supply the current frame number once per vblank instead of on demand.
+// The digits are kept ready to send; when the frame advances by one (the usual case while playing) they are updated
+//  by incrementing the last digit and carrying, so frame inquiries never have to convert anything.
+typedef struct
+{
+	uint32_t u32Frame;	// the frame number as supplied by the host
+	uint8_t au8Ascii[5];	// lower 5 digits of u32Frame in ASCII, most significant first
+	uint8_t u8Valid;	// non-zero once the host has supplied a frame number
+} LDPInFrameCache_t;
+
+// forgets the cached frame number (until the next ldpin_frame_cache_set)
+void ldpin_frame_cache_reset(LDPInFrameCache_t *pCache);
+
+// updates the cache with the current frame number
+void ldpin_frame_cache_set(LDPInFrameCache_t *pCache, uint32_t u32Frame);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_CONVERT_H
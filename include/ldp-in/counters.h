@@ -0,0 +1,143 @@
+#ifndef LDP_IN_COUNTERS_H
+#define LDP_IN_COUNTERS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+#include <ldp-in/config.h>
+#include "ring.h"
+
+// Usage counters.
+// In a LDP_IN_COUNTERS build every context has a counters member (LDPInCounters_t) that the interpreter keeps up to date as it runs:
+//  bytes in and out, commands by class, errors by code, how full the transmit (and receive) queues have got, searches and vblanks.
+// They are plain integers updated without any locking, so the host can read them whenever it likes (on an 8-bit target, a multi-byte
+//  counter read while an interrupt handler is updating it can be off; read it twice if that matters).
+// They are zeroed by <prefix>_ctx_init (or ldpin_counters_reset) but not by <prefix>_ctx_reset, and aren't part of the state, so
+//  snapshots, hashes and rewinding leave them alone.  The clock given to ldpin_counters_set_clock is part of the counters too, so
+//  every context can have its own; <prefix>_ctx_init forgets it, ldpin_counters_reset keeps it.
+// In a normal build none of this exists and the hooks in the interpreters compile to nothing.
+
+// the kinds of command that are counted separately
+typedef enum
+{
+	LDPIN_CMD_DIGIT = 0,	// a digit of a frame/chapter number
+	LDPIN_CMD_PLAY,	// play, still, stop, step, scan, speed changes, skips, reject
+	LDPIN_CMD_SEARCH,	// search and repeat
+	LDPIN_CMD_INQUIRY,	// status, frame number, disc and other inquiries
+	LDPIN_CMD_AV,	// audio, video and display/text overlay settings
+	LDPIN_CMD_OTHER,	// clear, enter, mode and configuration commands, and bytes that aren't commands at all
+	LDPIN_CMD_CLASS_COUNT
+} LDPInCmdClass_t;
+
+// error codes past this are counted with the last one
+#define LDPIN_COUNTERS_MAX_ERRORS 6
+
+// Search latency histograms, from the begin_search callback to the interpreter seeing the search end (as the game sees it).
+// Bucket 0 counts latencies of 0, and bucket n (n > 0) counts those from 2^(n-1) up to 2^n - 1; the last bucket also takes anything longer.
+// Vblank latencies are in vblanks (up to 4095 before the last bucket, about 68 seconds).
+// Microsecond latencies are in units of 2^LDPIN_LATENCY_US_SHIFT us (up to about 4.2 seconds), and are only kept if the host has
+//  supplied a clock with ldpin_counters_set_clock, and only for searches that were started with that clock.
+#define LDPIN_LATENCY_BUCKETS 14
+#define LDPIN_LATENCY_US_SHIFT 10
+
+typedef struct
+{
+	uint16_t au16VBlanks[LDPIN_LATENCY_BUCKETS];	// stop at 65535
+	uint16_t au16Micros[LDPIN_LATENCY_BUCKETS];	// stop at 65535
+	uint32_t u32StartVBlank;	// u32VBlanks when the pending search started
+	uint32_t u32StartMicros;	// the host's clock when the pending search started
+	uint8_t u8Pending;	// non-zero while a search is being timed
+	uint8_t u8StartMicrosValid;	// non-zero if u32StartMicros came from the current clock
+} LDPInLatency_t;
+
+// ldpin_latency_export's output: a version byte, the bucket count, then the vblank and microsecond histograms as little-endian 16-bit counts
+#define LDPIN_LATENCY_EXPORT_VERSION 1
+#define LDPIN_LATENCY_EXPORT_SIZE (2 + (4 * LDPIN_LATENCY_BUCKETS))
+
+typedef struct
+{
+	uint32_t u32BytesIn;	// bytes written by the host (PR-8210: messages, VP931: command bytes passed to on_vsync)
+	uint32_t u32BytesOut;	// bytes read from the transmit queue (LD-V1000: every read)
+	uint32_t au32Cmds[LDPIN_CMD_CLASS_COUNT];	// commands received, by LDPInCmdClass_t (rejected ones are in au32Errors too)
+	uint32_t au32Errors[LDPIN_COUNTERS_MAX_ERRORS];	// error callbacks, by the interpreter's <X>ErrCode_t (LD-V1000: all under 0)
+	uint32_t u32TxOverflows;	// bytes dropped because the transmit queue was full
+	uint32_t u32RxOverflows;	// bytes dropped because the receive buffer was full (VP932 only)
+	uint32_t u32SearchesStarted;	// begin_search callbacks
+	uint32_t u32SearchesCompleted;	// searches that the interpreter saw finish (not counted by the PR-7820, VP931 and LD-700, which leave that to the player)
+	uint32_t u32SearchesFailed;	// searches that the interpreter saw fail
+	uint32_t u32VBlanks;	// calls to the vblank/vsync entry point (LD-V1000 and PR-7820, which don't have one: calls to ldpin_counters_vblank)
+	uint8_t u8TxHighWater;	// the most entries the transmit queue has held
+	uint8_t u8RxHighWater;	// the most bytes the receive buffer has held (VP932 only)
+	LDPInLatency_t searchLatency;	// how long completed and failed searches took
+	uint32_t (*pfnMicros)(void *pUser);	// the clock given to ldpin_counters_set_clock, or 0
+	void *pMicrosUser;	// passed to pfnMicros
+} LDPInCounters_t;
+
+#ifdef LDP_IN_COUNTERS
+
+// zeroes every counter (and drops any search being timed), keeping the clock
+void ldpin_counters_reset(LDPInCounters_t *pCounters);
+
+// The LD-V1000 and PR-7820 interpreters have no vblank entry point, so their hosts should call this once per vblank
+//  (for the vblank count and the search latencies).
+void ldpin_counters_vblank(LDPInCounters_t *pCounters);
+
+// Supplies a free-running microsecond clock (wrapping at 2^32 is fine) for these counters' microsecond latency histograms, or 0 to
+//  stop using one.  It is called with pUser from the context's interpreter (so from the same thread or interrupt handlers), and
+//  should be set after <prefix>_ctx_init.  A search that is already being timed gets no microsecond sample.
+void ldpin_counters_set_clock(LDPInCounters_t *pCounters, uint32_t (*pfnMicros)(void *pUser), void *pUser);
+
+// writes LDPIN_LATENCY_EXPORT_SIZE bytes describing pLatency's histograms into pDst, for sending to a PC
+void ldpin_latency_export(const LDPInLatency_t *pLatency, uint8_t *pDst);
+
+// The interpreters call these through the macros below.
+void ldpin_counters_init(LDPInCounters_t *pCounters);
+void ldpin_counters_error(LDPInCounters_t *pCounters, uint8_t u8Code);
+void ldpin_counters_tx8(LDPInCounters_t *pCounters, LDPInRing8_t *pRing, uint8_t u8Val);
+void ldpin_counters_tx8_n(LDPInCounters_t *pCounters, LDPInRing8_t *pRing, const uint8_t *p8Src, uint8_t u8Len);
+void ldpin_counters_tx16(LDPInCounters_t *pCounters, LDPInRing16_t *pRing, uint16_t u16Val);
+void ldpin_counters_rx(LDPInCounters_t *pCounters, uint8_t u8Level);
+void ldpin_counters_search_start(LDPInCounters_t *pCounters);
+void ldpin_counters_search_end(LDPInCounters_t *pCounters, uint8_t u8Failed);
+
+#define LDPIN_COUNTERS_INIT(pCtx)	ldpin_counters_init(&(pCtx)->counters)
+#define LDPIN_COUNT(pCtx, member)	((pCtx)->counters.member++)
+#define LDPIN_COUNT_N(pCtx, member, n)	((pCtx)->counters.member += (n))
+#define LDPIN_COUNT_CMD(pCtx, cls)	((pCtx)->counters.au32Cmds[cls]++)
+#define LDPIN_COUNT_ERR(pCtx, code)	ldpin_counters_error(&(pCtx)->counters, (uint8_t) (code))
+#define LDPIN_COUNT_RX(pCtx, level)	ldpin_counters_rx(&(pCtx)->counters, level)
+#define LDPIN_COUNT_SEARCH_START(pCtx)	ldpin_counters_search_start(&(pCtx)->counters)
+#define LDPIN_COUNT_SEARCH_DONE(pCtx)	ldpin_counters_search_end(&(pCtx)->counters, 0)
+#define LDPIN_COUNT_SEARCH_FAILED(pCtx)	ldpin_counters_search_end(&(pCtx)->counters, 1)
+
+// push onto the context's transmit ring (state.tx), keeping track of its high-water mark and of anything dropped
+#define LDPIN_TX8_PUSH(pCtx, val)	ldpin_counters_tx8(&(pCtx)->counters, &(pCtx)->state.tx, val)
+#define LDPIN_TX8_PUSH_N(pCtx, src, len)	ldpin_counters_tx8_n(&(pCtx)->counters, &(pCtx)->state.tx, src, len)
+#define LDPIN_TX16_PUSH(pCtx, val)	ldpin_counters_tx16(&(pCtx)->counters, &(pCtx)->state.tx, val)
+
+#else
+
+#define LDPIN_COUNTERS_INIT(pCtx)	((void) 0)
+#define LDPIN_COUNT(pCtx, member)	((void) 0)
+#define LDPIN_COUNT_N(pCtx, member, n)	((void) 0)
+#define LDPIN_COUNT_CMD(pCtx, cls)	((void) 0)
+#define LDPIN_COUNT_ERR(pCtx, code)	((void) 0)
+#define LDPIN_COUNT_RX(pCtx, level)	((void) 0)
+#define LDPIN_COUNT_SEARCH_START(pCtx)	((void) 0)
+#define LDPIN_COUNT_SEARCH_DONE(pCtx)	((void) 0)
+#define LDPIN_COUNT_SEARCH_FAILED(pCtx)	((void) 0)
+
+#define LDPIN_TX8_PUSH(pCtx, val)	ldpin_ring8_push(&(pCtx)->state.tx, val)
+#define LDPIN_TX8_PUSH_N(pCtx, src, len)	ldpin_ring8_push_n(&(pCtx)->state.tx, src, len)
+#define LDPIN_TX16_PUSH(pCtx, val)	ldpin_ring16_push(&(pCtx)->state.tx, val)
+
+#endif // LDP_IN_COUNTERS
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_COUNTERS_H
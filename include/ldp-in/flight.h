@@ -0,0 +1,108 @@
+#ifndef LDP_IN_FLIGHT_H
+#define LDP_IN_FLIGHT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+#include <ldp-in/config.h>
+#include "trace.h"	// LDPInTraceInterp_t
+
+// Flight recorder.
+// Unlike trace capture, this is on in every build (unless LDP_IN_FLIGHT_SIZE is 0) and only records the few events that say where an
+//  interpreter has got to: state machine moves, LD-V1000 search/disc switch edges, LD-700 EXT_ACK' edges and error callbacks.
+// Every context has a flight member (LDPInFlight_t) holding its own last LDP_IN_FLIGHT_SIZE - 1 records in a ring that overwrites the
+//  oldest ones, so after a hang the host (a diagnostics screen, a watchdog handler, ...) can drain it with <prefix>_ctx_flight_read
+//  and see what led up to it.  Each record is stamped with the context's own vblank count.
+// The interpreter only ever moves the head and the reader only the tail; a reader that finds the interpreter has lapped it skips to
+//  the oldest record still there and counts the rest as lost, so recording never waits for the reader.
+// On the AVR a record costs a few stores with interrupts briefly disabled, so the interpreters can run from interrupt handlers and
+//  be read from the main loop.  Elsewhere the indices and records are C11 atomics, so the recorder can be read from another thread
+//  while the interpreter runs.
+// Like the counters, it is emptied by <prefix>_ctx_init (or ldpin_flight_reset) but not by <prefix>_ctx_reset, and isn't part of the
+//  state, so snapshots, hashes and rewinding leave it alone.
+
+// what a record means and what its value holds
+typedef enum
+{
+	LDPIN_FLIGHT_STATE = 0,	// LDP-1000, VIP9500SG, VP932 or LD-700 state machine moved; value is the new state
+	LDPIN_FLIGHT_SEARCH,	// LD-V1000 search_pending changed; value is the new value
+	LDPIN_FLIGHT_DISCSWITCH,	// LD-V1000 discswitch_pending changed; value is the new value
+	LDPIN_FLIGHT_EXT_ACK,	// LD-700 EXT_ACK' changed; value is bActive
+	LDPIN_FLIGHT_ERROR	// error callback; value is the code (LD-V1000: 0, since its errors are text)
+} LDPInFlightKind_t;
+
+typedef struct
+{
+	uint8_t u8Event;	// LDPInFlightKind_t in bits 4-7, LDPInTraceInterp_t in bits 0-3
+	uint8_t u8Val;	// see LDPInFlightKind_t
+	uint16_t u16VBlank;	// the context's vblank count when the record was made (wraps)
+} LDPInFlightRecord_t;
+
+#define LDPIN_FLIGHT_KIND(u8Event)	((u8Event) >> 4)
+#define LDPIN_FLIGHT_INTERP(u8Event)	((u8Event) & 0x0F)
+
+#if LDP_IN_FLIGHT_SIZE != 0
+
+#if (LDP_IN_FLIGHT_SIZE < 2) || (LDP_IN_FLIGHT_SIZE > 128) || ((LDP_IN_FLIGHT_SIZE & (LDP_IN_FLIGHT_SIZE - 1)) != 0)
+#error LDP_IN_FLIGHT_SIZE must be 0 or a power of two between 2 and 128
+#endif
+
+// what the library (compiled as C11) sees as atomic is plain to C++ and to the AVR, which locks instead; both are the same size
+#if defined(__cplusplus) || defined(__AVR__) || !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) || defined(__STDC_NO_ATOMICS__)
+typedef volatile uint16_t LDPInFlightIdx_t;
+typedef volatile uint32_t LDPInFlightWord_t;
+#else
+#include <stdatomic.h>
+#define LDP_IN_FLIGHT_C11_ATOMICS
+typedef _Atomic uint16_t LDPInFlightIdx_t;
+typedef _Atomic uint32_t LDPInFlightWord_t;
+#endif
+
+typedef struct
+{
+	LDPInFlightWord_t au32Recs[LDP_IN_FLIGHT_SIZE];	// u8Event in bits 0-7, u8Val in bits 8-15, u16VBlank in bits 16-31
+	LDPInFlightIdx_t u16Head;	// next slot to write (interpreter only; free-running like the rings)
+	LDPInFlightIdx_t u16Tail;	// next slot to read (reader only)
+	uint16_t u16VBlank;	// the context's vblank count (interpreter only, wraps)
+	uint16_t u16Lost;	// records overwritten before they were read (reader only, stops at 65535)
+} LDPInFlight_t;
+
+// Empties the recorder and zeroes its vblank count and lost count.  <prefix>_ctx_init calls this; neither side may be using it.
+void ldpin_flight_reset(LDPInFlight_t *pFlight);
+
+// Adds a record, overwriting the oldest one if the ring is full.  The interpreters call this through LDPIN_FLIGHT.
+void ldpin_flight_push(LDPInFlight_t *pFlight, uint8_t u8Event, uint8_t u8Val);
+
+// Advances the vblank count.  The interpreters with a vblank entry point call this; hosts of the LD-V1000 and PR-7820 should call it
+//  once per vblank on the context's flight member, from wherever they call the interpreter.
+void ldpin_flight_vblank(LDPInFlight_t *pFlight);
+
+// Copies up to u8Cap of the oldest unread records to pDst, oldest first, and marks them as read; returns how many were copied.
+// One reader at a time: the main loop while the interpreter runs in an interrupt handler, or another thread.
+// (<prefix>_ctx_flight_read calls this.)
+uint8_t ldpin_flight_read(LDPInFlight_t *pFlight, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+
+// how many records were overwritten before they were read (stops at 65535, and only counts right if the reader looks at least once
+//  every 65535 records); for the reader
+uint16_t ldpin_flight_lost(LDPInFlight_t *pFlight);
+
+#define LDPIN_FLIGHT_INIT(pCtx)	ldpin_flight_reset(&(pCtx)->flight)
+#define LDPIN_FLIGHT(pCtx, kind, interp, val)	ldpin_flight_push(&(pCtx)->flight, (uint8_t) (((kind) << 4) | (interp)), (uint8_t) (val))
+#define LDPIN_FLIGHT_VBLANK(pCtx)	ldpin_flight_vblank(&(pCtx)->flight)
+
+#else
+
+#define LDPIN_FLIGHT_INIT(pCtx)	((void) 0)
+#define LDPIN_FLIGHT(pCtx, kind, interp, val)	((void) 0)
+#define LDPIN_FLIGHT_VBLANK(pCtx)	((void) 0)
+
+#endif // LDP_IN_FLIGHT_SIZE
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_FLIGHT_H
@@ -2,6 +2,12 @@
 #define LDP_IN_LD700_INTERPRETER_H
 
 #include "datatypes.h"
+#include <ldp-in/config.h>
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -81,6 +87,137 @@ extern void (*g_ld700i_error)(LD700ErrCode_t code, uint8_t u8Val);
 
 // end callbacks
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The ld700i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+#define LD700_NUMBUFSIZE 5	// the number buffer can wraparound to the beginning of it gets too many digits
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to ld700i_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*stop)(void *pUser);
+	void (*eject)(void *pUser);
+	void (*step)(void *pUser, LD700_BOOL bBackward);
+	void (*begin_search)(void *pUser, uint32_t uFrameNumber);
+	void (*change_audio)(void *pUser, LD700_BOOL bEnableLeft, LD700_BOOL bEnableRight);
+	void (*change_audio_squelch)(void *pUser, LD700_BOOL bSquelched);
+	uint32_t (*get_current_picnum)(void *pUser);
+	void (*on_ext_ack_changed)(void *pUser, LD700_BOOL bActive);
+	void (*error)(void *pUser, LD700ErrCode_t code, uint8_t u8Val);
+} LD700Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of LD700Callbacks_t.
+// ld700i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void ld700i_host_play(void *pUser);
+void ld700i_host_pause(void *pUser);
+void ld700i_host_stop(void *pUser);
+void ld700i_host_eject(void *pUser);
+void ld700i_host_step(void *pUser, LD700_BOOL bBackward);
+void ld700i_host_begin_search(void *pUser, uint32_t uFrameNumber);
+void ld700i_host_change_audio(void *pUser, LD700_BOOL bEnableLeft, LD700_BOOL bEnableRight);
+void ld700i_host_change_audio_squelch(void *pUser, LD700_BOOL bSquelched);
+uint32_t ld700i_host_get_current_picnum(void *pUser);
+void ld700i_host_on_ext_ack_changed(void *pUser, LD700_BOOL bActive);
+void ld700i_host_error(void *pUser, LD700ErrCode_t code, uint8_t u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// so we can decode incoming commands properly
+typedef enum
+{
+	LD700I_CMD_PREFIX,
+	LD700I_CMD_PREFIX_XOR,
+	LD700I_CMD,
+	LD700I_CMD_XOR,
+} LD700CmdState_t;
+
+typedef enum
+{
+	LD700I_STATE_NORMAL,
+	LD700I_STATE_FRAME	// in the middle of receiving a frame number
+} LD700State_t;
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	LD700CmdState_t cmd_state;
+	LD700State_t state;
+	uint8_t numBuf[LD700_NUMBUFSIZE];
+	uint8_t u8NumBufStart;	// index of the oldest digit in the number buffer
+	uint8_t u8NumBufEnd;	// index where the next digit goes
+	uint8_t u8NumBufCount;	// this shows how many bytes are in the number buffer
+	uint8_t u8CmdTimeoutVsyncCounter;	// to detect duplicate commands to be dropped
+	LD700_BOOL bNewCmdReceived;	// whether we've received a new command (as opposed to a dupe)
+	LD700_BOOL bExtAckActive;
+	LD700_BOOL bNumBufResetArmed;	// whether we will clear the num buf if any digit is received
+	uint8_t u8QueuedCmd;
+	uint8_t u8LastCmd;	// to drop rapidly repeated commands
+	LD700_BOOL bEscapedActive;	// whether we are in the middle of an escaped command
+} LD700CtxState_t;
+
+typedef struct
+{
+	LD700CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	LD700Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} LD700Ctx_t;
+
+// bump whenever LD700CtxState_t changes (see snapshot.h)
+#define LD700_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	LD700CtxState_t state;
+} LD700Snapshot_t;
+
+// Prepares a context for use (callbacks are copied).  The context is left in the power-on state; call ld700i_ctx_reset before using it just like with ld700i_reset.
+void ld700i_ctx_init(LD700Ctx_t *pCtx, const LD700Callbacks_t *pCallbacks, void *pUser);
+
+void ld700i_ctx_reset(LD700Ctx_t *pCtx);
+void ld700i_ctx_on_new_cmd(LD700Ctx_t *pCtx);
+void ld700i_ctx_write(LD700Ctx_t *pCtx, uint8_t u8Cmd, LD700Status_t status);
+void ld700i_ctx_on_vblank(LD700Ctx_t *pCtx, LD700Status_t status);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void ld700i_ctx_save(const LD700Ctx_t *pCtx, LD700Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns LD700_FALSE without changing anything if the snapshot was saved by another interpreter or build, or is corrupt.
+LD700_BOOL ld700i_ctx_restore(LD700Ctx_t *pCtx, const LD700Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t ld700i_ctx_hash(const LD700Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t ld700i_ctx_flight_read(LD700Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that ld700i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *ld700i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+LD700Ctx_t *ld700i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // c++
@@ -29,6 +29,13 @@ extern "C"
 #endif // C++
 
 #include "datatypes.h"
+#include "ring.h"
+#include "convert.h"
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 /////////////////////////////////////////
 
@@ -69,10 +76,32 @@ typedef enum
 // NOTE: High byte is LDP1000Latency_t associated with this byte, low byte is the actual value
 uint16_t ldp1000i_read();
 
+// Bulk versions of the above for hosts that receive/transmit whole blocks (UART FIFO, DMA) at a time.
+// ldp1000i_write_n is the same as calling ldp1000i_write for each byte.
+// ldp1000i_read_n reads up to u16Cap queued bytes and returns how many were read (0 if nothing is queued).
+void ldp1000i_write_n(const uint8_t *p8Src, uint16_t u16Len);
+uint16_t ldp1000i_read_n(uint16_t *pDst, uint16_t u16Cap);
+
+// Access to the transmit queue without dequeuing each byte.
+// ldp1000i_tx_peek returns a pointer to the oldest queued entry and stores in *pu8Count how many entries can be read contiguously from it
+//  (this may be less than the total queued if the queue wraps; call again after committing to get the rest).
+// ldp1000i_tx_commit removes u8Count entries (which must not exceed the peeked count) once they have been transmitted.
+// Unlike the VP932 and VIP9500SG queues, this isn't a byte stream that a byte-wide UART or DMA can send as it is: like ldp1000i_read,
+//  each entry has the LDP1000Latency_t in the high byte and the value in the low byte.  The host is expected to go through the
+//  entries, waiting out each one's latency (see ldp1000-timing.h) and writing its low byte to the UART, then commit what it sent.
+const uint16_t *ldp1000i_tx_peek(uint8_t *pu8Count);
+void ldp1000i_tx_commit(uint8_t u8Count);
+
 // Should be called after vblank has started and the new VBI data has been read, but before vblank has ended.
 // This is to handle things like the "REPEAT" command
 void ldp1000i_think_during_vblank();
 
+// Optional: supplies the current frame number once per vblank (after the new VBI data has been read).
+// Once this has been called, ADDR INQ (60) replies with the digits kept from the last call instead of calling get_cur_frame_num,
+//  which is also closer to the real player (it latches the frame number from VBI), so keep calling it every vblank.
+// ldp1000i_reset forgets the frame number until the next call.
+void ldp1000i_set_cur_frame_num(uint32_t u32Frame);
+
 // Returns a pointer to the beginning of the text overlay buffer.  The text overlay buffer is always 32-bytes big.
 const uint8_t *ldp1000i_get_text_buffer();
 
@@ -171,6 +200,164 @@ typedef enum
 // gets called by interpreter on error.  the code is an enum while the value relates to the error code (for example the value could be an unknown command byte)
 extern void (*g_ldp1000i_error)(LDP1000ErrCode_t code, uint8_t u8Val);
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The ldp1000i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to ldp1000i_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched);
+	void (*pause)(void *pUser);
+	void (*begin_search)(void *pUser, uint32_t u32FrameNum);
+	void (*step_forward)(void *pUser);
+	void (*step_reverse)(void *pUser);
+	void (*skip)(void *pUser, int16_t i16TracksToSkip);
+	void (*change_audio)(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+	void (*change_video)(void *pUser, LDP1000_BOOL bEnable);
+	LDP1000Status_t (*get_status)(void *pUser);
+	uint32_t (*get_cur_frame_num)(void *pUser);
+	void (*text_enable_changed)(void *pUser, LDP1000_BOOL bEnabled);
+	void (*text_buffer_contents_changed)(void *pUser, const uint8_t *p8Buf32Bytes);
+	void (*text_buffer_start_index_changed)(void *pUser, uint8_t u8StartIdx);
+	void (*text_modes_changed)(void *pUser, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y);
+	void (*error)(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val);
+} LDP1000Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of LDP1000Callbacks_t.
+// ldp1000i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void ldp1000i_host_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched);
+void ldp1000i_host_pause(void *pUser);
+void ldp1000i_host_begin_search(void *pUser, uint32_t u32FrameNum);
+void ldp1000i_host_step_forward(void *pUser);
+void ldp1000i_host_step_reverse(void *pUser);
+void ldp1000i_host_skip(void *pUser, int16_t i16TracksToSkip);
+void ldp1000i_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+void ldp1000i_host_change_video(void *pUser, LDP1000_BOOL bEnable);
+LDP1000Status_t ldp1000i_host_get_status(void *pUser);
+uint32_t ldp1000i_host_get_cur_frame_num(void *pUser);
+void ldp1000i_host_text_enable_changed(void *pUser, LDP1000_BOOL bEnabled);
+void ldp1000i_host_text_buffer_contents_changed(void *pUser, const uint8_t *p8Buf32Bytes);
+void ldp1000i_host_text_buffer_start_index_changed(void *pUser, uint8_t u8StartIdx);
+void ldp1000i_host_text_modes_changed(void *pUser, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y);
+void ldp1000i_host_error(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// so we know what to do when we get an ENTER command
+typedef enum
+{
+	LDP1000I_STATE_NORMAL,
+	LDP1000I_STATE_WAIT_SEARCH,	// in the middle of a search command
+	LDP1000I_STATE_REPEAT0_WAIT_END_FRAME,		// repeat command received, waiting for end frame number
+	LDP1000I_STATE_REPEAT1_WAIT_COUNT,		// repeat end of frame number received, waiting for iteration count
+	LDP1000I_STATE_WAIT_VARIABLE_SPEED, // in the middle of a variable speed play command
+	LDP1000I_STATE_SKIP_FORWARD,	// in the middle of skip forward command
+	LDP1000I_STATE_SKIP_BACKWARD,	// in the middle of skip backward command
+} LDP1000State_t;
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	LDP1000_EmulationType_t type;
+	LDP1000State_t state;
+
+	// these are 16-bit values so that one byte can hold latency information
+	LDPInRing16_t tx;	// bytes waiting to be read by the host
+
+	uint32_t u32Frame;	// current frame entered in for stuff like searching, repeating, etc
+	uint8_t u8FrameIdx;	// which digit we are entering (imagine we are entering into an array)
+	uint8_t u8Idx;	// general purpose index (u8FrameIdx may be merged into this)
+	LDP1000_BOOL directionIsReversed;	// which direction to go for variable speed play, repeat, etc
+	LDP1000_BOOL bSearchActive;	// whether disc is in the middle of a search
+
+	// repeat state
+	LDP1000_BOOL bRepeatActive;
+	uint32_t u32RepeatStartFrame;
+	uint32_t u32RepeatEndFrame;
+	uint8_t u8RepeatIterations;
+
+	LDP1000_BOOL UIC_Input_Active;
+	uint8_t u8UICFunction;	// which UIC function is active (u8Idx must be >0 for this value to mean something)
+	uint8_t u8UIC_X, u8UIC_Y, u8UIC_Mode;
+	uint8_t u8UIC_Window;
+	LDP1000_BOOL bUI_Enabled;
+	uint8_t u8UIC_StartIdx;
+	uint8_t UIC_TextBuf[32];
+	uint8_t u8UIC_PendingNotifications;
+
+	LDPInFrameCache_t frameCache;	// frame number supplied by the host at the last vblank (if any)
+} LDP1000CtxState_t;
+
+typedef struct
+{
+	LDP1000CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	LDP1000Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} LDP1000Ctx_t;
+
+// bump whenever LDP1000CtxState_t changes (see snapshot.h)
+#define LDP1000_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	LDP1000CtxState_t state;
+} LDP1000Snapshot_t;
+
+// Prepares a context for use (callbacks are copied).  The context is left in the power-on state; call ldp1000i_ctx_reset before using it just like with ldp1000i_reset.
+void ldp1000i_ctx_init(LDP1000Ctx_t *pCtx, const LDP1000Callbacks_t *pCallbacks, void *pUser);
+
+void ldp1000i_ctx_reset(LDP1000Ctx_t *pCtx, LDP1000_EmulationType_t type);
+void ldp1000i_ctx_write(LDP1000Ctx_t *pCtx, uint8_t u8Byte);
+LDP1000_BOOL ldp1000i_ctx_can_read(LDP1000Ctx_t *pCtx);
+uint16_t ldp1000i_ctx_read(LDP1000Ctx_t *pCtx);
+void ldp1000i_ctx_write_n(LDP1000Ctx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len);
+uint16_t ldp1000i_ctx_read_n(LDP1000Ctx_t *pCtx, uint16_t *pDst, uint16_t u16Cap);
+const uint16_t *ldp1000i_ctx_tx_peek(LDP1000Ctx_t *pCtx, uint8_t *pu8Count);
+void ldp1000i_ctx_tx_commit(LDP1000Ctx_t *pCtx, uint8_t u8Count);
+void ldp1000i_ctx_think_during_vblank(LDP1000Ctx_t *pCtx);
+void ldp1000i_ctx_set_cur_frame_num(LDP1000Ctx_t *pCtx, uint32_t u32Frame);
+const uint8_t *ldp1000i_ctx_get_text_buffer(LDP1000Ctx_t *pCtx);
+LDP1000_BOOL ldp1000i_ctx_isRepeatActive(LDP1000Ctx_t *pCtx);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void ldp1000i_ctx_save(const LDP1000Ctx_t *pCtx, LDP1000Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns LDP1000_FALSE without changing anything if the snapshot was saved by another interpreter or build, or is corrupt.
+LDP1000_BOOL ldp1000i_ctx_restore(LDP1000Ctx_t *pCtx, const LDP1000Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t ldp1000i_ctx_hash(const LDP1000Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t ldp1000i_ctx_flight_read(LDP1000Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that ldp1000i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *ldp1000i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+LDP1000Ctx_t *ldp1000i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // C++
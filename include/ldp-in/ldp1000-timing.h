@@ -0,0 +1,81 @@
+#ifndef LDP1000_TIMING_H
+#define LDP1000_TIMING_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "ldp1000-interpreter.h"
+
+// When each byte the LDP-1000 sends would arrive at the host, for emulators that want serial timing to match a real player.
+// Instead of polling ldp1000i_can_read every CPU slice, an emulator hands each byte it takes from the interpreter to
+//  ldp1000i_timing_release (or takes them all with ldp1000i_timing_drain) and schedules one event per byte for the time returned.
+// The model follows how the interpreter tags its bytes (the LDP1000Latency_t in the high byte of each queued entry is the delay
+//  before that byte; a multi-byte inquiry answer has its first byte tagged GENERIC and the rest INQUIRY):
+//  - the first byte of a response starts after the delay for its class, counted from the time of the call that produced it
+//     (the write of the command byte it answers, or the vblank for search completions);
+//  - each later byte of the same response starts after the delay for its class, counted from the end of the byte before;
+//  - every byte takes LDP1000_TIMING_BITS_PER_BYTE bit times at the baud rate and never starts before the one in front of it
+//     has finished;
+//  - the release time is when the stop bit has been sent, which is when the host's UART would have the byte ready.
+// Times are in ns on whatever clock the emulator likes, as long as it is the same one for every call.
+// The byte times are exact over any length of stream (the remainder of 10^9 * bits / baud is carried from byte to byte).
+
+#define LDP1000_TIMING_BITS_PER_BYTE 10	// 8N1: start bit, 8 data bits, stop bit
+#define LDP1000_TIMING_MIN_BAUD 1200
+#define LDP1000_TIMING_MAX_BAUD 9600
+#define LDP1000_LATENCY_COUNT (LDP1000_LATENCY_GENERIC + 1)
+
+typedef struct
+{
+	// us before a byte starts, by LDP1000Latency_t: from the call that produced the response for its first byte, from the end of the
+	//  byte before for the rest
+	uint32_t au32DelayUs[LDP1000_LATENCY_COUNT];
+} LDP1000LatencyTable_t;
+
+typedef struct
+{
+	LDP1000LatencyTable_t table;	// copied from ldp1000i_timing_default_table by ldp1000i_timing_init; the host may change it
+	uint32_t u32Baud;
+	uint64_t u64LineFreeNs;	// when the last byte scheduled finishes
+	uint32_t u32LineFrac;	// what u64LineFreeNs leaves out, in 1/u32Baud ns
+	uint64_t u64LastCmdNs;	// u64CmdNs of the last call; a byte passed to ldp1000i_timing_release with a different one starts a new response
+	uint8_t bStarted;	// a byte has been scheduled since ldp1000i_timing_init
+	uint8_t u8Carry;	// bytes the last ldp1000i_timing_drain left queued, which belong to the response it was timing
+} LDP1000Timing_t;
+
+typedef struct
+{
+	uint8_t u8Val;
+	uint64_t u64ReleaseNs;
+} LDP1000TimedByte_t;
+
+// The delays for a model.
+// Nobody has captured a real player's response times yet, so these are estimates (the LDP-1450, with its faster CPU, answering
+//  in about half the time of the LDP-1000A, play/still waiting on the mechanism, and inquiry digits coming out with a short gap
+//  between them); hosts with measurements should overwrite them.
+const LDP1000LatencyTable_t *ldp1000i_timing_default_table(LDP1000_EmulationType_t type);
+
+// Starts an idle line at u32Baud with the default delays for type.
+// The players support 1200 to 9600 baud; a rate outside that (including 0) is clamped to the nearest end.
+void ldp1000i_timing_init(LDP1000Timing_t *pTiming, LDP1000_EmulationType_t type, uint32_t u32Baud);
+
+// Returns when the byte u16Entry (as returned by ldp1000i_read or ldp1000i_tx_peek) will have arrived, given that the call
+//  that produced it was made at u64CmdNs.  Bytes must be passed in the order they were queued, with u64CmdNs never going backwards.
+// A byte whose u64CmdNs is the same as the byte before's is taken to be part of the same response, so each interpreter call whose
+//  bytes are passed here must have a time of its own; use ldp1000i_timing_drain if two calls can happen at the same time.
+uint64_t ldp1000i_timing_release(LDP1000Timing_t *pTiming, uint64_t u64CmdNs, uint16_t u16Entry);
+
+// Takes up to u8Cap bytes from pCtx's transmit queue into pDst, each with its release time; returns how many.
+// Call it after each ldp1000i_ctx_write and ldp1000i_ctx_think_during_vblank with the time of that call (two calls may share a time).
+// The bytes it takes that were queued by that call are timed as a new response. Bytes that didn't fit in u8Cap stay queued and are
+//  timed by the next call as the rest of that response, before anything queued since (a u8Cap of LDP_IN_RING_SIZE always takes
+//  everything).
+uint8_t ldp1000i_timing_drain(LDP1000Timing_t *pTiming, LDP1000Ctx_t *pCtx, uint64_t u64CmdNs, LDP1000TimedByte_t *pDst, uint8_t u8Cap);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP1000_TIMING_H
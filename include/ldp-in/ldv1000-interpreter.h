@@ -27,6 +27,13 @@
 #define LDV1000_INTERPRETER_H
 
 #include "datatypes.h"
+#include "ring.h"
+#include "convert.h"
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 typedef enum
 {
@@ -68,6 +75,22 @@ void reset_ldv1000i(LDV1000_EmulationType_t type);
 unsigned char read_ldv1000i();
 void write_ldv1000i (unsigned char value);
 
+// Bulk versions of the above.  Every read of the LD-V1000 returns a byte (the status if nothing else is queued),
+//  so read_n_ldv1000i always fills u16Count bytes; it is the same as calling read_ldv1000i that many times.
+void write_n_ldv1000i(const unsigned char *pSrc, uint16_t u16Len);
+void read_n_ldv1000i(unsigned char *pDst, uint16_t u16Count);
+
+// Optional: supplies the current frame number once per vblank (after the new VBI data has been read).
+// Once this has been called, "get current frame" (C2) replies with the digits kept from the last call instead of calling get_cur_frame_num,
+//  so keep calling it every vblank.  reset_ldv1000i forgets the frame number until the next call.
+void set_cur_frame_num_ldv1000i(uint32_t u32Frame);
+
+// Optional: tells the interpreter the player's status whenever it changes (call it at least once per vblank).
+// Once this has been called the interpreter stops calling get_status and keeps the status byte ready, so that a status strobe with
+//  nothing queued and nothing changed is just a load (set_cur_frame_num_ldv1000i should also be used so that autostop doesn't need the frame callback).
+// reset_ldv1000i goes back to calling get_status until the next call.
+void set_status_ldv1000i(LDV1000Status_t status);
+
 // CALLBACKS
 
 // returns current status of laserdisc player (playing, paused, etc..)
@@ -125,6 +148,141 @@ extern void (*g_ldv1000i_change_super_mode)(LDV1000_BOOL bEnabled);
 
 // end callbacks
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The ldv1000i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+#define LDV1000_FRAMESIZE 5
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to ldv1000i_ctx_init
+typedef struct
+{
+	LDV1000Status_t (*get_status)(void *pUser);
+	uint32_t (*get_cur_frame_num)(void *pUser);
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*begin_search)(void *pUser, uint32_t uFrameNumber);
+	void (*step_reverse)(void *pUser);
+	void (*change_speed)(void *pUser, uint8_t uNumerator, uint8_t uDenominator);
+	void (*skip_forward)(void *pUser, uint8_t uTracks);
+	void (*skip_backward)(void *pUser, uint8_t uTracks);
+	void (*change_audio)(void *pUser, uint8_t uChannel, uint8_t uEnable);
+	void (*on_error)(void *pUser, const char *pszErrMsg);
+	const uint8_t *(*query_available_discs)(void *pUser);
+	uint8_t (*query_active_disc)(void *pUser);
+	void (*begin_changing_to_disc)(void *pUser, uint8_t idDisc);
+	void (*change_seek_delay)(void *pUser, LDV1000_BOOL bEnabled);
+	void (*change_spinup_delay)(void *pUser, LDV1000_BOOL bEnabled);
+	void (*change_super_mode)(void *pUser, LDV1000_BOOL bEnabled);
+} LDV1000Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of LDV1000Callbacks_t.
+// ldv1000i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+LDV1000Status_t ldv1000i_host_get_status(void *pUser);
+uint32_t ldv1000i_host_get_cur_frame_num(void *pUser);
+void ldv1000i_host_play(void *pUser);
+void ldv1000i_host_pause(void *pUser);
+void ldv1000i_host_begin_search(void *pUser, uint32_t uFrameNumber);
+void ldv1000i_host_step_reverse(void *pUser);
+void ldv1000i_host_change_speed(void *pUser, uint8_t uNumerator, uint8_t uDenominator);
+void ldv1000i_host_skip_forward(void *pUser, uint8_t uTracks);
+void ldv1000i_host_skip_backward(void *pUser, uint8_t uTracks);
+void ldv1000i_host_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable);
+void ldv1000i_host_on_error(void *pUser, const char *pszErrMsg);
+const uint8_t *ldv1000i_host_query_available_discs(void *pUser);
+uint8_t ldv1000i_host_query_active_disc(void *pUser);
+void ldv1000i_host_begin_changing_to_disc(void *pUser, uint8_t idDisc);
+void ldv1000i_host_change_seek_delay(void *pUser, LDV1000_BOOL bEnabled);
+void ldv1000i_host_change_spinup_delay(void *pUser, LDV1000_BOOL bEnabled);
+void ldv1000i_host_change_super_mode(void *pUser, LDV1000_BOOL bEnabled);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	LDPInRing8_t tx;	// bytes waiting to be read by the host
+	unsigned int autostop_frame;	// which frame we need to stop on (if any)
+	LDV1000_BOOL audio1;
+	LDV1000_BOOL audio2;
+	LDV1000_BOOL audio_temp_mute;	// flag set on FORWARD 1X, 2X, etc., which don't play audio unless a PLAY command was given first
+	char frame[LDV1000_FRAMESIZE + 1];	// holds the digits sent to the LD-V1000
+	unsigned char output;
+	LDV1000_BOOL search_pending;	// whether the LD-V1000 is currently in the middle of a search operation or not
+	LDV1000_DiscSwitchState_t discswitch_state;	// state of extended disc switch command
+	LDV1000_BOOL discswitch_pending;	// whether LD-V1000 is currently in the middle of a disc swap operation or not
+	unsigned int search_delay_iterations;	// how many times read is called before our search is finally finished
+	LDV1000_EmulationType_t emulation_type;
+	LDPInFrameCache_t frame_cache;	// frame number supplied by the host at the last vblank (if any)
+	LDV1000_BOOL status_notified;	// whether the host supplies the status (see set_status_ldv1000i)
+	LDV1000Status_t notified_status;
+	LDV1000_BOOL read_cached;	// if true, the next read returns read_cache without doing anything else
+	unsigned char read_cache;
+} LDV1000CtxState_t;
+
+typedef struct
+{
+	LDV1000CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	LDV1000Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} LDV1000Ctx_t;
+
+// bump whenever LDV1000CtxState_t changes (see snapshot.h)
+#define LDV1000_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	LDV1000CtxState_t state;
+} LDV1000Snapshot_t;
+
+// Prepares a context for use (callbacks are copied).  The context is left in the power-on state; call ldv1000i_ctx_reset before using it just like with reset_ldv1000i.
+void ldv1000i_ctx_init(LDV1000Ctx_t *pCtx, const LDV1000Callbacks_t *pCallbacks, void *pUser);
+
+void ldv1000i_ctx_reset(LDV1000Ctx_t *pCtx, LDV1000_EmulationType_t type);
+unsigned char ldv1000i_ctx_read(LDV1000Ctx_t *pCtx);
+void ldv1000i_ctx_write(LDV1000Ctx_t *pCtx, unsigned char value);
+void ldv1000i_ctx_write_n(LDV1000Ctx_t *pCtx, const unsigned char *pSrc, uint16_t u16Len);
+void ldv1000i_ctx_read_n(LDV1000Ctx_t *pCtx, unsigned char *pDst, uint16_t u16Count);
+void ldv1000i_ctx_set_cur_frame_num(LDV1000Ctx_t *pCtx, uint32_t u32Frame);
+void ldv1000i_ctx_set_status(LDV1000Ctx_t *pCtx, LDV1000Status_t status);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void ldv1000i_ctx_save(const LDV1000Ctx_t *pCtx, LDV1000Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns LDV1000_FALSE without changing anything if the snapshot was saved by another interpreter or build, or is corrupt.
+LDV1000_BOOL ldv1000i_ctx_restore(LDV1000Ctx_t *pCtx, const LDV1000Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t ldv1000i_ctx_hash(const LDV1000Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t ldv1000i_ctx_flight_read(LDV1000Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that ldv1000i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *ldv1000i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by reset_ldv1000i/read_ldv1000i/write_ldv1000i
+LDV1000Ctx_t *ldv1000i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // c++
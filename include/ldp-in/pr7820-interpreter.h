@@ -23,6 +23,13 @@
 #ifndef PR7820_INTERPRETER_H
 #define PR7820_INTERPRETER_H
 
+#include <ldp-in/config.h>
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
+
 typedef enum
 {  
    PR7820_ERROR, PR7820_SEARCHING, PR7820_STOPPED, PR7820_PLAYING, PR7820_PAUSED, PR7820_SPINNING_UP
@@ -80,6 +87,102 @@ extern void (*g_pr7820i_on_error)(PR7820ErrCode_t code, unsigned char u8Val);
 
 // end callbacks
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The pr7820i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+#define PR7820_FRAMESIZE 5
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to pr7820i_ctx_init
+typedef struct
+{
+	PR7820Status_t (*get_status)(void *pUser);
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*begin_search)(void *pUser, unsigned int uFrameNumber);
+	void (*change_audio)(void *pUser, unsigned char uChannel, unsigned char uEnable);
+	void (*enable_super_mode)(void *pUser);
+	void (*on_error)(void *pUser, PR7820ErrCode_t code, unsigned char u8Val);
+} PR7820Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of PR7820Callbacks_t.
+// pr7820i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+PR7820Status_t pr7820i_host_get_status(void *pUser);
+void pr7820i_host_play(void *pUser);
+void pr7820i_host_pause(void *pUser);
+void pr7820i_host_begin_search(void *pUser, unsigned int uFrameNumber);
+void pr7820i_host_change_audio(void *pUser, unsigned char uChannel, unsigned char uEnable);
+void pr7820i_host_enable_super_mode(void *pUser);
+void pr7820i_host_on_error(void *pUser, PR7820ErrCode_t code, unsigned char u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	PR7820_BOOL bAudioEnabled[2];
+	char frame[PR7820_FRAMESIZE + 1]; // holds the digits sent to the player
+} PR7820CtxState_t;
+
+typedef struct
+{
+	PR7820CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	PR7820Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} PR7820Ctx_t;
+
+// bump whenever PR7820CtxState_t changes (see snapshot.h)
+#define PR7820_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	PR7820CtxState_t state;
+} PR7820Snapshot_t;
+
+// Prepares a context for use (callbacks are copied) and puts it in the power-on state.
+void pr7820i_ctx_init(PR7820Ctx_t *pCtx, const PR7820Callbacks_t *pCallbacks, void *pUser);
+
+void pr7820i_ctx_reset(PR7820Ctx_t *pCtx);
+PR7820_BOOL pr7820i_ctx_is_busy(PR7820Ctx_t *pCtx);
+void pr7820i_ctx_write(PR7820Ctx_t *pCtx, unsigned char value);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void pr7820i_ctx_save(const PR7820Ctx_t *pCtx, PR7820Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns PR7820_FALSE without changing anything if the snapshot was saved by another interpreter or build.
+PR7820_BOOL pr7820i_ctx_restore(PR7820Ctx_t *pCtx, const PR7820Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t pr7820i_ctx_hash(const PR7820Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t pr7820i_ctx_flight_read(PR7820Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that pr7820i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *pr7820i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+PR7820Ctx_t *pr7820i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // c++
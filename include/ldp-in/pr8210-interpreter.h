@@ -2,6 +2,12 @@
 #define PR8210_INTERPRETER_H
 
 #include "datatypes.h"
+#include <ldp-in/config.h>
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -82,6 +88,116 @@ extern void (*g_pr8210i_error)(PR8210ErrCode_t code, uint16_t u16Val);
 
 // end callbacks
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The pr8210i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to pr8210i_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*step)(void *pUser, int8_t i8TracksToStep);
+	void (*begin_search)(void *pUser, uint32_t uFrameNumber);
+	void (*change_audio)(void *pUser, uint8_t uChannel, uint8_t uEnable);
+	void (*skip)(void *pUser, int8_t i8TracksToSkip);
+	void (*change_auto_track_jump)(void *pUser, PR8210_BOOL bAutoTrackJumpEnabled);
+	PR8210_BOOL (*is_player_busy)(void *pUser);
+	void (*change_standby)(void *pUser, PR8210_BOOL bRaised);
+	void (*error)(void *pUser, PR8210ErrCode_t code, uint16_t u16Val);
+} PR8210Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of PR8210Callbacks_t.
+// pr8210i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void pr8210i_host_play(void *pUser);
+void pr8210i_host_pause(void *pUser);
+void pr8210i_host_step(void *pUser, int8_t i8TracksToStep);
+void pr8210i_host_begin_search(void *pUser, uint32_t uFrameNumber);
+void pr8210i_host_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable);
+void pr8210i_host_skip(void *pUser, int8_t i8TracksToSkip);
+void pr8210i_host_change_auto_track_jump(void *pUser, PR8210_BOOL bAutoTrackJumpEnabled);
+PR8210_BOOL pr8210i_host_is_player_busy(void *pUser);
+void pr8210i_host_change_standby(void *pUser, PR8210_BOOL bRaised);
+void pr8210i_host_error(void *pUser, PR8210ErrCode_t code, uint16_t u16Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	uint8_t u8OldMsg, u8CurMsg;	// so that we know whether incoming message is okay
+	uint32_t u32Frame;
+	uint8_t u8FrameIdx;
+	uint8_t u8Audio[2];
+	PR8210_BOOL bJumpTriggerRaised;
+	PR8210_BOOL bScanCRaised;
+	PR8210_BOOL bPlayerBusy;
+	PR8210_BOOL bStandByRaised;
+	uint8_t u8VsyncCounter;
+	PR8210_BOOL bInternalMode;	// whether jmp trig and scan c are internally defined or externally defined (true means internal)
+} PR8210CtxState_t;
+
+typedef struct
+{
+	PR8210CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	PR8210Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} PR8210Ctx_t;
+
+// bump whenever PR8210CtxState_t changes (see snapshot.h)
+#define PR8210_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	PR8210CtxState_t state;
+} PR8210Snapshot_t;
+
+// Prepares a context for use (callbacks are copied) and puts it in the power-on state.
+void pr8210i_ctx_init(PR8210Ctx_t *pCtx, const PR8210Callbacks_t *pCallbacks, void *pUser);
+
+void pr8210i_ctx_reset(PR8210Ctx_t *pCtx);
+void pr8210i_ctx_write(PR8210Ctx_t *pCtx, uint16_t u16Msg);
+void pr8210i_ctx_on_jmp_trigger_changed(PR8210Ctx_t *pCtx, PR8210_BOOL bJmpTrigRaised, PR8210_BOOL bScanCRaised);
+void pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(PR8210Ctx_t *pCtx, PR8210_BOOL bInternal);
+void pr8210i_ctx_on_vblank(PR8210Ctx_t *pCtx);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void pr8210i_ctx_save(const PR8210Ctx_t *pCtx, PR8210Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns PR8210_FALSE without changing anything if the snapshot was saved by another interpreter or build.
+PR8210_BOOL pr8210i_ctx_restore(PR8210Ctx_t *pCtx, const PR8210Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t pr8210i_ctx_hash(const PR8210Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t pr8210i_ctx_flight_read(PR8210Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that pr8210i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *pr8210i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+PR8210Ctx_t *pr8210i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // c++
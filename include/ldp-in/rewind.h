@@ -0,0 +1,72 @@
+#ifndef LDP_IN_REWIND_H
+#define LDP_IN_REWIND_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+
+// Rewind buffer: an interpreter's snapshots (see snapshot.h) from the last few seconds or minutes, one per vblank, kept in a block of
+//  memory supplied by the host, so that the game can be rewound to any of those vblanks.
+// The state barely changes from one vblank to the next, so only every u16KeyInterval-th snapshot (a keyframe) is stored in full.
+// The ones in between are stored as the XOR of the snapshot and the keyframe before it, run-length coded: a snapshot that matches
+//  its keyframe costs one byte, and one that differs in a frame number or a counter costs a few.
+// When the memory is full, the oldest keyframe is dropped along with the snapshots that depend on it.
+// Snapshots are handled as plain bytes, so one rewind buffer works with any interpreter's <X>Snapshot_t.
+
+// a keyframe and the snapshots stored as differences from it
+typedef struct
+{
+	uint32_t u32Offset;	// where the keyframe's entry starts in the log
+	uint32_t u32First;	// number of the keyframe's snapshot
+	uint16_t u16Count;	// how many snapshots (keyframe included)
+} LDPInRewindGroup_t;
+
+typedef struct
+{
+	uint8_t *p8Log;	// the entries, oldest first, wrapping around at the end
+	uint32_t u32LogSize;
+	uint32_t u32LogStart;	// offset of the oldest entry
+	uint32_t u32LogUsed;
+	LDPInRewindGroup_t *pGroups;	// oldest first, wrapping around at the end
+	uint16_t u16MaxGroups;
+	uint16_t u16FirstGroup;
+	uint16_t u16GroupCount;
+	uint16_t u16SnapSize;
+	uint16_t u16KeyInterval;
+	uint8_t *p8Key;	// copy of the newest group's keyframe
+	uint32_t u32Next;	// number of the next snapshot to be pushed
+} LDPInRewind_t;
+
+// Sets up a rewind buffer in the u32MemSize bytes at pMem (which must be aligned for a uint32_t) for snapshots of u16SnapSize bytes,
+//  with a keyframe every u16KeyInterval snapshots (60 is a keyframe per second).
+// The first snapshot pushed gets number u32First; pass the vblank count to number them by vblank.
+// Returns 0 if the memory can't hold at least two keyframes.
+uint8_t ldpin_rewind_init(LDPInRewind_t *pRw, void *pMem, uint32_t u32MemSize, uint16_t u16SnapSize, uint16_t u16KeyInterval, uint32_t u32First);
+
+// adds the next snapshot (u16SnapSize bytes), dropping the oldest ones if there isn't room
+void ldpin_rewind_push(LDPInRewind_t *pRw, const void *pSnap);
+
+// the number of the oldest snapshot held (snapshots oldest to ldpin_rewind_next() - 1 can be retrieved)
+uint32_t ldpin_rewind_oldest(const LDPInRewind_t *pRw);
+
+// the number the next snapshot pushed will get
+uint32_t ldpin_rewind_next(const LDPInRewind_t *pRw);
+
+// Copies snapshot u32Num into pDst (u16SnapSize bytes).  Returns 0 if it isn't held (too old, or not pushed yet).
+uint8_t ldpin_rewind_get(const LDPInRewind_t *pRw, uint32_t u32Num, void *pDst);
+
+// Like ldpin_rewind_get, but also forgets every snapshot after u32Num, so that the next one pushed is u32Num + 1.
+// Restore the snapshot into the interpreter (<prefix>_ctx_restore) and carry on from that vblank.
+uint8_t ldpin_rewind_to(LDPInRewind_t *pRw, uint32_t u32Num, void *pDst);
+
+// bytes of the log currently holding snapshots (for measuring how much memory a period of play needs)
+uint32_t ldpin_rewind_bytes_used(const LDPInRewind_t *pRw);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_REWIND_H
@@ -0,0 +1,77 @@
+#ifndef LDP_IN_RING_H
+#define LDP_IN_RING_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+#include <ldp-in/config.h>
+
+// Fixed-size FIFO shared by the interpreters for their transmit queues.
+// The capacity is a power of two so that indexing is just a mask (no wraparound compare on every push/pop).
+// Head and tail are free-running 8-bit counters; head - tail is how many entries are queued.
+// Only the producer modifies the head and only the consumer modifies the tail, so one side may run in an interrupt
+//  handler (on a single core) without any locking.
+
+#if (LDP_IN_RING_SIZE < 2) || (LDP_IN_RING_SIZE > 128) || ((LDP_IN_RING_SIZE & (LDP_IN_RING_SIZE - 1)) != 0)
+#error LDP_IN_RING_SIZE must be a power of two between 2 and 128
+#endif
+
+#define LDP_IN_RING_MASK (LDP_IN_RING_SIZE - 1)
+
+// 8-bit entries
+typedef struct
+{
+	uint8_t buf[LDP_IN_RING_SIZE];
+	volatile uint8_t u8Head;	// next slot to write
+	volatile uint8_t u8Tail;	// next slot to read
+	uint8_t u8Overflows;	// how many pushes were dropped because the ring was full (stops at 255)
+} LDPInRing8_t;
+
+// 16-bit entries (for interpreters that tag each byte with extra information in the high byte)
+typedef struct
+{
+	uint16_t buf[LDP_IN_RING_SIZE];
+	volatile uint8_t u8Head;
+	volatile uint8_t u8Tail;
+	uint8_t u8Overflows;
+} LDPInRing16_t;
+
+// empties the ring and clears the overflow count
+void ldpin_ring8_reset(LDPInRing8_t *pRing);
+
+// returns how many entries are queued
+uint8_t ldpin_ring8_count(const LDPInRing8_t *pRing);
+
+// adds an entry; returns 0 (and counts an overflow) if the ring was full, otherwise non-zero
+uint8_t ldpin_ring8_push(LDPInRing8_t *pRing, uint8_t u8Val);
+
+// Adds up to u8Len entries, publishing them all at once; returns how many were added.
+// Entries that don't fit are dropped and counted as overflows, just like pushing them one at a time.
+uint8_t ldpin_ring8_push_n(LDPInRing8_t *pRing, const uint8_t *p8Src, uint8_t u8Len);
+
+// removes the oldest entry; the ring must not be empty
+uint8_t ldpin_ring8_pop(LDPInRing8_t *pRing);
+
+// Returns a pointer to the oldest entry and stores in *pu8Count how many entries can be read contiguously from it.
+// Call ldpin_ring8_commit once they have been consumed.
+const uint8_t *ldpin_ring8_peek(const LDPInRing8_t *pRing, uint8_t *pu8Count);
+
+// removes u8Count entries (must not exceed what ldpin_ring8_peek returned)
+void ldpin_ring8_commit(LDPInRing8_t *pRing, uint8_t u8Count);
+
+// same as above, for 16-bit entries
+void ldpin_ring16_reset(LDPInRing16_t *pRing);
+uint8_t ldpin_ring16_count(const LDPInRing16_t *pRing);
+uint8_t ldpin_ring16_push(LDPInRing16_t *pRing, uint16_t u16Val);
+uint16_t ldpin_ring16_pop(LDPInRing16_t *pRing);
+const uint16_t *ldpin_ring16_peek(const LDPInRing16_t *pRing, uint8_t *pu8Count);
+void ldpin_ring16_commit(LDPInRing16_t *pRing, uint8_t u8Count);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_RING_H
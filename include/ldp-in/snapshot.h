@@ -0,0 +1,38 @@
+#ifndef LDP_IN_SNAPSHOT_H
+#define LDP_IN_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+#include <ldp-in/trace.h>
+
+// Save states for the interpreters (for emulator save states and rollback).
+// A snapshot is a copy of everything in an interpreter's context except the callbacks and pUser, behind a small header.
+// The state holds no pointers (buffer positions are indices), so a snapshot can be stored or sent anywhere, and saving or restoring
+//  one is a single memcpy of the state; cheap enough to do every vblank.
+// Each interpreter has its own <X>Snapshot_t, <prefix>_ctx_save and <prefix>_ctx_restore (see its header).
+// The state's layout depends on the build (LDP_IN_RING_SIZE, the size of enums, padding), so a snapshot is meant for the build that
+//  saved it; restoring refuses a snapshot from another interpreter, from a different <X>_SNAPSHOT_VERSION or of a different size.
+// Snapshots may come from outside the program (a save state file), so restoring also refuses one whose buffer positions are out
+//  of range rather than let the interpreter index past its buffers.
+
+typedef struct
+{
+	uint8_t u8Interp;	// LDPInTraceInterp_t of the interpreter that saved it
+	uint8_t u8Version;	// that interpreter's <X>_SNAPSHOT_VERSION
+	uint16_t u16Size;	// sizeof its <X>CtxState_t
+} LDPInSnapshotHeader_t;
+
+void ldpin_snapshot_header_init(LDPInSnapshotHeader_t *pHdr, uint8_t u8Interp, uint8_t u8Version, uint16_t u16Size);
+
+// returns non-zero if the header matches what the interpreter would write
+uint8_t ldpin_snapshot_header_check(const LDPInSnapshotHeader_t *pHdr, uint8_t u8Interp, uint8_t u8Version, uint16_t u16Size);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_SNAPSHOT_H
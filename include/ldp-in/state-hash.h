@@ -0,0 +1,83 @@
+#ifndef LDP_IN_STATE_HASH_H
+#define LDP_IN_STATE_HASH_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+
+// 64-bit hash of an interpreter's logical state, for catching two emulations of the same game drifting apart (netplay desyncs).
+// Each interpreter has <prefix>_ctx_hash, cheap enough to call every vblank, and <prefix>_state_fields, the table that the hash is
+//  computed from (see its header).
+// The hash is taken field by field rather than over the raw state, so only what the interpreter will act on counts:
+//  - integers, enums and booleans are hashed by value (4 bytes, least significant first), so the size of an enum doesn't matter
+//  - a transmit ring is hashed as the bytes queued in it, oldest first, so it doesn't matter where in the ring they happen to sit
+//  - the same goes for the circular number buffers, and only the used part of a buffer filled from the start counts
+//  - padding is left out
+// Two states that hash differently will behave differently; two that hash the same almost certainly won't.
+// The hash is FNV-1a over those bytes.  The tables and hash functions are in their own source file, so firmware that doesn't hash
+//  doesn't link them (on the AVR the field names would otherwise take up SRAM).
+
+typedef enum
+{
+	LDPIN_FIELD_UINT,	// an integer, enum or boolean of u8Size (1, 2 or 4) bytes
+	LDPIN_FIELD_BYTES,	// u8Size bytes, as they are
+	LDPIN_FIELD_RING8,	// an LDPInRing8_t: its entry count, the queued entries and the overflow count
+	LDPIN_FIELD_RING16,	// an LDPInRing16_t: the same, with each entry as 2 bytes
+	LDPIN_FIELD_QUEUE,	// a circular buffer of u8Size bytes: the count (the byte at u16CountOffset), then that many bytes from the index at u16IdxOffset
+	LDPIN_FIELD_PREFIX	// a buffer of u8Size bytes filled from the start: the count (the byte at u16CountOffset), then that many bytes
+} LDPInFieldKind_t;
+
+typedef struct
+{
+	const char *pszName;
+	uint16_t u16Offset;	// where the field is in the <X>CtxState_t
+	uint8_t u8Size;
+	uint8_t u8Kind;	// LDPInFieldKind_t
+	uint16_t u16IdxOffset;	// LDPIN_FIELD_QUEUE only
+	uint16_t u16CountOffset;	// LDPIN_FIELD_QUEUE and LDPIN_FIELD_PREFIX only
+} LDPInStateField_t;
+
+// the most bytes that ldpin_state_field_value can produce
+#define LDPIN_STATE_FIELD_MAX_VALUE 260
+
+// Hashes the state at pState (an interpreter's <X>CtxState_t, or the state member of a snapshot) using its field table.
+uint64_t ldpin_state_hash(const void *pState, const LDPInStateField_t *pFields, uint8_t u8FieldCount);
+
+// Stores in p8Dst the bytes that ldpin_state_hash hashes for one field and returns how many there are (for showing which fields
+//  of two states differ, and how).
+uint16_t ldpin_state_field_value(const void *pState, const LDPInStateField_t *pField, uint8_t *p8Dst);
+
+/////////////////////////////////////////////////////////////////
+
+// Hash stream: a file of per-vblank hashes from one run, for tools/ldp_in_hashdiff to compare against another run.
+//
+// Header (LDPIN_HASHSTREAM_HEADER_SIZE bytes): 'L' 'D' 'P' 'H', version, the interpreter (LDPInTraceInterp_t), and the size of the
+//  snapshot stored with each hash (16 bits, least significant byte first), or 0 if there are none.
+// Then one fixed-size record per vblank: the vblank number (32 bits) and the hash (64 bits), least significant byte first, followed
+//  by the interpreter's <X>Snapshot_t if the header says so.  With snapshots, the tool can also say which fields differ.
+// A host that rewinds (rollback) can write a vblank again; the last record for a vblank is the one that counts.
+
+#define LDPIN_HASHSTREAM_VERSION 1
+#define LDPIN_HASHSTREAM_HEADER_SIZE 8
+#define LDPIN_HASHSTREAM_RECORD_SIZE 12	// not counting the snapshot
+
+// Stores the header in p8Dst.  Pass u16SnapSize = sizeof(<X>Snapshot_t) to include a snapshot with every record, or 0.
+void ldpin_hashstream_write_header(uint8_t *p8Dst, uint8_t u8Interp, uint16_t u16SnapSize);
+
+// Checks the header at p8Src.  Returns non-zero (storing the interpreter and snapshot size) if it is a hash stream this code can read.
+uint8_t ldpin_hashstream_read_header(const uint8_t *p8Src, uint32_t u32Len, uint8_t *pu8Interp, uint16_t *pu16SnapSize);
+
+// Stores a record in p8Dst (LDPIN_HASHSTREAM_RECORD_SIZE bytes, plus u16SnapSize for the snapshot at pSnap) and returns its size.
+uint16_t ldpin_hashstream_write_record(uint8_t *p8Dst, uint32_t u32VBlank, uint64_t u64Hash, const void *pSnap, uint16_t u16SnapSize);
+
+// reads the vblank number and hash of the record at p8Src
+void ldpin_hashstream_read_record(const uint8_t *p8Src, uint32_t *pu32VBlank, uint64_t *pu64Hash);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_STATE_HASH_H
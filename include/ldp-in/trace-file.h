@@ -0,0 +1,73 @@
+#ifndef LDP_IN_TRACE_FILE_H
+#define LDP_IN_TRACE_FILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include "datatypes.h"
+#include "trace.h"
+
+// Compact, versioned byte format for storing the records from trace.h (see tools/replay for a player).
+// A trace file is a header followed by one encoded record after another, with no index, so it can be written as the records come in
+//  and read straight out of a memory-mapped file.
+//
+// Header (LDPIN_TRACEFILE_HEADER_SIZE bytes): 'L' 'D' 'P' 'T', version, the interpreter the trace is for (LDPInTraceInterp_t),
+//  and the vblank count before the first record (16 bits, least significant byte first).
+//
+// Each record starts with a tag byte:
+//  bits 0-3: the record kind (LDPInTraceKind_t), or LDPIN_TRACEFILE_VBLANK_SYNC
+//  bit 4: the record is from a different interpreter than the header's (usually LDPIN_TRACE_HOST); the interpreter follows in the next byte
+//  bits 5-7: the value if it is less than 7; 7 means that the value follows as a varint (7 bits per byte, least significant first, bit 7 set on all but the last)
+// The vblank count is not stored; it is counted from the VBLANK records.  When that doesn't agree with the record (records were dropped
+//  because the trace buffer filled up), a LDPIN_TRACEFILE_VBLANK_SYNC tag carrying the new count comes first.
+// SET_FRAME values are stored as the difference from the previous SET_FRAME, and RESULT values as the difference from the previous
+//  result of the same callback (zigzag encoded so that small negative differences stay small).  So while a disc plays, a frame number
+//  costs one byte, and a status that hasn't changed fits in the tag.
+
+// 2: added LDPIN_TRACE_ERROR records (version 1 files can still be read; they just don't have any)
+#define LDPIN_TRACEFILE_VERSION 2
+#define LDPIN_TRACEFILE_HEADER_SIZE 8
+
+// the most bytes that ldpin_tracefile_encode can produce for one record
+#define LDPIN_TRACEFILE_MAX_ENCODED 11
+
+// tag kind that isn't a record (see above)
+#define LDPIN_TRACEFILE_VBLANK_SYNC 0x0F
+
+// callbacks past this index have their results stored in full
+#define LDPIN_TRACEFILE_MAX_CALLBACKS 24
+
+// Encoder/decoder state.  A file must be decoded in order from the start with a fresh state, as it was encoded.
+typedef struct
+{
+	uint8_t u8Interp;	// from the header
+	uint8_t u8LastCallback;	// index of the last CALLBACK record (the next RESULT belongs to it)
+	uint16_t u16VBlank;	// vblank count of the last record
+	uint32_t u32LastFrame;	// last SET_FRAME value
+	uint32_t au32LastResult[LDPIN_TRACEFILE_MAX_CALLBACKS];	// last RESULT value of each callback
+} LDPInTraceCodec_t;
+
+// Prepares pCodec to encode a trace for u8Interp whose first record comes after vblank count u16VBlank (0 after ldpin_trace_reset).
+void ldpin_tracefile_init(LDPInTraceCodec_t *pCodec, uint8_t u8Interp, uint16_t u16VBlank);
+
+// Stores the header for pCodec in p8Dst (LDPIN_TRACEFILE_HEADER_SIZE bytes).  Call this before encoding any records.
+void ldpin_tracefile_write_header(const LDPInTraceCodec_t *pCodec, uint8_t *p8Dst);
+
+// Checks the header at p8Src and prepares pCodec to decode the records after it.
+// Returns non-zero if it is a trace of this version or an earlier one; zero if u32Len is too short, the magic is wrong, or the version is unknown.
+uint8_t ldpin_tracefile_read_header(LDPInTraceCodec_t *pCodec, const uint8_t *p8Src, uint32_t u32Len);
+
+// Encodes one record into p8Dst (which must have room for LDPIN_TRACEFILE_MAX_ENCODED bytes) and returns the number of bytes used.
+uint8_t ldpin_tracefile_encode(LDPInTraceCodec_t *pCodec, const LDPInTraceRecord_t *pRec, uint8_t *p8Dst);
+
+// Decodes the record at p8Src into pRec.
+// Returns the number of bytes used, or 0 if the record is incomplete (p8End comes first) or corrupt.
+uint8_t ldpin_tracefile_decode(LDPInTraceCodec_t *pCodec, const uint8_t *p8Src, const uint8_t *p8End, LDPInTraceRecord_t *pRec);
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_TRACE_FILE_H
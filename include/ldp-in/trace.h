@@ -0,0 +1,131 @@
+#ifndef LDP_IN_TRACE_H
+#define LDP_IN_TRACE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // C++
+
+#include <stddef.h>	// offsetof
+#include "datatypes.h"
+#include <ldp-in/config.h>
+
+// Trace capture.
+// In a LDP_IN_TRACE build every interpreter records each call the host makes into it (bytes written, vblank/vsync calls and the status passed in, ...)
+//  and each callback it makes back to the host, as fixed-size records in its context's trace member (LDPInTrace_t).  The host drains it with
+//  ldpin_trace_read(&ctx.trace, ...) (to a file, a spare UART, ...) so that a misbehaving game can be looked at (or replayed) later.
+// Each context has a buffer and vblank count of its own, so several contexts (on one thread or several) can be traced side by side.
+// In a normal build none of this exists and the hooks in the interpreters compile to nothing.
+//
+// Records are in the order the events happened.  Callbacks (and their results) always follow the record of the call that caused them.
+// Reads that only drain the transmit queue are not recorded; LD-V1000 reads and PR-7820 busy checks are, because they change the interpreter's state.
+// Like the counters, the buffer is emptied by <prefix>_ctx_init (or ldpin_trace_reset) but not by <prefix>_ctx_reset, and isn't part of the state.
+
+// which interpreter made a record
+typedef enum
+{
+	LDPIN_TRACE_LDV1000 = 0,
+	LDPIN_TRACE_LDP1000,
+	LDPIN_TRACE_PR7820,
+	LDPIN_TRACE_PR8210,
+	LDPIN_TRACE_VIP9500SG,
+	LDPIN_TRACE_VP931,
+	LDPIN_TRACE_VP932,
+	LDPIN_TRACE_LD700,
+	LDPIN_TRACE_HOST = 0x0F	// ldpin_trace_vblank
+} LDPInTraceInterp_t;
+
+// what a record means and what its value holds
+typedef enum
+{
+	LDPIN_TRACE_RESET = 0,	// reset; value is the emulation type (0 for interpreters that don't have one)
+	LDPIN_TRACE_WRITE,	// write; value is the byte (PR-8210: the 16-bit message, LD-700: the byte in bits 0-7 and the status in bits 8-15)
+	LDPIN_TRACE_READ,	// read (LD-V1000) or busy check (PR-7820); followed by LDPIN_TRACE_OUTPUT
+	LDPIN_TRACE_OUTPUT,	// value returned by the preceding READ
+	LDPIN_TRACE_VBLANK,	// vblank/vsync entry point; value is the status passed in (0 if the entry point doesn't take one).  Advances the vblank counter.
+	LDPIN_TRACE_VSYNC_CMD,	// VP-931: one per 3-byte command in the buffer passed to on_vsync, just before it is processed; first byte in bits 0-7
+	LDPIN_TRACE_JMP_TRIGGER,	// PR-8210 jump trigger; bit 0 is bJmpTrigRaised, bit 1 is bScanCRaised
+	LDPIN_TRACE_INTEXT,	// PR-8210 jump trigger/scan C internal/external; value is bInternal
+	LDPIN_TRACE_NEW_CMD,	// LD-700 on_new_cmd
+	LDPIN_TRACE_SET_STATUS,	// set_status notification; value is the status
+	LDPIN_TRACE_SET_FRAME,	// set_cur_frame_num notification; value is the frame number
+	LDPIN_TRACE_CALLBACK,	// the interpreter called a callback; value is its position in the interpreter's <X>Callbacks_t
+	LDPIN_TRACE_RESULT,	// value returned by the preceding CALLBACK (only recorded for callbacks that return a number)
+	LDPIN_TRACE_ERROR	// comes just before the CALLBACK record of an error callback; code in bits 0-7, the argument in bits 8-23 (not for the LD-V1000, whose errors are text)
+} LDPInTraceKind_t;
+
+typedef struct
+{
+	uint8_t u8Kind;	// LDPInTraceKind_t
+	uint8_t u8Interp;	// LDPInTraceInterp_t
+	uint16_t u16VBlank;	// vblank counter when the record was made (wraps)
+	uint32_t u32Val;	// see LDPInTraceKind_t
+} LDPInTraceRecord_t;
+
+#ifdef LDP_IN_TRACE
+
+#if (LDP_IN_TRACE_SIZE < 2) || (LDP_IN_TRACE_SIZE > 4096) || ((LDP_IN_TRACE_SIZE & (LDP_IN_TRACE_SIZE - 1)) != 0)
+#error LDP_IN_TRACE_SIZE must be a power of two between 2 and 4096
+#endif
+
+// what the library (compiled as C11) sees as atomic is plain to C++ and to the AVR, which locks instead; both are the same size
+#if defined(__cplusplus) || defined(__AVR__) || !defined(__STDC_VERSION__) || (__STDC_VERSION__ < 201112L) || defined(__STDC_NO_ATOMICS__)
+typedef volatile uint16_t LDPInTraceIdx_t;
+#else
+#include <stdatomic.h>
+#define LDP_IN_TRACE_C11_ATOMICS
+typedef _Atomic uint16_t LDPInTraceIdx_t;
+#endif
+
+typedef struct
+{
+	LDPInTraceRecord_t aRecs[LDP_IN_TRACE_SIZE];
+	LDPInTraceIdx_t u16Head;	// next slot to write (interpreter only; free-running like the rings)
+	LDPInTraceIdx_t u16Tail;	// next slot to read (reader only)
+	uint16_t u16VBlank;	// the context's vblank count (interpreter only, wraps)
+	LDPInTraceIdx_t u16Overflows;	// records dropped because the buffer was full (interpreter only, stops at 65535)
+} LDPInTrace_t;
+
+// Empties the trace buffer and zeroes its vblank counter and overflow count.  <prefix>_ctx_init calls this; nothing may be using it.
+void ldpin_trace_reset(LDPInTrace_t *pTrace);
+
+// Adds a record.  The interpreters call this through the macros below.
+// If the buffer is full the record is dropped and counted (see ldpin_trace_overflows).
+void ldpin_trace_push(LDPInTrace_t *pTrace, uint8_t u8Kind, uint8_t u8Interp, uint32_t u32Val);
+
+// records u32Val as a LDPIN_TRACE_RESULT and returns it
+uint32_t ldpin_trace_result(LDPInTrace_t *pTrace, uint8_t u8Interp, uint32_t u32Val);
+
+// For interpreters without a vblank entry point (LD-V1000, PR-7820), the host can call this once per vblank (on the thread that runs
+//  the interpreter) so that their records get a vblank count.
+void ldpin_trace_vblank(LDPInTrace_t *pTrace);
+
+// Copies up to u16Cap of the oldest records to pDst and removes them from the buffer; returns how many were copied.
+// One reader at a time, which may be a different thread from the interpreter's (or the main loop while the interpreter runs in an
+//  interrupt handler).
+uint16_t ldpin_trace_read(LDPInTrace_t *pTrace, LDPInTraceRecord_t *pDst, uint16_t u16Cap);
+
+// how many records were dropped because the buffer was full (stops at 65535)
+uint16_t ldpin_trace_overflows(LDPInTrace_t *pTrace);
+
+#define LDPIN_TRACE_INIT(pCtx)	ldpin_trace_reset(&(pCtx)->trace)
+#define LDPIN_TRACE(pCtx, kind, interp, val)	ldpin_trace_push(&(pCtx)->trace, (uint8_t) (kind), (uint8_t) (interp), (uint32_t) (val))
+#define LDPIN_TRACE_CB(pCtx, interp, cbtype, name, func)	(LDPIN_TRACE(pCtx, LDPIN_TRACE_CALLBACK, interp, offsetof(cbtype, name) / sizeof(void (*)(void))), func)
+#define LDPIN_TRACE_RESULT(pCtx, interp, expr)	ldpin_trace_result(&(pCtx)->trace, (uint8_t) (interp), (uint32_t) (expr))
+#define LDPIN_TRACE_ERR(pCtx, interp, code, val)	LDPIN_TRACE(pCtx, LDPIN_TRACE_ERROR, interp, (uint32_t) (code) | ((uint32_t) (uint16_t) (val) << 8))
+
+#else
+
+#define LDPIN_TRACE_INIT(pCtx)	((void) 0)
+#define LDPIN_TRACE(pCtx, kind, interp, val)	((void) 0)
+#define LDPIN_TRACE_CB(pCtx, interp, cbtype, name, func)	func
+#define LDPIN_TRACE_RESULT(pCtx, interp, expr)	(expr)
+#define LDPIN_TRACE_ERR(pCtx, interp, code, val)	((void) 0)
+
+#endif // LDP_IN_TRACE
+
+#ifdef __cplusplus
+}
+#endif // C++
+
+#endif // LDP_IN_TRACE_H
@@ -29,6 +29,13 @@ extern "C"
 #endif // C++
 
 #include "datatypes.h"
+#include "ring.h"
+#include "convert.h"
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 /////////////////////////////////////////
 
@@ -49,10 +56,28 @@ VIP9500SG_BOOL vip9500sgi_can_read();
 // reads a byte from LDP; must call vip9500sgi_can_read first to determine if byte is available to be read
 uint8_t vip9500sgi_read();
 
+// Bulk versions of the above for hosts that receive/transmit whole blocks (UART FIFO, DMA) at a time.
+// vip9500sgi_write_n is the same as calling vip9500sgi_write for each byte.
+// vip9500sgi_read_n reads up to u16Cap queued bytes and returns how many were read (0 if nothing is queued).
+void vip9500sgi_write_n(const uint8_t *p8Src, uint16_t u16Len);
+uint16_t vip9500sgi_read_n(uint8_t *pDst, uint16_t u16Cap);
+
+// Zero-copy access to the transmit queue.
+// vip9500sgi_tx_peek returns a pointer to the oldest queued byte and stores in *pu8Count how many bytes can be read contiguously from it
+//  (this may be less than the total queued if the queue wraps; call again after committing to get the rest).
+// vip9500sgi_tx_commit removes u8Count bytes (which must not exceed the peeked count) once they have been transmitted.
+const uint8_t *vip9500sgi_tx_peek(uint8_t *pu8Count);
+void vip9500sgi_tx_commit(uint8_t u8Count);
+
 // Should be called right after vblank has ended (ie VBI data is read, seeking/skipping is finished).
 // This is to handle things like seeks/skips completing and 'get current picture number' requests.
 void vip9500sgi_think_after_vblank();
 
+// Optional: supplies the current frame number once per vblank (before vip9500sgi_think_after_vblank).
+// Once this has been called, "get current frame" (6B) replies with the number from the last call instead of calling get_cur_frame_num,
+//  so keep calling it every vblank.  vip9500sgi_reset forgets the frame number until the next call.
+void vip9500sgi_set_cur_frame_num(uint32_t u32Frame);
+
 ////////////////////////////////////////////////////////////////////////////
 
 typedef enum
@@ -96,6 +121,143 @@ typedef enum
 // gets called by interpreter on error.  the code is an enum while the value relates to the error code (for example the value could be an unknown command byte)
 extern void (*g_vip9500sgi_error)(VIP9500SGErrCode_t code, uint8_t u8Val);
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The vip9500sgi_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+#define VIP9500SG_NUMBUFSIZE 5	// holds currently entered in number (extra digits are discarded)
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to vip9500sgi_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*stop)(void *pUser);
+	void (*step_reverse)(void *pUser);
+	void (*begin_search)(void *pUser, uint32_t u32FrameNum);
+	void (*skip)(void *pUser, int32_t i32TracksToSkip);
+	void (*change_audio)(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+	VIP9500SGStatus_t (*get_status)(void *pUser);
+	uint32_t (*get_cur_frame_num)(void *pUser);
+	uint32_t (*get_cur_vbi_line18)(void *pUser);
+	void (*error)(void *pUser, VIP9500SGErrCode_t code, uint8_t u8Val);
+} VIP9500SGCallbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of VIP9500SGCallbacks_t.
+// vip9500sgi_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void vip9500sgi_host_play(void *pUser);
+void vip9500sgi_host_pause(void *pUser);
+void vip9500sgi_host_stop(void *pUser);
+void vip9500sgi_host_step_reverse(void *pUser);
+void vip9500sgi_host_begin_search(void *pUser, uint32_t u32FrameNum);
+void vip9500sgi_host_skip(void *pUser, int32_t i32TracksToSkip);
+void vip9500sgi_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+VIP9500SGStatus_t vip9500sgi_host_get_status(void *pUser);
+uint32_t vip9500sgi_host_get_cur_frame_num(void *pUser);
+uint32_t vip9500sgi_host_get_cur_vbi_line18(void *pUser);
+void vip9500sgi_host_error(void *pUser, VIP9500SGErrCode_t code, uint8_t u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// so we know what to do when we get an ENTER command
+typedef enum
+{
+	VIP9500SGI_STATE_NORMAL,
+	VIP9500SGI_STATE_WAIT_SEARCH,	// in the middle of a search command
+	VIP9500SGI_STATE_SEARCHING,	// in the middle of a search
+	VIP9500SGI_STATE_WAIT_SKIP_FORWARD,	// in the middle of a skip command
+	VIP9500SGI_STATE_WAIT_SKIP_BACKWARD,	// in the middle of a skip command
+	VIP9500SGI_STATE_WAITING_FOR_PLAYING,	// waiting for disc to be playing
+	VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED,	// waiting for disc to be playing/paused
+
+} VIP9500SGState_t;
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	VIP9500SGState_t state;
+	VIP9500SG_BOOL waitingForPicNum;	// if true, we'll return picture number next time we see one in VBI
+
+	LDPInRing8_t tx;	// bytes waiting to be read by the host
+
+	uint8_t num_buf[VIP9500SG_NUMBUFSIZE];
+	uint8_t u8NumBufStart;	// index of the oldest digit in the number buffer
+	uint8_t u8NumBufEnd;	// index where the next digit goes
+	uint8_t u8NumBufCount;	// how many bytes are in the number buffer
+
+	uint32_t u32Frame;	// current frame entered in for stuff like searching, repeating, etc
+	uint8_t u8Idx;	// general purpose index
+	uint8_t u8LastCmdByte;	// so our post-vblank handler knows what success byte to return
+
+	LDPInFrameCache_t frameCache;	// frame number supplied by the host at the last vblank (if any)
+} VIP9500SGCtxState_t;
+
+typedef struct
+{
+	VIP9500SGCtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	VIP9500SGCallbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} VIP9500SGCtx_t;
+
+// bump whenever VIP9500SGCtxState_t changes (see snapshot.h)
+#define VIP9500SG_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	VIP9500SGCtxState_t state;
+} VIP9500SGSnapshot_t;
+
+// Prepares a context for use (callbacks are copied).  The context is left in the power-on state; call vip9500sgi_ctx_reset before using it just like with vip9500sgi_reset.
+void vip9500sgi_ctx_init(VIP9500SGCtx_t *pCtx, const VIP9500SGCallbacks_t *pCallbacks, void *pUser);
+
+void vip9500sgi_ctx_reset(VIP9500SGCtx_t *pCtx);
+void vip9500sgi_ctx_write(VIP9500SGCtx_t *pCtx, uint8_t u8Byte);
+VIP9500SG_BOOL vip9500sgi_ctx_can_read(VIP9500SGCtx_t *pCtx);
+uint8_t vip9500sgi_ctx_read(VIP9500SGCtx_t *pCtx);
+void vip9500sgi_ctx_write_n(VIP9500SGCtx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len);
+uint16_t vip9500sgi_ctx_read_n(VIP9500SGCtx_t *pCtx, uint8_t *pDst, uint16_t u16Cap);
+const uint8_t *vip9500sgi_ctx_tx_peek(VIP9500SGCtx_t *pCtx, uint8_t *pu8Count);
+void vip9500sgi_ctx_tx_commit(VIP9500SGCtx_t *pCtx, uint8_t u8Count);
+void vip9500sgi_ctx_think_after_vblank(VIP9500SGCtx_t *pCtx);
+void vip9500sgi_ctx_set_cur_frame_num(VIP9500SGCtx_t *pCtx, uint32_t u32Frame);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void vip9500sgi_ctx_save(const VIP9500SGCtx_t *pCtx, VIP9500SGSnapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns VIP9500SG_FALSE without changing anything if the snapshot was saved by another interpreter or build, or is corrupt.
+VIP9500SG_BOOL vip9500sgi_ctx_restore(VIP9500SGCtx_t *pCtx, const VIP9500SGSnapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t vip9500sgi_ctx_hash(const VIP9500SGCtx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t vip9500sgi_ctx_flight_read(VIP9500SGCtx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that vip9500sgi_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *vip9500sgi_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+VIP9500SGCtx_t *vip9500sgi_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // C++
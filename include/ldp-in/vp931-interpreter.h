@@ -7,6 +7,12 @@ extern "C"
 #endif // C++
 
 #include "datatypes.h"
+#include <ldp-in/config.h>
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 typedef enum
 {
@@ -59,6 +65,89 @@ VP931ErrCode_t;
 // gets called by interpreter on error.  the code is an enum while the value relates to the error code (for example the value could be an unknown command byte)
 extern void (*g_vp931i_error)(VP931ErrCode_t code, uint8_t u8Val);
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The vp931i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side.
+// (vp931i_get_status_bytes does not depend on any instance, so it has no ctx version)
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to vp931i_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser);
+	void (*pause)(void *pUser);
+	void (*begin_search)(void *pUser, uint32_t uFrameNumber, VP931_BOOL bAudioSquelchedOnComplete);
+	void (*skip_tracks)(void *pUser, int16_t i16TracksToSkip);
+	void (*skip_to_framenum)(void *pUser, uint32_t uFrameNumber);
+	void (*error)(void *pUser, VP931ErrCode_t code, uint8_t u8Val);
+} VP931Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of VP931Callbacks_t.
+// vp931i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void vp931i_host_play(void *pUser);
+void vp931i_host_pause(void *pUser);
+void vp931i_host_begin_search(void *pUser, uint32_t uFrameNumber, VP931_BOOL bAudioSquelchedOnComplete);
+void vp931i_host_skip_tracks(void *pUser, int16_t i16TracksToSkip);
+void vp931i_host_skip_to_framenum(void *pUser, uint32_t uFrameNumber);
+void vp931i_host_error(void *pUser, VP931ErrCode_t code, uint8_t u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+// The VP931 interpreter currently has no state of its own, so a context is just the callbacks.
+typedef struct
+{
+#ifndef LDP_IN_STATIC_CALLBACKS
+	VP931Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} VP931Ctx_t;
+
+// bump whenever the interpreter's state changes (see snapshot.h)
+#define VP931_SNAPSHOT_VERSION 1
+
+// The VP931 has no state to save, so a snapshot is just the header (it can still be checked and restored like the others).
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+} VP931Snapshot_t;
+
+void vp931i_ctx_init(VP931Ctx_t *pCtx, const VP931Callbacks_t *pCallbacks, void *pUser);
+void vp931i_ctx_reset(VP931Ctx_t *pCtx);
+void vp931i_ctx_on_vsync(VP931Ctx_t *pCtx, const uint8_t *p8CmdBuf, uint8_t u8CmdBytesRecvd, VP931Status_t status);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void vp931i_ctx_save(const VP931Ctx_t *pCtx, VP931Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns VP931_FALSE without changing anything if the snapshot was saved by another interpreter or build.
+VP931_BOOL vp931i_ctx_restore(VP931Ctx_t *pCtx, const VP931Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t vp931i_ctx_hash(const VP931Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t vp931i_ctx_flight_read(VP931Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that vp931i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *vp931i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+VP931Ctx_t *vp931i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // C++
@@ -7,6 +7,12 @@ extern "C"
 #endif // C++
 
 #include "datatypes.h"
+#include "ring.h"
+#include "snapshot.h"
+#include "state-hash.h"
+#include "counters.h"
+#include "flight.h"
+#include "trace.h"
 
 typedef enum
 {
@@ -25,6 +31,19 @@ VP932_BOOL vp932i_can_read();
 // reads a byte from LDP; must call vp932i_can_read first to determine if byte is available to be read
 uint8_t vp932i_read();
 
+// Bulk versions of the above for hosts that receive/transmit whole blocks (UART FIFO, DMA) at a time.
+// vp932i_write_n is the same as calling vp932i_write for each byte.
+// vp932i_read_n reads up to u16Cap queued bytes and returns how many were read (0 if nothing is queued).
+void vp932i_write_n(const uint8_t *p8Src, uint16_t u16Len);
+uint16_t vp932i_read_n(uint8_t *pDst, uint16_t u16Cap);
+
+// Zero-copy access to the transmit queue.
+// vp932i_tx_peek returns a pointer to the oldest queued byte and stores in *pu8Count how many bytes can be read contiguously from it
+//  (this may be less than the total queued if the queue wraps; call again after committing to get the rest).
+// vp932i_tx_commit removes u8Count bytes (which must not exceed the peeked count) once they have been transmitted.
+const uint8_t *vp932i_tx_peek(uint8_t *pu8Count);
+void vp932i_tx_commit(uint8_t u8Count);
+
 typedef enum
 {  
    VP932_ERROR, VP932_SEARCHING, VP932_STOPPED, VP932_PLAYING, VP932_PAUSED, VP932_SPINNING_UP
@@ -63,6 +82,118 @@ typedef enum
 // gets called by interpreter on error.  the code is an enum while the value relates to the error code (for example the value could be an unknown command byte)
 extern void (*g_vp932i_error)(VP932ErrCode_t code, uint8_t u8Val);
 
+///////////////////////////////////////////////////////////////////////////////
+
+// REENTRANT API
+// The functions above operate on a single default instance.
+// The vp932i_ctx_* functions below operate on a caller-owned context so that any number of players can run side by side (even on different threads, as long as each context is only used by one thread at a time).
+
+#define VP932_RX_BUFSIZE 12	// should be as small as possible to save space
+
+// Same meaning as the global callbacks above, except that each one receives the user pointer that was passed to vp932i_ctx_init
+typedef struct
+{
+	void (*play)(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, VP932_BOOL bBackward, VP932_BOOL bAudioSquelched);
+	void (*step)(void *pUser, VP932_BOOL bBackward);
+	void (*pause)(void *pUser);
+	void (*begin_search)(void *pUser, uint32_t u32FrameNum);
+	void (*change_audio)(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+	uint32_t (*get_cur_frame_num)(void *pUser);
+	void (*error)(void *pUser, VP932ErrCode_t code, uint8_t u8Val);
+} VP932Callbacks_t;
+
+#ifdef LDP_IN_STATIC_CALLBACKS
+// In a LDP_IN_STATIC_CALLBACKS build the contexts do not store callbacks (and the global callbacks above do not exist).
+// Instead the host must define these functions, which take the same arguments as the members of VP932Callbacks_t.
+// vp932i_ctx_init ignores its pCallbacks argument in this mode (pass 0).
+void vp932i_host_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, VP932_BOOL bBackward, VP932_BOOL bAudioSquelched);
+void vp932i_host_step(void *pUser, VP932_BOOL bBackward);
+void vp932i_host_pause(void *pUser);
+void vp932i_host_begin_search(void *pUser, uint32_t u32FrameNum);
+void vp932i_host_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable);
+uint32_t vp932i_host_get_cur_frame_num(void *pUser);
+void vp932i_host_error(void *pUser, VP932ErrCode_t code, uint8_t u8Val);
+#endif // LDP_IN_STATIC_CALLBACKS
+
+typedef enum
+{
+	VP932_STATE_NORMAL = 0,
+	VP932_STATE_SEARCHING,	// in the middle of a disc search
+} VP932State_t;
+
+// Interpreter state.  This is private to the interpreter; it is only exposed so that contexts can be declared statically.
+typedef struct
+{
+	VP932State_t state;
+	VP932_BOOL play_after_search;	// whether to play the disc after a search is complete
+	LDPInRing8_t tx;	// bytes waiting to be read by the host
+	uint16_t u16LastFrameNumberSearched;	// last frame number we searched for
+	uint8_t rx_buf[VP932_RX_BUFSIZE];
+	uint8_t rx_buf_idx;	// current position of rx buf (0 means buffer is empty)
+} VP932CtxState_t;
+
+typedef struct
+{
+	VP932CtxState_t state;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	VP932Callbacks_t cb;
+#endif
+	void *pUser;	// passed to every callback
+#ifdef LDP_IN_COUNTERS
+	LDPInCounters_t counters;	// see counters.h
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	LDPInFlight_t flight;	// see flight.h
+#endif
+#ifdef LDP_IN_TRACE
+	LDPInTrace_t trace;	// see trace.h
+#endif
+} VP932Ctx_t;
+
+// bump whenever VP932CtxState_t changes (see snapshot.h)
+#define VP932_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+	LDPInSnapshotHeader_t hdr;
+	VP932CtxState_t state;
+} VP932Snapshot_t;
+
+// Prepares a context for use (callbacks are copied).  The context is left in the power-on state; call vp932i_ctx_reset before using it just like with vp932i_reset.
+void vp932i_ctx_init(VP932Ctx_t *pCtx, const VP932Callbacks_t *pCallbacks, void *pUser);
+
+void vp932i_ctx_reset(VP932Ctx_t *pCtx);
+void vp932i_ctx_write(VP932Ctx_t *pCtx, uint8_t u8Byte);
+VP932_BOOL vp932i_ctx_can_read(VP932Ctx_t *pCtx);
+uint8_t vp932i_ctx_read(VP932Ctx_t *pCtx);
+void vp932i_ctx_write_n(VP932Ctx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len);
+uint16_t vp932i_ctx_read_n(VP932Ctx_t *pCtx, uint8_t *pDst, uint16_t u16Cap);
+const uint8_t *vp932i_ctx_tx_peek(VP932Ctx_t *pCtx, uint8_t *pu8Count);
+void vp932i_ctx_tx_commit(VP932Ctx_t *pCtx, uint8_t u8Count);
+void vp932i_ctx_think_during_vblank(VP932Ctx_t *pCtx, VP932Status_t status);
+
+// Copies the context's state into a snapshot (see snapshot.h).
+void vp932i_ctx_save(const VP932Ctx_t *pCtx, VP932Snapshot_t *pSnap);
+
+// Puts the state saved in a snapshot back into the context (the callbacks and pUser are left alone).
+// Returns VP932_FALSE without changing anything if the snapshot was saved by another interpreter or build, or is corrupt.
+VP932_BOOL vp932i_ctx_restore(VP932Ctx_t *pCtx, const VP932Snapshot_t *pSnap);
+
+// 64-bit hash of the context's logical state, cheap enough to compare with another emulation's every vblank (see state-hash.h)
+uint64_t vp932i_ctx_hash(const VP932Ctx_t *pCtx);
+
+#if LDP_IN_FLIGHT_SIZE != 0
+// Copies up to u8Cap of the oldest flight records the context hasn't been asked for yet to pDst, oldest first (see flight.h).
+// May be called from another thread (or, on the AVR, from the main loop while the interpreter runs in an interrupt handler).
+uint8_t vp932i_ctx_flight_read(VP932Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap);
+#endif
+
+// the fields that vp932i_ctx_hash covers, for naming the ones that differ
+const LDPInStateField_t *vp932i_state_fields(uint8_t *pu8Count);
+
+// returns the context used by the non-ctx functions above
+VP932Ctx_t *vp932i_get_default_ctx();
+
 #ifdef __cplusplus
 }
 #endif // C++
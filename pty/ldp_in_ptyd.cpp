@@ -0,0 +1,297 @@
+// Serves serial laserdisc players on pseudo-terminals, for bench rigs and software cabinets: any program that opens one of the
+//  ptys talks to an LDP-1000, VP932 or VIP9500SG interpreter as if it were the real player on an RS-232 port.
+// Every pty, and a timerfd that delivers vblanks at 59.94 Hz (or 50 Hz with --pal), is served from one epoll loop on one thread.
+// Throughput and response latency for each pty are written to a stats file once a second.
+
+#include "pty_player.h"
+#include "field_clock.h"
+#include <ldp-in/trace.h>	// LDPInTraceInterp_t
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// upper bound, in us, of the latency that u32Permille of the responses were under
+static uint32_t latency_percentile(const PtyStats &stats, uint32_t u32Permille)
+{
+	uint64_t u64Total = 0;
+	uint64_t u64Seen = 0;
+
+	for (unsigned u = 0; u < PTY_LATENCY_BUCKETS; u++)
+	{
+		u64Total += stats.au32LatencyUs[u];
+	}
+	if (u64Total == 0)
+	{
+		return 0;
+	}
+
+	for (unsigned u = 0; u < PTY_LATENCY_BUCKETS - 1; u++)
+	{
+		u64Seen += stats.au32LatencyUs[u];
+		if (u64Seen * 1000 >= u64Total * u32Permille)
+		{
+			return std::min<uint32_t>(1u << u, stats.u32LatencyMaxUs);
+		}
+	}
+	return stats.u32LatencyMaxUs;
+}
+
+struct PtydStats
+{
+	uint64_t u64BytesIn;
+	uint64_t u64BytesOut;
+};
+
+// rewrites the stats file (through a temporary file, so that a reader never sees half of it)
+static void write_stats(const char *pszPath, const std::vector<std::unique_ptr<PtyPlayer> > &players, std::vector<PtydStats> *pLast,
+	double dSeconds, uint64_t u64LateTicks)
+{
+	std::string strTmp = std::string(pszPath) + ".tmp";
+	FILE *f = fopen(strTmp.c_str(), "w");
+
+	if (!f)
+	{
+		return;
+	}
+
+	fprintf(f, "# vblanks skipped because the loop fell behind: %llu\n", (unsigned long long) u64LateTicks);
+	fprintf(f, "# name device bytes_in bytes_out in_per_s out_per_s reads writes stalls vblanks latency_p50_us latency_p99_us latency_max_us\n");
+	for (size_t u = 0; u < players.size(); u++)
+	{
+		const PtyStats &s = players[u]->Stats();
+		PtydStats &last = (*pLast)[u];
+
+		fprintf(f, "%s %s %llu %llu %.0f %.0f %llu %llu %llu %llu %u %u %u\n", players[u]->Name().c_str(), players[u]->DevicePath().c_str(),
+			(unsigned long long) s.u64BytesIn, (unsigned long long) s.u64BytesOut,
+			(double) (s.u64BytesIn - last.u64BytesIn) / dSeconds, (double) (s.u64BytesOut - last.u64BytesOut) / dSeconds,
+			(unsigned long long) s.u64Reads, (unsigned long long) s.u64Writes, (unsigned long long) s.u64Stalls, (unsigned long long) s.u64Vblanks,
+			latency_percentile(s, 500), latency_percentile(s, 990), s.u32LatencyMaxUs);
+		last.u64BytesIn = s.u64BytesIn;
+		last.u64BytesOut = s.u64BytesOut;
+	}
+
+	fclose(f);
+	rename(strTmp.c_str(), pszPath);
+}
+
+static bool parse_player(const char *psz, uint8_t *pu8Interp, unsigned *puCount)
+{
+	const char *pszColon = strchr(psz, ':');
+	size_t uLen = pszColon ? (size_t) (pszColon - psz) : strlen(psz);
+
+	if ((uLen == 7) && (strncmp(psz, "ldp1000", uLen) == 0)) *pu8Interp = LDPIN_TRACE_LDP1000;
+	else if ((uLen == 5) && (strncmp(psz, "vp932", uLen) == 0)) *pu8Interp = LDPIN_TRACE_VP932;
+	else if ((uLen == 9) && (strncmp(psz, "vip9500sg", uLen) == 0)) *pu8Interp = LDPIN_TRACE_VIP9500SG;
+	else return false;
+
+	*puCount = pszColon ? (unsigned) atoi(pszColon + 1) : 1;
+	return *puCount != 0;
+}
+
+static bool epoll_set(int fdEpoll, int iOp, int fd, uint32_t u32Events, void *p)
+{
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = u32Events;
+	ev.data.ptr = p;
+	return epoll_ctl(fdEpoll, iOp, fd, &ev) == 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszLinkDir = 0;
+	const char *pszStats = 0;
+	uint16_t u16SeekVBlanks = 10;
+	bool bPal = false;
+	std::vector<std::pair<uint8_t, unsigned> > specs;
+	bool bUsage = false;
+
+	for (int i = 1; (i < argc) && !bUsage; i++)
+	{
+		uint8_t u8Interp;
+		unsigned uCount;
+
+		if ((strcmp(argv[i], "--link-dir") == 0) && (i + 1 < argc))
+		{
+			pszLinkDir = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--stats") == 0) && (i + 1 < argc))
+		{
+			pszStats = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--seek-vblanks") == 0) && (i + 1 < argc))
+		{
+			u16SeekVBlanks = (uint16_t) atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--pal") == 0)
+		{
+			bPal = true;
+		}
+		else if (parse_player(argv[i], &u8Interp, &uCount))
+		{
+			specs.push_back(std::make_pair(u8Interp, uCount));
+		}
+		else
+		{
+			bUsage = true;
+		}
+	}
+
+	if (bUsage || specs.empty())
+	{
+		printf("usage: %s [--link-dir <dir>] [--stats <file>] [--seek-vblanks <n>] [--pal] ldp1000|vp932|vip9500sg[:<count>]...\n", argv[0]);
+		return 2;
+	}
+
+	// the ptys and links are removed by the players' destructors, so SIGINT/SIGTERM end the loop instead of the process
+	sigset_t sigs;
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	sigprocmask(SIG_BLOCK, &sigs, 0);
+
+	int fdEpoll = epoll_create1(EPOLL_CLOEXEC);
+	int fdTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	int fdSignal = signalfd(-1, &sigs, SFD_NONBLOCK | SFD_CLOEXEC);
+
+	if ((fdEpoll < 0) || (fdTimer < 0) || (fdSignal < 0))
+	{
+		perror("ldp_in_ptyd");
+		return 1;
+	}
+
+	// the timer and signal fds are told apart from the players by these addresses
+	static char timerTag;
+	static char signalTag;
+	epoll_set(fdEpoll, EPOLL_CTL_ADD, fdTimer, EPOLLIN, &timerTag);
+	epoll_set(fdEpoll, EPOLL_CTL_ADD, fdSignal, EPOLLIN, &signalTag);
+
+	std::vector<std::unique_ptr<PtyPlayer> > players;
+	unsigned auNext[LDPIN_TRACE_LD700 + 1] = { 0 };
+
+	for (size_t u = 0; u < specs.size(); u++)
+	{
+		for (unsigned v = 0; v < specs[u].second; v++)
+		{
+			std::unique_ptr<PtyPlayer> player(new PtyPlayer());
+			std::string strErr;
+
+			// numbered per interpreter, so each one's names don't depend on what else is served
+			if (!player->Open(specs[u].first, auNext[specs[u].first]++, pszLinkDir, u16SeekVBlanks, &strErr))
+			{
+				fprintf(stderr, "%s\n", strErr.c_str());
+				return 1;
+			}
+			if (!epoll_set(fdEpoll, EPOLL_CTL_ADD, player->Fd(), EPOLLIN, player.get()))
+			{
+				perror("epoll_ctl");
+				return 1;
+			}
+			printf("%s %s\n", player->Name().c_str(), player->DevicePath().c_str());
+			players.push_back(std::move(player));
+		}
+	}
+	fflush(stdout);
+
+	std::vector<PtydStats> lastStats(players.size(), PtydStats());
+	std::vector<struct epoll_event> events(players.size() + 2);
+	LDPInFieldClock clock;
+	uint64_t u64StatsAt = ldpin_field_now_ns();
+	bool bQuit = false;
+
+	clock.Start(u64StatsAt, bPal);
+	ldpin_field_arm_timer(fdTimer, clock.NextAtNs());
+
+	while (!bQuit)
+	{
+		int iCount = epoll_wait(fdEpoll, &events[0], (int) events.size(), -1);
+		uint64_t u64NowUs = ldpin_field_now_ns() / 1000;
+
+		if ((iCount < 0) && (errno != EINTR))
+		{
+			perror("epoll_wait");
+			break;
+		}
+
+		for (int i = 0; i < iCount; i++)
+		{
+			void *p = events[i].data.ptr;
+
+			if (p == &signalTag)
+			{
+				bQuit = true;
+			}
+			else if (p == &timerTag)
+			{
+				uint64_t u64Expirations;
+				uint64_t u64Now = ldpin_field_now_ns();
+				uint32_t u32Run = clock.Advance(u64Now);
+
+				if (read(fdTimer, &u64Expirations, sizeof(u64Expirations)) < 0)
+				{
+					// EAGAIN: the timer was re-armed since epoll said it had expired
+				}
+
+				for (; u32Run != 0; u32Run--)
+				{
+					for (size_t u = 0; u < players.size(); u++)
+					{
+						bool bWasStalled = players[u]->Stalled();
+						players[u]->OnVBlank(u64NowUs);
+						if (!bWasStalled && players[u]->Stalled())
+						{
+							epoll_set(fdEpoll, EPOLL_CTL_MOD, players[u]->Fd(), EPOLLIN | EPOLLOUT, players[u].get());
+						}
+					}
+				}
+				ldpin_field_arm_timer(fdTimer, clock.NextAtNs());
+
+				if (pszStats && (u64Now - u64StatsAt >= 1000000000ull))
+				{
+					write_stats(pszStats, players, &lastStats, (double) (u64Now - u64StatsAt) / 1e9, clock.Skipped());
+					u64StatsAt = u64Now;
+				}
+			}
+			else
+			{
+				PtyPlayer *pPlayer = (PtyPlayer *) p;
+				bool bWasStalled = pPlayer->Stalled();
+
+				if (events[i].events & EPOLLOUT)
+				{
+					pPlayer->OnWritable(u64NowUs);
+				}
+				if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				{
+					pPlayer->OnReadable(u64NowUs);
+				}
+
+				if (pPlayer->Stalled() != bWasStalled)
+				{
+					epoll_set(fdEpoll, EPOLL_CTL_MOD, pPlayer->Fd(), pPlayer->Stalled() ? (EPOLLIN | EPOLLOUT) : EPOLLIN, pPlayer);
+				}
+			}
+		}
+	}
+
+	if (pszStats)
+	{
+		write_stats(pszStats, players, &lastStats, (double) (ldpin_field_now_ns() - u64StatsAt) / 1e9, clock.Skipped());
+	}
+
+	close(fdSignal);
+	close(fdTimer);
+	close(fdEpoll);
+	return 0;
+}
@@ -0,0 +1,416 @@
+#include "pty_player.h"
+#include <ldp-in/trace.h>	// LDPInTraceInterp_t
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/////////////////////////////////////////////////////////////////
+// callbacks; the disc model does what it is told and the rest are ignored
+
+static PtyPlayer *pl(void *p) { return (PtyPlayer *) p; }
+
+namespace ldp1000_pty
+{
+	void play(void *p, uint8_t, uint8_t, LDP1000_BOOL, LDP1000_BOOL) { pl(p)->Play(); }
+	void pause(void *p) { pl(p)->Pause(); }
+	void begin_search(void *p, uint32_t u32Frame) { pl(p)->BeginSearch(u32Frame); }
+	void step_forward(void *p) { pl(p)->Step(1); }
+	void step_reverse(void *p) { pl(p)->Step(-1); }
+	void skip(void *, int16_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	void change_video(void *, LDP1000_BOOL) { }
+	LDP1000Status_t get_status(void *p) { return (LDP1000Status_t) pl(p)->Status(); }
+	uint32_t get_cur_frame_num(void *p) { return pl(p)->CurFrame(); }
+	void text_enable_changed(void *, LDP1000_BOOL) { }
+	void text_buffer_contents_changed(void *, const uint8_t *) { }
+	void text_buffer_start_index_changed(void *, uint8_t) { }
+	void text_modes_changed(void *, uint8_t, uint8_t, uint8_t) { }
+	void error(void *, LDP1000ErrCode_t, uint8_t) { }
+
+	const LDP1000Callbacks_t cbs =
+	{
+		play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed,
+		text_modes_changed, error
+	};
+}
+
+namespace vp932_pty
+{
+	void play(void *p, uint8_t, uint8_t, VP932_BOOL, VP932_BOOL) { pl(p)->Play(); }
+	void step(void *p, VP932_BOOL bBackward) { pl(p)->Step(bBackward ? -1 : 1); }
+	void pause(void *p) { pl(p)->Pause(); }
+	void begin_search(void *p, uint32_t u32Frame) { pl(p)->BeginSearch(u32Frame); }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	uint32_t get_cur_frame_num(void *p) { return pl(p)->CurFrame(); }
+	void error(void *, VP932ErrCode_t, uint8_t) { }
+
+	const VP932Callbacks_t cbs = { play, step, pause, begin_search, change_audio, get_cur_frame_num, error };
+}
+
+namespace vip9500sg_pty
+{
+	void play(void *p) { pl(p)->Play(); }
+	void pause(void *p) { pl(p)->Pause(); }
+	void stop(void *p) { pl(p)->Stop(); }
+	void step_reverse(void *p) { pl(p)->Step(-1); }
+	void begin_search(void *p, uint32_t u32Frame) { pl(p)->BeginSearch(u32Frame); }
+	void skip(void *, int32_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	VIP9500SGStatus_t get_status(void *p) { return (VIP9500SGStatus_t) pl(p)->Status(); }
+	uint32_t get_cur_frame_num(void *p) { return pl(p)->CurFrame(); }
+	// every field carries a picture number (only the top nibble is looked at)
+	uint32_t get_cur_vbi_line18(void *p) { return 0xF80000 | pl(p)->CurFrame(); }
+	void error(void *, VIP9500SGErrCode_t, uint8_t) { }
+
+	const VIP9500SGCallbacks_t cbs =
+	{
+		play, pause, stop, step_reverse, begin_search, skip, change_audio, get_status, get_cur_frame_num, get_cur_vbi_line18, error
+	};
+}
+
+static const char *interp_name(uint8_t u8Interp)
+{
+	switch (u8Interp)
+	{
+	case LDPIN_TRACE_LDP1000: return "ldp1000";
+	case LDPIN_TRACE_VP932: return "vp932";
+	default: return "vip9500sg";
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+
+PtyPlayer::PtyPlayer() :
+	m_fdMaster(-1),
+	m_fdSlave(-1),
+	m_u8Interp(0),
+	m_disc(DISC_PAUSED),
+	m_u32Frame(1),
+	m_u32SearchTarget(0),
+	m_u16SearchLeft(0),
+	m_u16SeekVBlanks(0),
+	m_u8Field(0),
+	m_uOutPos(0),
+	m_u64PendingSinceUs(0),
+	m_u8PendingVBlanks(0)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+PtyPlayer::~PtyPlayer()
+{
+	if (!m_strLink.empty())
+	{
+		unlink(m_strLink.c_str());
+	}
+	if (m_fdSlave >= 0)
+	{
+		close(m_fdSlave);
+	}
+	if (m_fdMaster >= 0)
+	{
+		close(m_fdMaster);
+	}
+}
+
+bool PtyPlayer::Open(uint8_t u8Interp, unsigned uIndex, const char *pszLinkDir, uint16_t u16SeekVBlanks, std::string *pErr)
+{
+	char szName[32];
+	struct termios tio;
+
+	snprintf(szName, sizeof(szName), "%s.%u", interp_name(u8Interp), uIndex);
+	m_strName = szName;
+	m_u8Interp = u8Interp;
+	m_u16SeekVBlanks = u16SeekVBlanks;
+
+	m_fdMaster = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if ((m_fdMaster < 0) || (grantpt(m_fdMaster) != 0) || (unlockpt(m_fdMaster) != 0))
+	{
+		*pErr = m_strName + ": opening a pty: " + strerror(errno);
+		return false;
+	}
+
+	const char *pszDevice = ptsname(m_fdMaster);
+	if (pszDevice)
+	{
+		m_strDevice = pszDevice;
+		m_fdSlave = open(pszDevice, O_RDWR | O_NOCTTY | O_CLOEXEC);
+	}
+	if (m_fdSlave < 0)
+	{
+		*pErr = m_strName + ": opening the pty's device: " + strerror(errno);
+		return false;
+	}
+
+	// raw, like a real serial port; 9600 8N1 is only for programs that look (a pty has no baud rate of its own)
+	if (tcgetattr(m_fdSlave, &tio) == 0)
+	{
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, B9600);
+		cfsetospeed(&tio, B9600);
+		tcsetattr(m_fdSlave, TCSANOW, &tio);
+	}
+
+	if (pszLinkDir)
+	{
+		std::string strLink = std::string(pszLinkDir) + "/" + m_strName;
+		unlink(strLink.c_str());
+		if (symlink(m_strDevice.c_str(), strLink.c_str()) != 0)
+		{
+			*pErr = strLink + ": " + strerror(errno);
+			return false;
+		}
+		m_strLink = strLink;
+	}
+
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_LDP1000:
+		ldp1000i_ctx_init(&m_ldp1000, &ldp1000_pty::cbs, this);
+		ldp1000i_ctx_reset(&m_ldp1000, LDP1000_EMU_LDP1000A);
+		break;
+	case LDPIN_TRACE_VP932:
+		vp932i_ctx_init(&m_vp932, &vp932_pty::cbs, this);
+		vp932i_ctx_reset(&m_vp932);
+		break;
+	default:
+		vip9500sgi_ctx_init(&m_vip9500sg, &vip9500sg_pty::cbs, this);
+		vip9500sgi_ctx_reset(&m_vip9500sg);
+		break;
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////
+// disc model: a disc that is already spun up and paused on frame 1
+
+void PtyPlayer::Play()
+{
+	m_disc = DISC_PLAYING;
+}
+
+void PtyPlayer::Pause()
+{
+	m_disc = DISC_PAUSED;
+}
+
+void PtyPlayer::Stop()
+{
+	m_disc = DISC_STOPPED;
+}
+
+void PtyPlayer::Step(int iDelta)
+{
+	if ((iDelta > 0) || (m_u32Frame > 1))
+	{
+		m_u32Frame += iDelta;
+	}
+	m_disc = DISC_PAUSED;
+}
+
+void PtyPlayer::BeginSearch(uint32_t u32Frame)
+{
+	m_disc = DISC_SEARCHING;
+	m_u32SearchTarget = u32Frame;
+	m_u16SearchLeft = m_u16SeekVBlanks;
+}
+
+uint32_t PtyPlayer::Status() const
+{
+	// as the interpreter's own <X>Status_t
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_LDP1000:
+		return (m_disc == DISC_PLAYING) ? LDP1000_PLAYING : (m_disc == DISC_SEARCHING) ? LDP1000_SEARCHING : (m_disc == DISC_STOPPED) ? LDP1000_STOPPED : LDP1000_PAUSED;
+	case LDPIN_TRACE_VP932:
+		return (m_disc == DISC_PLAYING) ? VP932_PLAYING : (m_disc == DISC_SEARCHING) ? VP932_SEARCHING : (m_disc == DISC_STOPPED) ? VP932_STOPPED : VP932_PAUSED;
+	default:
+		return (m_disc == DISC_PLAYING) ? VIP9500SG_PLAYING : (m_disc == DISC_SEARCHING) ? VIP9500SG_SEARCHING : (m_disc == DISC_STOPPED) ? VIP9500SG_STOPPED : VIP9500SG_PAUSED;
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+
+void PtyPlayer::Collect()
+{
+	uint8_t u8Count = 0;
+
+	// take the whole transmit ring, one contiguous run at a time
+	for (;;)
+	{
+		if (m_u8Interp == LDPIN_TRACE_LDP1000)
+		{
+			// the latency class in the high byte is for timing-accurate hosts; a pty delivers as fast as it can
+			const uint16_t *p16 = ldp1000i_ctx_tx_peek(&m_ldp1000, &u8Count);
+			for (uint8_t u = 0; u < u8Count; u++)
+			{
+				m_out.push_back((uint8_t) p16[u]);
+			}
+			ldp1000i_ctx_tx_commit(&m_ldp1000, u8Count);
+		}
+		else
+		{
+			const uint8_t *p8 = (m_u8Interp == LDPIN_TRACE_VP932) ? vp932i_ctx_tx_peek(&m_vp932, &u8Count) : vip9500sgi_ctx_tx_peek(&m_vip9500sg, &u8Count);
+			m_out.insert(m_out.end(), p8, p8 + u8Count);
+			if (m_u8Interp == LDPIN_TRACE_VP932)
+			{
+				vp932i_ctx_tx_commit(&m_vp932, u8Count);
+			}
+			else
+			{
+				vip9500sgi_ctx_tx_commit(&m_vip9500sg, u8Count);
+			}
+		}
+
+		if (u8Count == 0)
+		{
+			break;
+		}
+	}
+}
+
+bool PtyPlayer::Flush(uint64_t u64NowUs)
+{
+	while (m_uOutPos < m_out.size())
+	{
+		ssize_t iWritten = write(m_fdMaster, &m_out[m_uOutPos], m_out.size() - m_uOutPos);
+
+		if (iWritten <= 0)
+		{
+			if ((iWritten < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			// full (EAGAIN); the caller waits for EPOLLOUT
+			m_stats.u64Stalls++;
+			return false;
+		}
+
+		if (m_u64PendingSinceUs != 0)
+		{
+			uint64_t u64Us = u64NowUs - m_u64PendingSinceUs;
+			unsigned uBucket = 0;
+
+			while ((uBucket < PTY_LATENCY_BUCKETS - 1) && (u64Us >= (1ull << uBucket)))
+			{
+				uBucket++;
+			}
+			m_stats.au32LatencyUs[uBucket]++;
+			if (u64Us > m_stats.u32LatencyMaxUs)
+			{
+				m_stats.u32LatencyMaxUs = (uint32_t) ((u64Us > 0xFFFFFFFF) ? 0xFFFFFFFF : u64Us);
+			}
+			m_u64PendingSinceUs = 0;
+		}
+
+		m_uOutPos += (size_t) iWritten;
+		m_stats.u64BytesOut += (uint64_t) iWritten;
+		m_stats.u64Writes++;
+	}
+
+	m_out.clear();
+	m_uOutPos = 0;
+	return true;
+}
+
+void PtyPlayer::OnReadable(uint64_t u64NowUs)
+{
+	uint8_t buf[4096];
+	bool bWasStalled = Stalled();	// looked at first: once something has been collected, Stalled is true until it is written
+
+	for (;;)
+	{
+		ssize_t iRead = read(m_fdMaster, buf, sizeof(buf));
+
+		if (iRead <= 0)
+		{
+			if ((iRead < 0) && (errno == EINTR))
+			{
+				continue;
+			}
+			break;	// EAGAIN: that was everything
+		}
+
+		m_stats.u64BytesIn += (uint64_t) iRead;
+		m_stats.u64Reads++;
+		if (m_u64PendingSinceUs == 0)
+		{
+			m_u64PendingSinceUs = u64NowUs;
+			m_u8PendingVBlanks = 0;
+		}
+
+		// a byte at a time, collecting the answers as they come, so that a burst of inquiries can't overflow the transmit ring
+		for (ssize_t i = 0; i < iRead; i++)
+		{
+			switch (m_u8Interp)
+			{
+			case LDPIN_TRACE_LDP1000: ldp1000i_ctx_write(&m_ldp1000, buf[i]); break;
+			case LDPIN_TRACE_VP932: vp932i_ctx_write(&m_vp932, buf[i]); break;
+			default: vip9500sgi_ctx_write(&m_vip9500sg, buf[i]); break;
+			}
+			Collect();
+		}
+	}
+
+	// if output is already waiting for EPOLLOUT, the new answers go after it then
+	if (!bWasStalled)
+	{
+		Flush(u64NowUs);
+	}
+}
+
+bool PtyPlayer::OnWritable(uint64_t u64NowUs)
+{
+	return Flush(u64NowUs);
+}
+
+void PtyPlayer::OnVBlank(uint64_t u64NowUs)
+{
+	bool bWasStalled = Stalled();
+
+	m_stats.u64Vblanks++;
+
+	if ((m_u64PendingSinceUs != 0) && (++m_u8PendingVBlanks > 2))
+	{
+		m_u64PendingSinceUs = 0;
+	}
+
+	switch (m_disc)
+	{
+	case DISC_SEARCHING:
+		if ((m_u16SearchLeft == 0) || (--m_u16SearchLeft == 0))
+		{
+			m_u32Frame = m_u32SearchTarget;
+			m_disc = DISC_PAUSED;
+		}
+		break;
+	case DISC_PLAYING:
+		if (++m_u8Field == 2)
+		{
+			m_u8Field = 0;
+			m_u32Frame++;
+		}
+		break;
+	default:
+		break;
+	}
+
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_LDP1000: ldp1000i_ctx_think_during_vblank(&m_ldp1000); break;
+	case LDPIN_TRACE_VP932: vp932i_ctx_think_during_vblank(&m_vp932, (VP932Status_t) Status()); break;
+	default: vip9500sgi_ctx_think_after_vblank(&m_vip9500sg); break;
+	}
+
+	Collect();
+	if (!bWasStalled)
+	{
+		Flush(u64NowUs);
+	}
+}
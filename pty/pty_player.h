@@ -0,0 +1,102 @@
+#ifndef LDP_IN_PTY_PLAYER_H
+#define LDP_IN_PTY_PLAYER_H
+
+// One serial laserdisc player on a pseudo-terminal: an interpreter (LDP-1000, VP932 or VIP9500SG) reading what a program writes to
+//  the pty and writing its responses back, in front of a simple disc model that answers its status and frame number callbacks.
+// Non-blocking throughout; ldp_in_ptyd drives every player from one epoll loop.
+
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#define PTY_LATENCY_BUCKETS 24	// bucket n counts latencies under 2^n us (the last one, anything longer)
+
+struct PtyStats
+{
+	uint64_t u64BytesIn;
+	uint64_t u64BytesOut;
+	uint64_t u64Reads;	// read() calls that returned data
+	uint64_t u64Writes;	// write() calls that wrote something
+	uint64_t u64Stalls;	// times the pty was full and output had to wait for EPOLLOUT
+	uint64_t u64Vblanks;
+
+	// from the read() that delivered a command to the write() of the first byte of its response (if it came within two vblanks)
+	uint32_t au32LatencyUs[PTY_LATENCY_BUCKETS];
+	uint32_t u32LatencyMaxUs;
+};
+
+class PtyPlayer
+{
+public:
+	PtyPlayer();
+	~PtyPlayer();
+
+	// Opens a pty in raw mode and sets up u8Interp (LDPIN_TRACE_LDP1000, _VP932 or _VIP9500SG).
+	// If pszLinkDir isn't 0, a symlink named after the player (for example "ldp1000.3") is made there to the pty's device.
+	// u16SeekVBlanks is how long the disc model takes to finish a search.
+	bool Open(uint8_t u8Interp, unsigned uIndex, const char *pszLinkDir, uint16_t u16SeekVBlanks, std::string *pErr);
+
+	// the pty master, for epoll
+	int Fd() const { return m_fdMaster; }
+
+	const std::string &Name() const { return m_strName; }
+	const std::string &DevicePath() const { return m_strDevice; }
+	const PtyStats &Stats() const { return m_stats; }
+
+	// EPOLLIN: reads everything waiting (in bulk) into the interpreter and sends whatever it answers.
+	void OnReadable(uint64_t u64NowUs);
+
+	// EPOLLOUT: sends what didn't fit last time; returns true once there is nothing left (so EPOLLOUT can be dropped)
+	bool OnWritable(uint64_t u64NowUs);
+
+	// a vblank (59.94 Hz): moves the disc model on, then runs the interpreter's vblank entry point
+	void OnVBlank(uint64_t u64NowUs);
+
+	// true if output is waiting for EPOLLOUT
+	bool Stalled() const { return m_uOutPos < m_out.size(); }
+
+	// called by the interpreter's callbacks
+	void Play();
+	void Pause();
+	void Stop();
+	void Step(int iDelta);
+	void BeginSearch(uint32_t u32Frame);
+	uint32_t CurFrame() const { return m_u32Frame; }
+	uint32_t Status() const;
+
+private:
+	void Collect();	// moves the interpreter's responses into m_out
+	bool Flush(uint64_t u64NowUs);
+
+	enum DiscState { DISC_STOPPED, DISC_PLAYING, DISC_PAUSED, DISC_SEARCHING };
+
+	std::string m_strName;
+	std::string m_strDevice;
+	std::string m_strLink;
+	int m_fdMaster;
+	int m_fdSlave;	// kept open so that the master doesn't see a hangup between programs
+	uint8_t m_u8Interp;
+
+	DiscState m_disc;
+	uint32_t m_u32Frame;
+	uint32_t m_u32SearchTarget;
+	uint16_t m_u16SearchLeft;
+	uint16_t m_u16SeekVBlanks;
+	uint8_t m_u8Field;	// frames advance every other vblank while playing
+
+	std::vector<uint8_t> m_out;	// responses not yet written
+	size_t m_uOutPos;
+	uint64_t m_u64PendingSinceUs;	// when the oldest unanswered input was read (0 if none)
+	uint8_t m_u8PendingVBlanks;	// vblanks since then; input that gets no response within two isn't timed
+
+	PtyStats m_stats;
+
+	LDP1000Ctx_t m_ldp1000;
+	VP932Ctx_t m_vp932;
+	VIP9500SGCtx_t m_vip9500sg;
+};
+
+#endif // LDP_IN_PTY_PLAYER_H
@@ -0,0 +1,239 @@
+// Runs an interpreter on the real-time runtime (see rt_runtime.h) for a while and prints how late the runtime thread woke for
+//  each field, so that a machine's scheduling can be checked before trusting it with a game.
+// The interpreter gets a command now and then (and, for the LDP-1000, its responses are read back) so that the input and output
+//  queues are exercised as well as the vblanks.
+
+#include "rt_runtime.h"
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t g_u32Callbacks = 0;	// callbacks made on the runtime thread (read once it has stopped)
+
+static void cb() { g_u32Callbacks++; }
+
+namespace pr8210_rt
+{
+	void play(void *) { cb(); }
+	void pause(void *) { cb(); }
+	void step(void *, int8_t) { cb(); }
+	void begin_search(void *, uint32_t) { cb(); }
+	void change_audio(void *, uint8_t, uint8_t) { cb(); }
+	void skip(void *, int8_t) { cb(); }
+	void change_auto_track_jump(void *, PR8210_BOOL) { cb(); }
+	PR8210_BOOL is_player_busy(void *) { return PR8210_FALSE; }
+	void change_standby(void *, PR8210_BOOL) { cb(); }
+	void error(void *, PR8210ErrCode_t, uint16_t) { cb(); }
+	const PR8210Callbacks_t cbs = { play, pause, step, begin_search, change_audio, skip, change_auto_track_jump, is_player_busy, change_standby, error };
+}
+
+namespace ld700_rt
+{
+	void play(void *) { cb(); }
+	void pause(void *) { cb(); }
+	void stop(void *) { cb(); }
+	void eject(void *) { cb(); }
+	void step(void *, LD700_BOOL) { cb(); }
+	void begin_search(void *, uint32_t) { cb(); }
+	void change_audio(void *, LD700_BOOL, LD700_BOOL) { cb(); }
+	void change_audio_squelch(void *, LD700_BOOL) { cb(); }
+	uint32_t get_current_picnum(void *) { return 1; }
+	void on_ext_ack_changed(void *, LD700_BOOL) { cb(); }
+	void error(void *, LD700ErrCode_t, uint8_t) { cb(); }
+	const LD700Callbacks_t cbs = { play, pause, stop, eject, step, begin_search, change_audio, change_audio_squelch, get_current_picnum, on_ext_ack_changed, error };
+}
+
+namespace ldp1000_rt
+{
+	void play(void *, uint8_t, uint8_t, LDP1000_BOOL, LDP1000_BOOL) { cb(); }
+	void pause(void *) { cb(); }
+	void begin_search(void *, uint32_t) { cb(); }
+	void step_forward(void *) { cb(); }
+	void step_reverse(void *) { cb(); }
+	void skip(void *, int16_t) { cb(); }
+	void change_audio(void *, uint8_t, uint8_t) { cb(); }
+	void change_video(void *, LDP1000_BOOL) { cb(); }
+	LDP1000Status_t get_status(void *) { return LDP1000_PAUSED; }
+	uint32_t get_cur_frame_num(void *) { return 1; }
+	void text_enable_changed(void *, LDP1000_BOOL) { cb(); }
+	void text_buffer_contents_changed(void *, const uint8_t *) { cb(); }
+	void text_buffer_start_index_changed(void *, uint8_t) { cb(); }
+	void text_modes_changed(void *, uint8_t, uint8_t, uint8_t) { cb(); }
+	void error(void *, LDP1000ErrCode_t, uint8_t) { cb(); }
+	const LDP1000Callbacks_t cbs = { play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed, text_modes_changed, error };
+}
+
+namespace vp931_rt
+{
+	void play(void *) { cb(); }
+	void pause(void *) { cb(); }
+	void begin_search(void *, uint32_t, VP931_BOOL) { cb(); }
+	void skip_tracks(void *, int16_t) { cb(); }
+	void skip_to_framenum(void *, uint32_t) { cb(); }
+	void error(void *, VP931ErrCode_t, uint8_t) { cb(); }
+	const VP931Callbacks_t cbs = { play, pause, begin_search, skip_tracks, skip_to_framenum, error };
+}
+
+// one command for the interpreter, sent once a second
+static void send_command(LDPInRtRuntime *pRt, uint8_t u8Interp)
+{
+	switch (u8Interp)
+	{
+	case LDPIN_TRACE_PR8210:
+		pRt->Write(4 | (5 << 3));	// PLAY
+		pRt->Write(4 | (5 << 3));
+		pRt->Write(4 | (0 << 3));	// end of command
+		break;
+	case LDPIN_TRACE_LD700:
+		{
+			static const uint8_t play[] = { 0xA8, 0xA8 ^ 0xFF, 0x17, 0x17 ^ 0xFF };	// prefix, PLAY
+			pRt->Post(LDPInRtInput{LDPIN_RT_IN_LD700_NEW_CMD, 0});
+			for (size_t u = 0; u < sizeof(play); u++)
+			{
+				pRt->Write(play[u]);
+			}
+		}
+		break;
+	case LDPIN_TRACE_LDP1000:
+		{
+			static const uint8_t search[] = { 0x43, 0x31, 0x32, 0x33, 0x40 };	// SEARCH 123 ENTER
+			for (size_t u = 0; u < sizeof(search); u++)
+			{
+				pRt->Write(search[u]);
+			}
+		}
+		break;
+	case LDPIN_TRACE_VP931:
+		{
+			static const uint8_t play[] = { 0xF1, 0x23, 0x45 };	// play, then go to frame 12345
+			for (size_t u = 0; u < sizeof(play); u++)
+			{
+				pRt->Write(play[u]);
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t u8Interp = 0xFF;
+	uint32_t u32Seconds = 10;
+	LDPInRtConfig cfg;
+	bool bUsage = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--interp") == 0) && (i + 1 < argc))
+		{
+			const char *psz = argv[++i];
+			if (strcmp(psz, "pr8210") == 0) u8Interp = LDPIN_TRACE_PR8210;
+			else if (strcmp(psz, "ld700") == 0) u8Interp = LDPIN_TRACE_LD700;
+			else if (strcmp(psz, "ldp1000") == 0) u8Interp = LDPIN_TRACE_LDP1000;
+			else if (strcmp(psz, "vp931") == 0) u8Interp = LDPIN_TRACE_VP931;
+			else bUsage = true;
+		}
+		else if ((strcmp(argv[i], "--seconds") == 0) && (i + 1 < argc))
+		{
+			u32Seconds = (uint32_t) atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--priority") == 0) && (i + 1 < argc))
+		{
+			cfg.iPriority = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--cpu") == 0) && (i + 1 < argc))
+		{
+			cfg.iCpu = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--pal") == 0)
+		{
+			cfg.bPal = true;
+		}
+		else if (strcmp(argv[i], "--lock-memory") == 0)
+		{
+			cfg.bLockMemory = true;
+		}
+		else
+		{
+			bUsage = true;
+		}
+	}
+
+	if (bUsage || (u8Interp == 0xFF) || (u32Seconds == 0))
+	{
+		printf("usage: %s --interp pr8210|ld700|ldp1000|vp931 [--seconds <n>] [--priority <1-99, 0 for none>] [--cpu <n>] [--pal] [--lock-memory]\n", argv[0]);
+		return 2;
+	}
+
+	PR8210Ctx_t pr8210;
+	LD700Ctx_t ld700;
+	LDP1000Ctx_t ldp1000;
+	VP931Ctx_t vp931;
+	LDPInRtRuntime rt;
+	std::string strErr;
+	bool bStarted = false;
+
+	switch (u8Interp)
+	{
+	case LDPIN_TRACE_PR8210:
+		pr8210i_ctx_init(&pr8210, &pr8210_rt::cbs, 0);
+		pr8210i_ctx_reset(&pr8210);
+		bStarted = rt.Start(&pr8210, cfg, &strErr);
+		break;
+	case LDPIN_TRACE_LD700:
+		ld700i_ctx_init(&ld700, &ld700_rt::cbs, 0);
+		ld700i_ctx_reset(&ld700);
+		rt.SetStatus(LD700_PAUSED);
+		bStarted = rt.Start(&ld700, cfg, &strErr);
+		break;
+	case LDPIN_TRACE_LDP1000:
+		ldp1000i_ctx_init(&ldp1000, &ldp1000_rt::cbs, 0);
+		ldp1000i_ctx_reset(&ldp1000, LDP1000_EMU_LDP1450);
+		rt.SetCurFrame(1);
+		bStarted = rt.Start(&ldp1000, cfg, &strErr);
+		break;
+	default:
+		vp931i_ctx_init(&vp931, &vp931_rt::cbs, 0);
+		vp931i_ctx_reset(&vp931);
+		rt.SetStatus(VP931_PAUSED);
+		bStarted = rt.Start(&vp931, cfg, &strErr);
+		break;
+	}
+
+	if (!bStarted)
+	{
+		fprintf(stderr, "%s\n", strErr.c_str());
+		return 1;
+	}
+
+	uint32_t u32BytesRead = 0;
+	for (uint32_t u = 0; u < u32Seconds * 10; u++)
+	{
+		uint16_t u16Val;
+
+		if ((u % 10) == 0)
+		{
+			send_command(&rt, u8Interp);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		while (rt.Read(&u16Val))
+		{
+			u32BytesRead++;
+		}
+	}
+	rt.Stop();
+
+	LDPInRtStats stats;
+	rt.GetStats(&stats);
+	printf("%s thread%s, %llu fields (%llu skipped), %u callbacks, %u bytes read back\n", stats.bRealtime ? "SCHED_FIFO" : "ordinary",
+		stats.bPinned ? " (pinned)" : "", (unsigned long long) stats.u64Fields, (unsigned long long) stats.u64Skipped,
+		g_u32Callbacks, u32BytesRead);
+	printf("wake-up lateness: median %u us, 99%% %u us, 99.9%% %u us, max %u us\n", stats.u32JitterP50Us, stats.u32JitterP99Us,
+		stats.u32JitterP999Us, stats.u32JitterMaxUs);
+	return 0;
+}
@@ -0,0 +1,445 @@
+#include "rt_runtime.h"
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+LDPInRtRuntime::LDPInRtRuntime() :
+	m_u8Interp(0xFF),
+	m_pCtx(0),
+	m_bPal(false),
+	m_thread(),
+	m_bRunning(false),
+	m_bRealtime(false),
+	m_bPinned(false),
+	m_fdTimer(-1),
+	m_fdWake(-1),
+	m_fdEpoll(-1),
+	m_u32Sleeping(0),
+	m_u32Quit(0),
+	m_u32Status(0),
+	m_u32CurFrame(LDPIN_RT_NO_FRAME),
+	m_u8VP931CmdLen(0),
+	m_u64Fields(0),
+	m_u64Skipped(0),
+	m_u64Dropped(0),
+	m_u64OutDropped(0),
+	m_u32JitterMaxUs(0)
+{
+	for (unsigned u = 0; u < LDPIN_RT_JITTER_BUCKETS; u++)
+	{
+		m_au32Jitter[u].store(0, std::memory_order_relaxed);
+	}
+}
+
+LDPInRtRuntime::~LDPInRtRuntime()
+{
+	Stop();
+}
+
+bool LDPInRtRuntime::Start(PR8210Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr)
+{
+	return StartThread(LDPIN_TRACE_PR8210, pCtx, cfg, pErr);
+}
+
+bool LDPInRtRuntime::Start(LD700Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr)
+{
+	return StartThread(LDPIN_TRACE_LD700, pCtx, cfg, pErr);
+}
+
+bool LDPInRtRuntime::Start(LDP1000Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr)
+{
+	return StartThread(LDPIN_TRACE_LDP1000, pCtx, cfg, pErr);
+}
+
+bool LDPInRtRuntime::Start(VP931Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr)
+{
+	return StartThread(LDPIN_TRACE_VP931, pCtx, cfg, pErr);
+}
+
+bool LDPInRtRuntime::StartThread(uint8_t u8Interp, void *pCtx, const LDPInRtConfig &cfg, std::string *pErr)
+{
+	struct epoll_event ev;
+	pthread_attr_t attr;
+	int iRes;
+
+	if (m_bRunning)
+	{
+		*pErr = "the runtime is already running";
+		return false;
+	}
+
+	// only once nothing is running on the old ones
+	m_u8Interp = u8Interp;
+	m_pCtx = pCtx;
+	m_bPal = cfg.bPal;
+	m_u32Quit.store(0, std::memory_order_relaxed);
+	m_u8VP931CmdLen = 0;
+
+	if (cfg.bLockMemory && (mlockall(MCL_CURRENT | MCL_FUTURE) != 0))
+	{
+		*pErr = std::string("mlockall: ") + strerror(errno);
+		return false;
+	}
+
+	m_fdTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	m_fdWake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	m_fdEpoll = epoll_create1(EPOLL_CLOEXEC);
+	if ((m_fdTimer < 0) || (m_fdWake < 0) || (m_fdEpoll < 0))
+	{
+		*pErr = std::string("timerfd/eventfd/epoll: ") + strerror(errno);
+		Stop();
+		return false;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = m_fdTimer;
+	epoll_ctl(m_fdEpoll, EPOLL_CTL_ADD, m_fdTimer, &ev);
+	ev.data.fd = m_fdWake;
+	epoll_ctl(m_fdEpoll, EPOLL_CTL_ADD, m_fdWake, &ev);
+
+	pthread_attr_init(&attr);
+	m_bPinned = false;
+	if (cfg.iCpu >= 0)
+	{
+		cpu_set_t cpus;
+
+		CPU_ZERO(&cpus);
+		CPU_SET(cfg.iCpu, &cpus);
+		m_bPinned = (pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) == 0);
+	}
+
+	m_bRealtime = false;
+	if (cfg.iPriority > 0)
+	{
+		struct sched_param param;
+
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = cfg.iPriority;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+
+		iRes = pthread_create(&m_thread, &attr, ThreadEntry, this);
+		m_bRealtime = (iRes == 0);
+
+		// EPERM: no CAP_SYS_NICE (or RLIMIT_RTPRIO); fall back to an ordinary thread
+		if ((iRes == EPERM) && !cfg.bRequireRealtime)
+		{
+			pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+			iRes = pthread_create(&m_thread, &attr, ThreadEntry, this);
+		}
+	}
+	else
+	{
+		iRes = pthread_create(&m_thread, &attr, ThreadEntry, this);
+	}
+	pthread_attr_destroy(&attr);
+
+	if (iRes != 0)
+	{
+		*pErr = std::string("pthread_create: ") + strerror(iRes);
+		Stop();
+		return false;
+	}
+
+	m_bRunning = true;
+	return true;
+}
+
+void LDPInRtRuntime::Stop()
+{
+	if (m_bRunning)
+	{
+		uint64_t u64One = 1;
+
+		m_u32Quit.store(1, std::memory_order_seq_cst);
+		if (write(m_fdWake, &u64One, sizeof(u64One)) < 0)
+		{
+			// can only fail if the counter is about to overflow, in which case the thread is awake anyway
+		}
+		pthread_join(m_thread, 0);
+		m_bRunning = false;
+	}
+
+	if (m_fdEpoll >= 0) close(m_fdEpoll);
+	if (m_fdWake >= 0) close(m_fdWake);
+	if (m_fdTimer >= 0) close(m_fdTimer);
+	m_fdEpoll = m_fdWake = m_fdTimer = -1;
+}
+
+bool LDPInRtRuntime::Post(const LDPInRtInput &in)
+{
+	if (!m_in.Push(in))
+	{
+		return false;
+	}
+
+	// pairs with the fence in ThreadMain: either the thread sees this input before it sleeps, or this sees that it is sleeping
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_u32Sleeping.load(std::memory_order_relaxed))
+	{
+		uint64_t u64One = 1;
+		if (write(m_fdWake, &u64One, sizeof(u64One)) < 0)
+		{
+			// as in Stop
+		}
+	}
+	return true;
+}
+
+void *LDPInRtRuntime::ThreadEntry(void *pThis)
+{
+	((LDPInRtRuntime *) pThis)->ThreadMain();
+	return 0;
+}
+
+void LDPInRtRuntime::ThreadMain()
+{
+	LDPInFieldClock clock;
+
+	clock.Start(ldpin_field_now_ns(), m_bPal);
+
+	// an ordinary thread's timers can fire up to 50 us late by default, so that wake-ups can be batched
+	prctl(PR_SET_TIMERSLACK, 1, 0, 0, 0);
+	ldpin_field_arm_timer(m_fdTimer, clock.NextAtNs());
+
+	while (!m_u32Quit.load(std::memory_order_relaxed))
+	{
+		struct epoll_event events[2];
+		uint64_t u64Val;
+
+		DrainInputs();
+
+		m_u32Sleeping.store(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if ((m_in.Count() != 0) || m_u32Quit.load(std::memory_order_relaxed))
+		{
+			m_u32Sleeping.store(0, std::memory_order_relaxed);
+			continue;
+		}
+
+		int iCount = epoll_wait(m_fdEpoll, events, 2, -1);
+		m_u32Sleeping.store(0, std::memory_order_relaxed);
+
+		for (int i = 0; i < iCount; i++)
+		{
+			if (events[i].data.fd == m_fdWake)
+			{
+				if (read(m_fdWake, &u64Val, sizeof(u64Val)) < 0)
+				{
+					// EAGAIN: another wake-up already cleared it
+				}
+				continue;
+			}
+
+			uint64_t u64Now = ldpin_field_now_ns();
+			uint64_t u64LateUs = clock.LateNs(u64Now) / 1000;	// how late this wake-up was for the first field it runs
+			uint32_t u32Run = clock.Advance(u64Now);
+
+			if (read(m_fdTimer, &u64Val, sizeof(u64Val)) < 0)
+			{
+				// EAGAIN: re-armed since epoll saw it expire
+			}
+			if (u32Run == 0)
+			{
+				continue;
+			}
+
+			uint32_t u32LateUs = (u64LateUs > 0xFFFFFFFFull) ? 0xFFFFFFFF : (uint32_t) u64LateUs;
+			uint32_t u32Bucket = (u32LateUs < LDPIN_RT_JITTER_BUCKETS - 1) ? u32LateUs : LDPIN_RT_JITTER_BUCKETS - 1;
+			m_au32Jitter[u32Bucket].store(m_au32Jitter[u32Bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			if (u32LateUs > m_u32JitterMaxUs.load(std::memory_order_relaxed))
+			{
+				m_u32JitterMaxUs.store(u32LateUs, std::memory_order_relaxed);
+			}
+
+			m_u64Skipped.store(clock.Skipped(), std::memory_order_relaxed);
+			for (; u32Run != 0; u32Run--)
+			{
+				DrainInputs();
+				VBlank();
+			}
+			ldpin_field_arm_timer(m_fdTimer, clock.NextAtNs());
+		}
+	}
+}
+
+void LDPInRtRuntime::DrainInputs()
+{
+	LDPInRtInput in;
+
+	while (m_in.Pop(&in))
+	{
+		Dispatch(in);
+	}
+	DrainOutput();
+}
+
+void LDPInRtRuntime::Dispatch(const LDPInRtInput &in)
+{
+	uint32_t u32Status = m_u32Status.load(std::memory_order_relaxed);
+
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_PR8210:
+		{
+			PR8210Ctx_t *pCtx = (PR8210Ctx_t *) m_pCtx;
+
+			if (in.u8Op == LDPIN_RT_IN_WRITE) pr8210i_ctx_write(pCtx, (uint16_t) in.u32Val);
+			else if (in.u8Op == LDPIN_RT_IN_RESET) pr8210i_ctx_reset(pCtx);
+			else if (in.u8Op == LDPIN_RT_IN_PR8210_JMP_TRIGGER)
+			{
+				pr8210i_ctx_on_jmp_trigger_changed(pCtx, (in.u32Val & 1) ? PR8210_TRUE : PR8210_FALSE, (in.u32Val & 2) ? PR8210_TRUE : PR8210_FALSE);
+			}
+			else if (in.u8Op == LDPIN_RT_IN_PR8210_INTEXT)
+			{
+				pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(pCtx, in.u32Val ? PR8210_TRUE : PR8210_FALSE);
+			}
+		}
+		break;
+	case LDPIN_TRACE_LD700:
+		{
+			LD700Ctx_t *pCtx = (LD700Ctx_t *) m_pCtx;
+
+			if (in.u8Op == LDPIN_RT_IN_WRITE) ld700i_ctx_write(pCtx, (uint8_t) in.u32Val, (LD700Status_t) u32Status);
+			else if (in.u8Op == LDPIN_RT_IN_RESET) ld700i_ctx_reset(pCtx);
+			else if (in.u8Op == LDPIN_RT_IN_LD700_NEW_CMD) ld700i_ctx_on_new_cmd(pCtx);
+		}
+		break;
+	case LDPIN_TRACE_LDP1000:
+		{
+			LDP1000Ctx_t *pCtx = (LDP1000Ctx_t *) m_pCtx;
+
+			if (in.u8Op == LDPIN_RT_IN_WRITE) ldp1000i_ctx_write(pCtx, (uint8_t) in.u32Val);
+			else if (in.u8Op == LDPIN_RT_IN_RESET) ldp1000i_ctx_reset(pCtx, (LDP1000_EmulationType_t) in.u32Val);
+		}
+		break;
+	case LDPIN_TRACE_VP931:
+		if (in.u8Op == LDPIN_RT_IN_WRITE)
+		{
+			if (m_u8VP931CmdLen < LDPIN_RT_VP931_CMD_MAX)
+			{
+				m_au8VP931Cmd[m_u8VP931CmdLen++] = (uint8_t) in.u32Val;
+			}
+			else
+			{
+				m_u64Dropped.store(m_u64Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+		}
+		else if (in.u8Op == LDPIN_RT_IN_RESET)
+		{
+			m_u8VP931CmdLen = 0;
+			vp931i_ctx_reset((VP931Ctx_t *) m_pCtx);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void LDPInRtRuntime::VBlank()
+{
+	uint32_t u32Status = m_u32Status.load(std::memory_order_relaxed);
+
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_PR8210:
+		pr8210i_ctx_on_vblank((PR8210Ctx_t *) m_pCtx);
+		break;
+	case LDPIN_TRACE_LD700:
+		ld700i_ctx_on_vblank((LD700Ctx_t *) m_pCtx, (LD700Status_t) u32Status);
+		break;
+	case LDPIN_TRACE_LDP1000:
+		{
+			uint32_t u32Frame = m_u32CurFrame.load(std::memory_order_relaxed);
+
+			if (u32Frame != LDPIN_RT_NO_FRAME)
+			{
+				ldp1000i_ctx_set_cur_frame_num((LDP1000Ctx_t *) m_pCtx, u32Frame);
+			}
+			ldp1000i_ctx_think_during_vblank((LDP1000Ctx_t *) m_pCtx);
+			DrainOutput();
+		}
+		break;
+	case LDPIN_TRACE_VP931:
+		vp931i_ctx_on_vsync((VP931Ctx_t *) m_pCtx, m_au8VP931Cmd, m_u8VP931CmdLen, (VP931Status_t) u32Status);
+		m_u8VP931CmdLen = 0;
+		break;
+	default:
+		break;
+	}
+
+	m_u64Fields.store(m_u64Fields.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// moves what the LDP-1000 has sent onto the output queue (dropping it if the host has stopped reading, so the interpreter never stalls)
+void LDPInRtRuntime::DrainOutput()
+{
+	if (m_u8Interp != LDPIN_TRACE_LDP1000)
+	{
+		return;
+	}
+
+	LDP1000Ctx_t *pCtx = (LDP1000Ctx_t *) m_pCtx;
+	uint8_t u8Count;
+	const uint16_t *p16;
+
+	while ((p16 = ldp1000i_ctx_tx_peek(pCtx, &u8Count)) && (u8Count != 0))
+	{
+		for (uint8_t u = 0; u < u8Count; u++)
+		{
+			if (!m_out.Push(p16[u]))
+			{
+				m_u64OutDropped.store(m_u64OutDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+		}
+		ldp1000i_ctx_tx_commit(pCtx, u8Count);
+	}
+}
+
+uint32_t LDPInRtRuntime::JitterPercentile(uint64_t u64Total, uint32_t u32Permille) const
+{
+	uint64_t u64Seen = 0;
+
+	if (u64Total == 0)
+	{
+		return 0;
+	}
+	for (unsigned u = 0; u < LDPIN_RT_JITTER_BUCKETS - 1; u++)
+	{
+		u64Seen += m_au32Jitter[u].load(std::memory_order_relaxed);
+		if (u64Seen * 1000 >= u64Total * u32Permille)
+		{
+			return u;
+		}
+	}
+	return m_u32JitterMaxUs.load(std::memory_order_relaxed);
+}
+
+void LDPInRtRuntime::GetStats(LDPInRtStats *pStats) const
+{
+	uint64_t u64Total = 0;
+
+	for (unsigned u = 0; u < LDPIN_RT_JITTER_BUCKETS; u++)
+	{
+		u64Total += m_au32Jitter[u].load(std::memory_order_relaxed);
+	}
+
+	pStats->bRealtime = m_bRealtime;
+	pStats->bPinned = m_bPinned;
+	pStats->u64Fields = m_u64Fields.load(std::memory_order_relaxed);
+	pStats->u64Skipped = m_u64Skipped.load(std::memory_order_relaxed);
+	pStats->u64Dropped = m_u64Dropped.load(std::memory_order_relaxed);
+	pStats->u64OutDropped = m_u64OutDropped.load(std::memory_order_relaxed);
+	pStats->u32JitterP50Us = JitterPercentile(u64Total, 500);
+	pStats->u32JitterP99Us = JitterPercentile(u64Total, 990);
+	pStats->u32JitterP999Us = JitterPercentile(u64Total, 999);
+	pStats->u32JitterMaxUs = m_u32JitterMaxUs.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,146 @@
+#ifndef LDP_IN_RT_RUNTIME_H
+#define LDP_IN_RT_RUNTIME_H
+
+// Runs one interpreter (PR-8210, LD-700, LDP-1000 or VP931) on a thread of its own that calls its vblank entry point at the
+//  field rate, so that what hangs off vblanks (the PR-8210's STAND BY blinking, the LD-700's EXT_ACK' pulses, LDP-1000 REPEAT)
+//  keeps its timing whatever the host's own loop is doing.
+// - The thread runs SCHED_FIFO if the process is allowed to (see LDPInRtConfig) and can be pinned to a CPU.
+// - Fields are paced by an LDPInFieldClock (field_clock.h): each timerfd expiry is an absolute time worked out from the start
+//    time and the field number, so the rate never drifts, and if the thread falls more than LDPIN_FIELD_MAX_CATCH_UP fields
+//    behind, the rest are skipped and counted.
+// - The host's inputs go through an LDPInSpscRing (spsc_ring.h), which the thread drains whenever it wakes (and before every
+//    field); it sleeps in epoll on the timerfd and an eventfd that the host only writes to if the thread is asleep.
+// - How late each field's wake-up was is kept in a histogram, for the percentiles in LDPInRtStats.
+// The interpreter's callbacks are called on the runtime thread: they must be safe to call from there, and anything they block
+//  on delays the next field.
+// Linux only.
+
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/trace.h>	// LDPInTraceInterp_t
+#include "field_clock.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <string>
+#include <pthread.h>
+#include <stdint.h>
+
+#define LDPIN_RT_JITTER_BUCKETS 2048	// bucket n counts wake-ups n us late (the last one, anything later)
+#define LDPIN_RT_VP931_CMD_MAX 48	// VP931 command bytes kept between vsyncs
+#define LDPIN_RT_NO_FRAME 0xFFFFFFFF
+
+// what the host asks the runtime thread to do
+#define LDPIN_RT_IN_WRITE 0	// u32Val: PR-8210 message, LD-700 command, LDP-1000 byte or VP931 command byte (sent at the next vsync)
+#define LDPIN_RT_IN_RESET 1	// u32Val: the LDP-1000's emulation type (ignored by the others)
+#define LDPIN_RT_IN_PR8210_JMP_TRIGGER 2	// u32Val bit 0: JMP TRIG raised, bit 1: SCAN C raised
+#define LDPIN_RT_IN_PR8210_INTEXT 3	// u32Val: non-zero if internal
+#define LDPIN_RT_IN_LD700_NEW_CMD 4
+
+struct LDPInRtInput
+{
+	uint8_t u8Op;	// LDPIN_RT_IN_*
+	uint32_t u32Val;
+};
+
+struct LDPInRtConfig
+{
+	bool bPal = false;	// 50 Hz fields instead of 59.94
+	int iPriority = 80;	// SCHED_FIFO priority (1-99), or 0 for an ordinary thread
+	int iCpu = -1;	// CPU to pin the thread to, or -1 to leave it to the scheduler
+	bool bRequireRealtime = false;	// fail Start if SCHED_FIFO isn't allowed, instead of falling back to an ordinary thread
+	bool bLockMemory = false;	// mlockall the process first, so page faults don't show up as jitter
+};
+
+struct LDPInRtStats
+{
+	bool bRealtime;	// the thread got SCHED_FIFO
+	bool bPinned;	// the thread is pinned to LDPInRtConfig::iCpu
+	uint64_t u64Fields;	// vblank entry points run
+	uint64_t u64Skipped;	// fields skipped because the thread fell behind
+	uint64_t u64Dropped;	// VP931 command bytes dropped because more than LDPIN_RT_VP931_CMD_MAX came in one field
+	uint64_t u64OutDropped;	// LDP-1000 bytes dropped because the host wasn't reading them
+	// how late the thread woke for each field, in us
+	uint32_t u32JitterP50Us;
+	uint32_t u32JitterP99Us;
+	uint32_t u32JitterP999Us;
+	uint32_t u32JitterMaxUs;
+};
+
+class LDPInRtRuntime
+{
+public:
+	LDPInRtRuntime();
+
+	// stops the thread if it is still running
+	~LDPInRtRuntime();
+
+	// Starts the runtime thread on a context that has been through <prefix>_ctx_init (and reset); the thread owns it until Stop.
+	// Returns false with a reason in *pErr if the thread can't be started (or, with bRequireRealtime, can't be made SCHED_FIFO).
+	bool Start(PR8210Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr);
+	bool Start(LD700Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr);
+	bool Start(LDP1000Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr);
+	bool Start(VP931Ctx_t *pCtx, const LDPInRtConfig &cfg, std::string *pErr);
+
+	// waits for the thread to finish (it runs no more fields after this returns)
+	void Stop();
+
+	// Inputs, from one host thread.  Each returns false if the queue is full.
+	bool Post(const LDPInRtInput &in);
+	bool Write(uint32_t u32Val) { return Post(LDPInRtInput{LDPIN_RT_IN_WRITE, u32Val}); }
+	bool Reset(uint32_t u32Type) { return Post(LDPInRtInput{LDPIN_RT_IN_RESET, u32Type}); }
+
+	// the player's status, passed to the LD-700 and VP931 with every write and vblank (LD700Status_t or VP931Status_t)
+	void SetStatus(uint32_t u32Status) { m_u32Status.store(u32Status, std::memory_order_relaxed); }
+
+	// LDP-1000: the frame number to pass to ldp1000i_ctx_set_cur_frame_num every vblank (until this is called, it isn't)
+	void SetCurFrame(uint32_t u32Frame) { m_u32CurFrame.store(u32Frame, std::memory_order_relaxed); }
+
+	// LDP-1000: the next byte it sent (with its LDP1000Latency_t in the high byte, as ldp1000i_read); false if there isn't one
+	bool Read(uint16_t *pu16Val) { return m_out.Pop(pu16Val); }
+
+	// may be called from any thread while the runtime is running, or after Stop
+	void GetStats(LDPInRtStats *pStats) const;
+
+private:
+	bool StartThread(uint8_t u8Interp, void *pCtx, const LDPInRtConfig &cfg, std::string *pErr);
+	static void *ThreadEntry(void *pThis);
+	void ThreadMain();
+	void Dispatch(const LDPInRtInput &in);
+	void DrainInputs();
+	void VBlank();
+	void DrainOutput();
+	uint32_t JitterPercentile(uint64_t u64Total, uint32_t u32Permille) const;
+
+	uint8_t m_u8Interp;	// LDPInTraceInterp_t
+	void *m_pCtx;
+	bool m_bPal;
+	pthread_t m_thread;
+	bool m_bRunning;
+	bool m_bRealtime;
+	bool m_bPinned;
+	int m_fdTimer;
+	int m_fdWake;	// eventfd: inputs or Stop while the thread was asleep
+	int m_fdEpoll;
+
+	LDPInSpscRing<LDPInRtInput, 1024> m_in;
+	LDPInSpscRing<uint16_t, 1024> m_out;
+	std::atomic<uint32_t> m_u32Sleeping;	// the thread is (about to be) in epoll_wait
+	std::atomic<uint32_t> m_u32Quit;
+	std::atomic<uint32_t> m_u32Status;
+	std::atomic<uint32_t> m_u32CurFrame;	// LDPIN_RT_NO_FRAME until SetCurFrame
+
+	uint8_t m_au8VP931Cmd[LDPIN_RT_VP931_CMD_MAX];
+	uint8_t m_u8VP931CmdLen;
+
+	// written by the runtime thread only; relaxed, since GetStats only needs each value to be whole
+	std::atomic<uint64_t> m_u64Fields;
+	std::atomic<uint64_t> m_u64Skipped;
+	std::atomic<uint64_t> m_u64Dropped;
+	std::atomic<uint64_t> m_u64OutDropped;
+	std::atomic<uint32_t> m_au32Jitter[LDPIN_RT_JITTER_BUCKETS];
+	std::atomic<uint32_t> m_u32JitterMaxUs;
+};
+
+#endif // LDP_IN_RT_RUNTIME_H
@@ -0,0 +1,243 @@
+// Checks the shared-memory transport end to end and measures its round trip, with the interpreter in another process.
+// With --spawn it forks an LD-V1000 server of its own; otherwise it attaches to a running ldp_in_shm_server --interp ldv1000.
+// It first sends a search through the server and through an interpreter in this process and checks that every read and
+//  callback matches, then times LD-V1000 reads (one byte each way) while both sides are polling, and again after letting the
+//  server go to sleep.
+
+#include "shm_client.h"
+#include "shm_server.h"
+#include <ldp-in/ldv1000-interpreter.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define PING_TIMEOUT_US 1000000
+
+// the in-process interpreter that the server's answers are checked against
+static LDV1000Status_t g_localStatus = LDV1000_PAUSED;
+static std::vector<uint32_t> g_localSearches;
+static LDV1000Status_t local_get_status(void *) { return g_localStatus; }
+static uint32_t local_get_cur_frame_num(void *) { return 0; }
+static void local_begin_search(void *, uint32_t u32Frame) { g_localSearches.push_back(u32Frame); }
+
+static bool check_against_local(LDPInShmClient *pClient)
+{
+	static const uint8_t script[] = { 0x0F, 0xFF, 0x1F, 0xFF, 0xF7 };	// 1, 2, search
+	LDV1000Ctx_t ctx;
+	LDV1000Callbacks_t cb;
+	LDPInShmEvent ev;
+
+	memset(&cb, 0, sizeof(cb));
+	cb.get_status = local_get_status;
+	cb.get_cur_frame_num = local_get_cur_frame_num;
+	cb.begin_search = local_begin_search;
+	ldv1000i_ctx_init(&ctx, &cb, 0);
+	ldv1000i_ctx_reset(&ctx, LDV1000_EMU_STANDARD);
+
+	pClient->SetStatus(g_localStatus);
+	pClient->Reset(LDV1000_EMU_STANDARD);
+	while (pClient->PollEvent(&ev)) { }
+
+	for (size_t u = 0; u < sizeof(script); u++)
+	{
+		uint8_t u8Remote;
+
+		ldv1000i_ctx_write(&ctx, script[u]);
+		pClient->Write(script[u]);
+
+		// and a read after each one, as a game would
+		uint8_t u8Local = ldv1000i_ctx_read(&ctx);
+		if (!pClient->ReadLDV1000(&u8Remote, PING_TIMEOUT_US))
+		{
+			fprintf(stderr, "no response from the server\n");
+			return false;
+		}
+		if (u8Local != u8Remote)
+		{
+			fprintf(stderr, "read %u: server returned %02X, in process %02X\n", (unsigned) u, u8Remote, u8Local);
+			return false;
+		}
+	}
+
+	if (!pClient->WaitEvent(&ev, PING_TIMEOUT_US) || (ev.u8Cb != LDPIN_SHM_CB(LDV1000Callbacks_t, begin_search)))
+	{
+		fprintf(stderr, "the server didn't start a search\n");
+		return false;
+	}
+	if ((g_localSearches.size() != 1) || (ev.au32Args[0] != g_localSearches[0]))
+	{
+		fprintf(stderr, "the server searched to %u\n", ev.au32Args[0]);
+		return false;
+	}
+
+	return true;
+}
+
+static void report(const char *pszWhat, std::vector<uint64_t> *pNs)
+{
+	std::sort(pNs->begin(), pNs->end());
+	size_t uCount = pNs->size();
+
+	printf("%-8s %7u round trips: min %6llu ns, median %6llu ns, 99%% %7llu ns, 99.9%% %7llu ns, max %8llu ns\n", pszWhat, (unsigned) uCount,
+		(unsigned long long) (*pNs)[0], (unsigned long long) (*pNs)[uCount / 2], (unsigned long long) (*pNs)[uCount * 99 / 100],
+		(unsigned long long) (*pNs)[uCount * 999 / 1000], (unsigned long long) (*pNs)[uCount - 1]);
+}
+
+static bool time_reads(LDPInShmClient *pClient, uint32_t u32Count, uint32_t u32PauseUs, std::vector<uint64_t> *pNs)
+{
+	for (uint32_t u = 0; u < u32Count; u++)
+	{
+		uint8_t u8Val;
+
+		if (u32PauseUs != 0)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(u32PauseUs));
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if (!pClient->ReadLDV1000(&u8Val, PING_TIMEOUT_US))
+		{
+			fprintf(stderr, "no response from the server\n");
+			return false;
+		}
+		pNs->push_back((uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+	return true;
+}
+
+// the forked server; returns its exit code once the server (and so its shared memory object) is gone
+static int serve(const char *pszName, uint32_t u32SpinUs)
+{
+	LDPInShmServer server;
+	std::string strErr;
+
+	if (!server.Create(pszName, LDPIN_TRACE_LDV1000, &strErr))
+	{
+		fprintf(stderr, "%s\n", strErr.c_str());
+		return 1;
+	}
+	server.Run(u32SpinUs);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszName = 0;
+	bool bSpawn = false;
+	uint32_t u32Count = 100000;
+	// with one core, whichever side is spinning only keeps the other from running
+	uint32_t u32SpinUs = (std::thread::hardware_concurrency() > 1) ? 200 : 0;
+	char szSpawnName[64];
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--name") == 0) && (i + 1 < argc))
+		{
+			pszName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--spawn") == 0)
+		{
+			bSpawn = true;
+		}
+		else if ((strcmp(argv[i], "--count") == 0) && (i + 1 < argc))
+		{
+			u32Count = (uint32_t) atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--spin-us") == 0) && (i + 1 < argc))
+		{
+			u32SpinUs = (uint32_t) atoi(argv[++i]);
+		}
+		else
+		{
+			bSpawn = false;
+			pszName = 0;
+			break;
+		}
+	}
+
+	if ((!pszName && !bSpawn) || (u32Count == 0))
+	{
+		printf("usage: %s --spawn | --name <shm name> [--count <n>] [--spin-us <n>]\n", argv[0]);
+		return 2;
+	}
+
+	pid_t pid = 0;
+	if (bSpawn)
+	{
+		snprintf(szSpawnName, sizeof(szSpawnName), "/ldp-in.ping.%d", (int) getpid());
+		pszName = szSpawnName;
+
+		pid = fork();
+		if (pid < 0)
+		{
+			perror("fork");
+			return 1;
+		}
+		if (pid == 0)
+		{
+			_exit(serve(pszName, u32SpinUs));
+		}
+	}
+
+	LDPInShmClient client;
+	std::string strErr;
+	bool bOpened = client.Open(pszName, 5000, &strErr);
+	bool bOk = bOpened;
+
+	if (!bOpened)
+	{
+		fprintf(stderr, "%s\n", strErr.c_str());
+	}
+	else if (client.Interp() != LDPIN_TRACE_LDV1000)
+	{
+		fprintf(stderr, "%s is not serving an LD-V1000\n", pszName);
+		bOk = false;
+	}
+	else
+	{
+		std::vector<uint64_t> busy;
+		std::vector<uint64_t> idle;
+
+		client.SetSpinUs(u32SpinUs);
+		bOk = check_against_local(&client);
+		if (bOk)
+		{
+			printf("reads and callbacks match the in-process interpreter\n");
+			bOk = time_reads(&client, u32Count, 0, &busy);
+		}
+		// long enough apart that the server has gone to sleep each time
+		if (bOk)
+		{
+			bOk = time_reads(&client, std::min<uint32_t>(u32Count, 200), u32SpinUs * 2 + 1000, &idle);
+		}
+		if (bOk)
+		{
+			report("polling", &busy);
+			report("idle", &idle);
+		}
+	}
+
+	if (bSpawn)
+	{
+		int iStatus = 0;
+
+		if (bOpened)
+		{
+			client.Quit();
+		}
+		else
+		{
+			kill(pid, SIGTERM);
+		}
+		waitpid(pid, &iStatus, 0);
+	}
+
+	return bOk ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Runs one interpreter for an emulator in another process, over the shared-memory transport (see shm_transport.h).
+// Start it before (or after) the emulator, with the name the emulator's LDPInShmClient opens; it serves until the client calls
+//  Quit, and removes the shared memory object when it exits.
+
+#include "shm_server.h"
+#include <thread>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static LDPInShmServer g_server;
+
+// so that Ctrl+C or kill still removes the shared memory object
+static void on_signal(int)
+{
+	g_server.Region()->u32Quit.store(1, std::memory_order_release);
+}
+
+static bool parse_interp(const char *psz, uint8_t *pu8Interp)
+{
+	if (strcmp(psz, "ldv1000") == 0) *pu8Interp = LDPIN_TRACE_LDV1000;
+	else if (strcmp(psz, "ldp1000") == 0) *pu8Interp = LDPIN_TRACE_LDP1000;
+	else if (strcmp(psz, "vp932") == 0) *pu8Interp = LDPIN_TRACE_VP932;
+	else if (strcmp(psz, "vip9500sg") == 0) *pu8Interp = LDPIN_TRACE_VIP9500SG;
+	else return false;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszName = 0;
+	uint8_t u8Interp = 0xFF;
+	// with one core, spinning only keeps the client from running
+	uint32_t u32SpinUs = (std::thread::hardware_concurrency() > 1) ? 200 : 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--name") == 0) && (i + 1 < argc))
+		{
+			pszName = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--interp") == 0) && (i + 1 < argc))
+		{
+			if (!parse_interp(argv[++i], &u8Interp))
+			{
+				u8Interp = 0xFF;
+				break;
+			}
+		}
+		else if ((strcmp(argv[i], "--spin-us") == 0) && (i + 1 < argc))
+		{
+			u32SpinUs = (uint32_t) atoi(argv[++i]);
+		}
+		else
+		{
+			pszName = 0;
+			break;
+		}
+	}
+
+	if (!pszName || (u8Interp == 0xFF))
+	{
+		printf("usage: %s --name <shm name, e.g. /ldp-in.0> --interp ldv1000|ldp1000|vp932|vip9500sg [--spin-us <n>]\n", argv[0]);
+		return 2;
+	}
+
+	std::string strErr;
+
+	if (!g_server.Create(pszName, u8Interp, &strErr))
+	{
+		fprintf(stderr, "%s\n", strErr.c_str());
+		return 1;
+	}
+
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	g_server.Run(u32SpinUs);
+	return 0;
+}
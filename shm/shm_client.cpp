@@ -0,0 +1,230 @@
+#include "shm_client.h"
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LDPInShmClient::LDPInShmClient() :
+	m_pRegion(0),
+	m_u32CmdsSent(0),
+	m_u32SpinUs(50),
+	m_u8ReadSeq(0)
+{
+}
+
+LDPInShmClient::~LDPInShmClient()
+{
+	if (m_pRegion)
+	{
+		munmap(m_pRegion, sizeof(LDPInShmRegion));
+	}
+}
+
+bool LDPInShmClient::Open(const char *pszName, uint32_t u32TimeoutMs, std::string *pErr)
+{
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(u32TimeoutMs);
+
+	for (;;)
+	{
+		int fd = shm_open(pszName, O_RDWR, 0);
+		if (fd >= 0)
+		{
+			struct stat st;
+			void *p = MAP_FAILED;
+
+			// the server may not have sized it yet
+			if ((fstat(fd, &st) == 0) && (st.st_size == (off_t) sizeof(LDPInShmRegion)))
+			{
+				p = mmap(0, sizeof(LDPInShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			}
+			close(fd);
+
+			if (p != MAP_FAILED)
+			{
+				LDPInShmRegion *pRegion = (LDPInShmRegion *) p;
+
+				if (pRegion->u32Ready.load(std::memory_order_acquire) != 0)
+				{
+					if ((pRegion->u32Magic != LDPIN_SHM_MAGIC) || (pRegion->u16Version != LDPIN_SHM_VERSION))
+					{
+						munmap(p, sizeof(LDPInShmRegion));
+						*pErr = "the server was built from a different version of the transport";
+						return false;
+					}
+
+					m_pRegion = pRegion;
+					// the server counts commands from when it started, and the client is the only one that sends them
+					m_u32CmdsSent = m_pRegion->cmd.u32Head.load(std::memory_order_relaxed);
+					return true;
+				}
+				munmap(p, sizeof(LDPInShmRegion));
+			}
+		}
+		else if (errno != ENOENT)
+		{
+			*pErr = std::string("shm_open: ") + strerror(errno);
+			return false;
+		}
+
+		if (std::chrono::steady_clock::now() >= end)
+		{
+			*pErr = "timed out waiting for the server";
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void LDPInShmClient::PushCmd(uint16_t u16Cmd)
+{
+	// the interpreter's own entry points can't refuse a byte, so wait for the server to make room
+	while (!m_pRegion->cmd.Push(u16Cmd))
+	{
+		ldpin_shm_doorbell_ring(&m_pRegion->toServer);
+		std::this_thread::yield();
+	}
+	m_u32CmdsSent++;
+	ldpin_shm_doorbell_ring(&m_pRegion->toServer);
+}
+
+void LDPInShmClient::Reset(uint8_t u8EmulationType)
+{
+	PushCmd(LDPIN_SHM_CMD(LDPIN_SHM_CMD_RESET, u8EmulationType));
+}
+
+void LDPInShmClient::Write(uint8_t u8Byte)
+{
+	PushCmd(LDPIN_SHM_CMD(LDPIN_SHM_CMD_WRITE, u8Byte));
+}
+
+uint8_t LDPInShmClient::RequestRead()
+{
+	m_u8ReadSeq++;
+	PushCmd(LDPIN_SHM_CMD(LDPIN_SHM_CMD_READ, m_u8ReadSeq));
+	return m_u8ReadSeq;
+}
+
+void LDPInShmClient::VBlank()
+{
+	while (!m_pRegion->vblank.Push(m_u32CmdsSent))
+	{
+		ldpin_shm_doorbell_ring(&m_pRegion->toServer);
+		std::this_thread::yield();
+	}
+	ldpin_shm_doorbell_ring(&m_pRegion->toServer);
+}
+
+void LDPInShmClient::SetStatus(uint32_t u32Status)
+{
+	m_pRegion->u32Status.store(u32Status, std::memory_order_release);
+}
+
+void LDPInShmClient::SetCurFrame(uint32_t u32Frame)
+{
+	m_pRegion->u32CurFrame.store(u32Frame, std::memory_order_release);
+}
+
+void LDPInShmClient::SetActiveDisc(uint8_t u8Disc)
+{
+	m_pRegion->u8ActiveDisc.store(u8Disc, std::memory_order_release);
+}
+
+void LDPInShmClient::SetAvailableDiscs(const uint8_t *p8Discs)
+{
+	int i = 0;
+
+	for (; (i < LDPIN_SHM_MAX_DISCS - 1) && (p8Discs[i] != 0); i++)
+	{
+		m_pRegion->au8Discs[i].store(p8Discs[i], std::memory_order_release);
+	}
+	m_pRegion->au8Discs[i].store(0, std::memory_order_release);
+}
+
+template <typename T, uint32_t SIZE> bool LDPInShmClient::Wait(LDPInSpscRing<T, SIZE> *pRing, T *pVal, uint32_t u32TimeoutUs)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point spinEnd = start + std::chrono::microseconds(m_u32SpinUs);
+	std::chrono::steady_clock::time_point end = start + std::chrono::microseconds(u32TimeoutUs);
+
+	for (;;)
+	{
+		// read before looking, so that anything pushed after the look stops the wait below
+		uint32_t u32Seq = m_pRegion->toClient.u32Seq.load(std::memory_order_seq_cst);
+
+		if (pRing->Pop(pVal))
+		{
+			return true;
+		}
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now >= end)
+		{
+			return false;
+		}
+
+		if (now < spinEnd)
+		{
+			ldpin_shm_relax();
+		}
+		else
+		{
+			uint32_t u32Left = (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(end - now).count();
+			ldpin_shm_doorbell_wait(&m_pRegion->toClient, u32Seq, u32Left + 1);
+		}
+	}
+}
+
+bool LDPInShmClient::Read(uint16_t *pu16Val)
+{
+	return m_pRegion->resp.Pop(pu16Val);
+}
+
+bool LDPInShmClient::WaitRead(uint16_t *pu16Val, uint32_t u32TimeoutUs)
+{
+	return Wait(&m_pRegion->resp, pu16Val, u32TimeoutUs);
+}
+
+bool LDPInShmClient::ReadLDV1000(uint8_t *pu8Val, uint32_t u32TimeoutUs)
+{
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::microseconds(u32TimeoutUs);
+	uint8_t u8Seq = RequestRead();
+	uint16_t u16Val;
+
+	for (;;)
+	{
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		uint32_t u32Left = (now < end) ? (uint32_t) std::chrono::duration_cast<std::chrono::microseconds>(end - now).count() : 0;
+
+		if (!WaitRead(&u16Val, u32Left))
+		{
+			return false;
+		}
+
+		// anything else is the answer to a read that gave up waiting for it
+		if ((uint8_t) (u16Val >> 8) == u8Seq)
+		{
+			*pu8Val = (uint8_t) u16Val;
+			return true;
+		}
+	}
+}
+
+bool LDPInShmClient::PollEvent(LDPInShmEvent *pEv)
+{
+	return m_pRegion->events.Pop(pEv);
+}
+
+bool LDPInShmClient::WaitEvent(LDPInShmEvent *pEv, uint32_t u32TimeoutUs)
+{
+	return Wait(&m_pRegion->events, pEv, u32TimeoutUs);
+}
+
+void LDPInShmClient::Quit()
+{
+	m_pRegion->u32Quit.store(1, std::memory_order_release);
+	ldpin_shm_doorbell_ring(&m_pRegion->toServer);
+}
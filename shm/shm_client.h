@@ -0,0 +1,87 @@
+#ifndef LDP_IN_SHM_CLIENT_H
+#define LDP_IN_SHM_CLIENT_H
+
+// The emulator side of the shared-memory transport (see shm_transport.h).
+// Stands in for the interpreter's entry points: what would have been ldp1000i_ctx_write becomes Write, ldp1000i_ctx_read becomes
+//  Read, and so on, while the player's status and frame number are reported with SetStatus and SetCurFrame instead of being asked
+//  for by callbacks.  The callbacks that don't return anything come back as events (PollEvent).
+// Only one thread may use a client at a time.
+
+#include "shm_transport.h"
+#include <string>
+
+class LDPInShmClient
+{
+public:
+	LDPInShmClient();
+
+	// unmaps the shared memory (the server keeps running)
+	~LDPInShmClient();
+
+	// Attaches to the server's shared memory object, waiting up to u32TimeoutMs for the server to create it.
+	// Returns false with a reason in *pErr if it can't.
+	bool Open(const char *pszName, uint32_t u32TimeoutMs, std::string *pErr);
+
+	// LDPInTraceInterp_t of the interpreter being served
+	uint8_t Interp() const { return m_pRegion->u8Interp; }
+
+	// How long Wait* busy-poll before sleeping until the server pushes something (default 50 us).
+	// Polling keeps the round trip well under a microsecond while the game is talking to the player; sleeping keeps an idle
+	//  emulator from using a core.
+	void SetSpinUs(uint32_t u32SpinUs) { m_u32SpinUs = u32SpinUs; }
+
+	// <prefix>_ctx_reset
+	void Reset(uint8_t u8EmulationType);
+
+	// <prefix>_ctx_write
+	void Write(uint8_t u8Byte);
+
+	// LD-V1000 only: asks for ldv1000i_ctx_read, whose result arrives on the response ring (see ReadLDV1000) with the
+	//  sequence number returned here in bits 8-15
+	uint8_t RequestRead();
+
+	// The vblank entry point (ldp1000i_ctx_think_during_vblank, vp932i_ctx_think_during_vblank with the status last set,
+	//  vip9500sgi_ctx_think_after_vblank, whose get_cur_vbi_line18 gives the picture number of the frame last set).
+	// It happens after every byte written before it and before every byte written after it, as it would in process.
+	void VBlank();
+
+	// what the interpreter's get_status, get_cur_frame_num and (LD-V1000) query_* callbacks return from now on
+	void SetStatus(uint32_t u32Status);
+	void SetCurFrame(uint32_t u32Frame);
+	void SetActiveDisc(uint8_t u8Disc);
+	void SetAvailableDiscs(const uint8_t *p8Discs);	// 0-terminated, up to LDPIN_SHM_MAX_DISCS - 1 discs
+
+	// <prefix>_ctx_can_read + <prefix>_ctx_read: returns false if nothing has come back yet
+	bool Read(uint16_t *pu16Val);
+
+	// Read, waiting up to u32TimeoutUs for something to come back
+	bool WaitRead(uint16_t *pu16Val, uint32_t u32TimeoutUs);
+
+	// RequestRead + WaitRead, throwing away the late answers to earlier reads that timed out
+	bool ReadLDV1000(uint8_t *pu8Val, uint32_t u32TimeoutUs);
+
+	// the oldest callback not yet returned; false if there isn't one
+	bool PollEvent(LDPInShmEvent *pEv);
+
+	// PollEvent, waiting up to u32TimeoutUs for one
+	bool WaitEvent(LDPInShmEvent *pEv, uint32_t u32TimeoutUs);
+
+	// how many responses and events the server had to throw away because they weren't collected in time
+	uint32_t RespDropped() const { return m_pRegion->u32RespDropped.load(std::memory_order_relaxed); }
+	uint32_t EventsDropped() const { return m_pRegion->u32EventsDropped.load(std::memory_order_relaxed); }
+
+	// stops the server's Run
+	void Quit();
+
+private:
+	void PushCmd(uint16_t u16Cmd);
+
+	template <typename T, uint32_t SIZE> bool Wait(LDPInSpscRing<T, SIZE> *pRing, T *pVal, uint32_t u32TimeoutUs);
+
+	LDPInShmRegion *m_pRegion;
+	uint32_t m_u32CmdsSent;
+	uint32_t m_u32SpinUs;
+	uint8_t m_u8ReadSeq;	// sequence number of the last LD-V1000 read requested
+};
+
+#endif // LDP_IN_SHM_CLIENT_H
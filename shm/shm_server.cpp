@@ -0,0 +1,396 @@
+#include "shm_server.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/////////////////////////////////////////////////////////////////
+// callbacks; the ones that return something read what the client last reported, the rest become events
+
+static LDPInShmServer *srv(void *p) { return (LDPInShmServer *) p; }
+static uint32_t status(void *p) { return srv(p)->Region()->u32Status.load(std::memory_order_acquire); }
+static uint32_t frame(void *p) { return srv(p)->Region()->u32CurFrame.load(std::memory_order_acquire); }
+
+static void ev(void *p, uint8_t u8Cb, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0)
+{
+	LDPInShmEvent e;
+
+	memset(&e, 0, sizeof(e));
+	e.u8Cb = u8Cb;
+	e.au32Args[0] = a0;
+	e.au32Args[1] = a1;
+	e.au32Args[2] = a2;
+	e.au32Args[3] = a3;
+	srv(p)->PushEvent(e);
+}
+
+static void ev_data(void *p, uint8_t u8Cb, const void *pData, size_t uLen, uint32_t a0 = 0)
+{
+	LDPInShmEvent e;
+
+	memset(&e, 0, sizeof(e));
+	e.u8Cb = u8Cb;
+	e.au32Args[0] = a0;
+	e.u8Len = (uint8_t) ((uLen < sizeof(e.au8Data)) ? uLen : sizeof(e.au8Data));
+	memcpy(e.au8Data, pData, e.u8Len);
+	srv(p)->PushEvent(e);
+}
+
+namespace ldv1000_shm
+{
+#define IDX(name) LDPIN_SHM_CB(LDV1000Callbacks_t, name)
+	LDV1000Status_t get_status(void *p) { return (LDV1000Status_t) status(p); }
+	uint32_t get_cur_frame_num(void *p) { return frame(p); }
+	void play(void *p) { ev(p, IDX(play)); }
+	void pause(void *p) { ev(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t u32Frame) { ev(p, IDX(begin_search), u32Frame); }
+	void step_reverse(void *p) { ev(p, IDX(step_reverse)); }
+	void change_speed(void *p, uint8_t u8Num, uint8_t u8Denom) { ev(p, IDX(change_speed), u8Num, u8Denom); }
+	void skip_forward(void *p, uint8_t u8Tracks) { ev(p, IDX(skip_forward), u8Tracks); }
+	void skip_backward(void *p, uint8_t u8Tracks) { ev(p, IDX(skip_backward), u8Tracks); }
+	void change_audio(void *p, uint8_t u8Channel, uint8_t u8Enable) { ev(p, IDX(change_audio), u8Channel, u8Enable); }
+	void on_error(void *p, const char *pszErrMsg) { ev_data(p, IDX(on_error), pszErrMsg, strlen(pszErrMsg)); }
+	const uint8_t *query_available_discs(void *p) { return srv(p)->Discs(); }
+	uint8_t query_active_disc(void *p) { return srv(p)->Region()->u8ActiveDisc.load(std::memory_order_acquire); }
+	void begin_changing_to_disc(void *p, uint8_t idDisc) { ev(p, IDX(begin_changing_to_disc), idDisc); }
+	void change_seek_delay(void *p, LDV1000_BOOL bEnabled) { ev(p, IDX(change_seek_delay), bEnabled); }
+	void change_spinup_delay(void *p, LDV1000_BOOL bEnabled) { ev(p, IDX(change_spinup_delay), bEnabled); }
+	void change_super_mode(void *p, LDV1000_BOOL bEnabled) { ev(p, IDX(change_super_mode), bEnabled); }
+#undef IDX
+
+	const LDV1000Callbacks_t cbs =
+	{
+		get_status, get_cur_frame_num, play, pause, begin_search, step_reverse, change_speed, skip_forward, skip_backward,
+		change_audio, on_error, query_available_discs, query_active_disc, begin_changing_to_disc, change_seek_delay,
+		change_spinup_delay, change_super_mode
+	};
+}
+
+namespace ldp1000_shm
+{
+#define IDX(name) LDPIN_SHM_CB(LDP1000Callbacks_t, name)
+	void play(void *p, uint8_t u8Num, uint8_t u8Denom, LDP1000_BOOL bBackward, LDP1000_BOOL bSquelched) { ev(p, IDX(play), u8Num, u8Denom, bBackward, bSquelched); }
+	void pause(void *p) { ev(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t u32Frame) { ev(p, IDX(begin_search), u32Frame); }
+	void step_forward(void *p) { ev(p, IDX(step_forward)); }
+	void step_reverse(void *p) { ev(p, IDX(step_reverse)); }
+	void skip(void *p, int16_t i16Tracks) { ev(p, IDX(skip), (uint32_t) (int32_t) i16Tracks); }
+	void change_audio(void *p, uint8_t u8Channel, uint8_t u8Enable) { ev(p, IDX(change_audio), u8Channel, u8Enable); }
+	void change_video(void *p, LDP1000_BOOL bEnable) { ev(p, IDX(change_video), bEnable); }
+	LDP1000Status_t get_status(void *p) { return (LDP1000Status_t) status(p); }
+	uint32_t get_cur_frame_num(void *p) { return frame(p); }
+	void text_enable_changed(void *p, LDP1000_BOOL bEnabled) { ev(p, IDX(text_enable_changed), bEnabled); }
+	void text_buffer_contents_changed(void *p, const uint8_t *p8Buf) { ev_data(p, IDX(text_buffer_contents_changed), p8Buf, 32); }
+	void text_buffer_start_index_changed(void *p, uint8_t u8Idx) { ev(p, IDX(text_buffer_start_index_changed), u8Idx); }
+	void text_modes_changed(void *p, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y) { ev(p, IDX(text_modes_changed), u8Mode, u8X, u8Y); }
+	void error(void *p, LDP1000ErrCode_t code, uint8_t u8Val) { ev(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const LDP1000Callbacks_t cbs =
+	{
+		play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed,
+		text_modes_changed, error
+	};
+}
+
+namespace vp932_shm
+{
+#define IDX(name) LDPIN_SHM_CB(VP932Callbacks_t, name)
+	void play(void *p, uint8_t u8Num, uint8_t u8Denom, VP932_BOOL bBackward, VP932_BOOL bSquelched) { ev(p, IDX(play), u8Num, u8Denom, bBackward, bSquelched); }
+	void step(void *p, VP932_BOOL bBackward) { ev(p, IDX(step), bBackward); }
+	void pause(void *p) { ev(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t u32Frame) { ev(p, IDX(begin_search), u32Frame); }
+	void change_audio(void *p, uint8_t u8Channel, uint8_t u8Enable) { ev(p, IDX(change_audio), u8Channel, u8Enable); }
+	uint32_t get_cur_frame_num(void *p) { return frame(p); }
+	void error(void *p, VP932ErrCode_t code, uint8_t u8Val) { ev(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const VP932Callbacks_t cbs = { play, step, pause, begin_search, change_audio, get_cur_frame_num, error };
+}
+
+namespace vip9500sg_shm
+{
+#define IDX(name) LDPIN_SHM_CB(VIP9500SGCallbacks_t, name)
+	void play(void *p) { ev(p, IDX(play)); }
+	void pause(void *p) { ev(p, IDX(pause)); }
+	void stop(void *p) { ev(p, IDX(stop)); }
+	void step_reverse(void *p) { ev(p, IDX(step_reverse)); }
+	void begin_search(void *p, uint32_t u32Frame) { ev(p, IDX(begin_search), u32Frame); }
+	void skip(void *p, int32_t i32Tracks) { ev(p, IDX(skip), (uint32_t) i32Tracks); }
+	void change_audio(void *p, uint8_t u8Channel, uint8_t u8Enable) { ev(p, IDX(change_audio), u8Channel, u8Enable); }
+	VIP9500SGStatus_t get_status(void *p) { return (VIP9500SGStatus_t) status(p); }
+	uint32_t get_cur_frame_num(void *p) { return frame(p); }
+	// every field carries a picture number (only the top nibble is looked at), as in ldp_in_ptyd
+	uint32_t get_cur_vbi_line18(void *p) { return 0xF80000 | frame(p); }
+	void error(void *p, VIP9500SGErrCode_t code, uint8_t u8Val) { ev(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const VIP9500SGCallbacks_t cbs =
+	{
+		play, pause, stop, step_reverse, begin_search, skip, change_audio, get_status, get_cur_frame_num, get_cur_vbi_line18, error
+	};
+}
+
+/////////////////////////////////////////////////////////////////
+
+LDPInShmServer::LDPInShmServer() :
+	m_pRegion(0),
+	m_u8Interp(0),
+	m_u32CmdsDone(0),
+	m_bToClient(false)
+{
+	memset(m_au8Discs, 0, sizeof(m_au8Discs));
+}
+
+LDPInShmServer::~LDPInShmServer()
+{
+	if (m_pRegion)
+	{
+		munmap(m_pRegion, sizeof(LDPInShmRegion));
+		shm_unlink(m_strName.c_str());
+	}
+}
+
+bool LDPInShmServer::Create(const char *pszName, uint8_t u8Interp, std::string *pErr)
+{
+	if ((u8Interp != LDPIN_TRACE_LDV1000) && (u8Interp != LDPIN_TRACE_LDP1000) && (u8Interp != LDPIN_TRACE_VP932) &&
+		(u8Interp != LDPIN_TRACE_VIP9500SG))
+	{
+		*pErr = "only the LD-V1000, LDP-1000, VP932 and VIP9500SG can be served";
+		return false;
+	}
+
+	// a name left behind by a server that died would hold a stale layout, so always start from a new object
+	shm_unlink(pszName);
+	int fd = shm_open(pszName, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0)
+	{
+		*pErr = std::string("shm_open: ") + strerror(errno);
+		return false;
+	}
+
+	void *p = MAP_FAILED;
+	if (ftruncate(fd, sizeof(LDPInShmRegion)) == 0)
+	{
+		p = mmap(0, sizeof(LDPInShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+	int iErr = errno;
+	close(fd);
+
+	if (p == MAP_FAILED)
+	{
+		*pErr = std::string("mapping shared memory: ") + strerror(iErr);
+		shm_unlink(pszName);
+		return false;
+	}
+
+	// a new object is all zeroes, which is what every atomic and ring needs to start from, so only the header needs setting
+	m_strName = pszName;
+	m_pRegion = (LDPInShmRegion *) p;
+	m_u8Interp = u8Interp;
+	m_u32CmdsDone = 0;
+
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_LDV1000:
+		ldv1000i_ctx_init(&m_ldv1000, &ldv1000_shm::cbs, this);
+		ldv1000i_ctx_reset(&m_ldv1000, LDV1000_EMU_STANDARD);
+		break;
+	case LDPIN_TRACE_LDP1000:
+		ldp1000i_ctx_init(&m_ldp1000, &ldp1000_shm::cbs, this);
+		ldp1000i_ctx_reset(&m_ldp1000, LDP1000_EMU_LDP1000A);
+		break;
+	case LDPIN_TRACE_VIP9500SG:
+		vip9500sgi_ctx_init(&m_vip9500sg, &vip9500sg_shm::cbs, this);
+		vip9500sgi_ctx_reset(&m_vip9500sg);
+		break;
+	default:
+		vp932i_ctx_init(&m_vp932, &vp932_shm::cbs, this);
+		vp932i_ctx_reset(&m_vp932);
+		break;
+	}
+
+	m_pRegion->u32Magic = LDPIN_SHM_MAGIC;
+	m_pRegion->u16Version = LDPIN_SHM_VERSION;
+	m_pRegion->u8Interp = u8Interp;
+	m_pRegion->u32Ready.store(1, std::memory_order_release);
+	return true;
+}
+
+void LDPInShmServer::PushEvent(const LDPInShmEvent &ev)
+{
+	if (m_pRegion->events.Push(ev))
+	{
+		m_bToClient = true;
+	}
+	else
+	{
+		m_pRegion->u32EventsDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+const uint8_t *LDPInShmServer::Discs()
+{
+	for (int i = 0; i < LDPIN_SHM_MAX_DISCS; i++)
+	{
+		m_au8Discs[i] = m_pRegion->au8Discs[i].load(std::memory_order_acquire);
+	}
+	m_au8Discs[LDPIN_SHM_MAX_DISCS - 1] = 0;
+	return m_au8Discs;
+}
+
+void LDPInShmServer::Dispatch(uint16_t u16Cmd)
+{
+	uint8_t u8Val = (uint8_t) u16Cmd;
+
+	switch (u16Cmd >> 8)
+	{
+	case LDPIN_SHM_CMD_WRITE:
+		switch (m_u8Interp)
+		{
+		case LDPIN_TRACE_LDV1000: ldv1000i_ctx_write(&m_ldv1000, u8Val); break;
+		case LDPIN_TRACE_LDP1000: ldp1000i_ctx_write(&m_ldp1000, u8Val); break;
+		case LDPIN_TRACE_VIP9500SG: vip9500sgi_ctx_write(&m_vip9500sg, u8Val); break;
+		default: vp932i_ctx_write(&m_vp932, u8Val); break;
+		}
+		break;
+	case LDPIN_SHM_CMD_READ:
+		// the other interpreters queue their responses, which DrainResponses passes on
+		if (m_u8Interp == LDPIN_TRACE_LDV1000)
+		{
+			if (m_pRegion->resp.Push((uint16_t) ((u8Val << 8) | ldv1000i_ctx_read(&m_ldv1000))))
+			{
+				m_bToClient = true;
+			}
+			else
+			{
+				m_pRegion->u32RespDropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+		break;
+	case LDPIN_SHM_CMD_RESET:
+		switch (m_u8Interp)
+		{
+		case LDPIN_TRACE_LDV1000: ldv1000i_ctx_reset(&m_ldv1000, (LDV1000_EmulationType_t) u8Val); break;
+		case LDPIN_TRACE_LDP1000: ldp1000i_ctx_reset(&m_ldp1000, (LDP1000_EmulationType_t) u8Val); break;
+		case LDPIN_TRACE_VIP9500SG: vip9500sgi_ctx_reset(&m_vip9500sg); break;
+		default: vp932i_ctx_reset(&m_vp932); break;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void LDPInShmServer::VBlank()
+{
+	switch (m_u8Interp)
+	{
+	case LDPIN_TRACE_LDP1000: ldp1000i_ctx_think_during_vblank(&m_ldp1000); break;
+	case LDPIN_TRACE_VP932: vp932i_ctx_think_during_vblank(&m_vp932, (VP932Status_t) status(this)); break;
+	case LDPIN_TRACE_VIP9500SG: vip9500sgi_ctx_think_after_vblank(&m_vip9500sg); break;
+	default: break;	// the LD-V1000 has no vblank entry point
+	}
+}
+
+bool LDPInShmServer::DrainResponses()
+{
+	bool bDid = false;
+
+	// whatever doesn't fit stays in the interpreter's own transmit ring until the client catches up
+	if (m_u8Interp == LDPIN_TRACE_LDP1000)
+	{
+		while (ldp1000i_ctx_can_read(&m_ldp1000) && m_pRegion->resp.Push(ldp1000i_ctx_read(&m_ldp1000)))
+		{
+			bDid = true;
+		}
+	}
+	else if (m_u8Interp == LDPIN_TRACE_VP932)
+	{
+		while (vp932i_ctx_can_read(&m_vp932) && m_pRegion->resp.Push(vp932i_ctx_read(&m_vp932)))
+		{
+			bDid = true;
+		}
+	}
+	else if (m_u8Interp == LDPIN_TRACE_VIP9500SG)
+	{
+		while (vip9500sgi_ctx_can_read(&m_vip9500sg) && m_pRegion->resp.Push(vip9500sgi_ctx_read(&m_vip9500sg)))
+		{
+			bDid = true;
+		}
+	}
+
+	return bDid;
+}
+
+bool LDPInShmServer::Poll()
+{
+	bool bDid = false;
+
+	for (;;)
+	{
+		// Look at the command ring before the vblank ring: the client pushes a vblank before any command sent after it, so if a
+		//  command is visible here, any vblank that has to come first is visible below.
+		bool bCmd = (m_pRegion->cmd.Count() != 0);
+		const uint32_t *pu32VBlank = m_pRegion->vblank.Peek();
+
+		if (pu32VBlank && (*pu32VBlank == m_u32CmdsDone))
+		{
+			m_pRegion->vblank.Drop();
+			VBlank();
+			bDid = true;
+			continue;
+		}
+
+		uint16_t u16Cmd;
+		if (!bCmd || !m_pRegion->cmd.Pop(&u16Cmd))
+		{
+			break;
+		}
+		Dispatch(u16Cmd);
+		m_u32CmdsDone++;
+		bDid = true;
+	}
+
+	if (DrainResponses())
+	{
+		m_bToClient = true;
+		bDid = true;
+	}
+
+	if (m_bToClient)
+	{
+		ldpin_shm_doorbell_ring(&m_pRegion->toClient);
+		m_bToClient = false;
+	}
+
+	return bDid;
+}
+
+void LDPInShmServer::Run(uint32_t u32SpinUs)
+{
+	std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+	while (m_pRegion->u32Quit.load(std::memory_order_acquire) == 0)
+	{
+		// read before polling, so that anything pushed after the poll has looked stops the wait below
+		uint32_t u32Seq = m_pRegion->toServer.u32Seq.load(std::memory_order_seq_cst);
+
+		if (Poll())
+		{
+			last = std::chrono::steady_clock::now();
+		}
+		else if (std::chrono::steady_clock::now() - last < std::chrono::microseconds(u32SpinUs))
+		{
+			ldpin_shm_relax();
+		}
+		else
+		{
+			// wake up now and then anyway, in case the client died without asking us to quit
+			ldpin_shm_doorbell_wait(&m_pRegion->toServer, u32Seq, 100000);
+		}
+	}
+}
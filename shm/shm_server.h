@@ -0,0 +1,59 @@
+#ifndef LDP_IN_SHM_SERVER_H
+#define LDP_IN_SHM_SERVER_H
+
+// The interpreter side of the shared-memory transport (see shm_transport.h).
+// Creates the shared memory object, runs one interpreter (LD-V1000, LDP-1000, VP932 or VIP9500SG) on what the client sends, and
+//  passes back its responses and callbacks.
+
+#include "shm_transport.h"
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <string>
+
+class LDPInShmServer
+{
+public:
+	LDPInShmServer();
+
+	// unmaps the shared memory and removes its name
+	~LDPInShmServer();
+
+	// Creates the shared memory object pszName (for example "/ldp-in.0", see shm_open) for u8Interp (LDPIN_TRACE_LDV1000,
+	//  LDPIN_TRACE_LDP1000, LDPIN_TRACE_VP932 or LDPIN_TRACE_VIP9500SG), replacing one left behind by a server that died, and resets the interpreter.
+	// Returns false with a reason in *pErr if it can't.
+	bool Create(const char *pszName, uint8_t u8Interp, std::string *pErr);
+
+	// Handles everything that is waiting (commands, vblanks, responses); returns true if there was anything.
+	// For hosts with a loop of their own; Run calls it.
+	bool Poll();
+
+	// Polls until the client asks it to stop, busy-polling for u32SpinUs after the last thing it did and then sleeping until the
+	//  client pushes something.
+	void Run(uint32_t u32SpinUs);
+
+	// used by the interpreter's callbacks
+	void PushEvent(const LDPInShmEvent &ev);
+	LDPInShmRegion *Region() { return m_pRegion; }
+	const uint8_t *Discs();
+
+private:
+	void Dispatch(uint16_t u16Cmd);
+	void VBlank();
+	bool DrainResponses();
+
+	std::string m_strName;
+	LDPInShmRegion *m_pRegion;
+	uint8_t m_u8Interp;
+	uint32_t m_u32CmdsDone;	// commands handled so far (compared with the vblank ring's entries)
+	bool m_bToClient;	// something was pushed for the client since the doorbell was last rung
+	uint8_t m_au8Discs[LDPIN_SHM_MAX_DISCS];
+
+	LDV1000Ctx_t m_ldv1000;
+	LDP1000Ctx_t m_ldp1000;
+	VP932Ctx_t m_vp932;
+	VIP9500SGCtx_t m_vip9500sg;
+};
+
+#endif // LDP_IN_SHM_SERVER_H
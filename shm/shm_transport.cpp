@@ -0,0 +1,39 @@
+#include "shm_transport.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+
+// not FUTEX_PRIVATE_FLAG: the two sides are different processes
+static long shm_futex(std::atomic<uint32_t> *pWord, int iOp, uint32_t u32Val, const struct timespec *pTimeout)
+{
+	return syscall(SYS_futex, (uint32_t *) pWord, iOp, u32Val, pTimeout, (uint32_t *) 0, 0);
+}
+
+void ldpin_shm_doorbell_ring(LDPInShmDoorbell *pBell)
+{
+	// seq_cst on both sides (here and in ldpin_shm_doorbell_wait), so that either the sleeper sees the new sequence number
+	//  before it sleeps or this sees that it is asleep
+	pBell->u32Seq.fetch_add(1, std::memory_order_seq_cst);
+	if (pBell->u32Sleeping.load(std::memory_order_seq_cst) != 0)
+	{
+		shm_futex(&pBell->u32Seq, FUTEX_WAKE, INT_MAX, 0);
+	}
+}
+
+void ldpin_shm_doorbell_wait(LDPInShmDoorbell *pBell, uint32_t u32Seq, uint32_t u32TimeoutUs)
+{
+	struct timespec ts;
+
+	ts.tv_sec = u32TimeoutUs / 1000000;
+	ts.tv_nsec = (long) (u32TimeoutUs % 1000000) * 1000;
+
+	pBell->u32Sleeping.store(1, std::memory_order_seq_cst);
+	if (pBell->u32Seq.load(std::memory_order_seq_cst) == u32Seq)
+	{
+		// the kernel checks the value again, so a ring between the load above and the wait isn't missed
+		shm_futex(&pBell->u32Seq, FUTEX_WAIT, u32Seq, &ts);
+	}
+	pBell->u32Sleeping.store(0, std::memory_order_relaxed);
+}
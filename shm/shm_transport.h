@@ -0,0 +1,104 @@
+#ifndef LDP_IN_SHM_TRANSPORT_H
+#define LDP_IN_SHM_TRANSPORT_H
+
+// Shared-memory transport between an emulator (the client, see shm_client.h) and an interpreter running in another process
+//  (the server, see shm_server.h), so that the interpreter can have a real-time priority of its own.
+// One POSIX shared memory object per interpreter holds:
+//  - the command ring (client -> server): bytes written to the player, LD-V1000 reads and resets
+//  - the response ring (server -> client): bytes the player sends back (LD-V1000: the result of each read)
+//  - the vblank ring (client -> server): one entry per vblank holding how many commands had been sent by then, so the server runs
+//     its vblank entry point at exactly the same point in the byte stream as it would have in process
+//  - the event ring (server -> client): every callback the interpreter makes that doesn't return anything, with its arguments
+//  - the player's status, current frame and discs, which the client keeps up to date and the server's get_* callbacks read
+// Each ring is an LDPInSpscRing (see spsc_ring.h), with one producer and one consumer.
+// Both sides busy-poll for a while after the last thing they got, then sleep on a futex in the shared memory that the other side
+//  wakes when it produces something.
+// Linux only, and both processes must be built from the same tree (the layout is checked with LDPIN_SHM_VERSION).
+
+#include <ldp-in/trace.h>	// LDPInTraceInterp_t
+#include "spsc_ring.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LDPIN_SHM_MAGIC 0x4D53444C	// "LDSM"
+#define LDPIN_SHM_VERSION 2
+
+// command ring entries: the operation in bits 8-15, its value in bits 0-7
+#define LDPIN_SHM_CMD_WRITE 0	// write the value to the player
+#define LDPIN_SHM_CMD_READ 1	// LD-V1000 read; the value is a sequence number, returned in bits 8-15 of the result on the response ring
+#define LDPIN_SHM_CMD_RESET 2	// reset; the value is the emulation type (0 for interpreters that don't have one)
+#define LDPIN_SHM_CMD(op, val)	((uint16_t) (((op) << 8) | (uint8_t) (val)))
+
+// which callback an event is for: its position in the interpreter's callbacks struct (the same numbering as the trace's CALLBACK records)
+#define LDPIN_SHM_CB(type, name)	((uint8_t) (offsetof(type, name) / sizeof(void (*)(void))))
+
+struct LDPInShmEvent
+{
+	uint8_t u8Cb;	// LDPIN_SHM_CB of the callback
+	uint8_t u8Len;	// bytes used in au8Data
+	uint8_t au8Pad[2];
+	uint32_t au32Args[4];	// numeric arguments, in order (bools and enums as their values, skips sign-extended from their own type)
+	uint8_t au8Data[32];	// LD-V1000 on_error text (not terminated), LDP-1000 text buffer contents
+};
+
+// keeps the CPU from hammering the cache line while spinning (and lets a hyperthread sibling run)
+static inline void ldpin_shm_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__ ("yield");
+#endif
+}
+
+// How one side tells the other that it has pushed something.
+// The producer bumps u32Seq after pushing and only makes the futex call if the consumer has said it is about to sleep, so
+//  while both sides are busy-polling no system calls are made at all.
+struct LDPInShmDoorbell
+{
+	alignas(64) std::atomic<uint32_t> u32Seq;
+	std::atomic<uint32_t> u32Sleeping;
+};
+
+void ldpin_shm_doorbell_ring(LDPInShmDoorbell *pBell);
+
+// Sleeps until the doorbell has been rung since u32Seq was read from it (returns at once if it already has) or u32TimeoutUs has passed.
+void ldpin_shm_doorbell_wait(LDPInShmDoorbell *pBell, uint32_t u32Seq, uint32_t u32TimeoutUs);
+
+#define LDPIN_SHM_CMD_SIZE 1024
+#define LDPIN_SHM_RESP_SIZE 1024
+#define LDPIN_SHM_VBLANK_SIZE 256
+#define LDPIN_SHM_EVENT_SIZE 256
+#define LDPIN_SHM_MAX_DISCS 16
+
+struct LDPInShmRegion
+{
+	uint32_t u32Magic;	// LDPIN_SHM_MAGIC once the server has set everything up
+	uint16_t u16Version;	// LDPIN_SHM_VERSION
+	uint8_t u8Interp;	// LDPInTraceInterp_t
+	std::atomic<uint32_t> u32Ready;	// set by the server (release) once the rest is initialized
+	std::atomic<uint32_t> u32Quit;	// set by the client to stop the server
+
+	// the player, as the client last reported it
+	std::atomic<uint32_t> u32Status;	// <X>Status_t
+	std::atomic<uint32_t> u32CurFrame;
+	std::atomic<uint8_t> u8ActiveDisc;
+	std::atomic<uint8_t> au8Discs[LDPIN_SHM_MAX_DISCS];	// LD-V1000 available discs, 0-terminated
+
+	// things the server had to throw away because the client wasn't keeping up
+	std::atomic<uint32_t> u32RespDropped;
+	std::atomic<uint32_t> u32EventsDropped;
+
+	LDPInShmDoorbell toServer;	// rung after pushing commands and vblanks
+	LDPInShmDoorbell toClient;	// rung after pushing responses and events
+
+	LDPInSpscRing<uint16_t, LDPIN_SHM_CMD_SIZE> cmd;
+	LDPInSpscRing<uint32_t, LDPIN_SHM_VBLANK_SIZE> vblank;	// how many commands had been pushed when the vblank happened
+	LDPInSpscRing<uint16_t, LDPIN_SHM_RESP_SIZE> resp;	// bits 8-15: LDP-1000 LDP1000Latency_t (like ldp1000i_read), LD-V1000 read sequence number
+	LDPInSpscRing<LDPInShmEvent, LDPIN_SHM_EVENT_SIZE> events;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the shared indices must be lock-free to work across processes");
+
+#endif // LDP_IN_SHM_TRANSPORT_H
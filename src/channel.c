@@ -0,0 +1,142 @@
+#include <ldp-in/channel.h>
+
+// Each side loads the other side's index with acquire (so it sees the bytes published before it) and stores its own with release
+//  (so the bytes it wrote, or finished reading, are done before the other side can see the move).
+#ifdef LDP_IN_CHAN_C11_ATOMICS
+#define LDP_IN_CHAN_LOAD_ACQ(idx)	atomic_load_explicit(&(idx), memory_order_acquire)
+#define LDP_IN_CHAN_LOAD_OWN(idx)	atomic_load_explicit(&(idx), memory_order_relaxed)
+#define LDP_IN_CHAN_STORE_REL(idx, val)	atomic_store_explicit(&(idx), (uint8_t) (val), memory_order_release)
+#define LDP_IN_CHAN_STORE_INIT(idx, val)	atomic_init(&(idx), (uint8_t) (val))
+#else
+// AVR (or a compiler without C11 atomics): byte loads and stores are atomic, so keeping the compiler from moving the buffer access
+//  to the other side of the volatile index access is enough (see ring.c)
+#if defined(__GNUC__)
+#define LDP_IN_CHAN_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LDP_IN_CHAN_BARRIER()	_ReadWriteBarrier()
+#else
+#define LDP_IN_CHAN_BARRIER()
+#endif
+#define LDP_IN_CHAN_LOAD_ACQ(idx)	ldpin_chan_load_acq(&(idx))
+#define LDP_IN_CHAN_LOAD_OWN(idx)	(idx)
+#define LDP_IN_CHAN_STORE_REL(idx, val)	do { LDP_IN_CHAN_BARRIER(); (idx) = (uint8_t) (val); } while (0)
+#define LDP_IN_CHAN_STORE_INIT(idx, val)	((idx) = (uint8_t) (val))
+
+static uint8_t ldpin_chan_load_acq(const LDPInChanIdx_t *pIdx)
+{
+	uint8_t u8Val = *pIdx;
+	LDP_IN_CHAN_BARRIER();
+	return u8Val;
+}
+#endif // LDP_IN_CHAN_C11_ATOMICS
+
+uint8_t ldpin_chan_init(LDPInChan_t *pChan, uint8_t *p8Buf, uint8_t u8Size)
+{
+	// head - tail has to tell full from empty in a byte, so 128 is the most it can hold
+	if ((u8Size < 2) || (u8Size > 128) || ((u8Size & (u8Size - 1)) != 0))
+	{
+		return 0;
+	}
+
+	pChan->p8Buf = p8Buf;
+	pChan->u8Mask = (uint8_t) (u8Size - 1);
+	LDP_IN_CHAN_STORE_INIT(pChan->u8Head, 0);
+	LDP_IN_CHAN_STORE_INIT(pChan->u8Tail, 0);
+	pChan->u8Overflows = 0;
+	return 1;
+}
+
+uint8_t ldpin_chan_count(const LDPInChan_t *pChan)
+{
+	uint8_t u8Tail = LDP_IN_CHAN_LOAD_ACQ(pChan->u8Tail);
+	return (uint8_t) (LDP_IN_CHAN_LOAD_ACQ(pChan->u8Head) - u8Tail);
+}
+
+uint8_t ldpin_chan_put(LDPInChan_t *pChan, uint8_t u8Val)
+{
+	uint8_t u8Head = LDP_IN_CHAN_LOAD_OWN(pChan->u8Head);
+
+	if ((uint8_t) (u8Head - LDP_IN_CHAN_LOAD_ACQ(pChan->u8Tail)) > pChan->u8Mask)
+	{
+		if (pChan->u8Overflows != 0xFF) pChan->u8Overflows++;
+		return 0;
+	}
+
+	pChan->p8Buf[u8Head & pChan->u8Mask] = u8Val;
+	LDP_IN_CHAN_STORE_REL(pChan->u8Head, u8Head + 1);
+	return 1;
+}
+
+uint8_t ldpin_chan_put_n(LDPInChan_t *pChan, const uint8_t *p8Src, uint8_t u8Len)
+{
+	uint8_t u8Head = LDP_IN_CHAN_LOAD_OWN(pChan->u8Head);
+	uint8_t u8Free = (uint8_t) (pChan->u8Mask + 1 - (uint8_t) (u8Head - LDP_IN_CHAN_LOAD_ACQ(pChan->u8Tail)));
+	uint8_t u8Count = (u8Len < u8Free) ? u8Len : u8Free;
+	uint8_t u8Dropped = (uint8_t) (u8Len - u8Count);
+	uint8_t u;
+
+	for (u = 0; u < u8Count; u++)
+	{
+		pChan->p8Buf[(uint8_t) (u8Head + u) & pChan->u8Mask] = p8Src[u];
+	}
+	LDP_IN_CHAN_STORE_REL(pChan->u8Head, u8Head + u8Count);
+
+	for (; (u8Dropped != 0) && (pChan->u8Overflows != 0xFF); u8Dropped--)
+	{
+		pChan->u8Overflows++;
+	}
+
+	return u8Count;
+}
+
+uint8_t ldpin_chan_get(LDPInChan_t *pChan, uint8_t *pu8Val)
+{
+	uint8_t u8Tail = LDP_IN_CHAN_LOAD_OWN(pChan->u8Tail);
+
+	if (u8Tail == LDP_IN_CHAN_LOAD_ACQ(pChan->u8Head))
+	{
+		return 0;
+	}
+
+	*pu8Val = pChan->p8Buf[u8Tail & pChan->u8Mask];
+	LDP_IN_CHAN_STORE_REL(pChan->u8Tail, u8Tail + 1);
+	return 1;
+}
+
+uint8_t ldpin_chan_get_n(LDPInChan_t *pChan, uint8_t *pDst, uint8_t u8Cap)
+{
+	uint8_t u8Tail = LDP_IN_CHAN_LOAD_OWN(pChan->u8Tail);
+	uint8_t u8Count = (uint8_t) (LDP_IN_CHAN_LOAD_ACQ(pChan->u8Head) - u8Tail);
+	uint8_t u;
+
+	if (u8Count > u8Cap)
+	{
+		u8Count = u8Cap;
+	}
+
+	for (u = 0; u < u8Count; u++)
+	{
+		pDst[u] = pChan->p8Buf[(uint8_t) (u8Tail + u) & pChan->u8Mask];
+	}
+	LDP_IN_CHAN_STORE_REL(pChan->u8Tail, u8Tail + u8Count);
+
+	return u8Count;
+}
+
+const uint8_t *ldpin_chan_peek(const LDPInChan_t *pChan, uint8_t *pu8Count)
+{
+	uint8_t u8Tail = LDP_IN_CHAN_LOAD_OWN(pChan->u8Tail);
+	uint8_t u8Count = (uint8_t) (LDP_IN_CHAN_LOAD_ACQ(pChan->u8Head) - u8Tail);
+	uint8_t u8Index = u8Tail & pChan->u8Mask;
+	uint8_t u8ToEnd = (uint8_t) (pChan->u8Mask + 1 - u8Index);
+
+	// stop at the end of the buffer; the rest comes from the next peek
+	*pu8Count = (u8Count < u8ToEnd) ? u8Count : u8ToEnd;
+	return &pChan->p8Buf[u8Index];
+}
+
+void ldpin_chan_commit(LDPInChan_t *pChan, uint8_t u8Count)
+{
+	LDP_IN_CHAN_STORE_REL(pChan->u8Tail, LDP_IN_CHAN_LOAD_OWN(pChan->u8Tail) + u8Count);
+}
@@ -0,0 +1,129 @@
+#include <ldp-in/convert.h>
+
+// two packed BCD digits to binary: (hi * 10) + lo is the same as the byte minus 6 for every 16 in it
+#define BCD_BYTE(u8) ((uint8_t) ((u8) - (((u8) >> 4) * 6)))
+
+// Splits u32Val into its lower 5 decimal digits (most significant first) using reciprocal multiplies.
+static void ldpin_split5(uint32_t u32Val, uint8_t *p8Digits)
+{
+	uint16_t u16Rest;
+	uint8_t u8Hundreds, u8Lo, u8Tens;
+
+	if (u32Val > 99999)
+	{
+		u32Val %= 100000;
+	}
+
+	// x / 10000 == (x / 16) / 625, and (y * 6711) >> 22 == y / 625 for y < 6250
+	p8Digits[0] = (uint8_t) ((((uint32_t) (uint16_t) (u32Val >> 4)) * 6711) >> 22);
+
+	// the rest fits in 16 bits
+	u16Rest = (uint16_t) ((uint16_t) u32Val - (uint16_t) (p8Digits[0] * 10000U));
+
+	// (r * 5243) >> 19 == r / 100 for r < 10000
+	u8Hundreds = (uint8_t) ((((uint32_t) u16Rest) * 5243) >> 19);
+	u8Lo = (uint8_t) (u16Rest - (uint16_t) (u8Hundreds * 100));
+
+	// (r * 103) >> 10 == r / 10 for r < 100, and fits in 16 bits
+	u8Tens = (uint8_t) (((uint16_t) (u8Hundreds * 103)) >> 10);
+	p8Digits[1] = u8Tens;
+	p8Digits[2] = (uint8_t) (u8Hundreds - (u8Tens * 10));
+
+	u8Tens = (uint8_t) (((uint16_t) (u8Lo * 103)) >> 10);
+	p8Digits[3] = u8Tens;
+	p8Digits[4] = (uint8_t) (u8Lo - (u8Tens * 10));
+}
+
+void ldpin_u32_to_ascii5(uint32_t u32Val, uint8_t *p8Dst)
+{
+	ldpin_split5(u32Val, p8Dst);
+	p8Dst[0] |= 0x30;
+	p8Dst[1] |= 0x30;
+	p8Dst[2] |= 0x30;
+	p8Dst[3] |= 0x30;
+	p8Dst[4] |= 0x30;
+}
+
+void ldpin_u32_to_bcd5(uint32_t u32Val, uint8_t *p8Dst)
+{
+	uint8_t digits[5];
+	ldpin_split5(u32Val, digits);
+	p8Dst[0] = digits[0];
+	p8Dst[1] = (uint8_t) ((digits[1] << 4) | digits[2]);
+	p8Dst[2] = (uint8_t) ((digits[3] << 4) | digits[4]);
+}
+
+uint32_t ldpin_ascii5_to_u32(const char *psz)
+{
+	// the first 4 digits fit in 16 bits, where multiplying by 10 is cheap
+	uint16_t u16Val = 0;
+	uint8_t u8Count;
+
+	for (u8Count = 0; u8Count < 4; u8Count++)
+	{
+		uint8_t u8Digit = (uint8_t) (psz[u8Count] - '0');	// anything that isn't a digit wraps around to more than 9
+		if (u8Digit > 9)
+		{
+			return u16Val;
+		}
+		u16Val = (uint16_t) (u16Val * 10 + u8Digit);
+	}
+
+	// 5th digit
+	{
+		uint8_t u8Digit = (uint8_t) (psz[4] - '0');
+		if (u8Digit > 9)
+		{
+			return u16Val;
+		}
+		return ldpin_append_digit(u16Val, u8Digit);
+	}
+}
+
+uint32_t ldpin_bcd5_to_u32(uint8_t u8Hi, uint8_t u8Mid, uint8_t u8Lo)
+{
+	// at most 15 * 100 + 99, so 16 bits is plenty for the first part
+	uint16_t u16Upper = (uint16_t) ((u8Hi & 0x0F) * 100 + BCD_BYTE(u8Mid));
+	return (((uint32_t) u16Upper) * 100) + BCD_BYTE(u8Lo);
+}
+
+uint16_t ldpin_bcd3_to_u16(uint8_t u8Hi, uint8_t u8Lo)
+{
+	return (uint16_t) ((u8Hi & 0x0F) * 100 + BCD_BYTE(u8Lo));
+}
+
+uint32_t ldpin_append_digit(uint32_t u32Val, uint8_t u8Digit)
+{
+	uint32_t u32Times2 = u32Val << 1;
+	return (u32Times2 << 2) + u32Times2 + u8Digit;
+}
+
+void ldpin_frame_cache_reset(LDPInFrameCache_t *pCache)
+{
+	pCache->u8Valid = 0;
+}
+
+void ldpin_frame_cache_set(LDPInFrameCache_t *pCache, uint32_t u32Frame)
+{
+	if (pCache->u8Valid && (u32Frame == pCache->u32Frame + 1))
+	{
+		// 99999 rolls over to 00000, which is what the lower 5 digits of 100000 are anyway
+		int8_t i8Idx = 4;
+		while ((i8Idx >= 0) && (pCache->au8Ascii[i8Idx] == '9'))
+		{
+			pCache->au8Ascii[i8Idx] = '0';
+			i8Idx--;
+		}
+		if (i8Idx >= 0)
+		{
+			pCache->au8Ascii[i8Idx]++;
+		}
+	}
+	else if (!pCache->u8Valid || (u32Frame != pCache->u32Frame))
+	{
+		ldpin_u32_to_ascii5(u32Frame, pCache->au8Ascii);
+		pCache->u8Valid = 1;
+	}
+
+	pCache->u32Frame = u32Frame;
+}
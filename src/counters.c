@@ -0,0 +1,165 @@
+#include <ldp-in/counters.h>
+#include <string.h>
+
+void ldpin_counters_init(LDPInCounters_t *pCounters)
+{
+	memset(pCounters, 0, sizeof(*pCounters));
+}
+
+void ldpin_counters_reset(LDPInCounters_t *pCounters)
+{
+	uint32_t (*pfnMicros)(void *pUser) = pCounters->pfnMicros;
+	void *pMicrosUser = pCounters->pMicrosUser;
+
+	ldpin_counters_init(pCounters);
+	pCounters->pfnMicros = pfnMicros;
+	pCounters->pMicrosUser = pMicrosUser;
+}
+
+void ldpin_counters_error(LDPInCounters_t *pCounters, uint8_t u8Code)
+{
+	if (u8Code >= LDPIN_COUNTERS_MAX_ERRORS)
+	{
+		u8Code = LDPIN_COUNTERS_MAX_ERRORS - 1;
+	}
+	pCounters->au32Errors[u8Code]++;
+}
+
+static void counters_tx_level(LDPInCounters_t *pCounters, uint8_t u8Level)
+{
+	if (u8Level > pCounters->u8TxHighWater)
+	{
+		pCounters->u8TxHighWater = u8Level;
+	}
+}
+
+void ldpin_counters_tx8(LDPInCounters_t *pCounters, LDPInRing8_t *pRing, uint8_t u8Val)
+{
+	if (!ldpin_ring8_push(pRing, u8Val))
+	{
+		pCounters->u32TxOverflows++;
+	}
+	counters_tx_level(pCounters, ldpin_ring8_count(pRing));
+}
+
+void ldpin_counters_tx8_n(LDPInCounters_t *pCounters, LDPInRing8_t *pRing, const uint8_t *p8Src, uint8_t u8Len)
+{
+	pCounters->u32TxOverflows += (uint8_t) (u8Len - ldpin_ring8_push_n(pRing, p8Src, u8Len));
+	counters_tx_level(pCounters, ldpin_ring8_count(pRing));
+}
+
+void ldpin_counters_tx16(LDPInCounters_t *pCounters, LDPInRing16_t *pRing, uint16_t u16Val)
+{
+	if (!ldpin_ring16_push(pRing, u16Val))
+	{
+		pCounters->u32TxOverflows++;
+	}
+	counters_tx_level(pCounters, ldpin_ring16_count(pRing));
+}
+
+void ldpin_counters_rx(LDPInCounters_t *pCounters, uint8_t u8Level)
+{
+	if (u8Level > pCounters->u8RxHighWater)
+	{
+		pCounters->u8RxHighWater = u8Level;
+	}
+}
+
+void ldpin_counters_vblank(LDPInCounters_t *pCounters)
+{
+	pCounters->u32VBlanks++;
+}
+
+void ldpin_counters_set_clock(LDPInCounters_t *pCounters, uint32_t (*pfnMicros)(void *pUser), void *pUser)
+{
+	pCounters->pfnMicros = pfnMicros;
+	pCounters->pMicrosUser = pUser;
+
+	// a pending search's start time (if it has one) is from some other clock
+	pCounters->searchLatency.u8StartMicrosValid = 0;
+}
+
+void ldpin_counters_search_start(LDPInCounters_t *pCounters)
+{
+	LDPInLatency_t *pLat = &pCounters->searchLatency;
+
+	pCounters->u32SearchesStarted++;
+	pLat->u32StartVBlank = pCounters->u32VBlanks;
+	pLat->u8StartMicrosValid = 0;
+	if (pCounters->pfnMicros)
+	{
+		pLat->u32StartMicros = pCounters->pfnMicros(pCounters->pMicrosUser);
+		pLat->u8StartMicrosValid = 1;
+	}
+	pLat->u8Pending = 1;
+}
+
+// the histogram bucket for a latency (see LDPIN_LATENCY_BUCKETS)
+static uint8_t counters_latency_bucket(uint32_t u32Latency)
+{
+	uint8_t u8Bucket = 0;
+
+	while ((u32Latency != 0) && (u8Bucket < (LDPIN_LATENCY_BUCKETS - 1)))
+	{
+		u32Latency >>= 1;
+		u8Bucket++;
+	}
+
+	return u8Bucket;
+}
+
+static void counters_latency_add(uint16_t *pu16Hist, uint32_t u32Latency)
+{
+	uint16_t *pu16Count = &pu16Hist[counters_latency_bucket(u32Latency)];
+
+	if (*pu16Count != 0xFFFF)
+	{
+		(*pu16Count)++;
+	}
+}
+
+void ldpin_counters_search_end(LDPInCounters_t *pCounters, uint8_t u8Failed)
+{
+	LDPInLatency_t *pLat = &pCounters->searchLatency;
+
+	if (u8Failed)
+	{
+		pCounters->u32SearchesFailed++;
+	}
+	else
+	{
+		pCounters->u32SearchesCompleted++;
+	}
+
+	// a search that the interpreter didn't start (a repeated VP932 search, for example) has nothing to time
+	if (!pLat->u8Pending)
+	{
+		return;
+	}
+	pLat->u8Pending = 0;
+
+	counters_latency_add(pLat->au16VBlanks, pCounters->u32VBlanks - pLat->u32StartVBlank);
+	if (pCounters->pfnMicros && pLat->u8StartMicrosValid)
+	{
+		counters_latency_add(pLat->au16Micros, (pCounters->pfnMicros(pCounters->pMicrosUser) - pLat->u32StartMicros) >> LDPIN_LATENCY_US_SHIFT);
+	}
+	pLat->u8StartMicrosValid = 0;
+}
+
+void ldpin_latency_export(const LDPInLatency_t *pLatency, uint8_t *pDst)
+{
+	uint8_t u;
+
+	*pDst++ = LDPIN_LATENCY_EXPORT_VERSION;
+	*pDst++ = LDPIN_LATENCY_BUCKETS;
+	for (u = 0; u < LDPIN_LATENCY_BUCKETS; u++)
+	{
+		*pDst++ = (uint8_t) pLatency->au16VBlanks[u];
+		*pDst++ = (uint8_t) (pLatency->au16VBlanks[u] >> 8);
+	}
+	for (u = 0; u < LDPIN_LATENCY_BUCKETS; u++)
+	{
+		*pDst++ = (uint8_t) pLatency->au16Micros[u];
+		*pDst++ = (uint8_t) (pLatency->au16Micros[u] >> 8);
+	}
+}
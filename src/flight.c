@@ -0,0 +1,154 @@
+#include <ldp-in/flight.h>
+
+// not built when LDP_IN_FLIGHT_SIZE is 0
+
+// The interpreter (the producer) only writes the records, the head and the vblank count; the reader only writes the tail and the
+//  lost count.  A push never looks at the tail: it just overwrites the slot, and the reader works out from head - tail how much it
+//  has missed.  One slot is kept between the oldest record the reader may take and the slot being written, so a record the reader
+//  has copied is only good if the head hasn't come round to its slot by the time the copy is done.
+// On the AVR, records can come from interrupt handlers as well as the main loop and the 16-bit indices and 32-bit records aren't
+//  written in one go, so both sides briefly disable interrupts.  Elsewhere they are C11 atomics (see flight.h) and nothing locks.
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define LDP_IN_FLIGHT_LOCK()	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define LDP_IN_FLIGHT_LOCK()
+#endif
+
+#ifdef LDP_IN_FLIGHT_C11_ATOMICS
+#define LDP_IN_FLIGHT_LOAD(var, order)	atomic_load_explicit(&(var), memory_order_##order)
+#define LDP_IN_FLIGHT_STORE(var, val, order)	atomic_store_explicit(&(var), val, memory_order_##order)
+#define LDP_IN_FLIGHT_INIT_VAR(var, val)	atomic_init(&(var), val)
+#define LDP_IN_FLIGHT_FENCE(order)	atomic_thread_fence(memory_order_##order)
+#else
+// AVR (or a compiler without C11 atomics): the lock (or the single core) does the ordering, as long as the compiler keeps to it
+#if defined(__GNUC__)
+#define LDP_IN_FLIGHT_FENCE(order)	__asm__ __volatile__ ("" ::: "memory")
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LDP_IN_FLIGHT_FENCE(order)	_ReadWriteBarrier()
+#else
+#define LDP_IN_FLIGHT_FENCE(order)
+#endif
+#define LDP_IN_FLIGHT_LOAD(var, order)	(var)
+#define LDP_IN_FLIGHT_STORE(var, val, order)	((var) = (val))
+#define LDP_IN_FLIGHT_INIT_VAR(var, val)	((var) = (val))
+#endif // LDP_IN_FLIGHT_C11_ATOMICS
+
+#define LDP_IN_FLIGHT_MASK (LDP_IN_FLIGHT_SIZE - 1)
+#define LDP_IN_FLIGHT_KEEP (LDP_IN_FLIGHT_SIZE - 1)	// records the reader can still get (see above)
+
+void ldpin_flight_reset(LDPInFlight_t *pFlight)
+{
+	uint8_t u;
+
+	LDP_IN_FLIGHT_LOCK()
+	{
+		for (u = 0; u < LDP_IN_FLIGHT_SIZE; u++)
+		{
+			LDP_IN_FLIGHT_INIT_VAR(pFlight->au32Recs[u], 0);
+		}
+		LDP_IN_FLIGHT_INIT_VAR(pFlight->u16Head, 0);
+		LDP_IN_FLIGHT_INIT_VAR(pFlight->u16Tail, 0);
+		pFlight->u16VBlank = 0;
+		pFlight->u16Lost = 0;
+	}
+}
+
+void ldpin_flight_push(LDPInFlight_t *pFlight, uint8_t u8Event, uint8_t u8Val)
+{
+	LDP_IN_FLIGHT_LOCK()
+	{
+		uint16_t u16Head = LDP_IN_FLIGHT_LOAD(pFlight->u16Head, relaxed);
+		uint32_t u32Rec = (uint32_t) u8Event | ((uint32_t) u8Val << 8) | ((uint32_t) pFlight->u16VBlank << 16);
+
+		// keeps the last push's head store ahead of this record's store, so a reader that sees this record also sees that head
+		LDP_IN_FLIGHT_FENCE(release);
+		LDP_IN_FLIGHT_STORE(pFlight->au32Recs[u16Head & LDP_IN_FLIGHT_MASK], u32Rec, relaxed);
+		LDP_IN_FLIGHT_STORE(pFlight->u16Head, (uint16_t) (u16Head + 1), release);
+	}
+}
+
+void ldpin_flight_vblank(LDPInFlight_t *pFlight)
+{
+	LDP_IN_FLIGHT_LOCK()
+	{
+		pFlight->u16VBlank++;
+	}
+}
+
+// counts what the interpreter has overwritten since the reader last looked, and moves the reader past it
+static uint16_t ldpin_flight_catch_up(LDPInFlight_t *pFlight, uint16_t u16Head, uint16_t u16Tail)
+{
+	uint16_t u16Behind = (uint16_t) (u16Head - u16Tail);
+
+	if (u16Behind > LDP_IN_FLIGHT_KEEP)
+	{
+		uint32_t u32Lost = (uint32_t) pFlight->u16Lost + (uint16_t) (u16Behind - LDP_IN_FLIGHT_KEEP);
+		pFlight->u16Lost = (u32Lost > 0xFFFF) ? 0xFFFF : (uint16_t) u32Lost;
+		u16Tail = (uint16_t) (u16Head - LDP_IN_FLIGHT_KEEP);
+	}
+	return u16Tail;
+}
+
+uint8_t ldpin_flight_read(LDPInFlight_t *pFlight, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
+{
+	uint8_t u8Read = 0;
+
+	// one record at a time, so that interrupts are never held off for long
+	while (u8Read < u8Cap)
+	{
+		uint8_t u8Got = 0;
+		uint8_t u8Empty = 0;
+
+		LDP_IN_FLIGHT_LOCK()
+		{
+			uint16_t u16Head = LDP_IN_FLIGHT_LOAD(pFlight->u16Head, acquire);
+			uint16_t u16Tail = ldpin_flight_catch_up(pFlight, u16Head, LDP_IN_FLIGHT_LOAD(pFlight->u16Tail, relaxed));
+
+			if (u16Tail == u16Head)
+			{
+				u8Empty = 1;
+			}
+			else
+			{
+				uint32_t u32Rec = LDP_IN_FLIGHT_LOAD(pFlight->au32Recs[u16Tail & LDP_IN_FLIGHT_MASK], relaxed);
+
+				// if the interpreter has got round to this slot since, the copy may be of the newer record: go round again
+				LDP_IN_FLIGHT_FENCE(acquire);
+				u16Head = LDP_IN_FLIGHT_LOAD(pFlight->u16Head, relaxed);
+				if ((uint16_t) (u16Head - u16Tail) <= LDP_IN_FLIGHT_KEEP)
+				{
+					pDst[u8Read].u8Event = (uint8_t) u32Rec;
+					pDst[u8Read].u8Val = (uint8_t) (u32Rec >> 8);
+					pDst[u8Read].u16VBlank = (uint16_t) (u32Rec >> 16);
+					u16Tail++;
+					u8Got = 1;
+				}
+			}
+			LDP_IN_FLIGHT_STORE(pFlight->u16Tail, u16Tail, relaxed);
+		}
+
+		if (u8Empty)
+		{
+			break;
+		}
+		u8Read = (uint8_t) (u8Read + u8Got);
+	}
+
+	return u8Read;
+}
+
+uint16_t ldpin_flight_lost(LDPInFlight_t *pFlight)
+{
+	uint16_t u16Lost;
+
+	LDP_IN_FLIGHT_LOCK()
+	{
+		uint16_t u16Head = LDP_IN_FLIGHT_LOAD(pFlight->u16Head, acquire);
+		LDP_IN_FLIGHT_STORE(pFlight->u16Tail, ldpin_flight_catch_up(pFlight, u16Head, LDP_IN_FLIGHT_LOAD(pFlight->u16Tail, relaxed)), relaxed);
+		u16Lost = pFlight->u16Lost;
+	}
+
+	return u16Lost;
+}
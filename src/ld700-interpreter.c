@@ -1,4 +1,8 @@
 #include <ldp-in/ld700-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
+#include <string.h>	// memset
 
 /*
  * NOTES about how the real LD-700 behaves that we may or may not include in this interpreter.
@@ -14,6 +18,7 @@
  * - If a pause command is sent while the disc is spinning up, it is ignored and the disc plays once spin-up finishes.
  */
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // callbacks, must be assigned before calling any other function in this interpreter
 void (*g_ld700i_play)() = 0;
 void (*g_ld700i_pause)() = 0;
@@ -29,183 +34,289 @@ void (*g_ld700i_on_ext_ack_changed)(LD700_BOOL bActive) = 0;
 
 /////////////////////////
 
-// so we can decode incoming commands properly
-typedef enum
+// the default context forwards to the global callbacks above
+static void ld700i_global_play(void *pUser) { (void) pUser; g_ld700i_play(); }
+static void ld700i_global_pause(void *pUser) { (void) pUser; g_ld700i_pause(); }
+static void ld700i_global_stop(void *pUser) { (void) pUser; g_ld700i_stop(); }
+static void ld700i_global_eject(void *pUser) { (void) pUser; g_ld700i_eject(); }
+static void ld700i_global_step(void *pUser, LD700_BOOL bBackward) { (void) pUser; g_ld700i_step(bBackward); }
+static void ld700i_global_begin_search(void *pUser, uint32_t uFrameNumber) { (void) pUser; g_ld700i_begin_search(uFrameNumber); }
+static void ld700i_global_change_audio(void *pUser, LD700_BOOL bEnableLeft, LD700_BOOL bEnableRight) { (void) pUser; g_ld700i_change_audio(bEnableLeft, bEnableRight); }
+static void ld700i_global_change_audio_squelch(void *pUser, LD700_BOOL bSquelched) { (void) pUser; g_ld700i_change_audio_squelch(bSquelched); }
+static uint32_t ld700i_global_get_current_picnum(void *pUser) { (void) pUser; return g_ld700i_get_current_picnum(); }
+static void ld700i_global_on_ext_ack_changed(void *pUser, LD700_BOOL bActive) { (void) pUser; g_ld700i_on_ext_ack_changed(bActive); }
+static void ld700i_global_error(void *pUser, LD700ErrCode_t code, uint8_t u8Val) { (void) pUser; g_ld700i_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static LD700Ctx_t g_ld700i_ctx =
 {
-	LD700I_CMD_PREFIX,
-	LD700I_CMD_PREFIX_XOR,
-	LD700I_CMD,
-	LD700I_CMD_XOR,
-} LD700CmdState_t;
+	{ LD700I_CMD_PREFIX },	// everything else is zero until reset
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		ld700i_global_play,
+		ld700i_global_pause,
+		ld700i_global_stop,
+		ld700i_global_eject,
+		ld700i_global_step,
+		ld700i_global_begin_search,
+		ld700i_global_change_audio,
+		ld700i_global_change_audio_squelch,
+		ld700i_global_get_current_picnum,
+		ld700i_global_on_ext_ack_changed,
+		ld700i_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the ld700i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define LD700I_CB_FUNC(pCtx, name)	ld700i_host_##name
+#else
+#define LD700I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define LD700I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_LD700, LD700Callbacks_t, name, LD700I_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define LD700I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_LD700, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_LD700, code), LD700I_CB(pCtx, error)((pCtx)->pUser, code, val))
+
+// state machine moves go through here so that the flight recorder sees them
+#define LD700I_SET_STATE(pCtx, s)	((pCtx)->state.state = (s), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_STATE, LDPIN_TRACE_LD700, s))
+
+#define NUM_BUF_WRAP(idx) 	if (idx >= LD700_NUMBUFSIZE) idx = 0;
 
-LD700CmdState_t g_ld700i_cmd_state = LD700I_CMD_PREFIX;
+//////////////////////////////////////////////
 
-typedef enum
+void ld700i_ctx_init(LD700Ctx_t *pCtx, const LD700Callbacks_t *pCallbacks, void *pUser)
 {
-	LD700I_STATE_NORMAL,
-	LD700I_STATE_FRAME	// in the middle of receiving a frame number
-} LD700State_t;
-
-LD700State_t g_ld700i_state;
-uint8_t g_ld700i_numBuf[5];	// the number buffer can wraparound to the beginning of it gets too many digits
-uint8_t *g_ld700i_pNumBufStart = 0;
-uint8_t *g_ld700i_pNumBufEnd = 0;
-const uint8_t *g_ld700i_pNumBufLastGoodPtr = (g_ld700i_numBuf + sizeof(g_ld700i_numBuf) - 1);
-uint8_t g_ld700i_u8NumBufCount = 0;	// this shows how many bytes are in the number buffer
-#define NUM_BUF_WRAP(var) 	if (var > g_ld700i_pNumBufLastGoodPtr) var = g_ld700i_numBuf;
-
-uint8_t g_ld700i_u8CmdTimeoutVsyncCounter;	// to detect duplicate commands to be dropped
-LD700_BOOL g_ld700i_bNewCmdReceived;	// whether we've received a new command (as opposed to a dupe)
-LD700_BOOL g_ld700i_bExtAckActive;
-LD700_BOOL g_ld700i_bNumBufResetArmed;	// whether we will clear the num buf if any digit is received
-uint8_t g_ld700i_u8QueuedCmd;
-uint8_t g_ld700i_u8LastCmd;	// to drop rapidly repeated commands
-LD700_BOOL g_ld700i_bEscapedActive;	// whether we are in the middle of an escaped command
+	memset(&pCtx->state, 0, sizeof(pCtx->state));
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
 
-//////////////////////////////////////////////
+void ld700i_ctx_save(const LD700Ctx_t *pCtx, LD700Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_LD700, LD700_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
+
+LD700_BOOL ld700i_ctx_restore(LD700Ctx_t *pCtx, const LD700Snapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_LD700, LD700_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return LD700_FALSE;
+	}
+
+	// the number buffer positions are used as indices without any further checks
+	if ((pSnap->state.u8NumBufStart >= LD700_NUMBUFSIZE) || (pSnap->state.u8NumBufEnd >= LD700_NUMBUFSIZE) ||
+		(pSnap->state.u8NumBufCount > LD700_NUMBUFSIZE))
+	{
+		return LD700_FALSE;
+	}
+
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return LD700_TRUE;
+}
+
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t ld700i_ctx_flight_read(LD700Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
+{
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
+}
+#endif
 
 // call every time you want EXT_ACK' to be a certain value.  The method will track if it's changed and trigger the callback if needed.
-void ld700i_change_ext_ack(LD700_BOOL bActive)
+void ld700i_change_ext_ack(LD700Ctx_t *pCtx, LD700_BOOL bActive)
 {
 	// callback gets called every time this value changes
-	if (g_ld700i_bExtAckActive != bActive)
+	if (pCtx->state.bExtAckActive != bActive)
 	{
-		g_ld700i_on_ext_ack_changed(bActive);
-		g_ld700i_bExtAckActive = bActive;
+		LD700I_CB(pCtx, on_ext_ack_changed)(pCtx->pUser, bActive);
+		pCtx->state.bExtAckActive = bActive;
+		LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_EXT_ACK, LDPIN_TRACE_LD700, bActive);
 	}
 }
 
-void ld700i_reset()
+void ld700i_ctx_reset(LD700Ctx_t *pCtx)
 {
-	g_ld700i_pNumBufStart = g_ld700i_numBuf;
-	g_ld700i_pNumBufEnd = g_ld700i_numBuf;
-	g_ld700i_u8NumBufCount = 0;
-	g_ld700i_u8CmdTimeoutVsyncCounter = 0;
-	g_ld700i_bNewCmdReceived = LD700_FALSE;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_LD700, 0);
+	pCtx->state.u8NumBufStart = 0;
+	pCtx->state.u8NumBufEnd = 0;
+	pCtx->state.u8NumBufCount = 0;
+	pCtx->state.u8CmdTimeoutVsyncCounter = 0;
+	pCtx->state.bNewCmdReceived = LD700_FALSE;
 
 	// force callback to be called so our implementor will be in the proper initial state
-	g_ld700i_bExtAckActive = LD700_TRUE;
-	ld700i_change_ext_ack(LD700_FALSE);
-
-	g_ld700i_bNumBufResetArmed = LD700_FALSE;
-	g_ld700i_cmd_state = LD700I_CMD_PREFIX;
-	g_ld700i_u8QueuedCmd = 0;	// apparently is not needed
-	g_ld700i_u8LastCmd = 0xFF;
-	g_ld700i_state = LD700I_STATE_NORMAL;
-	g_ld700i_bEscapedActive = LD700_FALSE;
+	pCtx->state.bExtAckActive = LD700_TRUE;
+	ld700i_change_ext_ack(pCtx, LD700_FALSE);
+
+	pCtx->state.bNumBufResetArmed = LD700_FALSE;
+	pCtx->state.cmd_state = LD700I_CMD_PREFIX;
+	pCtx->state.u8QueuedCmd = 0;	// apparently is not needed
+	pCtx->state.u8LastCmd = 0xFF;
+	LD700I_SET_STATE(pCtx, LD700I_STATE_NORMAL);
+	pCtx->state.bEscapedActive = LD700_FALSE;
 }
 
-void ld700i_add_digit(uint8_t u8Digit)
+void ld700i_add_digit(LD700Ctx_t *pCtx, uint8_t u8Digit)
 {
 	// the player will remember the previous frame and will only erase it once a digit is entered.
-	if (g_ld700i_bNumBufResetArmed)
+	if (pCtx->state.bNumBufResetArmed)
 	{
 		// erase anything that was in the buffer
-		g_ld700i_pNumBufStart = g_ld700i_pNumBufEnd;
-		g_ld700i_u8NumBufCount = 0;
-		g_ld700i_bNumBufResetArmed = LD700_FALSE;
+		pCtx->state.u8NumBufStart = pCtx->state.u8NumBufEnd;
+		pCtx->state.u8NumBufCount = 0;
+		pCtx->state.bNumBufResetArmed = LD700_FALSE;
 	}
 
-	*g_ld700i_pNumBufEnd = u8Digit;
-	g_ld700i_pNumBufEnd++;
-	NUM_BUF_WRAP(g_ld700i_pNumBufEnd);
-	g_ld700i_u8NumBufCount++;
+	pCtx->state.numBuf[pCtx->state.u8NumBufEnd] = u8Digit;
+	pCtx->state.u8NumBufEnd++;
+	NUM_BUF_WRAP(pCtx->state.u8NumBufEnd);
+	pCtx->state.u8NumBufCount++;
 
 	// if they enter too many digits, we start dropping digits from the beginning
-	if (g_ld700i_u8NumBufCount > 5)
+	if (pCtx->state.u8NumBufCount > 5)
 	{
-		g_ld700i_pNumBufStart++;
-		NUM_BUF_WRAP(g_ld700i_pNumBufStart);
-		g_ld700i_u8NumBufCount = 5;
+		pCtx->state.u8NumBufStart++;
+		NUM_BUF_WRAP(pCtx->state.u8NumBufStart);
+		pCtx->state.u8NumBufCount = 5;
 	}
 }
 
-void ld700i_cmd_error(uint8_t u8Cmd)
+void ld700i_cmd_error(LD700Ctx_t *pCtx, uint8_t u8Cmd)
 {
-	g_ld700i_error(LD700_ERR_UNKNOWN_CMD_BYTE, u8Cmd);
-	g_ld700i_cmd_state = LD700I_CMD_PREFIX;
+	LD700I_ERROR(pCtx, LD700_ERR_UNKNOWN_CMD_BYTE, u8Cmd);
+	pCtx->state.cmd_state = LD700I_CMD_PREFIX;
 }
 
-void ld700i_clear()
+void ld700i_clear(LD700Ctx_t *pCtx)
 {
-	g_ld700i_bEscapedActive = LD700_FALSE;
+	pCtx->state.bEscapedActive = LD700_FALSE;
 
-	if (g_ld700i_state == LD700I_STATE_FRAME)
+	if (pCtx->state.state == LD700I_STATE_FRAME)
 	{
 		// if user has started entering in a number, we clear it but stay in 'retrieve number' mode
-		if (g_ld700i_u8NumBufCount != 0)
+		if (pCtx->state.u8NumBufCount != 0)
 		{
-			g_ld700i_pNumBufStart = g_ld700i_pNumBufEnd;
-			g_ld700i_u8NumBufCount = 0;
+			pCtx->state.u8NumBufStart = pCtx->state.u8NumBufEnd;
+			pCtx->state.u8NumBufCount = 0;
 		}
 		// else we leave 'entering in a number' mode
 		else
 		{
-			g_ld700i_state = LD700I_STATE_NORMAL;
+			LD700I_SET_STATE(pCtx, LD700I_STATE_NORMAL);
 		}
 	}
 	// else nothing to clear
 }
 
-void ld700i_on_new_cmd()
+void ld700i_ctx_on_new_cmd(LD700Ctx_t *pCtx)
 {
-	g_ld700i_cmd_state = LD700I_CMD_PREFIX;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_NEW_CMD, LDPIN_TRACE_LD700, 0);
+	pCtx->state.cmd_state = LD700I_CMD_PREFIX;
 }
 
 // 0 means something else so we need another distinct value to indicate no change
 #define NO_CHANGE 0xFF
 
-void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t ld700i_cmd_class(uint8_t u8Cmd, LD700_BOOL bEscaped)
 {
+	if (bEscaped)
+	{
+		return ((u8Cmd >= 0x02) && (u8Cmd <= 0x07)) ? LDPIN_CMD_AV : LDPIN_CMD_OTHER;
+	}
+
+	switch (u8Cmd)
+	{
+	case 0x0: case 0x1: case 0x2: case 0x3: case 0x4:
+	case 0x5: case 0x6: case 0x7: case 0x8: case 0x9:
+		return LDPIN_CMD_DIGIT;
+	case 0x16: case 0x17: case 0x18: case 0x50: case 0x54:
+		return LDPIN_CMD_PLAY;
+	case 0x41: case 0x42:
+		return LDPIN_CMD_SEARCH;
+	case 0x49: case 0x4A: case 0x4B:
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
+}
+#endif // LDP_IN_COUNTERS
+
+void ld700i_ctx_write(LD700Ctx_t *pCtx, uint8_t u8Cmd, const LD700Status_t status)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_LD700, u8Cmd | ((uint32_t) status << 8));
+	LDPIN_COUNT(pCtx, u32BytesIn);
+
 	uint8_t u8NewCmdTimeoutVsyncCounter = 4;	// default value
 
-	switch (g_ld700i_cmd_state)
+	switch (pCtx->state.cmd_state)
 	{
 	case LD700I_CMD_PREFIX:
-		if (u8Cmd == 0xA8) g_ld700i_cmd_state++;
-		else ld700i_cmd_error(u8Cmd);
+		if (u8Cmd == 0xA8) pCtx->state.cmd_state++;
+		else ld700i_cmd_error(pCtx, u8Cmd);
 		break;
 	case LD700I_CMD_PREFIX_XOR:
-		if (u8Cmd == 0x57) g_ld700i_cmd_state++;
-		else ld700i_cmd_error(u8Cmd);
+		if (u8Cmd == 0x57) pCtx->state.cmd_state++;
+		else ld700i_cmd_error(pCtx, u8Cmd);
 		break;
 	case LD700I_CMD:
-		g_ld700i_u8QueuedCmd = u8Cmd;
-		g_ld700i_cmd_state++;
+		pCtx->state.u8QueuedCmd = u8Cmd;
+		pCtx->state.cmd_state++;
 		break;
 	default:	// LD700I_CMD_XOR
-		g_ld700i_cmd_state = LD700I_CMD_PREFIX;
-		if (u8Cmd != (g_ld700i_u8QueuedCmd ^ 0xFF))
+		pCtx->state.cmd_state = LD700I_CMD_PREFIX;
+		if (u8Cmd != (pCtx->state.u8QueuedCmd ^ 0xFF))
 		{
-			ld700i_cmd_error(u8Cmd);
+			ld700i_cmd_error(pCtx, u8Cmd);
 			return;
 		}
 		break;
 	}
 
-	if (g_ld700i_cmd_state != LD700I_CMD_PREFIX)
+	if (pCtx->state.cmd_state != LD700I_CMD_PREFIX)
 	{
 		// if new commands come in while our cmd timeout counter is not 0, then we need to hold EXT_ACK' active to properly detect a held remote control button
-		if (g_ld700i_u8CmdTimeoutVsyncCounter != 0) goto done;
+		if (pCtx->state.u8CmdTimeoutVsyncCounter != 0) goto done;
 		return;
 	}
 
 	// rapidly repeated commands are dropped
 	// (a human pressing keys on a remote control will cause commands to rapidly repeat)
-	if ((g_ld700i_u8QueuedCmd == g_ld700i_u8LastCmd) && (g_ld700i_u8CmdTimeoutVsyncCounter != 0))
+	if ((pCtx->state.u8QueuedCmd == pCtx->state.u8LastCmd) && (pCtx->state.u8CmdTimeoutVsyncCounter != 0))
 	{
 		goto done;
 	}
 
-	g_ld700i_bNewCmdReceived = LD700_TRUE;
+	pCtx->state.bNewCmdReceived = LD700_TRUE;
+	LDPIN_COUNT_CMD(pCtx, ld700i_cmd_class(pCtx->state.u8QueuedCmd, pCtx->state.bEscapedActive));
 
 	// if we're receiving a normal command
-	if (!g_ld700i_bEscapedActive)
+	if (!pCtx->state.bEscapedActive)
 	{
-		switch (g_ld700i_u8QueuedCmd)
+		switch (pCtx->state.u8QueuedCmd)
 		{
 		default:	// unknown
-			g_ld700i_error(LD700_ERR_UNKNOWN_CMD_BYTE, g_ld700i_u8QueuedCmd);
+			LD700I_ERROR(pCtx, LD700_ERR_UNKNOWN_CMD_BYTE, pCtx->state.u8QueuedCmd);
 			break;
 		case 0x0:	// 0
 		case 0x1:
@@ -220,7 +331,7 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			// digits are ignored if disc is stopped
 			if (status != LD700_STOPPED)
 			{
-				ld700i_add_digit(g_ld700i_u8QueuedCmd);
+				ld700i_add_digit(pCtx, pCtx->state.u8QueuedCmd);
 			}
 			else
 			{
@@ -230,11 +341,11 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 		case 0x16: // reject
 			if ((status == LD700_PLAYING) || (status == LD700_PAUSED))
 			{
-				g_ld700i_stop();
+				LD700I_CB(pCtx, stop)(pCtx->pUser);
 			}
 			else if (status == LD700_STOPPED)
 			{
-				g_ld700i_eject();
+				LD700I_CB(pCtx, eject)(pCtx->pUser);
 			}
 			else if (status == LD700_TRAY_EJECTED)
 			{
@@ -242,12 +353,12 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			}
 			else
 			{
-				g_ld700i_error(LD700_ERR_UNHANDLED_SITUATION, status);
+				LD700I_ERROR(pCtx, LD700_ERR_UNHANDLED_SITUATION, status);
 			}
 			u8NewCmdTimeoutVsyncCounter = NO_CHANGE;	// I've never seen this command respond with an ACK
 			break;
 		case 0x17:	// play
-			g_ld700i_play();
+			LD700I_CB(pCtx, play)(pCtx->pUser);
 			break;
 		case 0x18:	// pause
 			// If disc is already paused, a pause command will cause the screen to go blank briefly.
@@ -255,12 +366,13 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			// We simulate this by doing a search to the frame that we're already on.
 			if (status == LD700_PAUSED)
 			{
-				uint32_t u32Frame = g_ld700i_get_current_picnum();
-				g_ld700i_begin_search(u32Frame);
+				uint32_t u32Frame = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LD700, LD700I_CB(pCtx, get_current_picnum)(pCtx->pUser));
+				LD700I_CB(pCtx, begin_search)(pCtx->pUser, u32Frame);
+				LDPIN_COUNT_SEARCH_START(pCtx);
 			}
 			else
 			{
-				g_ld700i_pause();
+				LD700I_CB(pCtx, pause)(pCtx->pUser);
 			}
 			break;
 		case 0x41:	// prepare to enter frame number
@@ -268,11 +380,11 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			// frame number entry is ignored if disc is stopped
 			if (status != LD700_STOPPED)
 			{
-				g_ld700i_state = LD700I_STATE_FRAME;
+				LD700I_SET_STATE(pCtx, LD700I_STATE_FRAME);
 
 				// The player will remember the previous frame, but will erase it if a digit is entered.
 				// This means 0x41 0x42 will seek to the previous frame.
-				g_ld700i_bNumBufResetArmed = LD700_TRUE;
+				pCtx->state.bNumBufResetArmed = LD700_TRUE;
 			}
 			else
 			{
@@ -281,22 +393,22 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			break;
 		case 0x42:	// begin search
 		{
-			if ((g_ld700i_state == LD700I_STATE_FRAME) && (status != LD700_STOPPED))
+			if ((pCtx->state.state == LD700I_STATE_FRAME) && (status != LD700_STOPPED))
 			{
 				uint32_t u32Frame = 0;
-				uint8_t *bufStartTmp = g_ld700i_pNumBufStart;
-				uint8_t u8NumBufCountTmp = g_ld700i_u8NumBufCount;
+				uint8_t u8BufStartTmp = pCtx->state.u8NumBufStart;
+				uint8_t u8NumBufCountTmp = pCtx->state.u8NumBufCount;
 				while (u8NumBufCountTmp != 0)
 				{
-					uint8_t u8 = *bufStartTmp;
-					u32Frame *= 10;
-					u32Frame += u8;
-					bufStartTmp++;
-					NUM_BUF_WRAP(bufStartTmp);
+					uint8_t u8 = pCtx->state.numBuf[u8BufStartTmp];
+					u32Frame = ldpin_append_digit(u32Frame, u8);
+					u8BufStartTmp++;
+					NUM_BUF_WRAP(u8BufStartTmp);
 					u8NumBufCountTmp--;
 				}
-				g_ld700i_state = LD700I_STATE_NORMAL;
-				g_ld700i_begin_search(u32Frame);
+				LD700I_SET_STATE(pCtx, LD700I_STATE_NORMAL);
+				LD700I_CB(pCtx, begin_search)(pCtx->pUser, u32Frame);
+				LDPIN_COUNT_SEARCH_START(pCtx);
 			}
 			// the original player does not ACK if not in 'enter number' mode or if disc is stopped
 			else
@@ -306,10 +418,10 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 		}
 			break;
 		case 0x45:	// clear
-			ld700i_clear();
+			ld700i_clear(pCtx);
 			break;
 		case 0x49:	// enable right
-			g_ld700i_change_audio(LD700_FALSE, LD700_TRUE);
+			LD700I_CB(pCtx, change_audio)(pCtx->pUser, LD700_FALSE, LD700_TRUE);
 			break;
 		case 0x4A:	// enable stereo
 			if (status == LD700_TRAY_EJECTED)
@@ -317,19 +429,19 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 				u8NewCmdTimeoutVsyncCounter = NO_CHANGE;
 			}
 
-			g_ld700i_change_audio(LD700_TRUE, LD700_TRUE);
+			LD700I_CB(pCtx, change_audio)(pCtx->pUser, LD700_TRUE, LD700_TRUE);
 			break;
 		case 0x4B:	// enable left
-			g_ld700i_change_audio(LD700_TRUE, LD700_FALSE);
+			LD700I_CB(pCtx, change_audio)(pCtx->pUser, LD700_TRUE, LD700_FALSE);
 			break;
 		case 0x50:	// step reverse
-			g_ld700i_step(LD700_TRUE);
+			LD700I_CB(pCtx, step)(pCtx->pUser, LD700_TRUE);
 			break;
 		case 0x54:	// step fwd
-			g_ld700i_step(LD700_FALSE);
+			LD700I_CB(pCtx, step)(pCtx->pUser, LD700_FALSE);
 			break;
 		case 0x5F:	// escape
-			g_ld700i_bEscapedActive = LD700_TRUE;
+			pCtx->state.bEscapedActive = LD700_TRUE;
 			u8NewCmdTimeoutVsyncCounter = NO_CHANGE;
 			break;
 		}
@@ -338,12 +450,12 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 	else
 	{
 		// in most cases, after we process an escape command, we'll start processing normal commands again
-		g_ld700i_bEscapedActive = LD700_FALSE;
+		pCtx->state.bEscapedActive = LD700_FALSE;
 
-		switch (g_ld700i_u8QueuedCmd)
+		switch (pCtx->state.u8QueuedCmd)
 		{
 		default:	// unknown
-			g_ld700i_error(LD700_ERR_UNKNOWN_CMD_BYTE, g_ld700i_u8QueuedCmd);
+			LD700I_ERROR(pCtx, LD700_ERR_UNKNOWN_CMD_BYTE, pCtx->state.u8QueuedCmd);
 			break;
 		case 0x02:	// disable video
 		case 0x03:	// enable video
@@ -352,40 +464,44 @@ void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
 			// not supported, but we will control EXT_ACK'
 			break;
 		case 0x04:	// disable audio
-			g_ld700i_change_audio_squelch(LD700_TRUE);
+			LD700I_CB(pCtx, change_audio_squelch)(pCtx->pUser, LD700_TRUE);
 			break;
 		case 0x05:	// enable audio
-			g_ld700i_change_audio_squelch(LD700_FALSE);
+			LD700I_CB(pCtx, change_audio_squelch)(pCtx->pUser, LD700_FALSE);
 			break;
 		case 0x45:	// clear
-			ld700i_clear();
+			ld700i_clear(pCtx);
 			break;
 		case 0x5F:	// repeated escapes are ignored (confirmed on real hardware)
 			u8NewCmdTimeoutVsyncCounter = NO_CHANGE;	// observed on real hardware, escapes by themselves do not cause ACK'
-			g_ld700i_bEscapedActive = LD700_TRUE;
+			pCtx->state.bEscapedActive = LD700_TRUE;
 			break;
 		}
 	}
 
 	// to detect duplicates
-	g_ld700i_u8LastCmd = g_ld700i_u8QueuedCmd;
+	pCtx->state.u8LastCmd = pCtx->state.u8QueuedCmd;
 
 done:
 	// if this value has been set, then we replace the global value
 	if (u8NewCmdTimeoutVsyncCounter != NO_CHANGE)
 	{
-		g_ld700i_u8CmdTimeoutVsyncCounter = u8NewCmdTimeoutVsyncCounter;
+		pCtx->state.u8CmdTimeoutVsyncCounter = u8NewCmdTimeoutVsyncCounter;
 	}
 }
 
-void ld700i_on_vblank(const LD700Status_t stat)
+void ld700i_ctx_on_vblank(LD700Ctx_t *pCtx, const LD700Status_t stat)
 {
-	LD700_BOOL bExtAckEnabled = (g_ld700i_u8CmdTimeoutVsyncCounter != 0);
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_LD700, stat);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+
+	LD700_BOOL bExtAckEnabled = (pCtx->state.u8CmdTimeoutVsyncCounter != 0);
 
 	// when new command comes in, EXT_ACK' pulses high for 1 vsync (overriding other behavior)
-	if (g_ld700i_bNewCmdReceived)
+	if (pCtx->state.bNewCmdReceived)
 	{
-		g_ld700i_bNewCmdReceived = LD700_FALSE;
+		pCtx->state.bNewCmdReceived = LD700_FALSE;
 		bExtAckEnabled = LD700_FALSE;
 	}
 
@@ -393,10 +509,37 @@ void ld700i_on_vblank(const LD700Status_t stat)
 	bExtAckEnabled |= ((stat == LD700_SEARCHING) || (stat == LD700_SPINNING_UP));
 
 	// EXT_ACK' is active after a command has been received or if the disc is searching/spinning-up
-	ld700i_change_ext_ack(bExtAckEnabled);
+	ld700i_change_ext_ack(pCtx, bExtAckEnabled);
 
-	if (g_ld700i_u8CmdTimeoutVsyncCounter != 0)
+	if (pCtx->state.u8CmdTimeoutVsyncCounter != 0)
 	{
-		g_ld700i_u8CmdTimeoutVsyncCounter--;
+		pCtx->state.u8CmdTimeoutVsyncCounter--;
 	}
 }
+
+//////////////////////////////////////////////
+
+void ld700i_reset()
+{
+	ld700i_ctx_reset(&g_ld700i_ctx);
+}
+
+void ld700i_on_new_cmd()
+{
+	ld700i_ctx_on_new_cmd(&g_ld700i_ctx);
+}
+
+void ld700i_write(uint8_t u8Cmd, const LD700Status_t status)
+{
+	ld700i_ctx_write(&g_ld700i_ctx, u8Cmd, status);
+}
+
+void ld700i_on_vblank(const LD700Status_t stat)
+{
+	ld700i_ctx_on_vblank(&g_ld700i_ctx, stat);
+}
+
+LD700Ctx_t *ld700i_get_default_ctx()
+{
+	return &g_ld700i_ctx;
+}
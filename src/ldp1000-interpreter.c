@@ -1,4 +1,7 @@
 #include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
 #include <string.h>
 #include <assert.h>
 
@@ -6,10 +9,11 @@
 
 // private methods:
 
-void ldp1000i_repeat_play();
+void ldp1000i_repeat_play(LDP1000Ctx_t *pCtx);
 
 //////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 void (*g_ldp1000i_play)(uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched) = 0;
@@ -28,71 +32,83 @@ void (*g_ldp1000i_text_buffer_contents_changed)(const uint8_t *p8Buf32Bytes) = 0
 void (*g_ldp1000i_text_buffer_start_index_changed)(uint8_t u8StartIdx) = 0;
 void (*g_ldp1000i_text_modes_changed)(uint8_t u8Mode, uint8_t u8X, uint8_t u8Y) = 0;
 
-void (*g_ldp1000i_add_latency)(LDP1000Latency_t latency) = 0;
 void (*g_ldp1000i_error)(LDP1000ErrCode_t code, uint8_t u8Val) = 0;
 
-/////////////////////////////////
-
-// so we know what to do when we get an ENTER command
-typedef enum
+// the default context forwards to the global callbacks above
+static void ldp1000i_global_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched) { (void) pUser; g_ldp1000i_play(u8Numerator, u8Denominator, bBackward, bAudioSquelched); }
+static void ldp1000i_global_pause(void *pUser) { (void) pUser; g_ldp1000i_pause(); }
+static void ldp1000i_global_begin_search(void *pUser, uint32_t u32FrameNum) { (void) pUser; g_ldp1000i_begin_search(u32FrameNum); }
+static void ldp1000i_global_step_forward(void *pUser) { (void) pUser; g_ldp1000i_step_forward(); }
+static void ldp1000i_global_step_reverse(void *pUser) { (void) pUser; g_ldp1000i_step_reverse(); }
+static void ldp1000i_global_skip(void *pUser, int16_t i16TracksToSkip) { (void) pUser; g_ldp1000i_skip(i16TracksToSkip); }
+static void ldp1000i_global_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { (void) pUser; g_ldp1000i_change_audio(u8Channel, uEnable); }
+static void ldp1000i_global_change_video(void *pUser, LDP1000_BOOL bEnable) { (void) pUser; g_ldp1000i_change_video(bEnable); }
+static LDP1000Status_t ldp1000i_global_get_status(void *pUser) { (void) pUser; return g_ldp1000i_get_status(); }
+static uint32_t ldp1000i_global_get_cur_frame_num(void *pUser) { (void) pUser; return g_ldp1000i_get_cur_frame_num(); }
+static void ldp1000i_global_text_enable_changed(void *pUser, LDP1000_BOOL bEnabled) { (void) pUser; g_ldp1000i_text_enable_changed(bEnabled); }
+static void ldp1000i_global_text_buffer_contents_changed(void *pUser, const uint8_t *p8Buf32Bytes) { (void) pUser; g_ldp1000i_text_buffer_contents_changed(p8Buf32Bytes); }
+static void ldp1000i_global_text_buffer_start_index_changed(void *pUser, uint8_t u8StartIdx) { (void) pUser; g_ldp1000i_text_buffer_start_index_changed(u8StartIdx); }
+static void ldp1000i_global_text_modes_changed(void *pUser, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y) { (void) pUser; g_ldp1000i_text_modes_changed(u8Mode, u8X, u8Y); }
+static void ldp1000i_global_error(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val) { (void) pUser; g_ldp1000i_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static LDP1000Ctx_t g_ldp1000i_ctx =
 {
-	LDP1000I_STATE_NORMAL,
-	LDP1000I_STATE_WAIT_SEARCH,	// in the middle of a search command
-	LDP1000I_STATE_REPEAT0_WAIT_END_FRAME,		// repeat command received, waiting for end frame number
-	LDP1000I_STATE_REPEAT1_WAIT_COUNT,		// repeat end of frame number received, waiting for iteration count
-    LDP1000I_STATE_WAIT_VARIABLE_SPEED, // in the middle of a variable speed play command
-	LDP1000I_STATE_SKIP_FORWARD,	// in the middle of skip forward command
-	LDP1000I_STATE_SKIP_BACKWARD,	// in the middle of skip backward command
-} LDP1000State_t;
-
-LDP1000_EmulationType_t g_ldp1000i_type = (LDP1000_EmulationType_t) 0;
-
-LDP1000State_t g_ldp1000i_state = LDP1000I_STATE_NORMAL;
-
-// these are 16-bit values so that one byte can hold latency information
-uint16_t g_ldp1000i_tx_buf[12];	// this should be small enough so as to not waste space but big enough to hold things like current frame number
-uint16_t *g_ldp1000i_pTxBufStart = 0;
-uint16_t *g_ldp1000i_pTxBufEnd = 0;
-const uint16_t *g_ldp1000i_pTxBufLastGoodPtr = (g_ldp1000i_tx_buf + (sizeof(g_ldp1000i_tx_buf)/sizeof(uint16_t)) - 1);
-uint8_t g_ldp1000i_u8TxBufCount = 0;	// how many bytes are in the tx buffer
-
-#define LDP1000I_TX_WRAP(var) 	if (var > g_ldp1000i_pTxBufLastGoodPtr) var = g_ldp1000i_tx_buf;
-
-// current frame entered in for stuff like searching, repeating, etc
-uint32_t g_ldp1000i_u32Frame = 0;
-
-// which digit we are entering (imagine we are entering into an array)
-uint8_t g_ldp1000i_u8FrameIdx = 0;
-
-// general purpose index (u8FrameIdx may be merged into this)
-uint8_t g_ldp1000i_u8Idx = 0;
-
-// which direction to go for variable speed play, repeat, etc
-LDP1000_BOOL g_ldp1000i_directionIsReversed = LDP1000_FALSE;
-
-// whether disc is in the middle of a search
-LDP1000_BOOL g_ldp1000i_bSearchActive = LDP1000_FALSE;
-
-// repeat state
-LDP1000_BOOL g_ldp1000i_bRepeatActive = LDP1000_FALSE;
-uint32_t g_ldp1000i_u32RepeatStartFrame = 0;
-uint32_t g_ldp1000i_u32RepeatEndFrame = 0;
-uint8_t g_ldp1000i_u8RepeatIterations = 0;
+	{ (LDP1000_EmulationType_t) 0 },	// everything else is zero until reset
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		ldp1000i_global_play,
+		ldp1000i_global_pause,
+		ldp1000i_global_begin_search,
+		ldp1000i_global_step_forward,
+		ldp1000i_global_step_reverse,
+		ldp1000i_global_skip,
+		ldp1000i_global_change_audio,
+		ldp1000i_global_change_video,
+		ldp1000i_global_get_status,
+		ldp1000i_global_get_cur_frame_num,
+		ldp1000i_global_text_enable_changed,
+		ldp1000i_global_text_buffer_contents_changed,
+		ldp1000i_global_text_buffer_start_index_changed,
+		ldp1000i_global_text_modes_changed,
+		ldp1000i_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the ldp1000i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define LDP1000I_CB_FUNC(pCtx, name)	ldp1000i_host_##name
+#else
+#define LDP1000I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define LDP1000I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_LDP1000, LDP1000Callbacks_t, name, LDP1000I_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define LDP1000I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_LDP1000, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_LDP1000, code), LDP1000I_CB(pCtx, error)((pCtx)->pUser, code, val))
+
+// state machine moves go through here so that the flight recorder sees them
+#define LDP1000I_SET_STATE(pCtx, s)	((pCtx)->state.state = (s), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_STATE, LDPIN_TRACE_LDP1000, s))
 
-LDP1000_BOOL g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;
-uint8_t g_ldp1000i_u8UICFunction = 0;	// which UIC function is active (u8Idx must be >0 for this value to mean something)
-uint8_t g_ldp1000i_u8UIC_X = 0, g_ldp1000i_u8UIC_Y = 0, g_ldp1000i_u8UIC_Mode = 0;
-uint8_t g_ldp1000i_u8UIC_Window = 0;
-LDP1000_BOOL g_ldp1000i_bUI_Enabled = LDP1000_FALSE;
-uint8_t g_ldp1000i_u8UIC_StartIdx = 0;
-uint8_t g_ldp1000i_UIC_TextBuf[32] = { 0 };
+/////////////////////////////////
 
-uint8_t g_ldp1000i_u8UIC_PendingNotifications = 0;
 #define LDP1000I_UIC_NOTIFY_MODES (1 << 0)
 #define LDP1000I_UIC_NOTIFY_WINDOW (1 << 1)
 #define LDP1000I_UIC_NOTIFY_BUFFER (1 << 2)
 
-#define LDP1000I_RESET_FRAME()	g_ldp1000i_u32Frame = 0; g_ldp1000i_u8FrameIdx = 0
+#define LDP1000I_RESET_FRAME(pCtx)	(pCtx)->state.u32Frame = 0; (pCtx)->state.u8FrameIdx = 0
 
 // since we will be making these calculations a lot
 #define LATVAL_CLEAR	(LDP1000_LATENCY_CLEAR << 8)
@@ -114,119 +130,172 @@ uint8_t g_ldp1000i_u8UIC_PendingNotifications = 0;
 
 //////////////////////////////////
 
-void ldp1000i_reset(LDP1000_EmulationType_t type)
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t ldp1000i_cmd_class(uint8_t u8Byte)
 {
-	g_ldp1000i_state = LDP1000I_STATE_NORMAL;
-	g_ldp1000i_pTxBufStart = g_ldp1000i_pTxBufEnd = g_ldp1000i_tx_buf;
-	g_ldp1000i_type = type;
-	g_ldp1000i_u32Frame = 0;
-	g_ldp1000i_u8FrameIdx = 0;
-	g_ldp1000i_u8Idx = 0;
-	g_ldp1000i_bSearchActive = LDP1000_FALSE;
-	g_ldp1000i_bRepeatActive = LDP1000_FALSE;
-	g_ldp1000i_u32RepeatStartFrame = 0;
-	g_ldp1000i_u32RepeatEndFrame = 0;
-	g_ldp1000i_u8RepeatIterations = 0;
-	g_ldp1000i_directionIsReversed = LDP1000_FALSE;
-	g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;
-	g_ldp1000i_u8UICFunction = 0;
-	g_ldp1000i_u8UIC_X = 0xFF;	// so that we will send out a notification if value is set to 0
-	g_ldp1000i_u8UIC_Y = 0xFF;	// " " "
-	g_ldp1000i_u8UIC_Mode = 0xFF;	// " " "
-	g_ldp1000i_u8UIC_Window = 0xFF;	// so that we will send out a notification if the window is set to 0
-	g_ldp1000i_bUI_Enabled = LDP1000_FALSE;
-	g_ldp1000i_u8UIC_StartIdx = 0;
-	memset(g_ldp1000i_UIC_TextBuf, 0, sizeof(g_ldp1000i_UIC_TextBuf));
-	g_ldp1000i_u8UIC_PendingNotifications = 0;
+	switch (u8Byte)
+	{
+	case 0x30: case 0x31: case 0x32: case 0x33: case 0x34:
+	case 0x35: case 0x36: case 0x37: case 0x38: case 0x39:
+		return LDPIN_CMD_DIGIT;
+	case 0x2B: case 0x2C: case 0x2D: case 0x2E:
+	case 0x3A: case 0x3B: case 0x3C: case 0x3D: case 0x3F:
+	case 0x4A: case 0x4B: case 0x4C: case 0x4D: case 0x4F:
+		return LDPIN_CMD_PLAY;
+	case 0x43: case 0x44:
+		return LDPIN_CMD_SEARCH;
+	case 0x60: case 0x67:
+		return LDPIN_CMD_INQUIRY;
+	case 0x24: case 0x25: case 0x26: case 0x27:
+	case 0x46: case 0x47: case 0x48: case 0x49:
+	case 0x50: case 0x51: case 0x80: case 0x81: case 0x82:
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
 }
+#endif // LDP_IN_COUNTERS
 
-void ldp1000i_push_queue(uint16_t u16Val)
+void ldp1000i_ctx_init(LDP1000Ctx_t *pCtx, const LDP1000Callbacks_t *pCallbacks, void *pUser)
 {
-	*g_ldp1000i_pTxBufEnd = u16Val;
-	g_ldp1000i_pTxBufEnd++;
-	LDP1000I_TX_WRAP(g_ldp1000i_pTxBufEnd);
-	g_ldp1000i_u8TxBufCount++;
+	memset(&pCtx->state, 0, sizeof(pCtx->state));
+	ldpin_ring16_reset(&pCtx->state.tx);
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
 
-	// we should never get close to this
-//	assert(g_ldp1000i_u8TxBufCount < sizeof(g_ldp1000i_tx_buf));
+void ldp1000i_ctx_save(const LDP1000Ctx_t *pCtx, LDP1000Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_LDP1000, LDP1000_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
 }
 
-uint16_t ldp1000i_pop_queue()
+LDP1000_BOOL ldp1000i_ctx_restore(LDP1000Ctx_t *pCtx, const LDP1000Snapshot_t *pSnap)
 {
-	uint16_t u16Res = *g_ldp1000i_pTxBufStart;
-	g_ldp1000i_pTxBufStart++;
-	LDP1000I_TX_WRAP(g_ldp1000i_pTxBufStart);
-	g_ldp1000i_u8TxBufCount--;
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_LDP1000, LDP1000_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return LDP1000_FALSE;
+	}
 
-	// sanity check
-//	assert(g_ldp1000i_u8TxBufCount != -1);
+	// u8UIC_StartIdx indexes the text buffer without any further checks (u8Idx only counts bytes, so any value is fine)
+	if ((pSnap->state.u8UIC_StartIdx >= sizeof(pSnap->state.UIC_TextBuf)) || (ldpin_ring16_count(&pSnap->state.tx) > LDP_IN_RING_SIZE))
+	{
+		return LDP1000_FALSE;
+	}
 
-	return u16Res;
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return LDP1000_TRUE;
 }
 
-void ldp1000i_add_digit(uint8_t u8Digit)
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t ldp1000i_ctx_flight_read(LDP1000Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
 {
-	if (g_ldp1000i_u8FrameIdx < 5)
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
+}
+#endif
+
+void ldp1000i_ctx_reset(LDP1000Ctx_t *pCtx, LDP1000_EmulationType_t type)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_LDP1000, type);
+	LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_NORMAL);
+	ldpin_ring16_reset(&pCtx->state.tx);
+	pCtx->state.type = type;
+	pCtx->state.u32Frame = 0;
+	pCtx->state.u8FrameIdx = 0;
+	pCtx->state.u8Idx = 0;
+	pCtx->state.bSearchActive = LDP1000_FALSE;
+	pCtx->state.bRepeatActive = LDP1000_FALSE;
+	pCtx->state.u32RepeatStartFrame = 0;
+	pCtx->state.u32RepeatEndFrame = 0;
+	pCtx->state.u8RepeatIterations = 0;
+	pCtx->state.directionIsReversed = LDP1000_FALSE;
+	pCtx->state.UIC_Input_Active = LDP1000_FALSE;
+	pCtx->state.u8UICFunction = 0;
+	pCtx->state.u8UIC_X = 0xFF;	// so that we will send out a notification if value is set to 0
+	pCtx->state.u8UIC_Y = 0xFF;	// " " "
+	pCtx->state.u8UIC_Mode = 0xFF;	// " " "
+	pCtx->state.u8UIC_Window = 0xFF;	// so that we will send out a notification if the window is set to 0
+	pCtx->state.bUI_Enabled = LDP1000_FALSE;
+	pCtx->state.u8UIC_StartIdx = 0;
+	memset(pCtx->state.UIC_TextBuf, 0, sizeof(pCtx->state.UIC_TextBuf));
+	pCtx->state.u8UIC_PendingNotifications = 0;
+	ldpin_frame_cache_reset(&pCtx->state.frameCache);
+}
+
+void ldp1000i_add_digit(LDP1000Ctx_t *pCtx, uint8_t u8Digit)
+{
+	if (pCtx->state.u8FrameIdx < 5)
 	{
 		uint8_t u8Tmp = u8Digit & 0xF;
-		g_ldp1000i_u32Frame *= 10;
-		g_ldp1000i_u32Frame += u8Tmp;
-		g_ldp1000i_u8FrameIdx++;
-		ldp1000i_push_queue(LATACK_NUMBER);
+		pCtx->state.u32Frame = ldpin_append_digit(pCtx->state.u32Frame, u8Tmp);
+		pCtx->state.u8FrameIdx++;
+		LDPIN_TX16_PUSH(pCtx, LATACK_NUMBER);
 	}
 
 	// TODO : test this on a real player to see what it does
 	// (WDO 7/16: a real 1450 uses the last 5 digits entered)
 	else
 	{
-		g_ldp1000i_error(LDP1000_ERR_TOO_MANY_DIGITS, 0);
-		ldp1000i_push_queue(LATVAL_NUMBER | 0xB);
+		LDP1000I_ERROR(pCtx, LDP1000_ERR_TOO_MANY_DIGITS, 0);
+		LDPIN_TX16_PUSH(pCtx, LATVAL_NUMBER | 0xB);
 	}
 }
 
-void ldp1000i_write(uint8_t u8Byte)
+void ldp1000i_ctx_write(LDP1000Ctx_t *pCtx, uint8_t u8Byte)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_LDP1000, u8Byte);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+
 	// if we not in UIC mode, then process incoming bytes normally
-	if (!g_ldp1000i_UIC_Input_Active)
+	if (!pCtx->state.UIC_Input_Active)
 	{
+		LDPIN_COUNT_CMD(pCtx, ldp1000i_cmd_class(u8Byte));
+
 		switch (u8Byte)
 		{
 		case 0x26:	// video off (mute video output)
-			g_ldp1000i_change_video(LDP1000_FALSE);
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDP1000I_CB(pCtx, change_video)(pCtx->pUser, LDP1000_FALSE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 		case 0x27:	// video on
-			g_ldp1000i_change_video(LDP1000_TRUE);
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDP1000I_CB(pCtx, change_video)(pCtx->pUser, LDP1000_TRUE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 		case 0x2D:	// skip forward
-			g_ldp1000i_state = LDP1000I_STATE_SKIP_FORWARD;
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_ENTER);	// this is a guess
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_SKIP_FORWARD);
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);	// this is a guess
 
 			// disc becomes paused as soon as this command is received (this is a guess, the disc arrives at its destination paused, so this is a decent place to put the pause)
-			g_ldp1000i_pause();
+			LDP1000I_CB(pCtx, pause)(pCtx->pUser);
 
 			break;
 		case 0x2E:	// skip backward
-			g_ldp1000i_state = LDP1000I_STATE_SKIP_BACKWARD;
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_ENTER);	// this is a guess
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_SKIP_BACKWARD);
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);	// this is a guess
 
 			// disc becomes paused as soon as this command is received (this is a guess, the disc arrives at its destination paused, so this is a decent place to put the pause)
-			g_ldp1000i_pause();
+			LDP1000I_CB(pCtx, pause)(pCtx->pUser);
 
 			break;
 
 		// TO-DO: step/forward reverse is only honored once per vsync (or per frame?)
 		//        additional steps are ignored (but ACK is still returned)
 		case 0x2B:	// step forward
-			g_ldp1000i_step_forward();
-			ldp1000i_push_queue(LATACK_STILL);
+			LDP1000I_CB(pCtx, step_forward)(pCtx->pUser);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);
 			break;
 		case 0x2C:	// step rev
-			g_ldp1000i_step_reverse();
-			ldp1000i_push_queue(LATACK_STILL);
+			LDP1000I_CB(pCtx, step_reverse)(pCtx->pUser);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);
 			break;
 		case 0x30:
 		case 0x31:
@@ -238,221 +307,218 @@ void ldp1000i_write(uint8_t u8Byte)
 		case 0x37:
 		case 0x38:
 		case 0x39:
-			ldp1000i_add_digit(u8Byte);
+			ldp1000i_add_digit(pCtx, u8Byte);
 			break;
 		case 0x3A:	// play forward at 1X
-			g_ldp1000i_play(1, 1, LDP1000_FALSE, LDP1000_FALSE);
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 1, LDP1000_FALSE, LDP1000_FALSE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x3B:	// play forward at 3X
-			g_ldp1000i_play(3, 1, LDP1000_FALSE, LDP1000_TRUE);
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 3, 1, LDP1000_FALSE, LDP1000_TRUE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x3C:	// play forward at 1/5X
-			g_ldp1000i_play(1, 5, LDP1000_FALSE, LDP1000_TRUE);
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 5, LDP1000_FALSE, LDP1000_TRUE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x3D:	// variable speed forward play
-			g_ldp1000i_state = LDP1000I_STATE_WAIT_VARIABLE_SPEED;
-			g_ldp1000i_directionIsReversed = LDP1000_FALSE;
-			LDP1000I_RESET_FRAME(); // use the frame # buffer for the speed
-			ldp1000i_push_queue(LATACK_GENERIC); // not documented
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_WAIT_VARIABLE_SPEED);
+			pCtx->state.directionIsReversed = LDP1000_FALSE;
+			LDP1000I_RESET_FRAME(pCtx); // use the frame # buffer for the speed
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC); // not documented
 
 			// for some reason, this command will cause the disc to play forward at 1/7X (confirmed on real hardware, but not documented)
-			g_ldp1000i_play(1, 7, LDP1000_FALSE, LDP1000_TRUE);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 7, LDP1000_FALSE, LDP1000_TRUE);
 			break;
 		case 0x3F:	// stop
-			ldp1000i_push_queue(LATACK_PLAY);	// same as play for stop
-			g_ldp1000i_error(LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);	// no point in implementing stop command because no game is going to use it
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);	// same as play for stop
+			LDP1000I_ERROR(pCtx, LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);	// no point in implementing stop command because no game is going to use it
 			break;
 		case 0x40:	// enter
-			switch (g_ldp1000i_state)
+			switch (pCtx->state.state)
 			{
 			case LDP1000I_STATE_WAIT_SEARCH:
-				g_ldp1000i_begin_search(g_ldp1000i_u32Frame);
-				g_ldp1000i_bSearchActive = LDP1000_TRUE;
-				g_ldp1000i_state = LDP1000I_STATE_NORMAL;	// done with search command
-				ldp1000i_push_queue(LATACK_ENTER);
+				LDP1000I_CB(pCtx, begin_search)(pCtx->pUser, pCtx->state.u32Frame);
+				LDPIN_COUNT_SEARCH_START(pCtx);
+				pCtx->state.bSearchActive = LDP1000_TRUE;
+				LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_NORMAL);	// done with search command
+				LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
 				break;
 				// if we have just received the end frame to loop to
 			case LDP1000I_STATE_REPEAT0_WAIT_END_FRAME:
-				g_ldp1000i_u32RepeatEndFrame = g_ldp1000i_u32Frame;
+				pCtx->state.u32RepeatEndFrame = pCtx->state.u32Frame;
 
 				// Set playback direction.
 				// If dest frame is ahead of current frame, we will play forward.
-				if (g_ldp1000i_u32RepeatEndFrame >= g_ldp1000i_u32RepeatStartFrame)
+				if (pCtx->state.u32RepeatEndFrame >= pCtx->state.u32RepeatStartFrame)
 				{
-					g_ldp1000i_directionIsReversed = LDP1000_FALSE;
+					pCtx->state.directionIsReversed = LDP1000_FALSE;
 				}
 				// Else we will play in reverse.
 				else
 				{
-					g_ldp1000i_directionIsReversed = LDP1000_TRUE;
+					pCtx->state.directionIsReversed = LDP1000_TRUE;
 				}
 
-				LDP1000I_RESET_FRAME();
-				g_ldp1000i_state = LDP1000I_STATE_REPEAT1_WAIT_COUNT;
-				ldp1000i_push_queue(LATACK_ENTER);
+				LDP1000I_RESET_FRAME(pCtx);
+				LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_REPEAT1_WAIT_COUNT);
+				LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
 
 				break;
 				// if we have received the number of loop iterations to perform
 			case LDP1000I_STATE_REPEAT1_WAIT_COUNT:
 
 				// if they specify repeat iterations, then make use of what they specified
-				if (g_ldp1000i_u8FrameIdx != 0)
+				if (pCtx->state.u8FrameIdx != 0)
 				{
-					g_ldp1000i_u8RepeatIterations = g_ldp1000i_u32Frame;
+					pCtx->state.u8RepeatIterations = pCtx->state.u32Frame;
 				}
 				// else 1 is implied if they don't provide an iteration count
 				else
 				{
-					g_ldp1000i_u8RepeatIterations = 1;
+					pCtx->state.u8RepeatIterations = 1;
 				}
 
-				ldp1000i_push_queue(LATACK_ENTER);
+				LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
 
-				ldp1000i_repeat_play();
+				ldp1000i_repeat_play(pCtx);
 
-				g_ldp1000i_bRepeatActive = LDP1000_TRUE;
+				pCtx->state.bRepeatActive = LDP1000_TRUE;
 
 				break;
             case LDP1000I_STATE_WAIT_VARIABLE_SPEED:
 			    // TO-DO: use only the last three digits entered
-				if (g_ldp1000i_u32Frame == 0)
+				if (pCtx->state.u32Frame == 0)
 				{
-			    	g_ldp1000i_pause();
-		        	ldp1000i_push_queue(LATACK_ENTER);
+			    	LDP1000I_CB(pCtx, pause)(pCtx->pUser);
+		        	LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
                 }
-			    else if (g_ldp1000i_u32Frame <= 255)
+			    else if (pCtx->state.u32Frame <= 255)
 				{
 					// audio always squelched for multispeed playbacvk
-				    g_ldp1000i_play(1, g_ldp1000i_u32Frame, g_ldp1000i_directionIsReversed, LDP1000_TRUE);
-		    	    ldp1000i_push_queue(LATACK_ENTER);
+				    LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, pCtx->state.u32Frame, pCtx->state.directionIsReversed, LDP1000_TRUE);
+		    	    LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
 				}
 				else
 				{
-				    ldp1000i_push_queue(LATNAK_GENERIC);
+				    LDPIN_TX16_PUSH(pCtx, LATNAK_GENERIC);
 				}
-				g_ldp1000i_state = LDP1000I_STATE_NORMAL;
+				LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_NORMAL);
 				break;
 			case LDP1000I_STATE_SKIP_FORWARD:
-				g_ldp1000i_skip(((int16_t) g_ldp1000i_u32Frame));
-				ldp1000i_push_queue(LATACK_ENTER);
-				ldp1000i_push_queue(LATVAL_GENERIC | 1);	// skip complete result code
+				LDP1000I_CB(pCtx, skip)(pCtx->pUser, ((int16_t) pCtx->state.u32Frame));
+				LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | 1);	// skip complete result code
 				break;
 			case LDP1000I_STATE_SKIP_BACKWARD:
-				g_ldp1000i_skip(-((int16_t) g_ldp1000i_u32Frame));
-				ldp1000i_push_queue(LATACK_ENTER);
-				ldp1000i_push_queue(LATVAL_GENERIC | 1);	// skip complete result code
+				LDP1000I_CB(pCtx, skip)(pCtx->pUser, -((int16_t) pCtx->state.u32Frame));
+				LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | 1);	// skip complete result code
 				break;
 			default:
-				g_ldp1000i_error(LDP1000_ERR_UNKNOWN_CMD_BYTE, u8Byte);
+				LDP1000I_ERROR(pCtx, LDP1000_ERR_UNKNOWN_CMD_BYTE, u8Byte);
 				break;
 			}
 			break;
 		case 0x41:	// clear entry
-			g_ldp1000i_state = LDP1000I_STATE_NORMAL;
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_GENERIC);	// latency is undocumented
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_NORMAL);
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);	// latency is undocumented
 			break;
 		case 0x43:	// begin search
-			g_ldp1000i_state = LDP1000I_STATE_WAIT_SEARCH;
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_ENTER);	// search latency the same as enter
-			g_ldp1000i_bRepeatActive = LDP1000_FALSE;	// search command cancels repeat (confirmed on real hardware)
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_WAIT_SEARCH);
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_ENTER);	// search latency the same as enter
+			pCtx->state.bRepeatActive = LDP1000_FALSE;	// search command cancels repeat (confirmed on real hardware)
 
 			// disc becomes paused as soon as search command is received
-			g_ldp1000i_pause();
+			LDP1000I_CB(pCtx, pause)(pCtx->pUser);
 
 			break;
 		case 0x44:	// begin repeat
-			g_ldp1000i_state = LDP1000I_STATE_REPEAT0_WAIT_END_FRAME;
-			g_ldp1000i_u32RepeatStartFrame = g_ldp1000i_get_cur_frame_num();
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_REPEAT0_WAIT_END_FRAME);
+			pCtx->state.u32RepeatStartFrame = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDP1000, LDP1000I_CB(pCtx, get_cur_frame_num)(pCtx->pUser));
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 
 			// disc becomes paused as soon as repeat command is received
-			g_ldp1000i_pause();
+			LDP1000I_CB(pCtx, pause)(pCtx->pUser);
 
 			break;
 		case 0x46:	// enable left audio
-			g_ldp1000i_change_audio(0, 1);
-			ldp1000i_push_queue(LATACK_STILL);	// same as still
+			LDP1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);	// same as still
 			break;
 		case 0x47:	// disable left audio
-			g_ldp1000i_change_audio(0, 0);
-			ldp1000i_push_queue(LATACK_STILL);	// same as still
+			LDP1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);	// same as still
 			break;
 		case 0x48:	// enable right audio
-			g_ldp1000i_change_audio(1, 1);
-			ldp1000i_push_queue(LATACK_STILL);	// same as still
+			LDP1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);	// same as still
 			break;
 		case 0x49:	// disable right audio
-			g_ldp1000i_change_audio(1, 0);
-			ldp1000i_push_queue(LATACK_STILL);	// same as still
+			LDP1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);	// same as still
 			break;
 		case 0x4A:	// play reverse at 1X
-			g_ldp1000i_play(1, 1, LDP1000_TRUE, LDP1000_TRUE);	// audio squelched for reverse
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 1, LDP1000_TRUE, LDP1000_TRUE);	// audio squelched for reverse
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x4B:	// play reverse at 3X
-			g_ldp1000i_play(3, 1, LDP1000_TRUE, LDP1000_TRUE);
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 3, 1, LDP1000_TRUE, LDP1000_TRUE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x4C:	// play reverse at 1/5X
-			g_ldp1000i_play(1, 5, LDP1000_TRUE, LDP1000_TRUE);
-			ldp1000i_push_queue(LATACK_PLAY);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 5, LDP1000_TRUE, LDP1000_TRUE);
+			LDPIN_TX16_PUSH(pCtx, LATACK_PLAY);
 			break;
 		case 0x4D:	// variable speed reverse play
-			g_ldp1000i_state = LDP1000I_STATE_WAIT_VARIABLE_SPEED;
-			g_ldp1000i_directionIsReversed = LDP1000_TRUE;
-			LDP1000I_RESET_FRAME(); // use the frame # buffer for the speed
-			ldp1000i_push_queue(LATACK_GENERIC); // not documented
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_WAIT_VARIABLE_SPEED);
+			pCtx->state.directionIsReversed = LDP1000_TRUE;
+			LDP1000I_RESET_FRAME(pCtx); // use the frame # buffer for the speed
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC); // not documented
 
 			// for some reason, this command will cause the disc to play at 1/7X (confirmed on real hardware, but not documented)
-			g_ldp1000i_play(1, 7, LDP1000_TRUE, LDP1000_TRUE);
+			LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 7, LDP1000_TRUE, LDP1000_TRUE);
 			break;
 		case 0x4F:	// pause
-			g_ldp1000i_pause();
-			ldp1000i_push_queue(LATACK_STILL);
+			LDP1000I_CB(pCtx, pause)(pCtx->pUser);
+			LDPIN_TX16_PUSH(pCtx, LATACK_STILL);
 			break;
 		case 0x56:	// clear all
-			g_ldp1000i_state = LDP1000I_STATE_NORMAL;
-			LDP1000I_RESET_FRAME();
-			ldp1000i_push_queue(LATACK_CLEAR);
+			LDP1000I_SET_STATE(pCtx, LDP1000I_STATE_NORMAL);
+			LDP1000I_RESET_FRAME(pCtx);
+			LDPIN_TX16_PUSH(pCtx, LATACK_CLEAR);
 			break;
 		case 0x60:	// ADDR INQ (get current frame number)
 			{
 				// According to LDP-1000A, the 5 bytes returned are set when the frame number is read from VBI.
 				// If the VBI contains no frame number or is corrupt, the last good frame number is retained.
 
-				// This is unfortunately a very expensive operation.  I've optimized it as best as I can.
-				uint8_t arr[4];
-				uint32_t u32FrameNum = g_ldp1000i_get_cur_frame_num();
-				arr[3] = (u32FrameNum % 10) | 0x30;
-				u32FrameNum /= 10;
-				arr[2] = (u32FrameNum % 10) | 0x30;
-				u32FrameNum /= 10;
-				arr[1] = (u32FrameNum % 10) | 0x30;
-				u32FrameNum /= 10;
-				arr[0] = (u32FrameNum % 10) | 0x30;
-				u32FrameNum /= 10;
-				ldp1000i_push_queue(LATVAL_GENERIC | (u32FrameNum | 0x30));	// u32FrameNum will hold the last digit so no need to store it to an array
-				ldp1000i_push_queue(LATVAL_INQUIRY | arr[0]);
-				ldp1000i_push_queue(LATVAL_INQUIRY | arr[1]);
-				ldp1000i_push_queue(LATVAL_INQUIRY | arr[2]);
-				ldp1000i_push_queue(LATVAL_INQUIRY | arr[3]);
+				uint8_t buf[5];
+				const uint8_t *arr = pCtx->state.frameCache.au8Ascii;
+				if (!pCtx->state.frameCache.u8Valid)
+				{
+					ldpin_u32_to_ascii5(LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDP1000, LDP1000I_CB(pCtx, get_cur_frame_num)(pCtx->pUser)), buf);
+					arr = buf;
+				}
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | arr[0]);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | arr[1]);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | arr[2]);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | arr[3]);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | arr[4]);
 			}
 			break;
 		case 0x62:	// motor on
 			// On the ldp-1450, I have personally verified that if the motor is already on, it will return a NAK (0xB).
 			// As of right now, we do not support turning off the motor, so we assume the motor is always on.
-			ldp1000i_push_queue(LATNAK_GENERIC);
+			LDPIN_TX16_PUSH(pCtx, LATNAK_GENERIC);
 			break;
 		case 0x67:	// status inquiry
 
 			// if it's a 1450
-			if (g_ldp1000i_type == LDP1000_EMU_LDP1450)
+			if (pCtx->state.type == LDP1000_EMU_LDP1450)
 			{
 				// Bits in status, 1 condition is described
 				//
@@ -473,21 +539,21 @@ void ldp1000i_write(uint8_t u8Byte)
 				// Number input flag: set when waiting for numerical input in SEARCH, REPEAT, and MARK-SET modes
 
 				uint8_t u8 = 0x80;
-				LDP1000Status_t stat = g_ldp1000i_get_status();
+				LDP1000Status_t stat = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDP1000, LDP1000I_CB(pCtx, get_status)(pCtx->pUser));
 				if (stat == LDP1000_SEARCHING)
 				{
 					u8 |= 0x40;
 				}
-				ldp1000i_push_queue(LATVAL_GENERIC | u8);
-				ldp1000i_push_queue(LATVAL_INQUIRY | 0);
-				ldp1000i_push_queue(LATVAL_INQUIRY | 0x10);	// 0x10 means a 12" disc is inserted (apparently)
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | u8);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | 0);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | 0x10);	// 0x10 means a 12" disc is inserted (apparently)
 
 				u8 = 0;
-				if (g_ldp1000i_state == LDP1000I_STATE_WAIT_SEARCH)
+				if (pCtx->state.state == LDP1000I_STATE_WAIT_SEARCH)
 				{
 					u8 |= 3;	// bit 0 means we are accepting digits as input, bit 1 means we are in the middle of a search command
 				}
-				ldp1000i_push_queue(LATVAL_INQUIRY | u8);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | u8);
 
 				// if playing, the returned status is 1
 				if (stat == LDP1000_PLAYING)
@@ -506,7 +572,7 @@ void ldp1000i_write(uint8_t u8Byte)
 					// 0x20 means disc is paused (still frame)
 					u8 = 0x20;
 				}
-				ldp1000i_push_queue(LATVAL_INQUIRY | u8);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_INQUIRY | u8);
 
 				// "ANY" also provided this tip, apparently it was once in the MAME source code and I don't know where it came from.
 				// I am putting it here to refer to later but I don't know how accurate it is.  It seems at least somewhat consistent with what I got from DL2 source code.
@@ -558,40 +624,40 @@ void ldp1000i_write(uint8_t u8Byte)
 			// else it's a 1000A and the results are totally different
 			else
 			{
-				g_ldp1000i_error(LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
+				LDP1000I_ERROR(pCtx, LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
 			}
 			break;
 
 		case 0x80:	// User Index Control (sets the user index)
-			g_ldp1000i_UIC_Input_Active = LDP1000_TRUE;
-			g_ldp1000i_u8Idx = 0;	// prepare to receive UIC function code
-			g_ldp1000i_u8UIC_PendingNotifications = 0;	// clear out any notifications
-			ldp1000i_push_queue(LATACK_GENERIC);
+			pCtx->state.UIC_Input_Active = LDP1000_TRUE;
+			pCtx->state.u8Idx = 0;	// prepare to receive UIC function code
+			pCtx->state.u8UIC_PendingNotifications = 0;	// clear out any notifications
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 			
 		case 0x81:	// User Index on
-			if (g_ldp1000i_bUI_Enabled == LDP1000_FALSE)
+			if (pCtx->state.bUI_Enabled == LDP1000_FALSE)
 			{
-				g_ldp1000i_bUI_Enabled = LDP1000_TRUE;
-				g_ldp1000i_text_enable_changed(LDP1000_TRUE);
+				pCtx->state.bUI_Enabled = LDP1000_TRUE;
+				LDP1000I_CB(pCtx, text_enable_changed)(pCtx->pUser, LDP1000_TRUE);
 			}
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 			
 		case 0x82:	// User Index off
-			if (g_ldp1000i_bUI_Enabled == LDP1000_TRUE)
+			if (pCtx->state.bUI_Enabled == LDP1000_TRUE)
 			{
-				g_ldp1000i_bUI_Enabled = LDP1000_FALSE;
-				g_ldp1000i_text_enable_changed(LDP1000_FALSE);
+				pCtx->state.bUI_Enabled = LDP1000_FALSE;
+				LDP1000I_CB(pCtx, text_enable_changed)(pCtx->pUser, LDP1000_FALSE);
 			}
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 			
 			// STUBS which we should implement if something is using them (return ACK but don't do anything)
 		case 0x24:	// audio off (mute)
 		case 0x25:	// audio on (unmute)
-			g_ldp1000i_error(LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDP1000I_ERROR(pCtx, LDP1000_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 
 			// STUBS (return ACK but don't do anything)
@@ -602,12 +668,12 @@ void ldp1000i_write(uint8_t u8Byte)
 		case 0x55:	// frame mode
 		case 0x6E:	// CX on
 		case 0x6F:	// CX off
-			ldp1000i_push_queue(LATACK_GENERIC);
+			LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			break;
 
 		default:
-			g_ldp1000i_error(LDP1000_ERR_UNKNOWN_CMD_BYTE, u8Byte);
-			ldp1000i_push_queue(LATNAK_GENERIC);
+			LDP1000I_ERROR(pCtx, LDP1000_ERR_UNKNOWN_CMD_BYTE, u8Byte);
+			LDPIN_TX16_PUSH(pCtx, LATNAK_GENERIC);
 			break;
 		}
 	} // end if we are not in UIC state
@@ -616,191 +682,232 @@ void ldp1000i_write(uint8_t u8Byte)
 	else
 	{
 		// if we are receiving the UIC function
-		if (g_ldp1000i_u8Idx == 0)
+		if (pCtx->state.u8Idx == 0)
 		{
 			// range check
 			if (u8Byte <= 2)
 			{
-				g_ldp1000i_u8UICFunction = u8Byte;
-				ldp1000i_push_queue(LATACK_GENERIC);
+				pCtx->state.u8UICFunction = u8Byte;
+				LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 			}
 			// TODO : see what a real player would return here
 			else
 			{
-				ldp1000i_push_queue(LATNAK_GENERIC);
-				g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;
+				LDPIN_TX16_PUSH(pCtx, LATNAK_GENERIC);
+				pCtx->state.UIC_Input_Active = LDP1000_FALSE;
 			}
 		}
 		// else we have the function established
 		else
 		{
-			switch (g_ldp1000i_u8UICFunction)
+			switch (pCtx->state.u8UICFunction)
 			{
 			default:
 			case 0:	// set display mode and coordinate
-				switch (g_ldp1000i_u8Idx)
+				switch (pCtx->state.u8Idx)
 				{
 				default:
 				case 1:	// X coordinate
 					// if coordinate will change, notify
-					if (g_ldp1000i_u8UIC_X != u8Byte)
+					if (pCtx->state.u8UIC_X != u8Byte)
 					{
-						g_ldp1000i_u8UIC_X = u8Byte;
-						g_ldp1000i_u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
+						pCtx->state.u8UIC_X = u8Byte;
+						pCtx->state.u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
 					}
-					ldp1000i_push_queue(LATACK_GENERIC);
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 					break;
 				case 2:	// Y coordinate
 					// if coordinate will change, notify
-					if (g_ldp1000i_u8UIC_Y != u8Byte)
+					if (pCtx->state.u8UIC_Y != u8Byte)
 					{
-						g_ldp1000i_u8UIC_Y = u8Byte;
-						g_ldp1000i_u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
+						pCtx->state.u8UIC_Y = u8Byte;
+						pCtx->state.u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
 					}
-					ldp1000i_push_queue(LATACK_GENERIC);
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 					break;
 				case 3:	// mode
-					if (g_ldp1000i_u8UIC_Mode != u8Byte)
+					if (pCtx->state.u8UIC_Mode != u8Byte)
 					{
-						g_ldp1000i_u8UIC_Mode = u8Byte;
-						g_ldp1000i_u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
+						pCtx->state.u8UIC_Mode = u8Byte;
+						pCtx->state.u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_MODES;
 					}
-					ldp1000i_push_queue(LATACK_GENERIC);
-					g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;	// we're done
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
+					pCtx->state.UIC_Input_Active = LDP1000_FALSE;	// we're done
 					break;
 				}
 				break;
 			case 1:	// set buffer contents
 
 				// if we are receiving the starting index within the buffer
-				if (g_ldp1000i_u8Idx == 1)
+				if (pCtx->state.u8Idx == 1)
 				{
-					g_ldp1000i_u8UIC_StartIdx = u8Byte & 31;	// range is 0-31 so just be safe
-					ldp1000i_push_queue(LATACK_GENERIC);
+					pCtx->state.u8UIC_StartIdx = u8Byte & 31;	// range is 0-31 so just be safe
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 				}
 				// else if this is the end-of-line character
 				else if (u8Byte == 0x1A)
 				{
-					g_ldp1000i_text_buffer_contents_changed(g_ldp1000i_UIC_TextBuf);
-					ldp1000i_push_queue(LATACK_GENERIC);
-					g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;	// we're done
+					LDP1000I_CB(pCtx, text_buffer_contents_changed)(pCtx->pUser, pCtx->state.UIC_TextBuf);
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
+					pCtx->state.UIC_Input_Active = LDP1000_FALSE;	// we're done
 				}
 				// else if we are receiving the actual bytes
 				else if (u8Byte <= 0x5F)
 				{
-					g_ldp1000i_UIC_TextBuf[g_ldp1000i_u8UIC_StartIdx] = u8Byte;
-					g_ldp1000i_u8UIC_StartIdx++;
-					g_ldp1000i_u8UIC_StartIdx &= 31;	// range is 0-31 so just be safe
-					ldp1000i_push_queue(LATACK_GENERIC);
+					pCtx->state.UIC_TextBuf[pCtx->state.u8UIC_StartIdx] = u8Byte;
+					pCtx->state.u8UIC_StartIdx++;
+					pCtx->state.u8UIC_StartIdx &= 31;	// range is 0-31 so just be safe
+					LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
 				}
 				// else out of range, so return an error (this is a way for us to get out of UIC mode if we are in it wrongly)
 				else
 				{
-					ldp1000i_push_queue(LATNAK_GENERIC);
-					g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;	// we're done
+					LDPIN_TX16_PUSH(pCtx, LATNAK_GENERIC);
+					pCtx->state.UIC_Input_Active = LDP1000_FALSE;	// we're done
 				}
 				break;
 			case 2:		// set window function
-				if (g_ldp1000i_u8UIC_Window != u8Byte)
+				if (pCtx->state.u8UIC_Window != u8Byte)
 				{
-					g_ldp1000i_u8UIC_Window = u8Byte;
-					g_ldp1000i_u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_WINDOW;
+					pCtx->state.u8UIC_Window = u8Byte;
+					pCtx->state.u8UIC_PendingNotifications |= LDP1000I_UIC_NOTIFY_WINDOW;
 				}
-				ldp1000i_push_queue(LATACK_GENERIC);
-				g_ldp1000i_UIC_Input_Active = LDP1000_FALSE;	// we're done
+				LDPIN_TX16_PUSH(pCtx, LATACK_GENERIC);
+				pCtx->state.UIC_Input_Active = LDP1000_FALSE;	// we're done
 				break;
 			}
 		}
 
 		// if we are leaving this UIC command, send out any notifications needed
-		if (!g_ldp1000i_UIC_Input_Active)
+		if (!pCtx->state.UIC_Input_Active)
 		{
-			if (g_ldp1000i_u8UIC_PendingNotifications & LDP1000I_UIC_NOTIFY_MODES)
+			if (pCtx->state.u8UIC_PendingNotifications & LDP1000I_UIC_NOTIFY_MODES)
 			{
-				g_ldp1000i_text_modes_changed(g_ldp1000i_u8UIC_Mode, g_ldp1000i_u8UIC_X, g_ldp1000i_u8UIC_Y);
+				LDP1000I_CB(pCtx, text_modes_changed)(pCtx->pUser, pCtx->state.u8UIC_Mode, pCtx->state.u8UIC_X, pCtx->state.u8UIC_Y);
 			}
 			
-			if (g_ldp1000i_u8UIC_PendingNotifications & LDP1000I_UIC_NOTIFY_WINDOW)
+			if (pCtx->state.u8UIC_PendingNotifications & LDP1000I_UIC_NOTIFY_WINDOW)
 			{
-				g_ldp1000i_text_buffer_start_index_changed(g_ldp1000i_u8UIC_Window);
+				LDP1000I_CB(pCtx, text_buffer_start_index_changed)(pCtx->pUser, pCtx->state.u8UIC_Window);
 			}			
 		}
 
-		g_ldp1000i_u8Idx++;
+		pCtx->state.u8Idx++;
 	}
 }
 
-LDP1000_BOOL ldp1000i_can_read()
+LDP1000_BOOL ldp1000i_ctx_can_read(LDP1000Ctx_t *pCtx)
 {
-	return (LDP1000_BOOL) (g_ldp1000i_u8TxBufCount != 0);
+	return (LDP1000_BOOL) (ldpin_ring16_count(&pCtx->state.tx) != 0);
 }
 
-uint16_t ldp1000i_read()
+uint16_t ldp1000i_ctx_read(LDP1000Ctx_t *pCtx)
 {
-//	assert(g_ldp1000i_u8TxBufCount > 0);
-	return ldp1000i_pop_queue();
+//	assert(ldpin_ring16_count(&pCtx->state.tx) > 0);
+	LDPIN_COUNT(pCtx, u32BytesOut);
+	return ldpin_ring16_pop(&pCtx->state.tx);
 }
 
-void ldp1000i_think_during_vblank()
+void ldp1000i_ctx_write_n(LDP1000Ctx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len)
 {
-	if (g_ldp1000i_bSearchActive)
+	while (u16Len != 0)
 	{
-		LDP1000Status_t stat = g_ldp1000i_get_status();
+		ldp1000i_ctx_write(pCtx, *p8Src++);
+		u16Len--;
+	}
+}
+
+uint16_t ldp1000i_ctx_read_n(LDP1000Ctx_t *pCtx, uint16_t *pDst, uint16_t u16Cap)
+{
+	uint16_t u16Read = 0;
+
+	while ((u16Read < u16Cap) && (ldpin_ring16_count(&pCtx->state.tx) != 0))
+	{
+		pDst[u16Read++] = ldpin_ring16_pop(&pCtx->state.tx);
+	}
+
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u16Read);
+	return u16Read;
+}
+
+const uint16_t *ldp1000i_ctx_tx_peek(LDP1000Ctx_t *pCtx, uint8_t *pu8Count)
+{
+	return ldpin_ring16_peek(&pCtx->state.tx, pu8Count);
+}
+
+void ldp1000i_ctx_tx_commit(LDP1000Ctx_t *pCtx, uint8_t u8Count)
+{
+	ldpin_ring16_commit(&pCtx->state.tx, u8Count);
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u8Count);
+}
+
+void ldp1000i_ctx_think_during_vblank(LDP1000Ctx_t *pCtx)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_LDP1000, 0);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+
+	if (pCtx->state.bSearchActive)
+	{
+		LDP1000Status_t stat = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDP1000, LDP1000I_CB(pCtx, get_status)(pCtx->pUser));
 		switch (stat)
 		{
 			// if search is complete
 		case LDP1000_PAUSED:
 
-			g_ldp1000i_bSearchActive = LDP1000_FALSE;
+			pCtx->state.bSearchActive = LDP1000_FALSE;
+			LDPIN_COUNT_SEARCH_DONE(pCtx);
 
 			// if this was a regular search and not a repeat
-			if (!g_ldp1000i_bRepeatActive)
+			if (!pCtx->state.bRepeatActive)
 			{
-				ldp1000i_push_queue(LATVAL_GENERIC | 1);	// search complete result code
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | 1);	// search complete result code
 			}
 			// else it's a repeat, doing a loop
 			else
 			{
-				ldp1000i_repeat_play();
+				ldp1000i_repeat_play(pCtx);
 			}
 			break;
 			// if we're still searching, do nothing
 		case LDP1000_SEARCHING:
 			break;
 		default:
-			g_ldp1000i_error(LDP1000_ERR_UNHANDLED_SITUATION, 0);
+			LDPIN_COUNT_SEARCH_FAILED(pCtx);
+			LDP1000I_ERROR(pCtx, LDP1000_ERR_UNHANDLED_SITUATION, 0);
 			break;
 		}
 	} // end if a search was active
 	// else if repeat is active, see if it's time to take action
-	else if (g_ldp1000i_bRepeatActive)
+	else if (pCtx->state.bRepeatActive)
 	{
-		uint32_t u32CurFrame = g_ldp1000i_get_cur_frame_num();
+		uint32_t u32CurFrame = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDP1000, LDP1000I_CB(pCtx, get_cur_frame_num)(pCtx->pUser));
 
 		// if we've reached our destination frame
 		if (
-			((!g_ldp1000i_directionIsReversed) && (u32CurFrame >= g_ldp1000i_u32RepeatEndFrame)) ||
-			((g_ldp1000i_directionIsReversed) && (u32CurFrame <= g_ldp1000i_u32RepeatEndFrame))
+			((!pCtx->state.directionIsReversed) && (u32CurFrame >= pCtx->state.u32RepeatEndFrame)) ||
+			((pCtx->state.directionIsReversed) && (u32CurFrame <= pCtx->state.u32RepeatEndFrame))
 			)
 		{
 			// if this is our last loop
-			if (g_ldp1000i_u8RepeatIterations == 1)
+			if (pCtx->state.u8RepeatIterations == 1)
 			{
 				// still on the end frame itself
-				g_ldp1000i_pause();
-				ldp1000i_push_queue(LATVAL_GENERIC | 1);	// send completion result code (same as for searches)
-				g_ldp1000i_bRepeatActive = LDP1000_FALSE;
+				LDP1000I_CB(pCtx, pause)(pCtx->pUser);
+				LDPIN_TX16_PUSH(pCtx, LATVAL_GENERIC | 1);	// send completion result code (same as for searches)
+				pCtx->state.bRepeatActive = LDP1000_FALSE;
 			}
 			// else we have more work to do (or else we are in an endless loop)
 			else
 			{
-				g_ldp1000i_begin_search(g_ldp1000i_u32RepeatStartFrame);
-				g_ldp1000i_bSearchActive = LDP1000_TRUE;
+				LDP1000I_CB(pCtx, begin_search)(pCtx->pUser, pCtx->state.u32RepeatStartFrame);
+				LDPIN_COUNT_SEARCH_START(pCtx);
+				pCtx->state.bSearchActive = LDP1000_TRUE;
 
 				// if our iterations can be decremented (0 means endless loop)
-				if (g_ldp1000i_u8RepeatIterations > 0)
+				if (pCtx->state.u8RepeatIterations > 0)
 				{
-					g_ldp1000i_u8RepeatIterations--;
+					pCtx->state.u8RepeatIterations--;
 				}
 			}
 		} // end if we've reached destination frame
@@ -808,22 +915,94 @@ void ldp1000i_think_during_vblank()
 
 }
 
-const uint8_t *ldp1000i_get_text_buffer()
+const uint8_t *ldp1000i_ctx_get_text_buffer(LDP1000Ctx_t *pCtx)
 {
-	return g_ldp1000i_UIC_TextBuf;
+	return pCtx->state.UIC_TextBuf;
 }
 
-LDP1000_BOOL ldp1000i_isRepeatActive()
+LDP1000_BOOL ldp1000i_ctx_isRepeatActive(LDP1000Ctx_t *pCtx)
 {
-	return g_ldp1000i_bRepeatActive;
+	return pCtx->state.bRepeatActive;
 }
 
 // this is a separate method in case we ever decide to support multi-speed repeat playback
-void ldp1000i_repeat_play()
+void ldp1000i_repeat_play(LDP1000Ctx_t *pCtx)
 {
 	// NOTE : multi-speed playback is optional for the REPEAT command but no game uses it so no point in supporting it
-	g_ldp1000i_play(1, 1, g_ldp1000i_directionIsReversed,
+	LDP1000I_CB(pCtx, play)(pCtx->pUser, 1, 1, pCtx->state.directionIsReversed,
 
 		// if direction is reversed, we want to squelch audio to be consistent for normal ldp-1450 behavior when playing in reverse
-		g_ldp1000i_directionIsReversed);
-}
\ No newline at end of file
+		pCtx->state.directionIsReversed);
+}
+//////////////////////////////////
+
+void ldp1000i_reset(LDP1000_EmulationType_t type)
+{
+	ldp1000i_ctx_reset(&g_ldp1000i_ctx, type);
+}
+
+void ldp1000i_write(uint8_t u8Byte)
+{
+	ldp1000i_ctx_write(&g_ldp1000i_ctx, u8Byte);
+}
+
+LDP1000_BOOL ldp1000i_can_read()
+{
+	return ldp1000i_ctx_can_read(&g_ldp1000i_ctx);
+}
+
+uint16_t ldp1000i_read()
+{
+	return ldp1000i_ctx_read(&g_ldp1000i_ctx);
+}
+
+void ldp1000i_write_n(const uint8_t *p8Src, uint16_t u16Len)
+{
+	ldp1000i_ctx_write_n(&g_ldp1000i_ctx, p8Src, u16Len);
+}
+
+uint16_t ldp1000i_read_n(uint16_t *pDst, uint16_t u16Cap)
+{
+	return ldp1000i_ctx_read_n(&g_ldp1000i_ctx, pDst, u16Cap);
+}
+
+const uint16_t *ldp1000i_tx_peek(uint8_t *pu8Count)
+{
+	return ldp1000i_ctx_tx_peek(&g_ldp1000i_ctx, pu8Count);
+}
+
+void ldp1000i_tx_commit(uint8_t u8Count)
+{
+	ldp1000i_ctx_tx_commit(&g_ldp1000i_ctx, u8Count);
+}
+
+void ldp1000i_think_during_vblank()
+{
+	ldp1000i_ctx_think_during_vblank(&g_ldp1000i_ctx);
+}
+
+void ldp1000i_ctx_set_cur_frame_num(LDP1000Ctx_t *pCtx, uint32_t u32Frame)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_LDP1000, u32Frame);
+	ldpin_frame_cache_set(&pCtx->state.frameCache, u32Frame);
+}
+
+void ldp1000i_set_cur_frame_num(uint32_t u32Frame)
+{
+	ldp1000i_ctx_set_cur_frame_num(&g_ldp1000i_ctx, u32Frame);
+}
+
+const uint8_t *ldp1000i_get_text_buffer()
+{
+	return ldp1000i_ctx_get_text_buffer(&g_ldp1000i_ctx);
+}
+
+LDP1000_BOOL ldp1000i_isRepeatActive()
+{
+	return ldp1000i_ctx_isRepeatActive(&g_ldp1000i_ctx);
+}
+
+LDP1000Ctx_t *ldp1000i_get_default_ctx()
+{
+	return &g_ldp1000i_ctx;
+}
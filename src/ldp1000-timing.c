@@ -0,0 +1,150 @@
+#include <ldp-in/ldp1000-timing.h>
+
+// (see ldp1000i_timing_default_table)
+static const LDP1000LatencyTable_t g_ldp1000aDelays =
+{
+	{
+		6000,	// LDP1000_LATENCY_CLEAR
+		4000,	// LDP1000_LATENCY_NUMBER
+		8000,	// LDP1000_LATENCY_ENTER
+		20000,	// LDP1000_LATENCY_PLAY
+		20000,	// LDP1000_LATENCY_STILL
+		1000,	// LDP1000_LATENCY_INQUIRY (between digits)
+		8000	// LDP1000_LATENCY_GENERIC
+	}
+};
+
+static const LDP1000LatencyTable_t g_ldp1450Delays =
+{
+	{
+		3000,	// LDP1000_LATENCY_CLEAR
+		2000,	// LDP1000_LATENCY_NUMBER
+		4000,	// LDP1000_LATENCY_ENTER
+		12000,	// LDP1000_LATENCY_PLAY
+		12000,	// LDP1000_LATENCY_STILL
+		500,	// LDP1000_LATENCY_INQUIRY (between digits)
+		4000	// LDP1000_LATENCY_GENERIC
+	}
+};
+
+const LDP1000LatencyTable_t *ldp1000i_timing_default_table(LDP1000_EmulationType_t type)
+{
+	return (type == LDP1000_EMU_LDP1450) ? &g_ldp1450Delays : &g_ldp1000aDelays;
+}
+
+void ldp1000i_timing_init(LDP1000Timing_t *pTiming, LDP1000_EmulationType_t type, uint32_t u32Baud)
+{
+	if (u32Baud < LDP1000_TIMING_MIN_BAUD)
+	{
+		u32Baud = LDP1000_TIMING_MIN_BAUD;
+	}
+	else if (u32Baud > LDP1000_TIMING_MAX_BAUD)
+	{
+		u32Baud = LDP1000_TIMING_MAX_BAUD;
+	}
+
+	pTiming->table = *ldp1000i_timing_default_table(type);
+	pTiming->u32Baud = u32Baud;
+	pTiming->u64LineFreeNs = 0;
+	pTiming->u32LineFrac = 0;
+	pTiming->u64LastCmdNs = 0;
+	pTiming->bStarted = 0;
+	pTiming->u8Carry = 0;
+}
+
+// schedules one byte; bFirst is non-zero for the first byte of a response
+static uint64_t ldp1000i_timing_schedule(LDP1000Timing_t *pTiming, uint8_t bFirst, uint64_t u64CmdNs, uint16_t u16Entry)
+{
+	uint8_t u8Latency = (uint8_t) (u16Entry >> 8);
+	uint64_t u64StartNs = pTiming->u64LineFreeNs;
+	uint64_t u64ReadyNs;
+	uint64_t u64Bits;
+
+	// the first byte of a response counts from the call that produced it, the rest from the byte before
+	if (bFirst || !pTiming->bStarted)
+	{
+		u64ReadyNs = u64CmdNs;
+	}
+	else
+	{
+		u64ReadyNs = pTiming->u64LineFreeNs;
+	}
+	if (u8Latency < LDP1000_LATENCY_COUNT)
+	{
+		u64ReadyNs += (uint64_t) pTiming->table.au32DelayUs[u8Latency] * 1000;
+	}
+
+	// a line that has been idle starts counting whole bit times again from when the byte is ready
+	if (!pTiming->bStarted || (u64ReadyNs > u64StartNs))
+	{
+		u64StartNs = u64ReadyNs;
+		pTiming->u32LineFrac = 0;
+	}
+	pTiming->bStarted = 1;
+
+	// 10^9 * bits / baud, keeping the remainder so that a long stream doesn't drift
+	u64Bits = (uint64_t) LDP1000_TIMING_BITS_PER_BYTE * 1000000000ull + pTiming->u32LineFrac;
+	pTiming->u64LineFreeNs = u64StartNs + (u64Bits / pTiming->u32Baud);
+	pTiming->u32LineFrac = (uint32_t) (u64Bits % pTiming->u32Baud);
+	return pTiming->u64LineFreeNs;
+}
+
+uint64_t ldp1000i_timing_release(LDP1000Timing_t *pTiming, uint64_t u64CmdNs, uint16_t u16Entry)
+{
+	uint8_t bFirst = (uint8_t) (u64CmdNs != pTiming->u64LastCmdNs);
+
+	pTiming->u64LastCmdNs = u64CmdNs;
+	return ldp1000i_timing_schedule(pTiming, bFirst, u64CmdNs, u16Entry);
+}
+
+uint8_t ldp1000i_timing_drain(LDP1000Timing_t *pTiming, LDP1000Ctx_t *pCtx, uint64_t u64CmdNs, LDP1000TimedByte_t *pDst, uint8_t u8Cap)
+{
+	uint8_t u8Total = 0;
+	uint8_t bNewResponse = 1;
+
+	while (u8Total < u8Cap)
+	{
+		uint8_t u8Count = 0;
+		const uint16_t *p16 = ldp1000i_ctx_tx_peek(pCtx, &u8Count);
+		uint8_t u;
+
+		if (u8Count == 0)
+		{
+			break;
+		}
+		if (u8Count > (uint8_t) (u8Cap - u8Total))
+		{
+			u8Count = (uint8_t) (u8Cap - u8Total);
+		}
+
+		for (u = 0; u < u8Count; u++)
+		{
+			uint8_t bFirst = 0;
+
+			// what the last drain left behind carries on its response; the first byte after that starts this call's
+			if (pTiming->u8Carry != 0)
+			{
+				pTiming->u8Carry--;
+			}
+			else
+			{
+				bFirst = bNewResponse;
+				bNewResponse = 0;
+			}
+			pDst[u8Total].u8Val = (uint8_t) p16[u];
+			pDst[u8Total].u64ReleaseNs = ldp1000i_timing_schedule(pTiming, bFirst, u64CmdNs, p16[u]);
+			u8Total++;
+		}
+		ldp1000i_ctx_tx_commit(pCtx, u8Count);
+	}
+
+	// Whatever is still queued was queued by the time this returned, so it is timed as the rest of this call's response.
+	// (if not even the first byte of it fitted, it is left to be timed as a response to the next call instead)
+	if (!bNewResponse)
+	{
+		pTiming->u8Carry = ldpin_ring16_count(&pCtx->state.tx);
+	}
+	pTiming->u64LastCmdNs = u64CmdNs;
+
+	return u8Total;
+}
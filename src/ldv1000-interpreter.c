@@ -44,58 +44,13 @@
 #include <string.h>	// memset
 #include <assert.h>
 #include <ldp-in/ldv1000-interpreter.h>
-
-#define LDV1000_FRAMESIZE 5
-#define LDV1000_QUEUESIZE 12		/* this should be small enough so as to not waste space but big enough to hold things like current frame number */
-
-uint8_t g_ldv1000i_tx_buf[LDV1000_QUEUESIZE];
-uint8_t *g_ldv1000i_pTxBufStart = 0;
-uint8_t *g_ldv1000i_pTxBufEnd = 0;
-const uint8_t *g_ldv1000i_pTxBufLastGoodPtr = (g_ldv1000i_tx_buf + sizeof(g_ldv1000i_tx_buf) - 1);
-uint8_t g_ldv1000i_u8TxBufCount = 0;	// how many bytes are in the tx buffer
-
-#define LDV1000I_TX_WRAP(var) 	if (var > g_ldv1000i_pTxBufLastGoodPtr) var = g_ldv1000i_tx_buf;
-
-unsigned int g_ldv1000_autostop_frame = 0;	// which frame we need to stop on (if any)
-
-LDV1000_BOOL audio1 = LDV1000_TRUE; // default audio status is on
-LDV1000_BOOL audio2 = LDV1000_TRUE;
-
-LDV1000_BOOL audio_temp_mute = LDV1000_FALSE;  // flag set on FORWARD 1X, 2X, etc., which don't play audio unless a PLAY command was given first
-
-char ldv1000_frame[LDV1000_FRAMESIZE + 1]; // holds the digits sent to the LD-V1000
-
-unsigned char g_ldv1000_output = 0xFC;	// LD-V1000 is PARK'd and READY
-
-LDV1000_BOOL g_ldv1000_search_pending = LDV1000_FALSE;	// whether the LD-V1000 is currently in the middle of a search operation or not
-LDV1000_DiscSwitchState_t g_ldv1000_discswitch_state = LDV1000_DISCSWITCH_NONE;	// state of extended disc switch command
-LDV1000_BOOL g_ldv1000_discswitch_pending = LDV1000_FALSE;	// whether LD-V1000 is currently in the middle of a disc swap operation or not
-
-// 30 means 0.5 seconds (since read_ldv1000 should be called at 60 Hz)
-unsigned int g_ldv1000_search_delay_iterations = 0; // how many times read_ldv1000() is called before our search is finally finished
-
-LDV1000_EmulationType_t g_ldv1000_emulation_type = LDV1000_EMU_STANDARD;
-
-///////////////////////////////////////////
-
-void reset_ldv1000i(LDV1000_EmulationType_t type)
-{
-	g_ldv1000i_pTxBufStart = g_ldv1000i_pTxBufEnd = g_ldv1000i_tx_buf;
-	g_ldv1000i_u8TxBufCount = 0;
-	g_ldv1000_autostop_frame = 0;
-	audio1 = LDV1000_TRUE;
-	audio2 = LDV1000_TRUE;
-	audio_temp_mute = LDV1000_FALSE;
-	g_ldv1000_output = 0xFC;
-	g_ldv1000_search_pending = LDV1000_FALSE;
-	g_ldv1000_discswitch_pending = LDV1000_FALSE;
-	g_ldv1000_search_delay_iterations = 0;
-	g_ldv1000_emulation_type = type;
-	g_ldv1000_discswitch_state = LDV1000_DISCSWITCH_NONE;
-}
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
 
 ///////////////////////////////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 LDV1000Status_t (*g_ldv1000i_get_status)() = NULL;
@@ -116,70 +71,262 @@ void (*g_ldv1000i_change_seek_delay)(LDV1000_BOOL bEnabled) = NULL;
 void (*g_ldv1000i_change_spinup_delay)(LDV1000_BOOL bEnabled) = NULL;
 void (*g_ldv1000i_change_super_mode)(LDV1000_BOOL bEnabled) = NULL;
 
+// the default context forwards to the global callbacks above
+static LDV1000Status_t ldv1000i_global_get_status(void *pUser) { (void) pUser; return g_ldv1000i_get_status(); }
+static uint32_t ldv1000i_global_get_cur_frame_num(void *pUser) { (void) pUser; return g_ldv1000i_get_cur_frame_num(); }
+static void ldv1000i_global_play(void *pUser) { (void) pUser; g_ldv1000i_play(); }
+static void ldv1000i_global_pause(void *pUser) { (void) pUser; g_ldv1000i_pause(); }
+static void ldv1000i_global_begin_search(void *pUser, uint32_t uFrameNumber) { (void) pUser; g_ldv1000i_begin_search(uFrameNumber); }
+static void ldv1000i_global_step_reverse(void *pUser) { (void) pUser; g_ldv1000i_step_reverse(); }
+static void ldv1000i_global_change_speed(void *pUser, uint8_t uNumerator, uint8_t uDenominator) { (void) pUser; g_ldv1000i_change_speed(uNumerator, uDenominator); }
+static void ldv1000i_global_skip_forward(void *pUser, uint8_t uTracks) { (void) pUser; g_ldv1000i_skip_forward(uTracks); }
+static void ldv1000i_global_skip_backward(void *pUser, uint8_t uTracks) { (void) pUser; g_ldv1000i_skip_backward(uTracks); }
+static void ldv1000i_global_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable) { (void) pUser; g_ldv1000i_change_audio(uChannel, uEnable); }
+static void ldv1000i_global_on_error(void *pUser, const char *pszErrMsg) { (void) pUser; g_ldv1000i_on_error(pszErrMsg); }
+static const uint8_t *ldv1000i_global_query_available_discs(void *pUser) { (void) pUser; return g_ldv1000i_query_available_discs(); }
+static uint8_t ldv1000i_global_query_active_disc(void *pUser) { (void) pUser; return g_ldv1000i_query_active_disc(); }
+static void ldv1000i_global_begin_changing_to_disc(void *pUser, uint8_t idDisc) { (void) pUser; g_ldv1000i_begin_changing_to_disc(idDisc); }
+static void ldv1000i_global_change_seek_delay(void *pUser, LDV1000_BOOL bEnabled) { (void) pUser; g_ldv1000i_change_seek_delay(bEnabled); }
+static void ldv1000i_global_change_spinup_delay(void *pUser, LDV1000_BOOL bEnabled) { (void) pUser; g_ldv1000i_change_spinup_delay(bEnabled); }
+static void ldv1000i_global_change_super_mode(void *pUser, LDV1000_BOOL bEnabled) { (void) pUser; g_ldv1000i_change_super_mode(bEnabled); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static LDV1000Ctx_t g_ldv1000i_ctx =
+{
+	{
+		{ { 0 }, 0, 0, 0 },	// tx (empty)
+		0,	// autostop_frame
+		LDV1000_TRUE, LDV1000_TRUE,	// default audio status is on
+		LDV1000_FALSE,	// audio_temp_mute
+		{ 0 },	// frame
+		0xFC,	// LD-V1000 is PARK'd and READY
+		LDV1000_FALSE,	// search_pending
+		LDV1000_DISCSWITCH_NONE,
+		LDV1000_FALSE,	// discswitch_pending
+		0,	// search_delay_iterations
+		LDV1000_EMU_STANDARD,
+		{ 0, { 0 }, 0 },	// frame_cache (empty)
+		LDV1000_FALSE,	// status_notified
+		LDV1000_ERROR,	// notified_status (unused until status_notified is set)
+		LDV1000_FALSE,	// read_cached
+		0	// read_cache
+	},
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		ldv1000i_global_get_status,
+		ldv1000i_global_get_cur_frame_num,
+		ldv1000i_global_play,
+		ldv1000i_global_pause,
+		ldv1000i_global_begin_search,
+		ldv1000i_global_step_reverse,
+		ldv1000i_global_change_speed,
+		ldv1000i_global_skip_forward,
+		ldv1000i_global_skip_backward,
+		ldv1000i_global_change_audio,
+		ldv1000i_global_on_error,
+		ldv1000i_global_query_available_discs,
+		ldv1000i_global_query_active_disc,
+		ldv1000i_global_begin_changing_to_disc,
+		ldv1000i_global_change_seek_delay,
+		ldv1000i_global_change_spinup_delay,
+		ldv1000i_global_change_super_mode
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the ldv1000i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define LDV1000I_CB_FUNC(pCtx, name)	ldv1000i_host_##name
+#else
+#define LDV1000I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define LDV1000I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_LDV1000, LDV1000Callbacks_t, name, LDV1000I_CB_FUNC(pCtx, name))
+
+// errors are text, so the counters and the flight recorder are only told that one happened
+#define LDV1000I_NOTE_ERROR(pCtx)	(LDPIN_COUNT_ERR(pCtx, 0), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_LDV1000, 0))
+
+// busy edges go through here so that the flight recorder sees them
+#define LDV1000I_SET_SEARCH_PENDING(pCtx, b)	((pCtx)->state.search_pending = (b), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_SEARCH, LDPIN_TRACE_LDV1000, b))
+#define LDV1000I_SET_DISCSWITCH_PENDING(pCtx, b)	((pCtx)->state.discswitch_pending = (b), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_DISCSWITCH, LDPIN_TRACE_LDV1000, b))
+
 ///////////////////////////////////////////
 
-// private functions
+void ldv1000i_ctx_init(LDV1000Ctx_t *pCtx, const LDV1000Callbacks_t *pCallbacks, void *pUser)
+{
+	memset(&pCtx->state, 0, sizeof(pCtx->state));
+	ldpin_ring8_reset(&pCtx->state.tx);
+	pCtx->state.audio1 = LDV1000_TRUE;
+	pCtx->state.audio2 = LDV1000_TRUE;
+	pCtx->state.output = 0xFC;	// LD-V1000 is PARK'd and READY
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
 
-unsigned int get_buffered_frame(void);
-void ldv1000_add_digit(char);
-void pre_audio1();
-void pre_audio2();
-void clear();
+void ldv1000i_ctx_save(const LDV1000Ctx_t *pCtx, LDV1000Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_LDV1000, LDV1000_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
 
-//////////////////////////////////////////
+LDV1000_BOOL ldv1000i_ctx_restore(LDV1000Ctx_t *pCtx, const LDV1000Snapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_LDV1000, LDV1000_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return LDV1000_FALSE;
+	}
+
+	if (ldpin_ring8_count(&pSnap->state.tx) > LDP_IN_RING_SIZE)
+	{
+		return LDV1000_FALSE;
+	}
+
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return LDV1000_TRUE;
+}
+
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t ldv1000i_ctx_flight_read(LDV1000Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
+{
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
+}
+#endif
 
-void ldv1000_push_queue(uint8_t u8Val)
+void ldv1000i_ctx_reset(LDV1000Ctx_t *pCtx, LDV1000_EmulationType_t type)
 {
-	*g_ldv1000i_pTxBufEnd = u8Val;
-	g_ldv1000i_pTxBufEnd++;
-	LDV1000I_TX_WRAP(g_ldv1000i_pTxBufEnd);
-	g_ldv1000i_u8TxBufCount++;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_LDV1000, type);
+	ldpin_ring8_reset(&pCtx->state.tx);
+	pCtx->state.autostop_frame = 0;
+	pCtx->state.audio1 = LDV1000_TRUE;
+	pCtx->state.audio2 = LDV1000_TRUE;
+	pCtx->state.audio_temp_mute = LDV1000_FALSE;
+	pCtx->state.output = 0xFC;
+	pCtx->state.search_pending = LDV1000_FALSE;
+	pCtx->state.discswitch_pending = LDV1000_FALSE;
+	pCtx->state.search_delay_iterations = 0;
+	pCtx->state.emulation_type = type;
+	pCtx->state.discswitch_state = LDV1000_DISCSWITCH_NONE;
+	ldpin_frame_cache_reset(&pCtx->state.frame_cache);
+	pCtx->state.status_notified = LDV1000_FALSE;
+	pCtx->state.read_cached = LDV1000_FALSE;
+}
 
-	// we should never get close to this
-	assert(g_ldv1000i_u8TxBufCount < sizeof(g_ldv1000i_tx_buf));
+void reset_ldv1000i(LDV1000_EmulationType_t type)
+{
+	ldv1000i_ctx_reset(&g_ldv1000i_ctx, type);
 }
 
-uint8_t ldv1000_pop_queue()
+LDV1000Ctx_t *ldv1000i_get_default_ctx()
 {
-	uint8_t u8Res = *g_ldv1000i_pTxBufStart;
-	g_ldv1000i_pTxBufStart++;
-	LDV1000I_TX_WRAP(g_ldv1000i_pTxBufStart);
-	g_ldv1000i_u8TxBufCount--;
+	return &g_ldv1000i_ctx;
+}
+
+///////////////////////////////////////////
+
+// private functions
 
-	// sanity check
-	assert(g_ldv1000i_u8TxBufCount != -1);
+unsigned int get_buffered_frame(LDV1000Ctx_t *pCtx);
+void ldv1000_add_digit(LDV1000Ctx_t *pCtx, char);
+void pre_audio1(LDV1000Ctx_t *pCtx);
+void pre_audio2(LDV1000Ctx_t *pCtx);
+void clear(LDV1000Ctx_t *pCtx);
 
-	return u8Res;
+// player status, either as notified by the host or from the callback
+static LDV1000Status_t get_status(LDV1000Ctx_t *pCtx)
+{
+	if (pCtx->state.status_notified)
+	{
+		return pCtx->state.notified_status;
+	}
+	return LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDV1000, LDV1000I_CB(pCtx, get_status)(pCtx->pUser));
+}
+
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t ldv1000i_cmd_class(unsigned char value)
+{
+	switch (value)
+	{
+	case 0x3F: case 0x0F: case 0x8F: case 0x4F: case 0x2F:
+	case 0xAF: case 0x6F: case 0x1F: case 0x9F: case 0x5F:
+		return LDPIN_CMD_DIGIT;
+	case 0xA0: case 0xA1: case 0xA2: case 0xA3: case 0xA4: case 0xA5: case 0xA6: case 0xA7:
+	case 0xF9: case 0xF3: case 0xFD: case 0xFE: case 0xFB:
+	case 0xB1: case 0xB2: case 0xB3: case 0xB4: case 0xB5: case 0xB6: case 0xB7: case 0xB8: case 0xB9: case 0xBA:
+	case 0x20: case 0x31: case 0x32: case 0x33: case 0x34: case 0x35: case 0x36: case 0x37: case 0x38: case 0x39:
+		return LDPIN_CMD_PLAY;
+	case 0xF7:
+		return LDPIN_CMD_SEARCH;
+	case 0xC2: case 0x90: case 0x91: case 0x92:
+		return LDPIN_CMD_INQUIRY;
+	case 0xF4: case 0xFC: case 0xCD: case 0xCE:
+		return LDPIN_CMD_AV;
+	default:	// includes NO ENTRY
+		return LDPIN_CMD_OTHER;
+	}
 }
+#endif // LDP_IN_COUNTERS
+
+//////////////////////////////////////////
 
 // retrieves the status from our virtual LD-V1000
-unsigned char read_ldv1000i()
+unsigned char ldv1000i_ctx_read(LDV1000Ctx_t *pCtx)
 {
 	unsigned char result = 0;
 
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_READ, LDPIN_TRACE_LDV1000, 0);
+	LDPIN_COUNT(pCtx, u32BytesOut);
+
+	// nothing queued and nothing has changed since the last read
+	if (pCtx->state.read_cached)
+	{
+		LDPIN_TRACE(pCtx, LDPIN_TRACE_OUTPUT, LDPIN_TRACE_LDV1000, pCtx->state.read_cache);
+		return pCtx->state.read_cache;
+	}
+
 	// if we don't have anything in the queue to return, then return current player status
-	if (g_ldv1000i_u8TxBufCount == 0)
+	if (ldpin_ring8_count(&pCtx->state.tx) == 0)
 	{
-		LDV1000Status_t stat = g_ldv1000i_get_status();
+		LDV1000Status_t stat = get_status(pCtx);
+		LDV1000_BOOL bStable = LDV1000_TRUE;	// whether reading again would return the same thing without changing anything
 
 		// we are in the middle of a search operation ...
-		if (g_ldv1000_search_pending)
+		if (pCtx->state.search_pending)
 		{
 			// if the ld-v1000 has been "searching" for long enough
 			//   then check to see if it's time to change our search from 'busy' to 'finished'
-			if (g_ldv1000_search_delay_iterations == 0)
+			if (pCtx->state.search_delay_iterations == 0)
 			{
 				// if we finished seeking and found success
 				if (stat == LDV1000_PAUSED)
 				{
-					g_ldv1000_output = (g_ldv1000_output & 0x80) | 0x50;	// seek succeeded (but don't change the high bit in case they have not sent a NO ENTRY command since initiating the search, cobraconv does this a lot)
-					g_ldv1000_search_pending = LDV1000_FALSE;
+					pCtx->state.output = (pCtx->state.output & 0x80) | 0x50;	// seek succeeded (but don't change the high bit in case they have not sent a NO ENTRY command since initiating the search, cobraconv does this a lot)
+					LDV1000I_SET_SEARCH_PENDING(pCtx, LDV1000_FALSE);
+					LDPIN_COUNT_SEARCH_DONE(pCtx);
 				}
 				// search failed for whatever reason ...
 				else if (stat == LDV1000_ERROR)
 				{
-					g_ldv1000_output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
-					g_ldv1000_search_pending = LDV1000_FALSE;
+					pCtx->state.output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
+					LDV1000I_SET_SEARCH_PENDING(pCtx, LDV1000_FALSE);
+					LDPIN_COUNT_SEARCH_FAILED(pCtx);
 				}
 
 				// else if we're not still searching, it's an error
@@ -187,64 +334,81 @@ unsigned char read_ldv1000i()
 				{
 					char s[50];
 					sprintf(s, "Unknown state after search: %x", stat);
-					g_ldv1000i_on_error(s);
+					LDV1000I_NOTE_ERROR(pCtx);
+					LDV1000I_CB(pCtx, on_error)(pCtx->pUser, s);
+					bStable = LDV1000_FALSE;
 				}
 			}
 			// else search is still going so don't change status
 			else
 			{
-				g_ldv1000_search_delay_iterations--;
+				pCtx->state.search_delay_iterations--;
+				bStable = LDV1000_FALSE;
 			}
 		}
 
-		else if (g_ldv1000_discswitch_pending)
+		else if (pCtx->state.discswitch_pending)
 		{
 			if (stat == LDV1000_STOPPED)
 			{
-				g_ldv1000_output = (g_ldv1000_output & 0x80) | 0x50;	// seek succeeded (but don't change the high bit in case they have not sent a NO ENTRY command since initiating the search, cobraconv does this a lot)
-				g_ldv1000_discswitch_pending = LDV1000_FALSE;
+				pCtx->state.output = (pCtx->state.output & 0x80) | 0x50;	// seek succeeded (but don't change the high bit in case they have not sent a NO ENTRY command since initiating the search, cobraconv does this a lot)
+				LDV1000I_SET_DISCSWITCH_PENDING(pCtx, LDV1000_FALSE);
 			}
 			else if (stat == LDV1000_ERROR)
 			{
-				g_ldv1000_output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
-				g_ldv1000_discswitch_pending = LDV1000_FALSE;
+				pCtx->state.output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
+				LDV1000I_SET_DISCSWITCH_PENDING(pCtx, LDV1000_FALSE);
 			}
 			else if (stat != LDV1000_DISC_SWITCHING)
 			{
 				char s[50];
 				sprintf(s, "Unknown state after disc switch: %x", stat);
-				g_ldv1000i_on_error(s);
+				LDV1000I_NOTE_ERROR(pCtx);
+				LDV1000I_CB(pCtx, on_error)(pCtx->pUser, s);
 
-				g_ldv1000_output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
-				g_ldv1000_discswitch_state = LDV1000_DISCSWITCH_NONE;
+				pCtx->state.output = 0x90;	// seek failed and ready (TODO : this is incorrect, the ready bit should be changeable, but I need to add a unit test to prove it before I fix it here)
+				pCtx->state.discswitch_state = LDV1000_DISCSWITCH_NONE;
+				bStable = LDV1000_FALSE;
 			}
 		}
 
 		// if autostop is active, we need to check to see if we need to stop
-		else if ((g_ldv1000_output & 0x7F) == 0x54)
+		else if ((pCtx->state.output & 0x7F) == 0x54)
 		{
+			uint32_t u32Frame;
+
+			if (pCtx->state.frame_cache.u8Valid)
+			{
+				u32Frame = pCtx->state.frame_cache.u32Frame;
+			}
+			else
+			{
+				u32Frame = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDV1000, LDV1000I_CB(pCtx, get_cur_frame_num)(pCtx->pUser));
+				bStable = LDV1000_FALSE;	// frame could change at any time
+			}
+
 			// if we've hit the frame we need to stop on (or gone too far) then stop
-			if (g_ldv1000i_get_cur_frame_num() >= g_ldv1000_autostop_frame)
+			if (u32Frame >= pCtx->state.autostop_frame)
 			{
-				g_ldv1000i_pause();
-				g_ldv1000_output = (unsigned char) ((g_ldv1000_output & 0x80) | 0x65);	// preserve ready bit and set status to paused
-				g_ldv1000_autostop_frame = 0;
+				LDV1000I_CB(pCtx, pause)(pCtx->pUser);
+				pCtx->state.output = (unsigned char) ((pCtx->state.output & 0x80) | 0x65);	// preserve ready bit and set status to paused
+				pCtx->state.autostop_frame = 0;
 			}
 		}
 
 		// else we can just return the previous output
 
-		result = g_ldv1000_output;
+		result = pCtx->state.output;
 
 		// status is always 'ready' in super mode (this will be overridden by spinning up/seeking status)
-		if (g_ldv1000_emulation_type == LDV1000_EMU_SUPER)
+		if (pCtx->state.emulation_type == LDV1000_EMU_SUPER)
 		{
 			result |= 0x80;
 		}
 
 		// it's legal to start sending new commands during a busy operation but we want our status to stay as 0x50
 		// (I'm not sure if this is correct)
-		if ((g_ldv1000_search_pending) || (g_ldv1000_discswitch_pending))
+		if ((pCtx->state.search_pending) || (pCtx->state.discswitch_pending))
 		{
 			result = 0x50;
 		}
@@ -253,168 +417,183 @@ unsigned char read_ldv1000i()
 		{
 			result = 0x64;
 		}
+
+		// Only the host's status/frame notifications (and writes) can change the result now, and they all clear read_cached.
+		// Without notifications the status has to be asked for every time.
+		if (pCtx->state.status_notified && bStable)
+		{
+			pCtx->state.read_cache = result;
+			pCtx->state.read_cached = LDV1000_TRUE;
+		}
 	}
 	// else if we have something in the queue (like the current frame)
 	else 
 	{
-		result = ldv1000_pop_queue();
+		result = ldpin_ring8_pop(&pCtx->state.tx);
 	}
 
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_OUTPUT, LDPIN_TRACE_LDV1000, result);
 	return(result);
 }
 
 // sends a byte to our virtual LD-V1000
-void write_ldv1000i(unsigned char value)
+void ldv1000i_ctx_write(LDV1000Ctx_t *pCtx, unsigned char value)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_LDV1000, value);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+	pCtx->state.read_cached = LDV1000_FALSE;
+
 	// if high-bit is set, it means we are ready and so we accept input
 	// (super mode is always ready)
-	if ((g_ldv1000_output & 0x80) || (g_ldv1000_emulation_type == LDV1000_EMU_SUPER))
+	if ((pCtx->state.output & 0x80) || (pCtx->state.emulation_type == LDV1000_EMU_SUPER))
 	{
 		// if we are in the middle of a 'switch disc' extended command
-		if (g_ldv1000_discswitch_state == LDV1000_DISCSWITCH_WAITING_FOR_DISC_ID)
+		if (pCtx->state.discswitch_state == LDV1000_DISCSWITCH_WAITING_FOR_DISC_ID)
 		{
 			// we have received the multi-part command so back to normal command processing
-			g_ldv1000_discswitch_state = LDV1000_DISCSWITCH_NONE;
+			pCtx->state.discswitch_state = LDV1000_DISCSWITCH_NONE;
 
 			// we can only initiate a disc switch if a previous disc switch is not in progress
-			if (g_ldv1000_discswitch_pending == LDV1000_TRUE)
+			if (pCtx->state.discswitch_pending == LDV1000_TRUE)
 			{
 				return;
 			}
 
 			// we can only initiate a disc switch if a search is not in progress
-			if (g_ldv1000_search_pending == LDV1000_TRUE)
+			if (pCtx->state.search_pending == LDV1000_TRUE)
 			{
 				return;
 			}
 
 			// if we are really changing to a new disc
-			if (g_ldv1000i_query_active_disc() != value)
+			if (LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDV1000, LDV1000I_CB(pCtx, query_active_disc)(pCtx->pUser)) != value)
 			{
-				g_ldv1000_discswitch_pending = LDV1000_TRUE;
-				g_ldv1000i_begin_changing_to_disc(value);
+				LDV1000I_SET_DISCSWITCH_PENDING(pCtx, LDV1000_TRUE);
+				LDV1000I_CB(pCtx, begin_changing_to_disc)(pCtx->pUser, value);
 			}
 			// else we are changing to the current disc, so 'instantly' succeed
 
 			// the status will changed to 'busy' regardless or whether we complete the change instantly or not
-			g_ldv1000_output = 0x50;
+			pCtx->state.output = 0x50;
 
 			return;
 		}
 
-		g_ldv1000_output &= 0x7F;	// clear high bit
+		pCtx->state.output &= 0x7F;	// clear high bit
 		// because when we receive a non 0xFF command we are no longer ready
 
+		LDPIN_COUNT_CMD(pCtx, ldv1000i_cmd_class(value));
+
 		switch (value)
 		{
 		case 0xBF:	// clear
-			clear();
+			clear(pCtx);
 			break;
 		case 0x3F:	// 0
-			ldv1000_add_digit('0');
+			ldv1000_add_digit(pCtx, '0');
 			break;
 		case 0x0F:	// 1
-			ldv1000_add_digit('1');
+			ldv1000_add_digit(pCtx, '1');
 			break;
 		case 0x8F:	// 2
-			ldv1000_add_digit('2');
+			ldv1000_add_digit(pCtx, '2');
 			break;
 		case 0x4F:	// 3
-			ldv1000_add_digit('3');
+			ldv1000_add_digit(pCtx, '3');
 			break;
 		case 0x2F:	// 4
-			ldv1000_add_digit('4');
+			ldv1000_add_digit(pCtx, '4');
 			break;
 		case 0xAF:	// 5
-			ldv1000_add_digit('5');
+			ldv1000_add_digit(pCtx, '5');
 			break;
 		case 0x6F:	// 6
-			ldv1000_add_digit('6');
+			ldv1000_add_digit(pCtx, '6');
 			break;
 		case 0x1F:	// 7
-			ldv1000_add_digit('7');
+			ldv1000_add_digit(pCtx, '7');
 			break;
 		case 0x9F:	// 8
-			ldv1000_add_digit('8');
+			ldv1000_add_digit(pCtx, '8');
 			break;
 		case 0x5F:	// 9
-			ldv1000_add_digit('9');
+			ldv1000_add_digit(pCtx, '9');
 			break;
 		case 0xF4:	// Audio 1
-			pre_audio1();
+			pre_audio1(pCtx);
 			break;
 		case 0xFC:	// Audio 2
-			pre_audio2();
+			pre_audio2(pCtx);
 			break;
 		case 0xA0:	// play at 0X (pause)
-			g_ldv1000i_pause();
+			LDV1000I_CB(pCtx, pause)(pCtx->pUser);
 			// TODO : change status?
 			break;
 		case 0xA1:	// play at 1/4X
-			g_ldv1000i_change_speed(1, 4);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 1, 4);
 			break;
 		case 0xA2:	// play at 1/2X
-			g_ldv1000i_change_speed(1, 2);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 1, 2);
 			break;
 		case 0xA3:	// play at 1X
 			// it is necessary to set the playspeed because otherwise the ld-v1000 ignores skip commands
-			if (g_ldv1000i_get_status() != LDV1000_PLAYING) 
+			if (get_status(pCtx) != LDV1000_PLAYING) 
 			{
 				// if not already playing, FORWARD 1X plays with no audio (until the next PLAY),
 				// so we need to set a temporary mute
-				audio_temp_mute = LDV1000_TRUE;
-				g_ldv1000i_play();
-				g_ldv1000i_change_audio(0, 0);// disable audio 1
-				g_ldv1000i_change_audio(1, 0);// disable audio 2
-				g_ldv1000_output = 0x2e;	// not ready and in FORWARD (variable speed) mode
+				pCtx->state.audio_temp_mute = LDV1000_TRUE;
+				LDV1000I_CB(pCtx, play)(pCtx->pUser);
+				LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);// disable audio 1
+				LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);// disable audio 2
+				pCtx->state.output = 0x2e;	// not ready and in FORWARD (variable speed) mode
 			}
-			g_ldv1000i_change_speed(1, 1);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 1, 1);
 			break;
 		case 0xA4:	// play at 2X
-			g_ldv1000i_change_speed(2, 1);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 2, 1);
 			break;
 		case 0xA5:	// play at 3X
-			g_ldv1000i_change_speed(3, 1);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 3, 1);
 			break;
 		case 0xA6:	// play at 4X
-			g_ldv1000i_change_speed(4, 1);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 4, 1);
 			break;
 		case 0xA7:	// play at 5X
-			g_ldv1000i_change_speed(5, 1);
+			LDV1000I_CB(pCtx, change_speed)(pCtx->pUser, 5, 1);
 			break;
 		case 0xF9:	// Reject - Stop the laserdisc player from playing
-			g_ldv1000_output = 0x7c;	// LD-V1000 is PARK'd and NOT READY
+			pCtx->state.output = 0x7c;	// LD-V1000 is PARK'd and NOT READY
 			// NOTE: laserdisc state should go into parked mode, but most people probably don't want this to happen (I sure don't)
 			break;
 		case 0xF3:	// Auto Stop (used by Esh's)
 			// This command accepts a frame # as an argument and also begins playing the disc
-			g_ldv1000_autostop_frame = get_buffered_frame();
-			clear();
-			g_ldv1000i_play();
-			g_ldv1000_output = 0x54;	// autostop is active
+			pCtx->state.autostop_frame = get_buffered_frame(pCtx);
+			clear(pCtx);
+			LDV1000I_CB(pCtx, play)(pCtx->pUser);
+			pCtx->state.output = 0x54;	// autostop is active
 			break;
 		case 0xFD:	// Play
-			g_ldv1000i_play();
+			LDV1000I_CB(pCtx, play)(pCtx->pUser);
 
 			// if a FORWARD 1X caused playing with no audio, PLAY will turn audio back on
-			if (audio_temp_mute)
+			if (pCtx->state.audio_temp_mute)
 			{
-				audio_temp_mute = LDV1000_FALSE;
-				if (audio1)  //make sure we don't have a normal mute going as well
+				pCtx->state.audio_temp_mute = LDV1000_FALSE;
+				if (pCtx->state.audio1)  //make sure we don't have a normal mute going as well
 				{
-					g_ldv1000i_change_audio(0, 1);// enable audio 1
+					LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);// enable audio 1
 				}
-				if (audio2)
+				if (pCtx->state.audio2)
 				{
-					g_ldv1000i_change_audio(1, 1); // enable audio 2
+					LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1); // enable audio 2
 				}
 			}
-			g_ldv1000_output = 0x64;	// not ready and playing
+			pCtx->state.output = 0x64;	// not ready and playing
 			break;
 		case 0xFE:  // step reverse
 			{
-				g_ldv1000i_step_reverse();
-				g_ldv1000_output = 0x65; // 0x65 is stop
+				LDV1000I_CB(pCtx, step_reverse)(pCtx->pUser);
+				pCtx->state.output = 0x65; // 0x65 is stop
 				break;
 			}
 		case 0xF7:	// Search
@@ -422,37 +601,27 @@ void write_ldv1000i(unsigned char value)
 				uint32_t uFrame;
 
 				// Esh's and Astron belt require searches to last at least 4 delay iterations
-				g_ldv1000_search_delay_iterations = 4;
+				pCtx->state.search_delay_iterations = 4;
 			
-				uFrame = strtoul(ldv1000_frame, NULL, 10);	// atoi is not sufficient for AVR because it is only 16-bit signed
-				g_ldv1000i_begin_search(uFrame);
-				g_ldv1000_search_pending = LDV1000_TRUE;
-				g_ldv1000_output = 0x50;
-				clear();
+				uFrame = ldpin_ascii5_to_u32(pCtx->state.frame);
+				LDV1000I_CB(pCtx, begin_search)(pCtx->pUser, uFrame);
+				LDPIN_COUNT_SEARCH_START(pCtx);
+				LDV1000I_SET_SEARCH_PENDING(pCtx, LDV1000_TRUE);
+				pCtx->state.output = 0x50;
+				clear(pCtx);
 			}
 			break;
 		case 0xC2:	// get current frame
+			// only the lower 5 digits are sent
+			if (pCtx->state.frame_cache.u8Valid)
+			{
+				LDPIN_TX8_PUSH_N(pCtx, pCtx->state.frame_cache.au8Ascii, 5);
+			}
+			else
 			{
-				uint32_t curframe = g_ldv1000i_get_cur_frame_num();
-
-				// this conversion is expensive so I've forced the loop to be unrolled
-				char s[5];
-				s[4] = (curframe % 10) + '0';
-				curframe /= 10;
-				s[3] = (curframe % 10) + '0';
-				curframe /= 10;
-				s[2] = (curframe % 10) + '0';
-				curframe /= 10;
-				s[1] = (curframe % 10) + '0';
-				curframe /= 10;
-				s[0] = (curframe % 10) + '0';
-				// discard the rest as we only want the lower 5 digits
-
-				ldv1000_push_queue(s[0]);
-				ldv1000_push_queue(s[1]);
-				ldv1000_push_queue(s[2]);
-				ldv1000_push_queue(s[3]);
-				ldv1000_push_queue(s[4]);
+				uint8_t s[5];
+				ldpin_u32_to_ascii5(LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDV1000, LDV1000I_CB(pCtx, get_cur_frame_num)(pCtx->pUser)), s);
+				LDPIN_TX8_PUSH_N(pCtx, s, 5);
 			}
 			break;
 		case 0xB1:	// Skip Forward 10
@@ -470,7 +639,7 @@ void write_ldv1000i(unsigned char value)
 				// LD-V1000 does add 1 when skipping
 				// UPDATE : I've decided it adds 1 because the disc is playing, so we should not add 1 here.
 				unsigned int tracks_to_skip = (unsigned int) (10 * (value & 0x0f));
-				g_ldv1000i_skip_forward(tracks_to_skip);
+				LDV1000I_CB(pCtx, skip_forward)(pCtx->pUser, tracks_to_skip);
 			}
 			break;
 		case 0xCD:	// Display Disable
@@ -478,8 +647,8 @@ void write_ldv1000i(unsigned char value)
 		case 0xCE:	// Display Enable
 			break;
 		case 0xFB:	// Stop - this actually just goes into still-frame mode, so we pause
-			g_ldv1000i_pause();
-			g_ldv1000_output = 0x65;	// stopped and not ready
+			LDV1000I_CB(pCtx, pause)(pCtx->pUser);
+			pCtx->state.output = 0x65;	// stopped and not ready
 			break;
 			/*
 			* From Ernesto Corvi (MAME team)
@@ -488,7 +657,7 @@ void write_ldv1000i(unsigned char value)
 			*/
 
 		case 0x20:	// Badlands custom command (disc paused, reverse)
-			g_ldv1000i_pause();
+			LDV1000I_CB(pCtx, pause)(pCtx->pUser);
 			// TODO : change status? this was a Badlands-only command
 			break;
 		case 0x31:	// Badlands custom command (skip backward 10)
@@ -502,24 +671,24 @@ void write_ldv1000i(unsigned char value)
 		case 0x39: // skip back 90
 			{
 				unsigned int tracks_to_skip = (unsigned int) (10 * (value & 0x0f));
-				g_ldv1000i_skip_backward(tracks_to_skip);
+				LDV1000I_CB(pCtx, skip_backward)(pCtx->pUser, tracks_to_skip);
 			}
 			break;
 
 			// EXTENDED (NON-STANDARD) COMMANDS DEVELOPED FOR DEXTER
 		case 0x90:	// hello
-			ldv1000_push_queue(0xa2);
+			LDPIN_TX8_PUSH(pCtx, 0xa2);
 			break;
 		case 0x91:	// query available discs
-			if (!g_ldv1000_discswitch_pending)
+			if (!pCtx->state.discswitch_pending)
 			{
-				const uint8_t *pDiscs = g_ldv1000i_query_available_discs();
+				const uint8_t *pDiscs = LDV1000I_CB(pCtx, query_available_discs)(pCtx->pUser);
 
 				for (;;)
 				{
 					uint8_t val = *pDiscs;
 					pDiscs++;
-					ldv1000_push_queue(val);
+					LDPIN_TX8_PUSH(pCtx, val);
 					if (val == 0)
 					{
 						break;
@@ -528,45 +697,46 @@ void write_ldv1000i(unsigned char value)
 			}
 			break;
 		case 0x92:	// query active disc
-			if (!g_ldv1000_discswitch_pending)
+			if (!pCtx->state.discswitch_pending)
 			{
-				ldv1000_push_queue(g_ldv1000i_query_active_disc());
+				LDPIN_TX8_PUSH(pCtx, LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_LDV1000, LDV1000I_CB(pCtx, query_active_disc)(pCtx->pUser)));
 			}
 			break;
 		case 0x93:	// prepare to switch discs
 			// yes, we always have to go into this state because we need to 'eat' the subsequent byte even if we will be ignoring this command later
-			g_ldv1000_discswitch_state = LDV1000_DISCSWITCH_WAITING_FOR_DISC_ID;
+			pCtx->state.discswitch_state = LDV1000_DISCSWITCH_WAITING_FOR_DISC_ID;
 			break;
 
 		case 0x94:	// change spin-up delay
-			g_ldv1000i_change_spinup_delay((ldv1000_frame[LDV1000_FRAMESIZE - 1] & 1));
-			clear();
+			LDV1000I_CB(pCtx, change_spinup_delay)(pCtx->pUser, (pCtx->state.frame[LDV1000_FRAMESIZE - 1] & 1));
+			clear(pCtx);
 			break;
 
 		case 0x95:	// change seek delay
-			g_ldv1000i_change_seek_delay((ldv1000_frame[LDV1000_FRAMESIZE - 1] & 1));
-			clear();
+			LDV1000I_CB(pCtx, change_seek_delay)(pCtx->pUser, (pCtx->state.frame[LDV1000_FRAMESIZE - 1] & 1));
+			clear(pCtx);
 			break;
 
 		case 0x9D:	// disable super mode
-			g_ldv1000i_change_super_mode(LDV1000_FALSE);
+			LDV1000I_CB(pCtx, change_super_mode)(pCtx->pUser, LDV1000_FALSE);
 			break;
 
 		case 0x9E:	// enable super mode
-			g_ldv1000i_change_super_mode(LDV1000_TRUE);
+			LDV1000I_CB(pCtx, change_super_mode)(pCtx->pUser, LDV1000_TRUE);
 			break;
 
 		case 0xFF:	// NO ENTRY
 			// it's legal to send the LD-V1000 as many of these as you want, we just ignore 'em
-			g_ldv1000_output |= 0x80;	// set highbit just in case
+			pCtx->state.output |= 0x80;	// set highbit just in case
 			break;
 		default:	// Unsupported Command
 			{
 				// this should never happen :)
 				char s[3];
-				g_ldv1000i_on_error("Unsupported Command");
+				LDV1000I_NOTE_ERROR(pCtx);	// one error, two messages
+				LDV1000I_CB(pCtx, on_error)(pCtx->pUser, "Unsupported Command");
 				sprintf(s, "%2x", value);
-				g_ldv1000i_on_error(s);
+				LDV1000I_CB(pCtx, on_error)(pCtx->pUser, s);
 			}
 			break;
 		}
@@ -578,121 +748,193 @@ void write_ldv1000i(unsigned char value)
 		// if we got 0xFF (NO ENTRY) as expected
 		if (value == 0xFF)
 		{
-				g_ldv1000_output |= 0x80;	// set high bit, we are now ready
+				pCtx->state.output |= 0x80;	// set high bit, we are now ready
 		}
 
 		// if we got a non NO ENTRY, we just ignore it, only the first non-NO ENTRY matters
 		else
 		{
-			g_ldv1000_output &= 0x7F;	// clear high bit, we are no longer ready
+			pCtx->state.output &= 0x7F;	// clear high bit, we are no longer ready
 		}
 	}
 
 }
 
+unsigned char read_ldv1000i()
+{
+	return ldv1000i_ctx_read(&g_ldv1000i_ctx);
+}
+
+void ldv1000i_ctx_write_n(LDV1000Ctx_t *pCtx, const unsigned char *pSrc, uint16_t u16Len)
+{
+	while (u16Len != 0)
+	{
+		ldv1000i_ctx_write(pCtx, *pSrc++);
+		u16Len--;
+	}
+}
+
+void ldv1000i_ctx_read_n(LDV1000Ctx_t *pCtx, unsigned char *pDst, uint16_t u16Count)
+{
+	while (u16Count != 0)
+	{
+		*pDst++ = ldv1000i_ctx_read(pCtx);
+		u16Count--;
+	}
+}
+
+void write_ldv1000i(unsigned char value)
+{
+	ldv1000i_ctx_write(&g_ldv1000i_ctx, value);
+}
+
+void write_n_ldv1000i(const unsigned char *pSrc, uint16_t u16Len)
+{
+	ldv1000i_ctx_write_n(&g_ldv1000i_ctx, pSrc, u16Len);
+}
+
+void read_n_ldv1000i(unsigned char *pDst, uint16_t u16Count)
+{
+	ldv1000i_ctx_read_n(&g_ldv1000i_ctx, pDst, u16Count);
+}
+
+void ldv1000i_ctx_set_cur_frame_num(LDV1000Ctx_t *pCtx, uint32_t u32Frame)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_LDV1000, u32Frame);
+
+	// only autostop depends on the frame number
+	if (!pCtx->state.frame_cache.u8Valid || (pCtx->state.frame_cache.u32Frame != u32Frame))
+	{
+		pCtx->state.read_cached = LDV1000_FALSE;
+	}
+	ldpin_frame_cache_set(&pCtx->state.frame_cache, u32Frame);
+}
+
+void ldv1000i_ctx_set_status(LDV1000Ctx_t *pCtx, LDV1000Status_t status)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_SET_STATUS, LDPIN_TRACE_LDV1000, status);
+
+	if (!pCtx->state.status_notified || (pCtx->state.notified_status != status))
+	{
+		pCtx->state.read_cached = LDV1000_FALSE;
+	}
+	pCtx->state.notified_status = status;
+	pCtx->state.status_notified = LDV1000_TRUE;
+}
+
+void set_status_ldv1000i(LDV1000Status_t status)
+{
+	ldv1000i_ctx_set_status(&g_ldv1000i_ctx, status);
+}
+
+void set_cur_frame_num_ldv1000i(uint32_t u32Frame)
+{
+	ldv1000i_ctx_set_cur_frame_num(&g_ldv1000i_ctx, u32Frame);
+}
+
 // Adds a digit to the frame array that we will be seeking to.
 // Digit should be in ASCII format
-void ldv1000_add_digit(char digit)
+void ldv1000_add_digit(LDV1000Ctx_t *pCtx, char digit)
 {
 	int count;
 	// we need to set the high bit for Badlands - it might be caused by some emulation problem
-	if (g_ldv1000_emulation_type == LDV1000_EMU_BADLANDS)
+	if (pCtx->state.emulation_type == LDV1000_EMU_BADLANDS)
 	{
-		g_ldv1000_output |= 0x80;	
+		pCtx->state.output |= 0x80;	
 	}
 
 	for (count = 0; count < LDV1000_FRAMESIZE - 1; count++)
 	{
-		if (!ldv1000_frame[count + 1])
+		if (!pCtx->state.frame[count + 1])
 		{
-			ldv1000_frame[count + 1] = '0';
+			pCtx->state.frame[count + 1] = '0';
 		}
-		ldv1000_frame[count] = ldv1000_frame[count + 1];
+		pCtx->state.frame[count] = pCtx->state.frame[count + 1];
 	}
-	ldv1000_frame[LDV1000_FRAMESIZE - 1] = digit;		
+	pCtx->state.frame[LDV1000_FRAMESIZE - 1] = digit;		
 }
 
 // Audio channel 1 on or off
-void pre_audio1()
+void pre_audio1(LDV1000Ctx_t *pCtx)
 {
 	// Check if we should just toggle
-	if (!ldv1000_frame[LDV1000_FRAMESIZE - 1])
+	if (!pCtx->state.frame[LDV1000_FRAMESIZE - 1])
 	{
 		// Check status of audio and toggle accordingly
-		if (audio1)
+		if (pCtx->state.audio1)
 		{
-			audio1 = LDV1000_FALSE;
-			g_ldv1000i_change_audio(0, 0);	// disable left channel
+			pCtx->state.audio1 = LDV1000_FALSE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);	// disable left channel
 		}
 		else
 		{
-			audio1 = LDV1000_TRUE;
-			g_ldv1000i_change_audio(0, 1);	// enable left channel
+			pCtx->state.audio1 = LDV1000_TRUE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);	// enable left channel
 		}
 	}
 	// Or if we have an explicit audio command
 	else 
 	{
-		switch (ldv1000_frame[LDV1000_FRAMESIZE - 1] & 1)
+		switch (pCtx->state.frame[LDV1000_FRAMESIZE - 1] & 1)
 		{
 		case 0:
-			audio1 = LDV1000_FALSE;
-			g_ldv1000i_change_audio(0, 0);
+			pCtx->state.audio1 = LDV1000_FALSE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);
 			break;
 		default:
-			audio1 = LDV1000_TRUE;
-			g_ldv1000i_change_audio(0, 1);
+			pCtx->state.audio1 = LDV1000_TRUE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);
 			break;
 		}
-		clear();
+		clear(pCtx);
 	}
 }
 
 // Audio channel 2 on or off
-void pre_audio2()
+void pre_audio2(LDV1000Ctx_t *pCtx)
 {
 	// Check if we should just toggle
-	if (!ldv1000_frame[LDV1000_FRAMESIZE - 1])
+	if (!pCtx->state.frame[LDV1000_FRAMESIZE - 1])
 	{
 		// Check status of audio and toggle accordingly
-		if (audio2)
+		if (pCtx->state.audio2)
 		{
-			audio2 = LDV1000_FALSE;
-			g_ldv1000i_change_audio(1, 0);
+			pCtx->state.audio2 = LDV1000_FALSE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);
 		}
 		else
 		{
-			audio2 = LDV1000_TRUE;
-			g_ldv1000i_change_audio(1, 1);
+			pCtx->state.audio2 = LDV1000_TRUE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1);
 		}
 	}
 	// Or if we have an explicit audio command
 	else 
 	{
-		switch (ldv1000_frame[LDV1000_FRAMESIZE - 1] & 1)
+		switch (pCtx->state.frame[LDV1000_FRAMESIZE - 1] & 1)
 		{
 		case 0:
-			audio2 = LDV1000_FALSE;
-			g_ldv1000i_change_audio(1, 0);
+			pCtx->state.audio2 = LDV1000_FALSE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);
 			break;
 		default:
-			audio2 = LDV1000_TRUE;
-			g_ldv1000i_change_audio(1, 1);
+			pCtx->state.audio2 = LDV1000_TRUE;
+			LDV1000I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1);
 			break;
 		}
-		clear();
+		clear(pCtx);
 	}
 }
 
 // returns the frame that has been entered in by add_digit thus far
-unsigned int get_buffered_frame()
+unsigned int get_buffered_frame(LDV1000Ctx_t *pCtx)
 {
-	ldv1000_frame[LDV1000_FRAMESIZE] = 0;	// terminate string
-	return ((unsigned int) atoi(ldv1000_frame));
+	pCtx->state.frame[LDV1000_FRAMESIZE] = 0;	// terminate string
+	return ((unsigned int) ldpin_ascii5_to_u32(pCtx->state.frame));
 }
 
 // clears any received digits from the frame array
-void clear(void)
+void clear(LDV1000Ctx_t *pCtx)
 {
-	memset(ldv1000_frame,0,sizeof(ldv1000_frame));
+	memset(pCtx->state.frame,0,sizeof(pCtx->state.frame));
 }
@@ -24,35 +24,70 @@
 #include <stdlib.h>
 #include <string.h>	// memset
 #include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
 #include <ldp-in/datatypes.h>
 
-#define PR7820_FRAMESIZE 5
+// private functions
 
-PR7820_BOOL g_bPR7820AudioEnabled[2] = { PR7820_TRUE, PR7820_TRUE }; // default audio status is on
+void pr7820_add_digit(PR7820Ctx_t *pCtx, char);
+void pr7820_audio1(PR7820Ctx_t *pCtx);
+void pr7820_audio2(PR7820Ctx_t *pCtx);
+void pr7820_update_audio(PR7820Ctx_t *pCtx);
+void pr7820_clear(PR7820Ctx_t *pCtx);
 
-char pr7820_frame[PR7820_FRAMESIZE + 1]; // holds the digits sent to the player
+////////////////////////////
 
-///////////////////////////////////////////
+void pr7820i_ctx_reset(PR7820Ctx_t *pCtx)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_PR7820, 0);
+	pCtx->state.bAudioEnabled[0] = PR7820_TRUE;
+	pCtx->state.bAudioEnabled[1] = PR7820_TRUE;
+	pr7820_clear(pCtx);
+}
 
-// private functions
+void pr7820i_ctx_init(PR7820Ctx_t *pCtx, const PR7820Callbacks_t *pCallbacks, void *pUser)
+{
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+	pr7820i_ctx_reset(pCtx);
+}
 
-void pr7820_add_digit(char);
-void pr7820_audio1();
-void pr7820_audio2();
-void pr7820_update_audio();
-void pr7820_clear();
+void pr7820i_ctx_save(const PR7820Ctx_t *pCtx, PR7820Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_PR7820, PR7820_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
 
-////////////////////////////
+PR7820_BOOL pr7820i_ctx_restore(PR7820Ctx_t *pCtx, const PR7820Snapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_PR7820, PR7820_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return PR7820_FALSE;
+	}
 
-void pr7820i_reset()
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return PR7820_TRUE;
+}
+
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t pr7820i_ctx_flight_read(PR7820Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
 {
-	g_bPR7820AudioEnabled[0] = PR7820_TRUE;
-	g_bPR7820AudioEnabled[1] = PR7820_TRUE;
-	pr7820_clear();
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
 }
+#endif
 
 ///////////////////////////////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 PR7820Status_t (*g_pr7820i_get_status)() = NULL;
@@ -63,100 +98,179 @@ void (*g_pr7820i_change_audio)(unsigned char uChannel, unsigned char uEnable) =
 void (*g_pr7820i_enable_super_mode)() = NULL;
 void (*g_pr7820i_on_error)(PR7820ErrCode_t code, unsigned char u8Val) = NULL;
 
+// the default context forwards to the global callbacks above
+static PR7820Status_t pr7820i_global_get_status(void *pUser) { (void) pUser; return g_pr7820i_get_status(); }
+static void pr7820i_global_play(void *pUser) { (void) pUser; g_pr7820i_play(); }
+static void pr7820i_global_pause(void *pUser) { (void) pUser; g_pr7820i_pause(); }
+static void pr7820i_global_begin_search(void *pUser, unsigned int uFrameNumber) { (void) pUser; g_pr7820i_begin_search(uFrameNumber); }
+static void pr7820i_global_change_audio(void *pUser, unsigned char uChannel, unsigned char uEnable) { (void) pUser; g_pr7820i_change_audio(uChannel, uEnable); }
+static void pr7820i_global_enable_super_mode(void *pUser) { (void) pUser; g_pr7820i_enable_super_mode(); }
+static void pr7820i_global_on_error(void *pUser, PR7820ErrCode_t code, unsigned char u8Val) { (void) pUser; g_pr7820i_on_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static PR7820Ctx_t g_pr7820i_ctx =
+{
+	{
+		{ PR7820_TRUE, PR7820_TRUE },	// default audio status is on
+		{ 0 }	// frame
+	},
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		pr7820i_global_get_status,
+		pr7820i_global_play,
+		pr7820i_global_pause,
+		pr7820i_global_begin_search,
+		pr7820i_global_change_audio,
+		pr7820i_global_enable_super_mode,
+		pr7820i_global_on_error
+	},
+#endif
+	NULL,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the pr7820i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define PR7820I_CB_FUNC(pCtx, name)	pr7820i_host_##name
+#else
+#define PR7820I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define PR7820I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_PR7820, PR7820Callbacks_t, name, PR7820I_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define PR7820I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_PR7820, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_PR7820, code), PR7820I_CB(pCtx, on_error)((pCtx)->pUser, code, val))
+
 ///////////////////////////////////////////
 
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t pr7820i_cmd_class(unsigned char value)
+{
+	switch (value)
+	{
+	case 0x3F: case 0x0F: case 0x8F: case 0x4F: case 0x2F:
+	case 0xAF: case 0x6F: case 0x1F: case 0x9F: case 0x5F:
+		return LDPIN_CMD_DIGIT;
+	case 0xFD: case 0xF9: case 0xFB: case 0xf2: case 0xF3: case 0xf6: case 0xfa: case 0xFE:
+		return LDPIN_CMD_PLAY;
+	case 0xF7:
+		return LDPIN_CMD_SEARCH;
+	case 0xA0: case 0xA1: case 0xA2: case 0xA3: case 0xE0: case 0xE1: case 0xF1: case 0xF4: case 0xFC:
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
+}
+#endif // LDP_IN_COUNTERS
+
 //////////////////////////////////////////
 
-PR7820_BOOL pr7820i_is_busy()
+PR7820_BOOL pr7820i_ctx_is_busy(PR7820Ctx_t *pCtx)
 {
-	PR7820Status_t stat = g_pr7820i_get_status();
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_READ, LDPIN_TRACE_PR7820, 0);
+	PR7820Status_t stat = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_PR7820, PR7820I_CB(pCtx, get_status)(pCtx->pUser));
 	PR7820_BOOL result = ((stat == PR7820_SEARCHING) || (stat == PR7820_SPINNING_UP));
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_OUTPUT, LDPIN_TRACE_PR7820, result);
 	return(result);
 }
 
-void pr7820i_write(unsigned char value)
+void pr7820i_ctx_write(PR7820Ctx_t *pCtx, unsigned char value)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, value);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+	LDPIN_COUNT_CMD(pCtx, pr7820i_cmd_class(value));
+
 	switch (value)
 	{
 	case 0x3F:	// 0
-		pr7820_add_digit('0');
+		pr7820_add_digit(pCtx, '0');
 		break;
 	case 0x0F:	// 1
-		pr7820_add_digit('1');
+		pr7820_add_digit(pCtx, '1');
 		break;
 	case 0x8F:	// 2
-		pr7820_add_digit('2');
+		pr7820_add_digit(pCtx, '2');
 		break;
 	case 0x4F:	// 3
-		pr7820_add_digit('3');
+		pr7820_add_digit(pCtx, '3');
 		break;
 	case 0x2F:	// 4
-		pr7820_add_digit('4');
+		pr7820_add_digit(pCtx, '4');
 		break;
 	case 0xAF:	// 5
-		pr7820_add_digit('5');
+		pr7820_add_digit(pCtx, '5');
 		break;
 	case 0x6F:	// 6
-		pr7820_add_digit('6');
+		pr7820_add_digit(pCtx, '6');
 		break;
 	case 0x1F:	// 7
-		pr7820_add_digit('7');
+		pr7820_add_digit(pCtx, '7');
 		break;
 	case 0x9F:	// 8
-		pr7820_add_digit('8');
+		pr7820_add_digit(pCtx, '8');
 		break;
 	case 0x5F:	// 9
-		pr7820_add_digit('9');
+		pr7820_add_digit(pCtx, '9');
 		break;
 
 	case 0x9E:	// EXTENDED COMMAND: enable super mode
-		g_pr7820i_enable_super_mode();
+		PR7820I_CB(pCtx, enable_super_mode)(pCtx->pUser);
 		break;
 	case 0xA0:	// mute audio (see $1D27 in thayer's quest ROM)
-		g_bPR7820AudioEnabled[0] = PR7820_FALSE;
-		g_bPR7820AudioEnabled[1] = PR7820_FALSE;
-		pr7820_update_audio();
+		pCtx->state.bAudioEnabled[0] = PR7820_FALSE;
+		pCtx->state.bAudioEnabled[1] = PR7820_FALSE;
+		pr7820_update_audio(pCtx);
 		break;
 	case 0xA1:	// enable left audio only (see $1D0E in thayer's quest ROM)
-		g_bPR7820AudioEnabled[0] = PR7820_TRUE;
-		g_bPR7820AudioEnabled[1] = PR7820_FALSE;
-		pr7820_update_audio();
+		pCtx->state.bAudioEnabled[0] = PR7820_TRUE;
+		pCtx->state.bAudioEnabled[1] = PR7820_FALSE;
+		pr7820_update_audio(pCtx);
 		break;
 	case 0xA2:	// enable right audio only (see $1CF5 in thayer's quest ROM)
-		g_bPR7820AudioEnabled[0] = PR7820_FALSE;
-		g_bPR7820AudioEnabled[1] = PR7820_TRUE;
-		pr7820_update_audio();
+		pCtx->state.bAudioEnabled[0] = PR7820_FALSE;
+		pCtx->state.bAudioEnabled[1] = PR7820_TRUE;
+		pr7820_update_audio(pCtx);
 		break;
 	case 0xA3:	// enable both audio channels (see $1CC1 in Thayer's Quest ROM)
-		g_bPR7820AudioEnabled[0] = PR7820_TRUE;
-		g_bPR7820AudioEnabled[1] = PR7820_TRUE;
-		pr7820_update_audio();
+		pCtx->state.bAudioEnabled[0] = PR7820_TRUE;
+		pCtx->state.bAudioEnabled[1] = PR7820_TRUE;
+		pr7820_update_audio(pCtx);
 		break;
 	case 0xE1:	// display off (see $1F30 in Thayer's Quest ROM)
 		// ignored
 		break;
 	case 0xF4:	// Audio 1
-		pr7820_audio1();
+		pr7820_audio1(pCtx);
 		break;
 	case 0xFC:	// Audio 2
-		pr7820_audio2();
+		pr7820_audio2(pCtx);
 		break;
 	case 0xFD:	// Play
-		g_pr7820i_play();
+		PR7820I_CB(pCtx, play)(pCtx->pUser);
 		break;
 	case 0xF7:	// Search
 		{
 			uint32_t uFrame;
-			uFrame = strtoul(pr7820_frame, NULL, 10);	// atoi is not sufficient for AVR because it is only 16-bit signed
-			g_pr7820i_begin_search(uFrame);
-			pr7820_clear();
+			uFrame = ldpin_ascii5_to_u32(pCtx->state.frame);
+			PR7820I_CB(pCtx, begin_search)(pCtx->pUser, uFrame);
+			LDPIN_COUNT_SEARCH_START(pCtx);
+			pr7820_clear(pCtx);
 		}
 		break;
 	case 0xF9:	// reject
 		// ignored
 		break;
 	case 0xFB:	// Stop - this actually just goes into still-frame mode, so we pause
-		g_pr7820i_pause();
+		PR7820I_CB(pCtx, pause)(pCtx->pUser);
 		break;
 
 	case 0xFF:	// no entry
@@ -178,113 +292,135 @@ void pr7820i_write(unsigned char value)
 	case 0xfa:	// slow rev
 	case 0xFE:  // step reverse
 		// unsupported commands
-		g_pr7820i_on_error(PR7820_ERR_UNSUPPORTED_CMD_BYTE, value);
+		PR7820I_ERROR(pCtx, PR7820_ERR_UNSUPPORTED_CMD_BYTE, value);
 		break;
 
 	default:	// Unknown Command
-		g_pr7820i_on_error(PR7820_ERR_UNKNOWN_CMD_BYTE, value);
+		PR7820I_ERROR(pCtx, PR7820_ERR_UNKNOWN_CMD_BYTE, value);
 		break;
 	}
 }
 
 // Adds a digit to the frame array that we will be seeking to.
 // Digit should be in ASCII format
-void pr7820_add_digit(char digit)
+void pr7820_add_digit(PR7820Ctx_t *pCtx, char digit)
 {
 	int count;
 
 	// shift existing digits over to the left
 	for (count = 0; count < PR7820_FRAMESIZE - 1; count++)
 	{
-		if (!pr7820_frame[count + 1])
+		if (!pCtx->state.frame[count + 1])
 		{
-			pr7820_frame[count + 1] = '0';
+			pCtx->state.frame[count + 1] = '0';
 		}
-		pr7820_frame[count] = pr7820_frame[count + 1];
+		pCtx->state.frame[count] = pCtx->state.frame[count + 1];
 	}
-	pr7820_frame[PR7820_FRAMESIZE - 1] = digit;		
+	pCtx->state.frame[PR7820_FRAMESIZE - 1] = digit;		
 }
 
 // Audio channel 1 on or off
-void pr7820_audio1()
+void pr7820_audio1(PR7820Ctx_t *pCtx)
 {
 	// Check if we should just toggle
-	if (!pr7820_frame[PR7820_FRAMESIZE - 1])
+	if (!pCtx->state.frame[PR7820_FRAMESIZE - 1])
 	{
 		// Check status of audio and toggle accordingly
-		if (g_bPR7820AudioEnabled[0])
+		if (pCtx->state.bAudioEnabled[0])
 		{
-			g_bPR7820AudioEnabled[0] = PR7820_FALSE;
-			g_pr7820i_change_audio(0, 0);	// disable left channel
+			pCtx->state.bAudioEnabled[0] = PR7820_FALSE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);	// disable left channel
 		}
 		else
 		{
-			g_bPR7820AudioEnabled[0] = PR7820_TRUE;
-			g_pr7820i_change_audio(0, 1);	// enable left channel
+			pCtx->state.bAudioEnabled[0] = PR7820_TRUE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);	// enable left channel
 		}
 	}
 	// Or if we have an explicit audio command
 	else 
 	{
-		switch (pr7820_frame[PR7820_FRAMESIZE - 1] % 2)
+		switch (pCtx->state.frame[PR7820_FRAMESIZE - 1] % 2)
 		{
 		case 0:
-			g_bPR7820AudioEnabled[0] = PR7820_FALSE;
-			g_pr7820i_change_audio(0, 0);
+			pCtx->state.bAudioEnabled[0] = PR7820_FALSE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 0, 0);
 			break;
 		default:
-			g_bPR7820AudioEnabled[0] = PR7820_TRUE;
-			g_pr7820i_change_audio(0, 1);
+			pCtx->state.bAudioEnabled[0] = PR7820_TRUE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 0, 1);
 			break;
 		}
-		pr7820_clear();
+		pr7820_clear(pCtx);
 	}
 }
 
 // Audio channel 2 on or off
-void pr7820_audio2()
+void pr7820_audio2(PR7820Ctx_t *pCtx)
 {
 	// Check if we should just toggle
-	if (!pr7820_frame[PR7820_FRAMESIZE - 1])
+	if (!pCtx->state.frame[PR7820_FRAMESIZE - 1])
 	{
 		// Check status of audio and toggle accordingly
-		if (g_bPR7820AudioEnabled[1])
+		if (pCtx->state.bAudioEnabled[1])
 		{
-			g_bPR7820AudioEnabled[1] = PR7820_FALSE;
-			g_pr7820i_change_audio(1, 0);
+			pCtx->state.bAudioEnabled[1] = PR7820_FALSE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);
 		}
 		else
 		{
-			g_bPR7820AudioEnabled[1] = PR7820_TRUE;
-			g_pr7820i_change_audio(1, 1);
+			pCtx->state.bAudioEnabled[1] = PR7820_TRUE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1);
 		}
 	}
 	// Or if we have an explicit audio command
 	else 
 	{
-		switch (pr7820_frame[PR7820_FRAMESIZE - 1] % 2)
+		switch (pCtx->state.frame[PR7820_FRAMESIZE - 1] % 2)
 		{
 		case 0:
-			g_bPR7820AudioEnabled[1] = PR7820_FALSE;
-			g_pr7820i_change_audio(1, 0);
+			pCtx->state.bAudioEnabled[1] = PR7820_FALSE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 1, 0);
 			break;
 		default:
-			g_bPR7820AudioEnabled[1] = PR7820_TRUE;
-			g_pr7820i_change_audio(1, 1);
+			pCtx->state.bAudioEnabled[1] = PR7820_TRUE;
+			PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 1, 1);
 			break;
 		}
-		pr7820_clear();
+		pr7820_clear(pCtx);
 	}
 }
 
 // clears any received digits from the frame array
-void pr7820_clear()
+void pr7820_clear(PR7820Ctx_t *pCtx)
+{
+	memset(pCtx->state.frame,0,sizeof(pCtx->state.frame));
+}
+
+void pr7820_update_audio(PR7820Ctx_t *pCtx)
+{
+	PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 0, pCtx->state.bAudioEnabled[0]);
+	PR7820I_CB(pCtx, change_audio)(pCtx->pUser, 1, pCtx->state.bAudioEnabled[1]);
+}
+
+//////////////////////////////////////////
+
+void pr7820i_reset()
 {
-	memset(pr7820_frame,0,sizeof(pr7820_frame));
+	pr7820i_ctx_reset(&g_pr7820i_ctx);
 }
 
-void pr7820_update_audio()
+PR7820_BOOL pr7820i_is_busy()
 {
-	g_pr7820i_change_audio(0, g_bPR7820AudioEnabled[0]);
-	g_pr7820i_change_audio(1, g_bPR7820AudioEnabled[1]);
-}
\ No newline at end of file
+	return pr7820i_ctx_is_busy(&g_pr7820i_ctx);
+}
+
+void pr7820i_write(unsigned char value)
+{
+	pr7820i_ctx_write(&g_pr7820i_ctx, value);
+}
+
+PR7820Ctx_t *pr7820i_get_default_ctx()
+{
+	return &g_pr7820i_ctx;
+}
@@ -1,5 +1,10 @@
 #include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
+#include <string.h>
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // callbacks, must be assigned before calling any other function in this interpreter
 void (*g_pr8210i_play)() = 0;
 void (*g_pr8210i_pause)() = 0;
@@ -14,59 +19,172 @@ void (*g_pr8210i_change_standby)(PR8210_BOOL bRaised) = 0;
 
 /////////////////////////
 
-// so that we know whether incoming message is okay
-uint8_t g_pr8210i_u8OldMsg = ~0, g_pr8210i_u8CurMsg = ~0;
-uint32_t g_pr8210i_u32Frame = 0;
-uint8_t g_pr8210i_u8FrameIdx = 0;
-uint8_t g_pr8210i_u8Audio[2] = { 1, 1 };	// audio starts out enabled
-PR8210_BOOL g_pr8210i_bJumpTriggerRaised = PR8210_TRUE;
-PR8210_BOOL g_pr8210i_bScanCRaised = PR8210_TRUE;
-PR8210_BOOL g_pr8210i_bPlayerBusy = PR8210_FALSE;
-PR8210_BOOL g_pr8210i_bStandByRaised = PR8210_FALSE;
-uint8_t g_pr8210i_u8VsyncCounter = 0;
+// the default context forwards to the global callbacks above
+static void pr8210i_global_play(void *pUser) { (void) pUser; g_pr8210i_play(); }
+static void pr8210i_global_pause(void *pUser) { (void) pUser; g_pr8210i_pause(); }
+static void pr8210i_global_step(void *pUser, int8_t i8TracksToStep) { (void) pUser; g_pr8210i_step(i8TracksToStep); }
+static void pr8210i_global_begin_search(void *pUser, uint32_t uFrameNumber) { (void) pUser; g_pr8210i_begin_search(uFrameNumber); }
+static void pr8210i_global_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable) { (void) pUser; g_pr8210i_change_audio(uChannel, uEnable); }
+static void pr8210i_global_skip(void *pUser, int8_t i8TracksToSkip) { (void) pUser; g_pr8210i_skip(i8TracksToSkip); }
+static void pr8210i_global_change_auto_track_jump(void *pUser, PR8210_BOOL bAutoTrackJumpEnabled) { (void) pUser; g_pr8210i_change_auto_track_jump(bAutoTrackJumpEnabled); }
+static PR8210_BOOL pr8210i_global_is_player_busy(void *pUser) { (void) pUser; return g_pr8210i_is_player_busy(); }
+static void pr8210i_global_change_standby(void *pUser, PR8210_BOOL bRaised) { (void) pUser; g_pr8210i_change_standby(bRaised); }
+static void pr8210i_global_error(void *pUser, PR8210ErrCode_t code, uint16_t u16Val) { (void) pUser; g_pr8210i_error(code, u16Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
 
-// whether jmp trig and scan c are internally defined or externally defined (true means internal)
-PR8210_BOOL g_pr8210i_bInternalMode = PR8210_TRUE;
+static PR8210Ctx_t g_pr8210i_ctx =
+{
+	{
+		(uint8_t) ~0, (uint8_t) ~0,	// u8OldMsg, u8CurMsg
+		0,	// u32Frame
+		0,	// u8FrameIdx
+		{ 1, 1 },	// audio starts out enabled
+		PR8210_TRUE,	// bJumpTriggerRaised
+		PR8210_TRUE,	// bScanCRaised
+		PR8210_FALSE,	// bPlayerBusy
+		PR8210_FALSE,	// bStandByRaised
+		0,	// u8VsyncCounter
+		PR8210_TRUE	// bInternalMode
+	},
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		pr8210i_global_play,
+		pr8210i_global_pause,
+		pr8210i_global_step,
+		pr8210i_global_begin_search,
+		pr8210i_global_change_audio,
+		pr8210i_global_skip,
+		pr8210i_global_change_auto_track_jump,
+		pr8210i_global_is_player_busy,
+		pr8210i_global_change_standby,
+		pr8210i_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
 
-void pr8210i_reset()
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the pr8210i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define PR8210I_CB_FUNC(pCtx, name)	pr8210i_host_##name
+#else
+#define PR8210I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define PR8210I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_PR8210, PR8210Callbacks_t, name, PR8210I_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define PR8210I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_PR8210, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_PR8210, code), PR8210I_CB(pCtx, error)((pCtx)->pUser, code, val))
+
+void pr8210i_ctx_init(PR8210Ctx_t *pCtx, const PR8210Callbacks_t *pCallbacks, void *pUser)
+{
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+	pr8210i_ctx_reset(pCtx);
+}
+
+void pr8210i_ctx_save(const PR8210Ctx_t *pCtx, PR8210Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_PR8210, PR8210_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
+
+PR8210_BOOL pr8210i_ctx_restore(PR8210Ctx_t *pCtx, const PR8210Snapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_PR8210, PR8210_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return PR8210_FALSE;
+	}
+
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return PR8210_TRUE;
+}
+
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t pr8210i_ctx_flight_read(PR8210Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
+{
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
+}
+#endif
+
+void pr8210i_ctx_reset(PR8210Ctx_t *pCtx)
 {
-	g_pr8210i_u8OldMsg = ~0;
-	g_pr8210i_u8CurMsg = ~0;
-	g_pr8210i_u32Frame = 0;
-	g_pr8210i_u8FrameIdx = 0;
-	g_pr8210i_u8Audio[0] = g_pr8210i_u8Audio[1] = 1;	// default to audio being enabled
-	g_pr8210i_bJumpTriggerRaised = PR8210_TRUE;
-	g_pr8210i_bScanCRaised = PR8210_TRUE;
-	g_pr8210i_bInternalMode = PR8210_TRUE;
-	g_pr8210i_bPlayerBusy = PR8210_FALSE;
-	g_pr8210i_bStandByRaised = PR8210_FALSE;
-	g_pr8210i_u8VsyncCounter = 0;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_PR8210, 0);
+	pCtx->state.u8OldMsg = ~0;
+	pCtx->state.u8CurMsg = ~0;
+	pCtx->state.u32Frame = 0;
+	pCtx->state.u8FrameIdx = 0;
+	pCtx->state.u8Audio[0] = pCtx->state.u8Audio[1] = 1;	// default to audio being enabled
+	pCtx->state.bJumpTriggerRaised = PR8210_TRUE;
+	pCtx->state.bScanCRaised = PR8210_TRUE;
+	pCtx->state.bInternalMode = PR8210_TRUE;
+	pCtx->state.bPlayerBusy = PR8210_FALSE;
+	pCtx->state.bStandByRaised = PR8210_FALSE;
+	pCtx->state.u8VsyncCounter = 0;
 }
 
-void pr8210i_add_digit(uint8_t u8Digit)
+void pr8210i_add_digit(PR8210Ctx_t *pCtx, uint8_t u8Digit)
 {
-	if (g_pr8210i_u8FrameIdx < 5)
+	if (pCtx->state.u8FrameIdx < 5)
 	{
-		g_pr8210i_u32Frame *= 10;
-		g_pr8210i_u32Frame += u8Digit;
-		g_pr8210i_u8FrameIdx++;
+		pCtx->state.u32Frame = ldpin_append_digit(pCtx->state.u32Frame, u8Digit);
+		pCtx->state.u8FrameIdx++;
 	}
 
 	// TODO : test this on a real player to see what it does
 	else
 	{
-		g_pr8210i_error(PR8210_ERR_TOO_MANY_DIGITS, 0);
+		PR8210I_ERROR(pCtx, PR8210_ERR_TOO_MANY_DIGITS, 0);
 	}
 }
 
-void pr8210i_write(uint16_t u16Msg)
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t pr8210i_cmd_class(uint8_t u8Cmd)
+{
+	switch (u8Cmd)
+	{
+	case 0x10: case 0x11: case 0x12: case 0x13: case 0x14:
+	case 0x15: case 0x16: case 0x17: case 0x18: case 0x19:
+		return LDPIN_CMD_DIGIT;
+	case 1: case 2: case 3: case 4: case 5: case 6: case 7: case 8: case 9: case 0x0A: case 0xF:
+		return LDPIN_CMD_PLAY;
+	case 0xB:
+		return LDPIN_CMD_SEARCH;
+	case 0xD: case 0xE: case 0x1A:
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
+}
+#endif // LDP_IN_COUNTERS
+
+void pr8210i_ctx_write(PR8210Ctx_t *pCtx, uint16_t u16Msg)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_PR8210, u16Msg);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+
 	uint8_t u8Cmd;
 
 	// test header and footer bits to make sure it complies (MACH3 sends in all 0 bits and we don't want to flag this as an error)
 	if (((u16Msg & 0x307) != 4) && (u16Msg != 0))
 	{
-		g_pr8210i_error(PR8210_ERR_CORRUPT_INPUT, u16Msg);
+		PR8210I_ERROR(pCtx, PR8210_ERR_CORRUPT_INPUT, u16Msg);
 		return;
 	}
 
@@ -74,62 +192,64 @@ void pr8210i_write(uint16_t u16Msg)
 	u8Cmd = u16Msg >> 3;
 
 	// if this is the first time we've seen this command, ignore it since all commands must (apparently) come at least twice to be valid
-	if (u8Cmd != g_pr8210i_u8OldMsg)
+	if (u8Cmd != pCtx->state.u8OldMsg)
 	{
-		g_pr8210i_u8OldMsg = u8Cmd;
-		g_pr8210i_u8CurMsg = ~0;	// TODO : is this necessary?
+		pCtx->state.u8OldMsg = u8Cmd;
+		pCtx->state.u8CurMsg = ~0;	// TODO : is this necessary?
 		return;
 	}
 	// if the command has been received 3 or more times, just ignore it
-	else if (u8Cmd == g_pr8210i_u8CurMsg)
+	else if (u8Cmd == pCtx->state.u8CurMsg)
 	{
 		return;
 	}
 	// else process it
+	LDPIN_COUNT_CMD(pCtx, pr8210i_cmd_class(u8Cmd));
 
 	switch (u8Cmd)
 	{
 	default:	// unknown
-		g_pr8210i_error(PR8210_ERR_UNKNOWN_CMD_BYTE, u8Cmd);
+		PR8210I_ERROR(pCtx, PR8210_ERR_UNKNOWN_CMD_BYTE, u8Cmd);
 		break;
 	case 0:	// filler (aka End Of Command), used by cobra command and cliff hanger, but cobra command does not always send it, so it must remain optional
 		//  nothing to do
 		break;
 	case 4: // step forward
-		g_pr8210i_step(1);
+		PR8210I_CB(pCtx, step)(pCtx->pUser, 1);
 		break;
 	case 5:	// play
-		g_pr8210i_play();
+		PR8210I_CB(pCtx, play)(pCtx->pUser);
 		break;
 	case 9: // step backward
-		g_pr8210i_step(-1);
+		PR8210I_CB(pCtx, step)(pCtx->pUser, -1);
 		break;
 	case 0x0A:	// pause
-		g_pr8210i_pause();
+		PR8210I_CB(pCtx, pause)(pCtx->pUser);
 		break;
 	case 0xB:	// search
 		// If at least one digit has been received, perform a search.
 		// Regardless, always reset buffered frame number and digit count when we receive one of these.
 		// (this may not be authentic behavior, but it seems to be compatible, at least)
 		// This behavior is necessary to support Goal To Go's tendency to not switch to a separate command (ie a non-0xB) between two consecutive seeks.
-		if (g_pr8210i_u8FrameIdx != 0)
+		if (pCtx->state.u8FrameIdx != 0)
 		{
-			g_pr8210i_begin_search(g_pr8210i_u32Frame);
-			g_pr8210i_change_standby(PR8210_TRUE);	// star rider code apparently expects stand by to immediately go high when search starts
-			g_pr8210i_bStandByRaised = PR8210_TRUE;
-			g_pr8210i_bPlayerBusy = PR8210_TRUE;	
-			g_pr8210i_u8VsyncCounter = 0;	// counter used to determine when to blink stand by
+			PR8210I_CB(pCtx, begin_search)(pCtx->pUser, pCtx->state.u32Frame);
+			LDPIN_COUNT_SEARCH_START(pCtx);
+			PR8210I_CB(pCtx, change_standby)(pCtx->pUser, PR8210_TRUE);	// star rider code apparently expects stand by to immediately go high when search starts
+			pCtx->state.bStandByRaised = PR8210_TRUE;
+			pCtx->state.bPlayerBusy = PR8210_TRUE;	
+			pCtx->state.u8VsyncCounter = 0;	// counter used to determine when to blink stand by
 		}
-		g_pr8210i_u32Frame = 0;
-		g_pr8210i_u8FrameIdx = 0;
+		pCtx->state.u32Frame = 0;
+		pCtx->state.u8FrameIdx = 0;
 		break;
 	case 0xD:	// toggle right audio
-		g_pr8210i_u8Audio[1] ^= 1;
-		g_pr8210i_change_audio(1, g_pr8210i_u8Audio[1]);
+		pCtx->state.u8Audio[1] ^= 1;
+		PR8210I_CB(pCtx, change_audio)(pCtx->pUser, 1, pCtx->state.u8Audio[1]);
 		break;
 	case 0xE:	// toggle left audio
-		g_pr8210i_u8Audio[0] ^= 1;
-		g_pr8210i_change_audio(0, g_pr8210i_u8Audio[0]);
+		pCtx->state.u8Audio[0] ^= 1;
+		PR8210I_CB(pCtx, change_audio)(pCtx->pUser, 0, pCtx->state.u8Audio[0]);
 		break;
 	case 0xF:	// reject
 		// ignore
@@ -144,7 +264,7 @@ void pr8210i_write(uint16_t u16Msg)
 	case 0x17:
 	case 0x18:
 	case 0x19:	// 9
-		pr8210i_add_digit(u8Cmd & 0xF);
+		pr8210i_add_digit(pCtx, u8Cmd & 0xF);
 		break;
 	case 1:	// 3X FWD
 	case 2:	// SCAN FWD
@@ -154,30 +274,32 @@ void pr8210i_write(uint16_t u16Msg)
 	case 8:	// SLOW REV
 	case 0xC:	// chapter
 	case 0x1A:	// frame disp
-		g_pr8210i_error(PR8210_ERR_UNSUPPORTED_CMD_BYTE, u8Cmd);
+		PR8210I_ERROR(pCtx, PR8210_ERR_UNSUPPORTED_CMD_BYTE, u8Cmd);
 		break;
 	}
 
 	// allow repeated spamming of the same command (ie only process it once)
-	g_pr8210i_u8CurMsg = u8Cmd;
+	pCtx->state.u8CurMsg = u8Cmd;
 }
 
 // PR-8210A only
-void pr8210i_on_jmp_trigger_changed(PR8210_BOOL bJmpTrigRaised, PR8210_BOOL bScanCRaised)
+void pr8210i_ctx_on_jmp_trigger_changed(PR8210Ctx_t *pCtx, PR8210_BOOL bJmpTrigRaised, PR8210_BOOL bScanCRaised)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_JMP_TRIGGER, LDPIN_TRACE_PR8210, (bJmpTrigRaised ? 1 : 0) | (bScanCRaised ? 2 : 0));
+
 	// cache this for special case of going external while jump trigger is low
-	g_pr8210i_bScanCRaised = bScanCRaised;
+	pCtx->state.bScanCRaised = bScanCRaised;
 
 	// do nothing if this call has no effect
-	if (g_pr8210i_bJumpTriggerRaised == bJmpTrigRaised)
+	if (pCtx->state.bJumpTriggerRaised == bJmpTrigRaised)
 	{
 		return;
 	}
 
-	g_pr8210i_bJumpTriggerRaised = bJmpTrigRaised;
+	pCtx->state.bJumpTriggerRaised = bJmpTrigRaised;
 
 	// only act on this change if PR-8210A is in external mode
-	if (g_pr8210i_bInternalMode)
+	if (pCtx->state.bInternalMode)
 	{
 		return;
 	}
@@ -186,62 +308,103 @@ void pr8210i_on_jmp_trigger_changed(PR8210_BOOL bJmpTrigRaised, PR8210_BOOL bSca
 	if (!bJmpTrigRaised)
 	{
 		int8_t i8TracksToSkip = bScanCRaised ? 1 : -1;	// high means forward, low means backward
-			g_pr8210i_skip(i8TracksToSkip);
+			PR8210I_CB(pCtx, skip)(pCtx->pUser, i8TracksToSkip);
 	}
 	// else jump trigger has gone high (inactive)
 }
 
 // PR-8210A only
-void pr8210i_on_jmptrig_and_scanc_intext_changed(PR8210_BOOL bInternal)
+void pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(PR8210Ctx_t *pCtx, PR8210_BOOL bInternal)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_INTEXT, LDPIN_TRACE_PR8210, bInternal);
+
 	// do nothing if call has no effect
-	if (g_pr8210i_bInternalMode == bInternal)
+	if (pCtx->state.bInternalMode == bInternal)
 	{
 		return;
 	}
 
-	g_pr8210i_bInternalMode = bInternal;
-	g_pr8210i_change_auto_track_jump(bInternal);
+	pCtx->state.bInternalMode = bInternal;
+	PR8210I_CB(pCtx, change_auto_track_jump)(pCtx->pUser, bInternal);
 
 	// edge case: if jump trigger was already low before we were external
-	if (!g_pr8210i_bJumpTriggerRaised)
+	if (!pCtx->state.bJumpTriggerRaised)
 	{
-		g_pr8210i_bJumpTriggerRaised = PR8210_TRUE;	// force jump trigger to be processed
-		pr8210i_on_jmp_trigger_changed(PR8210_FALSE, g_pr8210i_bScanCRaised);
+		pCtx->state.bJumpTriggerRaised = PR8210_TRUE;	// force jump trigger to be processed
+		pr8210i_ctx_on_jmp_trigger_changed(pCtx, PR8210_FALSE, pCtx->state.bScanCRaised);
 	}
 }
 
-void pr8210i_on_vblank()
+void pr8210i_ctx_on_vblank(PR8210Ctx_t *pCtx)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_PR8210, 0);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+
 	// if player has been busy up to this point
-	if (g_pr8210i_bPlayerBusy)
+	if (pCtx->state.bPlayerBusy)
 	{
 		// if player is still busy, check to see whether we need to blink the stand by line
-		if (g_pr8210i_is_player_busy())
+		if (LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_PR8210, PR8210I_CB(pCtx, is_player_busy)(pCtx->pUser)))
 		{
 			// if 13 vsyncs have passed (0-12 index) (~216ms, close to goal of 225ms) blink the stand by
-			if (g_pr8210i_u8VsyncCounter >= 12)
+			if (pCtx->state.u8VsyncCounter >= 12)
 			{
-				g_pr8210i_bStandByRaised ^= PR8210_TRUE;
-				g_pr8210i_change_standby(g_pr8210i_bStandByRaised);
-				g_pr8210i_u8VsyncCounter = 0;
+				pCtx->state.bStandByRaised ^= PR8210_TRUE;
+				PR8210I_CB(pCtx, change_standby)(pCtx->pUser, pCtx->state.bStandByRaised);
+				pCtx->state.u8VsyncCounter = 0;
 			}
 			// else we don't want to pulse stand by yet
 			else
 			{
-				g_pr8210i_u8VsyncCounter++;
+				pCtx->state.u8VsyncCounter++;
 			}
 		}
 		// else player is no longer busy, stand by goes instantly false
 		else
 		{
 			// don't change the stand by if it's already the way we want it
-			if (g_pr8210i_bStandByRaised == PR8210_TRUE)
+			if (pCtx->state.bStandByRaised == PR8210_TRUE)
 			{
-				g_pr8210i_change_standby(PR8210_FALSE);
+				PR8210I_CB(pCtx, change_standby)(pCtx->pUser, PR8210_FALSE);
 			}
-			g_pr8210i_bPlayerBusy = PR8210_FALSE;
+			pCtx->state.bPlayerBusy = PR8210_FALSE;
+			LDPIN_COUNT_SEARCH_DONE(pCtx);
 		}
 	}
 	// else player was not busy
 }
+
+/////////////////////////
+
+void pr8210i_reset()
+{
+	pr8210i_ctx_reset(&g_pr8210i_ctx);
+}
+
+void pr8210i_write(uint16_t u16Msg)
+{
+	pr8210i_ctx_write(&g_pr8210i_ctx, u16Msg);
+}
+
+// PR-8210A only
+void pr8210i_on_jmp_trigger_changed(PR8210_BOOL bJmpTrigRaised, PR8210_BOOL bScanCRaised)
+{
+	pr8210i_ctx_on_jmp_trigger_changed(&g_pr8210i_ctx, bJmpTrigRaised, bScanCRaised);
+}
+
+// PR-8210A only
+void pr8210i_on_jmptrig_and_scanc_intext_changed(PR8210_BOOL bInternal)
+{
+	pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(&g_pr8210i_ctx, bInternal);
+}
+
+void pr8210i_on_vblank()
+{
+	pr8210i_ctx_on_vblank(&g_pr8210i_ctx);
+}
+
+PR8210Ctx_t *pr8210i_get_default_ctx()
+{
+	return &g_pr8210i_ctx;
+}
@@ -0,0 +1,333 @@
+#include <ldp-in/rewind.h>
+#include <string.h>
+
+// Each entry in the log starts with a tag byte:
+//  0-254: a difference from the group's keyframe, whose coded form is this many bytes long
+//  255: a keyframe, followed by the whole snapshot
+// A difference is coded as pairs of counts, each followed by that many bytes to XOR in:
+//  (bytes that are the same, bytes that differ), ...
+// Bytes that are the same at the end aren't coded at all, so a snapshot that matches its keyframe is just the tag byte.
+#define TAG_KEYFRAME 0xFF
+#define MAX_DIFF_LEN 254	// a difference any longer than this is stored as a new keyframe instead
+
+static uint32_t log_pos(const LDPInRewind_t *pRw, uint32_t u32Pos)
+{
+	return (u32Pos >= pRw->u32LogSize) ? (u32Pos - pRw->u32LogSize) : u32Pos;
+}
+
+static uint8_t log_get(const LDPInRewind_t *pRw, uint32_t u32Pos)
+{
+	return pRw->p8Log[log_pos(pRw, u32Pos)];
+}
+
+static void log_put(LDPInRewind_t *pRw, uint32_t u32Pos, uint8_t u8Val)
+{
+	pRw->p8Log[log_pos(pRw, u32Pos)] = u8Val;
+}
+
+static void log_read(const LDPInRewind_t *pRw, uint32_t u32Pos, uint8_t *p8Dst, uint16_t u16Len)
+{
+	uint16_t u;
+
+	for (u = 0; u < u16Len; u++)
+	{
+		p8Dst[u] = log_get(pRw, u32Pos + u);
+	}
+}
+
+static LDPInRewindGroup_t *group(const LDPInRewind_t *pRw, uint16_t u16Idx)
+{
+	uint32_t u32Idx = (uint32_t) pRw->u16FirstGroup + u16Idx;
+
+	if (u32Idx >= pRw->u16MaxGroups)
+	{
+		u32Idx -= pRw->u16MaxGroups;
+	}
+
+	return &pRw->pGroups[u32Idx];
+}
+
+static void drop_oldest_group(LDPInRewind_t *pRw)
+{
+	if (pRw->u16GroupCount > 1)
+	{
+		uint32_t u32NextOffset = group(pRw, 1)->u32Offset;
+		uint32_t u32Freed = (u32NextOffset >= pRw->u32LogStart) ? (u32NextOffset - pRw->u32LogStart) : (u32NextOffset + pRw->u32LogSize - pRw->u32LogStart);
+
+		pRw->u32LogStart = u32NextOffset;
+		pRw->u32LogUsed -= u32Freed;
+		pRw->u16FirstGroup = (uint16_t) (pRw->u16FirstGroup + 1 == pRw->u16MaxGroups ? 0 : pRw->u16FirstGroup + 1);
+		pRw->u16GroupCount--;
+	}
+	else
+	{
+		pRw->u32LogStart = 0;
+		pRw->u32LogUsed = 0;
+		pRw->u16FirstGroup = 0;
+		pRw->u16GroupCount = 0;
+	}
+}
+
+// Codes the XOR of pSnap and the keyframe into p8Dst (MAX_DIFF_LEN bytes).  Returns the length, or -1 if it doesn't fit.
+static int16_t code_diff(const LDPInRewind_t *pRw, const uint8_t *p8Snap, uint8_t *p8Dst)
+{
+	const uint8_t *p8Key = pRw->p8Key;
+	uint16_t u16Size = pRw->u16SnapSize;
+	uint16_t i = 0;
+	int16_t i16Len = 0;
+
+	for (;;)
+	{
+		uint8_t u8Same = 0;
+		uint8_t u8Diff = 0;
+		uint16_t u16DiffStart;
+
+		while ((i < u16Size) && (p8Snap[i] == p8Key[i]) && (u8Same < 255))
+		{
+			u8Same++;
+			i++;
+		}
+
+		// the rest is the same
+		if (i == u16Size)
+		{
+			break;
+		}
+
+		u16DiffStart = i;
+		while ((i < u16Size) && (p8Snap[i] != p8Key[i]) && (u8Diff < 255))
+		{
+			u8Diff++;
+			i++;
+		}
+
+		if (i16Len + 2 + u8Diff > MAX_DIFF_LEN)
+		{
+			return -1;
+		}
+
+		p8Dst[i16Len++] = u8Same;
+		p8Dst[i16Len++] = u8Diff;
+		while (u16DiffStart < i)
+		{
+			p8Dst[i16Len++] = p8Snap[u16DiffStart] ^ p8Key[u16DiffStart];
+			u16DiffStart++;
+		}
+	}
+
+	return i16Len;
+}
+
+// applies the coded difference at u32Pos (u8Len bytes) to p8Dst, which holds the keyframe
+static void apply_diff(const LDPInRewind_t *pRw, uint32_t u32Pos, uint8_t u8Len, uint8_t *p8Dst)
+{
+	uint32_t u32End = u32Pos + u8Len;
+	uint16_t i = 0;
+
+	while (u32Pos < u32End)
+	{
+		uint8_t u8Diff;
+
+		i += log_get(pRw, u32Pos++);
+		u8Diff = log_get(pRw, u32Pos++);
+		while (u8Diff--)
+		{
+			p8Dst[i++] ^= log_get(pRw, u32Pos++);
+		}
+	}
+}
+
+// finds the group holding snapshot u32Num (which must be held)
+static uint16_t find_group(const LDPInRewind_t *pRw, uint32_t u32Num)
+{
+	uint16_t u16Idx = (uint16_t) (pRw->u16GroupCount - 1);
+
+	while (group(pRw, u16Idx)->u32First > u32Num)
+	{
+		u16Idx--;
+	}
+
+	return u16Idx;
+}
+
+static void push_keyframe(LDPInRewind_t *pRw, const uint8_t *p8Snap)
+{
+	uint32_t u32Need = 1 + (uint32_t) pRw->u16SnapSize;
+	uint32_t u32Pos;
+	LDPInRewindGroup_t *pGroup;
+	uint16_t u;
+
+	while ((pRw->u16GroupCount != 0) && ((pRw->u32LogSize - pRw->u32LogUsed < u32Need) || (pRw->u16GroupCount == pRw->u16MaxGroups)))
+	{
+		drop_oldest_group(pRw);
+	}
+
+	u32Pos = log_pos(pRw, pRw->u32LogStart + pRw->u32LogUsed);
+	log_put(pRw, u32Pos, TAG_KEYFRAME);
+	for (u = 0; u < pRw->u16SnapSize; u++)
+	{
+		log_put(pRw, u32Pos + 1 + u, p8Snap[u]);
+	}
+	pRw->u32LogUsed += u32Need;
+
+	pRw->u16GroupCount++;
+	pGroup = group(pRw, (uint16_t) (pRw->u16GroupCount - 1));
+	pGroup->u32Offset = u32Pos;
+	pGroup->u32First = pRw->u32Next;
+	pGroup->u16Count = 1;
+
+	memcpy(pRw->p8Key, p8Snap, pRw->u16SnapSize);
+}
+
+uint8_t ldpin_rewind_init(LDPInRewind_t *pRw, void *pMem, uint32_t u32MemSize, uint16_t u16SnapSize, uint16_t u16KeyInterval, uint32_t u32First)
+{
+	uint32_t u32Groups;
+	uint32_t u32KeyBytes = 1 + (uint32_t) u16SnapSize;
+
+	if ((u16SnapSize == 0) || (u16KeyInterval == 0) || (u32MemSize < u16SnapSize + 2 * (u32KeyBytes + sizeof(LDPInRewindGroup_t))))
+	{
+		return 0;
+	}
+
+	// every group holds at least a keyframe, so there can't be more groups than this
+	u32Groups = (u32MemSize - u16SnapSize) / (u32KeyBytes + sizeof(LDPInRewindGroup_t));
+	if (u32Groups > 0xFFFF)
+	{
+		u32Groups = 0xFFFF;
+	}
+
+	pRw->pGroups = (LDPInRewindGroup_t *) pMem;
+	pRw->u16MaxGroups = (uint16_t) u32Groups;
+	pRw->p8Key = (uint8_t *) pMem + u32Groups * sizeof(LDPInRewindGroup_t);
+	pRw->p8Log = pRw->p8Key + u16SnapSize;
+	pRw->u32LogSize = u32MemSize - (uint32_t) (pRw->p8Log - (uint8_t *) pMem);
+	pRw->u32LogStart = 0;
+	pRw->u32LogUsed = 0;
+	pRw->u16FirstGroup = 0;
+	pRw->u16GroupCount = 0;
+	pRw->u16SnapSize = u16SnapSize;
+	pRw->u16KeyInterval = u16KeyInterval;
+	pRw->u32Next = u32First;
+
+	return 1;
+}
+
+void ldpin_rewind_push(LDPInRewind_t *pRw, const void *pSnap)
+{
+	const uint8_t *p8Snap = (const uint8_t *) pSnap;
+	uint8_t au8Diff[MAX_DIFF_LEN];
+	int16_t i16Len = -1;
+
+	if ((pRw->u16GroupCount != 0) && (group(pRw, (uint16_t) (pRw->u16GroupCount - 1))->u16Count < pRw->u16KeyInterval))
+	{
+		i16Len = code_diff(pRw, p8Snap, au8Diff);
+	}
+
+	// make room, unless that would mean dropping the keyframe that this snapshot depends on
+	if (i16Len >= 0)
+	{
+		while ((pRw->u32LogSize - pRw->u32LogUsed < (uint32_t) (1 + i16Len)) && (pRw->u16GroupCount > 1))
+		{
+			drop_oldest_group(pRw);
+		}
+		if (pRw->u32LogSize - pRw->u32LogUsed < (uint32_t) (1 + i16Len))
+		{
+			i16Len = -1;
+		}
+	}
+
+	if (i16Len >= 0)
+	{
+		uint32_t u32Pos = pRw->u32LogStart + pRw->u32LogUsed;
+		int16_t i;
+
+		log_put(pRw, u32Pos, (uint8_t) i16Len);
+		for (i = 0; i < i16Len; i++)
+		{
+			log_put(pRw, u32Pos + 1 + i, au8Diff[i]);
+		}
+		pRw->u32LogUsed += 1 + i16Len;
+		group(pRw, (uint16_t) (pRw->u16GroupCount - 1))->u16Count++;
+	}
+	else
+	{
+		push_keyframe(pRw, p8Snap);
+	}
+
+	pRw->u32Next++;
+}
+
+uint32_t ldpin_rewind_oldest(const LDPInRewind_t *pRw)
+{
+	return (pRw->u16GroupCount != 0) ? group(pRw, 0)->u32First : pRw->u32Next;
+}
+
+uint32_t ldpin_rewind_next(const LDPInRewind_t *pRw)
+{
+	return pRw->u32Next;
+}
+
+// decodes snapshot u32Num (which must be held) of group u16Group into p8Dst, and returns where its entry ends in the log
+static uint32_t decode(const LDPInRewind_t *pRw, uint16_t u16Group, uint32_t u32Num, uint8_t *p8Dst)
+{
+	const LDPInRewindGroup_t *pGroup = group(pRw, u16Group);
+	uint32_t u32Pos = pGroup->u32Offset + 1;
+	uint32_t u32Skip = u32Num - pGroup->u32First;
+
+	log_read(pRw, u32Pos, p8Dst, pRw->u16SnapSize);
+	u32Pos += pRw->u16SnapSize;
+
+	while (u32Skip--)
+	{
+		uint8_t u8Len = log_get(pRw, u32Pos);
+
+		if (u32Skip == 0)
+		{
+			apply_diff(pRw, u32Pos + 1, u8Len, p8Dst);
+		}
+		u32Pos += 1 + u8Len;
+	}
+
+	return log_pos(pRw, u32Pos);
+}
+
+uint8_t ldpin_rewind_get(const LDPInRewind_t *pRw, uint32_t u32Num, void *pDst)
+{
+	if ((u32Num < ldpin_rewind_oldest(pRw)) || (u32Num >= pRw->u32Next))
+	{
+		return 0;
+	}
+
+	decode(pRw, find_group(pRw, u32Num), u32Num, (uint8_t *) pDst);
+	return 1;
+}
+
+uint8_t ldpin_rewind_to(LDPInRewind_t *pRw, uint32_t u32Num, void *pDst)
+{
+	uint16_t u16Group;
+	uint32_t u32End;
+	LDPInRewindGroup_t *pGroup;
+
+	if ((u32Num < ldpin_rewind_oldest(pRw)) || (u32Num >= pRw->u32Next))
+	{
+		return 0;
+	}
+
+	u16Group = find_group(pRw, u32Num);
+	u32End = decode(pRw, u16Group, u32Num, (uint8_t *) pDst);
+
+	// forget everything after u32Num
+	pGroup = group(pRw, u16Group);
+	pGroup->u16Count = (uint16_t) (u32Num - pGroup->u32First + 1);
+	pRw->u16GroupCount = (uint16_t) (u16Group + 1);
+	pRw->u32LogUsed = (u32End > pRw->u32LogStart) ? (u32End - pRw->u32LogStart) : (u32End + pRw->u32LogSize - pRw->u32LogStart);	// equal when the log is full
+	pRw->u32Next = u32Num + 1;
+	log_read(pRw, pGroup->u32Offset + 1, pRw->p8Key, pRw->u16SnapSize);
+
+	return 1;
+}
+
+uint32_t ldpin_rewind_bytes_used(const LDPInRewind_t *pRw)
+{
+	return pRw->u32LogUsed;
+}
@@ -0,0 +1,141 @@
+#include <ldp-in/ring.h>
+
+// Keeps the compiler from moving the buffer access to the other side of the index update.
+// (the index is volatile but the buffer isn't, so without this the interrupt side could see the new index before the data)
+#if defined(__GNUC__)
+#define LDP_IN_RING_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LDP_IN_RING_BARRIER()	_ReadWriteBarrier()
+#else
+#define LDP_IN_RING_BARRIER()
+#endif
+
+void ldpin_ring8_reset(LDPInRing8_t *pRing)
+{
+	pRing->u8Head = pRing->u8Tail = 0;
+	pRing->u8Overflows = 0;
+}
+
+uint8_t ldpin_ring8_count(const LDPInRing8_t *pRing)
+{
+	return (uint8_t) (pRing->u8Head - pRing->u8Tail);
+}
+
+uint8_t ldpin_ring8_push(LDPInRing8_t *pRing, uint8_t u8Val)
+{
+	uint8_t u8Head = pRing->u8Head;
+
+	if ((uint8_t) (u8Head - pRing->u8Tail) == LDP_IN_RING_SIZE)
+	{
+		if (pRing->u8Overflows != 0xFF) pRing->u8Overflows++;
+		return 0;
+	}
+
+	pRing->buf[u8Head & LDP_IN_RING_MASK] = u8Val;
+	LDP_IN_RING_BARRIER();
+	pRing->u8Head = u8Head + 1;
+	return 1;
+}
+
+uint8_t ldpin_ring8_push_n(LDPInRing8_t *pRing, const uint8_t *p8Src, uint8_t u8Len)
+{
+	uint8_t u8Head = pRing->u8Head;
+	uint8_t u8Free = (uint8_t) (LDP_IN_RING_SIZE - (uint8_t) (u8Head - pRing->u8Tail));
+	uint8_t u8Count = (u8Len < u8Free) ? u8Len : u8Free;
+	uint8_t u8Dropped = (uint8_t) (u8Len - u8Count);
+	uint8_t u;
+
+	for (u = 0; u < u8Count; u++)
+	{
+		pRing->buf[(uint8_t) (u8Head + u) & LDP_IN_RING_MASK] = p8Src[u];
+	}
+	LDP_IN_RING_BARRIER();
+	pRing->u8Head = (uint8_t) (u8Head + u8Count);
+
+	for (; (u8Dropped != 0) && (pRing->u8Overflows != 0xFF); u8Dropped--)
+	{
+		pRing->u8Overflows++;
+	}
+
+	return u8Count;
+}
+
+uint8_t ldpin_ring8_pop(LDPInRing8_t *pRing)
+{
+	uint8_t u8Tail = pRing->u8Tail;
+	uint8_t u8Res = pRing->buf[u8Tail & LDP_IN_RING_MASK];
+	LDP_IN_RING_BARRIER();
+	pRing->u8Tail = u8Tail + 1;
+	return u8Res;
+}
+
+const uint8_t *ldpin_ring8_peek(const LDPInRing8_t *pRing, uint8_t *pu8Count)
+{
+	uint8_t u8Idx = pRing->u8Tail & LDP_IN_RING_MASK;
+	uint8_t u8Count = (uint8_t) (pRing->u8Head - pRing->u8Tail);
+	uint8_t u8UntilWrap = LDP_IN_RING_SIZE - u8Idx;
+
+	*pu8Count = (u8Count < u8UntilWrap) ? u8Count : u8UntilWrap;
+	return &pRing->buf[u8Idx];
+}
+
+void ldpin_ring8_commit(LDPInRing8_t *pRing, uint8_t u8Count)
+{
+	LDP_IN_RING_BARRIER();
+	pRing->u8Tail += u8Count;
+}
+
+//////////////////////////////////////////////////////////////
+
+void ldpin_ring16_reset(LDPInRing16_t *pRing)
+{
+	pRing->u8Head = pRing->u8Tail = 0;
+	pRing->u8Overflows = 0;
+}
+
+uint8_t ldpin_ring16_count(const LDPInRing16_t *pRing)
+{
+	return (uint8_t) (pRing->u8Head - pRing->u8Tail);
+}
+
+uint8_t ldpin_ring16_push(LDPInRing16_t *pRing, uint16_t u16Val)
+{
+	uint8_t u8Head = pRing->u8Head;
+
+	if ((uint8_t) (u8Head - pRing->u8Tail) == LDP_IN_RING_SIZE)
+	{
+		if (pRing->u8Overflows != 0xFF) pRing->u8Overflows++;
+		return 0;
+	}
+
+	pRing->buf[u8Head & LDP_IN_RING_MASK] = u16Val;
+	LDP_IN_RING_BARRIER();
+	pRing->u8Head = u8Head + 1;
+	return 1;
+}
+
+uint16_t ldpin_ring16_pop(LDPInRing16_t *pRing)
+{
+	uint8_t u8Tail = pRing->u8Tail;
+	uint16_t u16Res = pRing->buf[u8Tail & LDP_IN_RING_MASK];
+	LDP_IN_RING_BARRIER();
+	pRing->u8Tail = u8Tail + 1;
+	return u16Res;
+}
+
+const uint16_t *ldpin_ring16_peek(const LDPInRing16_t *pRing, uint8_t *pu8Count)
+{
+	uint8_t u8Idx = pRing->u8Tail & LDP_IN_RING_MASK;
+	uint8_t u8Count = (uint8_t) (pRing->u8Head - pRing->u8Tail);
+	uint8_t u8UntilWrap = LDP_IN_RING_SIZE - u8Idx;
+
+	*pu8Count = (u8Count < u8UntilWrap) ? u8Count : u8UntilWrap;
+	return &pRing->buf[u8Idx];
+}
+
+void ldpin_ring16_commit(LDPInRing16_t *pRing, uint8_t u8Count)
+{
+	LDP_IN_RING_BARRIER();
+	pRing->u8Tail += u8Count;
+}
@@ -0,0 +1,13 @@
+#include <ldp-in/snapshot.h>
+
+void ldpin_snapshot_header_init(LDPInSnapshotHeader_t *pHdr, uint8_t u8Interp, uint8_t u8Version, uint16_t u16Size)
+{
+	pHdr->u8Interp = u8Interp;
+	pHdr->u8Version = u8Version;
+	pHdr->u16Size = u16Size;
+}
+
+uint8_t ldpin_snapshot_header_check(const LDPInSnapshotHeader_t *pHdr, uint8_t u8Interp, uint8_t u8Version, uint16_t u16Size)
+{
+	return (pHdr->u8Interp == u8Interp) && (pHdr->u8Version == u8Version) && (pHdr->u16Size == u16Size);
+}
@@ -0,0 +1,441 @@
+#include <ldp-in/state-hash.h>
+#include <ldp-in/ring.h>
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <stddef.h>
+#include <string.h>
+
+#define FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FNV_PRIME 0x100000001B3ULL
+
+static const uint8_t g_au8HashStreamMagic[4] = { 'L', 'D', 'P', 'H' };
+
+// where a field's bytes go: into the hash, and into p8Dst if it isn't null
+typedef struct
+{
+	uint64_t u64Hash;
+	uint8_t *p8Dst;
+	uint16_t u16Len;
+} FieldSink_t;
+
+static void sink_byte(FieldSink_t *pSink, uint8_t u8Val)
+{
+	pSink->u64Hash = (pSink->u64Hash ^ u8Val) * FNV_PRIME;
+	if (pSink->p8Dst)
+	{
+		pSink->p8Dst[pSink->u16Len] = u8Val;
+	}
+	pSink->u16Len++;
+}
+
+static void sink_u32(FieldSink_t *pSink, uint32_t u32Val)
+{
+	sink_byte(pSink, (uint8_t) u32Val);
+	sink_byte(pSink, (uint8_t) (u32Val >> 8));
+	sink_byte(pSink, (uint8_t) (u32Val >> 16));
+	sink_byte(pSink, (uint8_t) (u32Val >> 24));
+}
+
+static uint32_t read_uint(const uint8_t *p8Src, uint8_t u8Size)
+{
+	uint16_t u16;
+	uint32_t u32;
+
+	switch (u8Size)
+	{
+	case 1:
+		return *p8Src;
+	case 2:
+		memcpy(&u16, p8Src, sizeof(u16));
+		return u16;
+	default:
+		memcpy(&u32, p8Src, sizeof(u32));
+		return u32;
+	}
+}
+
+static void field_walk(const uint8_t *p8State, const LDPInStateField_t *pField, FieldSink_t *pSink)
+{
+	const uint8_t *p8Field = p8State + pField->u16Offset;
+	uint8_t u8Count;
+	uint8_t u8Idx;
+	uint16_t u;
+
+	switch (pField->u8Kind)
+	{
+	case LDPIN_FIELD_UINT:
+		sink_u32(pSink, read_uint(p8Field, pField->u8Size));
+		break;
+	case LDPIN_FIELD_BYTES:
+		for (u = 0; u < pField->u8Size; u++)
+		{
+			sink_byte(pSink, p8Field[u]);
+		}
+		break;
+	case LDPIN_FIELD_RING8:
+		{
+			const LDPInRing8_t *pRing = (const LDPInRing8_t *) p8Field;
+			uint8_t u8Tail = pRing->u8Tail;
+
+			u8Count = ldpin_ring8_count(pRing);
+			sink_byte(pSink, u8Count);
+			for (u = 0; u < u8Count; u++)
+			{
+				sink_byte(pSink, pRing->buf[(u8Tail + u) & LDP_IN_RING_MASK]);
+			}
+			sink_byte(pSink, pRing->u8Overflows);
+		}
+		break;
+	case LDPIN_FIELD_RING16:
+		{
+			const LDPInRing16_t *pRing = (const LDPInRing16_t *) p8Field;
+			uint8_t u8Tail = pRing->u8Tail;
+
+			u8Count = ldpin_ring16_count(pRing);
+			sink_byte(pSink, u8Count);
+			for (u = 0; u < u8Count; u++)
+			{
+				uint16_t u16Val = pRing->buf[(u8Tail + u) & LDP_IN_RING_MASK];
+				sink_byte(pSink, (uint8_t) u16Val);
+				sink_byte(pSink, (uint8_t) (u16Val >> 8));
+			}
+			sink_byte(pSink, pRing->u8Overflows);
+		}
+		break;
+	case LDPIN_FIELD_QUEUE:
+		u8Count = p8State[pField->u16CountOffset];
+		u8Idx = p8State[pField->u16IdxOffset];
+		if (u8Idx >= pField->u8Size)
+		{
+			u8Idx = 0;	// only in a corrupt snapshot
+		}
+		sink_byte(pSink, u8Count);
+		for (u = 0; (u < u8Count) && (u < pField->u8Size); u++)
+		{
+			sink_byte(pSink, p8Field[u8Idx]);
+			u8Idx++;
+			if (u8Idx >= pField->u8Size)
+			{
+				u8Idx = 0;
+			}
+		}
+		break;
+	default:	// LDPIN_FIELD_PREFIX
+		u8Count = p8State[pField->u16CountOffset];
+		sink_byte(pSink, u8Count);
+		for (u = 0; (u < u8Count) && (u < pField->u8Size); u++)
+		{
+			sink_byte(pSink, p8Field[u]);
+		}
+		break;
+	}
+}
+
+uint64_t ldpin_state_hash(const void *pState, const LDPInStateField_t *pFields, uint8_t u8FieldCount)
+{
+	FieldSink_t sink;
+	uint8_t u;
+
+	sink.u64Hash = FNV_OFFSET_BASIS;
+	sink.p8Dst = 0;
+	sink.u16Len = 0;
+
+	for (u = 0; u < u8FieldCount; u++)
+	{
+		field_walk((const uint8_t *) pState, &pFields[u], &sink);
+	}
+
+	return sink.u64Hash;
+}
+
+uint16_t ldpin_state_field_value(const void *pState, const LDPInStateField_t *pField, uint8_t *p8Dst)
+{
+	FieldSink_t sink;
+
+	sink.u64Hash = FNV_OFFSET_BASIS;
+	sink.p8Dst = p8Dst;
+	sink.u16Len = 0;
+	field_walk((const uint8_t *) pState, pField, &sink);
+
+	return sink.u16Len;
+}
+
+/////////////////////////////////////////////////////////////////
+
+static void put_le(uint8_t *p8Dst, uint64_t u64Val, uint8_t u8Len)
+{
+	uint8_t u;
+
+	for (u = 0; u < u8Len; u++)
+	{
+		p8Dst[u] = (uint8_t) (u64Val >> (u * 8));
+	}
+}
+
+static uint64_t get_le(const uint8_t *p8Src, uint8_t u8Len)
+{
+	uint64_t u64Val = 0;
+	uint8_t u;
+
+	for (u = 0; u < u8Len; u++)
+	{
+		u64Val |= ((uint64_t) p8Src[u]) << (u * 8);
+	}
+
+	return u64Val;
+}
+
+void ldpin_hashstream_write_header(uint8_t *p8Dst, uint8_t u8Interp, uint16_t u16SnapSize)
+{
+	memcpy(p8Dst, g_au8HashStreamMagic, sizeof(g_au8HashStreamMagic));
+	p8Dst[4] = LDPIN_HASHSTREAM_VERSION;
+	p8Dst[5] = u8Interp;
+	put_le(p8Dst + 6, u16SnapSize, 2);
+}
+
+uint8_t ldpin_hashstream_read_header(const uint8_t *p8Src, uint32_t u32Len, uint8_t *pu8Interp, uint16_t *pu16SnapSize)
+{
+	if ((u32Len < LDPIN_HASHSTREAM_HEADER_SIZE) || (memcmp(p8Src, g_au8HashStreamMagic, sizeof(g_au8HashStreamMagic)) != 0) ||
+		(p8Src[4] != LDPIN_HASHSTREAM_VERSION))
+	{
+		return 0;
+	}
+
+	*pu8Interp = p8Src[5];
+	*pu16SnapSize = (uint16_t) get_le(p8Src + 6, 2);
+	return 1;
+}
+
+uint16_t ldpin_hashstream_write_record(uint8_t *p8Dst, uint32_t u32VBlank, uint64_t u64Hash, const void *pSnap, uint16_t u16SnapSize)
+{
+	put_le(p8Dst, u32VBlank, 4);
+	put_le(p8Dst + 4, u64Hash, 8);
+	if (u16SnapSize != 0)
+	{
+		memcpy(p8Dst + LDPIN_HASHSTREAM_RECORD_SIZE, pSnap, u16SnapSize);
+	}
+
+	return (uint16_t) (LDPIN_HASHSTREAM_RECORD_SIZE + u16SnapSize);
+}
+
+void ldpin_hashstream_read_record(const uint8_t *p8Src, uint32_t *pu32VBlank, uint64_t *pu64Hash)
+{
+	*pu32VBlank = (uint32_t) get_le(p8Src, 4);
+	*pu64Hash = get_le(p8Src + 4, 8);
+}
+
+/////////////////////////////////////////////////////////////////
+// Each interpreter's field table.  Every member of its <X>CtxState_t must be covered here (or, like the end index of a circular
+//  buffer, follow from what is), or desyncs in it would go unnoticed.  The state_hash_covers_* tests check that every byte of each
+//  state is in exactly one field, apart from those indices and the padding the tests expect.
+
+#define FIELD_SIZE(type, member) sizeof(((type *) 0)->member)
+#define FIELD(type, member, kind) { #member, offsetof(type, member), FIELD_SIZE(type, member), kind, 0, 0 }
+#define FIELD_UINT(type, member) FIELD(type, member, LDPIN_FIELD_UINT)
+#define FIELD_BYTES(type, member) FIELD(type, member, LDPIN_FIELD_BYTES)
+#define FIELD_QUEUE(type, member, idx, count) { #member, offsetof(type, member), FIELD_SIZE(type, member), LDPIN_FIELD_QUEUE, offsetof(type, idx), offsetof(type, count) }
+#define FIELD_PREFIX(type, member, count) { #member, offsetof(type, member), FIELD_SIZE(type, member), LDPIN_FIELD_PREFIX, 0, offsetof(type, count) }
+#define FIELD_FRAME_CACHE(type, member) FIELD_UINT(type, member.u32Frame), FIELD_BYTES(type, member.au8Ascii), FIELD_UINT(type, member.u8Valid)
+
+#define FIELD_COUNT(table) ((uint8_t) (sizeof(table) / sizeof(table[0])))
+
+static const LDPInStateField_t g_ldv1000Fields[] =
+{
+	FIELD(LDV1000CtxState_t, tx, LDPIN_FIELD_RING8),
+	FIELD_UINT(LDV1000CtxState_t, autostop_frame),
+	FIELD_UINT(LDV1000CtxState_t, audio1),
+	FIELD_UINT(LDV1000CtxState_t, audio2),
+	FIELD_UINT(LDV1000CtxState_t, audio_temp_mute),
+	FIELD_BYTES(LDV1000CtxState_t, frame),
+	FIELD_UINT(LDV1000CtxState_t, output),
+	FIELD_UINT(LDV1000CtxState_t, search_pending),
+	FIELD_UINT(LDV1000CtxState_t, discswitch_state),
+	FIELD_UINT(LDV1000CtxState_t, discswitch_pending),
+	FIELD_UINT(LDV1000CtxState_t, search_delay_iterations),
+	FIELD_UINT(LDV1000CtxState_t, emulation_type),
+	FIELD_FRAME_CACHE(LDV1000CtxState_t, frame_cache),
+	FIELD_UINT(LDV1000CtxState_t, status_notified),
+	FIELD_UINT(LDV1000CtxState_t, notified_status),
+	FIELD_UINT(LDV1000CtxState_t, read_cached),
+	FIELD_UINT(LDV1000CtxState_t, read_cache),
+};
+
+const LDPInStateField_t *ldv1000i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_ldv1000Fields);
+	return g_ldv1000Fields;
+}
+
+uint64_t ldv1000i_ctx_hash(const LDV1000Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_ldv1000Fields, FIELD_COUNT(g_ldv1000Fields));
+}
+
+static const LDPInStateField_t g_ldp1000Fields[] =
+{
+	FIELD_UINT(LDP1000CtxState_t, type),
+	FIELD_UINT(LDP1000CtxState_t, state),
+	FIELD(LDP1000CtxState_t, tx, LDPIN_FIELD_RING16),
+	FIELD_UINT(LDP1000CtxState_t, u32Frame),
+	FIELD_UINT(LDP1000CtxState_t, u8FrameIdx),
+	FIELD_UINT(LDP1000CtxState_t, u8Idx),
+	FIELD_UINT(LDP1000CtxState_t, directionIsReversed),
+	FIELD_UINT(LDP1000CtxState_t, bSearchActive),
+	FIELD_UINT(LDP1000CtxState_t, bRepeatActive),
+	FIELD_UINT(LDP1000CtxState_t, u32RepeatStartFrame),
+	FIELD_UINT(LDP1000CtxState_t, u32RepeatEndFrame),
+	FIELD_UINT(LDP1000CtxState_t, u8RepeatIterations),
+	FIELD_UINT(LDP1000CtxState_t, UIC_Input_Active),
+	FIELD_UINT(LDP1000CtxState_t, u8UICFunction),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_X),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_Y),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_Mode),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_Window),
+	FIELD_UINT(LDP1000CtxState_t, bUI_Enabled),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_StartIdx),
+	FIELD_BYTES(LDP1000CtxState_t, UIC_TextBuf),
+	FIELD_UINT(LDP1000CtxState_t, u8UIC_PendingNotifications),
+	FIELD_FRAME_CACHE(LDP1000CtxState_t, frameCache),
+};
+
+const LDPInStateField_t *ldp1000i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_ldp1000Fields);
+	return g_ldp1000Fields;
+}
+
+uint64_t ldp1000i_ctx_hash(const LDP1000Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_ldp1000Fields, FIELD_COUNT(g_ldp1000Fields));
+}
+
+static const LDPInStateField_t g_pr7820Fields[] =
+{
+	FIELD_UINT(PR7820CtxState_t, bAudioEnabled[0]),
+	FIELD_UINT(PR7820CtxState_t, bAudioEnabled[1]),
+	FIELD_BYTES(PR7820CtxState_t, frame),
+};
+
+const LDPInStateField_t *pr7820i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_pr7820Fields);
+	return g_pr7820Fields;
+}
+
+uint64_t pr7820i_ctx_hash(const PR7820Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_pr7820Fields, FIELD_COUNT(g_pr7820Fields));
+}
+
+static const LDPInStateField_t g_pr8210Fields[] =
+{
+	FIELD_UINT(PR8210CtxState_t, u8OldMsg),
+	FIELD_UINT(PR8210CtxState_t, u8CurMsg),
+	FIELD_UINT(PR8210CtxState_t, u32Frame),
+	FIELD_UINT(PR8210CtxState_t, u8FrameIdx),
+	FIELD_BYTES(PR8210CtxState_t, u8Audio),
+	FIELD_UINT(PR8210CtxState_t, bJumpTriggerRaised),
+	FIELD_UINT(PR8210CtxState_t, bScanCRaised),
+	FIELD_UINT(PR8210CtxState_t, bPlayerBusy),
+	FIELD_UINT(PR8210CtxState_t, bStandByRaised),
+	FIELD_UINT(PR8210CtxState_t, u8VsyncCounter),
+	FIELD_UINT(PR8210CtxState_t, bInternalMode),
+};
+
+const LDPInStateField_t *pr8210i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_pr8210Fields);
+	return g_pr8210Fields;
+}
+
+uint64_t pr8210i_ctx_hash(const PR8210Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_pr8210Fields, FIELD_COUNT(g_pr8210Fields));
+}
+
+static const LDPInStateField_t g_vip9500sgFields[] =
+{
+	FIELD_UINT(VIP9500SGCtxState_t, state),
+	FIELD_UINT(VIP9500SGCtxState_t, waitingForPicNum),
+	FIELD(VIP9500SGCtxState_t, tx, LDPIN_FIELD_RING8),
+	FIELD_QUEUE(VIP9500SGCtxState_t, num_buf, u8NumBufStart, u8NumBufCount),
+	FIELD_UINT(VIP9500SGCtxState_t, u32Frame),
+	FIELD_UINT(VIP9500SGCtxState_t, u8Idx),
+	FIELD_UINT(VIP9500SGCtxState_t, u8LastCmdByte),
+	FIELD_FRAME_CACHE(VIP9500SGCtxState_t, frameCache),
+};
+
+const LDPInStateField_t *vip9500sgi_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_vip9500sgFields);
+	return g_vip9500sgFields;
+}
+
+uint64_t vip9500sgi_ctx_hash(const VIP9500SGCtx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_vip9500sgFields, FIELD_COUNT(g_vip9500sgFields));
+}
+
+// the VP931 interpreter keeps no state of its own
+const LDPInStateField_t *vp931i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = 0;
+	return 0;
+}
+
+uint64_t vp931i_ctx_hash(const VP931Ctx_t *pCtx)
+{
+	(void) pCtx;
+	return ldpin_state_hash(0, 0, 0);
+}
+
+static const LDPInStateField_t g_vp932Fields[] =
+{
+	FIELD_UINT(VP932CtxState_t, state),
+	FIELD_UINT(VP932CtxState_t, play_after_search),
+	FIELD(VP932CtxState_t, tx, LDPIN_FIELD_RING8),
+	FIELD_UINT(VP932CtxState_t, u16LastFrameNumberSearched),
+	FIELD_PREFIX(VP932CtxState_t, rx_buf, rx_buf_idx),
+};
+
+const LDPInStateField_t *vp932i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_vp932Fields);
+	return g_vp932Fields;
+}
+
+uint64_t vp932i_ctx_hash(const VP932Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_vp932Fields, FIELD_COUNT(g_vp932Fields));
+}
+
+static const LDPInStateField_t g_ld700Fields[] =
+{
+	FIELD_UINT(LD700CtxState_t, cmd_state),
+	FIELD_UINT(LD700CtxState_t, state),
+	FIELD_QUEUE(LD700CtxState_t, numBuf, u8NumBufStart, u8NumBufCount),
+	FIELD_UINT(LD700CtxState_t, u8CmdTimeoutVsyncCounter),
+	FIELD_UINT(LD700CtxState_t, bNewCmdReceived),
+	FIELD_UINT(LD700CtxState_t, bExtAckActive),
+	FIELD_UINT(LD700CtxState_t, bNumBufResetArmed),
+	FIELD_UINT(LD700CtxState_t, u8QueuedCmd),
+	FIELD_UINT(LD700CtxState_t, u8LastCmd),
+	FIELD_UINT(LD700CtxState_t, bEscapedActive),
+};
+
+const LDPInStateField_t *ld700i_state_fields(uint8_t *pu8Count)
+{
+	*pu8Count = FIELD_COUNT(g_ld700Fields);
+	return g_ld700Fields;
+}
+
+uint64_t ld700i_ctx_hash(const LD700Ctx_t *pCtx)
+{
+	return ldpin_state_hash(&pCtx->state, g_ld700Fields, FIELD_COUNT(g_ld700Fields));
+}
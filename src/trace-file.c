@@ -0,0 +1,261 @@
+#include <ldp-in/trace-file.h>
+
+#define TAG_KIND_MASK 0x0F
+#define TAG_OTHER_INTERP 0x10
+#define TAG_VAL_SHIFT 5
+#define TAG_VAL_FOLLOWS 7
+
+static const uint8_t g_au8TraceFileMagic[4] = { 'L', 'D', 'P', 'T' };
+
+static uint8_t put_varint(uint8_t *p8Dst, uint32_t u32Val)
+{
+	uint8_t u8Len = 0;
+
+	while (u32Val >= 0x80)
+	{
+		p8Dst[u8Len++] = (uint8_t) (u32Val | 0x80);
+		u32Val >>= 7;
+	}
+	p8Dst[u8Len++] = (uint8_t) u32Val;
+
+	return u8Len;
+}
+
+// returns the number of bytes used, or 0 if the varint runs past p8End or is longer than 5 bytes
+static uint8_t get_varint(const uint8_t *p8Src, const uint8_t *p8End, uint32_t *pu32Val)
+{
+	uint32_t u32Val = 0;
+	uint8_t u8Len = 0;
+
+	for (;;)
+	{
+		uint8_t u8Byte;
+
+		if ((p8Src + u8Len >= p8End) || (u8Len == 5))
+		{
+			return 0;
+		}
+
+		u8Byte = p8Src[u8Len];
+		u32Val |= ((uint32_t) (u8Byte & 0x7F)) << (7 * u8Len);
+		u8Len++;
+
+		if (!(u8Byte & 0x80))
+		{
+			break;
+		}
+	}
+
+	*pu32Val = u32Val;
+	return u8Len;
+}
+
+// maps small negative and positive differences to small unsigned numbers (0, -1, 1, -2, ... => 0, 1, 2, 3, ...)
+static uint32_t zigzag(uint32_t u32Diff)
+{
+	return (u32Diff << 1) ^ ((u32Diff & 0x80000000) ? 0xFFFFFFFF : 0);
+}
+
+static uint32_t unzigzag(uint32_t u32Val)
+{
+	return (u32Val >> 1) ^ ((u32Val & 1) ? 0xFFFFFFFF : 0);
+}
+
+// the value that the stored difference of a record of this kind is taken from, or 0 if the kind is stored in full
+static uint32_t *get_base(LDPInTraceCodec_t *pCodec, uint8_t u8Kind)
+{
+	uint32_t *pBase = 0;
+
+	if (u8Kind == LDPIN_TRACE_SET_FRAME)
+	{
+		pBase = &pCodec->u32LastFrame;
+	}
+	else if ((u8Kind == LDPIN_TRACE_RESULT) && (pCodec->u8LastCallback < LDPIN_TRACEFILE_MAX_CALLBACKS))
+	{
+		pBase = &pCodec->au32LastResult[pCodec->u8LastCallback];
+	}
+
+	return pBase;
+}
+
+void ldpin_tracefile_init(LDPInTraceCodec_t *pCodec, uint8_t u8Interp, uint16_t u16VBlank)
+{
+	uint8_t u;
+
+	pCodec->u8Interp = u8Interp;
+	pCodec->u8LastCallback = 0;
+	pCodec->u16VBlank = u16VBlank;
+	pCodec->u32LastFrame = 0;
+
+	for (u = 0; u < LDPIN_TRACEFILE_MAX_CALLBACKS; u++)
+	{
+		pCodec->au32LastResult[u] = 0;
+	}
+}
+
+void ldpin_tracefile_write_header(const LDPInTraceCodec_t *pCodec, uint8_t *p8Dst)
+{
+	p8Dst[0] = g_au8TraceFileMagic[0];
+	p8Dst[1] = g_au8TraceFileMagic[1];
+	p8Dst[2] = g_au8TraceFileMagic[2];
+	p8Dst[3] = g_au8TraceFileMagic[3];
+	p8Dst[4] = LDPIN_TRACEFILE_VERSION;
+	p8Dst[5] = pCodec->u8Interp;
+	p8Dst[6] = (uint8_t) pCodec->u16VBlank;
+	p8Dst[7] = (uint8_t) (pCodec->u16VBlank >> 8);
+}
+
+uint8_t ldpin_tracefile_read_header(LDPInTraceCodec_t *pCodec, const uint8_t *p8Src, uint32_t u32Len)
+{
+	if ((u32Len < LDPIN_TRACEFILE_HEADER_SIZE) ||
+		(p8Src[0] != g_au8TraceFileMagic[0]) || (p8Src[1] != g_au8TraceFileMagic[1]) ||
+		(p8Src[2] != g_au8TraceFileMagic[2]) || (p8Src[3] != g_au8TraceFileMagic[3]) ||
+		(p8Src[4] == 0) || (p8Src[4] > LDPIN_TRACEFILE_VERSION))
+	{
+		return 0;
+	}
+
+	ldpin_tracefile_init(pCodec, p8Src[5], (uint16_t) (p8Src[6] | (p8Src[7] << 8)));
+	return 1;
+}
+
+uint8_t ldpin_tracefile_encode(LDPInTraceCodec_t *pCodec, const LDPInTraceRecord_t *pRec, uint8_t *p8Dst)
+{
+	uint8_t u8Len = 0;
+	uint8_t u8Kind = pRec->u8Kind & TAG_KIND_MASK;
+	uint16_t u16VBlank = pCodec->u16VBlank;
+	uint32_t u32Val = pRec->u32Val;
+	uint32_t *pBase = get_base(pCodec, u8Kind);
+	uint8_t u8Tag = u8Kind;
+
+	if (u8Kind == LDPIN_TRACE_VBLANK)
+	{
+		u16VBlank++;
+	}
+
+	// records went missing
+	if (u16VBlank != pRec->u16VBlank)
+	{
+		p8Dst[u8Len++] = (TAG_VAL_FOLLOWS << TAG_VAL_SHIFT) | LDPIN_TRACEFILE_VBLANK_SYNC;
+		u8Len += put_varint(p8Dst + u8Len, pRec->u16VBlank);
+	}
+	pCodec->u16VBlank = pRec->u16VBlank;
+
+	if (pBase)
+	{
+		uint32_t u32Diff = u32Val - *pBase;
+		*pBase = u32Val;
+		u32Val = zigzag(u32Diff);
+	}
+	else if (u8Kind == LDPIN_TRACE_CALLBACK)
+	{
+		pCodec->u8LastCallback = (uint8_t) ((u32Val < 0xFF) ? u32Val : 0xFF);
+	}
+
+	if (pRec->u8Interp != pCodec->u8Interp)
+	{
+		u8Tag |= TAG_OTHER_INTERP;
+	}
+
+	if (u32Val < TAG_VAL_FOLLOWS)
+	{
+		u8Tag |= (uint8_t) (u32Val << TAG_VAL_SHIFT);
+	}
+	else
+	{
+		u8Tag |= TAG_VAL_FOLLOWS << TAG_VAL_SHIFT;
+	}
+
+	p8Dst[u8Len++] = u8Tag;
+
+	if (u8Tag & TAG_OTHER_INTERP)
+	{
+		p8Dst[u8Len++] = pRec->u8Interp;
+	}
+
+	if (u32Val >= TAG_VAL_FOLLOWS)
+	{
+		u8Len += put_varint(p8Dst + u8Len, u32Val);
+	}
+
+	return u8Len;
+}
+
+uint8_t ldpin_tracefile_decode(LDPInTraceCodec_t *pCodec, const uint8_t *p8Src, const uint8_t *p8End, LDPInTraceRecord_t *pRec)
+{
+	const uint8_t *p8 = p8Src;
+	uint16_t u16VBlank = pCodec->u16VBlank;
+	uint8_t u8Tag, u8Kind, u8Interp;
+	uint32_t u32Val;
+	uint32_t *pBase;
+
+	if (p8 >= p8End)
+	{
+		return 0;
+	}
+	u8Tag = *p8++;
+
+	if ((u8Tag & TAG_KIND_MASK) == LDPIN_TRACEFILE_VBLANK_SYNC)
+	{
+		uint8_t u8VarLen = get_varint(p8, p8End, &u32Val);
+		if ((u8VarLen == 0) || (u32Val > 0xFFFF) || (p8 + u8VarLen >= p8End))
+		{
+			return 0;
+		}
+		p8 += u8VarLen;
+		u16VBlank = (uint16_t) u32Val;
+		u8Tag = *p8++;
+	}
+	else if ((u8Tag & TAG_KIND_MASK) == LDPIN_TRACE_VBLANK)
+	{
+		u16VBlank++;
+	}
+
+	u8Kind = u8Tag & TAG_KIND_MASK;
+	if (u8Kind > LDPIN_TRACE_ERROR)
+	{
+		return 0;
+	}
+
+	u8Interp = pCodec->u8Interp;
+	if (u8Tag & TAG_OTHER_INTERP)
+	{
+		if (p8 >= p8End)
+		{
+			return 0;
+		}
+		u8Interp = *p8++;
+	}
+
+	u32Val = u8Tag >> TAG_VAL_SHIFT;
+	if (u32Val == TAG_VAL_FOLLOWS)
+	{
+		uint8_t u8VarLen = get_varint(p8, p8End, &u32Val);
+		if (u8VarLen == 0)
+		{
+			return 0;
+		}
+		p8 += u8VarLen;
+	}
+
+	// nothing changes until the whole record has been read, so an incomplete record can be decoded again once the rest arrives
+	pBase = get_base(pCodec, u8Kind);
+	if (pBase)
+	{
+		u32Val = *pBase + unzigzag(u32Val);
+		*pBase = u32Val;
+	}
+	else if (u8Kind == LDPIN_TRACE_CALLBACK)
+	{
+		pCodec->u8LastCallback = (uint8_t) ((u32Val < 0xFF) ? u32Val : 0xFF);
+	}
+
+	pCodec->u16VBlank = u16VBlank;
+
+	pRec->u8Kind = u8Kind;
+	pRec->u8Interp = u8Interp;
+	pRec->u16VBlank = u16VBlank;
+	pRec->u32Val = u32Val;
+
+	return (uint8_t) (p8 - p8Src);
+}
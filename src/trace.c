@@ -0,0 +1,128 @@
+#include <ldp-in/trace.h>
+
+// only built when LDP_IN_TRACE is on
+
+// The interpreter (the producer) only writes the records, the head, the vblank count and the overflow count; the reader only writes the
+//  tail.  A record is written before the head that hands it over, and the reader is done with a slot before the tail that frees it.
+// Records can come from interrupt handlers as well as the main loop, so on the AVR both sides briefly disable interrupts (a 16-bit
+//  index isn't written in one go).  Elsewhere the indices are C11 atomics (see trace.h) and nothing locks.
+#if defined(__AVR__)
+#include <util/atomic.h>
+#define LDP_IN_TRACE_LOCK()	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+#define LDP_IN_TRACE_LOCK()
+#endif
+
+#ifdef LDP_IN_TRACE_C11_ATOMICS
+#define LDP_IN_TRACE_LOAD(var, order)	atomic_load_explicit(&(var), memory_order_##order)
+#define LDP_IN_TRACE_STORE(var, val, order)	atomic_store_explicit(&(var), val, memory_order_##order)
+#define LDP_IN_TRACE_INIT_VAR(var, val)	atomic_init(&(var), val)
+#else
+// AVR (or a compiler without C11 atomics): the lock (or the single core) does the ordering, as long as the compiler keeps to it
+#if defined(__GNUC__)
+#define LDP_IN_TRACE_BARRIER()	__asm__ __volatile__ ("" ::: "memory")
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define LDP_IN_TRACE_BARRIER()	_ReadWriteBarrier()
+#else
+#define LDP_IN_TRACE_BARRIER()
+#endif
+#define LDP_IN_TRACE_LOAD(var, order)	(LDP_IN_TRACE_BARRIER(), (var))
+#define LDP_IN_TRACE_STORE(var, val, order)	do { LDP_IN_TRACE_BARRIER(); (var) = (val); } while (0)
+#define LDP_IN_TRACE_INIT_VAR(var, val)	((var) = (val))
+#endif // LDP_IN_TRACE_C11_ATOMICS
+
+#define LDP_IN_TRACE_MASK (LDP_IN_TRACE_SIZE - 1)
+
+void ldpin_trace_reset(LDPInTrace_t *pTrace)
+{
+	LDP_IN_TRACE_LOCK()
+	{
+		LDP_IN_TRACE_INIT_VAR(pTrace->u16Head, 0);
+		LDP_IN_TRACE_INIT_VAR(pTrace->u16Tail, 0);
+		pTrace->u16VBlank = 0;
+		LDP_IN_TRACE_INIT_VAR(pTrace->u16Overflows, 0);
+	}
+}
+
+void ldpin_trace_push(LDPInTrace_t *pTrace, uint8_t u8Kind, uint8_t u8Interp, uint32_t u32Val)
+{
+	LDP_IN_TRACE_LOCK()
+	{
+		uint16_t u16Head = LDP_IN_TRACE_LOAD(pTrace->u16Head, relaxed);
+
+		if (u8Kind == LDPIN_TRACE_VBLANK)
+		{
+			pTrace->u16VBlank++;
+		}
+
+		if ((uint16_t) (u16Head - LDP_IN_TRACE_LOAD(pTrace->u16Tail, acquire)) == LDP_IN_TRACE_SIZE)
+		{
+			uint16_t u16Overflows = LDP_IN_TRACE_LOAD(pTrace->u16Overflows, relaxed);
+			if (u16Overflows != 0xFFFF) LDP_IN_TRACE_STORE(pTrace->u16Overflows, (uint16_t) (u16Overflows + 1), relaxed);
+		}
+		else
+		{
+			LDPInTraceRecord_t *pRec = &pTrace->aRecs[u16Head & LDP_IN_TRACE_MASK];
+			pRec->u8Kind = u8Kind;
+			pRec->u8Interp = u8Interp;
+			pRec->u16VBlank = pTrace->u16VBlank;
+			pRec->u32Val = u32Val;
+			LDP_IN_TRACE_STORE(pTrace->u16Head, (uint16_t) (u16Head + 1), release);
+		}
+	}
+}
+
+uint32_t ldpin_trace_result(LDPInTrace_t *pTrace, uint8_t u8Interp, uint32_t u32Val)
+{
+	ldpin_trace_push(pTrace, LDPIN_TRACE_RESULT, u8Interp, u32Val);
+	return u32Val;
+}
+
+void ldpin_trace_vblank(LDPInTrace_t *pTrace)
+{
+	ldpin_trace_push(pTrace, LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 0);
+}
+
+uint16_t ldpin_trace_read(LDPInTrace_t *pTrace, LDPInTraceRecord_t *pDst, uint16_t u16Cap)
+{
+	uint16_t u16Tail;
+	uint16_t u16Head;
+	uint16_t u16Count;
+	uint16_t u;
+
+	LDP_IN_TRACE_LOCK()
+	{
+		u16Tail = LDP_IN_TRACE_LOAD(pTrace->u16Tail, relaxed);
+		u16Head = LDP_IN_TRACE_LOAD(pTrace->u16Head, acquire);
+	}
+	u16Count = (uint16_t) (u16Head - u16Tail);
+
+	if (u16Count > u16Cap)
+	{
+		u16Count = u16Cap;
+	}
+
+	// (the interpreter won't touch these slots until the tail has moved past them)
+	for (u = 0; u < u16Count; u++)
+	{
+		pDst[u] = pTrace->aRecs[(uint16_t) (u16Tail + u) & LDP_IN_TRACE_MASK];
+	}
+	LDP_IN_TRACE_LOCK()
+	{
+		LDP_IN_TRACE_STORE(pTrace->u16Tail, (uint16_t) (u16Tail + u16Count), release);
+	}
+
+	return u16Count;
+}
+
+uint16_t ldpin_trace_overflows(LDPInTrace_t *pTrace)
+{
+	uint16_t u16Overflows;
+
+	LDP_IN_TRACE_LOCK()
+	{
+		u16Overflows = LDP_IN_TRACE_LOAD(pTrace->u16Overflows, relaxed);
+	}
+	return u16Overflows;
+}
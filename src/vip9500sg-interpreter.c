@@ -1,9 +1,13 @@
 #include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
 #include <string.h>
 #include <assert.h>
 
 //////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 void (*g_vip9500sgi_play)() = 0;
@@ -19,172 +23,230 @@ uint32_t (*g_vip9500sgi_get_cur_vbi_line18)() = 0;
 
 void (*g_vip9500sgi_error)(VIP9500SGErrCode_t code, uint8_t u8Val) = 0;
 
-/////////////////////////////////
-
-// so we know what to do when we get an ENTER command
-typedef enum
+// the default context forwards to the global callbacks above
+static void vip9500sgi_global_play(void *pUser) { (void) pUser; g_vip9500sgi_play(); }
+static void vip9500sgi_global_pause(void *pUser) { (void) pUser; g_vip9500sgi_pause(); }
+static void vip9500sgi_global_stop(void *pUser) { (void) pUser; g_vip9500sgi_stop(); }
+static void vip9500sgi_global_step_reverse(void *pUser) { (void) pUser; g_vip9500sgi_step_reverse(); }
+static void vip9500sgi_global_begin_search(void *pUser, uint32_t u32FrameNum) { (void) pUser; g_vip9500sgi_begin_search(u32FrameNum); }
+static void vip9500sgi_global_skip(void *pUser, int32_t i32TracksToSkip) { (void) pUser; g_vip9500sgi_skip(i32TracksToSkip); }
+static void vip9500sgi_global_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { (void) pUser; g_vip9500sgi_change_audio(u8Channel, uEnable); }
+static VIP9500SGStatus_t vip9500sgi_global_get_status(void *pUser) { (void) pUser; return g_vip9500sgi_get_status(); }
+static uint32_t vip9500sgi_global_get_cur_frame_num(void *pUser) { (void) pUser; return g_vip9500sgi_get_cur_frame_num(); }
+static uint32_t vip9500sgi_global_get_cur_vbi_line18(void *pUser) { (void) pUser; return g_vip9500sgi_get_cur_vbi_line18(); }
+static void vip9500sgi_global_error(void *pUser, VIP9500SGErrCode_t code, uint8_t u8Val) { (void) pUser; g_vip9500sgi_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static VIP9500SGCtx_t g_vip9500sgi_ctx =
 {
-	VIP9500SGI_STATE_NORMAL,
-	VIP9500SGI_STATE_WAIT_SEARCH,	// in the middle of a search command
-	VIP9500SGI_STATE_SEARCHING,	// in the middle of a search
-	VIP9500SGI_STATE_WAIT_SKIP_FORWARD,	// in the middle of a skip command
-	VIP9500SGI_STATE_WAIT_SKIP_BACKWARD,	// in the middle of a skip command
-	VIP9500SGI_STATE_WAITING_FOR_PLAYING,	// waiting for disc to be playing
-	VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED,	// waiting for disc to be playing/paused
-
-} VIP9500SGState_t;
-
-VIP9500SGState_t g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
-
-// if true, we'll return picture number next time we see one in VBI
-VIP9500SG_BOOL g_vip9500sgi_waitingForPicNum = VIP9500SG_FALSE;
-
-///////////////////////////////////////////////////////////////////////////////
-
-uint8_t g_vip9500sgi_tx_buf[12];	// this should be small enough so as to not waste space but big enough to hold things like current frame number
-uint8_t *g_vip9500sgi_pTxBufStart = 0;
-uint8_t *g_vip9500sgi_pTxBufEnd = 0;
-const uint8_t *g_vip9500sgi_pTxBufLastGoodPtr = (g_vip9500sgi_tx_buf + sizeof(g_vip9500sgi_tx_buf) - 1);
-uint8_t g_vip9500sgi_u8TxBufCount = 0;	// how many bytes are in the tx buffer
-
-#define VIP9500SGI_TX_WRAP(var) 	if (var > g_vip9500sgi_pTxBufLastGoodPtr) var = g_vip9500sgi_tx_buf;
-
-///////////////////////////////////////////////////////////////////////////////
-
-uint8_t g_vip9500sgi_num_buf[5];	// holds currently entered in number (extra digits are discarded)
-uint8_t *g_vip9500sgi_pNumBufStart = 0;
-uint8_t *g_vip9500sgi_pNumBufEnd = 0;
-const uint8_t *g_vip9500sgi_pNumBufLastGoodPtr = (g_vip9500sgi_num_buf + sizeof(g_vip9500sgi_num_buf) - 1);
-uint8_t g_vip9500sgi_u8NumBufCount = 0;	// how many bytes are in the number buffer
-
-#define VIP9500SGI_NUM_WRAP(var) 	if (var > g_vip9500sgi_pNumBufLastGoodPtr) var = g_vip9500sgi_num_buf;
-
-///////////////////////////////////////////////////////////////////////////////
-
-// current frame entered in for stuff like searching, repeating, etc
-uint32_t g_vip9500sgi_u32Frame = 0;
-
-// general purpose index
-uint8_t g_vip9500sgi_u8Idx = 0;
+	{ VIP9500SGI_STATE_NORMAL },	// everything else is zero until reset
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		vip9500sgi_global_play,
+		vip9500sgi_global_pause,
+		vip9500sgi_global_stop,
+		vip9500sgi_global_step_reverse,
+		vip9500sgi_global_begin_search,
+		vip9500sgi_global_skip,
+		vip9500sgi_global_change_audio,
+		vip9500sgi_global_get_status,
+		vip9500sgi_global_get_cur_frame_num,
+		vip9500sgi_global_get_cur_vbi_line18,
+		vip9500sgi_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the vip9500sgi_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define VIP9500SGI_CB_FUNC(pCtx, name)	vip9500sgi_host_##name
+#else
+#define VIP9500SGI_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define VIP9500SGI_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_VIP9500SG, VIP9500SGCallbacks_t, name, VIP9500SGI_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define VIP9500SGI_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_VIP9500SG, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_VIP9500SG, code), VIP9500SGI_CB(pCtx, error)((pCtx)->pUser, code, val))
+
+// state machine moves go through here so that the flight recorder sees them
+#define VIP9500SGI_SET_STATE(pCtx, s)	((pCtx)->state.state = (s), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, s))
+
+#define VIP9500SGI_NUM_WRAP(idx) 	if (idx >= VIP9500SG_NUMBUFSIZE) idx = 0;
+#define VIP9500SGI_RESET_FRAME(pCtx)	(pCtx)->state.u8NumBufStart = (pCtx)->state.u8NumBufEnd = 0; (pCtx)->state.u8NumBufCount = 0
 
-// so our post-vblank handler knows what success byte to return
-uint8_t g_vip9500sgi_u8LastCmdByte = 0;
+//////////////////////////////////
 
-#define VIP9500SGI_RESET_FRAME()	g_vip9500sgi_pNumBufStart = g_vip9500sgi_pNumBufEnd = g_vip9500sgi_num_buf; g_vip9500sgi_u8NumBufCount = 0
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t vip9500sgi_cmd_class(uint8_t u8Byte)
+{
+	switch (u8Byte)
+	{
+	case 0x30: case 0x31: case 0x32: case 0x33: case 0x34:
+	case 0x35: case 0x36: case 0x37: case 0x38: case 0x39:
+		return LDPIN_CMD_DIGIT;
+	case 0x24: case 0x25: case 0x29: case 0x2f: case 0x46: case 0x47: case 0x53:
+		return LDPIN_CMD_PLAY;
+	case 0x2b:
+		return LDPIN_CMD_SEARCH;
+	case 0x6b:
+		return LDPIN_CMD_INQUIRY;
+	case 0x48: case 0x49: case 0x4a: case 0x4b: case 0x4c: case 0x4d:
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
+}
+#endif // LDP_IN_COUNTERS
 
-//////////////////////////////////
+void vip9500sgi_ctx_init(VIP9500SGCtx_t *pCtx, const VIP9500SGCallbacks_t *pCallbacks, void *pUser)
+{
+	memset(&pCtx->state, 0, sizeof(pCtx->state));
+	ldpin_ring8_reset(&pCtx->state.tx);
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
 
-void vip9500sgi_reset()
+void vip9500sgi_ctx_save(const VIP9500SGCtx_t *pCtx, VIP9500SGSnapshot_t *pSnap)
 {
-	g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_VIP9500SG, VIP9500SG_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
 
-	g_vip9500sgi_pTxBufStart = g_vip9500sgi_pTxBufEnd = g_vip9500sgi_tx_buf;
-	g_vip9500sgi_u8TxBufCount = 0;
+VIP9500SG_BOOL vip9500sgi_ctx_restore(VIP9500SGCtx_t *pCtx, const VIP9500SGSnapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_VIP9500SG, VIP9500SG_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return VIP9500SG_FALSE;
+	}
 
-	VIP9500SGI_RESET_FRAME();
+	// the number buffer positions are used as indices without any further checks
+	if ((pSnap->state.u8NumBufStart >= VIP9500SG_NUMBUFSIZE) || (pSnap->state.u8NumBufEnd >= VIP9500SG_NUMBUFSIZE) ||
+		(pSnap->state.u8NumBufCount > VIP9500SG_NUMBUFSIZE) || (ldpin_ring8_count(&pSnap->state.tx) > LDP_IN_RING_SIZE))
+	{
+		return VIP9500SG_FALSE;
+	}
 
-	g_vip9500sgi_u32Frame = 0;
-	g_vip9500sgi_u8Idx = 0;
-	g_vip9500sgi_u8TxBufCount = 0;
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return VIP9500SG_TRUE;
 }
 
-void vip9500sgi_push_queue(uint8_t u8Val)
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t vip9500sgi_ctx_flight_read(VIP9500SGCtx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
 {
-	*g_vip9500sgi_pTxBufEnd = u8Val;
-	g_vip9500sgi_pTxBufEnd++;
-	VIP9500SGI_TX_WRAP(g_vip9500sgi_pTxBufEnd);
-	g_vip9500sgi_u8TxBufCount++;
-
-	// we should never get close to this
-//	assert(g_vip9500sgi_u8TxBufCount < sizeof(g_vip9500sgi_tx_buf));
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
 }
+#endif
 
-uint8_t vip9500sgi_pop_queue()
+void vip9500sgi_ctx_reset(VIP9500SGCtx_t *pCtx)
 {
-	uint8_t u8Res = *g_vip9500sgi_pTxBufStart;
-	g_vip9500sgi_pTxBufStart++;
-	VIP9500SGI_TX_WRAP(g_vip9500sgi_pTxBufStart);
-	g_vip9500sgi_u8TxBufCount--;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_VIP9500SG, 0);
+
+	VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
 
-	// sanity check
-//	assert(g_vip9500sgi_u8TxBufCount != -1);
+	ldpin_ring8_reset(&pCtx->state.tx);
 
-	return u8Res;
+	VIP9500SGI_RESET_FRAME(pCtx);
+
+	pCtx->state.u32Frame = 0;
+	pCtx->state.u8Idx = 0;
+	ldpin_frame_cache_reset(&pCtx->state.frameCache);
 }
 
-void vip9500sgi_add_digit(uint8_t u8Digit)
+void vip9500sgi_add_digit(VIP9500SGCtx_t *pCtx, uint8_t u8Digit)
 {
 	// make sure we don't overflow
-//	assert(g_vip9500sgi_pNumBufEnd <= g_vip9500sgi_pNumBufLastGoodPtr);
+//	assert(pCtx->state.u8NumBufEnd < VIP9500SG_NUMBUFSIZE);
 
-	*g_vip9500sgi_pNumBufEnd = u8Digit;
-	g_vip9500sgi_pNumBufEnd++;
-	VIP9500SGI_NUM_WRAP(g_vip9500sgi_pNumBufEnd);
+	pCtx->state.num_buf[pCtx->state.u8NumBufEnd] = u8Digit;
+	pCtx->state.u8NumBufEnd++;
+	VIP9500SGI_NUM_WRAP(pCtx->state.u8NumBufEnd);
 
 	// buffer cannot have more than 5 digits.  oldest digits get discarded.  Tested on a real player.
-	if (g_vip9500sgi_u8NumBufCount < 5)
+	if (pCtx->state.u8NumBufCount < 5)
 	{
-		g_vip9500sgi_u8NumBufCount++;
+		pCtx->state.u8NumBufCount++;
 	}
 	else
 	{
-		g_vip9500sgi_pNumBufStart++;
-		VIP9500SGI_NUM_WRAP(g_vip9500sgi_pNumBufStart);
+		pCtx->state.u8NumBufStart++;
+		VIP9500SGI_NUM_WRAP(pCtx->state.u8NumBufStart);
 	}
 
 	// we should never overflow
-//	assert(g_vip9500sgi_u8NumBufCount <= sizeof(g_vip9500sgi_num_buf));
+//	assert(pCtx->state.u8NumBufCount <= sizeof(pCtx->state.num_buf));
 }
 
-// converts array into integer and stores it in g_vip9500sgi_u32Frame
-void vip9500sgi_process_number()
+// converts array into integer and stores it in u32Frame
+void vip9500sgi_process_number(VIP9500SGCtx_t *pCtx)
 {
-	g_vip9500sgi_u32Frame = 0;
+	pCtx->state.u32Frame = 0;
 
-	while (g_vip9500sgi_u8NumBufCount > 0)
+	while (pCtx->state.u8NumBufCount > 0)
 	{
-		g_vip9500sgi_u32Frame *= 10;
-		g_vip9500sgi_u32Frame += ((*g_vip9500sgi_pNumBufStart) & 0xF);
-		g_vip9500sgi_pNumBufStart++;
-		VIP9500SGI_NUM_WRAP(g_vip9500sgi_pNumBufStart);
-		g_vip9500sgi_u8NumBufCount--;
+		pCtx->state.u32Frame = ldpin_append_digit(pCtx->state.u32Frame, pCtx->state.num_buf[pCtx->state.u8NumBufStart] & 0xF);
+		pCtx->state.u8NumBufStart++;
+		VIP9500SGI_NUM_WRAP(pCtx->state.u8NumBufStart);
+		pCtx->state.u8NumBufCount--;
 	}
 }
 
-void vip9500sgi_write(uint8_t u8Byte)
+void vip9500sgi_ctx_write(VIP9500SGCtx_t *pCtx, uint8_t u8Byte)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_VIP9500SG, u8Byte);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+	LDPIN_COUNT_CMD(pCtx, vip9500sgi_cmd_class(u8Byte));
+
 	uint8_t u8SuccessByte = u8Byte | 0x80;	// general purpose success
 
 	// we don't want to overwrite our command with the 'enter' byte or digits
 	if ((u8Byte != 0x41) && (u8Byte != 0x6B) && ((u8Byte & 0xF0) != 0x30))
 	{
-		g_vip9500sgi_u8LastCmdByte = u8Byte;
+		pCtx->state.u8LastCmdByte = u8Byte;
 	}
 
 	switch (u8Byte)
 	{
 	case 0x24:	// pause
-		g_vip9500sgi_pause();
+		VIP9500SGI_CB(pCtx, pause)(pCtx->pUser);
 
 		// I've observed that most commands have a delay associated with them.  I'm _guessing_ that the pause command also does, but don't have proof.
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED;
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED);
 		break;
 	case 0x25:	// play
-		g_vip9500sgi_play();
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING;	// spin-up, etc.
+		VIP9500SGI_CB(pCtx, play)(pCtx->pUser);
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING);	// spin-up, etc.
 		break;
 	case 0x29:	// step reverse
 		// Astron, GR, and Cobra Command only seem to use this for pause
-		g_vip9500sgi_step_reverse();
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED;	// we go into stepping state and are done once we reach the paused state
+		VIP9500SGI_CB(pCtx, step_reverse)(pCtx->pUser);
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED);	// we go into stepping state and are done once we reach the paused state
 		break;
 	case 0x2b:	// begin search
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAIT_SEARCH;
-		VIP9500SGI_RESET_FRAME();
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAIT_SEARCH);
+		VIP9500SGI_RESET_FRAME(pCtx);
 		break;
 	case 0x2f:	// stop
-		g_vip9500sgi_stop();
-		vip9500sgi_push_queue(u8SuccessByte);
+		VIP9500SGI_CB(pCtx, stop)(pCtx->pUser);
+		LDPIN_TX8_PUSH(pCtx, u8SuccessByte);
 		break;
 	case 0x30:
 	case 0x31:
@@ -196,55 +258,56 @@ void vip9500sgi_write(uint8_t u8Byte)
 	case 0x37:
 	case 0x38:
 	case 0x39:
-		vip9500sgi_add_digit(u8Byte);
+		vip9500sgi_add_digit(pCtx, u8Byte);
 		break;
 	case 0x41: // Enter
-		vip9500sgi_process_number();
-		switch (g_vip9500sgi_state)
+		vip9500sgi_process_number(pCtx);
+		switch (pCtx->state.state)
 		{
 		case VIP9500SGI_STATE_WAIT_SEARCH:
-			g_vip9500sgi_begin_search(g_vip9500sgi_u32Frame);
-			g_vip9500sgi_state = VIP9500SGI_STATE_SEARCHING;
-			vip9500sgi_push_queue(0x41); // acknowledge that we will search
+			VIP9500SGI_CB(pCtx, begin_search)(pCtx->pUser, pCtx->state.u32Frame);
+			LDPIN_COUNT_SEARCH_START(pCtx);
+			VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_SEARCHING);
+			LDPIN_TX8_PUSH(pCtx, 0x41); // acknowledge that we will search
 			break;
 		case VIP9500SGI_STATE_WAIT_SKIP_FORWARD:
-			g_vip9500sgi_skip((int32_t) g_vip9500sgi_u32Frame +1);	// +1 due to quirk of the LDP
-			g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED;
-			vip9500sgi_push_queue(0x41); // acknowledge that we will skip
+			VIP9500SGI_CB(pCtx, skip)(pCtx->pUser, (int32_t) pCtx->state.u32Frame +1);	// +1 due to quirk of the LDP
+			VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED);
+			LDPIN_TX8_PUSH(pCtx, 0x41); // acknowledge that we will skip
 			break;
 		case VIP9500SGI_STATE_WAIT_SKIP_BACKWARD:
-			g_vip9500sgi_skip( (-((int32_t) g_vip9500sgi_u32Frame)) + 1);	// +1 due to quirk of the LDP
-			g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED;
-			vip9500sgi_push_queue(0x41); // acknowledge that we will skip
+			VIP9500SGI_CB(pCtx, skip)(pCtx->pUser,  (-((int32_t) pCtx->state.u32Frame)) + 1);	// +1 due to quirk of the LDP
+			VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING_OR_PAUSED);
+			LDPIN_TX8_PUSH(pCtx, 0x41); // acknowledge that we will skip
 			break;
 		default:
-			g_vip9500sgi_error(VIP9500SG_ERR_UNKNOWN_CMD_BYTE, u8Byte);
+			VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNKNOWN_CMD_BYTE, u8Byte);
 			break;
 		}
 		break;
 	case 0x46:	// prepare to skip forward
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAIT_SKIP_FORWARD;
-		VIP9500SGI_RESET_FRAME();
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAIT_SKIP_FORWARD);
+		VIP9500SGI_RESET_FRAME(pCtx);
 		break;
 	case 0x47:	// prepare to skip backward
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAIT_SKIP_BACKWARD;
-		VIP9500SGI_RESET_FRAME();
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAIT_SKIP_BACKWARD);
+		VIP9500SGI_RESET_FRAME(pCtx);
 		break;
 	case 0x53:	// Play forward at 1X with sound enabled, note that if disc is stopped this will return an error 0x1D
-		g_vip9500sgi_play();
+		VIP9500SGI_CB(pCtx, play)(pCtx->pUser);
 
 		// real LDP has some delay when responding this command.
-		g_vip9500sgi_state = VIP9500SGI_STATE_WAITING_FOR_PLAYING;
+		VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_WAITING_FOR_PLAYING);
 		break;
 
 	case 0x68:	// reset
-		vip9500sgi_reset();
-		vip9500sgi_push_queue(u8SuccessByte);
+		vip9500sgi_ctx_reset(pCtx);
+		LDPIN_TX8_PUSH(pCtx, u8SuccessByte);
 		break;
 
 	case 0x6b:	// get current frame
 		// the real LDP has some delay when responding to this command.  I suspect it waits until the next picture number is decoded.
-		g_vip9500sgi_waitingForPicNum = VIP9500SG_TRUE;
+		pCtx->state.waitingForPicNum = VIP9500SG_TRUE;
 		break;
 
 		// STUBS: return success but don't actually do anything
@@ -253,7 +316,7 @@ void vip9500sgi_write(uint8_t u8Byte)
 	case 0x6e:	// unknown
 	case 0x71:	// turn on response
 	case 0x75:	// some reset function, I found it in hitachi.cpp but don't know what else it does
-		vip9500sgi_push_queue(u8SuccessByte);
+		LDPIN_TX8_PUSH(pCtx, u8SuccessByte);
 		break;
 
 		// STUBS: stuff we don't support but maybe need to if a game uses it
@@ -262,46 +325,80 @@ void vip9500sgi_write(uint8_t u8Byte)
 	case 0x49:	// disable left audio
 	case 0x4a:	// enable right audio
 	case 0x4b:	// disable right audio
-		g_vip9500sgi_error(VIP9500SG_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
-		vip9500sgi_push_queue(u8SuccessByte);
+		VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNSUPPORTED_CMD_BYTE, u8Byte);
+		LDPIN_TX8_PUSH(pCtx, u8SuccessByte);
 		break;
 
 
 	default:
-		g_vip9500sgi_error(VIP9500SG_ERR_UNKNOWN_CMD_BYTE, u8Byte);
+		VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNKNOWN_CMD_BYTE, u8Byte);
 		break;
 	}
 }
 
-VIP9500SG_BOOL vip9500sgi_can_read()
+VIP9500SG_BOOL vip9500sgi_ctx_can_read(VIP9500SGCtx_t *pCtx)
 {
-	return (VIP9500SG_BOOL) (g_vip9500sgi_u8TxBufCount != 0);
+	return (VIP9500SG_BOOL) (ldpin_ring8_count(&pCtx->state.tx) != 0);
 }
 
-uint8_t vip9500sgi_read()
+uint8_t vip9500sgi_ctx_read(VIP9500SGCtx_t *pCtx)
 {
-//	assert(g_vip9500sgi_u8TxBufCount > 0);
-	return vip9500sgi_pop_queue();
+//	assert(ldpin_ring8_count(&pCtx->state.tx) > 0);
+	LDPIN_COUNT(pCtx, u32BytesOut);
+	return ldpin_ring8_pop(&pCtx->state.tx);
 }
 
-void vip9500sgi_think_picnum_query(VIP9500SGStatus_t stat)
+void vip9500sgi_ctx_write_n(VIP9500SGCtx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len)
+{
+	while (u16Len != 0)
+	{
+		vip9500sgi_ctx_write(pCtx, *p8Src++);
+		u16Len--;
+	}
+}
+
+uint16_t vip9500sgi_ctx_read_n(VIP9500SGCtx_t *pCtx, uint8_t *pDst, uint16_t u16Cap)
+{
+	uint16_t u16Read = 0;
+
+	while ((u16Read < u16Cap) && (ldpin_ring8_count(&pCtx->state.tx) != 0))
+	{
+		pDst[u16Read++] = ldpin_ring8_pop(&pCtx->state.tx);
+	}
+
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u16Read);
+	return u16Read;
+}
+
+const uint8_t *vip9500sgi_ctx_tx_peek(VIP9500SGCtx_t *pCtx, uint8_t *pu8Count)
+{
+	return ldpin_ring8_peek(&pCtx->state.tx, pu8Count);
+}
+
+void vip9500sgi_ctx_tx_commit(VIP9500SGCtx_t *pCtx, uint8_t u8Count)
+{
+	ldpin_ring8_commit(&pCtx->state.tx, u8Count);
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u8Count);
+}
+
+void vip9500sgi_think_picnum_query(VIP9500SGCtx_t *pCtx, VIP9500SGStatus_t stat)
 {
 	// if picture number will be valid
 	if ((stat == VIP9500SG_PAUSED) || (stat == VIP9500SG_PLAYING))
 	{
-		uint32_t line18 = g_vip9500sgi_get_cur_vbi_line18();
+		uint32_t line18 = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_VIP9500SG, VIP9500SGI_CB(pCtx, get_cur_vbi_line18)(pCtx->pUser));
 
 		// if this field contains a picture number, then we're done
 		// The real player has some delay before returning a result for the current picture number query.
 		// I am _guessing_ that it waits for the next picture number to be decoded in VBI.
 		if (((line18 >> 16) & 0xF0) == 0xF0)
 		{
-			uint32_t curframe = g_vip9500sgi_get_cur_frame_num();
-			vip9500sgi_push_queue(0x6b); // frame response
-			vip9500sgi_push_queue((uint8_t) ((curframe >> 8) & 0xff)); // high byte of frame
-			vip9500sgi_push_queue((uint8_t) (curframe & 0xff)); // low byte of frame
+			uint32_t curframe = pCtx->state.frameCache.u8Valid ? pCtx->state.frameCache.u32Frame : LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_VIP9500SG, VIP9500SGI_CB(pCtx, get_cur_frame_num)(pCtx->pUser));
+			LDPIN_TX8_PUSH(pCtx, 0x6b); // frame response
+			LDPIN_TX8_PUSH(pCtx, (uint8_t) ((curframe >> 8) & 0xff)); // high byte of frame
+			LDPIN_TX8_PUSH(pCtx, (uint8_t) (curframe & 0xff)); // low byte of frame
 
-			g_vip9500sgi_waitingForPicNum = VIP9500SG_FALSE;
+			pCtx->state.waitingForPicNum = VIP9500SG_FALSE;
 		}
 		// else wait for the next field
 	}
@@ -309,27 +406,31 @@ void vip9500sgi_think_picnum_query(VIP9500SGStatus_t stat)
 	{
 		// if picture number is requested during spin-up, a real player returns an error.
 		// This is a good default for all other conditions for now.
-		vip9500sgi_push_queue(0x1d); // error code from real player
+		LDPIN_TX8_PUSH(pCtx, 0x1d); // error code from real player
 
-		g_vip9500sgi_waitingForPicNum = VIP9500SG_FALSE;
+		pCtx->state.waitingForPicNum = VIP9500SG_FALSE;
 	}
 
 }
 
-void vip9500sgi_think_after_vblank()
+void vip9500sgi_ctx_think_after_vblank(VIP9500SGCtx_t *pCtx)
 {
-	VIP9500SGStatus_t stat = g_vip9500sgi_get_status();
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_VIP9500SG, 0);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+
+	VIP9500SGStatus_t stat = LDPIN_TRACE_RESULT(pCtx, LDPIN_TRACE_VIP9500SG, VIP9500SGI_CB(pCtx, get_status)(pCtx->pUser));
 
-	switch (g_vip9500sgi_state)
+	switch (pCtx->state.state)
 	{
 		// nothing to do
 	case VIP9500SGI_STATE_NORMAL:
 	case VIP9500SGI_STATE_WAIT_SEARCH:
 	case VIP9500SGI_STATE_WAIT_SKIP_FORWARD:
 	case VIP9500SGI_STATE_WAIT_SKIP_BACKWARD:
-		if (g_vip9500sgi_waitingForPicNum)
+		if (pCtx->state.waitingForPicNum)
 		{
-			vip9500sgi_think_picnum_query(stat);
+			vip9500sgi_think_picnum_query(pCtx, stat);
 		}
 		break;
 	// if we are in the middle of a search
@@ -339,15 +440,17 @@ void vip9500sgi_think_after_vblank()
 			{
 				// if search is complete
 			case VIP9500SG_PAUSED:
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
-				vip9500sgi_push_queue(0xb0);	// search complete
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
+				LDPIN_TX8_PUSH(pCtx, 0xb0);	// search complete
+				LDPIN_COUNT_SEARCH_DONE(pCtx);
 				break;
 				// if we're still working, do nothing
 			case VIP9500SG_SEARCHING:
 				break;
 			default:
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
-				vip9500sgi_push_queue(0x1d);	// error code confirmed on a real player
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
+				LDPIN_TX8_PUSH(pCtx, 0x1d);	// error code confirmed on a real player
+				LDPIN_COUNT_SEARCH_FAILED(pCtx);
 				break;
 			}
 		}
@@ -357,21 +460,21 @@ void vip9500sgi_think_after_vblank()
 			switch (stat)
 			{
 			case VIP9500SG_PLAYING:
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
-				vip9500sgi_push_queue(g_vip9500sgi_u8LastCmdByte | 0x80);	// success!
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
+				LDPIN_TX8_PUSH(pCtx, pCtx->state.u8LastCmdByte | 0x80);	// success!
 				break;
 				// if we're still working, keep waiting
 			case VIP9500SG_SPINNING_UP:
 				break;
 			default:
-				g_vip9500sgi_error(VIP9500SG_ERR_UNHANDLED_SITUATION, stat);
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
+				VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNHANDLED_SITUATION, stat);
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
 				break;
 			}
 
-			if (g_vip9500sgi_waitingForPicNum)
+			if (pCtx->state.waitingForPicNum)
 			{
-				vip9500sgi_think_picnum_query(stat);
+				vip9500sgi_think_picnum_query(pCtx, stat);
 			}
 		}
 		break;
@@ -381,22 +484,85 @@ void vip9500sgi_think_after_vblank()
 			{
 			case VIP9500SG_PLAYING:
 			case VIP9500SG_PAUSED:
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
-				vip9500sgi_push_queue(g_vip9500sgi_u8LastCmdByte | 0x80);	// success!
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
+				LDPIN_TX8_PUSH(pCtx, pCtx->state.u8LastCmdByte | 0x80);	// success!
 				break;
 				// if we're still working, keep waiting
 			case VIP9500SG_STEPPING:
 				break;
 			default:
-				g_vip9500sgi_error(VIP9500SG_ERR_UNHANDLED_SITUATION, stat);
-				g_vip9500sgi_state = VIP9500SGI_STATE_NORMAL;
+				VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNHANDLED_SITUATION, stat);
+				VIP9500SGI_SET_STATE(pCtx, VIP9500SGI_STATE_NORMAL);
 
 				break;
 			}
 		}
 		break;
 	default:	// unhandled state which we need to handle
-		g_vip9500sgi_error(VIP9500SG_ERR_UNHANDLED_SITUATION, 0);
+		VIP9500SGI_ERROR(pCtx, VIP9500SG_ERR_UNHANDLED_SITUATION, 0);
 		break;
 	}
 }
+
+//////////////////////////////////
+
+void vip9500sgi_reset()
+{
+	vip9500sgi_ctx_reset(&g_vip9500sgi_ctx);
+}
+
+void vip9500sgi_write(uint8_t u8Byte)
+{
+	vip9500sgi_ctx_write(&g_vip9500sgi_ctx, u8Byte);
+}
+
+VIP9500SG_BOOL vip9500sgi_can_read()
+{
+	return vip9500sgi_ctx_can_read(&g_vip9500sgi_ctx);
+}
+
+uint8_t vip9500sgi_read()
+{
+	return vip9500sgi_ctx_read(&g_vip9500sgi_ctx);
+}
+
+void vip9500sgi_write_n(const uint8_t *p8Src, uint16_t u16Len)
+{
+	vip9500sgi_ctx_write_n(&g_vip9500sgi_ctx, p8Src, u16Len);
+}
+
+uint16_t vip9500sgi_read_n(uint8_t *pDst, uint16_t u16Cap)
+{
+	return vip9500sgi_ctx_read_n(&g_vip9500sgi_ctx, pDst, u16Cap);
+}
+
+const uint8_t *vip9500sgi_tx_peek(uint8_t *pu8Count)
+{
+	return vip9500sgi_ctx_tx_peek(&g_vip9500sgi_ctx, pu8Count);
+}
+
+void vip9500sgi_tx_commit(uint8_t u8Count)
+{
+	vip9500sgi_ctx_tx_commit(&g_vip9500sgi_ctx, u8Count);
+}
+
+void vip9500sgi_ctx_set_cur_frame_num(VIP9500SGCtx_t *pCtx, uint32_t u32Frame)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_VIP9500SG, u32Frame);
+	ldpin_frame_cache_set(&pCtx->state.frameCache, u32Frame);
+}
+
+void vip9500sgi_set_cur_frame_num(uint32_t u32Frame)
+{
+	vip9500sgi_ctx_set_cur_frame_num(&g_vip9500sgi_ctx, u32Frame);
+}
+
+void vip9500sgi_think_after_vblank()
+{
+	vip9500sgi_ctx_think_after_vblank(&g_vip9500sgi_ctx);
+}
+
+VIP9500SGCtx_t *vip9500sgi_get_default_ctx()
+{
+	return &g_vip9500sgi_ctx;
+}
@@ -1,7 +1,11 @@
 #include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
+#include <ldp-in/convert.h>
 
 //////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 void (*g_vp931i_play)() = 0;
@@ -11,35 +15,84 @@ void (*g_vp931i_skip_tracks)(int16_t i16Tracks) = 0;
 void (*g_vp931i_skip_to_framenum)(uint32_t uFrameNumber) = 0;
 void (*g_vp931i_error)(VP931ErrCode_t code, uint8_t u8Val) = 0;
 
-//////////////////////////////////////////////////////////////
-
-// private methods
+// the default context forwards to the global callbacks above
+static void vp931i_global_play(void *pUser) { (void) pUser; g_vp931i_play(); }
+static void vp931i_global_pause(void *pUser) { (void) pUser; g_vp931i_pause(); }
+static void vp931i_global_begin_search(void *pUser, uint32_t uFrameNumber, VP931_BOOL bAudioSquelchedOnComplete) { (void) pUser; g_vp931i_begin_search(uFrameNumber, bAudioSquelchedOnComplete); }
+static void vp931i_global_skip_tracks(void *pUser, int16_t i16TracksToSkip) { (void) pUser; g_vp931i_skip_tracks(i16TracksToSkip); }
+static void vp931i_global_skip_to_framenum(void *pUser, uint32_t uFrameNumber) { (void) pUser; g_vp931i_skip_to_framenum(uFrameNumber); }
+static void vp931i_global_error(void *pUser, VP931ErrCode_t code, uint8_t u8Val) { (void) pUser; g_vp931i_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
 
-uint16_t BCDtoHEX12(const uint8_t *BCD_String)				// Convert player BCD format to 12-bit integer
+static VP931Ctx_t g_vp931i_ctx =
 {
-	uint16_t Hex_Value;
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		vp931i_global_play,
+		vp931i_global_pause,
+		vp931i_global_begin_search,
+		vp931i_global_skip_tracks,
+		vp931i_global_skip_to_framenum,
+		vp931i_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
 
-	Hex_Value = (uint16_t)(BCD_String[0] & 0x0F) * 100;
-	Hex_Value += (BCD_String[1] >> 4) * 10;
-	Hex_Value += BCD_String[1] & 0x0F;
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the vp931i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define VP931I_CB_FUNC(pCtx, name)	vp931i_host_##name
+#else
+#define VP931I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
 
-	return(Hex_Value);
-}
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define VP931I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_VP931, VP931Callbacks_t, name, VP931I_CB_FUNC(pCtx, name))
 
-uint32_t BCDtoHEX20(const uint8_t *BCD_String)				// Convert player BCD format to 20-bit integer
-{
-	uint32_t Hex_Value;
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define VP931I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_VP931, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_VP931, code), VP931I_CB(pCtx, error)((pCtx)->pUser, code, val))
 
-	Hex_Value = (uint32_t)(BCD_String[0] & 0x07) * 10000;	// discard top 5 bits as they are reserved and cannot be part of the picture number
-	Hex_Value += (uint32_t)(BCD_String[1] >> 4) * 1000;
-	Hex_Value += (uint32_t)(BCD_String[1] & 0x0F) * 100;
-	Hex_Value += (BCD_String[2] >> 4) * 10;
-	Hex_Value += BCD_String[2] & 0x0F;
+//////////////////////////////////////////////////////////////
+
+// private methods
+
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t vp931i_cmd_class(const uint8_t *pCmdBuf)
+{
+	uint8_t u8HighNibble = (pCmdBuf[0] & 0xF0);
 
-	return(Hex_Value);
+	if (pCmdBuf[0] == 0)
+	{
+		switch (pCmdBuf[1] & 0xF0)
+		{
+		case 0x00: case 0x10: case 0x20: case 0x40: case 0x50: case 0xA0: case 0xB0: case 0xE0: case 0xF0:
+			return LDPIN_CMD_PLAY;
+		default:
+			return LDPIN_CMD_OTHER;
+		}
+	}
+	else if ((u8HighNibble == 0xD0) || (u8HighNibble == 0xF0))
+	{
+		return LDPIN_CMD_SEARCH;
+	}
+	else if (pCmdBuf[0] == 0x02)
+	{
+		return LDPIN_CMD_AV;
+	}
+	return LDPIN_CMD_OTHER;
 }
+#endif // LDP_IN_COUNTERS
 
-void vp931i_process_cmd(const uint8_t *pCmdBuf, VP931Status_t status)
+void vp931i_process_cmd(VP931Ctx_t *pCtx, const uint8_t *pCmdBuf, VP931Status_t status)
 {
 	uint8_t u8HighNibble = (pCmdBuf[0] & 0xF0);
 
@@ -49,7 +102,7 @@ void vp931i_process_cmd(const uint8_t *pCmdBuf, VP931Status_t status)
 		switch (pCmdBuf[1] & 0xF0)
 		{
 		default:	// unknown
-			g_vp931i_error(VP931_ERR_UNKNOWN_CMD_BYTE, pCmdBuf[1]);
+			VP931I_ERROR(pCtx, VP931_ERR_UNKNOWN_CMD_BYTE, pCmdBuf[1]);
 			break;
 		case 0x00:		// Play
 			// Firefox spams the play command.  We need to check the status to make sure we don't get overwhelmed by said spammage.
@@ -65,7 +118,7 @@ void vp931i_process_cmd(const uint8_t *pCmdBuf, VP931Status_t status)
 				// only if we are paused (or had a search error) should we actually send a play command
 			case VP931_PAUSED:
 			case VP931_ERROR:
-				g_vp931i_play();
+				VP931I_CB(pCtx, play)(pCtx->pUser);
 				break;
 			}
 			break;
@@ -75,19 +128,19 @@ void vp931i_process_cmd(const uint8_t *pCmdBuf, VP931Status_t status)
 			// don't spam the pause command (FFR spams this if nothing is plugged into the PIF board)
 			if (status != VP931_PAUSED)
 			{
-				g_vp931i_pause();
+				VP931I_CB(pCtx, pause)(pCtx->pUser);
 			}
 			break;
 		case 0xE0:		// Jump XXX tracks forward
 			{
-				uint16_t u16TracksToJumpForward = BCDtoHEX12(&pCmdBuf[1]);
-				g_vp931i_skip_tracks(u16TracksToJumpForward);
+				uint16_t u16TracksToJumpForward = ldpin_bcd3_to_u16(pCmdBuf[1], pCmdBuf[2]);
+				VP931I_CB(pCtx, skip_tracks)(pCtx->pUser, u16TracksToJumpForward);
 			}
 			break;
 		case 0xF0:		// Jump XXX tracks backward
 			{
-				uint16_t u16TracksToJumpBackward = BCDtoHEX12(&pCmdBuf[1]);
-				g_vp931i_skip_tracks(-u16TracksToJumpBackward);
+				uint16_t u16TracksToJumpBackward = ldpin_bcd3_to_u16(pCmdBuf[1], pCmdBuf[2]);
+				VP931I_CB(pCtx, skip_tracks)(pCtx->pUser, -u16TracksToJumpBackward);
 			}
 			break;
 		case 0x10:		// Reverse play
@@ -95,60 +148,118 @@ void vp931i_process_cmd(const uint8_t *pCmdBuf, VP931Status_t status)
 		case 0x50:		// Slow backward
 		case 0xA0:		// Scan forward 75X
 		case 0xB0:		// Scan backward 75X
-			g_vp931i_error(VP931_ERR_UNSUPPORTED_CMD_BYTE, pCmdBuf[1]);
+			VP931I_ERROR(pCtx, VP931_ERR_UNSUPPORTED_CMD_BYTE, pCmdBuf[1]);
 			break;
 		}
 	}
 	// goto + halt
+	// (the top 5 bits of the first byte are reserved and cannot be part of the picture number)
 	else if (u8HighNibble == 0xD0)
 	{
-		uint32_t uTargetPicNum = BCDtoHEX20(&pCmdBuf[0]);
-		g_vp931i_begin_search(uTargetPicNum, VP931_TRUE);
+		uint32_t uTargetPicNum = ldpin_bcd5_to_u32(pCmdBuf[0] & 0x07, pCmdBuf[1], pCmdBuf[2]);
+		VP931I_CB(pCtx, begin_search)(pCtx->pUser, uTargetPicNum, VP931_TRUE);
+		LDPIN_COUNT_SEARCH_START(pCtx);
 	}
 	// goto + play
 	else if (u8HighNibble == 0xF0)
 	{
-		uint32_t uTargetPicNum = BCDtoHEX20(&pCmdBuf[0]);
+		uint32_t uTargetPicNum = ldpin_bcd5_to_u32(pCmdBuf[0] & 0x07, pCmdBuf[1], pCmdBuf[2]);
 
 		// skip won't work unless disc is playing, so if disc is not playing, send a play command before performing the skip
 		if (status != VP931_PLAYING)
 		{
-			g_vp931i_play();
+			VP931I_CB(pCtx, play)(pCtx->pUser);
 		}
 
-		g_vp931i_skip_to_framenum(uTargetPicNum);
+		VP931I_CB(pCtx, skip_to_framenum)(pCtx->pUser, uTargetPicNum);
 	}
 	// else video/audio options
 	else if (pCmdBuf[0] == 0x02)
 	{
-		g_vp931i_error(VP931_ERR_UNSUPPORTED_CMD_BYTE, pCmdBuf[0]);
+		VP931I_ERROR(pCtx, VP931_ERR_UNSUPPORTED_CMD_BYTE, pCmdBuf[0]);
 	}
 	// else unknown
 	else
 	{
-		g_vp931i_error(VP931_ERR_UNKNOWN_CMD_BYTE, pCmdBuf[0]);
+		VP931I_ERROR(pCtx, VP931_ERR_UNKNOWN_CMD_BYTE, pCmdBuf[0]);
 	}
 }
 
 //////////////////////////////////////////////////////////////
 
-void vp931i_on_vsync(const uint8_t *p8CmdBuf, uint8_t u8CmdBytesRecvd, VP931Status_t status)
+void vp931i_ctx_on_vsync(VP931Ctx_t *pCtx, const uint8_t *p8CmdBuf, uint8_t u8CmdBytesRecvd, VP931Status_t status)
 {
 	uint8_t idx = 0;
 
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_VP931, status);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+	LDPIN_COUNT_N(pCtx, u32BytesIn, u8CmdBytesRecvd);
+
 	// process all command sets of 3 (don't process partial command sets)
 	while ((idx+3) <= u8CmdBytesRecvd)
 	{
-		vp931i_process_cmd(&p8CmdBuf[idx], status);
+		LDPIN_TRACE(pCtx, LDPIN_TRACE_VSYNC_CMD, LDPIN_TRACE_VP931, p8CmdBuf[idx] | ((uint32_t) p8CmdBuf[idx + 1] << 8) | ((uint32_t) p8CmdBuf[idx + 2] << 16));
+		LDPIN_COUNT_CMD(pCtx, vp931i_cmd_class(&p8CmdBuf[idx]));
+		vp931i_process_cmd(pCtx, &p8CmdBuf[idx], status);
 		idx += 3;	// 3 bytes per command
 	}
 
 	u8CmdBytesRecvd = 0;	// ready to receive new commands
 }
 
+void vp931i_ctx_reset(VP931Ctx_t *pCtx)
+{
+	(void) pCtx;
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_VP931, 0);
+	// nothing else to do here for now
+}
+
+void vp931i_ctx_init(VP931Ctx_t *pCtx, const VP931Callbacks_t *pCallbacks, void *pUser)
+{
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
+
+void vp931i_ctx_save(const VP931Ctx_t *pCtx, VP931Snapshot_t *pSnap)
+{
+	(void) pCtx;
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_VP931, VP931_SNAPSHOT_VERSION, 0);
+}
+
+VP931_BOOL vp931i_ctx_restore(VP931Ctx_t *pCtx, const VP931Snapshot_t *pSnap)
+{
+	(void) pCtx;
+	return ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_VP931, VP931_SNAPSHOT_VERSION, 0) ? VP931_TRUE : VP931_FALSE;
+}
+
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t vp931i_ctx_flight_read(VP931Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
+{
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
+}
+#endif
+
+void vp931i_on_vsync(const uint8_t *p8CmdBuf, uint8_t u8CmdBytesRecvd, VP931Status_t status)
+{
+	vp931i_ctx_on_vsync(&g_vp931i_ctx, p8CmdBuf, u8CmdBytesRecvd, status);
+}
+
 void vp931i_reset()
 {
-	// nothing to do here for now
+	vp931i_ctx_reset(&g_vp931i_ctx);
+}
+
+VP931Ctx_t *vp931i_get_default_ctx()
+{
+	return &g_vp931i_ctx;
 }
 
 void vp931i_get_status_bytes(uint32_t u32VBILine18, VP931Status_t status, uint8_t *pDstBuffer)
@@ -1,9 +1,12 @@
 #include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/trace.h>
+#include <ldp-in/flight.h>
 #include <string.h>
 #include <assert.h>
 
 //////////////////
 
+#ifndef LDP_IN_STATIC_CALLBACKS
 // CALLBACKS THAT MUST BE DEFINED BY CALLER:
 
 void (*g_vp932i_play)(uint8_t u8Numerator, uint8_t u8Denominator, VP932_BOOL bBackward, VP932_BOOL bAudioSquelched) = 0;
@@ -18,67 +21,135 @@ void (*g_vp932i_set_rts)(VP932_BOOL) = 0;
 
 void (*g_vp932i_error)(VP932ErrCode_t code, uint8_t u8Val) = 0;
 
-/////////////////////////////////
-
-typedef enum
+// the default context forwards to the global callbacks above
+static void vp932i_global_play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, VP932_BOOL bBackward, VP932_BOOL bAudioSquelched) { (void) pUser; g_vp932i_play(u8Numerator, u8Denominator, bBackward, bAudioSquelched); }
+static void vp932i_global_step(void *pUser, VP932_BOOL bBackward) { (void) pUser; g_vp932i_step(bBackward); }
+static void vp932i_global_pause(void *pUser) { (void) pUser; g_vp932i_pause(); }
+static void vp932i_global_begin_search(void *pUser, uint32_t u32FrameNum) { (void) pUser; g_vp932i_begin_search(u32FrameNum); }
+static void vp932i_global_change_audio(void *pUser, uint8_t u8Channel, uint8_t uEnable) { (void) pUser; g_vp932i_change_audio(u8Channel, uEnable); }
+static uint32_t vp932i_global_get_cur_frame_num(void *pUser) { (void) pUser; return g_vp932i_get_cur_frame_num(); }
+static void vp932i_global_error(void *pUser, VP932ErrCode_t code, uint8_t u8Val) { (void) pUser; g_vp932i_error(code, u8Val); }
+#endif // LDP_IN_STATIC_CALLBACKS
+
+static VP932Ctx_t g_vp932i_ctx =
 {
-	VP932_STATE_NORMAL = 0,
-	VP932_STATE_SEARCHING,	// in the middle of a disc search
-} VP932State_t;
+	{ VP932_STATE_NORMAL },	// everything else is zero until reset
+#ifndef LDP_IN_STATIC_CALLBACKS
+	{
+		vp932i_global_play,
+		vp932i_global_step,
+		vp932i_global_pause,
+		vp932i_global_begin_search,
+		vp932i_global_change_audio,
+		vp932i_global_get_cur_frame_num,
+		vp932i_global_error
+	},
+#endif
+	0,
+#ifdef LDP_IN_COUNTERS
+	{ 0 },	// counters
+#endif
+#if LDP_IN_FLIGHT_SIZE != 0
+	{ { 0 }, 0, 0, 0, 0 },	// flight
+#endif
+#ifdef LDP_IN_TRACE
+	{ { { 0, 0, 0, 0 } }, 0, 0, 0, 0 }	// trace
+#endif
+};
+
+// in a LDP_IN_STATIC_CALLBACKS build, callbacks are bound at link time to the vp932i_host_* functions supplied by the host
+#ifdef LDP_IN_STATIC_CALLBACKS
+#define VP932I_CB_FUNC(pCtx, name)	vp932i_host_##name
+#else
+#define VP932I_CB_FUNC(pCtx, name)	(pCtx)->cb.name
+#endif
+
+// every callback goes through here so that a LDP_IN_TRACE build can record it
+#define VP932I_CB(pCtx, name)	LDPIN_TRACE_CB(pCtx, LDPIN_TRACE_VP932, VP932Callbacks_t, name, VP932I_CB_FUNC(pCtx, name))
+
+// error callbacks also leave a record of the code and argument (for trace statistics)
+#define VP932I_ERROR(pCtx, code, val)	(LDPIN_TRACE_ERR(pCtx, LDPIN_TRACE_VP932, code, val), LDPIN_COUNT_ERR(pCtx, code), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_ERROR, LDPIN_TRACE_VP932, code), VP932I_CB(pCtx, error)((pCtx)->pUser, code, val))
+
+// state machine moves go through here so that the flight recorder sees them
+#define VP932I_SET_STATE(pCtx, s)	((pCtx)->state.state = (s), LDPIN_FLIGHT(pCtx, LDPIN_FLIGHT_STATE, LDPIN_TRACE_VP932, s))
 
-VP932State_t g_vp932i_state = VP932_STATE_NORMAL;
+//////////////////////////////////
 
-// whether to play the disc after a search is complete
-VP932_BOOL g_vp932i_play_after_search = VP932_FALSE;
+void vp932i_ctx_init(VP932Ctx_t *pCtx, const VP932Callbacks_t *pCallbacks, void *pUser)
+{
+	memset(&pCtx->state, 0, sizeof(pCtx->state));
+	ldpin_ring8_reset(&pCtx->state.tx);
+#ifndef LDP_IN_STATIC_CALLBACKS
+	pCtx->cb = *pCallbacks;
+#else
+	(void) pCallbacks;	// the host_* functions are called instead
+#endif
+	pCtx->pUser = pUser;
+	LDPIN_COUNTERS_INIT(pCtx);
+	LDPIN_FLIGHT_INIT(pCtx);
+	LDPIN_TRACE_INIT(pCtx);
+}
 
-uint8_t g_vp932i_tx_buf[12];	// this should be small enough so as to not waste space but big enough to hold things like current frame number
-uint8_t *g_vp932i_pTxBufStart = 0;
-uint8_t *g_vp932i_pTxBufEnd = 0;
-const uint8_t *g_vp932i_pTxBufLastGoodPtr = (g_vp932i_tx_buf + sizeof(g_vp932i_tx_buf) - 1);
-uint8_t g_vp932i_u8TxBufCount = 0;	// how many bytes are in the tx buffer
-uint16_t g_vp932i_u16LastFrameNumberSearched = 0;	// last frame number we searched for
+void vp932i_ctx_save(const VP932Ctx_t *pCtx, VP932Snapshot_t *pSnap)
+{
+	ldpin_snapshot_header_init(&pSnap->hdr, LDPIN_TRACE_VP932, VP932_SNAPSHOT_VERSION, sizeof(pCtx->state));
+	memcpy(&pSnap->state, &pCtx->state, sizeof(pCtx->state));	// padding included, so equal states give equal snapshots
+}
 
-#define VP932I_TX_WRAP(var) 	if (var > g_vp932i_pTxBufLastGoodPtr) var = g_vp932i_tx_buf;
+VP932_BOOL vp932i_ctx_restore(VP932Ctx_t *pCtx, const VP932Snapshot_t *pSnap)
+{
+	if (!ldpin_snapshot_header_check(&pSnap->hdr, LDPIN_TRACE_VP932, VP932_SNAPSHOT_VERSION, sizeof(pCtx->state)))
+	{
+		return VP932_FALSE;
+	}
 
-uint8_t g_vp932i_rx_buf[12];	// should be as small as possible to save space
-uint8_t g_vp932i_rx_buf_idx = 0;	// current position of rx buf (0 means buffer is empty)
+	// rx_buf_idx bounds the reads of rx_buf
+	if ((pSnap->state.rx_buf_idx > VP932_RX_BUFSIZE) || (ldpin_ring8_count(&pSnap->state.tx) > LDP_IN_RING_SIZE))
+	{
+		return VP932_FALSE;
+	}
 
-//////////////////////////////////
+	memcpy(&pCtx->state, &pSnap->state, sizeof(pCtx->state));
+	return VP932_TRUE;
+}
 
-void vp932i_reset()
+#if LDP_IN_FLIGHT_SIZE != 0
+uint8_t vp932i_ctx_flight_read(VP932Ctx_t *pCtx, LDPInFlightRecord_t *pDst, uint8_t u8Cap)
 {
-	g_vp932i_state = VP932_STATE_NORMAL;
-	g_vp932i_play_after_search = VP932_FALSE;
-	g_vp932i_pTxBufStart = g_vp932i_pTxBufEnd = g_vp932i_tx_buf;
-	g_vp932i_u8TxBufCount = 0;
-	g_vp932i_u16LastFrameNumberSearched = 0;
+	return ldpin_flight_read(&pCtx->flight, pDst, u8Cap);
 }
+#endif
 
-void vp932i_push_tx_queue(uint8_t u8Val)
+void vp932i_ctx_reset(VP932Ctx_t *pCtx)
 {
-	*g_vp932i_pTxBufEnd = u8Val;
-	g_vp932i_pTxBufEnd++;
-	VP932I_TX_WRAP(g_vp932i_pTxBufEnd);
-	g_vp932i_u8TxBufCount++;
-
-	// we should never get close to this
-//	assert(g_vp932i_u8TxBufCount < sizeof(g_vp932i_tx_buf));
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_RESET, LDPIN_TRACE_VP932, 0);
+	VP932I_SET_STATE(pCtx, VP932_STATE_NORMAL);
+	pCtx->state.play_after_search = VP932_FALSE;
+	ldpin_ring8_reset(&pCtx->state.tx);
+	pCtx->state.u16LastFrameNumberSearched = 0;
 }
 
-uint8_t vp932i_pop_tx_queue()
+#ifdef LDP_IN_COUNTERS
+static LDPInCmdClass_t vp932i_cmd_class(uint8_t u8Val)
 {
-	uint8_t u8Res = *g_vp932i_pTxBufStart;
-	g_vp932i_pTxBufStart++;
-	VP932I_TX_WRAP(g_vp932i_pTxBufStart);
-	g_vp932i_u8TxBufCount--;
-
-	// sanity check
-//	assert(g_vp932i_u8TxBufCount != -1);
-
-	return u8Res;
+	switch (u8Val)
+	{
+	case '0': case '1': case '2': case '3': case '4':
+	case '5': case '6': case '7': case '8': case '9':
+		return LDPIN_CMD_DIGIT;
+	case 'L': case 'M': case 'S': case 'U': case 'V': case '*':
+		return LDPIN_CMD_PLAY;
+	case 'F': case 'N': case 'R':
+		return LDPIN_CMD_SEARCH;
+	case 'D':
+		return LDPIN_CMD_AV;
+	default:
+		return LDPIN_CMD_OTHER;
+	}
 }
+#endif // LDP_IN_COUNTERS
 
-void vp932i_process_rx_buf()
+void vp932i_process_rx_buf(VP932Ctx_t *pCtx)
 {
 	uint8_t u8Idx = 0;
 	uint8_t u8Val = 0;
@@ -86,9 +157,10 @@ void vp932i_process_rx_buf()
 	uint16_t u16Number = 0;	// number, such as a frame number
 
 	// go until we get to the end of the buffer
-	while (u8Idx < g_vp932i_rx_buf_idx)
+	while (u8Idx < pCtx->state.rx_buf_idx)
 	{
-		u8Val = g_vp932i_rx_buf[u8Idx++];
+		u8Val = pCtx->state.rx_buf[u8Idx++];
+		LDPIN_COUNT_CMD(pCtx, vp932i_cmd_class(u8Val));
 
 		switch (u8Val)
 		{
@@ -116,11 +188,11 @@ void vp932i_process_rx_buf()
 			break;
 
 		case 'L':	// step forward
-			g_vp932i_step(VP932_FALSE);
+			VP932I_CB(pCtx, step)(pCtx->pUser, VP932_FALSE);
 			break;
 
 		case 'M':	// step reverse
-			g_vp932i_step(VP932_TRUE);
+			VP932I_CB(pCtx, step)(pCtx->pUser, VP932_TRUE);
 			break;
 
 		case 'N':	// complete search, then play
@@ -128,15 +200,16 @@ void vp932i_process_rx_buf()
 			{
 				// if they try to search to the frame that we're already on, then just play
 				// (DL Euro does this for every scene)
-				if (g_vp932i_u16LastFrameNumberSearched != u16Number)
+				if (pCtx->state.u16LastFrameNumberSearched != u16Number)
 				{
-					g_vp932i_u16LastFrameNumberSearched = u16Number;
-					g_vp932i_begin_search(u16Number);
+					pCtx->state.u16LastFrameNumberSearched = u16Number;
+					VP932I_CB(pCtx, begin_search)(pCtx->pUser, u16Number);
+					LDPIN_COUNT_SEARCH_START(pCtx);
 				}
 				// else we don't initiate a new search, but we still want to return the expected status code so we pretend like we are searching
 
-				g_vp932i_play_after_search = VP932_TRUE;
-				g_vp932i_state = VP932_STATE_SEARCHING;
+				pCtx->state.play_after_search = VP932_TRUE;
+				VP932I_SET_STATE(pCtx, VP932_STATE_SEARCHING);
 
 			}
 
@@ -149,15 +222,16 @@ void vp932i_process_rx_buf()
 			{
 				// if they try to search to the frame that we're already on, then just ignore
 				// (Sidam DL does this for diagnostics mode)
-				if (g_vp932i_u16LastFrameNumberSearched != u16Number)
+				if (pCtx->state.u16LastFrameNumberSearched != u16Number)
 				{
-					g_vp932i_u16LastFrameNumberSearched = u16Number;
-					g_vp932i_begin_search(u16Number);
+					pCtx->state.u16LastFrameNumberSearched = u16Number;
+					VP932I_CB(pCtx, begin_search)(pCtx->pUser, u16Number);
+					LDPIN_COUNT_SEARCH_START(pCtx);
 				}
 				// else we don't initiate a new search, but we still want to return the expected status code so we pretend like we are searching
 
-				g_vp932i_play_after_search = VP932_FALSE;
-				g_vp932i_state = VP932_STATE_SEARCHING;
+				pCtx->state.play_after_search = VP932_FALSE;
+				VP932I_SET_STATE(pCtx, VP932_STATE_SEARCHING);
 			}
 			bSearchCmdActive = VP932_FALSE;
 			break;
@@ -170,19 +244,19 @@ void vp932i_process_rx_buf()
 
 		case 'U':	// initiate multi-speed playback with audio muted
 
-			g_vp932i_u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
+			pCtx->state.u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
 
 			// DL Euro does not change multi-speed playback speed (to our knowledge) so we hard-code 1/1
-			g_vp932i_play(1, 1, VP932_FALSE, VP932_TRUE);
+			VP932I_CB(pCtx, play)(pCtx->pUser, 1, 1, VP932_FALSE, VP932_TRUE);
 
 			break;
 
 		case 'V':	// initiate multi-speed playback, reverse
 
-			g_vp932i_u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
+			pCtx->state.u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
 
 			// DL Euro does not change multi-speed playback speed (to our knowledge) so we hard-code 1/1
-			g_vp932i_play(1, 1, VP932_TRUE, VP932_TRUE);
+			VP932I_CB(pCtx, play)(pCtx->pUser, 1, 1, VP932_TRUE, VP932_TRUE);
 
 			break;
 
@@ -191,39 +265,44 @@ void vp932i_process_rx_buf()
 			bSearchCmdActive = VP932_FALSE;
 			break;
 		case '*':	// pause
-			g_vp932i_pause();
+			VP932I_CB(pCtx, pause)(pCtx->pUser);
 			break;
 		default:
-			g_vp932i_error(VP932_ERR_UNKNOWN_CMD_BYTE, u8Val);
+			VP932I_ERROR(pCtx, VP932_ERR_UNKNOWN_CMD_BYTE, u8Val);
 			break;
 		}
 	}
 
 	// now that buffer is processed, we need to empty it to prepare to receive the next buffer
-	g_vp932i_rx_buf_idx = 0;
+	pCtx->state.rx_buf_idx = 0;
 }
 
-void vp932i_write(uint8_t u8Byte)
+void vp932i_ctx_write(VP932Ctx_t *pCtx, uint8_t u8Byte)
 {
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_WRITE, LDPIN_TRACE_VP932, u8Byte);
+	LDPIN_COUNT(pCtx, u32BytesIn);
+
 	switch (u8Byte)
 	{
 	case 0x00:	// behaves like clear (undocumented, inferred from observed behavior)
-		g_vp932i_rx_buf_idx = 0;		
+		pCtx->state.rx_buf_idx = 0;		
 		break;
 	case 0x0D:	// carriage return (end of command)
-		vp932i_process_rx_buf();
+		vp932i_process_rx_buf(pCtx);
 		break;
 
 	default:
 
-		if (g_vp932i_rx_buf_idx < sizeof(g_vp932i_rx_buf))
+		if (pCtx->state.rx_buf_idx < sizeof(pCtx->state.rx_buf))
 		{
-			g_vp932i_rx_buf[g_vp932i_rx_buf_idx++] = u8Byte;
+			pCtx->state.rx_buf[pCtx->state.rx_buf_idx++] = u8Byte;
+			LDPIN_COUNT_RX(pCtx, pCtx->state.rx_buf_idx);
 		}
 		// else we've overflowed our buffer; we either need to make it bigger or we probably have a bug
 		else
 		{
-			g_vp932i_error(VP932_ERR_RX_BUF_OVERFLOW,
+			LDPIN_COUNT(pCtx, u32RxOverflows);
+			VP932I_ERROR(pCtx, VP932_ERR_RX_BUF_OVERFLOW,
 
 				// nothing meaningful to put for the value so just put 0
 				0);
@@ -233,44 +312,83 @@ void vp932i_write(uint8_t u8Byte)
 	}
 }
 
-VP932_BOOL vp932i_can_read()
+VP932_BOOL vp932i_ctx_can_read(VP932Ctx_t *pCtx)
 {
-	return (VP932_BOOL) (g_vp932i_u8TxBufCount != 0);
+	return (VP932_BOOL) (ldpin_ring8_count(&pCtx->state.tx) != 0);
 }
 
-uint8_t vp932i_read()
+uint8_t vp932i_ctx_read(VP932Ctx_t *pCtx)
 {
-//	assert(g_vp932i_u8TxBufCount > 0);
-	return vp932i_pop_tx_queue();
+//	assert(ldpin_ring8_count(&pCtx->state.tx) > 0);
+	LDPIN_COUNT(pCtx, u32BytesOut);
+	return ldpin_ring8_pop(&pCtx->state.tx);
 }
 
-void vp932i_think_during_vblank(VP932Status_t status)
+void vp932i_ctx_write_n(VP932Ctx_t *pCtx, const uint8_t *p8Src, uint16_t u16Len)
+{
+	while (u16Len != 0)
+	{
+		vp932i_ctx_write(pCtx, *p8Src++);
+		u16Len--;
+	}
+}
+
+uint16_t vp932i_ctx_read_n(VP932Ctx_t *pCtx, uint8_t *pDst, uint16_t u16Cap)
+{
+	uint16_t u16Read = 0;
+
+	while ((u16Read < u16Cap) && (ldpin_ring8_count(&pCtx->state.tx) != 0))
+	{
+		pDst[u16Read++] = ldpin_ring8_pop(&pCtx->state.tx);
+	}
+
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u16Read);
+	return u16Read;
+}
+
+const uint8_t *vp932i_ctx_tx_peek(VP932Ctx_t *pCtx, uint8_t *pu8Count)
+{
+	return ldpin_ring8_peek(&pCtx->state.tx, pu8Count);
+}
+
+void vp932i_ctx_tx_commit(VP932Ctx_t *pCtx, uint8_t u8Count)
 {
+	ldpin_ring8_commit(&pCtx->state.tx, u8Count);
+	LDPIN_COUNT_N(pCtx, u32BytesOut, u8Count);
+}
+
+void vp932i_ctx_think_during_vblank(VP932Ctx_t *pCtx, VP932Status_t status)
+{
+	LDPIN_TRACE(pCtx, LDPIN_TRACE_VBLANK, LDPIN_TRACE_VP932, status);
+	LDPIN_COUNT(pCtx, u32VBlanks);
+	LDPIN_FLIGHT_VBLANK(pCtx);
+
 	// if we're in the middle of a search
-	if (g_vp932i_state == VP932_STATE_SEARCHING)
+	if (pCtx->state.state == VP932_STATE_SEARCHING)
 	{
 		switch (status)
 		{
 		case VP932_PAUSED:
-			if (g_vp932i_play_after_search == VP932_TRUE)
+			if (pCtx->state.play_after_search == VP932_TRUE)
 			{
 				// A1 to be returned after successful search+play
-				vp932i_push_tx_queue('A');
-				vp932i_push_tx_queue('1');
-				vp932i_push_tx_queue('\r');
+				LDPIN_TX8_PUSH(pCtx, 'A');
+				LDPIN_TX8_PUSH(pCtx, '1');
+				LDPIN_TX8_PUSH(pCtx, '\r');
 
-				g_vp932i_u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
+				pCtx->state.u16LastFrameNumberSearched = 0;	// once we play, this check no longer applies
 
-				g_vp932i_play(1, 1, VP932_FALSE, VP932_FALSE);
+				VP932I_CB(pCtx, play)(pCtx->pUser, 1, 1, VP932_FALSE, VP932_FALSE);
 			}
 			else
 			{
 				// A0 to be returned after successful search
-				vp932i_push_tx_queue('A');
-				vp932i_push_tx_queue('0');
-				vp932i_push_tx_queue('\r');
+				LDPIN_TX8_PUSH(pCtx, 'A');
+				LDPIN_TX8_PUSH(pCtx, '0');
+				LDPIN_TX8_PUSH(pCtx, '\r');
 			}
-			g_vp932i_state = VP932_STATE_NORMAL;	// search is done, we're back to normal
+			VP932I_SET_STATE(pCtx, VP932_STATE_NORMAL);	// search is done, we're back to normal
+			LDPIN_COUNT_SEARCH_DONE(pCtx);
 			break;
 		case VP932_SEARCHING:
 			// if we're still searching, nothing to do
@@ -283,3 +401,54 @@ void vp932i_think_during_vblank(VP932Status_t status)
 	}
 }
 
+//////////////////////////////////
+
+void vp932i_reset()
+{
+	vp932i_ctx_reset(&g_vp932i_ctx);
+}
+
+void vp932i_write(uint8_t u8Byte)
+{
+	vp932i_ctx_write(&g_vp932i_ctx, u8Byte);
+}
+
+VP932_BOOL vp932i_can_read()
+{
+	return vp932i_ctx_can_read(&g_vp932i_ctx);
+}
+
+uint8_t vp932i_read()
+{
+	return vp932i_ctx_read(&g_vp932i_ctx);
+}
+
+void vp932i_write_n(const uint8_t *p8Src, uint16_t u16Len)
+{
+	vp932i_ctx_write_n(&g_vp932i_ctx, p8Src, u16Len);
+}
+
+uint16_t vp932i_read_n(uint8_t *pDst, uint16_t u16Cap)
+{
+	return vp932i_ctx_read_n(&g_vp932i_ctx, pDst, u16Cap);
+}
+
+const uint8_t *vp932i_tx_peek(uint8_t *pu8Count)
+{
+	return vp932i_ctx_tx_peek(&g_vp932i_ctx, pu8Count);
+}
+
+void vp932i_tx_commit(uint8_t u8Count)
+{
+	vp932i_ctx_tx_commit(&g_vp932i_ctx, u8Count);
+}
+
+void vp932i_think_during_vblank(VP932Status_t status)
+{
+	vp932i_ctx_think_during_vblank(&g_vp932i_ctx, status);
+}
+
+VP932Ctx_t *vp932i_get_default_ctx()
+{
+	return &g_vp932i_ctx;
+}
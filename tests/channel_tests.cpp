@@ -0,0 +1,170 @@
+#include "stdafx.h"
+#include <ldp-in/channel.h>
+#include <thread>
+
+void test_chan_init_sizes()
+{
+	LDPInChan_t chan;
+	uint8_t buf[128];
+
+	TEST_CHECK_EQUAL(0, ldpin_chan_init(&chan, buf, 0));
+	TEST_CHECK_EQUAL(0, ldpin_chan_init(&chan, buf, 1));
+	TEST_CHECK_EQUAL(0, ldpin_chan_init(&chan, buf, 12));
+	TEST_CHECK_EQUAL(0, ldpin_chan_init(&chan, buf, 255));
+	TEST_CHECK(ldpin_chan_init(&chan, buf, 2) != 0);
+	TEST_CHECK(ldpin_chan_init(&chan, buf, 128) != 0);
+	TEST_CHECK_EQUAL(0, ldpin_chan_count(&chan));
+}
+
+TEST_CASE(chan_init_sizes)
+{
+	test_chan_init_sizes();
+}
+
+void test_chan_fifo_and_overflow()
+{
+	LDPInChan_t chan;
+	uint8_t buf[8];
+	uint8_t u8Val = 0;
+
+	TEST_REQUIRE(ldpin_chan_init(&chan, buf, sizeof(buf)) != 0);
+	TEST_CHECK_EQUAL(0, ldpin_chan_get(&chan, &u8Val));
+
+	// go around the free-running indices more than once
+	for (int i = 0; i < 600; i++)
+	{
+		TEST_REQUIRE(ldpin_chan_put(&chan, (uint8_t) i) != 0);
+		TEST_REQUIRE(ldpin_chan_put(&chan, (uint8_t) (i + 1)) != 0);
+		TEST_REQUIRE_EQUAL(2, ldpin_chan_count(&chan));
+		TEST_REQUIRE(ldpin_chan_get(&chan, &u8Val) != 0);
+		TEST_REQUIRE_EQUAL((uint8_t) i, u8Val);
+		TEST_REQUIRE(ldpin_chan_get(&chan, &u8Val) != 0);
+		TEST_REQUIRE_EQUAL((uint8_t) (i + 1), u8Val);
+	}
+
+	// fill it, then the next two are dropped and counted
+	for (int i = 0; i < 8; i++)
+	{
+		TEST_REQUIRE(ldpin_chan_put(&chan, (uint8_t) (0x40 + i)) != 0);
+	}
+	TEST_CHECK_EQUAL(0, ldpin_chan_put(&chan, 0xEE));
+	TEST_CHECK_EQUAL(0, ldpin_chan_put(&chan, 0xEE));
+	TEST_CHECK_EQUAL(8, ldpin_chan_count(&chan));
+	TEST_CHECK_EQUAL(2, chan.u8Overflows);
+
+	for (int i = 0; i < 8; i++)
+	{
+		TEST_REQUIRE(ldpin_chan_get(&chan, &u8Val) != 0);
+		TEST_CHECK_EQUAL(0x40 + i, u8Val);
+	}
+	TEST_CHECK_EQUAL(0, ldpin_chan_get(&chan, &u8Val));
+}
+
+TEST_CASE(chan_fifo_and_overflow)
+{
+	test_chan_fifo_and_overflow();
+}
+
+void test_chan_batches()
+{
+	LDPInChan_t chan;
+	uint8_t buf[8];
+	const uint8_t src[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	uint8_t dst[10];
+	uint8_t u8Count = 0;
+	const uint8_t *p8;
+
+	TEST_REQUIRE(ldpin_chan_init(&chan, buf, sizeof(buf)) != 0);
+
+	// move the indices to the middle of the buffer
+	TEST_REQUIRE_EQUAL(5, ldpin_chan_put_n(&chan, src, 5));
+	TEST_REQUIRE_EQUAL(5, ldpin_chan_get_n(&chan, dst, sizeof(dst)));
+
+	// only 8 fit
+	TEST_CHECK_EQUAL(8, ldpin_chan_put_n(&chan, src, 10));
+	TEST_CHECK_EQUAL(2, chan.u8Overflows);
+
+	// the first peek stops at the end of the buffer, the second gets the rest
+	p8 = ldpin_chan_peek(&chan, &u8Count);
+	TEST_REQUIRE_EQUAL(3, u8Count);
+	TEST_CHECK_EQUAL(0, memcmp(p8, src, 3));
+	ldpin_chan_commit(&chan, u8Count);
+	TEST_CHECK_EQUAL(5, ldpin_chan_count(&chan));
+
+	p8 = ldpin_chan_peek(&chan, &u8Count);
+	TEST_REQUIRE_EQUAL(5, u8Count);
+	TEST_CHECK_EQUAL(0, memcmp(p8, src + 3, 5));
+	ldpin_chan_commit(&chan, 2);
+
+	TEST_REQUIRE_EQUAL(3, ldpin_chan_get_n(&chan, dst, sizeof(dst)));
+	TEST_CHECK_EQUAL(0, memcmp(dst, src + 5, 3));
+
+	p8 = ldpin_chan_peek(&chan, &u8Count);
+	TEST_CHECK_EQUAL(0, u8Count);
+}
+
+TEST_CASE(chan_batches)
+{
+	test_chan_batches();
+}
+
+// the two sides on their own threads, as an interrupt handler and main loop (or two cores) would be
+void test_chan_two_threads()
+{
+	LDPInChan_t chan;
+	uint8_t buf[16];
+	const uint32_t u32Total = 200000;
+	uint32_t u32Mismatches = 0;
+
+	TEST_REQUIRE(ldpin_chan_init(&chan, buf, sizeof(buf)) != 0);
+
+	std::thread producer([&chan, u32Total]()
+	{
+		uint32_t u32Sent = 0;
+		while (u32Sent < u32Total)
+		{
+			if (ldpin_chan_put(&chan, (uint8_t) (u32Sent * 7)))
+			{
+				u32Sent++;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t u32Received = 0;
+	while (u32Received < u32Total)
+	{
+		uint8_t u8Count = 0;
+		const uint8_t *p8 = ldpin_chan_peek(&chan, &u8Count);
+
+		if (u8Count == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (uint8_t u = 0; u < u8Count; u++)
+		{
+			if (p8[u] != (uint8_t) ((u32Received + u) * 7))
+			{
+				u32Mismatches++;
+			}
+		}
+		ldpin_chan_commit(&chan, u8Count);
+		u32Received += u8Count;
+	}
+
+	producer.join();
+
+	TEST_CHECK_EQUAL(u32Total, u32Received);
+	TEST_CHECK_EQUAL(0, u32Mismatches);
+	TEST_CHECK_EQUAL(0, ldpin_chan_count(&chan));
+}
+
+TEST_CASE(chan_two_threads)
+{
+	test_chan_two_threads();
+}
@@ -0,0 +1,146 @@
+#include "stdafx.h"
+#include <ldp-in/convert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_convert_u32_to_ascii5()
+{
+	// every frame number a disc can hold
+	for (uint32_t u = 0; u <= 99999; u++)
+	{
+		char expected[6];
+		uint8_t actual[5];
+		sprintf(expected, "%05u", u);
+		ldpin_u32_to_ascii5(u, actual);
+		TEST_REQUIRE(memcmp(expected, actual, 5) == 0);
+	}
+
+	// only the lower 5 digits are kept
+	uint8_t actual[5];
+	ldpin_u32_to_ascii5(123456, actual);
+	TEST_CHECK(memcmp("23456", actual, 5) == 0);
+	ldpin_u32_to_ascii5(0xFFFFFFFF, actual);
+	TEST_CHECK(memcmp("67295", actual, 5) == 0);
+}
+
+TEST_CASE(convert_u32_to_ascii5)
+{
+	test_convert_u32_to_ascii5();
+}
+
+void test_convert_bcd5()
+{
+	for (uint32_t u = 0; u <= 99999; u++)
+	{
+		uint8_t bcd[3];
+		ldpin_u32_to_bcd5(u, bcd);
+		TEST_REQUIRE_EQUAL((uint8_t) (u / 10000), bcd[0]);
+		TEST_REQUIRE_EQUAL((uint8_t) ((((u / 1000) % 10) << 4) | ((u / 100) % 10)), bcd[1]);
+		TEST_REQUIRE_EQUAL((uint8_t) ((((u / 10) % 10) << 4) | (u % 10)), bcd[2]);
+		TEST_REQUIRE_EQUAL(u, ldpin_bcd5_to_u32(bcd[0], bcd[1], bcd[2]));
+	}
+
+	// upper nibble of the first byte is ignored
+	TEST_CHECK_EQUAL(12345, ldpin_bcd5_to_u32(0xF1, 0x23, 0x45));
+}
+
+TEST_CASE(convert_bcd5)
+{
+	test_convert_bcd5();
+}
+
+void test_convert_bcd3()
+{
+	for (uint16_t u = 0; u <= 999; u++)
+	{
+		uint8_t u8Hi = (uint8_t) (u / 100);
+		uint8_t u8Lo = (uint8_t) ((((u / 10) % 10) << 4) | (u % 10));
+		TEST_REQUIRE_EQUAL(u, ldpin_bcd3_to_u16(u8Hi, u8Lo));
+		TEST_REQUIRE_EQUAL(u, ldpin_bcd3_to_u16(u8Hi | 0xF0, u8Lo));
+	}
+}
+
+TEST_CASE(convert_bcd3)
+{
+	test_convert_bcd3();
+}
+
+void test_convert_ascii5_to_u32()
+{
+	for (uint32_t u = 0; u <= 99999; u++)
+	{
+		char s[6];
+		sprintf(s, "%05u", u);
+		TEST_REQUIRE_EQUAL(u, ldpin_ascii5_to_u32(s));
+	}
+
+	// short and empty buffers, the way the interpreters hold a partly entered number
+	const char *arr[] = { "", "7", "12", "305", "9999", "00042", "1234\0" "9", "12a45" };
+	for (size_t i = 0; i < sizeof(arr) / sizeof(arr[0]); i++)
+	{
+		TEST_CHECK_EQUAL((uint32_t) strtoul(arr[i], NULL, 10), ldpin_ascii5_to_u32(arr[i]));
+	}
+
+	// stops after 5 digits even without a terminator
+	TEST_CHECK_EQUAL(12345, ldpin_ascii5_to_u32("123456"));
+}
+
+TEST_CASE(convert_ascii5_to_u32)
+{
+	test_convert_ascii5_to_u32();
+}
+
+void test_convert_append_digit()
+{
+	uint32_t u32Val = 0;
+	const uint8_t digits[] = { 4, 2, 9, 4, 9, 6, 7, 2, 9 };
+	uint32_t u32Expected = 0;
+
+	for (size_t i = 0; i < sizeof(digits); i++)
+	{
+		u32Val = ldpin_append_digit(u32Val, digits[i]);
+		u32Expected = u32Expected * 10 + digits[i];
+		TEST_REQUIRE_EQUAL(u32Expected, u32Val);
+	}
+
+	TEST_CHECK_EQUAL(429496729, u32Val);
+	TEST_CHECK_EQUAL(0, ldpin_append_digit(0, 0));
+}
+
+TEST_CASE(convert_append_digit)
+{
+	test_convert_append_digit();
+}
+
+void test_convert_frame_cache()
+{
+	LDPInFrameCache_t cache;
+	ldpin_frame_cache_reset(&cache);
+	TEST_CHECK_EQUAL(0, cache.u8Valid);
+
+	// count up through every frame (and past the 5th digit) incrementally, then check against a fresh conversion
+	ldpin_frame_cache_set(&cache, 0);
+	for (uint32_t u = 1; u <= 100010; u++)
+	{
+		uint8_t expected[5];
+		ldpin_frame_cache_set(&cache, u);
+		ldpin_u32_to_ascii5(u, expected);
+		TEST_REQUIRE(memcmp(expected, cache.au8Ascii, 5) == 0);
+		TEST_REQUIRE_EQUAL(u, cache.u32Frame);
+	}
+
+	// jumps and repeats
+	ldpin_frame_cache_set(&cache, 500);
+	TEST_CHECK(memcmp("00500", cache.au8Ascii, 5) == 0);
+	ldpin_frame_cache_set(&cache, 500);
+	TEST_CHECK(memcmp("00500", cache.au8Ascii, 5) == 0);
+	ldpin_frame_cache_set(&cache, 499);
+	TEST_CHECK(memcmp("00499", cache.au8Ascii, 5) == 0);
+	TEST_CHECK(cache.u8Valid != 0);
+}
+
+TEST_CASE(convert_frame_cache)
+{
+	test_convert_frame_cache();
+}
@@ -0,0 +1,259 @@
+#include "stdafx.h"
+#include <ldp-in/counters.h>
+
+// these only mean something in a LDP_IN_COUNTERS build (cmake -DLDP_IN_COUNTERS=ON)
+#ifdef LDP_IN_COUNTERS
+
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <string.h>
+#include "ctx_test_init.h"
+
+static void counters_test_vp932_error(void *pUser, VP932ErrCode_t code, uint8_t u8Val) { }
+static void counters_test_ldp1000_error(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val) { }
+static LDV1000Status_t counters_test_ldv1000_status(void *pUser) { return LDV1000_PAUSED; }
+
+// the clock reads the time its pUser points to
+static uint32_t counters_test_micros(void *pUser) { return *(uint32_t *) pUser; }
+
+static void counters_test_write_str(VP932Ctx_t *pCtx, const char *pszStr)
+{
+	vp932i_ctx_write_n(pCtx, (const uint8_t *) pszStr, (uint16_t) strlen(pszStr));
+}
+
+void test_counters_vp932()
+{
+	VP932Ctx_t ctx;
+	VP932Callbacks_t cb;
+	uint8_t buf[8];
+
+	cb = ctx_test_callbacks<VP932Callbacks_t>();
+	cb.begin_search = ctx_test_begin_search;
+	cb.error = counters_test_vp932_error;
+	ctx_test_init(&ctx, cb);
+
+	counters_test_write_str(&ctx, "F1234R\r");
+	TEST_CHECK_EQUAL(1234, g_u32CtxTestSearchFrame);
+	vp932i_ctx_think_during_vblank(&ctx, VP932_SEARCHING);
+	vp932i_ctx_think_during_vblank(&ctx, VP932_PAUSED);	// A0
+	TEST_REQUIRE_EQUAL(3, vp932i_ctx_read_n(&ctx, buf, sizeof(buf)));
+
+	const LDPInCounters_t &c = ctx.counters;
+	TEST_CHECK_EQUAL(7, c.u32BytesIn);
+	TEST_CHECK_EQUAL(3, c.u32BytesOut);
+	TEST_CHECK_EQUAL(4, c.au32Cmds[LDPIN_CMD_DIGIT]);
+	TEST_CHECK_EQUAL(2, c.au32Cmds[LDPIN_CMD_SEARCH]);	// F and R
+	TEST_CHECK_EQUAL(0, c.au32Cmds[LDPIN_CMD_PLAY]);
+	TEST_CHECK_EQUAL(1, c.u32SearchesStarted);
+	TEST_CHECK_EQUAL(1, c.u32SearchesCompleted);
+	TEST_CHECK_EQUAL(0, c.u32SearchesFailed);
+	TEST_CHECK_EQUAL(2, c.u32VBlanks);
+	TEST_CHECK_EQUAL(3, c.u8TxHighWater);
+	TEST_CHECK_EQUAL(6, c.u8RxHighWater);	// carriage return isn't buffered
+	TEST_CHECK_EQUAL(0, c.u32RxOverflows);
+
+	// one byte more than the receive buffer holds
+	for (uint8_t u = 0; u <= VP932_RX_BUFSIZE; u++)
+	{
+		vp932i_ctx_write(&ctx, '*');
+	}
+	TEST_CHECK_EQUAL(VP932_RX_BUFSIZE, c.u8RxHighWater);
+	TEST_CHECK_EQUAL(1, c.u32RxOverflows);
+	TEST_CHECK_EQUAL(1, c.au32Errors[VP932_ERR_RX_BUF_OVERFLOW]);
+
+	// a reset leaves them alone, init clears them
+	vp932i_ctx_reset(&ctx);
+	TEST_CHECK_EQUAL(7 + VP932_RX_BUFSIZE + 1, c.u32BytesIn);
+	vp932i_ctx_init(&ctx, &cb, 0);
+	TEST_CHECK_EQUAL(0, c.u32BytesIn);
+	TEST_CHECK_EQUAL(0, c.u8RxHighWater);
+}
+
+TEST_CASE(counters_vp932)
+{
+	test_counters_vp932();
+}
+
+void test_counters_tx_overflow()
+{
+	LDP1000Ctx_t ctx;
+	LDP1000Callbacks_t cb;
+
+	cb = ctx_test_callbacks<LDP1000Callbacks_t>();
+	cb.error = counters_test_ldp1000_error;
+	ctx_test_init(&ctx, cb);
+
+	// every digit is acknowledged (the sixth and later with an error), and nothing is read
+	for (uint16_t u = 0; u < LDP_IN_RING_SIZE + 2; u++)
+	{
+		ldp1000i_ctx_write(&ctx, 0x31);
+	}
+
+	const LDPInCounters_t &c = ctx.counters;
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE + 2, c.au32Cmds[LDPIN_CMD_DIGIT]);
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE + 2 - 5, c.au32Errors[LDP1000_ERR_TOO_MANY_DIGITS]);
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE, c.u8TxHighWater);
+	TEST_CHECK_EQUAL(2, c.u32TxOverflows);
+	TEST_CHECK_EQUAL(ctx.state.tx.u8Overflows, c.u32TxOverflows);
+
+	// draining the queue doesn't lower the high-water mark
+	uint8_t u8Count;
+	ldp1000i_ctx_tx_peek(&ctx, &u8Count);
+	ldp1000i_ctx_tx_commit(&ctx, u8Count - 1);
+	ldp1000i_ctx_read(&ctx);
+	TEST_CHECK_EQUAL(u8Count, c.u32BytesOut);
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE, c.u8TxHighWater);
+}
+
+TEST_CASE(counters_tx_overflow)
+{
+	test_counters_tx_overflow();
+}
+
+void test_counters_error_clamp()
+{
+	LDPInCounters_t c;
+
+	ldpin_counters_reset(&c);
+	ldpin_counters_error(&c, 2);
+	ldpin_counters_error(&c, LDPIN_COUNTERS_MAX_ERRORS - 1);
+	ldpin_counters_error(&c, 200);
+	TEST_CHECK_EQUAL(1, c.au32Errors[2]);
+	TEST_CHECK_EQUAL(2, c.au32Errors[LDPIN_COUNTERS_MAX_ERRORS - 1]);
+}
+
+TEST_CASE(counters_error_clamp)
+{
+	test_counters_error_clamp();
+}
+
+void test_counters_search_latency()
+{
+	VP932Ctx_t ctx;
+	VP932Callbacks_t cb;
+
+	cb = ctx_test_callbacks<VP932Callbacks_t>();
+	cb.begin_search = ctx_test_begin_search;
+	ctx_test_init(&ctx, cb);
+	uint32_t u32Micros = 0xFFFF0000;	// wraps during the search
+	ldpin_counters_set_clock(&ctx.counters, counters_test_micros, &u32Micros);
+
+	counters_test_write_str(&ctx, "F500R\r");
+	for (int i = 0; i < 5; i++)
+	{
+		u32Micros += 16683;
+		vp932i_ctx_think_during_vblank(&ctx, VP932_SEARCHING);
+	}
+	u32Micros += 16683;
+	vp932i_ctx_think_during_vblank(&ctx, VP932_PAUSED);
+
+	// 6 vblanks and 100098 us (97 units of 1024 us)
+	const LDPInLatency_t &lat = ctx.counters.searchLatency;
+	TEST_CHECK_EQUAL(1, lat.au16VBlanks[3]);
+	TEST_CHECK_EQUAL(1, lat.au16Micros[7]);
+	TEST_CHECK_EQUAL(0, lat.u8Pending);
+
+	// the same frame again isn't searched for, so there's nothing to time, but the game still sees a completed search
+	counters_test_write_str(&ctx, "F500R\r");
+	vp932i_ctx_think_during_vblank(&ctx, VP932_PAUSED);
+	TEST_CHECK_EQUAL(1, ctx.counters.u32SearchesStarted);
+	TEST_CHECK_EQUAL(2, ctx.counters.u32SearchesCompleted);
+	TEST_CHECK_EQUAL(1, lat.au16VBlanks[3]);
+	TEST_CHECK_EQUAL(0, lat.au16VBlanks[1]);
+
+	uint8_t buf[LDPIN_LATENCY_EXPORT_SIZE];
+	ldpin_latency_export(&lat, buf);
+	TEST_CHECK_EQUAL(LDPIN_LATENCY_EXPORT_VERSION, buf[0]);
+	TEST_CHECK_EQUAL(LDPIN_LATENCY_BUCKETS, buf[1]);
+	TEST_CHECK_EQUAL(1, buf[2 + (3 * 2)]);
+	TEST_CHECK_EQUAL(1, buf[2 + (LDPIN_LATENCY_BUCKETS * 2) + (7 * 2)]);
+	TEST_CHECK_EQUAL(0, buf[2 + (LDPIN_LATENCY_BUCKETS * 2) + (7 * 2) + 1]);
+}
+
+TEST_CASE(counters_search_latency)
+{
+	test_counters_search_latency();
+}
+
+void test_counters_clock_per_context()
+{
+	VP932Ctx_t ctx;
+	VP932Ctx_t other;
+	VP932Callbacks_t cb;
+	uint32_t u32Micros = 1000;
+	uint32_t u32OtherMicros = 0;
+
+	cb = ctx_test_callbacks<VP932Callbacks_t>();
+	cb.begin_search = ctx_test_begin_search;
+	ctx_test_init(&ctx, cb);
+	ctx_test_init(&other, cb);
+	ldpin_counters_set_clock(&other.counters, counters_test_micros, &u32OtherMicros);
+
+	// a clock given while a search is pending didn't time its start, so that search only gets a vblank sample
+	counters_test_write_str(&ctx, "F500R\r");
+	ldpin_counters_set_clock(&ctx.counters, counters_test_micros, &u32Micros);
+	u32Micros += 5000;
+	vp932i_ctx_think_during_vblank(&ctx, VP932_PAUSED);
+	const LDPInLatency_t &lat = ctx.counters.searchLatency;
+	TEST_CHECK_EQUAL(1, lat.au16VBlanks[1]);
+	for (int i = 0; i < LDPIN_LATENCY_BUCKETS; i++)
+	{
+		TEST_CHECK_EQUAL(0, lat.au16Micros[i]);
+	}
+
+	// resetting the counters keeps the clock, and the next search is timed with it (and not with the other context's)
+	ldpin_counters_reset(&ctx.counters);
+	counters_test_write_str(&ctx, "F600R\r");
+	u32Micros += 3000;	// 2 units of 1024 us
+	vp932i_ctx_think_during_vblank(&ctx, VP932_PAUSED);
+	TEST_CHECK_EQUAL(1, lat.au16Micros[2]);
+	TEST_CHECK_EQUAL(0, other.counters.searchLatency.au16Micros[2]);
+
+	// init forgets it
+	vp932i_ctx_init(&ctx, &cb, 0);
+	TEST_CHECK(ctx.counters.pfnMicros == 0);
+}
+
+TEST_CASE(counters_clock_per_context)
+{
+	test_counters_clock_per_context();
+}
+
+void test_counters_ldv1000_latency()
+{
+	LDV1000Ctx_t ctx;
+	LDV1000Callbacks_t cb;
+
+	cb = ctx_test_callbacks<LDV1000Callbacks_t>();
+	cb.get_status = counters_test_ldv1000_status;
+	cb.begin_search = ctx_test_begin_search;
+	ldv1000i_ctx_init(&ctx, &cb, 0);
+
+	ldv1000i_ctx_write(&ctx, 0x0F);	// 1
+	ldv1000i_ctx_write(&ctx, 0xFF);
+	ldv1000i_ctx_write(&ctx, 0xF7);	// search
+	TEST_CHECK_EQUAL(1, g_u32CtxTestSearchFrame);
+
+	// the host polls once per vblank, and the search lasts at least 4 polls
+	int iVBlanks = 0;
+	do
+	{
+		ldpin_counters_vblank(&ctx.counters);
+		iVBlanks++;
+		ldv1000i_ctx_read(&ctx);
+	} while (ctx.state.search_pending && (iVBlanks < 10));
+
+	TEST_CHECK_EQUAL(5, iVBlanks);
+	TEST_CHECK_EQUAL(5, ctx.counters.u32VBlanks);
+	TEST_CHECK_EQUAL(1, ctx.counters.u32SearchesCompleted);
+	TEST_CHECK_EQUAL(1, ctx.counters.searchLatency.au16VBlanks[3]);	// 4-7
+	TEST_CHECK_EQUAL(0, ctx.counters.searchLatency.au16Micros[0]);	// no clock
+}
+
+TEST_CASE(counters_ldv1000_latency)
+{
+	test_counters_ldv1000_latency();
+}
+
+#endif // LDP_IN_COUNTERS
@@ -0,0 +1,69 @@
+#ifndef LDP_IN_CTX_TEST_INIT_H
+#define LDP_IN_CTX_TEST_INIT_H
+
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <string.h>
+
+// Setting up contexts for the tests of what the interpreters have in common (snapshots, state hashes, counters, the flight
+//  recorder, traces), which only need a callback or two.
+
+// a callbacks struct with every callback 0, for the test to set the ones it needs (any other one being called crashes the test)
+template <typename Callbacks>
+Callbacks ctx_test_callbacks()
+{
+	Callbacks cb;
+	memset(&cb, 0, sizeof(cb));
+	return cb;
+}
+
+// a begin_search callback that notes the frame in g_u32CtxTestSearchFrame
+inline uint32_t g_u32CtxTestSearchFrame = 0;
+inline void ctx_test_begin_search(void *pUser, uint32_t u32FrameNum) { g_u32CtxTestSearchFrame = u32FrameNum; }
+
+// inits pCtx with cb (and no pUser) and resets it; the LDP-1000 is reset as an LDP-1450, and the PR-7820 resets itself in init
+inline void ctx_test_init(LDP1000Ctx_t *pCtx, const LDP1000Callbacks_t &cb)
+{
+	ldp1000i_ctx_init(pCtx, &cb, 0);
+	ldp1000i_ctx_reset(pCtx, LDP1000_EMU_LDP1450);
+}
+
+inline void ctx_test_init(PR7820Ctx_t *pCtx, const PR7820Callbacks_t &cb)
+{
+	pr7820i_ctx_init(pCtx, &cb, 0);
+}
+
+inline void ctx_test_init(VIP9500SGCtx_t *pCtx, const VIP9500SGCallbacks_t &cb)
+{
+	vip9500sgi_ctx_init(pCtx, &cb, 0);
+	vip9500sgi_ctx_reset(pCtx);
+}
+
+inline void ctx_test_init(VP932Ctx_t *pCtx, const VP932Callbacks_t &cb)
+{
+	vp932i_ctx_init(pCtx, &cb, 0);
+	vp932i_ctx_reset(pCtx);
+}
+
+inline void ctx_test_init(LD700Ctx_t *pCtx, const LD700Callbacks_t &cb)
+{
+	ld700i_ctx_init(pCtx, &cb, 0);
+	ld700i_ctx_reset(pCtx);
+}
+
+inline VIP9500SGStatus_t ctx_test_vip9500sg_paused(void *pUser) { return VIP9500SG_PAUSED; }
+
+// a paused VIP9500SG whose searches go to ctx_test_begin_search, inited and reset
+inline void ctx_test_init_vip9500sg(VIP9500SGCtx_t *pCtx)
+{
+	VIP9500SGCallbacks_t cb = ctx_test_callbacks<VIP9500SGCallbacks_t>();
+
+	cb.begin_search = ctx_test_begin_search;
+	cb.get_status = ctx_test_vip9500sg_paused;
+	ctx_test_init(pCtx, cb);
+}
+
+#endif // LDP_IN_CTX_TEST_INIT_H
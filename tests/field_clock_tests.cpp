@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include "field_clock.h"
+
+void test_field_clock_round_trip()
+{
+	for (int iPal = 0; iPal < 2; iPal++)
+	{
+		bool bPal = (iPal != 0);
+
+		// each field is due at the first ns FieldsAt counts it, however far in
+		static const uint64_t au64Fields[] = { 1, 2, 3, 59999, 60000, 60001, 86400ull * 60000 + 7 };
+		for (size_t u = 0; u < sizeof(au64Fields) / sizeof(au64Fields[0]); u++)
+		{
+			uint64_t u64Field = au64Fields[u];
+			uint64_t u64Ns = LDPInFieldClock::FieldNs(u64Field, bPal);
+			TEST_CHECK_EQUAL(u64Field, LDPInFieldClock::FieldsAt(u64Ns, bPal));
+			TEST_CHECK_EQUAL(u64Field - 1, LDPInFieldClock::FieldsAt(u64Ns - 1, bPal));
+		}
+	}
+
+	// NTSC fields are 16683333 1/3 ns, and 60000 of them exactly 1001 s; PAL fields are exactly 20 ms
+	TEST_CHECK_EQUAL(16683334ull, LDPInFieldClock::FieldNs(1, false));
+	TEST_CHECK_EQUAL(33366667ull, LDPInFieldClock::FieldNs(2, false));
+	TEST_CHECK_EQUAL(50050000ull, LDPInFieldClock::FieldNs(3, false));
+	TEST_CHECK_EQUAL(1001000000000ull, LDPInFieldClock::FieldNs(60000, false));
+	TEST_CHECK_EQUAL(86400ull * 1001000000000ull, LDPInFieldClock::FieldNs(86400ull * 60000, false));
+	TEST_CHECK_EQUAL(20000000ull, LDPInFieldClock::FieldNs(1, true));
+	TEST_CHECK_EQUAL(1000000000ull, LDPInFieldClock::FieldNs(50, true));
+	TEST_CHECK_EQUAL(0, LDPInFieldClock::FieldsAt(0, false));
+}
+
+TEST_CASE(field_clock_round_trip)
+{
+	test_field_clock_round_trip();
+}
+
+void test_field_clock_advance()
+{
+	LDPInFieldClock clock;
+	uint64_t u64Start = 5000;
+
+	clock.Start(u64Start, false);
+	TEST_CHECK_EQUAL(u64Start + LDPInFieldClock::FieldNs(1, false), clock.NextAtNs());
+
+	// a timer that fires early runs nothing and isn't late
+	TEST_CHECK_EQUAL(0, clock.LateNs(clock.NextAtNs() - 1));
+	TEST_CHECK_EQUAL(0, clock.Advance(clock.NextAtNs() - 1));
+
+	// on time, one field
+	TEST_CHECK_EQUAL(0, clock.LateNs(clock.NextAtNs()));
+	TEST_CHECK_EQUAL(1, clock.Advance(clock.NextAtNs()));
+	TEST_CHECK_EQUAL(1, clock.Field());
+
+	// a little late: still one field, and how late it was
+	uint64_t u64Now = clock.NextAtNs() + 1234;
+	TEST_CHECK_EQUAL(1234, clock.LateNs(u64Now));
+	TEST_CHECK_EQUAL(1, clock.Advance(u64Now));
+	TEST_CHECK_EQUAL(u64Start + LDPInFieldClock::FieldNs(3, false), clock.NextAtNs());
+
+	// three fields behind: all three run
+	u64Now = u64Start + LDPInFieldClock::FieldNs(5, false);
+	TEST_CHECK_EQUAL(3, clock.Advance(u64Now));
+	TEST_CHECK_EQUAL(0, clock.Skipped());
+
+	// 20 behind: the last LDPIN_FIELD_MAX_CATCH_UP run and the rest are skipped
+	u64Now = u64Start + LDPInFieldClock::FieldNs(25, false);
+	TEST_CHECK_EQUAL(LDPIN_FIELD_MAX_CATCH_UP, clock.Advance(u64Now));
+	TEST_CHECK_EQUAL(20 - LDPIN_FIELD_MAX_CATCH_UP, clock.Skipped());
+	TEST_CHECK_EQUAL(25, clock.Field());
+	TEST_CHECK_EQUAL(u64Start + LDPInFieldClock::FieldNs(26, false), clock.NextAtNs());
+
+	// exactly LDPIN_FIELD_MAX_CATCH_UP behind skips nothing
+	u64Now = u64Start + LDPInFieldClock::FieldNs(25 + LDPIN_FIELD_MAX_CATCH_UP, false);
+	TEST_CHECK_EQUAL(LDPIN_FIELD_MAX_CATCH_UP, clock.Advance(u64Now));
+	TEST_CHECK_EQUAL(20 - LDPIN_FIELD_MAX_CATCH_UP, clock.Skipped());
+}
+
+TEST_CASE(field_clock_advance)
+{
+	test_field_clock_advance();
+}
+
+void test_field_clock_pal()
+{
+	LDPInFieldClock clock;
+
+	// a second of PAL is 50 fields, whichever way it is split up
+	clock.Start(0, true);
+	TEST_CHECK_EQUAL(1, clock.Advance(20000000));
+	TEST_CHECK_EQUAL(0, clock.Advance(39999999));
+	TEST_CHECK_EQUAL(5, clock.Advance(120000000));
+	TEST_CHECK_EQUAL(LDPIN_FIELD_MAX_CATCH_UP, clock.Advance(1000000000));
+	TEST_CHECK_EQUAL(50, clock.Field());
+	TEST_CHECK_EQUAL(50 - 6 - LDPIN_FIELD_MAX_CATCH_UP, clock.Skipped());
+	TEST_CHECK_EQUAL(1020000000ull, clock.NextAtNs());
+}
+
+TEST_CASE(field_clock_pal)
+{
+	test_field_clock_pal();
+}
@@ -0,0 +1,265 @@
+#include "stdafx.h"
+#include <ldp-in/flight.h>
+
+// the flight recorder can be left out with -DLDP_IN_FLIGHT_SIZE=0
+#if LDP_IN_FLIGHT_SIZE != 0
+
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string.h>
+#include "ctx_test_init.h"
+
+static void flight_test_nop(void *pUser) { }
+static void flight_test_ldv1000_error(void *pUser, const char *pszErrMsg) { }
+static LDV1000Status_t g_flightTestLDV1000Status = LDV1000_PAUSED;
+static LDV1000Status_t flight_test_ldv1000_status(void *pUser) { return g_flightTestLDV1000Status; }
+static void flight_test_ext_ack(void *pUser, LD700_BOOL bActive) { }
+
+static void check_flight(const LDPInFlightRecord_t &rec, uint8_t u8Kind, uint8_t u8Interp, uint8_t u8Val, uint16_t u16VBlank)
+{
+	TEST_CHECK_EQUAL(u8Kind, LDPIN_FLIGHT_KIND(rec.u8Event));
+	TEST_CHECK_EQUAL(u8Interp, LDPIN_FLIGHT_INTERP(rec.u8Event));
+	TEST_CHECK_EQUAL(u8Val, rec.u8Val);
+	TEST_CHECK_EQUAL(u16VBlank, rec.u16VBlank);
+}
+
+void test_flight_overwrite()
+{
+	LDPInFlight_t flight;
+	LDPInFlightRecord_t recs[LDP_IN_FLIGHT_SIZE];
+	const uint16_t u16Keep = LDP_IN_FLIGHT_SIZE - 1;	// one slot is always kept free
+
+	ldpin_flight_reset(&flight);
+	TEST_CHECK_EQUAL(0, ldpin_flight_read(&flight, recs, LDP_IN_FLIGHT_SIZE));
+
+	// three more than fit, so the first three are lost
+	for (uint16_t u = 0; u < u16Keep + 3; u++)
+	{
+		ldpin_flight_push(&flight, (uint8_t) ((LDPIN_FLIGHT_STATE << 4) | LDPIN_TRACE_LDP1000), (uint8_t) u);
+		ldpin_flight_vblank(&flight);
+	}
+	TEST_CHECK_EQUAL(3, ldpin_flight_lost(&flight));
+
+	// oldest first, and a partial read leaves the rest
+	TEST_REQUIRE_EQUAL(1, ldpin_flight_read(&flight, recs, 1));
+	check_flight(recs[0], LDPIN_FLIGHT_STATE, LDPIN_TRACE_LDP1000, 3, 3);
+	TEST_REQUIRE_EQUAL(u16Keep - 1, ldpin_flight_read(&flight, recs, LDP_IN_FLIGHT_SIZE));
+	check_flight(recs[u16Keep - 2], LDPIN_FLIGHT_STATE, LDPIN_TRACE_LDP1000, (uint8_t) (u16Keep + 2), u16Keep + 2);
+	TEST_CHECK_EQUAL(0, ldpin_flight_read(&flight, recs, LDP_IN_FLIGHT_SIZE));
+	TEST_CHECK_EQUAL(3, ldpin_flight_lost(&flight));
+
+	// lapping the reader several times still counts every record it missed
+	for (uint16_t u = 0; u < 5000; u++)
+	{
+		ldpin_flight_push(&flight, (uint8_t) ((LDPIN_FLIGHT_ERROR << 4) | LDPIN_TRACE_VP932), (uint8_t) u);
+	}
+	TEST_CHECK_EQUAL(3 + 5000 - u16Keep, ldpin_flight_lost(&flight));
+	TEST_REQUIRE_EQUAL(u16Keep, ldpin_flight_read(&flight, recs, LDP_IN_FLIGHT_SIZE));
+	check_flight(recs[u16Keep - 1], LDPIN_FLIGHT_ERROR, LDPIN_TRACE_VP932, (uint8_t) 4999, u16Keep + 3);
+
+	// the count stops at 0xFFFF (the reader has to look at least once every 65535 records for it to be right)
+	for (uint8_t u = 0; u < 3; u++)
+	{
+		for (uint16_t u16 = 0; u16 < 30000; u16++)
+		{
+			ldpin_flight_push(&flight, (uint8_t) ((LDPIN_FLIGHT_ERROR << 4) | LDPIN_TRACE_VP932), 0);
+		}
+		ldpin_flight_lost(&flight);
+	}
+	TEST_CHECK_EQUAL(0xFFFF, ldpin_flight_lost(&flight));
+
+	ldpin_flight_reset(&flight);
+	TEST_CHECK_EQUAL(0, ldpin_flight_lost(&flight));
+}
+
+TEST_CASE(flight_overwrite)
+{
+	test_flight_overwrite();
+}
+
+void test_flight_ldv1000_edges()
+{
+	LDV1000Ctx_t ctx;
+	LDV1000Callbacks_t cb;
+	LDPInFlightRecord_t recs[8];
+
+	cb = ctx_test_callbacks<LDV1000Callbacks_t>();
+	cb.get_status = flight_test_ldv1000_status;
+	cb.begin_search = ctx_test_begin_search;
+	cb.on_error = flight_test_ldv1000_error;
+	ldv1000i_ctx_init(&ctx, &cb, 0);
+
+	ldv1000i_ctx_write(&ctx, 0x0F);	// 1
+	ldv1000i_ctx_write(&ctx, 0xFF);
+	ldv1000i_ctx_write(&ctx, 0xF7);	// search
+	ldpin_flight_vblank(&ctx.flight);
+
+	// the player is in a state that makes no sense for a search, then finishes
+	g_flightTestLDV1000Status = LDV1000_STOPPED;
+	for (int i = 0; i < 5; i++)
+	{
+		ldv1000i_ctx_read(&ctx);
+	}
+	g_flightTestLDV1000Status = LDV1000_PAUSED;
+	ldv1000i_ctx_read(&ctx);
+
+	TEST_REQUIRE_EQUAL(3, ldv1000i_ctx_flight_read(&ctx, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_SEARCH, LDPIN_TRACE_LDV1000, LDV1000_TRUE, 0);
+	check_flight(recs[1], LDPIN_FLIGHT_ERROR, LDPIN_TRACE_LDV1000, 0, 1);
+	check_flight(recs[2], LDPIN_FLIGHT_SEARCH, LDPIN_TRACE_LDV1000, LDV1000_FALSE, 1);
+}
+
+TEST_CASE(flight_ldv1000_edges)
+{
+	test_flight_ldv1000_edges();
+}
+
+void test_flight_vip9500sg_states()
+{
+	VIP9500SGCtx_t ctx;
+	LDPInFlightRecord_t recs[8];
+
+	ctx_test_init_vip9500sg(&ctx);
+	vip9500sgi_ctx_write(&ctx, 0x2b);	// search
+	vip9500sgi_ctx_write(&ctx, 0x31);	// 1
+	vip9500sgi_ctx_write(&ctx, 0x41);	// enter
+	vip9500sgi_ctx_think_after_vblank(&ctx);	// paused, so the search is done
+
+	TEST_REQUIRE_EQUAL(4, vip9500sgi_ctx_flight_read(&ctx, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_NORMAL, 0);
+	check_flight(recs[1], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_WAIT_SEARCH, 0);
+	check_flight(recs[2], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_SEARCHING, 0);
+	check_flight(recs[3], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_NORMAL, 1);
+}
+
+TEST_CASE(flight_vip9500sg_states)
+{
+	test_flight_vip9500sg_states();
+}
+
+void test_flight_ld700_ext_ack()
+{
+	LD700Ctx_t ctx;
+	LD700Callbacks_t cb;
+	LDPInFlightRecord_t recs[8];
+
+	cb = ctx_test_callbacks<LD700Callbacks_t>();
+	cb.play = flight_test_nop;
+	cb.on_ext_ack_changed = flight_test_ext_ack;
+	ctx_test_init(&ctx, cb);
+	ldpin_flight_reset(&ctx.flight);	// leaving out the reset's state move
+
+	// play
+	ld700i_ctx_on_new_cmd(&ctx);
+	ld700i_ctx_write(&ctx, 0xA8, LD700_PAUSED);
+	ld700i_ctx_write(&ctx, 0x57, LD700_PAUSED);
+	ld700i_ctx_write(&ctx, 0x17, LD700_PAUSED);
+	ld700i_ctx_write(&ctx, 0xE8, LD700_PAUSED);
+	ld700i_ctx_on_vblank(&ctx, LD700_PLAYING);
+	ld700i_ctx_on_vblank(&ctx, LD700_PLAYING);	// EXT_ACK' goes active one vblank after the command
+
+	TEST_REQUIRE_EQUAL(1, ld700i_ctx_flight_read(&ctx, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_EXT_ACK, LDPIN_TRACE_LD700, LD700_TRUE, 2);
+
+	// and inactive again once the command times out
+	for (int i = 0; i < 4; i++)
+	{
+		ld700i_ctx_on_vblank(&ctx, LD700_PLAYING);
+	}
+	TEST_REQUIRE_EQUAL(1, ld700i_ctx_flight_read(&ctx, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_EXT_ACK, LDPIN_TRACE_LD700, LD700_FALSE, 5);
+}
+
+TEST_CASE(flight_ld700_ext_ack)
+{
+	test_flight_ld700_ext_ack();
+}
+
+void test_flight_contexts_apart()
+{
+	VIP9500SGCtx_t ctx1, ctx2;
+	VIP9500SGCallbacks_t cb;
+	LDPInFlightRecord_t recs[8];
+
+	cb = ctx_test_callbacks<VIP9500SGCallbacks_t>();
+	cb.begin_search = ctx_test_begin_search;
+	cb.get_status = ctx_test_vip9500sg_paused;
+	vip9500sgi_ctx_init(&ctx1, &cb, 0);
+	vip9500sgi_ctx_init(&ctx2, &cb, 0);
+
+	// each context records its own moves, stamped with its own vblanks
+	vip9500sgi_ctx_think_after_vblank(&ctx1);
+	vip9500sgi_ctx_think_after_vblank(&ctx1);
+	vip9500sgi_ctx_reset(&ctx1);
+	vip9500sgi_ctx_reset(&ctx2);
+	vip9500sgi_ctx_write(&ctx2, 0x2b);	// search
+
+	TEST_REQUIRE_EQUAL(1, vip9500sgi_ctx_flight_read(&ctx1, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_NORMAL, 2);
+	TEST_REQUIRE_EQUAL(2, vip9500sgi_ctx_flight_read(&ctx2, recs, 8));
+	check_flight(recs[0], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_NORMAL, 0);
+	check_flight(recs[1], LDPIN_FLIGHT_STATE, LDPIN_TRACE_VIP9500SG, VIP9500SGI_STATE_WAIT_SEARCH, 0);
+}
+
+TEST_CASE(flight_contexts_apart)
+{
+	test_flight_contexts_apart();
+}
+
+void test_flight_read_from_another_thread()
+{
+	LDPInFlight_t flight;
+	std::atomic<bool> bDone(false);
+	std::vector<uint16_t> got;
+	uint32_t u32Lost = 0;
+	const uint32_t u32Count = 60000;	// few enough that the lost count can't stop or wrap
+
+	ldpin_flight_reset(&flight);
+
+	// the value and vblank count of each record both come from its number, so a torn or stale record shows up
+	std::thread reader([&]()
+	{
+		LDPInFlightRecord_t recs[LDP_IN_FLIGHT_SIZE];
+		bool bLast = false;
+
+		while (!bLast)
+		{
+			bLast = bDone.load();
+			uint8_t u8Got = ldpin_flight_read(&flight, recs, LDP_IN_FLIGHT_SIZE);
+			for (uint8_t u = 0; u < u8Got; u++)
+			{
+				got.push_back(recs[u].u16VBlank);
+				TEST_CHECK_EQUAL((uint8_t) recs[u].u16VBlank, recs[u].u8Val);
+			}
+		}
+	});
+
+	for (uint32_t u = 0; u < u32Count; u++)
+	{
+		ldpin_flight_push(&flight, (uint8_t) ((LDPIN_FLIGHT_STATE << 4) | LDPIN_TRACE_LDP1000), (uint8_t) u);
+		ldpin_flight_vblank(&flight);
+	}
+	bDone.store(true);
+	reader.join();
+	u32Lost = ldpin_flight_lost(&flight);
+
+	// in order, nothing twice, and everything either read or counted as lost
+	TEST_REQUIRE(!got.empty());
+	for (size_t u = 1; u < got.size(); u++)
+	{
+		TEST_CHECK((uint16_t) (got[u] - got[u - 1]) >= 1);
+	}
+	TEST_CHECK_EQUAL((uint16_t) (u32Count - 1), got.back());
+	TEST_CHECK_EQUAL(u32Count, got.size() + u32Lost);
+}
+
+TEST_CASE(flight_read_from_another_thread)
+{
+	test_flight_read_from_another_thread();
+}
+
+#endif // LDP_IN_FLIGHT_SIZE
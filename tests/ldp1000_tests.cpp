@@ -258,6 +258,32 @@ TEST_CASE(ldp1000_get_cur_frame)
 	test_ldp1000_get_cur_frame();
 }
 
+void test_ldp1000_get_cur_frame_cached()
+{
+	MockLDP1000Test mockLDP;
+
+	ldp1000_test_wrapper::setup(&mockLDP);
+
+	// the frame number supplied at vblank is used instead
+	EXPECT_CALL(mockLDP, GetCurFrame()).Times(0);
+
+	ldp1000i_reset(LDP1000_EMU_LDP1000A);
+	ldp1000i_set_cur_frame_num(19999);
+	ldp1000i_set_cur_frame_num(20000);
+
+	ldp1000i_write(0x60);	// get current frame
+	TEST_CHECK_EQUAL(LATVAL_GENERIC | 0x32, ldp1000i_read());
+	TEST_CHECK_EQUAL(LATVAL_INQUIRY | 0x30, ldp1000i_read());
+	TEST_CHECK_EQUAL(LATVAL_INQUIRY | 0x30, ldp1000i_read());
+	TEST_CHECK_EQUAL(LATVAL_INQUIRY | 0x30, ldp1000i_read());
+	TEST_CHECK_EQUAL(LATVAL_INQUIRY | 0x30, ldp1000i_read());
+}
+
+TEST_CASE(ldp1000_get_cur_frame_cached)
+{
+	test_ldp1000_get_cur_frame_cached();
+}
+
 void test_ldp1000_clear()
 {
 	MockLDP1000Test mockLDP;
@@ -1434,3 +1460,79 @@ TEST_CASE(ldp1000_skip_backward)
 {
 	test_ldp1000_skip_backward();
 }
+
+/////////////////////////////////////////////////////////////////
+
+// callbacks for the reentrant API; pUser points to the mock that owns the context
+class ldp1000_ctx_test_wrapper
+{
+public:
+	static void play(void *pUser, uint8_t u8Numerator, uint8_t u8Denominator, LDP1000_BOOL bBackward, LDP1000_BOOL bAudioSquelched) { ((ILDP1000Test *) pUser)->Play(u8Numerator, u8Denominator, (bBackward != LDP1000_FALSE), (bAudioSquelched != LDP1000_FALSE)); }
+	static void pause(void *pUser) { ((ILDP1000Test *) pUser)->Pause(); }
+	static void begin_search(void *pUser, uint32_t u32FrameNum) { ((ILDP1000Test *) pUser)->BeginSearch(u32FrameNum); }
+	static void step_forward(void *pUser) { ((ILDP1000Test *) pUser)->StepForward(); }
+	static void step_reverse(void *pUser) { ((ILDP1000Test *) pUser)->StepReverse(); }
+	static void skip(void *pUser, int16_t iTracksToSkip) { ((ILDP1000Test *) pUser)->Skip(iTracksToSkip); }
+	static void change_audio(void *pUser, uint8_t u8Channel, uint8_t u8Enabled) { ((ILDP1000Test *) pUser)->ChangeAudio(u8Channel, u8Enabled); }
+	static void change_video(void *pUser, LDP1000_BOOL u8Enabled) { ((ILDP1000Test *) pUser)->ChangeVideo(u8Enabled != LDP1000_FALSE); }
+	static LDP1000Status_t GetStatus(void *pUser) { return ((ILDP1000Test *) pUser)->GetStatus(); }
+	static uint32_t get_cur_frame(void *pUser) { return ((ILDP1000Test *) pUser)->GetCurFrame(); }
+	static void text_enable_changed(void *pUser, LDP1000_BOOL bEnabled) { ((ILDP1000Test *) pUser)->TextEnableChanged(bEnabled != LDP1000_FALSE); }
+	static void text_buffer_contents_changed(void *pUser, const uint8_t *p8Buf32Bytes) { ((ILDP1000Test *) pUser)->TextBufferContentsChanged(p8Buf32Bytes); }
+	static void text_buffer_start_index_changed(void *pUser, uint8_t u8StartIdx) { ((ILDP1000Test *) pUser)->TextBufferStartIndexChanged(u8StartIdx); }
+	static void text_modes_changed(void *pUser, uint8_t u8Mode, uint8_t u8X, uint8_t u8Y) { ((ILDP1000Test *) pUser)->TextModesChanged(u8Mode, u8X, u8Y); }
+	static void OnError(void *pUser, LDP1000ErrCode_t code, uint8_t u8Val) { ((ILDP1000Test *) pUser)->OnError(code, u8Val); }
+
+	static void init(LDP1000Ctx_t *pCtx, ILDP1000Test *pInstance)
+	{
+		LDP1000Callbacks_t cb =
+		{
+			play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, GetStatus, get_cur_frame,
+			text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed, text_modes_changed,
+			OnError
+		};
+		ldp1000i_ctx_init(pCtx, &cb, pInstance);
+	}
+};
+
+void test_ldp1000_ctx_independent()
+{
+	MockLDP1000Test mock1, mock2;
+	LDP1000Ctx_t ctx1, ctx2;
+
+	ldp1000_ctx_test_wrapper::init(&ctx1, &mock1);
+	ldp1000_ctx_test_wrapper::init(&ctx2, &mock2);
+
+	EXPECT_CALL(mock1, Pause());
+	EXPECT_CALL(mock1, BeginSearch(12));
+	EXPECT_CALL(mock1, GetStatus()).WillRepeatedly(Return(LDP1000_PAUSED));
+	EXPECT_CALL(mock2, Play(1, 1, false, false));
+
+	ldp1000i_ctx_reset(&ctx1, LDP1000_EMU_LDP1000A);
+	ldp1000i_ctx_reset(&ctx2, LDP1000_EMU_LDP1450);
+
+	ldp1000i_ctx_write(&ctx1, 0x43);	// start search
+	ldp1000i_ctx_write(&ctx1, '1');
+	ldp1000i_ctx_write(&ctx2, 0x3A);	// play (in the middle of the other player's search)
+	ldp1000i_ctx_write(&ctx1, '2');
+	ldp1000i_ctx_write(&ctx1, 0x40);	// enter
+
+	// each player's responses must only show up on that player
+	TEST_CHECK_EQUAL(LATACK_PLAY, ldp1000i_ctx_read(&ctx2));
+	TEST_CHECK(ldp1000i_ctx_can_read(&ctx2) == LDP1000_FALSE);
+
+	TEST_CHECK_EQUAL(LATACK_ENTER, ldp1000i_ctx_read(&ctx1));
+	TEST_CHECK_EQUAL(LATACK_NUMBER, ldp1000i_ctx_read(&ctx1));
+	TEST_CHECK_EQUAL(LATACK_NUMBER, ldp1000i_ctx_read(&ctx1));
+	TEST_CHECK_EQUAL(LATACK_ENTER, ldp1000i_ctx_read(&ctx1));
+
+	// search completes on the next vblank
+	ldp1000i_ctx_think_during_vblank(&ctx1);
+	TEST_CHECK_EQUAL(LATVAL_GENERIC | 1, ldp1000i_ctx_read(&ctx1));
+	TEST_CHECK(ldp1000i_ctx_can_read(&ctx1) == LDP1000_FALSE);
+}
+
+TEST_CASE(ldp1000_ctx_independent)
+{
+	test_ldp1000_ctx_independent();
+}
@@ -0,0 +1,185 @@
+#include "stdafx.h"
+#include <ldp-in/ldp1000-timing.h>
+
+// 10 bits at 9600 baud is 1041666 2/3 ns
+#define BYTE_9600_NS 1041666ull
+
+void test_ldp1000_timing_first_byte_waits_for_latency()
+{
+	LDP1000Timing_t timing;
+
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1000A, 9600);
+
+	// the ACK for an ENTER starts after the ENTER delay and arrives one byte time later
+	uint64_t u64Cmd = 5000000;
+	uint64_t u64Release = ldp1000i_timing_release(&timing, u64Cmd, (LDP1000_LATENCY_ENTER << 8) | 0x0A);
+	TEST_CHECK_EQUAL(u64Cmd + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_ENTER] * 1000 + BYTE_9600_NS, u64Release);
+
+	// the LDP-1450 has its own table
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1450, 9600);
+	TEST_CHECK(timing.table.au32DelayUs[LDP1000_LATENCY_ENTER] != ldp1000i_timing_default_table(LDP1000_EMU_LDP1000A)->au32DelayUs[LDP1000_LATENCY_ENTER]);
+	u64Release = ldp1000i_timing_release(&timing, u64Cmd, (LDP1000_LATENCY_ENTER << 8) | 0x0A);
+	TEST_CHECK_EQUAL(u64Cmd + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_ENTER] * 1000 + BYTE_9600_NS, u64Release);
+}
+
+TEST_CASE(ldp1000_timing_first_byte_waits_for_latency)
+{
+	test_ldp1000_timing_first_byte_waits_for_latency();
+}
+
+void test_ldp1000_timing_back_to_back()
+{
+	LDP1000Timing_t timing;
+	uint64_t u64Release[5];
+
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1450, 9600);
+	timing.table.au32DelayUs[LDP1000_LATENCY_INQUIRY] = 0;
+	u64Release[0] = ldp1000i_timing_release(&timing, 0, (LDP1000_LATENCY_GENERIC << 8) | 0x30);
+	for (uint16_t u = 1; u < 5; u++)
+	{
+		u64Release[u] = ldp1000i_timing_release(&timing, 0, (LDP1000_LATENCY_INQUIRY << 8) | (0x30 + u));
+	}
+
+	// with no gap, the rest follow as soon as the one before has gone, with no rounding drift (3 bytes = 3125000 ns exactly)
+	uint64_t u64Start = (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_GENERIC] * 1000;
+	TEST_CHECK_EQUAL(u64Start + BYTE_9600_NS, u64Release[0]);
+	TEST_CHECK_EQUAL(u64Start + 2083333, u64Release[1]);
+	TEST_CHECK_EQUAL(u64Start + 3125000, u64Release[2]);
+	TEST_CHECK_EQUAL(u64Start + 3125000 + BYTE_9600_NS, u64Release[3]);
+	TEST_CHECK_EQUAL(u64Start + 3125000 + 2083333, u64Release[4]);
+}
+
+TEST_CASE(ldp1000_timing_back_to_back)
+{
+	test_ldp1000_timing_back_to_back();
+}
+
+void test_ldp1000_timing_busy_and_idle_line()
+{
+	LDP1000Timing_t timing;
+	uint64_t u64Release;
+
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1000A, 1200);
+	for (int i = 0; i < LDP1000_LATENCY_COUNT; i++)
+	{
+		timing.table.au32DelayUs[i] = 1000;
+	}
+
+	// 1200 baud: 8333333 1/3 ns per byte
+	u64Release = ldp1000i_timing_release(&timing, 0, 0x0A);
+	TEST_CHECK_EQUAL(1000000 + 8333333ull, u64Release);
+
+	// a response to a command that came in while that byte was still going out has to wait for the line
+	u64Release = ldp1000i_timing_release(&timing, 2000000, 0x0A);
+	TEST_CHECK_EQUAL(1000000 + 16666666ull, u64Release);
+
+	// once the line has gone idle, the delay counts again
+	u64Release = ldp1000i_timing_release(&timing, 100000000, 0x0A);
+	TEST_CHECK_EQUAL(101000000 + 8333333ull, u64Release);
+}
+
+TEST_CASE(ldp1000_timing_busy_and_idle_line)
+{
+	test_ldp1000_timing_busy_and_idle_line();
+}
+
+static LDP1000Status_t timing_get_status(void *) { return LDP1000_PAUSED; }
+static uint32_t timing_get_cur_frame(void *) { return 123; }
+
+void test_ldp1000_timing_drain()
+{
+	LDP1000Callbacks_t cb;
+	LDP1000Ctx_t ctx;
+	LDP1000Timing_t timing;
+	LDP1000TimedByte_t bytes[8];
+
+	memset(&cb, 0, sizeof(cb));
+	cb.get_status = timing_get_status;
+	cb.get_cur_frame_num = timing_get_cur_frame;
+	ldp1000i_ctx_init(&ctx, &cb, 0);
+	ldp1000i_ctx_reset(&ctx, LDP1000_EMU_LDP1450);
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1450, 9600);
+
+	// ADDR INQ: five digits
+	ldp1000i_ctx_write(&ctx, 0x60);
+	TEST_REQUIRE_EQUAL(5, ldp1000i_timing_drain(&timing, &ctx, 7000000, bytes, 8));
+	TEST_CHECK(ldp1000i_ctx_can_read(&ctx) == LDP1000_FALSE);
+
+	// the first digit waits for the GENERIC delay, each of the others for the INQUIRY gap after the one before
+	uint64_t u64Gap = (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_INQUIRY] * 1000;
+	uint64_t u64First = 7000000 + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_GENERIC] * 1000 + BYTE_9600_NS;
+	TEST_CHECK_EQUAL('0', bytes[0].u8Val);
+	TEST_CHECK_EQUAL('3', bytes[4].u8Val);
+	TEST_CHECK_EQUAL(u64First, bytes[0].u64ReleaseNs);
+	for (int i = 1; i < 5; i++)
+	{
+		TEST_CHECK_EQUAL(bytes[i - 1].u64ReleaseNs + u64Gap + BYTE_9600_NS, bytes[i].u64ReleaseNs);
+	}
+
+	// a short buffer leaves the rest queued, and the next call carries on with that response before its own
+	ldp1000i_ctx_write(&ctx, 0x60);
+	TEST_CHECK_EQUAL(2, ldp1000i_timing_drain(&timing, &ctx, 20000000, bytes, 2));
+	TEST_CHECK(ldp1000i_ctx_can_read(&ctx) != LDP1000_FALSE);
+	uint64_t u64Second = bytes[1].u64ReleaseNs;
+	ldp1000i_ctx_write(&ctx, 0x56);	// CLEAR
+	TEST_REQUIRE_EQUAL(4, ldp1000i_timing_drain(&timing, &ctx, 30000000, bytes, 8));
+	TEST_CHECK_EQUAL(u64Second + u64Gap + BYTE_9600_NS, bytes[0].u64ReleaseNs);
+	TEST_CHECK_EQUAL(bytes[1].u64ReleaseNs + u64Gap + BYTE_9600_NS, bytes[2].u64ReleaseNs);
+	TEST_CHECK_EQUAL(0x0A, bytes[3].u8Val);
+	TEST_CHECK_EQUAL(30000000 + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_CLEAR] * 1000 + BYTE_9600_NS, bytes[3].u64ReleaseNs);
+}
+
+TEST_CASE(ldp1000_timing_drain)
+{
+	test_ldp1000_timing_drain();
+}
+
+void test_ldp1000_timing_calls_at_the_same_time()
+{
+	LDP1000Callbacks_t cb;
+	LDP1000Ctx_t ctx;
+	LDP1000Timing_t timing;
+	LDP1000TimedByte_t bytes[8];
+
+	memset(&cb, 0, sizeof(cb));
+	cb.get_status = timing_get_status;
+	cb.get_cur_frame_num = timing_get_cur_frame;
+	ldp1000i_ctx_init(&ctx, &cb, 0);
+	ldp1000i_ctx_reset(&ctx, LDP1000_EMU_LDP1450);
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1450, 9600);
+
+	// two commands handled at the same emulated time are two responses, each counting its delay from that time
+	ldp1000i_ctx_write(&ctx, 0x56);	// CLEAR
+	TEST_REQUIRE_EQUAL(1, ldp1000i_timing_drain(&timing, &ctx, 1000000, bytes, 8));
+	uint64_t u64Clear = bytes[0].u64ReleaseNs;
+	TEST_CHECK_EQUAL(1000000 + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_CLEAR] * 1000 + BYTE_9600_NS, u64Clear);
+	timing.table.au32DelayUs[LDP1000_LATENCY_NUMBER] = 5000;	// longer than the CLEAR ACK takes to go out
+	ldp1000i_ctx_write(&ctx, 0x31);
+	TEST_REQUIRE_EQUAL(1, ldp1000i_timing_drain(&timing, &ctx, 1000000, bytes, 8));
+	TEST_CHECK_EQUAL(1000000 + 5000000 + BYTE_9600_NS, bytes[0].u64ReleaseNs);
+}
+
+TEST_CASE(ldp1000_timing_calls_at_the_same_time)
+{
+	test_ldp1000_timing_calls_at_the_same_time();
+}
+
+void test_ldp1000_timing_clamps_baud()
+{
+	LDP1000Timing_t timing;
+
+	// 0 would divide by zero; the players only go from 1200 to 9600
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1000A, 0);
+	TEST_CHECK_EQUAL(LDP1000_TIMING_MIN_BAUD, timing.u32Baud);
+	TEST_CHECK_EQUAL(8333333ull + (uint64_t) timing.table.au32DelayUs[LDP1000_LATENCY_GENERIC] * 1000,
+		ldp1000i_timing_release(&timing, 0, (LDP1000_LATENCY_GENERIC << 8) | 0x0A));
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1000A, 115200);
+	TEST_CHECK_EQUAL(LDP1000_TIMING_MAX_BAUD, timing.u32Baud);
+	ldp1000i_timing_init(&timing, LDP1000_EMU_LDP1000A, 4800);
+	TEST_CHECK_EQUAL(4800, timing.u32Baud);
+}
+
+TEST_CASE(ldp1000_timing_clamps_baud)
+{
+	test_ldp1000_timing_clamps_baud();
+}
@@ -186,3 +186,32 @@ TEST_CASE(ldv1000super_disc_switch_during_seek)
 {
 	test_ldv1000super_disc_switch_during_seek();
 }
+
+////////////////////////////
+
+void test_ldv1000super_notified_status()
+{
+	MockLDV1000Test mockLDV1000;
+	ldv1000_test_wrapper::setup(&mockLDV1000);
+
+	EXPECT_CALL(mockLDV1000, GetStatus()).Times(0);
+	EXPECT_CALL(mockLDV1000, Play());
+
+	reset_ldv1000i(LDV1000_EMU_SUPER);
+	set_status_ldv1000i(LDV1000_STOPPED);
+
+	write_ldv1000i(0xFD);	// send play command
+	set_status_ldv1000i(LDV1000_SPINNING_UP);
+	TEST_CHECK_EQUAL(0x64, read_ldv1000i());
+	TEST_CHECK_EQUAL(0x64, read_ldv1000i());
+
+	// super mode is always ready, even without a NO ENTRY
+	set_status_ldv1000i(LDV1000_PLAYING);
+	TEST_CHECK_EQUAL(0xE4, read_ldv1000i());
+	TEST_CHECK_EQUAL(0xE4, read_ldv1000i());
+}
+
+TEST_CASE(ldv1000super_notified_status)
+{
+	test_ldv1000super_notified_status();
+}
@@ -282,6 +282,130 @@ TEST_CASE(ldv1000_get_curframe)
 	test_ldv1000_get_curframe();
 }
 
+void test_ldv1000_get_curframe_cached()
+{
+	MockLDV1000Test mockLDV1000;
+	ldv1000_test_wrapper::setup(&mockLDV1000);
+
+	// the frame number supplied at vblank is used instead
+	EXPECT_CALL(mockLDV1000, GetCurFrameNum()).Times(0);
+
+	reset_ldv1000i(LDV1000_EMU_STANDARD);
+	set_cur_frame_num_ldv1000i(1998);
+	set_cur_frame_num_ldv1000i(1999);
+	set_cur_frame_num_ldv1000i(2000);	// carries into the thousands
+
+	unsigned char buf[5];
+	write_ldv1000i(0xC2);	// frame number query
+	read_n_ldv1000i(buf, 5);
+	TEST_CHECK(memcmp("02000", buf, 5) == 0);
+}
+
+TEST_CASE(ldv1000_get_curframe_cached)
+{
+	test_ldv1000_get_curframe_cached();
+}
+
+void test_ldv1000_notified_status_seek()
+{
+	MockLDV1000Test mockLDV1000;
+	ldv1000_test_wrapper::setup(&mockLDV1000);
+
+	// the host supplies the status so it is never asked for
+	EXPECT_CALL(mockLDV1000, GetStatus()).Times(0);
+	EXPECT_CALL(mockLDV1000, BeginSearch(0));
+
+	reset_ldv1000i(LDV1000_EMU_STANDARD);
+	set_status_ldv1000i(LDV1000_PAUSED);
+
+	TEST_CHECK_EQUAL(0xFC, read_ldv1000i());
+	TEST_CHECK_EQUAL(0xFC, read_ldv1000i());
+
+	write_ldv1000i(0xFF);	// no entry
+	write_ldv1000i(0xF7);	// seek to whatever frame
+	set_status_ldv1000i(LDV1000_SEARCHING);
+
+	// the search delay has to count down even though the status byte doesn't change
+	for (int i = 0; i < 10; i++)
+	{
+		TEST_REQUIRE_EQUAL(0x50, read_ldv1000i());	// seek busy
+	}
+
+	set_status_ldv1000i(LDV1000_PAUSED);
+	TEST_CHECK_EQUAL(0x50, read_ldv1000i());	// seek succeeded, but no NO ENTRY yet
+	write_ldv1000i(0xFF);	// no entry
+	TEST_CHECK_EQUAL(0xD0, read_ldv1000i());
+	TEST_CHECK_EQUAL(0xD0, read_ldv1000i());
+}
+
+TEST_CASE(ldv1000_notified_status_seek)
+{
+	test_ldv1000_notified_status_seek();
+}
+
+void test_ldv1000_notified_status_spinup()
+{
+	MockLDV1000Test mockLDV1000;
+	ldv1000_test_wrapper::setup(&mockLDV1000);
+
+	EXPECT_CALL(mockLDV1000, GetStatus()).Times(0);
+	EXPECT_CALL(mockLDV1000, Play());
+
+	reset_ldv1000i(LDV1000_EMU_STANDARD);
+	set_status_ldv1000i(LDV1000_STOPPED);
+
+	write_ldv1000i(0xFD);	// send play command
+	set_status_ldv1000i(LDV1000_SPINNING_UP);
+	TEST_CHECK_EQUAL(0x64, read_ldv1000i());
+	TEST_CHECK_EQUAL(0x64, read_ldv1000i());
+
+	set_status_ldv1000i(LDV1000_PLAYING);
+	write_ldv1000i(0xFF);	// no entry
+	TEST_CHECK_EQUAL(0xE4, read_ldv1000i());	// disc is full on in playing mode
+	TEST_CHECK_EQUAL(0xE4, read_ldv1000i());
+}
+
+TEST_CASE(ldv1000_notified_status_spinup)
+{
+	test_ldv1000_notified_status_spinup();
+}
+
+void test_ldv1000_notified_autostop()
+{
+	MockLDV1000Test mockLDV1000;
+	ldv1000_test_wrapper::setup(&mockLDV1000);
+
+	EXPECT_CALL(mockLDV1000, GetStatus()).Times(0);
+	EXPECT_CALL(mockLDV1000, GetCurFrameNum()).Times(0);
+	EXPECT_CALL(mockLDV1000, Play());
+	EXPECT_CALL(mockLDV1000, Pause());
+
+	reset_ldv1000i(LDV1000_EMU_STANDARD);
+	set_status_ldv1000i(LDV1000_PAUSED);
+	set_cur_frame_num_ldv1000i(98);
+
+	write_ldv1000i(0x0F);	// 1 (digits are followed by NO ENTRY like the games do)
+	write_ldv1000i(0xFF);
+	write_ldv1000i(0x3F);	// 0
+	write_ldv1000i(0xFF);
+	write_ldv1000i(0x3F);	// 0
+	write_ldv1000i(0xFF);
+	write_ldv1000i(0xF3);	// auto stop at frame 100
+	set_status_ldv1000i(LDV1000_PLAYING);
+
+	TEST_CHECK_EQUAL(0x54, read_ldv1000i());
+	set_cur_frame_num_ldv1000i(99);
+	TEST_CHECK_EQUAL(0x54, read_ldv1000i());
+	set_cur_frame_num_ldv1000i(100);
+	TEST_CHECK_EQUAL(0x65, read_ldv1000i());	// stopped (Pause gets called once)
+	TEST_CHECK_EQUAL(0x65, read_ldv1000i());
+}
+
+TEST_CASE(ldv1000_notified_autostop)
+{
+	test_ldv1000_notified_autostop();
+}
+
 void test_ldv1000_audio()
 {
 	MockLDV1000Test mockLDV1000;
@@ -554,3 +554,64 @@ TEST_CASE(pr8210_standby_end)
 {
 	test_pr8210_standby_end();
 }
+
+/////////////////////////////////////////////////////////////////
+
+// callbacks for the reentrant API; pUser points to the mock that owns the context
+class pr8210_ctx_test_wrapper
+{
+public:
+	static void play(void *pUser) { ((IPR8210Test *) pUser)->Play(); }
+	static void pause(void *pUser) { ((IPR8210Test *) pUser)->Pause(); }
+	static void step(void *pUser, int8_t i8Tracks) { ((IPR8210Test *) pUser)->Step(i8Tracks); }
+	static void begin_search(void *pUser, uint32_t u32FrameNum) { ((IPR8210Test *) pUser)->BeginSearch(u32FrameNum); }
+	static void change_audio(void *pUser, uint8_t u8Channel, uint8_t u8Enabled) { ((IPR8210Test *) pUser)->ChangeAudio(u8Channel, u8Enabled); }
+	static void skip(void *pUser, int8_t i8TracksToSkip) { ((IPR8210Test *) pUser)->Skip(i8TracksToSkip); }
+	static void change_auto_track_jump(void *pUser, PR8210_BOOL bAutoTrackJumpDisabled) { ((IPR8210Test *) pUser)->ChangeAutoTrackJump(bAutoTrackJumpDisabled != PR8210_FALSE); }
+	static PR8210_BOOL is_player_busy(void *pUser) { return ((IPR8210Test *) pUser)->IsPlayerBusy() ? PR8210_TRUE : PR8210_FALSE; }
+	static void change_standby(void *pUser, PR8210_BOOL bEnabled) { ((IPR8210Test *) pUser)->ChangeStandby(bEnabled != PR8210_FALSE); }
+	static void OnError(void *pUser, PR8210ErrCode_t code, uint16_t u16Val) { ((IPR8210Test *) pUser)->OnError(code, u16Val); }
+
+	static void init(PR8210Ctx_t *pCtx, IPR8210Test *pInstance)
+	{
+		PR8210Callbacks_t cb =
+		{
+			play, pause, step, begin_search, change_audio, skip, change_auto_track_jump, is_player_busy, change_standby, OnError
+		};
+		pr8210i_ctx_init(pCtx, &cb, pInstance);
+	}
+};
+
+void test_pr8210_ctx_independent()
+{
+	MockPR8210Test mock1, mock2;
+	PR8210Ctx_t ctx1, ctx2;
+
+	pr8210_ctx_test_wrapper::init(&ctx1, &mock1);
+	pr8210_ctx_test_wrapper::init(&ctx2, &mock2);
+
+	EXPECT_CALL(mock1, BeginSearch(12));
+	EXPECT_CALL(mock1, ChangeStandby(true));
+	EXPECT_CALL(mock2, BeginSearch(3));
+	EXPECT_CALL(mock2, ChangeStandby(true));
+	EXPECT_CALL(mock2, ChangeAudio(0, 0));
+
+	// interleave two different commands so that any shared state would corrupt one of them
+	pr8210i_ctx_write(&ctx1, 4 | (0x11 << 3));	// 1
+	pr8210i_ctx_write(&ctx2, 4 | (0x13 << 3));	// 3
+	pr8210i_ctx_write(&ctx1, 4 | (0x11 << 3));	// 1
+	pr8210i_ctx_write(&ctx2, 4 | (0x13 << 3));	// 3
+	pr8210i_ctx_write(&ctx1, 4 | (0x12 << 3));	// 2
+	pr8210i_ctx_write(&ctx2, 4 | (0xE << 3));	// toggle left audio
+	pr8210i_ctx_write(&ctx1, 4 | (0x12 << 3));	// 2
+	pr8210i_ctx_write(&ctx2, 4 | (0xE << 3));	// toggle left audio
+	pr8210i_ctx_write(&ctx1, 4 | (0xB << 3));	// SEARCH (B)
+	pr8210i_ctx_write(&ctx2, 4 | (0xB << 3));	// SEARCH (B)
+	pr8210i_ctx_write(&ctx1, 4 | (0xB << 3));	// SEARCH (B)
+	pr8210i_ctx_write(&ctx2, 4 | (0xB << 3));	// SEARCH (B)
+}
+
+TEST_CASE(pr8210_ctx_independent)
+{
+	test_pr8210_ctx_independent();
+}
@@ -0,0 +1,69 @@
+#include "stdafx.h"
+#include "pty_player.h"
+#include <ldp-in/trace.h>	// LDPInTraceInterp_t
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+// a pty passes bytes from one side to the other in the background, so wait for them to get there
+static bool pty_test_wait(int fd)
+{
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, 1000) == 1;
+}
+
+// everything waiting on the program's side of the pty
+static std::vector<uint8_t> pty_test_read(int fd)
+{
+	std::vector<uint8_t> v;
+	uint8_t au8Buf[64];
+	ssize_t iLen;
+
+	while ((iLen = read(fd, au8Buf, sizeof(au8Buf))) > 0)
+	{
+		v.insert(v.end(), au8Buf, au8Buf + iLen);
+	}
+	return v;
+}
+
+void test_pty_vblanks_after_commands()
+{
+	PtyPlayer player;
+	std::string strErr;
+	static const uint8_t search[] = { 0x43, 0x31, 0x32, 0x33, 0x40 };	// SEARCH 123 ENTER
+
+	TEST_REQUIRE(player.Open(LDPIN_TRACE_LDP1000, 0, 0, 2, &strErr));
+	int fd = open(player.DevicePath().c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	TEST_REQUIRE(fd >= 0);
+
+	// the command is answered as soon as it is read, without waiting for a vblank
+	TEST_REQUIRE_EQUAL((ssize_t) sizeof(search), write(fd, search, sizeof(search)));
+	TEST_REQUIRE(pty_test_wait(player.Fd()));
+	player.OnReadable(1000);
+	TEST_REQUIRE(pty_test_wait(fd));
+	std::vector<uint8_t> got = pty_test_read(fd);
+	TEST_CHECK(std::vector<uint8_t>(5, 0x0A) == got);
+
+	// the search finishes on the vblanks after it, not before
+	player.OnVBlank(2000);
+	TEST_CHECK(pty_test_read(fd).empty());
+	player.OnVBlank(3000);
+	player.OnVBlank(4000);
+	TEST_REQUIRE(pty_test_wait(fd));
+	got = pty_test_read(fd);
+	TEST_REQUIRE_EQUAL(1u, got.size());
+	TEST_CHECK_EQUAL(0x01, got[0]);
+	TEST_CHECK_EQUAL(3u, player.Stats().u64Vblanks);
+
+	close(fd);
+}
+
+TEST_CASE(pty_vblanks_after_commands)
+{
+	test_pty_vblanks_after_commands();
+}
@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include <ldp-in/rewind.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <string.h>
+#include "ctx_test_init.h"
+
+#define REWIND_TEST_SNAP_SIZE 40
+
+// a snapshot that changes a little every vblank (a frame number and a counter), and completely every 100th
+static void rewind_test_snap(uint32_t u32Num, uint8_t *p8Snap)
+{
+	memset(p8Snap, 0x11, REWIND_TEST_SNAP_SIZE);
+	p8Snap[3] = (uint8_t) u32Num;
+	p8Snap[4] = (uint8_t) (u32Num >> 8);
+	p8Snap[20] = (uint8_t) (u32Num / 7);
+	if ((u32Num % 100) == 99)
+	{
+		for (uint8_t u = 0; u < REWIND_TEST_SNAP_SIZE; u++)
+		{
+			p8Snap[u] = (uint8_t) (u32Num * 31 + u * 17);
+		}
+	}
+}
+
+static void rewind_test_check_all(const LDPInRewind_t *pRw)
+{
+	uint8_t expected[REWIND_TEST_SNAP_SIZE];
+	uint8_t actual[REWIND_TEST_SNAP_SIZE];
+
+	for (uint32_t u = ldpin_rewind_oldest(pRw); u < ldpin_rewind_next(pRw); u++)
+	{
+		rewind_test_snap(u, expected);
+		TEST_REQUIRE_EQUAL(1, ldpin_rewind_get(pRw, u, actual));
+		TEST_REQUIRE_EQUAL(0, memcmp(expected, actual, sizeof(actual)));
+	}
+}
+
+void test_rewind_get()
+{
+	uint32_t mem[4096 / 4];
+	LDPInRewind_t rw;
+	uint8_t snap[REWIND_TEST_SNAP_SIZE];
+
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_init(&rw, mem, sizeof(mem), REWIND_TEST_SNAP_SIZE, 60, 1000));
+	TEST_CHECK_EQUAL(1000, ldpin_rewind_oldest(&rw));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_get(&rw, 1000, snap));
+
+	// enough to wrap around the log many times
+	for (uint32_t u = 1000; u < 10000; u++)
+	{
+		rewind_test_snap(u, snap);
+		ldpin_rewind_push(&rw, snap);
+	}
+
+	TEST_CHECK_EQUAL(10000, ldpin_rewind_next(&rw));
+	TEST_CHECK(ldpin_rewind_oldest(&rw) > 1000);
+	TEST_CHECK(ldpin_rewind_oldest(&rw) < 9800);
+	TEST_CHECK(ldpin_rewind_bytes_used(&rw) <= sizeof(mem));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_get(&rw, ldpin_rewind_oldest(&rw) - 1, snap));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_get(&rw, 10000, snap));
+	rewind_test_check_all(&rw);
+}
+
+TEST_CASE(rewind_get)
+{
+	test_rewind_get();
+}
+
+void test_rewind_to()
+{
+	uint32_t mem[4096 / 4];
+	LDPInRewind_t rw;
+	uint8_t snap[REWIND_TEST_SNAP_SIZE];
+	uint8_t expected[REWIND_TEST_SNAP_SIZE];
+
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_init(&rw, mem, sizeof(mem), REWIND_TEST_SNAP_SIZE, 30, 0));
+	for (uint32_t u = 0; u < 500; u++)
+	{
+		rewind_test_snap(u, snap);
+		ldpin_rewind_push(&rw, snap);
+	}
+
+	// back to the middle of a group, then play on from there
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_to(&rw, 437, snap));
+	rewind_test_snap(437, expected);
+	TEST_CHECK_EQUAL(0, memcmp(expected, snap, sizeof(snap)));
+	TEST_CHECK_EQUAL(438, ldpin_rewind_next(&rw));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_get(&rw, 438, snap));
+
+	for (uint32_t u = 438; u < 1000; u++)
+	{
+		rewind_test_snap(u, snap);
+		ldpin_rewind_push(&rw, snap);
+	}
+	rewind_test_check_all(&rw);
+
+	// can't go forward, or further back than what is held
+	TEST_CHECK_EQUAL(0, ldpin_rewind_to(&rw, 1000, snap));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_to(&rw, ldpin_rewind_oldest(&rw) - 1, snap));
+	TEST_CHECK_EQUAL(1000, ldpin_rewind_next(&rw));
+}
+
+TEST_CASE(rewind_to)
+{
+	test_rewind_to();
+}
+
+void test_rewind_unchanged_costs_one_byte()
+{
+	uint32_t mem[8192 / 4];
+	LDPInRewind_t rw;
+	LDP1000Ctx_t ctx;
+	LDP1000Snapshot_t snap;
+	LDP1000Snapshot_t restored;
+
+	ctx_test_init(&ctx, ctx_test_callbacks<LDP1000Callbacks_t>());
+
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_init(&rw, mem, sizeof(mem), sizeof(snap), 60, 0));
+	ldp1000i_ctx_save(&ctx, &snap);
+	ldpin_rewind_push(&rw, &snap);
+	TEST_CHECK_EQUAL(1 + sizeof(snap), ldpin_rewind_bytes_used(&rw));
+
+	ldpin_rewind_push(&rw, &snap);
+	TEST_CHECK_EQUAL(2 + sizeof(snap), ldpin_rewind_bytes_used(&rw));
+
+	// the frame number changes every vblank
+	ldp1000i_ctx_set_cur_frame_num(&ctx, 12345);
+	ldp1000i_ctx_save(&ctx, &snap);
+	ldpin_rewind_push(&rw, &snap);
+	TEST_CHECK(ldpin_rewind_bytes_used(&rw) < 2 + sizeof(snap) + 16);
+
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_to(&rw, 2, &restored));
+	TEST_CHECK_EQUAL(0, memcmp(&snap, &restored, sizeof(snap)));
+	TEST_REQUIRE_EQUAL(1, ldpin_rewind_to(&rw, 0, &restored));
+	TEST_CHECK_EQUAL(LDP1000_TRUE, ldp1000i_ctx_restore(&ctx, &restored));
+	TEST_CHECK_EQUAL(0, ctx.state.frameCache.u8Valid);
+}
+
+TEST_CASE(rewind_unchanged_costs_one_byte)
+{
+	test_rewind_unchanged_costs_one_byte();
+}
+
+void test_rewind_init_too_small()
+{
+	uint32_t mem[16];
+	LDPInRewind_t rw;
+
+	TEST_CHECK_EQUAL(0, ldpin_rewind_init(&rw, mem, sizeof(mem), REWIND_TEST_SNAP_SIZE, 60, 0));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_init(&rw, mem, sizeof(mem), 0, 60, 0));
+	TEST_CHECK_EQUAL(0, ldpin_rewind_init(&rw, mem, sizeof(mem), 4, 0, 0));
+	TEST_CHECK_EQUAL(1, ldpin_rewind_init(&rw, mem, sizeof(mem), 4, 60, 0));
+}
+
+TEST_CASE(rewind_init_too_small)
+{
+	test_rewind_init_too_small();
+}
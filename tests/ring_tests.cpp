@@ -0,0 +1,152 @@
+#include "stdafx.h"
+#include <ldp-in/ring.h>
+
+void test_ring8_fifo_order()
+{
+	LDPInRing8_t ring;
+	ldpin_ring8_reset(&ring);
+
+	TEST_CHECK_EQUAL(0, ldpin_ring8_count(&ring));
+
+	// go around the free-running indices more than once to make sure they wrap properly
+	for (int i = 0; i < 600; i++)
+	{
+		TEST_REQUIRE(ldpin_ring8_push(&ring, (uint8_t) i) != 0);
+		TEST_REQUIRE(ldpin_ring8_push(&ring, (uint8_t) (i + 1)) != 0);
+		TEST_REQUIRE_EQUAL(2, ldpin_ring8_count(&ring));
+		TEST_REQUIRE_EQUAL((uint8_t) i, ldpin_ring8_pop(&ring));
+		TEST_REQUIRE_EQUAL((uint8_t) (i + 1), ldpin_ring8_pop(&ring));
+	}
+
+	TEST_CHECK_EQUAL(0, ldpin_ring8_count(&ring));
+	TEST_CHECK_EQUAL(0, ring.u8Overflows);
+}
+
+TEST_CASE(ring8_fifo_order)
+{
+	test_ring8_fifo_order();
+}
+
+void test_ring8_overflow()
+{
+	LDPInRing8_t ring;
+	ldpin_ring8_reset(&ring);
+
+	for (int i = 0; i < LDP_IN_RING_SIZE; i++)
+	{
+		TEST_REQUIRE(ldpin_ring8_push(&ring, (uint8_t) i) != 0);
+	}
+
+	// ring is full, so these get dropped and counted
+	TEST_CHECK_EQUAL(0, ldpin_ring8_push(&ring, 0xAA));
+	TEST_CHECK_EQUAL(0, ldpin_ring8_push(&ring, 0xAA));
+	TEST_CHECK_EQUAL(2, ring.u8Overflows);
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE, ldpin_ring8_count(&ring));
+
+	// nothing that was already queued got clobbered
+	for (int i = 0; i < LDP_IN_RING_SIZE; i++)
+	{
+		TEST_REQUIRE_EQUAL((uint8_t) i, ldpin_ring8_pop(&ring));
+	}
+
+	ldpin_ring8_reset(&ring);
+	TEST_CHECK_EQUAL(0, ring.u8Overflows);
+}
+
+TEST_CASE(ring8_overflow)
+{
+	test_ring8_overflow();
+}
+
+void test_ring8_push_n()
+{
+	LDPInRing8_t ring;
+	ldpin_ring8_reset(&ring);
+	uint8_t src[LDP_IN_RING_SIZE + 3];
+	for (int i = 0; i < (int) sizeof(src); i++) src[i] = (uint8_t) i;
+
+	// start partway around so that the copy wraps
+	ldpin_ring8_push(&ring, 0xAA);
+	ldpin_ring8_push(&ring, 0xAA);
+	ldpin_ring8_pop(&ring);
+	ldpin_ring8_pop(&ring);
+
+	TEST_CHECK_EQUAL(5, ldpin_ring8_push_n(&ring, src, 5));
+	TEST_CHECK_EQUAL(5, ldpin_ring8_count(&ring));
+
+	// the rest doesn't fit, so the extra entries are counted as overflows
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE - 5, ldpin_ring8_push_n(&ring, src + 5, LDP_IN_RING_SIZE - 2));
+	TEST_CHECK_EQUAL(LDP_IN_RING_SIZE, ldpin_ring8_count(&ring));
+	TEST_CHECK_EQUAL(3, ring.u8Overflows);
+
+	for (int i = 0; i < LDP_IN_RING_SIZE; i++)
+	{
+		TEST_REQUIRE_EQUAL(src[i], ldpin_ring8_pop(&ring));
+	}
+}
+
+TEST_CASE(ring8_push_n)
+{
+	test_ring8_push_n();
+}
+
+void test_ring8_peek_commit_wrap()
+{
+	LDPInRing8_t ring;
+	uint8_t u8Count = 0;
+	ldpin_ring8_reset(&ring);
+
+	// move the read position to 2 slots before the end of the buffer
+	for (int i = 0; i < LDP_IN_RING_SIZE - 2; i++)
+	{
+		ldpin_ring8_push(&ring, 0);
+		ldpin_ring8_pop(&ring);
+	}
+
+	ldpin_ring8_push(&ring, 1);
+	ldpin_ring8_push(&ring, 2);
+	ldpin_ring8_push(&ring, 3);
+
+	// only the part before the wrap is contiguous
+	const uint8_t *p8 = ldpin_ring8_peek(&ring, &u8Count);
+	TEST_REQUIRE_EQUAL(2, u8Count);
+	TEST_CHECK_EQUAL(1, p8[0]);
+	TEST_CHECK_EQUAL(2, p8[1]);
+	ldpin_ring8_commit(&ring, u8Count);
+
+	p8 = ldpin_ring8_peek(&ring, &u8Count);
+	TEST_REQUIRE_EQUAL(1, u8Count);
+	TEST_CHECK_EQUAL(3, p8[0]);
+	ldpin_ring8_commit(&ring, u8Count);
+
+	ldpin_ring8_peek(&ring, &u8Count);
+	TEST_CHECK_EQUAL(0, u8Count);
+}
+
+TEST_CASE(ring8_peek_commit_wrap)
+{
+	test_ring8_peek_commit_wrap();
+}
+
+void test_ring16_keeps_high_byte()
+{
+	LDPInRing16_t ring;
+	uint8_t u8Count = 0;
+	ldpin_ring16_reset(&ring);
+
+	ldpin_ring16_push(&ring, 0x030A);
+	ldpin_ring16_push(&ring, 0x050B);
+
+	const uint16_t *p16 = ldpin_ring16_peek(&ring, &u8Count);
+	TEST_REQUIRE_EQUAL(2, u8Count);
+	TEST_CHECK_EQUAL(0x030A, p16[0]);
+	ldpin_ring16_commit(&ring, 1);
+
+	TEST_CHECK_EQUAL(1, ldpin_ring16_count(&ring));
+	TEST_CHECK_EQUAL(0x050B, ldpin_ring16_pop(&ring));
+}
+
+TEST_CASE(ring16_keeps_high_byte)
+{
+	test_ring16_keeps_high_byte();
+}
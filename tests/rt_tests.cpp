@@ -0,0 +1,235 @@
+#include "stdafx.h"
+#include "rt_runtime.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// The runtime thread runs at the field rate and may be scheduled late, so nothing here depends on how many fields go by in a
+//  given time: the checks are on what the thread did around each field, recorded by the callbacks (which run on it) along with
+//  the field count at the time.
+
+static LDPInRtRuntime *g_pRtTestRt = 0;
+static std::vector<uint64_t> g_vRtTestSearches;	// fields run before each begin_search
+static std::vector<uint64_t> g_vRtTestStatus;	// fields run before each get_status
+static uint32_t g_u32RtTestVP931Play = 0;
+static uint64_t g_u64RtTestVP931PlayField = 0;
+
+static uint64_t rt_test_fields()
+{
+	LDPInRtStats stats;
+
+	g_pRtTestRt->GetStats(&stats);
+	return stats.u64Fields;
+}
+
+namespace rt_test_ldp1000
+{
+	void play(void *, uint8_t, uint8_t, LDP1000_BOOL, LDP1000_BOOL) { }
+	void pause(void *) { }
+	void begin_search(void *, uint32_t) { g_vRtTestSearches.push_back(rt_test_fields()); }
+	void step_forward(void *) { }
+	void step_reverse(void *) { }
+	void skip(void *, int16_t) { }
+	void change_audio(void *, uint8_t, uint8_t) { }
+	void change_video(void *, LDP1000_BOOL) { }
+	LDP1000Status_t get_status(void *) { g_vRtTestStatus.push_back(rt_test_fields()); return LDP1000_PAUSED; }
+	uint32_t get_cur_frame_num(void *) { return 123; }
+	void text_enable_changed(void *, LDP1000_BOOL) { }
+	void text_buffer_contents_changed(void *, const uint8_t *) { }
+	void text_buffer_start_index_changed(void *, uint8_t) { }
+	void text_modes_changed(void *, uint8_t, uint8_t, uint8_t) { }
+	void error(void *, LDP1000ErrCode_t, uint8_t) { }
+	const LDP1000Callbacks_t cbs = { play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed, text_modes_changed, error };
+}
+
+namespace rt_test_vp931
+{
+	void play(void *)
+	{
+		if (g_u32RtTestVP931Play++ == 0)
+		{
+			g_u64RtTestVP931PlayField = rt_test_fields();
+		}
+	}
+	void pause(void *) { }
+	void begin_search(void *, uint32_t, VP931_BOOL) { }
+	void skip_tracks(void *, int16_t) { }
+	void skip_to_framenum(void *, uint32_t) { }
+	void error(void *, VP931ErrCode_t, uint8_t) { }
+	const VP931Callbacks_t cbs = { play, pause, begin_search, skip_tracks, skip_to_framenum, error };
+}
+
+static const uint8_t g_au8RtTestSearch[] = { 0x43, 0x31, 0x32, 0x33, 0x40 };	// SEARCH 123 ENTER
+
+// what an LDP-1000 called directly queues for the search command and the vblank after it, latency classes and all
+static std::vector<uint16_t> rt_test_ldp1000_expected()
+{
+	LDP1000Ctx_t ctx;
+	std::vector<uint16_t> v;
+	uint16_t u16Val;
+	size_t uSearches = g_vRtTestSearches.size(), uStatus = g_vRtTestStatus.size();
+
+	ldp1000i_ctx_init(&ctx, &rt_test_ldp1000::cbs, 0);
+	ldp1000i_ctx_reset(&ctx, LDP1000_EMU_LDP1450);
+	for (size_t u = 0; u < sizeof(g_au8RtTestSearch); u++)
+	{
+		ldp1000i_ctx_write(&ctx, g_au8RtTestSearch[u]);
+	}
+	ldp1000i_ctx_think_during_vblank(&ctx);
+	while (ldp1000i_ctx_can_read(&ctx) != LDP1000_FALSE)
+	{
+		u16Val = ldp1000i_ctx_read(&ctx);
+		v.push_back(u16Val);
+	}
+
+	// (the callbacks above are meant for the runtime's context)
+	g_vRtTestSearches.resize(uSearches);
+	g_vRtTestStatus.resize(uStatus);
+	return v;
+}
+
+// reads uCount bytes from the runtime, giving up after a few seconds
+static std::vector<uint16_t> rt_test_read(LDPInRtRuntime *pRt, size_t uCount)
+{
+	std::vector<uint16_t> v;
+	uint16_t u16Val;
+
+	for (int i = 0; (i < 5000) && (v.size() < uCount); i++)
+	{
+		while ((v.size() < uCount) && pRt->Read(&u16Val))
+		{
+			v.push_back(u16Val);
+		}
+		if (v.size() < uCount)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	return v;
+}
+
+static bool rt_test_wait_fields(uint64_t u64Fields)
+{
+	for (int i = 0; (i < 5000) && (rt_test_fields() < u64Fields); i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return rt_test_fields() >= u64Fields;
+}
+
+void test_rt_ldp1000()
+{
+	LDPInRtRuntime rt;
+	LDP1000Ctx_t ctx;
+	VP931Ctx_t vp931;
+	LDPInRtConfig cfg;
+	LDPInRtStats stats;
+	std::string strErr;
+
+	g_pRtTestRt = &rt;
+	g_vRtTestSearches.clear();
+	g_vRtTestStatus.clear();
+	std::vector<uint16_t> expected = rt_test_ldp1000_expected();
+	TEST_REQUIRE_EQUAL(6u, expected.size());
+	TEST_CHECK_EQUAL((LDP1000_LATENCY_GENERIC << 8) | 1, expected[5]);
+
+	ldp1000i_ctx_init(&ctx, &rt_test_ldp1000::cbs, 0);
+	ldp1000i_ctx_reset(&ctx, LDP1000_EMU_LDP1450);
+	vp931i_ctx_init(&vp931, &rt_test_vp931::cbs, 0);
+	cfg.iPriority = 0;
+
+	// posted before the thread starts, so it is all applied before the first field
+	for (size_t u = 0; u < sizeof(g_au8RtTestSearch); u++)
+	{
+		TEST_REQUIRE(rt.Write(g_au8RtTestSearch[u]));
+	}
+	rt.SetCurFrame(123);
+	TEST_REQUIRE(rt.Start(&ctx, cfg, &strErr));
+
+	// a second Start is refused and leaves the thread on the context it has
+	TEST_CHECK(!rt.Start(&vp931, cfg, &strErr));
+
+	// the bytes come through with their latency classes, the search completion after the command's ACKs
+	TEST_CHECK(expected == rt_test_read(&rt, expected.size()));
+	TEST_REQUIRE_EQUAL(1u, g_vRtTestSearches.size());
+	TEST_CHECK_EQUAL(0u, g_vRtTestSearches[0]);
+	TEST_REQUIRE(!g_vRtTestStatus.empty());
+	TEST_CHECK_EQUAL(0u, g_vRtTestStatus[0]);
+
+	// once it is running, a command posted between two fields is applied before the second of them
+	TEST_REQUIRE(rt_test_wait_fields(3));
+	for (size_t u = 0; u < sizeof(g_au8RtTestSearch); u++)
+	{
+		TEST_REQUIRE(rt.Write(g_au8RtTestSearch[u]));
+	}
+	TEST_CHECK(expected == rt_test_read(&rt, expected.size()));
+	rt.Stop();
+
+	TEST_REQUIRE_EQUAL(2u, g_vRtTestSearches.size());
+	TEST_REQUIRE_EQUAL(2u, g_vRtTestStatus.size());
+	TEST_CHECK(g_vRtTestSearches[1] >= 3);
+	TEST_CHECK_EQUAL(g_vRtTestSearches[1], g_vRtTestStatus[1]);
+
+	// every field is either run or counted as skipped, and nothing was dropped
+	rt.GetStats(&stats);
+	TEST_CHECK(stats.u64Fields >= 4);
+	TEST_CHECK_EQUAL(0u, stats.u64Dropped);
+	TEST_CHECK_EQUAL(0u, stats.u64OutDropped);
+	TEST_CHECK(!stats.bRealtime);
+	TEST_CHECK(stats.u32JitterP50Us <= stats.u32JitterP99Us);
+	TEST_CHECK(stats.u32JitterP99Us <= stats.u32JitterP999Us);
+	TEST_CHECK(stats.u32JitterP999Us <= stats.u32JitterMaxUs);
+
+	// nothing more runs after Stop
+	uint16_t u16Val;
+	TEST_CHECK(!rt.Read(&u16Val));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	TEST_CHECK_EQUAL(stats.u64Fields, rt_test_fields());
+
+	g_pRtTestRt = 0;
+}
+
+TEST_CASE(rt_ldp1000)
+{
+	test_rt_ldp1000();
+}
+
+void test_rt_vp931_drops_extra_bytes()
+{
+	LDPInRtRuntime rt;
+	VP931Ctx_t ctx;
+	LDPInRtConfig cfg;
+	LDPInRtStats stats;
+	std::string strErr;
+
+	g_pRtTestRt = &rt;
+	g_u32RtTestVP931Play = 0;
+	vp931i_ctx_init(&ctx, &rt_test_vp931::cbs, 0);
+	vp931i_ctx_reset(&ctx);
+	cfg.iPriority = 0;
+
+	// go to a frame and play, then (unsupported) option bytes past what one vsync takes; only what fits goes to the first vsync, the
+	//  rest are counted
+	TEST_REQUIRE(rt.Write(0xF1));
+	for (uint32_t u = 1; u < LDPIN_RT_VP931_CMD_MAX + 5; u++)
+	{
+		TEST_REQUIRE(rt.Write(0x02));
+	}
+	rt.SetStatus(VP931_PAUSED);
+	TEST_REQUIRE(rt.Start(&ctx, cfg, &strErr));
+	TEST_REQUIRE(rt_test_wait_fields(2));
+	rt.Stop();
+
+	rt.GetStats(&stats);
+	TEST_CHECK_EQUAL(5u, stats.u64Dropped);
+	TEST_CHECK_EQUAL(1u, g_u32RtTestVP931Play);
+	TEST_CHECK_EQUAL(0u, g_u64RtTestVP931PlayField);
+
+	g_pRtTestRt = 0;
+}
+
+TEST_CASE(rt_vp931_drops_extra_bytes)
+{
+	test_rt_vp931_drops_extra_bytes();
+}
@@ -0,0 +1,178 @@
+#include "stdafx.h"
+#include "shm_client.h"
+#include "shm_server.h"
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <unistd.h>
+
+// a name of its own for each test, so that a run that dies doesn't get in the way of the next
+static std::string shm_test_name(const char *pszTest)
+{
+	char szName[64];
+	snprintf(szName, sizeof(szName), "/ldp-in.test.%s.%d", pszTest, (int) getpid());
+	return szName;
+}
+
+static LDP1000Status_t shm_test_ldp1000_get_status(void *) { return LDP1000_PAUSED; }
+static uint32_t shm_test_ldp1000_get_cur_frame_num(void *) { return 1; }
+static void shm_test_ldp1000_pause(void *) { }
+static void shm_test_ldp1000_begin_search(void *, uint32_t) { }
+
+static const uint8_t g_shmTestSearch[] = { 0x43, 0x31, 0x32, 0x33, 0x40 };	// SEARCH 123 ENTER
+
+void test_shm_vblank_keeps_its_place()
+{
+	LDPInShmServer server;
+	LDPInShmClient client;
+	std::string strName = shm_test_name("vblank");
+	std::string strErr;
+
+	TEST_REQUIRE(server.Create(strName.c_str(), LDPIN_TRACE_LDP1000, &strErr));
+	TEST_REQUIRE(client.Open(strName.c_str(), 1000, &strErr));
+	client.SetStatus(LDP1000_PAUSED);
+	client.SetCurFrame(1);
+
+	// the same thing in process: a search, a vblank (which finds it finished), then another search with no vblank after it
+	LDP1000Callbacks_t cb;
+	LDP1000Ctx_t ctx;
+	std::vector<uint16_t> expected;
+	memset(&cb, 0, sizeof(cb));
+	cb.get_status = shm_test_ldp1000_get_status;
+	cb.get_cur_frame_num = shm_test_ldp1000_get_cur_frame_num;
+	cb.pause = shm_test_ldp1000_pause;
+	cb.begin_search = shm_test_ldp1000_begin_search;
+	ldp1000i_ctx_init(&ctx, &cb, 0);
+	ldp1000i_ctx_reset(&ctx, LDP1000_EMU_LDP1450);
+	for (int iSearch = 0; iSearch < 2; iSearch++)
+	{
+		for (size_t u = 0; u < sizeof(g_shmTestSearch); u++)
+		{
+			ldp1000i_ctx_write(&ctx, g_shmTestSearch[u]);
+		}
+		if (iSearch == 0)
+		{
+			ldp1000i_ctx_think_during_vblank(&ctx);
+		}
+	}
+	while (ldp1000i_ctx_can_read(&ctx))
+	{
+		expected.push_back(ldp1000i_ctx_read(&ctx));
+	}
+	TEST_REQUIRE_EQUAL(11u, expected.size());
+	TEST_CHECK_EQUAL(1, expected[5] & 0xFF);	// search complete, between the two searches' ACKs
+
+	// Through the server, everything is pushed before it gets to run, so only the vblank ring can say where the vblank goes.
+	client.Reset(LDP1000_EMU_LDP1450);
+	for (int iSearch = 0; iSearch < 2; iSearch++)
+	{
+		for (size_t u = 0; u < sizeof(g_shmTestSearch); u++)
+		{
+			client.Write(g_shmTestSearch[u]);
+		}
+		if (iSearch == 0)
+		{
+			client.VBlank();
+		}
+	}
+	while (server.Poll()) { }
+
+	std::vector<uint16_t> got;
+	uint16_t u16Val;
+	while (client.Read(&u16Val))
+	{
+		got.push_back(u16Val);
+	}
+	TEST_CHECK(expected == got);
+
+	// and both searches were started
+	LDPInShmEvent ev;
+	int iSearches = 0;
+	while (client.PollEvent(&ev))
+	{
+		if (ev.u8Cb == LDPIN_SHM_CB(LDP1000Callbacks_t, begin_search))
+		{
+			TEST_CHECK_EQUAL(123u, ev.au32Args[0]);
+			iSearches++;
+		}
+	}
+	TEST_CHECK_EQUAL(2, iSearches);
+}
+
+TEST_CASE(shm_vblank_keeps_its_place)
+{
+	test_shm_vblank_keeps_its_place();
+}
+
+void test_shm_ldv1000_late_read_is_dropped()
+{
+	LDPInShmServer server;
+	LDPInShmClient client;
+	std::string strName = shm_test_name("late");
+	std::string strErr;
+
+	TEST_REQUIRE(server.Create(strName.c_str(), LDPIN_TRACE_LDV1000, &strErr));
+	TEST_REQUIRE(client.Open(strName.c_str(), 1000, &strErr));
+	client.SetStatus(LDV1000_PAUSED);
+
+	std::thread serverThread([&server]() { server.Run(0); });
+
+	// a read whose answer is never collected (as if it had timed out), then one that is: the late answer must not be taken for it
+	uint8_t u8Val;
+	client.RequestRead();
+	TEST_CHECK(client.ReadLDV1000(&u8Val, 1000000));
+
+	// nothing is left over to be taken for the next one either
+	uint16_t u16Val;
+	TEST_CHECK(!client.WaitRead(&u16Val, 100000));
+
+	client.Quit();
+	serverThread.join();
+}
+
+TEST_CASE(shm_ldv1000_late_read_is_dropped)
+{
+	test_shm_ldv1000_late_read_is_dropped();
+}
+
+void test_shm_vip9500sg()
+{
+	LDPInShmServer server;
+	LDPInShmClient client;
+	std::string strName = shm_test_name("vip9500sg");
+	std::string strErr;
+	static const uint8_t search[] = { 0x2B, '1', '2', '3', '4', '5', 0x41 };	// search to 12345
+
+	TEST_REQUIRE(server.Create(strName.c_str(), LDPIN_TRACE_VIP9500SG, &strErr));
+	TEST_REQUIRE(client.Open(strName.c_str(), 1000, &strErr));
+	TEST_CHECK_EQUAL(LDPIN_TRACE_VIP9500SG, client.Interp());
+	client.SetStatus(VIP9500SG_PAUSED);
+	client.SetCurFrame(1234);
+
+	for (size_t u = 0; u < sizeof(search); u++)
+	{
+		client.Write(search[u]);
+	}
+	client.VBlank();
+	while (server.Poll()) { }
+
+	std::vector<uint16_t> got;
+	uint16_t u16Val;
+	while (client.Read(&u16Val))
+	{
+		got.push_back(u16Val);
+	}
+	TEST_REQUIRE_EQUAL(2u, got.size());
+	TEST_CHECK_EQUAL(0x41, got[0]);
+	TEST_CHECK_EQUAL(0xB0, got[1]);
+
+	LDPInShmEvent ev;
+	TEST_REQUIRE(client.PollEvent(&ev));
+	TEST_CHECK_EQUAL(LDPIN_SHM_CB(VIP9500SGCallbacks_t, begin_search), ev.u8Cb);
+	TEST_CHECK_EQUAL(12345u, ev.au32Args[0]);
+}
+
+TEST_CASE(shm_vip9500sg)
+{
+	test_shm_vip9500sg();
+}
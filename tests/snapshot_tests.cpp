@@ -0,0 +1,182 @@
+#include "stdafx.h"
+#include <ldp-in/snapshot.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <string.h>
+#include "ctx_test_init.h"
+
+static void snapshot_test_on_ext_ack_changed(void *pUser, LD700_BOOL bActive) { }
+
+void test_snapshot_vip9500sg_restore()
+{
+	VIP9500SGCtx_t ctx;
+	VIP9500SGCtx_t other;
+	VIP9500SGSnapshot_t snap;
+
+	ctx_test_init_vip9500sg(&ctx);
+	ctx_test_init_vip9500sg(&other);
+
+	// 7 digits, so the number buffer has wrapped around
+	vip9500sgi_ctx_write(&ctx, 0x2b);	// start search
+	vip9500sgi_ctx_write(&ctx, '9');
+	vip9500sgi_ctx_write(&ctx, '9');
+	vip9500sgi_ctx_write(&ctx, '1');
+	vip9500sgi_ctx_write(&ctx, '2');
+	vip9500sgi_ctx_write(&ctx, '3');
+	vip9500sgi_ctx_write(&ctx, '4');
+	vip9500sgi_ctx_write(&ctx, '5');
+	vip9500sgi_ctx_save(&ctx, &snap);
+
+	vip9500sgi_ctx_write(&ctx, '6');
+	vip9500sgi_ctx_write(&ctx, 0x41);	// enter
+	TEST_CHECK_EQUAL(23456, g_u32CtxTestSearchFrame);
+	TEST_CHECK_EQUAL(0x41, vip9500sgi_ctx_read(&ctx));
+
+	// back to before the 6 was entered
+	TEST_REQUIRE(vip9500sgi_ctx_restore(&ctx, &snap) == VIP9500SG_TRUE);
+	vip9500sgi_ctx_write(&ctx, 0x41);
+	TEST_CHECK_EQUAL(12345, g_u32CtxTestSearchFrame);
+	TEST_CHECK_EQUAL(0x41, vip9500sgi_ctx_read(&ctx));
+	TEST_CHECK_EQUAL(VIP9500SG_FALSE, vip9500sgi_ctx_can_read(&ctx));
+
+	// nothing in a snapshot points into the context that saved it, so another context can pick up from the same point
+	g_u32CtxTestSearchFrame = 0;
+	TEST_REQUIRE(vip9500sgi_ctx_restore(&other, &snap) == VIP9500SG_TRUE);
+	vip9500sgi_ctx_write(&other, '7');
+	vip9500sgi_ctx_write(&other, 0x41);
+	TEST_CHECK_EQUAL(23457, g_u32CtxTestSearchFrame);	// the 1 drops off the front, as it would have in ctx
+}
+
+TEST_CASE(snapshot_vip9500sg_restore)
+{
+	test_snapshot_vip9500sg_restore();
+}
+
+void test_snapshot_same_state_same_bytes()
+{
+	VIP9500SGCtx_t ctx;
+	VIP9500SGSnapshot_t snap1;
+	VIP9500SGSnapshot_t snap2;
+
+	ctx_test_init_vip9500sg(&ctx);
+	vip9500sgi_ctx_write(&ctx, 0x2b);
+	vip9500sgi_ctx_write(&ctx, '1');
+
+	memset(&snap1, 0xAA, sizeof(snap1));
+	memset(&snap2, 0x55, sizeof(snap2));
+	vip9500sgi_ctx_save(&ctx, &snap1);
+	vip9500sgi_ctx_save(&ctx, &snap2);
+
+	TEST_CHECK_EQUAL(0, memcmp(&snap1, &snap2, sizeof(snap1)));
+}
+
+TEST_CASE(snapshot_same_state_same_bytes)
+{
+	test_snapshot_same_state_same_bytes();
+}
+
+void test_snapshot_rejects_mismatch()
+{
+	LDP1000Ctx_t ctx;
+	LDP1000Snapshot_t snap;
+	LDP1000Snapshot_t bad;
+
+	ctx_test_init(&ctx, ctx_test_callbacks<LDP1000Callbacks_t>());
+	ldp1000i_ctx_save(&ctx, &snap);
+
+	TEST_CHECK_EQUAL(LDPIN_TRACE_LDP1000, snap.hdr.u8Interp);
+	TEST_CHECK_EQUAL(LDP1000_SNAPSHOT_VERSION, snap.hdr.u8Version);
+	TEST_CHECK_EQUAL(sizeof(LDP1000CtxState_t), snap.hdr.u16Size);
+
+	bad = snap;
+	bad.hdr.u8Interp = LDPIN_TRACE_VIP9500SG;
+	TEST_CHECK_EQUAL(LDP1000_FALSE, ldp1000i_ctx_restore(&ctx, &bad));
+
+	bad = snap;
+	bad.hdr.u8Version++;
+	TEST_CHECK_EQUAL(LDP1000_FALSE, ldp1000i_ctx_restore(&ctx, &bad));
+
+	// saved by a build with a different LDP_IN_RING_SIZE, for example
+	bad = snap;
+	bad.hdr.u16Size--;
+	bad.state.type = LDP1000_EMU_LDP1000A;
+	TEST_CHECK_EQUAL(LDP1000_FALSE, ldp1000i_ctx_restore(&ctx, &bad));
+	TEST_CHECK_EQUAL(LDP1000_EMU_LDP1450, ctx.state.type);
+
+	TEST_CHECK_EQUAL(LDP1000_TRUE, ldp1000i_ctx_restore(&ctx, &snap));
+}
+
+TEST_CASE(snapshot_rejects_mismatch)
+{
+	test_snapshot_rejects_mismatch();
+}
+
+void test_snapshot_rejects_corrupt()
+{
+	LD700Ctx_t ld700;
+	LD700Callbacks_t ld700cb;
+	LD700Snapshot_t ld700snap, ld700bad;
+	VP932Ctx_t vp932;
+	VP932Snapshot_t vp932snap, vp932bad;
+	LDP1000Ctx_t ldp1000;
+	LDP1000Snapshot_t ldp1000snap, ldp1000bad;
+	VIP9500SGCtx_t vip;
+	VIP9500SGSnapshot_t vipsnap, vipbad;
+
+	// a save state file with the right header but damaged contents must not let the next write index past a buffer
+	ld700cb = ctx_test_callbacks<LD700Callbacks_t>();
+	ld700cb.on_ext_ack_changed = snapshot_test_on_ext_ack_changed;
+	ctx_test_init(&ld700, ld700cb);
+	ld700i_ctx_save(&ld700, &ld700snap);
+	ld700bad = ld700snap;
+	ld700bad.state.u8NumBufEnd = LD700_NUMBUFSIZE;
+	TEST_CHECK_EQUAL(LD700_FALSE, ld700i_ctx_restore(&ld700, &ld700bad));
+	ld700bad = ld700snap;
+	ld700bad.state.u8NumBufStart = 0xFF;
+	TEST_CHECK_EQUAL(LD700_FALSE, ld700i_ctx_restore(&ld700, &ld700bad));
+	ld700bad = ld700snap;
+	ld700bad.state.u8NumBufCount = LD700_NUMBUFSIZE + 1;
+	TEST_CHECK_EQUAL(LD700_FALSE, ld700i_ctx_restore(&ld700, &ld700bad));
+	TEST_CHECK_EQUAL(0, ld700.state.u8NumBufEnd);
+	TEST_CHECK_EQUAL(LD700_TRUE, ld700i_ctx_restore(&ld700, &ld700snap));
+
+	ctx_test_init(&vp932, ctx_test_callbacks<VP932Callbacks_t>());
+	vp932i_ctx_save(&vp932, &vp932snap);
+	vp932bad = vp932snap;
+	vp932bad.state.rx_buf_idx = VP932_RX_BUFSIZE + 1;
+	TEST_CHECK_EQUAL(VP932_FALSE, vp932i_ctx_restore(&vp932, &vp932bad));
+	vp932bad = vp932snap;
+	vp932bad.state.tx.u8Head = (uint8_t) (vp932bad.state.tx.u8Tail + LDP_IN_RING_SIZE + 1);
+	TEST_CHECK_EQUAL(VP932_FALSE, vp932i_ctx_restore(&vp932, &vp932bad));
+	TEST_CHECK_EQUAL(0, vp932.state.rx_buf_idx);
+	vp932bad = vp932snap;
+	vp932bad.state.rx_buf_idx = VP932_RX_BUFSIZE;	// a full buffer is fine
+	TEST_CHECK_EQUAL(VP932_TRUE, vp932i_ctx_restore(&vp932, &vp932bad));
+
+	ctx_test_init(&ldp1000, ctx_test_callbacks<LDP1000Callbacks_t>());
+	ldp1000i_ctx_save(&ldp1000, &ldp1000snap);
+	ldp1000bad = ldp1000snap;
+	ldp1000bad.state.u8UIC_StartIdx = sizeof(ldp1000bad.state.UIC_TextBuf);
+	TEST_CHECK_EQUAL(LDP1000_FALSE, ldp1000i_ctx_restore(&ldp1000, &ldp1000bad));
+	ldp1000bad = ldp1000snap;
+	ldp1000bad.state.tx.u8Tail = (uint8_t) (ldp1000bad.state.tx.u8Head + 1);
+	TEST_CHECK_EQUAL(LDP1000_FALSE, ldp1000i_ctx_restore(&ldp1000, &ldp1000bad));
+	TEST_CHECK_EQUAL(LDP1000_TRUE, ldp1000i_ctx_restore(&ldp1000, &ldp1000snap));
+
+	ctx_test_init_vip9500sg(&vip);
+	vip9500sgi_ctx_save(&vip, &vipsnap);
+	vipbad = vipsnap;
+	vipbad.state.u8NumBufEnd = VIP9500SG_NUMBUFSIZE;
+	TEST_CHECK_EQUAL(VIP9500SG_FALSE, vip9500sgi_ctx_restore(&vip, &vipbad));
+	vipbad = vipsnap;
+	vipbad.state.u8NumBufCount = 0xFF;
+	TEST_CHECK_EQUAL(VIP9500SG_FALSE, vip9500sgi_ctx_restore(&vip, &vipbad));
+	TEST_CHECK_EQUAL(VIP9500SG_TRUE, vip9500sgi_ctx_restore(&vip, &vipsnap));
+}
+
+TEST_CASE(snapshot_rejects_corrupt)
+{
+	test_snapshot_rejects_corrupt();
+}
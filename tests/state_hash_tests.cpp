@@ -0,0 +1,307 @@
+#include "stdafx.h"
+#include <ldp-in/state-hash.h>
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <string.h>
+#include <vector>
+#include "ctx_test_init.h"
+
+// the bytes of one field of a state, as the hash sees them
+static std::string state_hash_test_value(const void *pState, const LDPInStateField_t *pFields, uint8_t u8Count, const char *pszName)
+{
+	uint8_t buf[LDPIN_STATE_FIELD_MAX_VALUE];
+
+	for (uint8_t u = 0; u < u8Count; u++)
+	{
+		if (strcmp(pFields[u].pszName, pszName) == 0)
+		{
+			return std::string((const char *) buf, ldpin_state_field_value(pState, &pFields[u], buf));
+		}
+	}
+
+	return "missing";
+}
+
+void test_state_hash_ring_position()
+{
+	LDV1000Ctx_t ctx;
+	LDV1000Ctx_t other;
+	LDV1000Callbacks_t cb;
+
+	cb = ctx_test_callbacks<LDV1000Callbacks_t>();
+	ldv1000i_ctx_init(&ctx, &cb, 0);
+	ldv1000i_ctx_init(&other, &cb, 0);
+	TEST_CHECK_EQUAL(ldv1000i_ctx_hash(&ctx), ldv1000i_ctx_hash(&other));
+
+	// the same bytes queued, but in a different place in the ring
+	ldpin_ring8_push(&ctx.state.tx, 'A');
+	ldpin_ring8_push(&ctx.state.tx, 'B');
+	ldpin_ring8_push(&other.state.tx, 'x');
+	ldpin_ring8_push(&other.state.tx, 'y');
+	ldpin_ring8_push(&other.state.tx, 'A');
+	ldpin_ring8_push(&other.state.tx, 'B');
+	ldpin_ring8_pop(&other.state.tx);
+	ldpin_ring8_pop(&other.state.tx);
+	TEST_CHECK(memcmp(&ctx.state, &other.state, sizeof(ctx.state)) != 0);
+	TEST_CHECK_EQUAL(ldv1000i_ctx_hash(&ctx), ldv1000i_ctx_hash(&other));
+
+	// what is queued matters
+	ldpin_ring8_pop(&other.state.tx);
+	TEST_CHECK(ldv1000i_ctx_hash(&ctx) != ldv1000i_ctx_hash(&other));
+
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ldv1000i_state_fields(&u8Count);
+	TEST_CHECK_EQUAL(std::string("\x02" "AB" "\x00", 4), state_hash_test_value(&ctx.state, pFields, u8Count, "tx"));
+	TEST_CHECK_EQUAL(std::string("\x01" "B" "\x00", 3), state_hash_test_value(&other.state, pFields, u8Count, "tx"));
+}
+
+TEST_CASE(state_hash_ring_position)
+{
+	test_state_hash_ring_position();
+}
+
+void test_state_hash_number_buffer()
+{
+	VIP9500SGCtx_t ctx;
+	VIP9500SGCtx_t other;
+
+	ctx_test_init_vip9500sg(&ctx);
+	ctx_test_init_vip9500sg(&other);
+
+	// both end up holding 12345, but the 7 digits have wrapped the buffer around
+	vip9500sgi_ctx_write(&ctx, 0x2b);
+	vip9500sgi_ctx_write_n(&ctx, (const uint8_t *) "12345", 5);
+	vip9500sgi_ctx_write(&other, 0x2b);
+	vip9500sgi_ctx_write_n(&other, (const uint8_t *) "9912345", 7);
+	TEST_CHECK(ctx.state.u8NumBufStart != other.state.u8NumBufStart);
+	TEST_CHECK_EQUAL(vip9500sgi_ctx_hash(&ctx), vip9500sgi_ctx_hash(&other));
+
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = vip9500sgi_state_fields(&u8Count);
+	TEST_CHECK_EQUAL(std::string("\x05" "12345"), state_hash_test_value(&other.state, pFields, u8Count, "num_buf"));
+
+	vip9500sgi_ctx_write(&other, '6');
+	TEST_CHECK(vip9500sgi_ctx_hash(&ctx) != vip9500sgi_ctx_hash(&other));
+	TEST_CHECK_EQUAL(std::string("\x05" "23456"), state_hash_test_value(&other.state, pFields, u8Count, "num_buf"));
+}
+
+TEST_CASE(state_hash_number_buffer)
+{
+	test_state_hash_number_buffer();
+}
+
+void test_state_hash_every_field_counts()
+{
+	LDP1000Ctx_t ctx;
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ldp1000i_state_fields(&u8Count);
+
+	ctx_test_init(&ctx, ctx_test_callbacks<LDP1000Callbacks_t>());
+	uint64_t u64Hash = ldp1000i_ctx_hash(&ctx);
+
+	// changing the first byte of any plain field changes the hash
+	for (uint8_t u = 0; u < u8Count; u++)
+	{
+		if ((pFields[u].u8Kind != LDPIN_FIELD_UINT) && (pFields[u].u8Kind != LDPIN_FIELD_BYTES))
+		{
+			continue;
+		}
+
+		LDP1000Ctx_t changed = ctx;
+		((uint8_t *) &changed.state)[pFields[u].u16Offset] ^= 1;
+		TEST_CHECK(ldp1000i_ctx_hash(&changed) != u64Hash);
+	}
+
+	ldp1000i_ctx_set_cur_frame_num(&ctx, 12345);
+	TEST_CHECK(ldp1000i_ctx_hash(&ctx) != u64Hash);
+	TEST_CHECK_EQUAL(std::string("12345"), state_hash_test_value(&ctx.state, pFields, u8Count, "frameCache.au8Ascii"));
+	TEST_CHECK_EQUAL(std::string("\x39\x30\x00\x00", 4), state_hash_test_value(&ctx.state, pFields, u8Count, "frameCache.u32Frame"));
+}
+
+TEST_CASE(state_hash_every_field_counts)
+{
+	test_state_hash_every_field_counts();
+}
+
+// Checks that a field table covers each byte of its state once, apart from the one-byte indices at the offsets in vDerived (which
+//  follow from other fields) and u32Padding bytes of padding.
+// The padding is what a host with 4-byte enums and ints puts in; a member left out of the table shows up as extra padding (or as
+//  too little, if it went into what used to be padding).
+static void state_hash_test_coverage(const LDPInStateField_t *pFields, uint8_t u8Count, size_t uStateSize,
+	const std::vector<size_t> &vDerived, uint32_t u32Padding)
+{
+	std::vector<uint8_t> vCovered(uStateSize, 0);
+	uint32_t u32Uncovered = 0;
+
+	for (uint8_t u = 0; u < u8Count; u++)
+	{
+		TEST_REQUIRE(pFields[u].u16Offset + pFields[u].u8Size <= uStateSize);
+		for (uint8_t u8 = 0; u8 < pFields[u].u8Size; u8++)
+		{
+			vCovered[pFields[u].u16Offset + u8]++;
+		}
+
+		// a queue's start index and count, and a prefix buffer's count, are part of the field
+		if (pFields[u].u8Kind == LDPIN_FIELD_QUEUE)
+		{
+			vCovered[pFields[u].u16IdxOffset]++;
+		}
+		if ((pFields[u].u8Kind == LDPIN_FIELD_QUEUE) || (pFields[u].u8Kind == LDPIN_FIELD_PREFIX))
+		{
+			vCovered[pFields[u].u16CountOffset]++;
+		}
+	}
+	for (size_t u = 0; u < vDerived.size(); u++)
+	{
+		vCovered[vDerived[u]]++;
+	}
+
+	for (size_t u = 0; u < uStateSize; u++)
+	{
+		TEST_CHECK(vCovered[u] <= 1);
+		if (vCovered[u] == 0)
+		{
+			u32Uncovered++;
+		}
+	}
+	TEST_CHECK_EQUAL(u32Padding, u32Uncovered);
+}
+
+void test_state_hash_covers_ldv1000()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ldv1000i_state_fields(&u8Count);
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(LDV1000CtxState_t), std::vector<size_t>(), 7);
+}
+
+TEST_CASE(state_hash_covers_ldv1000)
+{
+	test_state_hash_covers_ldv1000();
+}
+
+void test_state_hash_covers_ldp1000()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ldp1000i_state_fields(&u8Count);
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(LDP1000CtxState_t), std::vector<size_t>(), 12);
+}
+
+TEST_CASE(state_hash_covers_ldp1000)
+{
+	test_state_hash_covers_ldp1000();
+}
+
+void test_state_hash_covers_pr7820()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = pr7820i_state_fields(&u8Count);
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(PR7820CtxState_t), std::vector<size_t>(), 2);
+}
+
+TEST_CASE(state_hash_covers_pr7820)
+{
+	test_state_hash_covers_pr7820();
+}
+
+void test_state_hash_covers_pr8210()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = pr8210i_state_fields(&u8Count);
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(PR8210CtxState_t), std::vector<size_t>(), 6);
+}
+
+TEST_CASE(state_hash_covers_pr8210)
+{
+	test_state_hash_covers_pr8210();
+}
+
+void test_state_hash_covers_vip9500sg()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = vip9500sgi_state_fields(&u8Count);
+	std::vector<size_t> vDerived(1, offsetof(VIP9500SGCtxState_t, u8NumBufEnd));
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(VIP9500SGCtxState_t), vDerived, 5);
+}
+
+TEST_CASE(state_hash_covers_vip9500sg)
+{
+	test_state_hash_covers_vip9500sg();
+}
+
+void test_state_hash_covers_vp932()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = vp932i_state_fields(&u8Count);
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(VP932CtxState_t), std::vector<size_t>(), 2);
+}
+
+TEST_CASE(state_hash_covers_vp932)
+{
+	test_state_hash_covers_vp932();
+}
+
+void test_state_hash_covers_ld700()
+{
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ld700i_state_fields(&u8Count);
+	std::vector<size_t> vDerived(1, offsetof(LD700CtxState_t, u8NumBufEnd));
+
+	state_hash_test_coverage(pFields, u8Count, sizeof(LD700CtxState_t), vDerived, 5);
+}
+
+TEST_CASE(state_hash_covers_ld700)
+{
+	test_state_hash_covers_ld700();
+}
+
+void test_state_hash_stream()
+{
+	uint8_t buf[LDPIN_HASHSTREAM_HEADER_SIZE + LDPIN_HASHSTREAM_RECORD_SIZE + sizeof(LDP1000Snapshot_t)];
+	LDP1000Ctx_t ctx;
+	LDP1000Snapshot_t snap;
+	uint8_t u8Interp = 0;
+	uint16_t u16SnapSize = 0;
+	uint32_t u32VBlank = 0;
+	uint64_t u64Hash = 0;
+
+	ctx_test_init(&ctx, ctx_test_callbacks<LDP1000Callbacks_t>());
+	ldp1000i_ctx_save(&ctx, &snap);
+
+	ldpin_hashstream_write_header(buf, LDPIN_TRACE_LDP1000, sizeof(snap));
+	TEST_REQUIRE_EQUAL(1, ldpin_hashstream_read_header(buf, sizeof(buf), &u8Interp, &u16SnapSize));
+	TEST_CHECK_EQUAL(LDPIN_TRACE_LDP1000, u8Interp);
+	TEST_CHECK_EQUAL(sizeof(snap), u16SnapSize);
+	TEST_CHECK_EQUAL(0, ldpin_hashstream_read_header(buf, LDPIN_HASHSTREAM_HEADER_SIZE - 1, &u8Interp, &u16SnapSize));
+
+	uint8_t *p8Rec = buf + LDPIN_HASHSTREAM_HEADER_SIZE;
+	TEST_CHECK_EQUAL(LDPIN_HASHSTREAM_RECORD_SIZE + sizeof(snap),
+		ldpin_hashstream_write_record(p8Rec, 0x12345678, ldp1000i_ctx_hash(&ctx), &snap, sizeof(snap)));
+	ldpin_hashstream_read_record(p8Rec, &u32VBlank, &u64Hash);
+	TEST_CHECK_EQUAL(0x12345678, u32VBlank);
+	TEST_CHECK_EQUAL(ldp1000i_ctx_hash(&ctx), u64Hash);
+
+	// the hash can be recomputed from the stored snapshot
+	uint8_t u8Count;
+	const LDPInStateField_t *pFields = ldp1000i_state_fields(&u8Count);
+	memcpy(&snap, p8Rec + LDPIN_HASHSTREAM_RECORD_SIZE, sizeof(snap));
+	TEST_CHECK_EQUAL(u64Hash, ldpin_state_hash(&snap.state, pFields, u8Count));
+
+	buf[4] = LDPIN_HASHSTREAM_VERSION + 1;
+	TEST_CHECK_EQUAL(0, ldpin_hashstream_read_header(buf, sizeof(buf), &u8Interp, &u16SnapSize));
+}
+
+TEST_CASE(state_hash_stream)
+{
+	test_state_hash_stream();
+}
@@ -0,0 +1,74 @@
+// Links the LD-V1000 interpreter in a LDP_IN_STATIC_CALLBACKS build against host_* functions defined here, and checks that it
+//  calls them (with the context's pUser) where a function pointer build would call its callbacks.
+// The unit tests can't do this, since they swap mock callbacks in and out at runtime.
+
+#include <ldp-in/ldv1000-interpreter.h>
+#include <stdio.h>
+
+#ifndef LDP_IN_STATIC_CALLBACKS
+#error "static_callbacks_check is for LDP_IN_STATIC_CALLBACKS builds"
+#endif
+
+typedef struct
+{
+	uint8_t u8Play;
+	uint8_t u8FrameQueries;
+	uint8_t u8Other;
+	uint8_t bWrongUser;
+} CheckCalls_t;
+
+static CheckCalls_t g_calls;
+
+// every callback notes that it was called, and whether it was passed the pUser given to ldv1000i_ctx_init
+static void check_user(void *pUser, uint8_t *pu8Count)
+{
+	if (pUser != &g_calls)
+	{
+		g_calls.bWrongUser = 1;
+	}
+	(*pu8Count)++;
+}
+
+LDV1000Status_t ldv1000i_host_get_status(void *pUser) { check_user(pUser, &g_calls.u8Other); return LDV1000_PLAYING; }
+uint32_t ldv1000i_host_get_cur_frame_num(void *pUser) { check_user(pUser, &g_calls.u8FrameQueries); return 12345; }
+void ldv1000i_host_play(void *pUser) { check_user(pUser, &g_calls.u8Play); }
+void ldv1000i_host_pause(void *pUser) { check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_begin_search(void *pUser, uint32_t uFrameNumber) { (void) uFrameNumber; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_step_reverse(void *pUser) { check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_change_speed(void *pUser, uint8_t uNumerator, uint8_t uDenominator) { (void) uNumerator; (void) uDenominator; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_skip_forward(void *pUser, uint8_t uTracks) { (void) uTracks; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_skip_backward(void *pUser, uint8_t uTracks) { (void) uTracks; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_change_audio(void *pUser, uint8_t uChannel, uint8_t uEnable) { (void) uChannel; (void) uEnable; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_on_error(void *pUser, const char *pszErrMsg) { (void) pszErrMsg; check_user(pUser, &g_calls.u8Other); }
+const uint8_t *ldv1000i_host_query_available_discs(void *pUser) { static const uint8_t discs[] = { 1, 0 }; check_user(pUser, &g_calls.u8Other); return discs; }
+uint8_t ldv1000i_host_query_active_disc(void *pUser) { check_user(pUser, &g_calls.u8Other); return 1; }
+void ldv1000i_host_begin_changing_to_disc(void *pUser, uint8_t idDisc) { (void) idDisc; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_change_seek_delay(void *pUser, LDV1000_BOOL bEnabled) { (void) bEnabled; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_change_spinup_delay(void *pUser, LDV1000_BOOL bEnabled) { (void) bEnabled; check_user(pUser, &g_calls.u8Other); }
+void ldv1000i_host_change_super_mode(void *pUser, LDV1000_BOOL bEnabled) { (void) bEnabled; check_user(pUser, &g_calls.u8Other); }
+
+int main()
+{
+	LDV1000Ctx_t ctx;
+	unsigned char digits[5];
+
+	ldv1000i_ctx_init(&ctx, 0, &g_calls);
+	ldv1000i_ctx_reset(&ctx, LDV1000_EMU_STANDARD);
+
+	// play, then get the current frame
+	ldv1000i_ctx_write(&ctx, 0xFF);
+	ldv1000i_ctx_write(&ctx, 0xFD);
+	ldv1000i_ctx_write(&ctx, 0xFF);
+	ldv1000i_ctx_write(&ctx, 0xC2);
+	ldv1000i_ctx_read_n(&ctx, digits, 5);
+
+	if ((g_calls.u8Play != 1) || (g_calls.u8FrameQueries == 0) || g_calls.bWrongUser || (digits[0] != '1') || (digits[4] != '5'))
+	{
+		printf("static callbacks: play %u, frame queries %u, other %u, wrong pUser %u, digits %.5s\n", g_calls.u8Play,
+			g_calls.u8FrameQueries, g_calls.u8Other, g_calls.bWrongUser, (const char *) digits);
+		return 1;
+	}
+
+	printf("static callbacks: ok\n");
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include <ldp-in/trace-file.h>
+
+static LDPInTraceRecord_t make_record(uint8_t u8Kind, uint8_t u8Interp, uint16_t u16VBlank, uint32_t u32Val)
+{
+	LDPInTraceRecord_t rec;
+	rec.u8Kind = u8Kind;
+	rec.u8Interp = u8Interp;
+	rec.u16VBlank = u16VBlank;
+	rec.u32Val = u32Val;
+	return rec;
+}
+
+void test_trace_file_round_trip()
+{
+	const LDPInTraceRecord_t recs[] =
+	{
+		make_record(LDPIN_TRACE_RESET, LDPIN_TRACE_LDV1000, 0, 0),
+		make_record(LDPIN_TRACE_WRITE, LDPIN_TRACE_LDV1000, 0, 0xC2),
+		make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDV1000, 0, 1),
+		make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDV1000, 0, 12345),
+		make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 1, 0),
+		make_record(LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_LDV1000, 1, 12346),
+		make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDV1000, 1, 0),
+		make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDV1000, 1, 0xE4),
+		make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDV1000, 1, 1),
+		make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDV1000, 1, 12300),	// goes backward
+		make_record(LDPIN_TRACE_READ, LDPIN_TRACE_LDV1000, 1, 0),
+		make_record(LDPIN_TRACE_OUTPUT, LDPIN_TRACE_LDV1000, 1, 0xFC),
+		make_record(LDPIN_TRACE_ERROR, LDPIN_TRACE_LDV1000, 1, 0x1234 << 8),
+		make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 9, 0),	// records were dropped
+		make_record(LDPIN_TRACE_WRITE, LDPIN_TRACE_LDV1000, 9, 0xFFFFFFFF),
+		make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDV1000, 9, 200),	// past LDPIN_TRACEFILE_MAX_CALLBACKS
+		make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDV1000, 9, 7),
+		make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 0, 0),	// wraps
+	};
+	const size_t uCount = sizeof(recs) / sizeof(recs[0]);
+	uint8_t buf[LDPIN_TRACEFILE_HEADER_SIZE + (sizeof(recs) / sizeof(recs[0])) * LDPIN_TRACEFILE_MAX_ENCODED];
+	LDPInTraceCodec_t enc, dec;
+	uint32_t u32Len = LDPIN_TRACEFILE_HEADER_SIZE;
+
+	ldpin_tracefile_init(&enc, LDPIN_TRACE_LDV1000, 0);
+	ldpin_tracefile_write_header(&enc, buf);
+
+	for (size_t i = 0; i < uCount; i++)
+	{
+		// the last record starts the count just before the wrap
+		if (i == uCount - 1)
+		{
+			LDPInTraceRecord_t rec = make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 0xFFFF, 0);
+			u32Len += ldpin_tracefile_encode(&enc, &rec, buf + u32Len);
+		}
+		uint8_t u8Len = ldpin_tracefile_encode(&enc, &recs[i], buf + u32Len);
+		TEST_REQUIRE(u8Len > 0);
+		TEST_REQUIRE(u8Len <= LDPIN_TRACEFILE_MAX_ENCODED);
+		u32Len += u8Len;
+	}
+
+	TEST_REQUIRE(ldpin_tracefile_read_header(&dec, buf, u32Len) != 0);
+	TEST_CHECK_EQUAL(LDPIN_TRACE_LDV1000, dec.u8Interp);
+
+	const uint8_t *p8 = buf + LDPIN_TRACEFILE_HEADER_SIZE;
+	const uint8_t *p8End = buf + u32Len;
+	for (size_t i = 0; i < uCount; i++)
+	{
+		LDPInTraceRecord_t rec;
+		uint8_t u8Len = ldpin_tracefile_decode(&dec, p8, p8End, &rec);
+		TEST_REQUIRE(u8Len > 0);
+		p8 += u8Len;
+
+		if (i == uCount - 1)
+		{
+			TEST_REQUIRE_EQUAL(0xFFFF, rec.u16VBlank);
+			u8Len = ldpin_tracefile_decode(&dec, p8, p8End, &rec);
+			TEST_REQUIRE(u8Len > 0);
+			p8 += u8Len;
+		}
+
+		TEST_CHECK_EQUAL(recs[i].u8Kind, rec.u8Kind);
+		TEST_CHECK_EQUAL(recs[i].u8Interp, rec.u8Interp);
+		TEST_CHECK_EQUAL(recs[i].u16VBlank, rec.u16VBlank);
+		TEST_CHECK_EQUAL(recs[i].u32Val, rec.u32Val);
+	}
+
+	TEST_CHECK(p8 == p8End);
+}
+
+TEST_CASE(trace_file_round_trip)
+{
+	test_trace_file_round_trip();
+}
+
+void test_trace_file_sizes()
+{
+	LDPInTraceCodec_t enc;
+	uint8_t buf[LDPIN_TRACEFILE_MAX_ENCODED];
+	LDPInTraceRecord_t rec;
+
+	ldpin_tracefile_init(&enc, LDPIN_TRACE_LDP1000, 0);
+
+	rec = make_record(LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_LDP1000, 0, 30000);
+	TEST_CHECK_EQUAL(4, ldpin_tracefile_encode(&enc, &rec, buf));
+
+	// a vblank and the next frame while playing
+	rec = make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_LDP1000, 1, 0);
+	TEST_CHECK_EQUAL(1, ldpin_tracefile_encode(&enc, &rec, buf));
+	rec = make_record(LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_LDP1000, 1, 30001);
+	TEST_CHECK_EQUAL(1, ldpin_tracefile_encode(&enc, &rec, buf));
+
+	// a command byte
+	rec = make_record(LDPIN_TRACE_WRITE, LDPIN_TRACE_LDP1000, 1, 0x60);
+	TEST_CHECK_EQUAL(2, ldpin_tracefile_encode(&enc, &rec, buf));
+
+	// a status, then the same status again
+	rec = make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDP1000, 1, 8);
+	TEST_CHECK_EQUAL(2, ldpin_tracefile_encode(&enc, &rec, buf));
+	rec = make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDP1000, 1, 0x64);
+	TEST_CHECK_EQUAL(3, ldpin_tracefile_encode(&enc, &rec, buf));
+	rec = make_record(LDPIN_TRACE_CALLBACK, LDPIN_TRACE_LDP1000, 1, 8);
+	TEST_CHECK_EQUAL(2, ldpin_tracefile_encode(&enc, &rec, buf));
+	rec = make_record(LDPIN_TRACE_RESULT, LDPIN_TRACE_LDP1000, 1, 0x64);
+	TEST_CHECK_EQUAL(1, ldpin_tracefile_encode(&enc, &rec, buf));
+
+	// from the host
+	rec = make_record(LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 2, 0);
+	TEST_CHECK_EQUAL(2, ldpin_tracefile_encode(&enc, &rec, buf));
+}
+
+TEST_CASE(trace_file_sizes)
+{
+	test_trace_file_sizes();
+}
+
+void test_trace_file_bad_input()
+{
+	LDPInTraceCodec_t codec;
+	uint8_t buf[LDPIN_TRACEFILE_HEADER_SIZE + LDPIN_TRACEFILE_MAX_ENCODED];
+	LDPInTraceRecord_t rec = make_record(LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_VP932, 0, 54321);
+
+	ldpin_tracefile_init(&codec, LDPIN_TRACE_VP932, 0);
+	ldpin_tracefile_write_header(&codec, buf);
+	uint8_t u8Len = ldpin_tracefile_encode(&codec, &rec, buf + LDPIN_TRACEFILE_HEADER_SIZE);
+
+	// short, wrong magic, wrong version
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_read_header(&codec, buf, LDPIN_TRACEFILE_HEADER_SIZE - 1));
+	buf[0] = 'X';
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_read_header(&codec, buf, sizeof(buf)));
+	buf[0] = 'L';
+	buf[4] = LDPIN_TRACEFILE_VERSION + 1;
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_read_header(&codec, buf, sizeof(buf)));
+	buf[4] = LDPIN_TRACEFILE_VERSION;
+	TEST_REQUIRE(ldpin_tracefile_read_header(&codec, buf, sizeof(buf)) != 0);
+
+	// an incomplete record can be decoded again once the rest of it is there
+	const uint8_t *p8 = buf + LDPIN_TRACEFILE_HEADER_SIZE;
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_decode(&codec, p8, p8 + u8Len - 1, &rec));
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_decode(&codec, p8, p8, &rec));
+	TEST_CHECK_EQUAL(u8Len, ldpin_tracefile_decode(&codec, p8, p8 + u8Len, &rec));
+	TEST_CHECK_EQUAL(54321, rec.u32Val);
+
+	// unknown kind
+	const uint8_t bad[] = { 0x0E };
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_decode(&codec, bad, bad + 1, &rec));
+
+	// varint longer than 5 bytes
+	const uint8_t longVarint[] = { 0xE1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+	TEST_CHECK_EQUAL(0, ldpin_tracefile_decode(&codec, longVarint, longVarint + sizeof(longVarint), &rec));
+}
+
+TEST_CASE(trace_file_bad_input)
+{
+	test_trace_file_bad_input();
+}
@@ -0,0 +1,193 @@
+#include "stdafx.h"
+#include <ldp-in/trace.h>
+
+// these only mean something in a LDP_IN_TRACE build (cmake -DLDP_IN_TRACE=ON)
+#ifdef LDP_IN_TRACE
+
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include "ctx_test_init.h"
+
+static PR7820Status_t g_traceTestPR7820Status = PR7820_PAUSED;
+static unsigned int g_uTraceTestSearchFrame = 0;
+
+static PR7820Status_t trace_test_get_status(void *pUser) { return g_traceTestPR7820Status; }
+static void trace_test_nop(void *pUser) { }
+static void trace_test_begin_search(void *pUser, unsigned int uFrameNumber) { g_uTraceTestSearchFrame = uFrameNumber; }
+static void trace_test_change_audio(void *pUser, unsigned char uChannel, unsigned char uEnable) { }
+static PR7820ErrCode_t g_traceTestPR7820Err = PR7820_ERR_UNKNOWN_CMD_BYTE;
+static void trace_test_on_error(void *pUser, PR7820ErrCode_t code, unsigned char u8Val) { g_traceTestPR7820Err = code; }
+
+static void check_record(const LDPInTraceRecord_t &rec, uint8_t u8Kind, uint8_t u8Interp, uint16_t u16VBlank, uint32_t u32Val)
+{
+	TEST_CHECK_EQUAL(u8Kind, rec.u8Kind);
+	TEST_CHECK_EQUAL(u8Interp, rec.u8Interp);
+	TEST_CHECK_EQUAL(u16VBlank, rec.u16VBlank);
+	TEST_CHECK_EQUAL(u32Val, rec.u32Val);
+}
+
+static void trace_test_init_pr7820(PR7820Ctx_t *pCtx)
+{
+	PR7820Callbacks_t cb = ctx_test_callbacks<PR7820Callbacks_t>();
+
+	cb.get_status = trace_test_get_status;
+	cb.play = trace_test_nop;
+	cb.pause = trace_test_nop;
+	cb.begin_search = trace_test_begin_search;
+	cb.change_audio = trace_test_change_audio;
+	cb.enable_super_mode = trace_test_nop;
+	cb.on_error = trace_test_on_error;
+	ctx_test_init(pCtx, cb);
+
+	// init empties the context's trace and then resets, so that is the first record
+	LDPInTraceRecord_t rec;
+	TEST_REQUIRE_EQUAL(1, ldpin_trace_read(&pCtx->trace, &rec, 1));
+	check_record(rec, LDPIN_TRACE_RESET, LDPIN_TRACE_PR7820, 0, 0);
+	TEST_CHECK_EQUAL(0, ldpin_trace_read(&pCtx->trace, &rec, 1));
+}
+
+void test_trace_pr7820()
+{
+	PR7820Ctx_t ctx;
+	LDPInTraceRecord_t recs[16];
+
+	trace_test_init_pr7820(&ctx);
+
+	pr7820i_ctx_write(&ctx, 0x0F);	// 1
+	ldpin_trace_vblank(&ctx.trace);
+	pr7820i_ctx_write(&ctx, 0xF7);	// search
+	g_traceTestPR7820Status = PR7820_SEARCHING;
+	PR7820_BOOL bBusy = pr7820i_ctx_is_busy(&ctx);
+	TEST_CHECK_EQUAL(PR7820_TRUE, bBusy);
+	TEST_CHECK_EQUAL(1, g_uTraceTestSearchFrame);
+
+	uint16_t u16Count = ldpin_trace_read(&ctx.trace, recs, 16);
+	TEST_REQUIRE_EQUAL(8, u16Count);
+	check_record(recs[0], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 0, 0x0F);
+	check_record(recs[1], LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 1, 0);
+	check_record(recs[2], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 1, 0xF7);
+	check_record(recs[3], LDPIN_TRACE_CALLBACK, LDPIN_TRACE_PR7820, 1, 3);	// begin_search
+	check_record(recs[4], LDPIN_TRACE_READ, LDPIN_TRACE_PR7820, 1, 0);
+	check_record(recs[5], LDPIN_TRACE_CALLBACK, LDPIN_TRACE_PR7820, 1, 0);	// get_status
+	check_record(recs[6], LDPIN_TRACE_RESULT, LDPIN_TRACE_PR7820, 1, PR7820_SEARCHING);
+	check_record(recs[7], LDPIN_TRACE_OUTPUT, LDPIN_TRACE_PR7820, 1, PR7820_TRUE);
+
+	// drained
+	TEST_CHECK_EQUAL(0, ldpin_trace_read(&ctx.trace, recs, 16));
+	TEST_CHECK_EQUAL(0, ldpin_trace_overflows(&ctx.trace));
+
+	g_traceTestPR7820Status = PR7820_PAUSED;
+}
+
+TEST_CASE(trace_pr7820)
+{
+	test_trace_pr7820();
+}
+
+void test_trace_vp931_vsync()
+{
+	VP931Ctx_t ctx;
+	VP931Callbacks_t cb = { 0 };	// none of them get called
+	LDPInTraceRecord_t recs[8];
+	const uint8_t cmds[] = { 0x00, 0x05, 0x34, 0xFF };	// play (while already playing) and a partial command
+
+	vp931i_ctx_init(&ctx, &cb, 0);
+
+	vp931i_ctx_on_vsync(&ctx, cmds, sizeof(cmds), VP931_PLAYING);
+
+	uint16_t u16Count = ldpin_trace_read(&ctx.trace, recs, 8);
+	TEST_REQUIRE_EQUAL(2, u16Count);
+	check_record(recs[0], LDPIN_TRACE_VBLANK, LDPIN_TRACE_VP931, 1, VP931_PLAYING);
+	check_record(recs[1], LDPIN_TRACE_VSYNC_CMD, LDPIN_TRACE_VP931, 1, 0x340500);
+}
+
+void test_trace_error()
+{
+	PR7820Ctx_t ctx;
+	LDPInTraceRecord_t recs[4];
+
+	trace_test_init_pr7820(&ctx);
+
+	pr7820i_ctx_write(&ctx, 0xF3);	// auto stop (unsupported)
+	TEST_CHECK_EQUAL(PR7820_ERR_UNSUPPORTED_CMD_BYTE, g_traceTestPR7820Err);
+
+	TEST_REQUIRE_EQUAL(3, ldpin_trace_read(&ctx.trace, recs, 4));
+	check_record(recs[0], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 0, 0xF3);
+	check_record(recs[1], LDPIN_TRACE_ERROR, LDPIN_TRACE_PR7820, 0, PR7820_ERR_UNSUPPORTED_CMD_BYTE | (0xF3 << 8));
+	check_record(recs[2], LDPIN_TRACE_CALLBACK, LDPIN_TRACE_PR7820, 0, 6);	// on_error
+}
+
+TEST_CASE(trace_error)
+{
+	test_trace_error();
+}
+
+TEST_CASE(trace_vp931_vsync)
+{
+	test_trace_vp931_vsync();
+}
+
+void test_trace_overflow()
+{
+	LDPInTrace_t trace;
+	LDPInTraceRecord_t rec;
+
+	ldpin_trace_reset(&trace);
+
+	for (uint32_t u = 0; u < LDP_IN_TRACE_SIZE + 3; u++)
+	{
+		ldpin_trace_push(&trace, LDPIN_TRACE_SET_FRAME, LDPIN_TRACE_HOST, u);
+	}
+
+	TEST_CHECK_EQUAL(3, ldpin_trace_overflows(&trace));
+
+	// the oldest records are kept
+	for (uint32_t u = 0; u < LDP_IN_TRACE_SIZE; u++)
+	{
+		TEST_REQUIRE_EQUAL(1, ldpin_trace_read(&trace, &rec, 1));
+		TEST_REQUIRE_EQUAL(u, rec.u32Val);
+	}
+	TEST_CHECK_EQUAL(0, ldpin_trace_read(&trace, &rec, 1));
+
+	ldpin_trace_reset(&trace);
+	TEST_CHECK_EQUAL(0, ldpin_trace_overflows(&trace));
+}
+
+TEST_CASE(trace_overflow)
+{
+	test_trace_overflow();
+}
+
+void test_trace_contexts_apart()
+{
+	PR7820Ctx_t ctx1, ctx2;
+	LDPInTraceRecord_t recs[4];
+
+	trace_test_init_pr7820(&ctx1);
+	trace_test_init_pr7820(&ctx2);
+
+	// each context records only its own calls, against its own vblank count
+	ldpin_trace_vblank(&ctx1.trace);
+	pr7820i_ctx_write(&ctx1, 0x0F);	// 1
+	pr7820i_ctx_write(&ctx2, 0x8F);	// 2
+
+	TEST_REQUIRE_EQUAL(2, ldpin_trace_read(&ctx1.trace, recs, 4));
+	check_record(recs[0], LDPIN_TRACE_VBLANK, LDPIN_TRACE_HOST, 1, 0);
+	check_record(recs[1], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 1, 0x0F);
+	TEST_REQUIRE_EQUAL(1, ldpin_trace_read(&ctx2.trace, recs, 4));
+	check_record(recs[0], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 0, 0x8F);
+
+	// and a reset leaves what is already there
+	pr7820i_ctx_write(&ctx1, 0x4F);	// 3
+	pr7820i_ctx_reset(&ctx1);
+	TEST_REQUIRE_EQUAL(2, ldpin_trace_read(&ctx1.trace, recs, 4));
+	check_record(recs[0], LDPIN_TRACE_WRITE, LDPIN_TRACE_PR7820, 1, 0x4F);
+	check_record(recs[1], LDPIN_TRACE_RESET, LDPIN_TRACE_PR7820, 1, 0);
+}
+
+TEST_CASE(trace_contexts_apart)
+{
+	test_trace_contexts_apart();
+}
+
+#endif // LDP_IN_TRACE
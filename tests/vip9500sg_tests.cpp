@@ -357,6 +357,34 @@ TEST_CASE(vip9500sg_get_cur_frame_playing)
 	test_vip9500sg_get_cur_frame_playing();
 }
 
+void test_vip9500sg_get_cur_frame_cached()
+{
+	MockVIP9500SGTest mockVIP9500SG;
+
+	vip9500sg_test_wrapper::setup(&mockVIP9500SG);
+
+	// the frame number supplied at vblank is used instead
+	EXPECT_CALL(mockVIP9500SG, GetCurFrame()).Times(0);
+	EXPECT_CALL(mockVIP9500SG, GetStatus()).WillRepeatedly(Return(VIP9500SG_PLAYING));
+	EXPECT_CALL(mockVIP9500SG, GetVBILine18()).WillRepeatedly(Return(0xF92345));
+
+	vip9500sgi_reset();
+	vip9500sgi_write(0x6B);	// get current frame
+
+	vip9500sgi_set_cur_frame_num(12345);
+	vip9500sgi_think_after_vblank();
+
+	TEST_REQUIRE(vip9500sgi_can_read() != 0);
+	TEST_CHECK_EQUAL(0x6B, vip9500sgi_read());
+	TEST_CHECK_EQUAL(0x30, vip9500sgi_read());	// 12345 is 0x3039
+	TEST_CHECK_EQUAL(0x39, vip9500sgi_read());
+}
+
+TEST_CASE(vip9500sg_get_cur_frame_cached)
+{
+	test_vip9500sg_get_cur_frame_cached();
+}
+
 void test_vip9500sg_get_cur_frame_stopped()
 {
 	MockVIP9500SGTest mockVIP9500SG;
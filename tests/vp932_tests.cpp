@@ -512,3 +512,58 @@ TEST_CASE(vp932_display)
 {
 	test_vp932_display();
 }
+
+void test_vp932_bulk_read_write()
+{
+	MockVP932Test mockVP932;
+
+	vp932_test_wrapper::setup(&mockVP932);
+
+	EXPECT_CALL(mockVP932, BeginSearch(12345));	// repeated searches to the same frame are only acknowledged
+
+	vp932i_reset();
+
+	const char *s = "F12345R\r";
+	uint8_t buf[8];
+	uint8_t u8Count = 0;
+
+	// nothing is queued yet
+	TEST_CHECK_EQUAL(0, vp932i_read_n(buf, sizeof(buf)));
+	vp932i_tx_peek(&u8Count);
+	TEST_CHECK_EQUAL(0, u8Count);
+
+	vp932i_write_n((const uint8_t *) s, (uint16_t) strlen(s));
+	vp932i_think_during_vblank(VP932_SEARCHING);
+	vp932i_think_during_vblank(VP932_PAUSED);
+
+	// cap is honored
+	TEST_REQUIRE_EQUAL(2, vp932i_read_n(buf, 2));
+	TEST_CHECK_EQUAL('A', buf[0]);
+	TEST_CHECK_EQUAL('0', buf[1]);
+	TEST_REQUIRE_EQUAL(1, vp932i_read_n(buf, sizeof(buf)));
+	TEST_CHECK_EQUAL('\r', buf[0]);
+
+	// queue up enough responses that the transmit queue wraps around, then drain it with peek/commit
+	for (int i = 0; i < 3; i++)
+	{
+		vp932i_write_n((const uint8_t *) s, (uint16_t) strlen(s));
+		vp932i_think_during_vblank(VP932_PAUSED);
+	}
+
+	std::string strSent;
+	const uint8_t *p8 = vp932i_tx_peek(&u8Count);
+	while (u8Count != 0)
+	{
+		strSent.append((const char *) p8, u8Count);
+		vp932i_tx_commit(u8Count);
+		p8 = vp932i_tx_peek(&u8Count);
+	}
+
+	TEST_CHECK_EQUAL(std::string("A0\rA0\rA0\r"), strSent);
+	TEST_CHECK_EQUAL(VP932_FALSE, vp932i_can_read());
+}
+
+TEST_CASE(vp932_bulk_read_write)
+{
+	test_vp932_bulk_read_write();
+}
@@ -0,0 +1,423 @@
+// Command-mix statistics for a corpus of trace files (see trace-file.h): which commands each game sends and how often, how far apart
+//  they come, which callbacks they lead to, and which errors the interpreters report.
+// Traces are grouped by game, taken to be the name of the directory each trace is in.
+// Files are spread over all cores; each thread keeps its own statistics, which are merged once every file has been read.
+
+#include "trace_list.h"
+#include "trace_map.h"
+#include "trace_names.h"
+#include <ldp-in/trace-file.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERP_COUNT 8	// LDPIN_TRACE_LDV1000 to LDPIN_TRACE_LD700
+#define CMD_KEYS 512	// see cmd_key
+#define MAX_CALLBACKS 32
+#define GAP_BUCKETS 18	// 0, 1, 2-3, 4-7, ... 32768-65535, 65536 and up
+
+struct InterpStats
+{
+	uint64_t u64Files;
+	uint64_t u64Bytes;
+	uint64_t u64Records;
+	uint64_t u64VBlanks;
+	uint64_t au64Cmds[CMD_KEYS];
+	uint64_t au64CmdRepeatGaps[CMD_KEYS];	// sum of the vblanks between each command and the previous one with the same key
+	uint64_t au64CmdRepeats[CMD_KEYS];	// how many gaps are in that sum
+	uint64_t au64Gaps[GAP_BUCKETS];	// vblanks between one command and the next (of any kind)
+	uint64_t au64Callbacks[MAX_CALLBACKS];
+	std::map<uint32_t, uint64_t> errors;	// by ERROR record value (code and argument)
+
+	InterpStats() { Clear(); }
+
+	void Clear()
+	{
+		u64Files = u64Bytes = u64Records = u64VBlanks = 0;
+		memset(au64Cmds, 0, sizeof(au64Cmds));
+		memset(au64CmdRepeatGaps, 0, sizeof(au64CmdRepeatGaps));
+		memset(au64CmdRepeats, 0, sizeof(au64CmdRepeats));
+		memset(au64Gaps, 0, sizeof(au64Gaps));
+		memset(au64Callbacks, 0, sizeof(au64Callbacks));
+		errors.clear();
+	}
+
+	void Merge(const InterpStats &other)
+	{
+		u64Files += other.u64Files;
+		u64Bytes += other.u64Bytes;
+		u64Records += other.u64Records;
+		u64VBlanks += other.u64VBlanks;
+		for (int i = 0; i < CMD_KEYS; i++)
+		{
+			au64Cmds[i] += other.au64Cmds[i];
+			au64CmdRepeatGaps[i] += other.au64CmdRepeatGaps[i];
+			au64CmdRepeats[i] += other.au64CmdRepeats[i];
+		}
+		for (int i = 0; i < GAP_BUCKETS; i++)
+		{
+			au64Gaps[i] += other.au64Gaps[i];
+		}
+		for (int i = 0; i < MAX_CALLBACKS; i++)
+		{
+			au64Callbacks[i] += other.au64Callbacks[i];
+		}
+		for (const auto &e : other.errors)
+		{
+			errors[e.first] += e.second;
+		}
+	}
+};
+
+struct GameStats
+{
+	InterpStats interps[INTERP_COUNT];
+	uint64_t u64BadFiles = 0;	// not traces, or cut short (what could be read is still counted)
+
+	void Merge(const GameStats &other)
+	{
+		for (int i = 0; i < INTERP_COUNT; i++)
+		{
+			interps[i].Merge(other.interps[i]);
+		}
+		u64BadFiles += other.u64BadFiles;
+	}
+};
+
+typedef std::map<std::string, GameStats> CorpusStats;
+
+/////////////////////////////////////////////////////////////////
+
+// Reduces a command to what identifies it:
+//  the byte for most players, the 5 command bits of a PR-8210 message, and for the VP-931, the command's high nibble
+//  (0x00-0xF0 for 00 xx commands, 0x100 and up for the others, whose low nibbles and other bytes are arguments)
+static uint32_t cmd_key(uint8_t u8Interp, uint32_t u32Val)
+{
+	switch (u8Interp)
+	{
+	case LDPIN_TRACE_PR8210:
+		return (u32Val >> 3) & 0xFF;
+	case LDPIN_TRACE_VP931:
+		return ((u32Val & 0xFF) == 0) ? ((u32Val >> 8) & 0xF0) : (0x100 | (u32Val & 0xF0));
+	default:
+		return u32Val & 0xFF;
+	}
+}
+
+static void format_cmd_key(uint8_t u8Interp, uint32_t u32Key, char *pszDst, size_t uLen)
+{
+	if (u8Interp == LDPIN_TRACE_VP931)
+	{
+		if (u32Key & 0x100)
+		{
+			snprintf(pszDst, uLen, "%Xx xx xx", (u32Key >> 4) & 0x0F);
+		}
+		else
+		{
+			snprintf(pszDst, uLen, "00 %Xx xx", u32Key >> 4);
+		}
+	}
+	else
+	{
+		snprintf(pszDst, uLen, "%02X", u32Key);
+	}
+}
+
+static uint8_t gap_bucket(uint64_t u64Gap)
+{
+	uint8_t u8Bucket = 0;
+
+	while ((u64Gap != 0) && (u8Bucket < GAP_BUCKETS - 1))
+	{
+		u64Gap >>= 1;
+		u8Bucket++;
+	}
+
+	return u8Bucket;
+}
+
+static void analyze_file(const TraceFile &file, GameStats *pGame)
+{
+	TraceMap map;
+	LDPInTraceCodec_t codec;
+	LDPInTraceRecord_t rec;
+
+	if (!trace_map_open(file.strPath.c_str(), &map))
+	{
+		pGame->u64BadFiles++;
+		return;
+	}
+
+	if (!ldpin_tracefile_read_header(&codec, map.p8Data, (uint32_t) std::min<size_t>(map.uLen, 0xFFFFFFFF)) || (codec.u8Interp >= INTERP_COUNT))
+	{
+		fprintf(stderr, "%s: not a trace file\n", file.strPath.c_str());
+		pGame->u64BadFiles++;
+		trace_map_close(&map);
+		return;
+	}
+
+	uint8_t u8Interp = codec.u8Interp;
+	InterpStats &st = pGame->interps[u8Interp];
+	const uint8_t *p8 = map.p8Data + LDPIN_TRACEFILE_HEADER_SIZE;
+	const uint8_t *p8End = map.p8Data + map.uLen;
+	uint16_t u16LastVBlank = codec.u16VBlank;
+	uint64_t u64VBlank = 0;	// vblanks since the start of the trace (the records' count wraps)
+	uint64_t u64LastCmd = ~(uint64_t) 0;
+	std::vector<uint64_t> lastByKey(CMD_KEYS, ~(uint64_t) 0);
+
+	while (p8 < p8End)
+	{
+		uint8_t u8Len = ldpin_tracefile_decode(&codec, p8, p8End, &rec);
+		if (u8Len == 0)
+		{
+			fprintf(stderr, "%s: corrupt or incomplete record at byte %zu\n", file.strPath.c_str(), (size_t) (p8 - map.p8Data));
+			pGame->u64BadFiles++;
+			break;
+		}
+		p8 += u8Len;
+		st.u64Records++;
+
+		u64VBlank += (uint16_t) (rec.u16VBlank - u16LastVBlank);
+		u16LastVBlank = rec.u16VBlank;
+
+		switch (rec.u8Kind)
+		{
+		case LDPIN_TRACE_WRITE:
+		case LDPIN_TRACE_VSYNC_CMD:
+			{
+				uint32_t u32Key = cmd_key(u8Interp, rec.u32Val);
+				st.au64Cmds[u32Key]++;
+
+				if (u64LastCmd != ~(uint64_t) 0)
+				{
+					st.au64Gaps[gap_bucket(u64VBlank - u64LastCmd)]++;
+				}
+				u64LastCmd = u64VBlank;
+
+				if (lastByKey[u32Key] != ~(uint64_t) 0)
+				{
+					st.au64CmdRepeatGaps[u32Key] += u64VBlank - lastByKey[u32Key];
+					st.au64CmdRepeats[u32Key]++;
+				}
+				lastByKey[u32Key] = u64VBlank;
+			}
+			break;
+		case LDPIN_TRACE_CALLBACK:
+			if (rec.u32Val < MAX_CALLBACKS)
+			{
+				st.au64Callbacks[rec.u32Val]++;
+			}
+			break;
+		case LDPIN_TRACE_ERROR:
+			st.errors[rec.u32Val]++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	st.u64Files++;
+	st.u64Bytes += map.uLen;
+	st.u64VBlanks += u64VBlank;
+
+	trace_map_close(&map);
+}
+
+static void worker(const std::vector<TraceFile> *pFiles, std::atomic<size_t> *pNext, CorpusStats *pStats)
+{
+	for (;;)
+	{
+		size_t uIdx = pNext->fetch_add(1, std::memory_order_relaxed);
+		if (uIdx >= pFiles->size())
+		{
+			break;
+		}
+
+		const TraceFile &file = (*pFiles)[uIdx];
+		analyze_file(file, &(*pStats)[file.strGame]);
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+
+static double percent(uint64_t u64Part, uint64_t u64Whole)
+{
+	return (u64Whole != 0) ? (100.0 * u64Part) / u64Whole : 0;
+}
+
+static void print_interp(const std::string &strGame, uint8_t u8Interp, const InterpStats &st, uint32_t u32Top)
+{
+	double dMinutes = st.u64VBlanks / (59.94 * 60);	// NTSC field rate
+	uint64_t u64Cmds = 0;
+	std::vector<uint32_t> keys;
+
+	printf("== %s: %s, %llu files, %.1f MB, %llu records, %llu vblanks (%.1f hours)\n", strGame.c_str(), trace_interp_name(u8Interp),
+		(unsigned long long) st.u64Files, st.u64Bytes / 1e6, (unsigned long long) st.u64Records, (unsigned long long) st.u64VBlanks,
+		dMinutes / 60);
+
+	for (uint32_t u = 0; u < CMD_KEYS; u++)
+	{
+		u64Cmds += st.au64Cmds[u];
+		if (st.au64Cmds[u] != 0)
+		{
+			keys.push_back(u);
+		}
+	}
+	std::sort(keys.begin(), keys.end(), [&](uint32_t a, uint32_t b) { return st.au64Cmds[a] > st.au64Cmds[b]; });
+
+	printf("commands: %llu (%.1f per minute)\n", (unsigned long long) u64Cmds, (dMinutes > 0) ? u64Cmds / dMinutes : 0);
+	printf("  %-10s %14s %7s %12s %14s\n", "command", "count", "%", "per minute", "repeats every");
+	for (size_t i = 0; (i < keys.size()) && (i < u32Top); i++)
+	{
+		uint32_t u32Key = keys[i];
+		char szKey[16];
+		char szRepeat[32] = "-";
+
+		format_cmd_key(u8Interp, u32Key, szKey, sizeof(szKey));
+		if (st.au64CmdRepeats[u32Key] != 0)
+		{
+			snprintf(szRepeat, sizeof(szRepeat), "%.1f vblanks", (double) st.au64CmdRepeatGaps[u32Key] / st.au64CmdRepeats[u32Key]);
+		}
+		printf("  %-10s %14llu %6.2f%% %12.1f %14s\n", szKey, (unsigned long long) st.au64Cmds[u32Key], percent(st.au64Cmds[u32Key], u64Cmds),
+			(dMinutes > 0) ? st.au64Cmds[u32Key] / dMinutes : 0, szRepeat);
+	}
+	if (keys.size() > u32Top)
+	{
+		printf("  (%zu more)\n", keys.size() - u32Top);
+	}
+
+	printf("vblanks between commands:\n");
+	uint64_t u64Gaps = 0;
+	for (int i = 0; i < GAP_BUCKETS; i++)
+	{
+		u64Gaps += st.au64Gaps[i];
+	}
+	for (int i = 0; i < GAP_BUCKETS; i++)
+	{
+		char szRange[32];
+
+		if (st.au64Gaps[i] == 0)
+		{
+			continue;
+		}
+
+		if (i == 0) snprintf(szRange, sizeof(szRange), "0");
+		else if (i == 1) snprintf(szRange, sizeof(szRange), "1");
+		else if (i == GAP_BUCKETS - 1) snprintf(szRange, sizeof(szRange), "%llu+", 1ULL << (i - 1));
+		else snprintf(szRange, sizeof(szRange), "%llu-%llu", 1ULL << (i - 1), (1ULL << i) - 1);
+
+		printf("  %-12s %14llu %6.2f%%\n", szRange, (unsigned long long) st.au64Gaps[i], percent(st.au64Gaps[i], u64Gaps));
+	}
+
+	printf("callbacks:\n");
+	for (uint32_t u = 0; u < MAX_CALLBACKS; u++)
+	{
+		if (st.au64Callbacks[u] != 0)
+		{
+			const char *pszName = trace_callback_name(u8Interp, u);
+			printf("  %-32s %14llu %12.1f per minute\n", pszName ? pszName : "?", (unsigned long long) st.au64Callbacks[u],
+				(dMinutes > 0) ? st.au64Callbacks[u] / dMinutes : 0);
+		}
+	}
+
+	if (!st.errors.empty())
+	{
+		printf("errors:\n");
+		for (const auto &e : st.errors)
+		{
+			const char *pszName = trace_error_name(u8Interp, (uint8_t) e.first);
+			printf("  %-24s 0x%04X %14llu\n", pszName ? pszName : "?", e.first >> 8, (unsigned long long) e.second);
+		}
+	}
+
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t u32Threads = std::thread::hardware_concurrency();
+	uint32_t u32Top = 20;
+	std::vector<TraceFile> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+		{
+			u32Threads = (uint32_t) atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--top") == 0) && (i + 1 < argc))
+		{
+			u32Top = (uint32_t) atoi(argv[++i]);
+		}
+		else if (argv[i][0] == '-')
+		{
+			printf("usage: %s [--threads <n>] [--top <n>] <trace file or directory>...\n", argv[0]);
+			return 2;
+		}
+		else
+		{
+			trace_list_add(argv[i], &files);
+		}
+	}
+
+	if (files.empty())
+	{
+		printf("usage: %s [--threads <n>] [--top <n>] <trace file or directory>...\n", argv[0]);
+		return 2;
+	}
+
+	trace_list_sort(&files);
+
+	u32Threads = std::max<uint32_t>(1, std::min<uint32_t>(u32Threads, (uint32_t) files.size()));
+
+	std::vector<CorpusStats> threadStats(u32Threads);
+	std::vector<std::thread> threads;
+	std::atomic<size_t> next(0);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint32_t u = 0; u < u32Threads; u++)
+	{
+		threads.emplace_back(worker, &files, &next, &threadStats[u]);
+	}
+
+	CorpusStats stats;
+	uint64_t u64Bytes = 0;
+	for (uint32_t u = 0; u < u32Threads; u++)
+	{
+		threads[u].join();
+		for (const auto &game : threadStats[u])
+		{
+			stats[game.first].Merge(game.second);
+		}
+	}
+
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (const auto &game : stats)
+	{
+		for (uint8_t u8Interp = 0; u8Interp < INTERP_COUNT; u8Interp++)
+		{
+			if (game.second.interps[u8Interp].u64Files != 0)
+			{
+				print_interp(game.first, u8Interp, game.second.interps[u8Interp], u32Top);
+				u64Bytes += game.second.interps[u8Interp].u64Bytes;
+			}
+		}
+		if (game.second.u64BadFiles != 0)
+		{
+			printf("== %s: %llu files could not be read completely\n\n", game.first.c_str(), (unsigned long long) game.second.u64BadFiles);
+		}
+	}
+
+	fprintf(stderr, "%zu files, %.1f MB in %.2f s (%.1f MB/s, %u threads)\n", files.size(), u64Bytes / 1e6, dSeconds,
+		(dSeconds > 0) ? (u64Bytes / 1e6) / dSeconds : 0, u32Threads);
+
+	return 0;
+}
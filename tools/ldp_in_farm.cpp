@@ -0,0 +1,296 @@
+// Replays a corpus of trace files (see trace-file.h) through two builds of the library, to see what a change to an interpreter does
+//  to real sessions before it ships.
+// Each build is a replay module (see replay_module.h) built from its own tree; every trace goes through both, one after the other on
+//  the same worker thread, and the traces are spread over all cores.
+// Both builds are fed the same recorded inputs and answered with the same recorded results, so for each trace, the first place
+//  where either build stops matching the recording is the first place where the two builds can differ.
+
+#include "replay_module.h"
+#include "trace_list.h"
+#include "trace_map.h"
+#include "trace_names.h"
+#include <ldp-in/trace-file.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ReplayModule
+{
+	const char *pszPath;
+	void *pHandle;
+	ReplayModuleRunFunc run;
+	const char *pszDescription;
+};
+
+enum Verdict
+{
+	VERDICT_MATCH,	// both builds match the whole trace
+	VERDICT_SAME,	// both builds leave the trace at the same record, in the same way (it was recorded with some other build)
+	VERDICT_DIVERGED,	// the builds differ
+	VERDICT_UNREADABLE,	// not a trace file
+	VERDICT_COUNT
+};
+
+struct FarmResult
+{
+	ReplayResult old;
+	ReplayResult cur;
+	double dOldSeconds;
+	double dNewSeconds;
+	Verdict verdict;
+};
+
+static bool load_module(const char *pszPath, ReplayModule *pModule)
+{
+	// RTLD_LOCAL keeps each build's symbols to itself, so the two copies of every interpreter function don't replace each other
+	void *pHandle = dlopen(pszPath, RTLD_NOW | RTLD_LOCAL);
+	if (!pHandle)
+	{
+		fprintf(stderr, "%s\n", dlerror());
+		return false;
+	}
+
+	ReplayModuleAbiFunc abi = (ReplayModuleAbiFunc) dlsym(pHandle, REPLAY_MODULE_ABI_SYMBOL);
+	ReplayModuleRunFunc run = (ReplayModuleRunFunc) dlsym(pHandle, REPLAY_MODULE_RUN_SYMBOL);
+	ReplayModuleDescribeFunc describe = (ReplayModuleDescribeFunc) dlsym(pHandle, REPLAY_MODULE_DESCRIBE_SYMBOL);
+
+	if (!abi || !run || !describe)
+	{
+		fprintf(stderr, "%s: not a replay module\n", pszPath);
+		dlclose(pHandle);
+		return false;
+	}
+
+	if (abi() != REPLAY_MODULE_ABI)
+	{
+		fprintf(stderr, "%s: replay module version %d, this tool needs %d (rebuild it)\n", pszPath, abi(), REPLAY_MODULE_ABI);
+		dlclose(pHandle);
+		return false;
+	}
+
+	pModule->pszPath = pszPath;
+	pModule->pHandle = pHandle;
+	pModule->run = run;
+	pModule->pszDescription = describe();
+	return true;
+}
+
+static bool same_outcome(const ReplayResult &a, const ReplayResult &b)
+{
+	return (a.bOk == b.bOk) && (a.uOffset == b.uOffset) && (strcmp(a.szError, b.szError) == 0);
+}
+
+static void farm_file(const ReplayModule &oldBuild, const ReplayModule &newBuild, const TraceFile &file, FarmResult *pResult)
+{
+	TraceMap map;
+
+	if (!trace_map_open(file.strPath.c_str(), &map))
+	{
+		pResult->verdict = VERDICT_UNREADABLE;
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	oldBuild.run(map.p8Data, map.uLen, &pResult->old);
+	std::chrono::steady_clock::time_point mid = std::chrono::steady_clock::now();
+	newBuild.run(map.p8Data, map.uLen, &pResult->cur);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+	pResult->dOldSeconds = std::chrono::duration<double>(mid - start).count();
+	pResult->dNewSeconds = std::chrono::duration<double>(end - mid).count();
+
+	if (pResult->old.u8Interp == 0xFF)
+	{
+		pResult->verdict = VERDICT_UNREADABLE;
+	}
+	else if (!same_outcome(pResult->old, pResult->cur))
+	{
+		pResult->verdict = VERDICT_DIVERGED;
+	}
+	else
+	{
+		pResult->verdict = pResult->old.bOk ? VERDICT_MATCH : VERDICT_SAME;
+	}
+
+	trace_map_close(&map);
+}
+
+static void worker(const ReplayModule *pOld, const ReplayModule *pNew, const std::vector<TraceFile> *pFiles, std::atomic<size_t> *pNext,
+	std::vector<FarmResult> *pResults)
+{
+	for (;;)
+	{
+		size_t uIdx = pNext->fetch_add(1, std::memory_order_relaxed);
+		if (uIdx >= pFiles->size())
+		{
+			break;
+		}
+
+		// each worker writes only its own files' results, so nothing needs a lock
+		farm_file(*pOld, *pNew, (*pFiles)[uIdx], &(*pResults)[uIdx]);
+	}
+}
+
+// what a build did at the first record where the builds differ
+static const char *describe_at(const ReplayResult &result, size_t uOffset)
+{
+	if (!result.bOk && (result.uOffset == uOffset))
+	{
+		return result.szError;
+	}
+	return "matches the trace here";
+}
+
+static void print_divergence(const TraceFile &file, const FarmResult &result)
+{
+	// the earlier of the two differences from the trace (a build that matched the whole trace has none)
+	const ReplayResult *pFirst = &result.old;
+
+	if (result.old.bOk || (!result.cur.bOk && (result.cur.uOffset < result.old.uOffset)))
+	{
+		pFirst = &result.cur;
+	}
+
+	printf("%s: %s, builds diverge at byte %zu (record %llu, vblank %llu)\n", file.strPath.c_str(), trace_interp_name(pFirst->u8Interp),
+		pFirst->uOffset, (unsigned long long) pFirst->u64Records, (unsigned long long) pFirst->u64VBlanks);
+	printf("  old: %s\n", describe_at(result.old, pFirst->uOffset));
+	printf("  new: %s\n", describe_at(result.cur, pFirst->uOffset));
+}
+
+int main(int argc, char **argv)
+{
+	const char *pszOld = 0;
+	const char *pszNew = 0;
+	uint32_t u32Threads = std::thread::hardware_concurrency();
+	bool bVerbose = false;
+	std::vector<TraceFile> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--old") == 0) && (i + 1 < argc))
+		{
+			pszOld = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--new") == 0) && (i + 1 < argc))
+		{
+			pszNew = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc))
+		{
+			u32Threads = (uint32_t) atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--verbose") == 0)
+		{
+			bVerbose = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			files.clear();
+			break;
+		}
+		else
+		{
+			trace_list_add(argv[i], &files);
+		}
+	}
+
+	if (!pszOld || !pszNew || files.empty())
+	{
+		printf("usage: %s --old <replay module> --new <replay module> [--threads <n>] [--verbose] <trace file or directory>...\n", argv[0]);
+		return 2;
+	}
+
+	ReplayModule oldBuild;
+	ReplayModule newBuild;
+
+	if (!load_module(pszOld, &oldBuild) || !load_module(pszNew, &newBuild))
+	{
+		return 2;
+	}
+
+	printf("old: %s (%s)\n", oldBuild.pszPath, oldBuild.pszDescription);
+	printf("new: %s (%s)\n", newBuild.pszPath, newBuild.pszDescription);
+
+	trace_list_sort(&files);
+	u32Threads = std::max<uint32_t>(1, std::min<uint32_t>(u32Threads, (uint32_t) files.size()));
+
+	std::vector<FarmResult> results(files.size());
+	std::vector<std::thread> threads;
+	std::atomic<size_t> next(0);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (uint32_t u = 0; u < u32Threads; u++)
+	{
+		threads.emplace_back(worker, &oldBuild, &newBuild, &files, &next, &results);
+	}
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// report in path order, whatever order the files were replayed in
+	std::vector<size_t> order(files.size());
+	for (size_t u = 0; u < order.size(); u++)
+	{
+		order[u] = u;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return files[a].strPath < files[b].strPath; });
+
+	uint64_t au64Verdicts[VERDICT_COUNT] = { 0 };
+	uint64_t u64Bytes = 0;
+	uint64_t u64VBlanks = 0;
+	double dOldSeconds = 0;
+	double dNewSeconds = 0;
+
+	for (size_t uIdx : order)
+	{
+		const TraceFile &file = files[uIdx];
+		const FarmResult &result = results[uIdx];
+
+		au64Verdicts[result.verdict]++;
+		if (result.verdict == VERDICT_UNREADABLE)
+		{
+			printf("%s: not a trace file\n", file.strPath.c_str());
+			continue;
+		}
+
+		u64Bytes += file.uSize;
+		u64VBlanks += std::max(result.old.u64VBlanks, result.cur.u64VBlanks);
+		dOldSeconds += result.dOldSeconds;
+		dNewSeconds += result.dNewSeconds;
+
+		if (result.verdict == VERDICT_DIVERGED)
+		{
+			print_divergence(file, result);
+		}
+		else if (bVerbose && (result.verdict == VERDICT_SAME))
+		{
+			printf("%s: %s, both builds differ from the trace at byte %zu (record %llu, vblank %llu): %s\n", file.strPath.c_str(),
+				trace_interp_name(result.old.u8Interp), result.old.uOffset, (unsigned long long) result.old.u64Records,
+				(unsigned long long) result.old.u64VBlanks, result.old.szError);
+		}
+		else if (bVerbose)
+		{
+			printf("%s: %s, both builds match\n", file.strPath.c_str(), trace_interp_name(result.old.u8Interp));
+		}
+	}
+
+	printf("%zu traces: %llu match, %llu differ from the trace the same way in both builds, %llu diverge, %llu unreadable\n", files.size(),
+		(unsigned long long) au64Verdicts[VERDICT_MATCH], (unsigned long long) au64Verdicts[VERDICT_SAME],
+		(unsigned long long) au64Verdicts[VERDICT_DIVERGED], (unsigned long long) au64Verdicts[VERDICT_UNREADABLE]);
+	printf("%.1f MB, %.1f hours of play in %.2f s on %u threads (%.1f MB/s, %.0fx real time); replay time old %.2f s, new %.2f s\n",
+		u64Bytes / 1e6, u64VBlanks / (59.94 * 3600), dSeconds, u32Threads, (dSeconds > 0) ? (u64Bytes / 1e6) / dSeconds : 0,
+		(dSeconds > 0) ? (u64VBlanks / 59.94) / dSeconds : 0, dOldSeconds, dNewSeconds);
+
+	// the modules stay loaded until exit; nothing is gained by unloading them first
+	return (au64Verdicts[VERDICT_DIVERGED] != 0) ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+// Compares the per-vblank state hashes (see state-hash.h) of two runs of the same game, such as the two sides of a netplay session,
+//  and reports the first vblank where they differ.  When both streams carry snapshots, it also says which fields differ and how.
+// Exits with 1 if the runs diverged.
+
+#include "trace_map.h"
+#include "trace_names.h"
+#include <ldp-in/state-hash.h>
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <map>
+#include <string>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// how this build lays out one interpreter's snapshots
+struct SnapshotLayout
+{
+	const LDPInStateField_t *pFields;
+	uint8_t u8FieldCount;
+	uint16_t u16SnapSize;
+	uint16_t u16StateOffset;
+};
+
+#define SNAPSHOT_LAYOUT(prefix, type) \
+	layout.pFields = prefix##_state_fields(&layout.u8FieldCount); \
+	layout.u16SnapSize = sizeof(type); \
+	layout.u16StateOffset = offsetof(type, state)
+
+static bool get_layout(uint8_t u8Interp, SnapshotLayout &layout)
+{
+	switch (u8Interp)
+	{
+	case LDPIN_TRACE_LDV1000: SNAPSHOT_LAYOUT(ldv1000i, LDV1000Snapshot_t); break;
+	case LDPIN_TRACE_LDP1000: SNAPSHOT_LAYOUT(ldp1000i, LDP1000Snapshot_t); break;
+	case LDPIN_TRACE_PR7820: SNAPSHOT_LAYOUT(pr7820i, PR7820Snapshot_t); break;
+	case LDPIN_TRACE_PR8210: SNAPSHOT_LAYOUT(pr8210i, PR8210Snapshot_t); break;
+	case LDPIN_TRACE_VIP9500SG: SNAPSHOT_LAYOUT(vip9500sgi, VIP9500SGSnapshot_t); break;
+	case LDPIN_TRACE_VP932: SNAPSHOT_LAYOUT(vp932i, VP932Snapshot_t); break;
+	case LDPIN_TRACE_LD700: SNAPSHOT_LAYOUT(ld700i, LD700Snapshot_t); break;
+	case LDPIN_TRACE_VP931:
+		layout.pFields = vp931i_state_fields(&layout.u8FieldCount);
+		layout.u16SnapSize = sizeof(VP931Snapshot_t);
+		layout.u16StateOffset = sizeof(VP931Snapshot_t);	// no state
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+struct HashStream
+{
+	const char *pszPath;
+	TraceMap map;
+	uint8_t u8Interp;
+	uint16_t u16SnapSize;
+	std::map<uint32_t, const uint8_t *> records;	// the last record for each vblank
+};
+
+static bool open_stream(const char *pszPath, HashStream &stream)
+{
+	stream.pszPath = pszPath;
+	if (!trace_map_open(pszPath, &stream.map))
+	{
+		return false;
+	}
+
+	if (!ldpin_hashstream_read_header(stream.map.p8Data, (uint32_t) stream.map.uLen, &stream.u8Interp, &stream.u16SnapSize))
+	{
+		printf("%s: not a hash stream (or a version this build can't read)\n", pszPath);
+		return false;
+	}
+
+	size_t uRecSize = LDPIN_HASHSTREAM_RECORD_SIZE + stream.u16SnapSize;
+	size_t uOffset = LDPIN_HASHSTREAM_HEADER_SIZE;
+	for (; uOffset + uRecSize <= stream.map.uLen; uOffset += uRecSize)
+	{
+		uint32_t u32VBlank;
+		uint64_t u64Hash;
+		ldpin_hashstream_read_record(stream.map.p8Data + uOffset, &u32VBlank, &u64Hash);
+		stream.records[u32VBlank] = stream.map.p8Data + uOffset;
+	}
+
+	if (uOffset != stream.map.uLen)
+	{
+		printf("%s: ignoring %zu bytes of an incomplete record at the end\n", pszPath, stream.map.uLen - uOffset);
+	}
+
+	return true;
+}
+
+static uint64_t record_hash(const uint8_t *p8Rec)
+{
+	uint32_t u32VBlank;
+	uint64_t u64Hash;
+	ldpin_hashstream_read_record(p8Rec, &u32VBlank, &u64Hash);
+	return u64Hash;
+}
+
+static void print_value(const LDPInStateField_t &field, const uint8_t *p8Val, uint16_t u16Len)
+{
+	if (field.u8Kind == LDPIN_FIELD_UINT)
+	{
+		printf("%u", (unsigned) (p8Val[0] | (p8Val[1] << 8) | (p8Val[2] << 16) | ((uint32_t) p8Val[3] << 24)));
+		return;
+	}
+
+	// rings, queues and partly used buffers start with the count
+	uint16_t u = 0;
+	if (field.u8Kind != LDPIN_FIELD_BYTES)
+	{
+		printf("(%u)", p8Val[0]);
+		u = 1;
+	}
+	for (; u < u16Len; u++)
+	{
+		printf(" %02X", p8Val[u]);
+	}
+}
+
+// the snapshot's state, or 0 (after saying why) if it can't be used to compare fields
+static const uint8_t *record_state(const HashStream &stream, const uint8_t *p8Rec, const SnapshotLayout &layout)
+{
+	const uint8_t *p8Snap = p8Rec + LDPIN_HASHSTREAM_RECORD_SIZE;
+	LDPInSnapshotHeader_t hdr;
+
+	if (stream.u16SnapSize == 0)
+	{
+		printf("%s has no snapshots; write them along with the hashes to see which fields differ\n", stream.pszPath);
+		return 0;
+	}
+
+	memcpy(&hdr, p8Snap, sizeof(hdr));
+	if ((stream.u16SnapSize != layout.u16SnapSize) || (hdr.u8Interp != stream.u8Interp) ||
+		(hdr.u16Size != layout.u16SnapSize - layout.u16StateOffset))
+	{
+		printf("%s: its snapshots were saved by a build with a different state layout, so the fields can't be compared\n", stream.pszPath);
+		return 0;
+	}
+
+	const uint8_t *p8State = p8Snap + layout.u16StateOffset;
+	if (ldpin_state_hash(p8State, layout.pFields, layout.u8FieldCount) != record_hash(p8Rec))
+	{
+		printf("%s: note: its hashes don't match its snapshots (hashed by a different build?)\n", stream.pszPath);
+	}
+
+	return p8State;
+}
+
+static void print_fields(const HashStream &a, const uint8_t *p8RecA, const HashStream &b, const uint8_t *p8RecB)
+{
+	SnapshotLayout layout;
+
+	if (!get_layout(a.u8Interp, layout))
+	{
+		printf("no field table for %s\n", trace_interp_name(a.u8Interp));
+		return;
+	}
+
+	const uint8_t *p8StateA = record_state(a, p8RecA, layout);
+	const uint8_t *p8StateB = record_state(b, p8RecB, layout);
+	if (!p8StateA || !p8StateB)
+	{
+		return;
+	}
+
+	// snapshots may be packed in the file, so work on aligned copies
+	std::string strA((const char *) p8StateA, layout.u16SnapSize - layout.u16StateOffset);
+	std::string strB((const char *) p8StateB, layout.u16SnapSize - layout.u16StateOffset);
+	uint32_t u32Differ = 0;
+
+	for (uint8_t u = 0; u < layout.u8FieldCount; u++)
+	{
+		const LDPInStateField_t &field = layout.pFields[u];
+		uint8_t au8ValA[LDPIN_STATE_FIELD_MAX_VALUE];
+		uint8_t au8ValB[LDPIN_STATE_FIELD_MAX_VALUE];
+		uint16_t u16LenA = ldpin_state_field_value(strA.data(), &field, au8ValA);
+		uint16_t u16LenB = ldpin_state_field_value(strB.data(), &field, au8ValB);
+
+		if ((u16LenA == u16LenB) && (memcmp(au8ValA, au8ValB, u16LenA) == 0))
+		{
+			continue;
+		}
+
+		printf("  %-28s ", field.pszName);
+		print_value(field, au8ValA, u16LenA);
+		printf("  vs  ");
+		print_value(field, au8ValB, u16LenB);
+		printf("\n");
+		u32Differ++;
+	}
+
+	if (u32Differ == 0)
+	{
+		printf("  the snapshots' fields are all the same\n");
+	}
+}
+
+int main(int argc, char **argv)
+{
+	HashStream a;
+	HashStream b;
+
+	if ((argc != 3) || (argv[1][0] == '-') || (argv[2][0] == '-'))
+	{
+		printf("usage: %s <hash stream> <hash stream>\n", argv[0]);
+		return 2;
+	}
+
+	if (!open_stream(argv[1], a) || !open_stream(argv[2], b))
+	{
+		return 2;
+	}
+
+	if (a.u8Interp != b.u8Interp)
+	{
+		printf("%s is for the %s and %s is for the %s\n", a.pszPath, trace_interp_name(a.u8Interp), b.pszPath, trace_interp_name(b.u8Interp));
+		return 2;
+	}
+
+	uint32_t u32Compared = 0;
+	uint32_t u32Diverged = 0;
+	uint32_t u32OnlyA = 0;
+	bool bHaveLastSame = false;
+	uint32_t u32LastSame = 0;
+	const uint8_t *p8FirstA = 0;
+	const uint8_t *p8FirstB = 0;
+	uint32_t u32FirstVBlank = 0;
+
+	for (const auto &rec : a.records)
+	{
+		auto itB = b.records.find(rec.first);
+		if (itB == b.records.end())
+		{
+			u32OnlyA++;
+			continue;
+		}
+
+		u32Compared++;
+		if (record_hash(rec.second) == record_hash(itB->second))
+		{
+			if (!p8FirstA)
+			{
+				bHaveLastSame = true;
+				u32LastSame = rec.first;
+			}
+			continue;
+		}
+
+		if (!p8FirstA)
+		{
+			p8FirstA = rec.second;
+			p8FirstB = itB->second;
+			u32FirstVBlank = rec.first;
+		}
+		u32Diverged++;
+	}
+
+	printf("%s: %u vblanks compared (%u only in %s, %u only in %s)\n", trace_interp_name(a.u8Interp), u32Compared,
+		u32OnlyA, a.pszPath, (uint32_t) b.records.size() - u32Compared, b.pszPath);
+
+	if (!p8FirstA)
+	{
+		printf("no divergence\n");
+		return 0;
+	}
+
+	printf("first divergence at vblank %u (hash %016llX vs %016llX)", u32FirstVBlank,
+		(unsigned long long) record_hash(p8FirstA), (unsigned long long) record_hash(p8FirstB));
+	if (bHaveLastSame)
+	{
+		printf(", last agreed at vblank %u", u32LastSame);
+	}
+	printf("; %u vblanks differ in all\n", u32Diverged);
+
+	print_fields(a, p8FirstA, b, p8FirstB);
+	return 1;
+}
@@ -0,0 +1,98 @@
+// Replays trace files (see trace-file.h) into the interpreters as fast as the CPU allows and checks that this build makes the same
+//  callbacks, in the same order, as the build that recorded them.  Exits with 1 on the first difference.
+
+#include "replay.h"
+#include "trace_names.h"
+#include "trace_map.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+	uint32_t u32Repeats = 1;
+	bool bQuiet = false;
+	int iFailed = 0;
+	int iFiles = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--repeat") == 0) && (i + 1 < argc))
+		{
+			u32Repeats = (uint32_t) atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--quiet") == 0)
+		{
+			bQuiet = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			printf("usage: %s [--repeat <n>] [--quiet] <trace file>...\n", argv[0]);
+			return 2;
+		}
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		TraceMap map;
+		ReplayResult result;
+		double dSeconds = 0;
+
+		if (strcmp(argv[i], "--repeat") == 0)
+		{
+			i++;
+			continue;
+		}
+		if (argv[i][0] == '-')
+		{
+			continue;
+		}
+
+		iFiles++;
+
+		if (!trace_map_open(argv[i], &map))
+		{
+			iFailed++;
+			continue;
+		}
+
+		// repeats are for timing; a trace that replays once replays every time
+		for (uint32_t u = 0; u < u32Repeats; u++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			bool bOk = replay_trace(map.p8Data, map.uLen, &result);
+			dSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (!bOk)
+			{
+				break;
+			}
+		}
+
+		if (!result.bOk)
+		{
+			printf("%s: %s at byte %zu (record %llu, vblank %llu): %s\n", argv[i], trace_interp_name(result.u8Interp), result.uOffset,
+				(unsigned long long) result.u64Records, (unsigned long long) result.u64VBlanks, result.szError);
+			iFailed++;
+		}
+		else if (!bQuiet)
+		{
+			double dPerReplay = dSeconds / u32Repeats;
+			double dRealSeconds = (double) result.u64VBlanks / 59.94;	// NTSC field rate
+			printf("%s: %s, %llu records, %llu vblanks (%.1f min): %.3f ms, %.1f MB/s, %.0fx real time\n", argv[i],
+				trace_interp_name(result.u8Interp), (unsigned long long) result.u64Records, (unsigned long long) result.u64VBlanks,
+				dRealSeconds / 60, dPerReplay * 1000, (map.uLen / dPerReplay) / 1e6, (dPerReplay > 0) ? dRealSeconds / dPerReplay : 0);
+		}
+
+		trace_map_close(&map);
+	}
+
+	if (iFiles == 0)
+	{
+		printf("usage: %s [--repeat <n>] [--quiet] <trace file>...\n", argv[0]);
+		return 2;
+	}
+
+	return (iFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,570 @@
+#include "replay.h"
+#include "trace_names.h"
+#include <ldp-in/trace-file.h>
+#include <ldp-in/ldv1000-interpreter.h>
+#include <ldp-in/ldp1000-interpreter.h>
+#include <ldp-in/pr7820-interpreter.h>
+#include <ldp-in/pr8210-interpreter.h>
+#include <ldp-in/vip9500sg-interpreter.h>
+#include <ldp-in/vp931-interpreter.h>
+#include <ldp-in/vp932-interpreter.h>
+#include <ldp-in/ld700-interpreter.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// same numbering as the CALLBACK records (see LDPIN_TRACE_CB)
+#define CB_INDEX(type, name) ((uint32_t) (offsetof(type, name) / sizeof(void (*)(void))))
+
+class Replayer
+{
+public:
+	Replayer(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult);
+
+	bool Run();
+
+	// called by the interpreter's callbacks; returns the recorded result (or 0)
+	uint32_t OnCallback(uint32_t u32Index, bool bHasResult);
+
+	// called by the error callbacks before OnCallback
+	void OnError(uint8_t u8Code, uint16_t u16Val);
+
+private:
+	bool Next(LDPInTraceRecord_t *pRec);
+	bool Expect(uint8_t u8Kind, LDPInTraceRecord_t *pRec);
+	void Fail(const char *pszFmt, ...);
+	void Dispatch(const LDPInTraceRecord_t &rec);
+	bool CollectVsyncCmds(uint8_t *p8Buf, uint8_t *pu8Len);
+
+	const uint8_t *m_p8Start;
+	const uint8_t *m_p8Cur;
+	const uint8_t *m_p8End;
+	const uint8_t *m_p8Rec;	// start of the last record decoded
+	LDPInTraceCodec_t m_codec;
+	ReplayResult *m_pResult;
+	bool m_bFailed;
+	bool m_bErrorRecords;	// false for version 1 traces, which were recorded before there were ERROR records
+
+	LDV1000Ctx_t m_ldv1000;
+	LDP1000Ctx_t m_ldp1000;
+	PR7820Ctx_t m_pr7820;
+	PR8210Ctx_t m_pr8210;
+	VIP9500SGCtx_t m_vip9500sg;
+	VP931Ctx_t m_vp931;
+	VP932Ctx_t m_vp932;
+	LD700Ctx_t m_ld700;
+};
+
+/////////////////////////////////////////////////////////////////
+// callbacks; each one just reports which callback it is
+
+static void cb(void *pUser, uint32_t u32Index) { ((Replayer *) pUser)->OnCallback(u32Index, false); }
+static uint32_t cbr(void *pUser, uint32_t u32Index) { return ((Replayer *) pUser)->OnCallback(u32Index, true); }
+static void err(void *pUser, uint32_t u32Index, int iCode, uint16_t u16Val) { ((Replayer *) pUser)->OnError((uint8_t) iCode, u16Val); cb(pUser, u32Index); }
+
+namespace ldv1000_replay
+{
+#define IDX(name) CB_INDEX(LDV1000Callbacks_t, name)
+	LDV1000Status_t get_status(void *p) { return (LDV1000Status_t) cbr(p, IDX(get_status)); }
+	uint32_t get_cur_frame_num(void *p) { return cbr(p, IDX(get_cur_frame_num)); }
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void step_reverse(void *p) { cb(p, IDX(step_reverse)); }
+	void change_speed(void *p, uint8_t, uint8_t) { cb(p, IDX(change_speed)); }
+	void skip_forward(void *p, uint8_t) { cb(p, IDX(skip_forward)); }
+	void skip_backward(void *p, uint8_t) { cb(p, IDX(skip_backward)); }
+	void change_audio(void *p, uint8_t, uint8_t) { cb(p, IDX(change_audio)); }
+	void on_error(void *p, const char *) { cb(p, IDX(on_error)); }
+	// the list itself isn't recorded, so this assumes the usual two-disc setup
+	const uint8_t *query_available_discs(void *p) { static const uint8_t discs[] = { 1, 2, 0 }; cb(p, IDX(query_available_discs)); return discs; }
+	uint8_t query_active_disc(void *p) { return (uint8_t) cbr(p, IDX(query_active_disc)); }
+	void begin_changing_to_disc(void *p, uint8_t) { cb(p, IDX(begin_changing_to_disc)); }
+	void change_seek_delay(void *p, LDV1000_BOOL) { cb(p, IDX(change_seek_delay)); }
+	void change_spinup_delay(void *p, LDV1000_BOOL) { cb(p, IDX(change_spinup_delay)); }
+	void change_super_mode(void *p, LDV1000_BOOL) { cb(p, IDX(change_super_mode)); }
+#undef IDX
+
+	const LDV1000Callbacks_t cbs =
+	{
+		get_status, get_cur_frame_num, play, pause, begin_search, step_reverse, change_speed, skip_forward, skip_backward,
+		change_audio, on_error, query_available_discs, query_active_disc, begin_changing_to_disc, change_seek_delay,
+		change_spinup_delay, change_super_mode
+	};
+}
+
+namespace ldp1000_replay
+{
+#define IDX(name) CB_INDEX(LDP1000Callbacks_t, name)
+	void play(void *p, uint8_t, uint8_t, LDP1000_BOOL, LDP1000_BOOL) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void step_forward(void *p) { cb(p, IDX(step_forward)); }
+	void step_reverse(void *p) { cb(p, IDX(step_reverse)); }
+	void skip(void *p, int16_t) { cb(p, IDX(skip)); }
+	void change_audio(void *p, uint8_t, uint8_t) { cb(p, IDX(change_audio)); }
+	void change_video(void *p, LDP1000_BOOL) { cb(p, IDX(change_video)); }
+	LDP1000Status_t get_status(void *p) { return (LDP1000Status_t) cbr(p, IDX(get_status)); }
+	uint32_t get_cur_frame_num(void *p) { return cbr(p, IDX(get_cur_frame_num)); }
+	void text_enable_changed(void *p, LDP1000_BOOL) { cb(p, IDX(text_enable_changed)); }
+	void text_buffer_contents_changed(void *p, const uint8_t *) { cb(p, IDX(text_buffer_contents_changed)); }
+	void text_buffer_start_index_changed(void *p, uint8_t) { cb(p, IDX(text_buffer_start_index_changed)); }
+	void text_modes_changed(void *p, uint8_t, uint8_t, uint8_t) { cb(p, IDX(text_modes_changed)); }
+	void error(void *p, LDP1000ErrCode_t code, uint8_t u8Val) { err(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const LDP1000Callbacks_t cbs =
+	{
+		play, pause, begin_search, step_forward, step_reverse, skip, change_audio, change_video, get_status,
+		get_cur_frame_num, text_enable_changed, text_buffer_contents_changed, text_buffer_start_index_changed,
+		text_modes_changed, error
+	};
+}
+
+namespace pr7820_replay
+{
+#define IDX(name) CB_INDEX(PR7820Callbacks_t, name)
+	PR7820Status_t get_status(void *p) { return (PR7820Status_t) cbr(p, IDX(get_status)); }
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void begin_search(void *p, unsigned int) { cb(p, IDX(begin_search)); }
+	void change_audio(void *p, unsigned char, unsigned char) { cb(p, IDX(change_audio)); }
+	void enable_super_mode(void *p) { cb(p, IDX(enable_super_mode)); }
+	void on_error(void *p, PR7820ErrCode_t code, unsigned char u8Val) { err(p, IDX(on_error), code, u8Val); }
+#undef IDX
+
+	const PR7820Callbacks_t cbs = { get_status, play, pause, begin_search, change_audio, enable_super_mode, on_error };
+}
+
+namespace pr8210_replay
+{
+#define IDX(name) CB_INDEX(PR8210Callbacks_t, name)
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void step(void *p, int8_t) { cb(p, IDX(step)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void change_audio(void *p, uint8_t, uint8_t) { cb(p, IDX(change_audio)); }
+	void skip(void *p, int8_t) { cb(p, IDX(skip)); }
+	void change_auto_track_jump(void *p, PR8210_BOOL) { cb(p, IDX(change_auto_track_jump)); }
+	PR8210_BOOL is_player_busy(void *p) { return (PR8210_BOOL) cbr(p, IDX(is_player_busy)); }
+	void change_standby(void *p, PR8210_BOOL) { cb(p, IDX(change_standby)); }
+	void error(void *p, PR8210ErrCode_t code, uint16_t u16Val) { err(p, IDX(error), code, u16Val); }
+#undef IDX
+
+	const PR8210Callbacks_t cbs =
+	{
+		play, pause, step, begin_search, change_audio, skip, change_auto_track_jump, is_player_busy, change_standby, error
+	};
+}
+
+namespace vip9500sg_replay
+{
+#define IDX(name) CB_INDEX(VIP9500SGCallbacks_t, name)
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void stop(void *p) { cb(p, IDX(stop)); }
+	void step_reverse(void *p) { cb(p, IDX(step_reverse)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void skip(void *p, int32_t) { cb(p, IDX(skip)); }
+	void change_audio(void *p, uint8_t, uint8_t) { cb(p, IDX(change_audio)); }
+	VIP9500SGStatus_t get_status(void *p) { return (VIP9500SGStatus_t) cbr(p, IDX(get_status)); }
+	uint32_t get_cur_frame_num(void *p) { return cbr(p, IDX(get_cur_frame_num)); }
+	uint32_t get_cur_vbi_line18(void *p) { return cbr(p, IDX(get_cur_vbi_line18)); }
+	void error(void *p, VIP9500SGErrCode_t code, uint8_t u8Val) { err(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const VIP9500SGCallbacks_t cbs =
+	{
+		play, pause, stop, step_reverse, begin_search, skip, change_audio, get_status, get_cur_frame_num, get_cur_vbi_line18, error
+	};
+}
+
+namespace vp931_replay
+{
+#define IDX(name) CB_INDEX(VP931Callbacks_t, name)
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t, VP931_BOOL) { cb(p, IDX(begin_search)); }
+	void skip_tracks(void *p, int16_t) { cb(p, IDX(skip_tracks)); }
+	void skip_to_framenum(void *p, uint32_t) { cb(p, IDX(skip_to_framenum)); }
+	void error(void *p, VP931ErrCode_t code, uint8_t u8Val) { err(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const VP931Callbacks_t cbs = { play, pause, begin_search, skip_tracks, skip_to_framenum, error };
+}
+
+namespace vp932_replay
+{
+#define IDX(name) CB_INDEX(VP932Callbacks_t, name)
+	void play(void *p, uint8_t, uint8_t, VP932_BOOL, VP932_BOOL) { cb(p, IDX(play)); }
+	void step(void *p, VP932_BOOL) { cb(p, IDX(step)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void change_audio(void *p, uint8_t, uint8_t) { cb(p, IDX(change_audio)); }
+	uint32_t get_cur_frame_num(void *p) { return cbr(p, IDX(get_cur_frame_num)); }
+	void error(void *p, VP932ErrCode_t code, uint8_t u8Val) { err(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const VP932Callbacks_t cbs = { play, step, pause, begin_search, change_audio, get_cur_frame_num, error };
+}
+
+namespace ld700_replay
+{
+#define IDX(name) CB_INDEX(LD700Callbacks_t, name)
+	void play(void *p) { cb(p, IDX(play)); }
+	void pause(void *p) { cb(p, IDX(pause)); }
+	void stop(void *p) { cb(p, IDX(stop)); }
+	void eject(void *p) { cb(p, IDX(eject)); }
+	void step(void *p, LD700_BOOL) { cb(p, IDX(step)); }
+	void begin_search(void *p, uint32_t) { cb(p, IDX(begin_search)); }
+	void change_audio(void *p, LD700_BOOL, LD700_BOOL) { cb(p, IDX(change_audio)); }
+	void change_audio_squelch(void *p, LD700_BOOL) { cb(p, IDX(change_audio_squelch)); }
+	uint32_t get_current_picnum(void *p) { return cbr(p, IDX(get_current_picnum)); }
+	void on_ext_ack_changed(void *p, LD700_BOOL) { cb(p, IDX(on_ext_ack_changed)); }
+	void error(void *p, LD700ErrCode_t code, uint8_t u8Val) { err(p, IDX(error), code, u8Val); }
+#undef IDX
+
+	const LD700Callbacks_t cbs =
+	{
+		play, pause, stop, eject, step, begin_search, change_audio, change_audio_squelch, get_current_picnum, on_ext_ack_changed, error
+	};
+}
+
+/////////////////////////////////////////////////////////////////
+
+Replayer::Replayer(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult) :
+	m_p8Start(p8Trace), m_p8Cur(p8Trace), m_p8End(p8Trace + uLen), m_p8Rec(p8Trace), m_pResult(pResult), m_bFailed(false), m_bErrorRecords(true)
+{
+	memset(pResult, 0, sizeof(*pResult));
+	pResult->u8Interp = 0xFF;
+
+	ldv1000i_ctx_init(&m_ldv1000, &ldv1000_replay::cbs, this);
+	ldp1000i_ctx_init(&m_ldp1000, &ldp1000_replay::cbs, this);
+	pr7820i_ctx_init(&m_pr7820, &pr7820_replay::cbs, this);
+	pr8210i_ctx_init(&m_pr8210, &pr8210_replay::cbs, this);
+	vip9500sgi_ctx_init(&m_vip9500sg, &vip9500sg_replay::cbs, this);
+	vp931i_ctx_init(&m_vp931, &vp931_replay::cbs, this);
+	vp932i_ctx_init(&m_vp932, &vp932_replay::cbs, this);
+	ld700i_ctx_init(&m_ld700, &ld700_replay::cbs, this);
+}
+
+void Replayer::Fail(const char *pszFmt, ...)
+{
+	va_list args;
+
+	// only the first difference means anything
+	if (m_bFailed)
+	{
+		return;
+	}
+
+	va_start(args, pszFmt);
+	vsnprintf(m_pResult->szError, sizeof(m_pResult->szError), pszFmt, args);
+	va_end(args);
+
+	m_bFailed = true;
+	m_pResult->uOffset = (size_t) (m_p8Rec - m_p8Start);
+}
+
+bool Replayer::Next(LDPInTraceRecord_t *pRec)
+{
+	uint8_t u8Len = ldpin_tracefile_decode(&m_codec, m_p8Cur, m_p8End, pRec);
+
+	m_p8Rec = m_p8Cur;
+
+	if (u8Len == 0)
+	{
+		return false;
+	}
+
+	m_p8Cur += u8Len;
+	m_pResult->u64Records++;
+	return true;
+}
+
+// Gets the next record that the interpreter's output should match.
+// (VP-931 command records are skipped: they were all handed over when on_vsync was called.)
+bool Replayer::Expect(uint8_t u8Kind, LDPInTraceRecord_t *pRec)
+{
+	if (m_bFailed)
+	{
+		return false;
+	}
+
+	for (;;)
+	{
+		if (!Next(pRec))
+		{
+			Fail("this build produced %s but the trace ends here", trace_kind_name(u8Kind));
+			return false;
+		}
+
+		if (pRec->u8Kind != LDPIN_TRACE_VSYNC_CMD)
+		{
+			break;
+		}
+	}
+
+	if (pRec->u8Kind != u8Kind)
+	{
+		Fail("this build produced %s where the trace has %s %u", trace_kind_name(u8Kind), trace_kind_name(pRec->u8Kind), pRec->u32Val);
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t Replayer::OnCallback(uint32_t u32Index, bool bHasResult)
+{
+	LDPInTraceRecord_t rec;
+
+	if (!Expect(LDPIN_TRACE_CALLBACK, &rec))
+	{
+		return 0;
+	}
+
+	if (rec.u32Val != u32Index)
+	{
+		const char *pszMine = trace_callback_name(m_codec.u8Interp, u32Index);
+		const char *pszTrace = trace_callback_name(m_codec.u8Interp, rec.u32Val);
+		Fail("this build called %s where the trace has %s", pszMine ? pszMine : "?", pszTrace ? pszTrace : "an unknown callback");
+		return 0;
+	}
+
+	if (bHasResult && Expect(LDPIN_TRACE_RESULT, &rec))
+	{
+		return rec.u32Val;
+	}
+
+	return 0;
+}
+
+void Replayer::OnError(uint8_t u8Code, uint16_t u16Val)
+{
+	LDPInTraceRecord_t rec;
+	uint32_t u32Val = u8Code | ((uint32_t) u16Val << 8);
+
+	if (!m_bErrorRecords)
+	{
+		return;
+	}
+
+	if (Expect(LDPIN_TRACE_ERROR, &rec) && (rec.u32Val != u32Val))
+	{
+		const char *pszMine = trace_error_name(m_codec.u8Interp, u8Code);
+		const char *pszTrace = trace_error_name(m_codec.u8Interp, (uint8_t) rec.u32Val);
+		Fail("this build reported %s (0x%X) where the trace has %s (0x%X)", pszMine ? pszMine : "?", u16Val,
+			pszTrace ? pszTrace : "an unknown error", rec.u32Val >> 8);
+	}
+}
+
+// Gathers the command records that follow a VP-931 VBLANK without consuming them (the callbacks made in between are consumed later).
+bool Replayer::CollectVsyncCmds(uint8_t *p8Buf, uint8_t *pu8Len)
+{
+	LDPInTraceCodec_t codec = m_codec;
+	const uint8_t *p8 = m_p8Cur;
+	LDPInTraceRecord_t rec;
+	uint8_t u8Len = 0;
+
+	for (;;)
+	{
+		uint8_t u8RecLen = ldpin_tracefile_decode(&codec, p8, m_p8End, &rec);
+		if (u8RecLen == 0)
+		{
+			break;
+		}
+		p8 += u8RecLen;
+
+		if (rec.u8Kind == LDPIN_TRACE_VSYNC_CMD)
+		{
+			// on_vsync takes at most 255 bytes
+			if (u8Len > 252)
+			{
+				Fail("too many VP-931 commands in one vsync");
+				return false;
+			}
+			p8Buf[u8Len++] = (uint8_t) rec.u32Val;
+			p8Buf[u8Len++] = (uint8_t) (rec.u32Val >> 8);
+			p8Buf[u8Len++] = (uint8_t) (rec.u32Val >> 16);
+		}
+		else if ((rec.u8Kind != LDPIN_TRACE_CALLBACK) && (rec.u8Kind != LDPIN_TRACE_RESULT) && (rec.u8Kind != LDPIN_TRACE_ERROR))
+		{
+			break;
+		}
+	}
+
+	*pu8Len = u8Len;
+	return true;
+}
+
+void Replayer::Dispatch(const LDPInTraceRecord_t &rec)
+{
+	uint8_t u8Kind = rec.u8Kind;
+	uint32_t u32Val = rec.u32Val;
+	LDPInTraceRecord_t out;
+
+	switch (rec.u8Interp)
+	{
+	case LDPIN_TRACE_LDV1000:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: ldv1000i_ctx_reset(&m_ldv1000, (LDV1000_EmulationType_t) u32Val); return;
+		case LDPIN_TRACE_WRITE: ldv1000i_ctx_write(&m_ldv1000, (unsigned char) u32Val); return;
+		case LDPIN_TRACE_SET_FRAME: ldv1000i_ctx_set_cur_frame_num(&m_ldv1000, u32Val); return;
+		case LDPIN_TRACE_SET_STATUS: ldv1000i_ctx_set_status(&m_ldv1000, (LDV1000Status_t) u32Val); return;
+		case LDPIN_TRACE_READ:
+			{
+				unsigned char u8Out = ldv1000i_ctx_read(&m_ldv1000);
+				if (Expect(LDPIN_TRACE_OUTPUT, &out) && (out.u32Val != u8Out))
+				{
+					Fail("read returned 0x%02X where the trace has 0x%02X", u8Out, out.u32Val);
+				}
+			}
+			return;
+		}
+		break;
+	case LDPIN_TRACE_LDP1000:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: ldp1000i_ctx_reset(&m_ldp1000, (LDP1000_EmulationType_t) u32Val); return;
+		case LDPIN_TRACE_WRITE: ldp1000i_ctx_write(&m_ldp1000, (uint8_t) u32Val); return;
+		case LDPIN_TRACE_VBLANK: ldp1000i_ctx_think_during_vblank(&m_ldp1000); return;
+		case LDPIN_TRACE_SET_FRAME: ldp1000i_ctx_set_cur_frame_num(&m_ldp1000, u32Val); return;
+		}
+		break;
+	case LDPIN_TRACE_PR7820:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: pr7820i_ctx_reset(&m_pr7820); return;
+		case LDPIN_TRACE_WRITE: pr7820i_ctx_write(&m_pr7820, (unsigned char) u32Val); return;
+		case LDPIN_TRACE_READ:
+			{
+				PR7820_BOOL bBusy = pr7820i_ctx_is_busy(&m_pr7820);
+				if (Expect(LDPIN_TRACE_OUTPUT, &out) && (out.u32Val != (uint32_t) bBusy))
+				{
+					Fail("is_busy returned %u where the trace has %u", bBusy, out.u32Val);
+				}
+			}
+			return;
+		}
+		break;
+	case LDPIN_TRACE_PR8210:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: pr8210i_ctx_reset(&m_pr8210); return;
+		case LDPIN_TRACE_WRITE: pr8210i_ctx_write(&m_pr8210, (uint16_t) u32Val); return;
+		case LDPIN_TRACE_VBLANK: pr8210i_ctx_on_vblank(&m_pr8210); return;
+		case LDPIN_TRACE_JMP_TRIGGER:
+			pr8210i_ctx_on_jmp_trigger_changed(&m_pr8210, (u32Val & 1) ? PR8210_TRUE : PR8210_FALSE, (u32Val & 2) ? PR8210_TRUE : PR8210_FALSE);
+			return;
+		case LDPIN_TRACE_INTEXT: pr8210i_ctx_on_jmptrig_and_scanc_intext_changed(&m_pr8210, u32Val ? PR8210_TRUE : PR8210_FALSE); return;
+		}
+		break;
+	case LDPIN_TRACE_VIP9500SG:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: vip9500sgi_ctx_reset(&m_vip9500sg); return;
+		case LDPIN_TRACE_WRITE: vip9500sgi_ctx_write(&m_vip9500sg, (uint8_t) u32Val); return;
+		case LDPIN_TRACE_VBLANK: vip9500sgi_ctx_think_after_vblank(&m_vip9500sg); return;
+		case LDPIN_TRACE_SET_FRAME: vip9500sgi_ctx_set_cur_frame_num(&m_vip9500sg, u32Val); return;
+		}
+		break;
+	case LDPIN_TRACE_VP931:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: vp931i_ctx_reset(&m_vp931); return;
+		case LDPIN_TRACE_VBLANK:
+			{
+				uint8_t au8Cmds[255];
+				uint8_t u8Len = 0;
+				if (CollectVsyncCmds(au8Cmds, &u8Len))
+				{
+					vp931i_ctx_on_vsync(&m_vp931, au8Cmds, u8Len, (VP931Status_t) u32Val);
+				}
+			}
+			return;
+		case LDPIN_TRACE_VSYNC_CMD: return;	// already handed over with the VBLANK before it
+		}
+		break;
+	case LDPIN_TRACE_VP932:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: vp932i_ctx_reset(&m_vp932); return;
+		case LDPIN_TRACE_WRITE: vp932i_ctx_write(&m_vp932, (uint8_t) u32Val); return;
+		case LDPIN_TRACE_VBLANK: vp932i_ctx_think_during_vblank(&m_vp932, (VP932Status_t) u32Val); return;
+		}
+		break;
+	case LDPIN_TRACE_LD700:
+		switch (u8Kind)
+		{
+		case LDPIN_TRACE_RESET: ld700i_ctx_reset(&m_ld700); return;
+		case LDPIN_TRACE_WRITE: ld700i_ctx_write(&m_ld700, (uint8_t) u32Val, (LD700Status_t) (u32Val >> 8)); return;
+		case LDPIN_TRACE_VBLANK: ld700i_ctx_on_vblank(&m_ld700, (LD700Status_t) u32Val); return;
+		case LDPIN_TRACE_NEW_CMD: ld700i_ctx_on_new_cmd(&m_ld700); return;
+		}
+		break;
+	}
+
+	// outputs only get here if the interpreter didn't produce them this time
+	if ((u8Kind == LDPIN_TRACE_CALLBACK) || (u8Kind == LDPIN_TRACE_RESULT) || (u8Kind == LDPIN_TRACE_OUTPUT) || (u8Kind == LDPIN_TRACE_ERROR))
+	{
+		Fail("the trace has %s %u which this build didn't produce", trace_kind_name(u8Kind), u32Val);
+	}
+	else
+	{
+		Fail("%s can't take a %s record", trace_interp_name(rec.u8Interp), trace_kind_name(u8Kind));
+	}
+}
+
+bool Replayer::Run()
+{
+	LDPInTraceRecord_t rec;
+
+	if (!ldpin_tracefile_read_header(&m_codec, m_p8Start, (uint32_t) (m_p8End - m_p8Start)))
+	{
+		Fail("not a version %u trace file", LDPIN_TRACEFILE_VERSION);
+		return false;
+	}
+	m_bErrorRecords = (m_p8Start[4] >= 2);	// the version
+	m_p8Cur += LDPIN_TRACEFILE_HEADER_SIZE;
+	m_pResult->u8Interp = m_codec.u8Interp;
+
+	while (!m_bFailed && Next(&rec))
+	{
+		if (rec.u8Kind == LDPIN_TRACE_VBLANK)
+		{
+			m_pResult->u64VBlanks++;
+		}
+
+		// ldpin_trace_vblank only counts vblanks
+		if (rec.u8Interp == LDPIN_TRACE_HOST)
+		{
+			continue;
+		}
+
+		if (rec.u8Interp != m_codec.u8Interp)
+		{
+			Fail("the trace is for the %s but this record is from the %s", trace_interp_name(m_codec.u8Interp), trace_interp_name(rec.u8Interp));
+			break;
+		}
+
+		Dispatch(rec);
+	}
+
+	if (!m_bFailed && (m_p8Cur != m_p8End))
+	{
+		Fail("corrupt or incomplete record");
+	}
+
+	m_pResult->bOk = !m_bFailed;
+	return m_pResult->bOk;
+}
+
+bool replay_trace(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult)
+{
+	// the contexts are big enough that they shouldn't go on a worker thread's stack
+	Replayer *pReplayer = new Replayer(p8Trace, uLen, pResult);
+	bool bOk = pReplayer->Run();
+	delete pReplayer;
+	return bOk;
+}
@@ -0,0 +1,25 @@
+#ifndef LDP_IN_TOOLS_REPLAY_H
+#define LDP_IN_TOOLS_REPLAY_H
+
+// Replays a trace file (see trace-file.h) into a freshly initialized interpreter.
+// Every input record is fed to the interpreter's entry point, and every callback the interpreter makes is checked against the next
+//  recorded CALLBACK (and answered with the recorded RESULT, if it returns something); LD-V1000 reads and PR-7820 busy checks are
+//  checked against the recorded OUTPUT, and error codes against the recorded ERROR.  Replay stops at the first difference.
+// Other callback arguments are not part of the trace, so only which callbacks were made (and in what order) is checked.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct ReplayResult
+{
+	bool bOk;
+	uint8_t u8Interp;	// LDPInTraceInterp_t from the header (0xFF if there isn't one)
+	uint64_t u64Records;	// records replayed (up to and including the one that differed)
+	uint64_t u64VBlanks;	// VBLANK records replayed (so also how far into the trace the difference is)
+	size_t uOffset;	// byte offset of the record that differed
+	char szError[160];	// what differed (if !bOk)
+};
+
+bool replay_trace(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult);
+
+#endif // LDP_IN_TOOLS_REPLAY_H
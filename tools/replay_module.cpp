@@ -0,0 +1,19 @@
+#include "replay_module.h"
+
+#define EXPORT extern "C" __attribute__((visibility("default")))
+
+EXPORT int ldp_in_replay_module_abi()
+{
+	return REPLAY_MODULE_ABI;
+}
+
+EXPORT bool ldp_in_replay_module_run(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult)
+{
+	return replay_trace(p8Trace, uLen, pResult);
+}
+
+// LDP_IN_MODULE_DESCRIPTION comes from tools/CMakeLists.txt
+EXPORT const char *ldp_in_replay_module_describe()
+{
+	return LDP_IN_MODULE_DESCRIPTION;
+}
@@ -0,0 +1,25 @@
+#ifndef LDP_IN_TOOLS_REPLAY_MODULE_H
+#define LDP_IN_TOOLS_REPLAY_MODULE_H
+
+// The replayer (see replay.h) built into a loadable module along with the interpreters, so that a tool can load two builds of the
+//  library side by side (each with dlopen's RTLD_LOCAL, so neither build's symbols can replace the other's) and compare them.
+
+#include "replay.h"
+
+// bump whenever ReplayResult or the functions below change, so that modules built from older trees are refused instead of misread
+#define REPLAY_MODULE_ABI 1
+
+#define REPLAY_MODULE_ABI_SYMBOL "ldp_in_replay_module_abi"
+#define REPLAY_MODULE_RUN_SYMBOL "ldp_in_replay_module_run"
+#define REPLAY_MODULE_DESCRIBE_SYMBOL "ldp_in_replay_module_describe"
+
+// returns REPLAY_MODULE_ABI as it was when the module was built
+typedef int (*ReplayModuleAbiFunc)();
+
+// replay_trace; safe to call from several threads at once
+typedef bool (*ReplayModuleRunFunc)(const uint8_t *p8Trace, size_t uLen, ReplayResult *pResult);
+
+// a line about the build (library version, build type and options), for reports
+typedef const char *(*ReplayModuleDescribeFunc)();
+
+#endif // LDP_IN_TOOLS_REPLAY_MODULE_H
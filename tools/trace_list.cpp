@@ -0,0 +1,41 @@
+#include "trace_list.h"
+#include <algorithm>
+#include <filesystem>
+
+static void add_file(const std::filesystem::path &path, std::vector<TraceFile> *pFiles)
+{
+	std::error_code ec;
+	TraceFile file;
+
+	file.strPath = path.string();
+	file.strGame = path.parent_path().filename().string();
+	if (file.strGame.empty())
+	{
+		file.strGame = ".";
+	}
+	file.uSize = std::filesystem::file_size(path, ec);
+	pFiles->push_back(file);
+}
+
+void trace_list_add(const char *pszArg, std::vector<TraceFile> *pFiles)
+{
+	if (std::filesystem::is_directory(pszArg))
+	{
+		for (const auto &entry : std::filesystem::recursive_directory_iterator(pszArg))
+		{
+			if (entry.is_regular_file())
+			{
+				add_file(entry.path(), pFiles);
+			}
+		}
+	}
+	else
+	{
+		add_file(pszArg, pFiles);
+	}
+}
+
+void trace_list_sort(std::vector<TraceFile> *pFiles)
+{
+	std::sort(pFiles->begin(), pFiles->end(), [](const TraceFile &a, const TraceFile &b) { return a.uSize > b.uSize; });
+}
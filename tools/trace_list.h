@@ -0,0 +1,24 @@
+#ifndef LDP_IN_TOOLS_TRACE_LIST_H
+#define LDP_IN_TOOLS_TRACE_LIST_H
+
+// The trace files named on a tool's command line, for tools that spread them over several threads.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+struct TraceFile
+{
+	std::string strPath;
+	std::string strGame;	// name of the directory the trace is in
+	uintmax_t uSize;
+};
+
+// Adds pszArg, or if it's a directory, every file under it.
+void trace_list_add(const char *pszArg, std::vector<TraceFile> *pFiles);
+
+// Biggest first, so that the last files to be picked up are small ones and the threads finish together.
+// (A trace can only be decoded from its start, so one file is never split between threads.)
+void trace_list_sort(std::vector<TraceFile> *pFiles);
+
+#endif // LDP_IN_TOOLS_TRACE_LIST_H
@@ -0,0 +1,62 @@
+#include "trace_map.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool trace_map_open(const char *pszPath, TraceMap *pMap)
+{
+	struct stat st;
+	int fd = open(pszPath, O_RDONLY);
+
+	pMap->p8Data = 0;
+	pMap->uLen = 0;
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "%s: %s\n", pszPath, strerror(errno));
+		return false;
+	}
+
+	if (fstat(fd, &st) != 0)
+	{
+		fprintf(stderr, "%s: %s\n", pszPath, strerror(errno));
+		close(fd);
+		return false;
+	}
+
+	// mmap refuses empty files; an empty trace is just one without a header
+	if (st.st_size == 0)
+	{
+		close(fd);
+		return true;
+	}
+
+	void *p = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);	// the mapping keeps the file open
+
+	if (p == MAP_FAILED)
+	{
+		fprintf(stderr, "%s: mmap: %s\n", pszPath, strerror(errno));
+		return false;
+	}
+
+	madvise(p, (size_t) st.st_size, MADV_SEQUENTIAL);
+
+	pMap->p8Data = (const uint8_t *) p;
+	pMap->uLen = (size_t) st.st_size;
+	return true;
+}
+
+void trace_map_close(TraceMap *pMap)
+{
+	if (pMap->uLen != 0)
+	{
+		munmap((void *) pMap->p8Data, pMap->uLen);
+	}
+	pMap->p8Data = 0;
+	pMap->uLen = 0;
+}
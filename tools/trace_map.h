@@ -0,0 +1,21 @@
+#ifndef LDP_IN_TOOLS_TRACE_MAP_H
+#define LDP_IN_TOOLS_TRACE_MAP_H
+
+// Read-only memory mapping of a trace file, so that traces of any length can be read without loading them into RAM.
+// The kernel reads pages in as they are touched (and is told that they will be touched in order) and can drop them again afterward.
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct TraceMap
+{
+	const uint8_t *p8Data;
+	size_t uLen;
+};
+
+// Maps pszPath.  Returns false (and prints why) if it can't be opened or mapped.
+bool trace_map_open(const char *pszPath, TraceMap *pMap);
+
+void trace_map_close(TraceMap *pMap);
+
+#endif // LDP_IN_TOOLS_TRACE_MAP_H
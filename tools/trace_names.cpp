@@ -0,0 +1,110 @@
+#include "trace_names.h"
+#include <ldp-in/trace.h>
+
+#define ARRAY_COUNT(a) ((uint32_t) (sizeof(a) / sizeof((a)[0])))
+
+// in the same order as LDPInTraceInterp_t
+static const char *g_apszInterps[] = { "LD-V1000", "LDP-1000", "PR-7820", "PR-8210", "VIP9500SG", "VP-931", "VP-932", "LD-700" };
+
+// in the same order as LDPInTraceKind_t
+static const char *g_apszKinds[] =
+{
+	"RESET", "WRITE", "READ", "OUTPUT", "VBLANK", "VSYNC_CMD", "JMP_TRIGGER", "INTEXT", "NEW_CMD", "SET_STATUS", "SET_FRAME",
+	"CALLBACK", "RESULT", "ERROR"
+};
+
+// in the same order as the members of each <X>Callbacks_t
+static const char *g_apszLDV1000Callbacks[] =
+{
+	"get_status", "get_cur_frame_num", "play", "pause", "begin_search", "step_reverse", "change_speed", "skip_forward", "skip_backward",
+	"change_audio", "on_error", "query_available_discs", "query_active_disc", "begin_changing_to_disc", "change_seek_delay",
+	"change_spinup_delay", "change_super_mode"
+};
+static const char *g_apszLDP1000Callbacks[] =
+{
+	"play", "pause", "begin_search", "step_forward", "step_reverse", "skip", "change_audio", "change_video", "get_status",
+	"get_cur_frame_num", "text_enable_changed", "text_buffer_contents_changed", "text_buffer_start_index_changed",
+	"text_modes_changed", "error"
+};
+static const char *g_apszPR7820Callbacks[] = { "get_status", "play", "pause", "begin_search", "change_audio", "enable_super_mode", "on_error" };
+static const char *g_apszPR8210Callbacks[] =
+{
+	"play", "pause", "step", "begin_search", "change_audio", "skip", "change_auto_track_jump", "is_player_busy", "change_standby", "error"
+};
+static const char *g_apszVIP9500SGCallbacks[] =
+{
+	"play", "pause", "stop", "step_reverse", "begin_search", "skip", "change_audio", "get_status", "get_cur_frame_num",
+	"get_cur_vbi_line18", "error"
+};
+static const char *g_apszVP931Callbacks[] = { "play", "pause", "begin_search", "skip_tracks", "skip_to_framenum", "error" };
+static const char *g_apszVP932Callbacks[] = { "play", "step", "pause", "begin_search", "change_audio", "get_cur_frame_num", "error" };
+static const char *g_apszLD700Callbacks[] =
+{
+	"play", "pause", "stop", "eject", "step", "begin_search", "change_audio", "change_audio_squelch", "get_current_picnum",
+	"on_ext_ack_changed", "error"
+};
+
+// in the same order as each <X>ErrCode_t
+static const char *g_apszLDP1000Errors[] = { "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE", "TOO_MANY_DIGITS", "UNHANDLED_SITUATION" };
+static const char *g_apszPR7820Errors[] = { "TOO_MANY_DIGITS", "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE" };
+static const char *g_apszPR8210Errors[] = { "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE", "TOO_MANY_DIGITS", "UNHANDLED_SITUATION", "CORRUPT_INPUT" };
+static const char *g_apszVIP9500SGErrors[] = { "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE", "TOO_MANY_DIGITS", "UNHANDLED_SITUATION" };
+static const char *g_apszVP931Errors[] = { "TOO_MANY_WRITES", "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE" };
+static const char *g_apszVP932Errors[] = { "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE", "RX_BUF_OVERFLOW", "UNHANDLED_SITUATION" };
+static const char *g_apszLD700Errors[] = { "UNKNOWN_CMD_BYTE", "UNSUPPORTED_CMD_BYTE", "TOO_MANY_DIGITS", "UNHANDLED_SITUATION", "CORRUPT_INPUT" };
+
+struct NameTable
+{
+	const char **ppszNames;
+	uint32_t u32Count;
+};
+
+#define NAME_TABLE(a) { a, ARRAY_COUNT(a) }
+
+// indexed by LDPInTraceInterp_t
+static const NameTable g_callbackNames[] =
+{
+	NAME_TABLE(g_apszLDV1000Callbacks), NAME_TABLE(g_apszLDP1000Callbacks), NAME_TABLE(g_apszPR7820Callbacks),
+	NAME_TABLE(g_apszPR8210Callbacks), NAME_TABLE(g_apszVIP9500SGCallbacks), NAME_TABLE(g_apszVP931Callbacks),
+	NAME_TABLE(g_apszVP932Callbacks), NAME_TABLE(g_apszLD700Callbacks)
+};
+
+static const NameTable g_errorNames[] =
+{
+	{ 0, 0 },	// the LD-V1000 reports errors as text
+	NAME_TABLE(g_apszLDP1000Errors), NAME_TABLE(g_apszPR7820Errors), NAME_TABLE(g_apszPR8210Errors), NAME_TABLE(g_apszVIP9500SGErrors),
+	NAME_TABLE(g_apszVP931Errors), NAME_TABLE(g_apszVP932Errors), NAME_TABLE(g_apszLD700Errors)
+};
+
+static const char *lookup(const NameTable *pTables, uint8_t u8Interp, uint32_t u32Index)
+{
+	if ((u8Interp >= ARRAY_COUNT(g_apszInterps)) || (u32Index >= pTables[u8Interp].u32Count))
+	{
+		return 0;
+	}
+	return pTables[u8Interp].ppszNames[u32Index];
+}
+
+const char *trace_interp_name(uint8_t u8Interp)
+{
+	if (u8Interp < ARRAY_COUNT(g_apszInterps))
+	{
+		return g_apszInterps[u8Interp];
+	}
+	return (u8Interp == LDPIN_TRACE_HOST) ? "host" : "unknown interpreter";
+}
+
+const char *trace_kind_name(uint8_t u8Kind)
+{
+	return (u8Kind < ARRAY_COUNT(g_apszKinds)) ? g_apszKinds[u8Kind] : "unknown";
+}
+
+const char *trace_callback_name(uint8_t u8Interp, uint32_t u32Index)
+{
+	return lookup(g_callbackNames, u8Interp, u32Index);
+}
+
+const char *trace_error_name(uint8_t u8Interp, uint8_t u8Code)
+{
+	return lookup(g_errorNames, u8Interp, u8Code);
+}
@@ -0,0 +1,20 @@
+#ifndef LDP_IN_TOOLS_TRACE_NAMES_H
+#define LDP_IN_TOOLS_TRACE_NAMES_H
+
+// Names for the numbers in trace records, for the tools' messages and reports.
+
+#include <stdint.h>
+
+// LDPInTraceInterp_t ("unknown interpreter" for anything else)
+const char *trace_interp_name(uint8_t u8Interp);
+
+// LDPInTraceKind_t
+const char *trace_kind_name(uint8_t u8Kind);
+
+// member of the interpreter's <X>Callbacks_t at position u32Index (the value of a CALLBACK record), or 0 if there isn't one
+const char *trace_callback_name(uint8_t u8Interp, uint32_t u32Index);
+
+// the interpreter's <X>ErrCode_t value (the low byte of an ERROR record), or 0 if there isn't one
+const char *trace_error_name(uint8_t u8Interp, uint8_t u8Code);
+
+#endif // LDP_IN_TOOLS_TRACE_NAMES_H